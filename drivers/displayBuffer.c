@@ -0,0 +1,569 @@
+/*
+This software is provided for student assignment use in the Department of
+Electrical and Computer Engineering, Brigham Young University, Utah, USA.
+
+Users agree to not re-host, or redistribute the software, in source or binary
+form, to other persons or other institutions. Users may modify and use the
+source code for personal or educational use.
+
+For questions, contact Brad Hutchings or Jeff Goeders, https://ece.byu.edu/
+*/
+
+// This file calls the real display_* functions.
+#define DISPLAY_BUFFER_NO_REDIRECT
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "display.h"
+#include "displayBuffer.h"
+#include "displayFont.h"
+#include "displayGlyphCache.h"
+
+#define DISPLAY_BUFFER_DEFAULT_TEXT_COLOR DISPLAY_WHITE
+#define DISPLAY_BUFFER_DECIMAL_INT_MAX_CHARS 12 // "-2147483648" and the 0.
+
+// The corners for the circle helpers, the same as Adafruit_GFX.
+#define DISPLAY_BUFFER_CORNER_UPPER_LEFT 0x1
+#define DISPLAY_BUFFER_CORNER_UPPER_RIGHT 0x2
+#define DISPLAY_BUFFER_CORNER_LOWER_RIGHT 0x4
+#define DISPLAY_BUFFER_CORNER_LOWER_LEFT 0x8
+
+static uint16_t pixels[DISPLAY_HEIGHT][DISPLAY_WIDTH];
+// One bit per tile, bit n is tile column n.
+static uint32_t dirtyTiles[DISPLAY_BUFFER_TILE_ROWS];
+
+static void displayBuffer_writeRuns(int16_t x, int16_t y, int16_t w, int16_t h,
+                                    const uint16_t *windowPixels,
+                                    uint16_t stride);
+static displayBuffer_windowWriter_t windowWriter = displayBuffer_writeRuns;
+
+// Text state, as in Adafruit_GFX.
+static int16_t cursorX;
+static int16_t cursorY;
+static uint16_t textColor = DISPLAY_BUFFER_DEFAULT_TEXT_COLOR;
+// The same as textColor means no background.
+static uint16_t textBgColor = DISPLAY_BUFFER_DEFAULT_TEXT_COLOR;
+static uint8_t textSize = 1;
+static bool textWrapFlag = true;
+
+// Writes the window with one display_fillRect() per run of equal pixels. Rows
+// that are the same as the row above are written with it.
+static void displayBuffer_writeRuns(int16_t x, int16_t y, int16_t w, int16_t h,
+                                    const uint16_t *windowPixels,
+                                    uint16_t stride) {
+  int16_t row = 0;
+  while (row < h) {
+    const uint16_t *line = windowPixels + row * stride;
+    int16_t rowCount = 1;
+    while (row + rowCount < h &&
+           memcmp(line, line + rowCount * stride, w * sizeof(uint16_t)) == 0)
+      rowCount++;
+    int16_t column = 0;
+    while (column < w) {
+      int16_t runLength = 1;
+      while (column + runLength < w &&
+             line[column + runLength] == line[column])
+        runLength++;
+      display_fillRect(x + column, y + row, runLength, rowCount, line[column]);
+      column += runLength;
+    }
+    row += rowCount;
+  }
+}
+
+// Calls display_init(), clears the framebuffer and marks it all dirty. The
+// default writer is put back first, so display_init() can plug in its own.
+void displayBuffer_init() {
+  windowWriter = displayBuffer_writeRuns;
+  display_init();
+  cursorX = 0;
+  cursorY = 0;
+  textColor = DISPLAY_BUFFER_DEFAULT_TEXT_COLOR;
+  textBgColor = DISPLAY_BUFFER_DEFAULT_TEXT_COLOR;
+  textSize = 1;
+  textWrapFlag = true;
+  displayBuffer_fillScreen(DISPLAY_BLACK);
+}
+
+// Returns the bits for tile columns first to last.
+static uint32_t displayBuffer_getTileMask(uint16_t first, uint16_t last) {
+  return (((uint32_t)2 << last) - 1) & ~(((uint32_t)1 << first) - 1);
+}
+
+// Marks the tiles under a rectangle that is already on the display.
+static void displayBuffer_markTiles(int16_t x, int16_t y, int16_t w,
+                                    int16_t h) {
+  uint32_t mask =
+      displayBuffer_getTileMask(x / DISPLAY_BUFFER_TILE_SIZE,
+                                (x + w - 1) / DISPLAY_BUFFER_TILE_SIZE);
+  for (int16_t row = y / DISPLAY_BUFFER_TILE_SIZE;
+       row <= (y + h - 1) / DISPLAY_BUFFER_TILE_SIZE; row++)
+    dirtyTiles[row] |= mask;
+}
+
+// Clips a rectangle to the display. Returns false if nothing is left.
+static bool displayBuffer_clip(int16_t *x, int16_t *y, int16_t *w,
+                               int16_t *h) {
+  if (*w <= 0 || *h <= 0 || *x >= DISPLAY_WIDTH || *y >= DISPLAY_HEIGHT ||
+      *x + *w <= 0 || *y + *h <= 0)
+    return false;
+  if (*x < 0) {
+    *w += *x;
+    *x = 0;
+  }
+  if (*y < 0) {
+    *h += *y;
+    *y = 0;
+  }
+  if (*x + *w > DISPLAY_WIDTH)
+    *w = DISPLAY_WIDTH - *x;
+  if (*y + *h > DISPLAY_HEIGHT)
+    *h = DISPLAY_HEIGHT - *y;
+  return true;
+}
+
+// Marks the w x h rectangle at (x, y) dirty.
+void displayBuffer_markDirty(int16_t x, int16_t y, int16_t w, int16_t h) {
+  if (displayBuffer_clip(&x, &y, &w, &h))
+    displayBuffer_markTiles(x, y, w, h);
+}
+
+// Returns the framebuffer.
+uint16_t *displayBuffer_getPixels() { return &pixels[0][0]; }
+
+// Writes the dirty tiles to the display.
+uint32_t displayBuffer_flush() {
+  uint32_t pixelCount = 0;
+  for (uint16_t row = 0; row < DISPLAY_BUFFER_TILE_ROWS; row++) {
+    uint16_t column = 0;
+    while (dirtyTiles[row] != 0) {
+      if (!(dirtyTiles[row] & ((uint32_t)1 << column))) {
+        column++;
+        continue;
+      }
+      uint16_t lastColumn = column;
+      while (lastColumn + 1 < DISPLAY_BUFFER_TILE_COLUMNS &&
+             (dirtyTiles[row] & ((uint32_t)1 << (lastColumn + 1))))
+        lastColumn++;
+      uint32_t mask = displayBuffer_getTileMask(column, lastColumn);
+      dirtyTiles[row] &= ~mask;
+      // Take the same columns from the tile rows below while they are dirty.
+      uint16_t endRow = row + 1;
+      while (endRow < DISPLAY_BUFFER_TILE_ROWS &&
+             (dirtyTiles[endRow] & mask) == mask)
+        dirtyTiles[endRow++] &= ~mask;
+      int16_t x = column * DISPLAY_BUFFER_TILE_SIZE;
+      int16_t y = row * DISPLAY_BUFFER_TILE_SIZE;
+      int16_t w = (lastColumn + 1 - column) * DISPLAY_BUFFER_TILE_SIZE;
+      int16_t h = (endRow - row) * DISPLAY_BUFFER_TILE_SIZE;
+      windowWriter(x, y, w, h, &pixels[y][x], DISPLAY_WIDTH);
+      pixelCount += (uint32_t)w * h;
+      column = lastColumn + 1;
+    }
+  }
+  return pixelCount;
+}
+
+// Sets the window writer, NULL for the default.
+void displayBuffer_setWindowWriter(displayBuffer_windowWriter_t writer) {
+  windowWriter = writer ? writer : displayBuffer_writeRuns;
+}
+
+// Writes a window straight to the display.
+void displayBuffer_writeWindow(int16_t x, int16_t y, int16_t w, int16_t h,
+                               const uint16_t *windowPixels, uint16_t stride) {
+  windowWriter(x, y, w, h, windowPixels, stride);
+}
+
+/*******************************************************
+ ****************** Drawing Routines *******************
+ ******************************************************/
+
+// Draws one pixel.
+void displayBuffer_drawPixel(int16_t x0, int16_t y0, uint16_t color) {
+  if (x0 < 0 || y0 < 0 || x0 >= DISPLAY_WIDTH || y0 >= DISPLAY_HEIGHT)
+    return;
+  pixels[y0][x0] = color;
+  dirtyTiles[y0 / DISPLAY_BUFFER_TILE_SIZE] |=
+      (uint32_t)1 << (x0 / DISPLAY_BUFFER_TILE_SIZE);
+}
+
+// Fills a rectangle, everything else that draws more than a pixel ends up
+// here.
+void displayBuffer_fillRect(int16_t x, int16_t y, int16_t w, int16_t h,
+                            uint16_t color) {
+  if (!displayBuffer_clip(&x, &y, &w, &h))
+    return;
+  for (int16_t row = y; row < y + h; row++) {
+    uint16_t *line = &pixels[row][x];
+    for (int16_t column = 0; column < w; column++)
+      line[column] = color;
+  }
+  displayBuffer_markTiles(x, y, w, h);
+}
+
+// Draws a line with Bresenham's algorithm.
+void displayBuffer_drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1,
+                            uint16_t color) {
+  int16_t temp;
+  bool steep = abs(y1 - y0) > abs(x1 - x0);
+  if (steep) {
+    temp = x0, x0 = y0, y0 = temp;
+    temp = x1, x1 = y1, y1 = temp;
+  }
+  if (x0 > x1) {
+    temp = x0, x0 = x1, x1 = temp;
+    temp = y0, y0 = y1, y1 = temp;
+  }
+  int16_t dx = x1 - x0;
+  int16_t dy = abs(y1 - y0);
+  int16_t err = dx / 2;
+  int16_t yStep = y0 < y1 ? 1 : -1;
+  for (; x0 <= x1; x0++) {
+    if (steep)
+      displayBuffer_drawPixel(y0, x0, color);
+    else
+      displayBuffer_drawPixel(x0, y0, color);
+    err -= dy;
+    if (err < 0) {
+      y0 += yStep;
+      err += dx;
+    }
+  }
+}
+
+// Draws a vertical line h pixels long, down from (x, y).
+void displayBuffer_drawFastVLine(int16_t x, int16_t y, int16_t h,
+                                 uint16_t color) {
+  displayBuffer_fillRect(x, y, 1, h, color);
+}
+
+// Draws a horizontal line w pixels long, right from (x, y).
+void displayBuffer_drawFastHLine(int16_t x, int16_t y, int16_t w,
+                                 uint16_t color) {
+  displayBuffer_fillRect(x, y, w, 1, color);
+}
+
+// Draws the outline of a rectangle.
+void displayBuffer_drawRect(int16_t x, int16_t y, int16_t w, int16_t h,
+                            uint16_t color) {
+  displayBuffer_drawFastHLine(x, y, w, color);
+  displayBuffer_drawFastHLine(x, y + h - 1, w, color);
+  displayBuffer_drawFastVLine(x, y, h, color);
+  displayBuffer_drawFastVLine(x + w - 1, y, h, color);
+}
+
+// Fills the whole display.
+void displayBuffer_fillScreen(uint16_t color) {
+  displayBuffer_fillRect(0, 0, DISPLAY_WIDTH, DISPLAY_HEIGHT, color);
+}
+
+// Draws the corners of a circle picked by cornerMask.
+static void displayBuffer_drawCircleHelper(int16_t x0, int16_t y0, int16_t r,
+                                           uint8_t cornerMask,
+                                           uint16_t color) {
+  int16_t f = 1 - r;
+  int16_t ddFx = 1;
+  int16_t ddFy = -2 * r;
+  int16_t x = 0;
+  int16_t y = r;
+  while (x < y) {
+    if (f >= 0) {
+      y--;
+      ddFy += 2;
+      f += ddFy;
+    }
+    x++;
+    ddFx += 2;
+    f += ddFx;
+    if (cornerMask & DISPLAY_BUFFER_CORNER_LOWER_RIGHT) {
+      displayBuffer_drawPixel(x0 + x, y0 + y, color);
+      displayBuffer_drawPixel(x0 + y, y0 + x, color);
+    }
+    if (cornerMask & DISPLAY_BUFFER_CORNER_UPPER_RIGHT) {
+      displayBuffer_drawPixel(x0 + x, y0 - y, color);
+      displayBuffer_drawPixel(x0 + y, y0 - x, color);
+    }
+    if (cornerMask & DISPLAY_BUFFER_CORNER_LOWER_LEFT) {
+      displayBuffer_drawPixel(x0 - y, y0 + x, color);
+      displayBuffer_drawPixel(x0 - x, y0 + y, color);
+    }
+    if (cornerMask & DISPLAY_BUFFER_CORNER_UPPER_LEFT) {
+      displayBuffer_drawPixel(x0 - y, y0 - x, color);
+      displayBuffer_drawPixel(x0 - x, y0 - y, color);
+    }
+  }
+}
+
+// Fills the right (DISPLAY_BUFFER_CORNER_UPPER_LEFT) and/or left
+// (DISPLAY_BUFFER_CORNER_UPPER_RIGHT) half of a circle with vertical lines,
+// stretched down by delta pixels. The bit names follow Adafruit_GFX.
+static void displayBuffer_fillCircleHelper(int16_t x0, int16_t y0, int16_t r,
+                                           uint8_t cornerMask, int16_t delta,
+                                           uint16_t color) {
+  int16_t f = 1 - r;
+  int16_t ddFx = 1;
+  int16_t ddFy = -2 * r;
+  int16_t x = 0;
+  int16_t y = r;
+  while (x < y) {
+    if (f >= 0) {
+      y--;
+      ddFy += 2;
+      f += ddFy;
+    }
+    x++;
+    ddFx += 2;
+    f += ddFx;
+    if (cornerMask & DISPLAY_BUFFER_CORNER_UPPER_LEFT) {
+      displayBuffer_drawFastVLine(x0 + x, y0 - y, 2 * y + 1 + delta, color);
+      displayBuffer_drawFastVLine(x0 + y, y0 - x, 2 * x + 1 + delta, color);
+    }
+    if (cornerMask & DISPLAY_BUFFER_CORNER_UPPER_RIGHT) {
+      displayBuffer_drawFastVLine(x0 - x, y0 - y, 2 * y + 1 + delta, color);
+      displayBuffer_drawFastVLine(x0 - y, y0 - x, 2 * x + 1 + delta, color);
+    }
+  }
+}
+
+// Draws the outline of a circle.
+void displayBuffer_drawCircle(int16_t x0, int16_t y0, int16_t r,
+                              uint16_t color) {
+  displayBuffer_drawPixel(x0, y0 + r, color);
+  displayBuffer_drawPixel(x0, y0 - r, color);
+  displayBuffer_drawPixel(x0 + r, y0, color);
+  displayBuffer_drawPixel(x0 - r, y0, color);
+  displayBuffer_drawCircleHelper(x0, y0, r,
+                                 DISPLAY_BUFFER_CORNER_UPPER_LEFT |
+                                     DISPLAY_BUFFER_CORNER_UPPER_RIGHT |
+                                     DISPLAY_BUFFER_CORNER_LOWER_RIGHT |
+                                     DISPLAY_BUFFER_CORNER_LOWER_LEFT,
+                                 color);
+}
+
+// Fills a circle.
+void displayBuffer_fillCircle(int16_t x0, int16_t y0, int16_t r,
+                              uint16_t color) {
+  displayBuffer_drawFastVLine(x0, y0 - r, 2 * r + 1, color);
+  displayBuffer_fillCircleHelper(x0, y0, r,
+                                 DISPLAY_BUFFER_CORNER_UPPER_LEFT |
+                                     DISPLAY_BUFFER_CORNER_UPPER_RIGHT,
+                                 0, color);
+}
+
+// Draws the outline of a triangle.
+void displayBuffer_drawTriangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1,
+                                int16_t x2, int16_t y2, uint16_t color) {
+  displayBuffer_drawLine(x0, y0, x1, y1, color);
+  displayBuffer_drawLine(x1, y1, x2, y2, color);
+  displayBuffer_drawLine(x2, y2, x0, y0, color);
+}
+
+// Fills a triangle a horizontal line at a time, top to bottom.
+void displayBuffer_fillTriangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1,
+                                int16_t x2, int16_t y2, uint16_t color) {
+  int16_t temp;
+  // Sort the corners by y, y0 <= y1 <= y2.
+  if (y0 > y1) {
+    temp = y0, y0 = y1, y1 = temp;
+    temp = x0, x0 = x1, x1 = temp;
+  }
+  if (y1 > y2) {
+    temp = y2, y2 = y1, y1 = temp;
+    temp = x2, x2 = x1, x1 = temp;
+  }
+  if (y0 > y1) {
+    temp = y0, y0 = y1, y1 = temp;
+    temp = x0, x0 = x1, x1 = temp;
+  }
+  int16_t a, b;
+  if (y0 == y2) { // All on one line.
+    a = b = x0;
+    if (x1 < a)
+      a = x1;
+    else if (x1 > b)
+      b = x1;
+    if (x2 < a)
+      a = x2;
+    else if (x2 > b)
+      b = x2;
+    displayBuffer_drawFastHLine(a, y0, b - a + 1, color);
+    return;
+  }
+  int16_t dx01 = x1 - x0;
+  int16_t dy01 = y1 - y0;
+  int16_t dx02 = x2 - x0;
+  int16_t dy02 = y2 - y0;
+  int16_t dx12 = x2 - x1;
+  int16_t dy12 = y2 - y1;
+  int32_t sa = 0;
+  int32_t sb = 0;
+  // The upper part, from y0 to y1 (included if the bottom is flat).
+  int16_t last = y1 == y2 ? y1 : y1 - 1;
+  int16_t y;
+  for (y = y0; y <= last; y++) {
+    a = x0 + sa / dy01;
+    b = x0 + sb / dy02;
+    sa += dx01;
+    sb += dx02;
+    if (a > b)
+      temp = a, a = b, b = temp;
+    displayBuffer_drawFastHLine(a, y, b - a + 1, color);
+  }
+  // The lower part, from y1 to y2.
+  sa = (int32_t)dx12 * (y - y1);
+  sb = (int32_t)dx02 * (y - y0);
+  for (; y <= y2; y++) {
+    a = x1 + sa / dy12;
+    b = x0 + sb / dy02;
+    sa += dx12;
+    sb += dx02;
+    if (a > b)
+      temp = a, a = b, b = temp;
+    displayBuffer_drawFastHLine(a, y, b - a + 1, color);
+  }
+}
+
+// Draws the outline of a rectangle with rounded corners.
+void displayBuffer_drawRoundRect(int16_t x0, int16_t y0, int16_t w, int16_t h,
+                                 int16_t radius, uint16_t color) {
+  displayBuffer_drawFastHLine(x0 + radius, y0, w - 2 * radius, color);
+  displayBuffer_drawFastHLine(x0 + radius, y0 + h - 1, w - 2 * radius, color);
+  displayBuffer_drawFastVLine(x0, y0 + radius, h - 2 * radius, color);
+  displayBuffer_drawFastVLine(x0 + w - 1, y0 + radius, h - 2 * radius, color);
+  displayBuffer_drawCircleHelper(x0 + radius, y0 + radius, radius,
+                                 DISPLAY_BUFFER_CORNER_UPPER_LEFT, color);
+  displayBuffer_drawCircleHelper(x0 + w - radius - 1, y0 + radius, radius,
+                                 DISPLAY_BUFFER_CORNER_UPPER_RIGHT, color);
+  displayBuffer_drawCircleHelper(x0 + w - radius - 1, y0 + h - radius - 1,
+                                 radius, DISPLAY_BUFFER_CORNER_LOWER_RIGHT,
+                                 color);
+  displayBuffer_drawCircleHelper(x0 + radius, y0 + h - radius - 1, radius,
+                                 DISPLAY_BUFFER_CORNER_LOWER_LEFT, color);
+}
+
+// Fills a rectangle with rounded corners.
+void displayBuffer_fillRoundRect(int16_t x0, int16_t y0, int16_t w, int16_t h,
+                                 int16_t radius, uint16_t color) {
+  displayBuffer_fillRect(x0 + radius, y0, w - 2 * radius, h, color);
+  displayBuffer_fillCircleHelper(x0 + w - radius - 1, y0 + radius, radius,
+                                 DISPLAY_BUFFER_CORNER_UPPER_LEFT,
+                                 h - 2 * radius - 1, color);
+  displayBuffer_fillCircleHelper(x0 + radius, y0 + radius, radius,
+                                 DISPLAY_BUFFER_CORNER_UPPER_RIGHT,
+                                 h - 2 * radius - 1, color);
+}
+
+// Draws the set bits of a bitmap, rows of whole bytes, most significant bit
+// first.
+void displayBuffer_drawBitmap(int16_t x, int16_t y, const uint8_t *bitmap,
+                              int16_t w, int16_t h, uint16_t color) {
+  int16_t byteWidth = (w + 7) / 8;
+  for (int16_t j = 0; j < h; j++) {
+    for (int16_t i = 0; i < w; i++) {
+      if (bitmap[j * byteWidth + i / 8] & (0x80 >> (i & 7)))
+        displayBuffer_drawPixel(x + i, y + j, color);
+    }
+  }
+}
+
+// Draws a character scaled by size. The background is only drawn if bg is
+// not color, then the glyph comes from the glyph cache.
+void displayBuffer_drawChar(int16_t x, int16_t y, unsigned char c,
+                            uint16_t color, uint16_t bg, uint8_t size) {
+  if (bg != color && size <= DISPLAY_GLYPH_CACHE_MAX_SIZE) {
+    displayGlyphCache_drawChar(x, y, c, color, bg, size);
+    return;
+  }
+  if (x >= DISPLAY_WIDTH || y >= DISPLAY_HEIGHT ||
+      x + DISPLAY_CHAR_WIDTH * size - 1 < 0 ||
+      y + DISPLAY_CHAR_HEIGHT * size - 1 < 0)
+    return;
+  for (int16_t i = 0; i < DISPLAY_CHAR_WIDTH; i++) {
+    uint8_t line = i < DISPLAY_FONT_GLYPH_WIDTH
+                       ? displayFont_glyphs[c * DISPLAY_FONT_GLYPH_WIDTH + i]
+                       : 0;
+    for (int16_t j = 0; j < DISPLAY_CHAR_HEIGHT; j++, line >>= 1) {
+      if (line & 0x1)
+        displayBuffer_fillRect(x + i * size, y + j * size, size, size, color);
+      else if (bg != color)
+        displayBuffer_fillRect(x + i * size, y + j * size, size, size, bg);
+    }
+  }
+}
+
+// Sets where the print routines draw next.
+void displayBuffer_setCursor(int16_t x, int16_t y) {
+  cursorX = x;
+  cursorY = y;
+}
+
+// Sets the text color with no background.
+void displayBuffer_setTextColor(uint16_t c) {
+  textColor = c;
+  textBgColor = c;
+}
+
+// Sets the text and background colors.
+void displayBuffer_setTextColorBg(uint16_t c, uint16_t bg) {
+  textColor = c;
+  textBgColor = bg;
+}
+
+// Sets the text size, 0 is the same as 1.
+void displayBuffer_setTextSize(uint8_t s) { textSize = s > 0 ? s : 1; }
+
+// Sets whether the print routines go to the next line at the right edge.
+void displayBuffer_setTextWrap(bool w) { textWrapFlag = w; }
+
+/*******************************************************
+ ******************* Print Routines ********************
+ ******************************************************/
+
+// Prints one character at the cursor and moves it, as Adafruit_GFX::write().
+size_t displayBuffer_printChar(char c) {
+  if (c == '\n') {
+    cursorY += textSize * DISPLAY_CHAR_HEIGHT;
+    cursorX = 0;
+  } else if (c != '\r') {
+    displayBuffer_drawChar(cursorX, cursorY, c, textColor, textBgColor,
+                           textSize);
+    cursorX += textSize * DISPLAY_CHAR_WIDTH;
+    if (textWrapFlag &&
+        cursorX > DISPLAY_WIDTH - textSize * DISPLAY_CHAR_WIDTH) {
+      cursorY += textSize * DISPLAY_CHAR_HEIGHT;
+      cursorX = 0;
+    }
+  }
+  return 1;
+}
+
+// Prints a string, returns the number of characters.
+size_t displayBuffer_print(const char str[]) {
+  size_t count = 0;
+  while (str[count] != '\0')
+    displayBuffer_printChar(str[count++]);
+  return count;
+}
+
+// Prints a number in decimal.
+size_t displayBuffer_printDecimalInt(int num) {
+  char buffer[DISPLAY_BUFFER_DECIMAL_INT_MAX_CHARS];
+  sprintf(buffer, "%d", num);
+  return displayBuffer_print(buffer);
+}
+
+// The println routines end the line with "\r\n", as Arduino's Print does.
+size_t displayBuffer_println(const char str[]) {
+  return displayBuffer_print(str) + displayBuffer_print("\r\n");
+}
+
+size_t displayBuffer_printlnChar(char c) {
+  return displayBuffer_printChar(c) + displayBuffer_print("\r\n");
+}
+
+size_t displayBuffer_printlnDecimalInt(int num) {
+  return displayBuffer_printDecimalInt(num) + displayBuffer_print("\r\n");
+}
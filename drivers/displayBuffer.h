@@ -0,0 +1,121 @@
+/*
+This software is provided for student assignment use in the Department of
+Electrical and Computer Engineering, Brigham Young University, Utah, USA.
+
+Users agree to not re-host, or redistribute the software, in source or binary
+form, to other persons or other institutions. Users may modify and use the
+source code for personal or educational use.
+
+For questions, contact Brad Hutchings or Jeff Goeders, https://ece.byu.edu/
+*/
+
+#ifndef DISPLAYBUFFER
+#define DISPLAYBUFFER
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "display.h"
+
+// An off-screen copy of the display. The drawing functions here are the same
+// as the display_* ones (and draw the same pixels, they follow Adafruit_GFX),
+// but they draw into a DISPLAY_WIDTH x DISPLAY_HEIGHT RGB565 framebuffer in
+// RAM and only mark the DISPLAY_BUFFER_TILE_SIZE square tiles they touch as
+// dirty. Nothing reaches the LCD until displayBuffer_flush(), which writes each
+// run of dirty tiles as one window. Erase-then-draw and overlapping shapes cost
+// nothing on the bus, only the final pixels are written, once per flush.
+//
+// Define DISPLAY_USE_FRAMEBUFFER in display.h to have the display_* drawing
+// and text functions call these instead, then call display_flush() at the
+// end of each frame. Link the displayBuffer library.
+//
+// The framebuffer is always landscape with the origin at the upper left, the
+// rotation display_init() sets. Touch, display_setRotation() and
+// display_invertDisplay() still go to the display.
+
+#define DISPLAY_BUFFER_TILE_SIZE 16
+#define DISPLAY_BUFFER_TILE_COLUMNS (DISPLAY_WIDTH / DISPLAY_BUFFER_TILE_SIZE)
+#define DISPLAY_BUFFER_TILE_ROWS (DISPLAY_HEIGHT / DISPLAY_BUFFER_TILE_SIZE)
+
+// Writes the w x h window at (x, y) to the display. pixels is its upper left
+// pixel, rows are stride pixels apart.
+typedef void (*displayBuffer_windowWriter_t)(int16_t x, int16_t y, int16_t w,
+                                             int16_t h,
+                                             const uint16_t *pixels,
+                                             uint16_t stride);
+
+// Calls display_init(), then clears the framebuffer to DISPLAY_BLACK and marks
+// all of it dirty, so the first flush clears the screen.
+void displayBuffer_init();
+
+// Writes every dirty tile to the display and marks them clean. Adjacent dirty
+// tiles in a tile row are written as one window, and a window is extended
+// down while the tile rows below are dirty over the same columns. Returns the
+// number of pixels written.
+uint32_t displayBuffer_flush();
+
+// Sets the function flush uses to write a window. The display library has no
+// C call that writes a block of pixels, so the default writer sends each run
+// of equal pixels (across identical rows) as one display_fillRect(). A board
+// with a faster way to write a window can plug it in here, from its
+// display_init() if it likes. NULL restores the default.
+void displayBuffer_setWindowWriter(displayBuffer_windowWriter_t writer);
+
+// Writes a window straight to the display with the window writer, for code
+// that has whole blocks of pixels to draw without the framebuffer. The
+// window must be on the display. The framebuffer doesn't see it.
+void displayBuffer_writeWindow(int16_t x, int16_t y, int16_t w, int16_t h,
+                               const uint16_t *windowPixels, uint16_t stride);
+
+// Marks the w x h rectangle at (x, y) dirty, so the next flush rewrites it.
+void displayBuffer_markDirty(int16_t x, int16_t y, int16_t w, int16_t h);
+
+// Returns the framebuffer, DISPLAY_WIDTH pixels per row. Mark anything written
+// to it directly with displayBuffer_markDirty().
+uint16_t *displayBuffer_getPixels();
+
+// The same as the display_* functions with these names.
+void displayBuffer_drawPixel(int16_t x0, int16_t y0, uint16_t color);
+void displayBuffer_drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1,
+                            uint16_t color);
+void displayBuffer_drawFastVLine(int16_t x, int16_t y, int16_t h,
+                                 uint16_t color);
+void displayBuffer_drawFastHLine(int16_t x, int16_t y, int16_t w,
+                                 uint16_t color);
+void displayBuffer_drawRect(int16_t x, int16_t y, int16_t w, int16_t h,
+                            uint16_t color);
+void displayBuffer_fillRect(int16_t x, int16_t y, int16_t w, int16_t h,
+                            uint16_t color);
+void displayBuffer_fillScreen(uint16_t color);
+void displayBuffer_drawCircle(int16_t x0, int16_t y0, int16_t r,
+                              uint16_t color);
+void displayBuffer_fillCircle(int16_t x0, int16_t y0, int16_t r,
+                              uint16_t color);
+void displayBuffer_drawTriangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1,
+                                int16_t x2, int16_t y2, uint16_t color);
+void displayBuffer_fillTriangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1,
+                                int16_t x2, int16_t y2, uint16_t color);
+void displayBuffer_drawRoundRect(int16_t x0, int16_t y0, int16_t w, int16_t h,
+                                 int16_t radius, uint16_t color);
+void displayBuffer_fillRoundRect(int16_t x0, int16_t y0, int16_t w, int16_t h,
+                                 int16_t radius, uint16_t color);
+void displayBuffer_drawBitmap(int16_t x, int16_t y, const uint8_t *bitmap,
+                              int16_t w, int16_t h, uint16_t color);
+void displayBuffer_drawChar(int16_t x, int16_t y, unsigned char c,
+                            uint16_t color, uint16_t bg, uint8_t size);
+void displayBuffer_setCursor(int16_t x, int16_t y);
+void displayBuffer_setTextColor(uint16_t c);
+void displayBuffer_setTextColorBg(uint16_t c, uint16_t bg);
+void displayBuffer_setTextSize(uint8_t s);
+void displayBuffer_setTextWrap(bool w);
+
+// Print routines.
+size_t displayBuffer_println(const char str[]);
+size_t displayBuffer_printlnChar(char c);
+size_t displayBuffer_printlnDecimalInt(int num);
+size_t displayBuffer_print(const char str[]);
+size_t displayBuffer_printChar(char c);
+size_t displayBuffer_printDecimalInt(int num);
+
+#endif /* DISPLAYBUFFER */
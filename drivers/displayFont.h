@@ -0,0 +1,29 @@
+/*
+This software is provided for student assignment use in the Department of
+Electrical and Computer Engineering, Brigham Young University, Utah, USA.
+
+Users agree to not re-host, or redistribute the software, in source or binary
+form, to other persons or other institutions. Users may modify and use the
+source code for personal or educational use.
+
+For questions, contact Brad Hutchings or Jeff Goeders, https://ece.byu.edu/
+*/
+
+#ifndef DISPLAYFONT
+#define DISPLAYFONT
+
+#include <stdint.h>
+
+// The font display_drawChar() uses, for code that draws text itself. Each
+// character is DISPLAY_FONT_GLYPH_WIDTH column bytes, the least significant
+// bit is the top row. Characters are DISPLAY_CHAR_WIDTH wide on the display,
+// the last column is always blank.
+
+#define DISPLAY_FONT_CHAR_COUNT 256
+#define DISPLAY_FONT_GLYPH_WIDTH 5
+#define DISPLAY_FONT_GLYPH_HEIGHT 8
+
+extern const uint8_t
+    displayFont_glyphs[DISPLAY_FONT_CHAR_COUNT * DISPLAY_FONT_GLYPH_WIDTH];
+
+#endif /* DISPLAYFONT */
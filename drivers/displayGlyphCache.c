@@ -0,0 +1,135 @@
+/*
+This software is provided for student assignment use in the Department of
+Electrical and Computer Engineering, Brigham Young University, Utah, USA.
+
+Users agree to not re-host, or redistribute the software, in source or binary
+form, to other persons or other institutions. Users may modify and use the
+source code for personal or educational use.
+
+For questions, contact Brad Hutchings or Jeff Goeders, https://ece.byu.edu/
+*/
+
+#include <stdbool.h>
+#include <string.h>
+
+#include "display.h"
+#include "displayBuffer.h"
+#include "displayFont.h"
+#include "displayGlyphCache.h"
+
+#define DISPLAY_GLYPH_CACHE_MAX_PIXEL_COUNT                                    \
+  (DISPLAY_CHAR_WIDTH * DISPLAY_CHAR_HEIGHT * DISPLAY_GLYPH_CACHE_MAX_SIZE *   \
+   DISPLAY_GLYPH_CACHE_MAX_SIZE)
+
+typedef struct {
+  uint64_t key;     // See displayGlyphCache_getKey(), 0 for an empty slot.
+  uint32_t lastUse; // The useCount when it was last drawn.
+  // DISPLAY_CHAR_HEIGHT * size rows of DISPLAY_CHAR_WIDTH * size pixels.
+  uint16_t pixels[DISPLAY_GLYPH_CACHE_MAX_PIXEL_COUNT];
+} displayGlyphCache_slot_t;
+
+static displayGlyphCache_slot_t slots[DISPLAY_GLYPH_CACHE_SLOT_COUNT];
+static uint32_t useCount;
+static uint32_t hitCount;
+static uint32_t missCount;
+
+// Empties the cache and zeroes the counts.
+void displayGlyphCache_init() {
+  for (uint16_t i = 0; i < DISPLAY_GLYPH_CACHE_SLOT_COUNT; i++) {
+    slots[i].key = 0;
+    slots[i].lastUse = 0;
+  }
+  useCount = 0;
+  hitCount = 0;
+  missCount = 0;
+}
+
+// Packs what a glyph looks like into one number. Never 0, size is at least 1.
+static uint64_t displayGlyphCache_getKey(unsigned char c, uint16_t color,
+                                         uint16_t bg, uint8_t size) {
+  return (uint64_t)size << 48 | (uint64_t)c << 32 | (uint32_t)color << 16 | bg;
+}
+
+// Expands c into the slot's pixels.
+static void displayGlyphCache_render(displayGlyphCache_slot_t *slot,
+                                     unsigned char c, uint16_t color,
+                                     uint16_t bg, uint8_t size) {
+  int16_t w = DISPLAY_CHAR_WIDTH * size;
+  const uint8_t *glyph = &displayFont_glyphs[c * DISPLAY_FONT_GLYPH_WIDTH];
+  for (int16_t j = 0; j < DISPLAY_CHAR_HEIGHT; j++) {
+    uint16_t *row = &slot->pixels[j * size * w];
+    for (int16_t i = 0; i < w; i++) {
+      int16_t column = i / size;
+      bool set = column < DISPLAY_FONT_GLYPH_WIDTH && (glyph[column] >> j) & 1;
+      row[i] = set ? color : bg;
+    }
+    // The other rows of a scaled font row are the same.
+    for (int16_t k = 1; k < size; k++)
+      memcpy(row + k * w, row, w * sizeof(uint16_t));
+  }
+}
+
+// Returns the pixels of a glyph, rendering it into the least recently used
+// slot if it isn't in the cache.
+static const uint16_t *displayGlyphCache_getGlyph(unsigned char c,
+                                                  uint16_t color, uint16_t bg,
+                                                  uint8_t size) {
+  uint64_t key = displayGlyphCache_getKey(c, color, bg, size);
+  displayGlyphCache_slot_t *oldest = &slots[0];
+  for (uint16_t i = 0; i < DISPLAY_GLYPH_CACHE_SLOT_COUNT; i++) {
+    if (slots[i].key == key) {
+      hitCount++;
+      slots[i].lastUse = ++useCount;
+      return slots[i].pixels;
+    }
+    if (slots[i].lastUse < oldest->lastUse)
+      oldest = &slots[i];
+  }
+  missCount++;
+  displayGlyphCache_render(oldest, c, color, bg, size);
+  oldest->key = key;
+  oldest->lastUse = ++useCount;
+  return oldest->pixels;
+}
+
+// Draws c with its background from the cache.
+void displayGlyphCache_drawChar(int16_t x, int16_t y, unsigned char c,
+                                uint16_t color, uint16_t bg, uint8_t size) {
+  if (size == 0)
+    return; // Nothing to draw, the same as display_drawChar().
+  if (size > DISPLAY_GLYPH_CACHE_MAX_SIZE || bg == color) {
+    display_drawChar(x, y, c, color, bg, size);
+    return;
+  }
+  int16_t w = DISPLAY_CHAR_WIDTH * size;
+  int16_t h = DISPLAY_CHAR_HEIGHT * size;
+#ifdef DISPLAY_USE_FRAMEBUFFER
+  // Copy the part that is on the display.
+  int16_t left = x < 0 ? -x : 0;
+  int16_t top = y < 0 ? -y : 0;
+  int16_t right = x + w > DISPLAY_WIDTH ? DISPLAY_WIDTH - x : w;
+  int16_t bottom = y + h > DISPLAY_HEIGHT ? DISPLAY_HEIGHT - y : h;
+  if (left >= right || top >= bottom)
+    return;
+  const uint16_t *glyph = displayGlyphCache_getGlyph(c, color, bg, size);
+  uint16_t *pixels = displayBuffer_getPixels();
+  for (int16_t j = top; j < bottom; j++)
+    memcpy(&pixels[(y + j) * DISPLAY_WIDTH + x + left], &glyph[j * w + left],
+           (right - left) * sizeof(uint16_t));
+  displayBuffer_markDirty(x, y, w, h);
+#else
+  // A window has to be on the display, let the library clip the rest.
+  if (x < 0 || y < 0 || x + w > DISPLAY_WIDTH || y + h > DISPLAY_HEIGHT) {
+    display_drawChar(x, y, c, color, bg, size);
+    return;
+  }
+  displayBuffer_writeWindow(x, y, w, h,
+                            displayGlyphCache_getGlyph(c, color, bg, size), w);
+#endif
+}
+
+// Returns the number of characters drawn from the cache.
+uint32_t displayGlyphCache_getHitCount() { return hitCount; }
+
+// Returns the number of glyphs rendered into the cache.
+uint32_t displayGlyphCache_getMissCount() { return missCount; }
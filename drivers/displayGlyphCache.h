@@ -0,0 +1,49 @@
+/*
+This software is provided for student assignment use in the Department of
+Electrical and Computer Engineering, Brigham Young University, Utah, USA.
+
+Users agree to not re-host, or redistribute the software, in source or binary
+form, to other persons or other institutions. Users may modify and use the
+source code for personal or educational use.
+
+For questions, contact Brad Hutchings or Jeff Goeders, https://ece.byu.edu/
+*/
+
+#ifndef DISPLAYGLYPHCACHE
+#define DISPLAYGLYPHCACHE
+
+#include <stdint.h>
+
+// Draws characters from a cache of pre-rendered glyphs. The first time a
+// character is drawn with a size, color and background, its whole
+// DISPLAY_CHAR_WIDTH x DISPLAY_CHAR_HEIGHT cell is expanded into an RGB565
+// block. After that drawing it is one window write (see displayBuffer.h), or
+// a copy into the framebuffer with DISPLAY_USE_FRAMEBUFFER, instead of a
+// display_fillRect() per font pixel. The background is part of the block, so
+// drawing a character over the old one also erases it, nothing has to be
+// erased first.
+//
+// The cache holds DISPLAY_GLYPH_CACHE_SLOT_COUNT glyphs, the least recently
+// drawn one is replaced when it is full. Only sizes up to
+// DISPLAY_GLYPH_CACHE_MAX_SIZE are cached, anything bigger is drawn with
+// display_drawChar().
+
+#define DISPLAY_GLYPH_CACHE_SLOT_COUNT 32
+#define DISPLAY_GLYPH_CACHE_MAX_SIZE 6
+
+// Empties the cache and zeroes the counts.
+void displayGlyphCache_init();
+
+// Draws c at (x, y) the same as display_drawChar() with bg different from
+// color: the whole cell, scaled by size. If bg is color only the character is
+// drawn, with display_drawChar().
+void displayGlyphCache_drawChar(int16_t x, int16_t y, unsigned char c,
+                                uint16_t color, uint16_t bg, uint8_t size);
+
+// Returns the number of characters drawn from the cache.
+uint32_t displayGlyphCache_getHitCount();
+
+// Returns the number of glyphs rendered into the cache.
+uint32_t displayGlyphCache_getMissCount();
+
+#endif /* DISPLAYGLYPHCACHE */
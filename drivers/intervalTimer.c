@@ -15,29 +15,36 @@
 // address map of TCSR0
 // bit 31-12 reserved
 // bit 11 CASC  <- 1 enable cascade, 0 disable cascade
-// bit 10 ENALL - UNUSED
-// bit  9 PWMA0 - UNUSED
+// bit 10 ENALL <- 1 enable both timers at once (PWM)
+// bit  9 PWMA0 <- 1 enable pulse width modulation
 // bit  8 T0INT < - interupt status, write 1 to acknowledge interrupt
 // bit  7 ENT0  <- 1 enable timer, 0 disable timer
 // bit  6 ENIT0 <- 1 enable interrupts, 0 disable interrupts
 // bit  5 LOAD0 <- 1 load timer with value in TLR0, 0 no load
 // bit  4 ARHT0 <- 1 autoreload, 0 hold value
 // bit  3 CAPT0 - UNUSED
-// bit  2 GENT0 - UNUSED
+// bit  2 GENT0 <- 1 enable the generate output (PWM)
 // bit  1 UDT0  <-  1 counter acts as down counter, 0 counter acts as up counter
 // bit  0 MDT0 - UNUSED
 
 #define CASC 11
+#define ENALL 10
+#define PWMA 9
 #define T0INT 8
 #define ENT 7
 #define ENIT 6
 #define LOAD 5
 #define ARHT 4
+#define GENT 2
 #define UDT 1
 
 #define CLK_HZ 100000000.0
 #define UPPER_COUNTER_SHIFT_VAL 32
 
+// A down-counting timer in generate mode runs for 2 cycles more than its load
+// value, so the PWM load values are this much less than the wanted cycles.
+#define PWM_LOAD_CYCLE_OFFSET 2
+
 // Returns 32 bit value of register given register number
 // and an address offset value
 static uint32_t readRegister(uint8_t registerNum, uint32_t offset) {
@@ -223,3 +230,38 @@ void intervalTimer_disableInterrupt(uint8_t timerNumber) {
 void intervalTimer_ackInterrupt(uint8_t timerNumber) {
   writeBitOfRegister(timerNumber, T0INT, TCSR0_OFFSET, 1); // Clears interrupt
 }
+
+// Configures the timer to generate a PWM signal on its pwm0 output: counter 0
+// sets the period and counter 1 the high time, both counting down and
+// reloading. Cascade mode is off, both counters are needed separately.
+void intervalTimer_initPwm(uint32_t timerNumber, uint32_t periodCycles,
+                           uint32_t highCycles) {
+  uint32_t control = (1 << PWMA) | (1 << GENT) | (1 << ARHT) | (1 << UDT);
+  writeRegister(timerNumber, TCSR0_OFFSET, control);
+  writeRegister(timerNumber, TCSR1_OFFSET, control);
+  intervalTimer_setPwm(timerNumber, periodCycles, highCycles);
+  intervalTimer_reload(timerNumber);
+}
+
+// Changes the period and high time of a PWM timer. Only the load registers are
+// written, so a running timer picks them up when its counters next reload.
+void intervalTimer_setPwm(uint32_t timerNumber, uint32_t periodCycles,
+                          uint32_t highCycles) {
+  writeRegister(timerNumber, TLR0_OFFSET,
+                periodCycles - PWM_LOAD_CYCLE_OFFSET);
+  writeRegister(timerNumber, TLR1_OFFSET, highCycles - PWM_LOAD_CYCLE_OFFSET);
+}
+
+// Starts a PWM timer at the beginning of a period.
+void intervalTimer_startPwm(uint32_t timerNumber) {
+  intervalTimer_reload(timerNumber);
+  writeBitOfRegister(timerNumber, ENALL, TCSR0_OFFSET, 1); // Both counters.
+}
+
+// Stops a PWM timer, pwm0 stays low until it is started again. Clearing ENALL
+// doesn't stop the counters, each one is disabled on its own.
+void intervalTimer_stopPwm(uint32_t timerNumber) {
+  writeBitOfRegister(timerNumber, ENALL, TCSR0_OFFSET, 0);
+  writeBitOfRegister(timerNumber, ENT, TCSR0_OFFSET, 0);
+  writeBitOfRegister(timerNumber, ENT, TCSR1_OFFSET, 0);
+}
@@ -84,4 +84,23 @@ void intervalTimer_disableInterrupt(uint8_t timerNumber);
 // Acknowledge the rollover to clear the interrupt output.
 void intervalTimer_ackInterrupt(uint8_t timerNumber);
 
+// Configures the timer to generate a square wave or other PWM signal on its
+// pwm0 output, which the hardware design must route to a pin. The signal is
+// high for highCycles of every periodCycles cycles of the 100 MHz timer clock.
+// Both counters of the timer are used. The timer is left stopped.
+void intervalTimer_initPwm(uint32_t timerNumber, uint32_t periodCycles,
+                           uint32_t highCycles);
+
+// Changes the period and high time of a timer set up by
+// intervalTimer_initPwm(). If the timer is running the change takes effect at
+// the end of the current period.
+void intervalTimer_setPwm(uint32_t timerNumber, uint32_t periodCycles,
+                          uint32_t highCycles);
+
+// Starts generating the PWM signal, from the beginning of a period.
+void intervalTimer_startPwm(uint32_t timerNumber);
+
+// Stops generating the PWM signal, the pwm0 output stays low.
+void intervalTimer_stopPwm(uint32_t timerNumber);
+
 #endif /* INTERVALTIMER */
@@ -161,4 +161,47 @@ typedef struct {
 }
 #endif
 
+// Uncomment to draw into an off-screen framebuffer (see displayBuffer.h) and
+// only write what changed to the LCD when display_flush() is called. Link the
+// displayBuffer library.
+//#define DISPLAY_USE_FRAMEBUFFER
+
+#ifdef DISPLAY_USE_FRAMEBUFFER
+#include "displayBuffer.h"
+#ifndef DISPLAY_BUFFER_NO_REDIRECT
+#define display_init displayBuffer_init
+#define display_flush displayBuffer_flush
+#define display_drawPixel displayBuffer_drawPixel
+#define display_drawLine displayBuffer_drawLine
+#define display_drawFastVLine displayBuffer_drawFastVLine
+#define display_drawFastHLine displayBuffer_drawFastHLine
+#define display_drawRect displayBuffer_drawRect
+#define display_fillRect displayBuffer_fillRect
+#define display_fillScreen displayBuffer_fillScreen
+#define display_drawCircle displayBuffer_drawCircle
+#define display_fillCircle displayBuffer_fillCircle
+#define display_drawTriangle displayBuffer_drawTriangle
+#define display_fillTriangle displayBuffer_fillTriangle
+#define display_drawRoundRect displayBuffer_drawRoundRect
+#define display_fillRoundRect displayBuffer_fillRoundRect
+#define display_drawBitmap displayBuffer_drawBitmap
+#define display_drawChar displayBuffer_drawChar
+#define display_setCursor displayBuffer_setCursor
+#define display_setTextColor displayBuffer_setTextColor
+#define display_setTextColorBg displayBuffer_setTextColorBg
+#define display_setTextSize displayBuffer_setTextSize
+#define display_setTextWrap displayBuffer_setTextWrap
+#define display_println displayBuffer_println
+#define display_printlnChar displayBuffer_printlnChar
+#define display_printlnDecimalInt displayBuffer_printlnDecimalInt
+#define display_print displayBuffer_print
+#define display_printChar displayBuffer_printChar
+#define display_printDecimalInt displayBuffer_printDecimalInt
+#endif
+#else
+// Everything is already on the display. Call this at the end of each frame so
+// the code works either way.
+#define display_flush() ((void)0)
+#endif
+
 #endif /* DISPLAY */
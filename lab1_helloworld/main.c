@@ -56,6 +56,7 @@ int main() {
   // Draw Triangles
   display_fillTriangle(TRIANGLE_LEFT_BOUND, UPPER_TRIANGLE_UPPER_BOUND, TRIANGLE_RIGHT_BOUND, UPPER_TRIANGLE_UPPER_BOUND, HALF_WIDTH, UPPER_TRIANGLE_LOWER_BOUND , DISPLAY_YELLOW);
   display_drawTriangle(TRIANGLE_LEFT_BOUND, LOWER_TRIANGLE_LOWER_BOUND, TRIANGLE_RIGHT_BOUND, LOWER_TRIANGLE_LOWER_BOUND, HALF_WIDTH, LOWER_TRIANGLE_UPPER_BOUND, DISPLAY_YELLOW);
+  display_flush();
 
   return 0;
 }
@@ -88,6 +88,7 @@ void gpioTest_buttons() {
         // Only draw to the screen when a change is detected
         if (buttons != buttons_prev) {
             drawButtonBoxes(buttons);
+            display_flush();
         }
 
         buttons_prev = buttons;
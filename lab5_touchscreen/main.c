@@ -68,6 +68,7 @@ void test_tick() {
     touchscreen_ack_touch();
     break;
   }
+  display_flush();
 }
 
 // Interrupt service routine to run FSM ticks
@@ -91,6 +92,7 @@ int main() {
 
   // Fill screen black
   display_fillScreen(DISPLAY_BLACK);
+  display_flush();
 
   // Set up interrupts
   interrupts_register(INTERVAL_TIMER_0_INTERRUPT_IRQ, isr);
@@ -16,6 +16,7 @@ For questions, contact Brad Hutchings or Jeff Goeders, https://ece.byu.edu/
 #include <string.h>
 
 #include "display.h"
+#include "displayGlyphCache.h"
 #include "utils.h"
 
 // Startup with this time.
@@ -236,25 +237,20 @@ static void updateTimeDisplay(bool forceUpdateAll) {
     // Redraw any character that has changed.
     if (nextClockDisplayString[i] != currentClockDisplayString[i] ||
         forceUpdateAll) {
-      // First, erase the character by drawing as background.
-      display_drawChar(CLOCK_DISPLAY_ORIGIN_X +
-                           (i * DISPLAY_CHAR_WIDTH * CLOCKDISPLAY_TEXT_SIZE),
-                       CLOCK_DISPLAY_ORIGIN_Y, nextClockDisplayString[i],
-                       CLOCK_BACKGROUND_COLOR, CLOCK_BACKGROUND_COLOR,
-                       CLOCKDISPLAY_TEXT_SIZE);
-
-      // Now, draw the character by drawing as foreground.
-      display_drawChar(CLOCK_DISPLAY_ORIGIN_X +
-                           (i * DISPLAY_CHAR_WIDTH * CLOCKDISPLAY_TEXT_SIZE),
-                       CLOCK_DISPLAY_ORIGIN_Y, nextClockDisplayString[i],
-                       CLOCK_FOREGROUND_COLOR, CLOCK_BACKGROUND_COLOR,
-                       CLOCKDISPLAY_TEXT_SIZE);
+      // Draw the character with its background, which erases the old one.
+      displayGlyphCache_drawChar(
+          CLOCK_DISPLAY_ORIGIN_X +
+              (i * DISPLAY_CHAR_WIDTH * CLOCKDISPLAY_TEXT_SIZE),
+          CLOCK_DISPLAY_ORIGIN_Y, nextClockDisplayString[i],
+          CLOCK_FOREGROUND_COLOR, CLOCK_BACKGROUND_COLOR,
+          CLOCKDISPLAY_TEXT_SIZE);
 
       // Copy characters from the next string into the current string to prep
       // for next call.
       currentClockDisplayString[i] = nextClockDisplayString[i];
     }
   }
+  display_flush();
 }
 
 // Increments/decrement value, with given minValue and maxValue.
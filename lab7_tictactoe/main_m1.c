@@ -11,9 +11,11 @@ For questions, contact Brad Hutchings or Jeff Goeders, https://ece.byu.edu/
 
 #include <stdio.h>
 
+#include "minimaxBook.h"
 #include "testBoards.h"
 
 int main() {
   printf("Running testBoards()\n");
   testBoards();
+  minimaxBook_runTest();
 }
\ No newline at end of file
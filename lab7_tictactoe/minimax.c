@@ -1,4 +1,6 @@
 #include "minimax.h"
+#include "minimaxBitboard.h"
+#include "minimaxBook.h"
 #include "ticTacToe.h"
 #include <stdio.h>
 
@@ -32,6 +34,9 @@
 
 static tictactoe_location_t choice;
 
+// Number of boards visited by the last minimax_searchNextMove().
+static uint32_t node_count;
+
 // Stores the score table and move table for an iteration
 typedef struct {
   tictactoe_location_t move_table[NUM_POSSIBLE_LOCATIONS];
@@ -230,6 +235,7 @@ minimax_score_t minimax(tictactoe_board_t *board, bool is_Xs_turn,
   int8_t score;
   board_table_t board_table;
   minimax_initializeBoardTable(&board_table);
+  ++node_count;
 
   // Check if game is over. If so return score
   if (minimax_isGameOver(minimax_computeBoardScore(board, is_Xs_turn))) {
@@ -297,6 +303,24 @@ minimax_score_t minimax(tictactoe_board_t *board, bool is_Xs_turn,
 // (helper) function.
 tictactoe_location_t minimax_computeNextMove(tictactoe_board_t *board,
                                              bool is_Xs_turn) {
+  // Every reachable board is in the book, so this only searches for boards
+  // that can't come up in a real game. The bitboard engine picks the same
+  // moves as minimax() with a fraction of the work.
+  tictactoe_location_t move;
+  if (minimaxBook_lookup(board, is_Xs_turn, &move)) {
+    return move;
+  }
+  return minimaxBitboard_computeNextMove(board, is_Xs_turn);
+}
+
+// Computes the next move by searching the whole game tree with minimax().
+// This is what the book was generated from.
+tictactoe_location_t minimax_searchNextMove(tictactoe_board_t *board,
+                                            bool is_Xs_turn) {
+  node_count = 0;
   minimax(board, is_Xs_turn, 0);
   return choice;
-}
\ No newline at end of file
+}
+
+// Returns the number of boards visited by the last minimax_searchNextMove().
+uint32_t minimax_getNodeCount() { return node_count; }
\ No newline at end of file
@@ -39,9 +39,20 @@ typedef int16_t minimax_score_t;
 // is_Xs_turn = false.
 // This function directly passes the  is_Xs_turn argument into the minimax()
 // (helper) function.
+// The move comes from the precomputed book (minimaxBook.h) when the board is
+// in it, which is every board reachable in a game, otherwise it is searched
+// with the bitboard engine (minimaxBitboard.h).
 tictactoe_location_t minimax_computeNextMove(tictactoe_board_t *board,
                                              bool is_Xs_turn);
 
+// Same as minimax_computeNextMove() but always searches the game tree with
+// minimax(), never using the book.
+tictactoe_location_t minimax_searchNextMove(tictactoe_board_t *board,
+                                            bool is_Xs_turn);
+
+// Returns the number of boards visited by the last minimax_searchNextMove().
+uint32_t minimax_getNodeCount();
+
 // Returns the score of the board.
 // This returns one of 4 values: MINIMAX_X_WINNING_SCORE,
 // MINIMAX_O_WINNING_SCORE, MINIMAX_DRAW_SCORE, MINIMAX_NOT_ENDGAME
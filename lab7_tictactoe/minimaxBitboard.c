@@ -0,0 +1,153 @@
+/*
+This software is provided for student assignment use in the Department of
+Electrical and Computer Engineering, Brigham Young University, Utah, USA.
+
+Users agree to not re-host, or redistribute the software, in source or binary
+form, to other persons or other institutions. Users may modify and use the
+source code for personal or educational use.
+
+For questions, contact Brad Hutchings or Jeff Goeders, https://ece.byu.edu/
+*/
+
+#include "minimaxBitboard.h"
+
+#define NUM_POSSIBLE_LOCATIONS 9 // The number of possible places on a board
+#define NUM_WIN_MASKS 8          // Three rows, Three columns, Two diagonals
+#define FULL_BOARD_MASK 0x1FF
+
+// Scores are always between these, so they work as -infinity and +infinity.
+#define SCORE_BELOW_MIN (MINIMAX_O_WINNING_SCORE - 1)
+#define SCORE_ABOVE_MAX (MINIMAX_X_WINNING_SCORE + 1)
+
+// Squares in each row, column and diagonal.
+static const minimaxBitboard_mask_t winMasks[NUM_WIN_MASKS] = {
+    0x007, 0x038, 0x1C0, // Rows.
+    0x049, 0x092, 0x124, // Columns.
+    0x111, 0x054};       // Top left to bottom right, top right to bottom left.
+
+// Order to try moves in below the top level: center, corners, then edges.
+// Good moves first means more cutoffs.
+static const uint8_t moveOrder[NUM_POSSIBLE_LOCATIONS] = {4, 0, 2, 6, 8,
+                                                          1, 3, 5, 7};
+
+static uint32_t nodeCount;
+
+// Converts board into X and O masks.
+void minimaxBitboard_fromBoard(tictactoe_board_t *board,
+                               minimaxBitboard_mask_t *xMask,
+                               minimaxBitboard_mask_t *oMask) {
+  *xMask = 0;
+  *oMask = 0;
+  for (uint8_t row = 0; row < TICTACTOE_BOARD_ROWS; ++row) {
+    for (uint8_t column = 0; column < TICTACTOE_BOARD_COLUMNS; ++column) {
+      minimaxBitboard_mask_t bit = 1 << (row * TICTACTOE_BOARD_COLUMNS + column);
+      if (board->squares[row][column] == MINIMAX_X_SQUARE) {
+        *xMask |= bit;
+      } else if (board->squares[row][column] == MINIMAX_O_SQUARE) {
+        *oMask |= bit;
+      }
+    }
+  }
+}
+
+// Returns true if the squares in mask include three in a row.
+bool minimaxBitboard_isWin(minimaxBitboard_mask_t mask) {
+  for (uint8_t i = 0; i < NUM_WIN_MASKS; ++i) {
+    if ((mask & winMasks[i]) == winMasks[i]) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Alpha-beta search. Returns the minimax() score of the board if it is
+// between alpha and beta, otherwise alpha (nothing better for X) or beta
+// (nothing better for O).
+static minimax_score_t minimaxBitboard_search(minimaxBitboard_mask_t xMask,
+                                              minimaxBitboard_mask_t oMask,
+                                              bool is_Xs_turn, uint8_t depth,
+                                              minimax_score_t alpha,
+                                              minimax_score_t beta) {
+  ++nodeCount;
+  // Same end-game checks, in the same order, as minimax_computeBoardScore().
+  if (minimaxBitboard_isWin(xMask)) {
+    return MINIMAX_X_WINNING_SCORE / depth;
+  }
+  if (minimaxBitboard_isWin(oMask)) {
+    return MINIMAX_O_WINNING_SCORE / depth;
+  }
+  minimaxBitboard_mask_t occupied = xMask | oMask;
+  if (occupied == FULL_BOARD_MASK) {
+    return MINIMAX_DRAW_SCORE;
+  }
+  for (uint8_t i = 0; i < NUM_POSSIBLE_LOCATIONS; ++i) {
+    minimaxBitboard_mask_t bit = 1 << moveOrder[i];
+    if (occupied & bit) {
+      continue;
+    }
+    if (is_Xs_turn) {
+      minimax_score_t score = minimaxBitboard_search(xMask | bit, oMask, false,
+                                                     depth + 1, alpha, beta);
+      if (score > alpha) {
+        alpha = score;
+      }
+    } else {
+      minimax_score_t score = minimaxBitboard_search(xMask, oMask | bit, true,
+                                                     depth + 1, alpha, beta);
+      if (score < beta) {
+        beta = score;
+      }
+    }
+    // The other player already has a better option elsewhere.
+    if (alpha >= beta) {
+      break;
+    }
+  }
+  return is_Xs_turn ? alpha : beta;
+}
+
+// Computes the next move for board, with the same arguments and result as
+// minimax_computeNextMove().
+tictactoe_location_t minimaxBitboard_computeNextMove(tictactoe_board_t *board,
+                                                     bool is_Xs_turn) {
+  minimaxBitboard_mask_t xMask;
+  minimaxBitboard_mask_t oMask;
+  minimaxBitboard_fromBoard(board, &xMask, &oMask);
+  nodeCount = 1; // The top-level board.
+  minimax_score_t alpha = SCORE_BELOW_MIN;
+  minimax_score_t beta = SCORE_ABOVE_MAX;
+  uint8_t bestSquare = 0;
+  // Top level in square order with strict improvement, so ties go to the
+  // first square like minimax(). Each move is searched with the window
+  // narrowed by the best move so far; a move that can't beat it comes back
+  // as alpha (or beta) and isn't chosen.
+  for (uint8_t square = 0; square < NUM_POSSIBLE_LOCATIONS; ++square) {
+    minimaxBitboard_mask_t bit = 1 << square;
+    if ((xMask | oMask) & bit) {
+      continue;
+    }
+    if (is_Xs_turn) {
+      minimax_score_t score = minimaxBitboard_search(xMask | bit, oMask, false,
+                                                     1, alpha, beta);
+      if (score > alpha) {
+        alpha = score;
+        bestSquare = square;
+      }
+    } else {
+      minimax_score_t score = minimaxBitboard_search(xMask, oMask | bit, true,
+                                                     1, alpha, beta);
+      if (score < beta) {
+        beta = score;
+        bestSquare = square;
+      }
+    }
+  }
+  tictactoe_location_t move;
+  move.row = bestSquare / TICTACTOE_BOARD_COLUMNS;
+  move.column = bestSquare % TICTACTOE_BOARD_COLUMNS;
+  return move;
+}
+
+// Returns the number of boards visited by the last
+// minimaxBitboard_computeNextMove().
+uint32_t minimaxBitboard_getNodeCount() { return nodeCount; }
@@ -0,0 +1,52 @@
+/*
+This software is provided for student assignment use in the Department of
+Electrical and Computer Engineering, Brigham Young University, Utah, USA.
+
+Users agree to not re-host, or redistribute the software, in source or binary
+form, to other persons or other institutions. Users may modify and use the
+source code for personal or educational use.
+
+For questions, contact Brad Hutchings or Jeff Goeders, https://ece.byu.edu/
+*/
+
+#ifndef MINIMAXBITBOARD
+#define MINIMAXBITBOARD
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "minimax.h"
+#include "ticTacToe.h"
+
+// Search engine that gives the same moves as minimax() with far less work.
+// The board is kept as two 9-bit masks, one for the X squares and one for the
+// O squares (bit row * TICTACTOE_BOARD_COLUMNS + column), so a win is one of 8
+// mask compares and a move is setting a bit. The search is alpha-beta with the
+// center and corners tried first.
+//
+// Scores are the same as minimax(): the end-game score divided by the depth it
+// was reached at. At the top level the moves are tried in square order and a
+// move only replaces the best one if it scores strictly better, which is the
+// tie-break minimax() uses, so the same move is chosen.
+
+// Bit mask of squares, bit row * TICTACTOE_BOARD_COLUMNS + column.
+typedef uint16_t minimaxBitboard_mask_t;
+
+// Converts board into X and O masks.
+void minimaxBitboard_fromBoard(tictactoe_board_t *board,
+                               minimaxBitboard_mask_t *xMask,
+                               minimaxBitboard_mask_t *oMask);
+
+// Returns true if the squares in mask include three in a row.
+bool minimaxBitboard_isWin(minimaxBitboard_mask_t mask);
+
+// Computes the next move for board, with the same arguments and result as
+// minimax_computeNextMove(). The board must not be game over.
+tictactoe_location_t minimaxBitboard_computeNextMove(tictactoe_board_t *board,
+                                                     bool is_Xs_turn);
+
+// Returns the number of boards visited by the last
+// minimaxBitboard_computeNextMove().
+uint32_t minimaxBitboard_getNodeCount();
+
+#endif /* MINIMAXBITBOARD */
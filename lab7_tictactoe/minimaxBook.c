@@ -0,0 +1,142 @@
+/*
+This software is provided for student assignment use in the Department of
+Electrical and Computer Engineering, Brigham Young University, Utah, USA.
+
+Users agree to not re-host, or redistribute the software, in source or binary
+form, to other persons or other institutions. Users may modify and use the
+source code for personal or educational use.
+
+For questions, contact Brad Hutchings or Jeff Goeders, https://ece.byu.edu/
+*/
+
+#include <stdio.h>
+
+#include "minimax.h"
+#include "minimaxBook.h"
+
+#define BASE 3
+// Number of legal tic-tac-toe positions, including the empty board and all of
+// the game-over boards.
+#define LEGAL_POSITION_COUNT 5478
+#define BITS_PER_BYTE 8
+
+// Encodes the board as a base-3 number.
+uint16_t minimaxBook_encodeBoard(tictactoe_board_t *board) {
+  uint16_t encoding = 0;
+  // The last square is the most significant digit.
+  for (int8_t row = TICTACTOE_BOARD_ROWS - 1; row >= 0; --row) {
+    for (int8_t column = TICTACTOE_BOARD_COLUMNS - 1; column >= 0; --column) {
+      encoding = encoding * BASE + board->squares[row][column];
+    }
+  }
+  return encoding;
+}
+
+// Returns true if it is X's turn on this board. X always goes first so it is
+// X's turn whenever both players have played the same number of squares.
+static bool minimaxBook_isXsTurn(tictactoe_board_t *board) {
+  int8_t difference = 0;
+  for (uint8_t row = 0; row < TICTACTOE_BOARD_ROWS; ++row) {
+    for (uint8_t column = 0; column < TICTACTOE_BOARD_COLUMNS; ++column) {
+      if (board->squares[row][column] == MINIMAX_X_SQUARE) {
+        ++difference;
+      } else if (board->squares[row][column] == MINIMAX_O_SQUARE) {
+        --difference;
+      }
+    }
+  }
+  return difference == 0;
+}
+
+// Looks up the next move for board. Returns false if the board is not in the
+// book or it isn't is_Xs_turn's turn on this board.
+bool minimaxBook_lookup(tictactoe_board_t *board, bool is_Xs_turn,
+                        tictactoe_location_t *move) {
+  uint8_t square = minimaxBook_table[minimaxBook_encodeBoard(board)];
+  if (square == MINIMAX_BOOK_NO_MOVE ||
+      minimaxBook_isXsTurn(board) != is_Xs_turn) {
+    return false;
+  }
+  move->row = square / TICTACTOE_BOARD_COLUMNS;
+  move->column = square % TICTACTOE_BOARD_COLUMNS;
+  return true;
+}
+
+// One bit per board encoding, set once the board has been checked.
+static uint8_t visited[(MINIMAX_BOOK_SIZE + BITS_PER_BYTE - 1) / BITS_PER_BYTE];
+static uint16_t visitedCount;
+static uint16_t mismatchCount;
+
+// Checks board and then every board that can be reached from it.
+static void minimaxBook_checkReachableBoards(tictactoe_board_t *board,
+                                             bool is_Xs_turn) {
+  uint16_t encoding = minimaxBook_encodeBoard(board);
+  if (visited[encoding / BITS_PER_BYTE] & (1 << (encoding % BITS_PER_BYTE))) {
+    return; // Already reached this board through other moves.
+  }
+  visited[encoding / BITS_PER_BYTE] |= 1 << (encoding % BITS_PER_BYTE);
+  ++visitedCount;
+  if (minimax_isGameOver(minimax_computeBoardScore(board, !is_Xs_turn))) {
+    // Nothing to look up, and the book must not claim a move either.
+    if (minimaxBook_table[encoding] != MINIMAX_BOOK_NO_MOVE) {
+      printf("minimaxBook_runTest: board %d is game over but the book has a "
+             "move.\n",
+             encoding);
+      ++mismatchCount;
+    }
+    return;
+  }
+  tictactoe_location_t bookMove;
+  if (!minimaxBook_lookup(board, is_Xs_turn, &bookMove)) {
+    printf("minimaxBook_runTest: board %d is missing from the book.\n",
+           encoding);
+    ++mismatchCount;
+  } else {
+    tictactoe_location_t searchMove = minimax_searchNextMove(board, is_Xs_turn);
+    if (bookMove.row != searchMove.row ||
+        bookMove.column != searchMove.column) {
+      printf("minimaxBook_runTest: board %d, book move (%d, %d) does not match "
+             "minimax() move (%d, %d).\n",
+             encoding, bookMove.row, bookMove.column, searchMove.row,
+             searchMove.column);
+      ++mismatchCount;
+    }
+  }
+  // Try every move from here.
+  for (uint8_t row = 0; row < TICTACTOE_BOARD_ROWS; ++row) {
+    for (uint8_t column = 0; column < TICTACTOE_BOARD_COLUMNS; ++column) {
+      if (board->squares[row][column] == MINIMAX_EMPTY_SQUARE) {
+        board->squares[row][column] =
+            is_Xs_turn ? MINIMAX_X_SQUARE : MINIMAX_O_SQUARE;
+        minimaxBook_checkReachableBoards(board, !is_Xs_turn);
+        board->squares[row][column] = MINIMAX_EMPTY_SQUARE;
+      }
+    }
+  }
+}
+
+// Visits every board that can be reached from an empty board and checks that
+// the book gives the same move as minimax_searchNextMove() on every one that
+// isn't game over. Returns true if they all agree.
+bool minimaxBook_runTest() {
+  printf("Running minimaxBook_runTest()\n");
+  for (uint16_t i = 0; i < sizeof(visited); ++i) {
+    visited[i] = 0;
+  }
+  visitedCount = 0;
+  mismatchCount = 0;
+  tictactoe_board_t board;
+  minimax_initBoard(&board);
+  minimaxBook_checkReachableBoards(&board, true);
+  if (visitedCount != LEGAL_POSITION_COUNT) {
+    printf("minimaxBook_runTest: reached %d boards, expected %d.\n",
+           visitedCount, LEGAL_POSITION_COUNT);
+    ++mismatchCount;
+  }
+  if (mismatchCount == 0) {
+    printf("minimaxBook_runTest passed.\n");
+  } else {
+    printf("minimaxBook_runTest failed.\n");
+  }
+  return mismatchCount == 0;
+}
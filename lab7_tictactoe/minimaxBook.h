@@ -0,0 +1,61 @@
+/*
+This software is provided for student assignment use in the Department of
+Electrical and Computer Engineering, Brigham Young University, Utah, USA.
+
+Users agree to not re-host, or redistribute the software, in source or binary
+form, to other persons or other institutions. Users may modify and use the
+source code for personal or educational use.
+
+For questions, contact Brad Hutchings or Jeff Goeders, https://ece.byu.edu/
+*/
+
+#ifndef MINIMAXBOOK
+#define MINIMAXBOOK
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "ticTacToe.h"
+
+// Precomputed minimax moves for every reachable tic-tac-toe board.
+// There are only 5478 legal positions, so instead of searching the game tree
+// on every computer move, minimax_computeNextMove() looks the move up in
+// minimaxBook_table, which is indexed by the board encoded in base 3 (one
+// digit per square, see minimaxBook_encodeBoard()).
+//
+// minimaxBook_table is generated at build time by minimaxBookGenerator.c,
+// which runs the search (minimax_searchNextMove()) on every reachable board,
+// so the book always agrees with minimax(), tie-breaks included. CMake builds
+// the generator with the host compiler, runs it, and compiles the
+// minimaxBookTable.c it writes into the build directory, again whenever
+// minimax.c changes. By hand:
+//   gcc -I. -o minimaxBookGenerator minimaxBookGenerator.c minimax.c
+//       minimaxBitboard.c minimaxBook.c
+//   ./minimaxBookGenerator minimaxBookTable.c
+
+// One entry per base-3 board encoding (3^9).
+#define MINIMAX_BOOK_SIZE 19683
+// Entry value for boards that are not in the book (unreachable or game over).
+#define MINIMAX_BOOK_NO_MOVE 0xFF
+
+// Best move for each board encoding, as row * TICTACTOE_BOARD_COLUMNS +
+// column, or MINIMAX_BOOK_NO_MOVE.
+extern const uint8_t minimaxBook_table[MINIMAX_BOOK_SIZE];
+
+// Encodes the board as a base-3 number. The square at (row, column) is digit
+// row * TICTACTOE_BOARD_COLUMNS + column and its value is the
+// tictactoe_square_state_t of the square.
+uint16_t minimaxBook_encodeBoard(tictactoe_board_t *board);
+
+// Looks up the next move for board. Returns false (and leaves move alone) if
+// the board is not in the book or it isn't is_Xs_turn's turn on this board (X
+// always goes first), in which case the caller has to search.
+bool minimaxBook_lookup(tictactoe_board_t *board, bool is_Xs_turn,
+                        tictactoe_location_t *move);
+
+// Visits every board that can be reached from an empty board and checks that
+// the book gives the same move as minimax_searchNextMove() on every one that
+// isn't game over. Returns true if they all agree.
+bool minimaxBook_runTest();
+
+#endif /* MINIMAXBOOK */
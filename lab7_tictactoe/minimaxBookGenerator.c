@@ -0,0 +1,85 @@
+/*
+This software is provided for student assignment use in the Department of
+Electrical and Computer Engineering, Brigham Young University, Utah, USA.
+
+Users agree to not re-host, or redistribute the software, in source or binary
+form, to other persons or other institutions. Users may modify and use the
+source code for personal or educational use.
+
+For questions, contact Brad Hutchings or Jeff Goeders, https://ece.byu.edu/
+*/
+
+// Host tool that writes minimaxBookTable.c, to the file named on the command
+// line or to stdout. It is not part of the lab7 executable: the build compiles
+// it with the host compiler and runs it, see CMakeLists.txt and minimaxBook.h.
+
+#include <stdio.h>
+
+#include "minimax.h"
+#include "minimaxBook.h"
+
+#define ENTRIES_PER_LINE 15
+
+static uint8_t table[MINIMAX_BOOK_SIZE];
+
+// minimax.c falls back on minimaxBook_lookup(), so minimaxBook.c is linked in
+// and needs a table. The generator only calls minimax_searchNextMove(), which
+// never looks anything up, so an all-zero one will do. This is what keeps the
+// generated table out of the generator.
+const uint8_t minimaxBook_table[MINIMAX_BOOK_SIZE];
+
+// Searches board and every board that can be reached from it, recording the
+// minimax() move for each one that isn't game over.
+static void generate(tictactoe_board_t *board, bool is_Xs_turn) {
+  uint16_t encoding = minimaxBook_encodeBoard(board);
+  if (table[encoding] != MINIMAX_BOOK_NO_MOVE ||
+      minimax_isGameOver(minimax_computeBoardScore(board, !is_Xs_turn))) {
+    return; // Already done, or there is no move to make.
+  }
+  tictactoe_location_t move = minimax_searchNextMove(board, is_Xs_turn);
+  table[encoding] = move.row * TICTACTOE_BOARD_COLUMNS + move.column;
+  for (uint8_t row = 0; row < TICTACTOE_BOARD_ROWS; ++row) {
+    for (uint8_t column = 0; column < TICTACTOE_BOARD_COLUMNS; ++column) {
+      if (board->squares[row][column] == MINIMAX_EMPTY_SQUARE) {
+        board->squares[row][column] =
+            is_Xs_turn ? MINIMAX_X_SQUARE : MINIMAX_O_SQUARE;
+        generate(board, !is_Xs_turn);
+        board->squares[row][column] = MINIMAX_EMPTY_SQUARE;
+      }
+    }
+  }
+}
+
+int main(int argc, char *argv[]) {
+  FILE *file = stdout;
+  if (argc > 1 && (file = fopen(argv[1], "w")) == NULL) {
+    printf("minimaxBookGenerator: could not open %s.\n", argv[1]);
+    return 1;
+  }
+  for (uint16_t i = 0; i < MINIMAX_BOOK_SIZE; ++i) {
+    table[i] = MINIMAX_BOOK_NO_MOVE;
+  }
+  tictactoe_board_t board;
+  minimax_initBoard(&board);
+  generate(&board, true);
+
+  fprintf(file, "// Generated by minimaxBookGenerator.c, do not edit.\n\n");
+  fprintf(file, "#include \"minimaxBook.h\"\n\n");
+  fprintf(file, "const uint8_t minimaxBook_table[MINIMAX_BOOK_SIZE] = {\n");
+  for (uint16_t i = 0; i < MINIMAX_BOOK_SIZE; ++i) {
+    if (i % ENTRIES_PER_LINE == 0) {
+      fprintf(file, "   ");
+    }
+    fprintf(file, " %d,", table[i]);
+    if (i % ENTRIES_PER_LINE == ENTRIES_PER_LINE - 1 ||
+        i == MINIMAX_BOOK_SIZE - 1) {
+      fprintf(file, "\n");
+    }
+  }
+  fprintf(file, "};\n");
+  if (file != stdout && fclose(file) != 0) {
+    printf("minimaxBookGenerator: could not write %s.\n", argv[1]);
+    return 1;
+  }
+  return 0;
+}
@@ -10,7 +10,9 @@ For questions, contact Brad Hutchings or Jeff Goeders, https://ece.byu.edu/
 */
 
 #include "minimax.h"
+#include "minimaxBitboard.h"
 #include <stdio.h>
+#include <time.h>
 
 #define TOP 0
 #define MID 1
@@ -18,6 +20,93 @@ For questions, contact Brad Hutchings or Jeff Goeders, https://ece.byu.edu/
 #define LFT 0
 #define RGT 2
 
+#define BOARD_SQUARE_COUNT 9
+
+// A board written as 9 characters, row by row ('X', 'O' or ' '), and whose
+// turn it is.
+typedef struct {
+  const char *squares;
+  bool is_Xs_turn;
+} benchmark_board_t;
+
+// The testBoards() boards, in the same order.
+static const benchmark_board_t benchmark_boards[] = {
+    {"O XX  XOO", true},  {"O X   X O", true},  {"O  O  X X", true},
+    {"O     X X", false}, {"XX  O    ", false}, {" OO O    ", true},
+    {"XXOOXXX O", false}, {"XX       ", false}, {"         ", true},
+    {"X        ", false}, {"X   O    ", true},  {"XX  O    ", false},
+    {"XXO O    ", true},  {"XXO O X  ", false}, {"XXOOO X  ", true},
+    {"XXOOOXX  ", false}, {"XXOOOXXO ", true}};
+#define BENCHMARK_BOARD_COUNT                                                  \
+  (sizeof(benchmark_boards) / sizeof(benchmark_boards[0]))
+
+// Fills board from 9 characters, row by row.
+static void setBoard(tictactoe_board_t *board, const char *squares) {
+  for (uint8_t i = 0; i < BOARD_SQUARE_COUNT; ++i) {
+    tictactoe_square_state_t state = MINIMAX_EMPTY_SQUARE;
+    if (squares[i] == 'X') {
+      state = MINIMAX_X_SQUARE;
+    } else if (squares[i] == 'O') {
+      state = MINIMAX_O_SQUARE;
+    }
+    board->squares[i / TICTACTOE_BOARD_COLUMNS][i % TICTACTOE_BOARD_COLUMNS] =
+        state;
+  }
+}
+
+// Returns the seconds since start.
+static double secondsSince(clock_t start) {
+  return ((double)(clock() - start)) / CLOCKS_PER_SEC;
+}
+
+// Runs minimax() and the bitboard engine on every testBoards() board and
+// prints the move, node count and time for each. Returns true if the engines
+// chose the same move on every board that isn't already game over.
+bool benchmarkBitboard() {
+  printf("\nboard   minimax move nodes  seconds   bitboard move nodes  "
+         "seconds\n");
+  bool success = true;
+  uint32_t minimax_nodes = 0;
+  uint32_t bitboard_nodes = 0;
+  double minimax_seconds = 0.0;
+  double bitboard_seconds = 0.0;
+  for (uint8_t i = 0; i < BENCHMARK_BOARD_COUNT; ++i) {
+    tictactoe_board_t board;
+    setBoard(&board, benchmark_boards[i].squares);
+    bool is_Xs_turn = benchmark_boards[i].is_Xs_turn;
+    if (minimax_isGameOver(minimax_computeBoardScore(&board, is_Xs_turn))) {
+      printf("board%-2d game over, no move to compare.\n", i + 1);
+      continue;
+    }
+    clock_t start = clock();
+    tictactoe_location_t minimax_move =
+        minimax_searchNextMove(&board, is_Xs_turn);
+    double seconds = secondsSince(start);
+    minimax_seconds += seconds;
+    minimax_nodes += minimax_getNodeCount();
+    printf("board%-2d (%d, %d) %7d %9.6f", i + 1, minimax_move.row,
+           minimax_move.column, minimax_getNodeCount(), seconds);
+    start = clock();
+    tictactoe_location_t bitboard_move =
+        minimaxBitboard_computeNextMove(&board, is_Xs_turn);
+    seconds = secondsSince(start);
+    bitboard_seconds += seconds;
+    bitboard_nodes += minimaxBitboard_getNodeCount();
+    printf("   (%d, %d) %7d %9.6f", bitboard_move.row, bitboard_move.column,
+           minimaxBitboard_getNodeCount(), seconds);
+    if (minimax_move.row != bitboard_move.row ||
+        minimax_move.column != bitboard_move.column) {
+      printf("  MISMATCH");
+      success = false;
+    }
+    printf("\n");
+  }
+  printf("total          %7d %9.6f          %7d %9.6f\n", minimax_nodes,
+         minimax_seconds, bitboard_nodes, bitboard_seconds);
+  printf("benchmarkBitboard %s.\n", success ? "passed" : "failed");
+  return success;
+}
+
 // Test the next move code, given several boards.
 // You need to also create 10 boards of your own to test.
 void main() {
@@ -151,4 +240,6 @@ void main() {
 
   score = minimax_computeBoardScore(&board9, is_Xs_turn);
   printf("score board9: %d\n", score);
+
+  benchmarkBitboard();
 }
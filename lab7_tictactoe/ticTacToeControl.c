@@ -332,6 +332,7 @@ void ticTacToeControl_tick() {
   default:
     break;
   }
+  display_flush();
 }
 
 // Initialize the tic-tac-toe controller state machine,
@@ -344,4 +345,5 @@ void ticTacToeControl_init(double period_s) {
   buttons_init();
   minimax_initBoard(&board);
   display_fillScreen(DISPLAY_DARK_BLUE); // Blank the screen.
+  display_flush();
 }
\ No newline at end of file
@@ -0,0 +1,198 @@
+/*
+This software is provided for student assignment use in the Department of
+Electrical and Computer Engineering, Brigham Young University, Utah, USA.
+Users agree to not re-host, or redistribute the software, in source or binary
+form, to other persons or other institutions. Users may modify and use the
+source code for personal or educational use.
+For questions, contact Brad Hutchings or Jeff Goeders, https://ece.byu.edu/
+*/
+
+#include "adcCapture.h"
+
+#define HEADER_BYTE_COUNT 12
+#define BLOCK_HEADER_BYTE_COUNT 6
+#define SAMPLE_BYTE_COUNT 2
+#define BITS_PER_BYTE 8
+#define BYTE_MASK 0xFF
+
+// Fields are written a byte at a time so the file doesn't depend on struct
+// padding or on the byte order of the machine that wrote it.
+static void adcCapture_put16(uint8_t bytes[], uint16_t value) {
+  bytes[0] = value & BYTE_MASK;
+  bytes[1] = (value >> BITS_PER_BYTE) & BYTE_MASK;
+}
+
+static void adcCapture_put32(uint8_t bytes[], uint32_t value) {
+  adcCapture_put16(bytes, value & 0xFFFF);
+  adcCapture_put16(bytes + 2, value >> 16);
+}
+
+static uint16_t adcCapture_get16(const uint8_t bytes[]) {
+  return bytes[0] | (bytes[1] << BITS_PER_BYTE);
+}
+
+static uint32_t adcCapture_get32(const uint8_t bytes[]) {
+  return adcCapture_get16(bytes) |
+         ((uint32_t)adcCapture_get16(bytes + 2) << 16);
+}
+
+// Writes the header. Returns false if the write failed.
+bool adcCapture_writeHeader(FILE *file, const adcCapture_header_t *header) {
+  uint8_t bytes[HEADER_BYTE_COUNT];
+  adcCapture_put32(bytes, ADC_CAPTURE_MAGIC);
+  adcCapture_put16(bytes + 4, ADC_CAPTURE_VERSION);
+  bytes[6] = header->adcInputMode;
+  bytes[7] = 0; // Reserved.
+  adcCapture_put32(bytes + 8, header->sampleRateHz);
+  return fwrite(bytes, 1, HEADER_BYTE_COUNT, file) == HEADER_BYTE_COUNT;
+}
+
+// Writes count samples as one block starting at sample index timestamp.
+bool adcCapture_writeBlock(FILE *file, uint32_t timestamp,
+                           const adcCapture_sample_t samples[],
+                           uint16_t count) {
+  static uint8_t bytes[BLOCK_HEADER_BYTE_COUNT +
+                       ADC_CAPTURE_MAX_BLOCK_SAMPLE_COUNT * SAMPLE_BYTE_COUNT];
+  if (count > ADC_CAPTURE_MAX_BLOCK_SAMPLE_COUNT) {
+    printf("adcCapture_writeBlock: %d samples is more than the maximum of "
+           "%d.\n",
+           count, ADC_CAPTURE_MAX_BLOCK_SAMPLE_COUNT);
+    return false;
+  }
+  adcCapture_put32(bytes, timestamp);
+  adcCapture_put16(bytes + 4, count);
+  for (uint16_t i = 0; i < count; i++)
+    adcCapture_put16(bytes + BLOCK_HEADER_BYTE_COUNT + i * SAMPLE_BYTE_COUNT,
+                     samples[i]);
+  size_t byteCount = BLOCK_HEADER_BYTE_COUNT + count * SAMPLE_BYTE_COUNT;
+  return fwrite(bytes, 1, byteCount, file) == byteCount;
+}
+
+// Reads and checks the header.
+bool adcCapture_readHeader(FILE *file, adcCapture_header_t *header) {
+  uint8_t bytes[HEADER_BYTE_COUNT];
+  if (fread(bytes, 1, HEADER_BYTE_COUNT, file) != HEADER_BYTE_COUNT) {
+    printf("adcCapture_readHeader: file is too short for a header.\n");
+    return false;
+  }
+  if (adcCapture_get32(bytes) != ADC_CAPTURE_MAGIC) {
+    printf("adcCapture_readHeader: not an ADC capture.\n");
+    return false;
+  }
+  uint16_t version = adcCapture_get16(bytes + 4);
+  if (version != ADC_CAPTURE_VERSION) {
+    printf("adcCapture_readHeader: version %d, only version %d is supported.\n",
+           version, ADC_CAPTURE_VERSION);
+    return false;
+  }
+  header->adcInputMode = bytes[6];
+  header->sampleRateHz = adcCapture_get32(bytes + 8);
+  return true;
+}
+
+// Reads the next block into samples. Returns 0 at the end of the capture.
+uint16_t adcCapture_readBlock(FILE *file, uint32_t *timestamp,
+                              adcCapture_sample_t samples[]) {
+  static uint8_t bytes[ADC_CAPTURE_MAX_BLOCK_SAMPLE_COUNT * SAMPLE_BYTE_COUNT];
+  size_t headerByteCount = fread(bytes, 1, BLOCK_HEADER_BYTE_COUNT, file);
+  if (headerByteCount == 0)
+    return 0; // Clean end of the capture.
+  if (headerByteCount != BLOCK_HEADER_BYTE_COUNT) {
+    printf("adcCapture_readBlock: capture ends part way through a block.\n");
+    return 0;
+  }
+  *timestamp = adcCapture_get32(bytes);
+  uint16_t count = adcCapture_get16(bytes + 4);
+  if (count > ADC_CAPTURE_MAX_BLOCK_SAMPLE_COUNT) {
+    printf("adcCapture_readBlock: block at %d has %d samples, the maximum is "
+           "%d.\n",
+           *timestamp, count, ADC_CAPTURE_MAX_BLOCK_SAMPLE_COUNT);
+    return 0;
+  }
+  size_t byteCount = count * SAMPLE_BYTE_COUNT;
+  if (fread(bytes, 1, byteCount, file) != byteCount) {
+    printf("adcCapture_readBlock: capture ends part way through a block.\n");
+    return 0;
+  }
+  for (uint16_t i = 0; i < count; i++)
+    samples[i] = adcCapture_get16(bytes + i * SAMPLE_BYTE_COUNT);
+  return count;
+}
+
+/*******************************************************
+ ****************** Test Routines **********************
+ ******************************************************/
+
+#define TEST_BLOCK_COUNT 3
+#define TEST_DROPPED_SAMPLE_COUNT 7 // Gap left between the blocks.
+#define TEST_SAMPLE_MASK 0xFFF      // Samples are 12 bits.
+#define TEST_SAMPLE_STEP 37         // Makes every sample different.
+
+// Writes a short capture to a temporary file, reads it back and checks that
+// the header and every block match.
+bool adcCapture_runTest() {
+  static adcCapture_sample_t written[ADC_CAPTURE_MAX_BLOCK_SAMPLE_COUNT];
+  static adcCapture_sample_t read[ADC_CAPTURE_MAX_BLOCK_SAMPLE_COUNT];
+  // Full size, one sample and a typical size, so the size limit is covered.
+  const uint16_t blockCounts[TEST_BLOCK_COUNT] = {
+      ADC_CAPTURE_MAX_BLOCK_SAMPLE_COUNT, 1, 256};
+  printf("Running adcCapture_runTest()\n");
+  FILE *file = tmpfile();
+  if (file == NULL) {
+    printf("adcCapture_runTest: could not create a temporary file.\n");
+    return false;
+  }
+  bool success = true;
+  adcCapture_header_t header = {.adcInputMode = true,
+                                .sampleRateHz = ADC_CAPTURE_SAMPLE_RATE_HZ};
+  success &= adcCapture_writeHeader(file, &header);
+  uint32_t timestamp = 0;
+  for (uint16_t block = 0; block < TEST_BLOCK_COUNT; block++) {
+    for (uint16_t i = 0; i < blockCounts[block]; i++)
+      written[i] = (timestamp + i) * TEST_SAMPLE_STEP & TEST_SAMPLE_MASK;
+    success &= adcCapture_writeBlock(file, timestamp, written,
+                                     blockCounts[block]);
+    timestamp += blockCounts[block] + TEST_DROPPED_SAMPLE_COUNT;
+  }
+  // Too big, must be refused rather than written.
+  success &= !adcCapture_writeBlock(file, timestamp, written,
+                                    ADC_CAPTURE_MAX_BLOCK_SAMPLE_COUNT + 1);
+  rewind(file);
+
+  adcCapture_header_t readHeader;
+  if (!adcCapture_readHeader(file, &readHeader) ||
+      readHeader.adcInputMode != header.adcInputMode ||
+      readHeader.sampleRateHz != header.sampleRateHz) {
+    printf("adcCapture_runTest: header does not match.\n");
+    success = false;
+  }
+  timestamp = 0;
+  for (uint16_t block = 0; block < TEST_BLOCK_COUNT; block++) {
+    uint32_t readTimestamp;
+    uint16_t count = adcCapture_readBlock(file, &readTimestamp, read);
+    if (count != blockCounts[block] || readTimestamp != timestamp) {
+      printf("adcCapture_runTest: block %d has %d samples at %d, expected %d "
+             "at %d.\n",
+             block, count, readTimestamp, blockCounts[block], timestamp);
+      success = false;
+      break;
+    }
+    for (uint16_t i = 0; i < count; i++) {
+      if (read[i] != ((timestamp + i) * TEST_SAMPLE_STEP & TEST_SAMPLE_MASK)) {
+        printf("adcCapture_runTest: block %d sample %d does not match.\n",
+               block, i);
+        success = false;
+        break;
+      }
+    }
+    timestamp += blockCounts[block] + TEST_DROPPED_SAMPLE_COUNT;
+  }
+  uint32_t readTimestamp;
+  if (adcCapture_readBlock(file, &readTimestamp, read) != 0) {
+    printf("adcCapture_runTest: found a block after the last one.\n");
+    success = false;
+  }
+  fclose(file);
+  printf("adcCapture_runTest %s.\n", success ? "passed" : "failed");
+  return success;
+}
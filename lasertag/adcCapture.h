@@ -0,0 +1,69 @@
+/*
+This software is provided for student assignment use in the Department of
+Electrical and Computer Engineering, Brigham Young University, Utah, USA.
+Users agree to not re-host, or redistribute the software, in source or binary
+form, to other persons or other institutions. Users may modify and use the
+source code for personal or educational use.
+For questions, contact Brad Hutchings or Jeff Goeders, https://ece.byu.edu/
+*/
+
+#ifndef ADCCAPTURE_H_
+#define ADCCAPTURE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+// Binary capture format for raw ADC streams, so a stream recorded at the range
+// can be replayed through the detector later (see adcReplay.h).
+//
+// All fields are little-endian. A capture is a header followed by any number
+// of blocks:
+//   header: uint32 magic (ADC_CAPTURE_MAGIC), uint16 version, uint8 ADC input
+//           mode (interrupts_getAdcInputMode()), uint8 reserved (0),
+//           uint32 sample rate in Hz.
+//   block:  uint32 timestamp, uint16 sample count, then that many uint16 raw
+//           ADC values exactly as interrupts_getAdcData() returned them.
+// The timestamp is the index of the first sample of the block, counted in
+// sample periods from the start of the capture. Blocks are in timestamp order
+// and a gap between one block's end and the next block's timestamp means
+// samples were dropped while recording.
+
+#define ADC_CAPTURE_MAGIC 0x43434441 // "ADCC" in file order.
+#define ADC_CAPTURE_VERSION 1
+#define ADC_CAPTURE_SAMPLE_RATE_HZ 100000 // isr_function() rate.
+// Largest block that can be written or read.
+#define ADC_CAPTURE_MAX_BLOCK_SAMPLE_COUNT 4096
+
+typedef uint16_t adcCapture_sample_t;
+
+typedef struct {
+  bool adcInputMode; // INTERRUPTS_ADC_UNIPOLAR_MODE or _BIPOLAR_MODE.
+  uint32_t sampleRateHz;
+} adcCapture_header_t;
+
+// Writes the header. Returns false if the write failed.
+bool adcCapture_writeHeader(FILE *file, const adcCapture_header_t *header);
+
+// Writes count samples (at most ADC_CAPTURE_MAX_BLOCK_SAMPLE_COUNT) as one
+// block starting at sample index timestamp. Returns false if the write failed.
+bool adcCapture_writeBlock(FILE *file, uint32_t timestamp,
+                           const adcCapture_sample_t samples[],
+                           uint16_t count);
+
+// Reads and checks the header. Prints why and returns false if the file isn't
+// a capture this code can read.
+bool adcCapture_readHeader(FILE *file, adcCapture_header_t *header);
+
+// Reads the next block into samples, which must hold
+// ADC_CAPTURE_MAX_BLOCK_SAMPLE_COUNT values. Returns the number of samples
+// read and sets timestamp, or returns 0 at the end of the capture. A truncated
+// or oversized block is reported and treated as the end of the capture.
+uint16_t adcCapture_readBlock(FILE *file, uint32_t *timestamp,
+                              adcCapture_sample_t samples[]);
+
+// Writes a short capture to a temporary file, reads it back and checks that
+// the header and every block match. Returns true if they do.
+bool adcCapture_runTest();
+
+#endif /* ADCCAPTURE_H_ */
@@ -0,0 +1,246 @@
+/*
+This software is provided for student assignment use in the Department of
+Electrical and Computer Engineering, Brigham Young University, Utah, USA.
+Users agree to not re-host, or redistribute the software, in source or binary
+form, to other persons or other institutions. Users may modify and use the
+source code for personal or educational use.
+For questions, contact Brad Hutchings or Jeff Goeders, https://ece.byu.edu/
+*/
+
+#include <stdio.h>
+
+#include "adcCapture.h"
+#include "adcReplay.h"
+#include "filter.h"
+#include "hitThreshold.h"
+#include "intervalTimer.h"
+#include "isr.h"
+#include "lockoutTimer.h"
+
+#define READ_TIMER INTERVAL_TIMER_0
+#define BUFFER_TIMER INTERVAL_TIMER_1
+#define DETECTOR_TIMER INTERVAL_TIMER_2
+
+#define ADC_REPLAY_SHOT_LINE_LENGTH 100
+#define ADC_REPLAY_SECONDS_PER_MINUTE 60.0
+
+static const char *engineNames[] = {"IIR", "sliding DFT", "IIR block"};
+
+// A hit reported by the detector or a shot from the shot file.
+typedef struct {
+  double seconds; // Capture time.
+  uint16_t frequencyNumber;
+} adcReplay_event_t;
+
+// The hits of the last replay, in capture time order.
+static adcReplay_event_t hits[ADC_REPLAY_MAX_HIT_COUNT];
+static uint32_t recordedHitCount;
+
+// Adds samples to the ADC buffer the way isr_function() does, one lockout tick
+// per sample, calling the detector every ADC_REPLAY_SAMPLES_PER_DETECTOR_CALL
+// samples. firstSampleIndex is the capture time of samples[0].
+static void adcReplay_feed(const adcCapture_sample_t samples[], uint16_t count,
+                           uint32_t firstSampleIndex, uint32_t sampleRateHz,
+                           adcReplay_result_t *result) {
+  uint16_t fed = 0;
+  while (fed < count) {
+    uint16_t chunk = count - fed;
+    if (chunk > ADC_REPLAY_SAMPLES_PER_DETECTOR_CALL)
+      chunk = ADC_REPLAY_SAMPLES_PER_DETECTOR_CALL;
+    intervalTimer_start(BUFFER_TIMER);
+    for (uint16_t i = 0; i < chunk; i++) {
+      isr_addDataToAdcBuffer(samples[fed + i]);
+      lockoutTimer_tick();
+    }
+    intervalTimer_stop(BUFFER_TIMER);
+    fed += chunk;
+
+    intervalTimer_start(DETECTOR_TIMER);
+    detector(false);
+    intervalTimer_stop(DETECTOR_TIMER);
+    if (detector_hitDetected()) {
+      // The hit is somewhere in this chunk, report the end of it.
+      double seconds = (double)(firstSampleIndex + fed) / sampleRateHz;
+      uint16_t frequencyNumber = detector_getFrequencyNumberOfLastHit();
+      printf("  hit at %9.5f s, frequency %d\n", seconds, frequencyNumber);
+      if (recordedHitCount < ADC_REPLAY_MAX_HIT_COUNT)
+        hits[recordedHitCount++] =
+            (adcReplay_event_t){seconds, frequencyNumber};
+      result->hitCount++;
+      detector_clearHit();
+    }
+  }
+  result->sampleCount += count;
+}
+
+// Replays the capture in fileName through a detector initialized with engine.
+bool adcReplay_run(const char *fileName, detector_engine_t engine,
+                   adcReplay_result_t *result) {
+  static adcCapture_sample_t samples[ADC_CAPTURE_MAX_BLOCK_SAMPLE_COUNT];
+  adcReplay_result_t localResult;
+  if (result == NULL)
+    result = &localResult;
+  *result = (adcReplay_result_t){0};
+  recordedHitCount = 0;
+  printf("Replaying %s with the %s engine.\n", fileName, engineNames[engine]);
+  FILE *file = fopen(fileName, "rb");
+  if (file == NULL) {
+    printf("adcReplay_run: could not open %s.\n", fileName);
+    return false;
+  }
+  adcCapture_header_t header;
+  if (!adcCapture_readHeader(file, &header)) {
+    fclose(file);
+    return false;
+  }
+  printf("  ADC mode: %s, %d Hz.\n",
+         header.adcInputMode ? "unipolar" : "bipolar", header.sampleRateHz);
+
+  // Start every replay from the same filter state so results repeat.
+  filter_init();
+  bool ignoredFrequencies[FILTER_FREQUENCY_COUNT] = {false};
+  detector_initWithEngine(ignoredFrequencies, engine);
+  lockoutTimer_init();
+  intervalTimer_initCountUp(READ_TIMER);
+  intervalTimer_initCountUp(BUFFER_TIMER);
+  intervalTimer_initCountUp(DETECTOR_TIMER);
+
+  uint32_t nextSampleIndex = 0; // Where the next block should start.
+  while (true) {
+    uint32_t timestamp;
+    intervalTimer_start(READ_TIMER);
+    uint16_t count = adcCapture_readBlock(file, &timestamp, samples);
+    intervalTimer_stop(READ_TIMER);
+    if (count == 0)
+      break;
+    int32_t gap = (int32_t)(timestamp - nextSampleIndex);
+    if (gap < 0) {
+      // Capture time went backwards, e.g. two captures back to back or a
+      // restarted stream. Hits and shots after this point can't be placed in
+      // capture time, so replay stops here.
+      printf("  capture time goes back %d samples at %9.5f s, stopping.\n",
+             -gap, (double)nextSampleIndex / header.sampleRateHz);
+      result->discontinuityFlag = true;
+      break;
+    }
+    if (gap > 0) {
+      // Samples were dropped while recording. Let the lockout run through the
+      // gap so it stays in step with capture time.
+      printf("  %d samples missing at %9.5f s\n", gap,
+             (double)nextSampleIndex / header.sampleRateHz);
+      result->droppedSampleCount += gap;
+      for (uint32_t i = nextSampleIndex; i < timestamp; i++)
+        lockoutTimer_tick();
+    }
+    adcReplay_feed(samples, count, timestamp, header.sampleRateHz, result);
+    nextSampleIndex = timestamp + count;
+  }
+  fclose(file);
+
+  result->captureSeconds = (double)nextSampleIndex / header.sampleRateHz;
+  result->readSeconds = intervalTimer_getTotalDurationInSeconds(READ_TIMER);
+  result->bufferSeconds = intervalTimer_getTotalDurationInSeconds(BUFFER_TIMER);
+  result->detectorSeconds =
+      intervalTimer_getTotalDurationInSeconds(DETECTOR_TIMER);
+
+  detector_hitCount_t hitCounts[FILTER_FREQUENCY_COUNT];
+  detector_getHitCounts(hitCounts);
+  printf("  hits per frequency:");
+  for (uint16_t i = 0; i < FILTER_FREQUENCY_COUNT; i++)
+    printf(" %d", hitCounts[i]);
+  printf("\n");
+  printf("  %d samples (%.2f s of capture, %d dropped), %d hits.\n",
+         result->sampleCount, result->captureSeconds,
+         result->droppedSampleCount, result->hitCount);
+  uint32_t checkCount = hitThreshold_getCheckCount();
+  if (checkCount > 0) { // Only the adaptive hit test counts.
+    uint32_t shortCircuitCount = hitThreshold_getShortCircuitCount();
+    printf("  %d hit tests, %.1f%% stopped at the minimum power.\n",
+           checkCount, 100.0 * shortCircuitCount / checkCount);
+  }
+  printf("  read %.4f s, ADC buffer %.4f s, detector %.4f s.\n",
+         result->readSeconds, result->bufferSeconds, result->detectorSeconds);
+  double processingSeconds = result->bufferSeconds + result->detectorSeconds;
+  if (processingSeconds > 0) {
+    double samplesPerSecond = result->sampleCount / processingSeconds;
+    printf("  %.0f samples/second, %.1f times real time.\n", samplesPerSecond,
+           samplesPerSecond / header.sampleRateHz);
+  }
+  return true;
+}
+
+// Reads up to ADC_REPLAY_MAX_SHOT_COUNT shots from shotFileName into shots.
+// Returns the number read, or -1 if the file couldn't be opened.
+static int32_t adcReplay_readShots(const char *shotFileName,
+                                   adcReplay_event_t shots[]) {
+  FILE *file = fopen(shotFileName, "r");
+  if (file == NULL) {
+    printf("adcReplay_runScored: could not open %s.\n", shotFileName);
+    return -1;
+  }
+  char line[ADC_REPLAY_SHOT_LINE_LENGTH];
+  int32_t shotCount = 0;
+  uint32_t lineNumber = 0;
+  while (fgets(line, sizeof(line), file) != NULL &&
+         shotCount < ADC_REPLAY_MAX_SHOT_COUNT) {
+    lineNumber++;
+    double seconds;
+    unsigned frequencyNumber;
+    int fieldCount = sscanf(line, "%lf %u", &seconds, &frequencyNumber);
+    if (line[0] == '#' || fieldCount == EOF)
+      continue; // Comment or blank line.
+    if (fieldCount != 2 || frequencyNumber >= FILTER_FREQUENCY_COUNT) {
+      printf("adcReplay_runScored: %s line %d is not a shot.\n", shotFileName,
+             lineNumber);
+      continue;
+    }
+    shots[shotCount++] = (adcReplay_event_t){seconds, frequencyNumber};
+  }
+  fclose(file);
+  return shotCount;
+}
+
+// Replays the capture, then scores the hits against the shots in shotFileName.
+bool adcReplay_runScored(const char *fileName, const char *shotFileName,
+                         detector_engine_t engine, adcReplay_result_t *result) {
+  static adcReplay_event_t shots[ADC_REPLAY_MAX_SHOT_COUNT];
+  adcReplay_result_t localResult;
+  if (result == NULL)
+    result = &localResult;
+  if (!adcReplay_run(fileName, engine, result))
+    return false;
+  int32_t shotCount = adcReplay_readShots(shotFileName, shots);
+  if (shotCount < 0)
+    return true;
+  // Each shot takes the first hit on its frequency in its window that no
+  // earlier shot took.
+  bool hitUsed[ADC_REPLAY_MAX_HIT_COUNT] = {false};
+  uint32_t detectedShotCount = 0;
+  for (int32_t s = 0; s < shotCount; s++) {
+    for (uint32_t h = 0; h < recordedHitCount; h++) {
+      double delay = hits[h].seconds - shots[s].seconds;
+      if (!hitUsed[h] && hits[h].frequencyNumber == shots[s].frequencyNumber &&
+          delay >= 0 && delay <= ADC_REPLAY_SHOT_MATCH_SECONDS) {
+        hitUsed[h] = true;
+        detectedShotCount++;
+        break;
+      }
+    }
+  }
+  result->scoredFlag = true;
+  result->shotCount = shotCount;
+  result->missedShotCount = shotCount - detectedShotCount;
+  result->falseHitCount = recordedHitCount - detectedShotCount;
+  printf("  %d shots: %d missed (%.1f%%), %d false hits (%.1f%% of hits, "
+         "%.2f per minute).\n",
+         result->shotCount, result->missedShotCount,
+         shotCount ? 100.0 * result->missedShotCount / shotCount : 0.0,
+         result->falseHitCount,
+         recordedHitCount ? 100.0 * result->falseHitCount / recordedHitCount
+                          : 0.0,
+         result->captureSeconds > 0
+             ? result->falseHitCount * ADC_REPLAY_SECONDS_PER_MINUTE /
+                   result->captureSeconds
+             : 0.0);
+  return true;
+}
@@ -0,0 +1,80 @@
+/*
+This software is provided for student assignment use in the Department of
+Electrical and Computer Engineering, Brigham Young University, Utah, USA.
+Users agree to not re-host, or redistribute the software, in source or binary
+form, to other persons or other institutions. Users may modify and use the
+source code for personal or educational use.
+For questions, contact Brad Hutchings or Jeff Goeders, https://ece.byu.edu/
+*/
+
+#ifndef ADCREPLAY_H_
+#define ADCREPLAY_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "detector.h"
+
+// Replays a recorded ADC capture (see adcCapture.h) through the detector as
+// fast as the CPU allows, so detector changes can be benchmarked and checked
+// against the same recordings every time. Meant for the emulator build on a
+// Linux host, where the capture is an ordinary file.
+//
+// Samples go in the same way isr_function() puts them in, through
+// isr_addDataToAdcBuffer(), with lockoutTimer_tick() called once per sample so
+// the lockout still lasts 1/2 second of capture time. detector() is called
+// after every ADC_REPLAY_SAMPLES_PER_DETECTOR_CALL samples, the hit (if any)
+// is recorded and cleared, and replay carries on. Nothing else is ticked, so
+// the hit LED is not lit.
+//
+// Uses interval timers 0, 1 and 2 to time reading the capture, filling the ADC
+// buffer and running the detector.
+//
+// A capture can be scored against a shot file listing the shots that were
+// really fired at the detector, one per line: the capture time in seconds when
+// the shot started and its frequency number, e.g. "12.345 3". Lines starting
+// with '#' are comments. A shot is detected if a hit on its frequency is
+// reported within ADC_REPLAY_SHOT_MATCH_SECONDS after it starts. Each hit
+// detects at most one shot, and a hit that detects none is a false hit.
+
+#define ADC_REPLAY_SAMPLES_PER_DETECTOR_CALL 256
+// Hits and shots kept for scoring, any past these aren't scored.
+#define ADC_REPLAY_MAX_HIT_COUNT 1024
+#define ADC_REPLAY_MAX_SHOT_COUNT 1024
+// The 200 ms burst and the detector's delay while the power builds.
+#define ADC_REPLAY_SHOT_MATCH_SECONDS 0.4
+
+typedef struct {
+  uint32_t sampleCount;        // Samples replayed.
+  uint32_t droppedSampleCount; // Samples missing from the capture (gaps).
+  uint32_t hitCount;           // Hits reported by the detector.
+  double captureSeconds;       // Length of the capture, gaps included.
+  double readSeconds;          // Time spent reading the capture.
+  double bufferSeconds;        // Time spent adding samples to the ADC buffer.
+  double detectorSeconds;      // Time spent in detector().
+  // Capture time went backwards and replay stopped there.
+  bool discontinuityFlag;
+  // Only filled in by adcReplay_runScored() when the shot file was read.
+  bool scoredFlag;
+  uint32_t shotCount;       // Shots in the shot file.
+  uint32_t missedShotCount; // Shots no hit detected (false negatives).
+  uint32_t falseHitCount;   // Hits that detected no shot (false positives).
+} adcReplay_result_t;
+
+// Replays the capture in fileName through a detector initialized with engine,
+// ignoring no frequencies. Prints every hit (capture time and frequency), the
+// hit counts per frequency, the time spent in each stage and the samples per
+// second, and fills result if it isn't NULL. Gaps in capture time are ticked
+// through; if capture time goes backwards the replay stops there and sets
+// discontinuityFlag. Returns false if the capture couldn't be read.
+bool adcReplay_run(const char *fileName, detector_engine_t engine,
+                   adcReplay_result_t *result);
+
+// The same as adcReplay_run(), then scores the hits against the shots in
+// shotFileName and prints the missed shots, the false hits and their rates.
+// If the shot file can't be read the replay isn't scored, it still returns
+// true if the capture could be replayed.
+bool adcReplay_runScored(const char *fileName, const char *shotFileName,
+                         detector_engine_t engine, adcReplay_result_t *result);
+
+#endif /* ADCREPLAY_H_ */
@@ -0,0 +1,440 @@
+/*
+This software is provided for student assignment use in the Department of
+Electrical and Computer Engineering, Brigham Young University, Utah, USA.
+Users agree to not re-host, or redistribute the software, in source or binary
+form, to other persons or other institutions. Users may modify and use the
+source code for personal or educational use.
+For questions, contact Brad Hutchings or Jeff Goeders, https://ece.byu.edu/
+*/
+
+#include "adcStream.h"
+
+#ifdef ZYBO_BOARD
+#include "xil_printf.h" // outbyte()
+#endif
+
+// Must be a power of two so free-running indices can be masked into the ring.
+#define BLOCK_INDEX_MASK (ADC_STREAM_BLOCK_COUNT - 1)
+#define MAX_PAYLOAD_BYTE_COUNT (ADC_STREAM_BLOCK_SAMPLE_COUNT * 2)
+#define FRAME_HEADER_BYTE_COUNT 14 // Sync word included.
+#define CHECKSUM_BYTE_COUNT 2
+#define SYNC_BYTE_COUNT 2
+#define SAMPLE_12_BIT_MASK 0xFFF
+#define NIBBLE_MASK 0x0F
+#define BYTE_MASK 0xFF
+#define BITS_PER_BYTE 8
+#define BITS_PER_NIBBLE 4
+#define FLETCHER_MODULUS 255
+
+typedef struct {
+  uint32_t sequence;
+  uint32_t timestamp;
+  uint16_t sampleCount;
+  uint8_t bitsPerSample;
+  bool adcInputMode;
+  uint8_t payload[MAX_PAYLOAD_BYTE_COUNT];
+} adcStream_block_t;
+
+// Same single-producer/single-consumer scheme as the ADC buffer in isr.c:
+// adcStream_addSample() (the ISR) is the only writer of writeBlockIndex and
+// adcStream_flush() (the main loop) the only writer of readBlockIndex. The
+// block at writeBlockIndex is the one being filled, and only while there is
+// room for it in the ring.
+static adcStream_block_t blocks[ADC_STREAM_BLOCK_COUNT];
+static uint32_t writeBlockIndex;
+static uint32_t readBlockIndex;
+
+// Producer state, only touched by adcStream_addSample() once running.
+static bool running;
+static bool stopRequested; // Set by adcStream_stop(), seen by the ISR.
+static adcStream_format_t currentFormat;
+static bool currentAdcInputMode;
+static uint32_t remainingSampleCount; // 0 means run until stopped.
+static bool stopWhenCountReached;
+static uint32_t sampleIndex; // Samples seen since adcStream_start().
+static uint32_t sequence;    // Of the block being filled.
+static uint16_t fillCount;   // Samples in the block being filled.
+static bool droppingBlock;   // No room in the ring for the current block.
+static uint32_t droppedBlockCount;
+
+// Bytes taken by count samples in format.
+static uint16_t adcStream_payloadByteCount(uint8_t bitsPerSample,
+                                           uint16_t count) {
+  if (bitsPerSample == ADC_STREAM_FORMAT_12_BIT)
+    return (count * 3 + 1) / 2;
+  return count * 2;
+}
+
+// Starts packing samples in format.
+void adcStream_start(adcStream_format_t format, bool adcInputMode,
+                     uint32_t sampleCount) {
+  writeBlockIndex = 0;
+  readBlockIndex = 0;
+  currentFormat = format;
+  currentAdcInputMode = adcInputMode;
+  remainingSampleCount = sampleCount;
+  stopWhenCountReached = sampleCount > 0;
+  sampleIndex = 0;
+  sequence = 0;
+  fillCount = 0;
+  droppingBlock = false;
+  droppedBlockCount = 0;
+  stopRequested = false;
+  // Everything above must be in place before the ISR sees running.
+  __atomic_store_n(&running, true, __ATOMIC_RELEASE);
+}
+
+// Stops packing samples, at the next sample the ISR sees.
+void adcStream_stop() {
+  __atomic_store_n(&stopRequested, true, __ATOMIC_RELEASE);
+}
+
+// Returns true while samples are being packed.
+bool adcStream_isRunning() {
+  return __atomic_load_n(&running, __ATOMIC_ACQUIRE);
+}
+
+// Queues the block being filled (or counts it as dropped) and moves on to the
+// next one.
+static void adcStream_finishBlock() {
+  if (droppingBlock) {
+    droppedBlockCount++;
+  } else {
+    adcStream_block_t *block = &blocks[writeBlockIndex & BLOCK_INDEX_MASK];
+    block->sequence = sequence;
+    block->timestamp = sampleIndex - fillCount;
+    block->sampleCount = fillCount;
+    block->bitsPerSample = currentFormat;
+    block->adcInputMode = currentAdcInputMode;
+    // Publish the block only after it is complete.
+    __atomic_store_n(&writeBlockIndex, writeBlockIndex + 1, __ATOMIC_RELEASE);
+  }
+  sequence++;
+  fillCount = 0;
+}
+
+// Packs the sample into the current block.
+static void adcStream_packSample(uint8_t payload[], uint16_t index,
+                                 uint32_t adcValue) {
+  if (currentFormat == ADC_STREAM_FORMAT_16_BIT) {
+    payload[index * 2] = adcValue & BYTE_MASK;
+    payload[index * 2 + 1] = (adcValue >> BITS_PER_BYTE) & BYTE_MASK;
+    return;
+  }
+  uint8_t *bytes = &payload[(index / 2) * 3];
+  adcValue &= SAMPLE_12_BIT_MASK;
+  if (index % 2 == 0) {
+    bytes[0] = adcValue & BYTE_MASK;
+    bytes[1] = adcValue >> BITS_PER_BYTE;
+  } else {
+    bytes[1] |= (adcValue & NIBBLE_MASK) << BITS_PER_NIBBLE;
+    bytes[2] = adcValue >> BITS_PER_NIBBLE;
+  }
+}
+
+// Called by isr_function() with every ADC sample.
+void adcStream_addSample(uint32_t adcValue) {
+  if (!running)
+    return;
+  if (__atomic_load_n(&stopRequested, __ATOMIC_ACQUIRE)) {
+    if (fillCount > 0)
+      adcStream_finishBlock();
+    __atomic_store_n(&running, false, __ATOMIC_RELEASE);
+    return;
+  }
+  if (fillCount == 0) {
+    // Decide once per block whether there is room for it.
+    uint32_t read = __atomic_load_n(&readBlockIndex, __ATOMIC_ACQUIRE);
+    droppingBlock = writeBlockIndex - read >= ADC_STREAM_BLOCK_COUNT;
+  }
+  if (!droppingBlock)
+    adcStream_packSample(blocks[writeBlockIndex & BLOCK_INDEX_MASK].payload,
+                         fillCount, adcValue);
+  fillCount++;
+  sampleIndex++;
+  bool lastSample = stopWhenCountReached && --remainingSampleCount == 0;
+  if (fillCount == ADC_STREAM_BLOCK_SAMPLE_COUNT || lastSample)
+    adcStream_finishBlock();
+  if (lastSample)
+    __atomic_store_n(&running, false, __ATOMIC_RELEASE);
+}
+
+// Fletcher-16 checksum, continuing from checksum.
+static uint16_t adcStream_fletcher16(uint16_t checksum, const uint8_t bytes[],
+                                     uint32_t count) {
+  uint16_t sum1 = checksum & BYTE_MASK;
+  uint16_t sum2 = checksum >> BITS_PER_BYTE;
+  for (uint32_t i = 0; i < count; i++) {
+    sum1 = (sum1 + bytes[i]) % FLETCHER_MODULUS;
+    sum2 = (sum2 + sum1) % FLETCHER_MODULUS;
+  }
+  return (sum2 << BITS_PER_BYTE) | sum1;
+}
+
+static void adcStream_put16(uint8_t bytes[], uint16_t value) {
+  bytes[0] = value & BYTE_MASK;
+  bytes[1] = value >> BITS_PER_BYTE;
+}
+
+static void adcStream_put32(uint8_t bytes[], uint32_t value) {
+  adcStream_put16(bytes, value & 0xFFFF);
+  adcStream_put16(bytes + 2, value >> 16);
+}
+
+static uint16_t adcStream_get16(const uint8_t bytes[]) {
+  return bytes[0] | (bytes[1] << BITS_PER_BYTE);
+}
+
+static uint32_t adcStream_get32(const uint8_t bytes[]) {
+  return adcStream_get16(bytes) | ((uint32_t)adcStream_get16(bytes + 2) << 16);
+}
+
+// Writes count bytes to file, or to the UART if file is NULL.
+static void adcStream_write(FILE *file, const uint8_t bytes[],
+                            uint32_t count) {
+#ifdef ZYBO_BOARD
+  if (file == NULL) {
+    // Straight to the UART: the board's stdout adds a '\r' before every '\n'.
+    for (uint32_t i = 0; i < count; i++)
+      outbyte(bytes[i]);
+    return;
+  }
+#endif
+  fwrite(bytes, 1, count, file == NULL ? stdout : file);
+}
+
+// Writes every full block to file, one frame each.
+uint32_t adcStream_flush(FILE *file) {
+  uint32_t frameCount = 0;
+  uint32_t read = readBlockIndex; // Only this side writes it.
+  uint32_t write = __atomic_load_n(&writeBlockIndex, __ATOMIC_ACQUIRE);
+  while (read != write) {
+    adcStream_block_t *block = &blocks[read & BLOCK_INDEX_MASK];
+    uint16_t payloadByteCount =
+        adcStream_payloadByteCount(block->bitsPerSample, block->sampleCount);
+    uint8_t header[FRAME_HEADER_BYTE_COUNT];
+    adcStream_put16(header, ADC_STREAM_SYNC);
+    header[2] = block->bitsPerSample;
+    header[3] = block->adcInputMode;
+    adcStream_put32(header + 4, block->sequence);
+    adcStream_put32(header + 8, block->timestamp);
+    adcStream_put16(header + 12, block->sampleCount);
+    uint16_t checksum =
+        adcStream_fletcher16(0, header + SYNC_BYTE_COUNT,
+                             FRAME_HEADER_BYTE_COUNT - SYNC_BYTE_COUNT);
+    checksum = adcStream_fletcher16(checksum, block->payload, payloadByteCount);
+    uint8_t trailer[CHECKSUM_BYTE_COUNT];
+    adcStream_put16(trailer, checksum);
+    adcStream_write(file, header, FRAME_HEADER_BYTE_COUNT);
+    adcStream_write(file, block->payload, payloadByteCount);
+    adcStream_write(file, trailer, CHECKSUM_BYTE_COUNT);
+    frameCount++;
+    // Hand the block back to the ISR only after it has been written.
+    __atomic_store_n(&readBlockIndex, ++read, __ATOMIC_RELEASE);
+  }
+  if (frameCount > 0)
+    fflush(file == NULL ? stdout : file);
+  return frameCount;
+}
+
+// Returns the number of blocks dropped because the ring was full.
+uint32_t adcStream_getDroppedBlockCount() { return droppedBlockCount; }
+
+// Reads the next frame with a good checksum into block. Skips bytes until a
+// sync word and skips frames that fail their checks. Returns false at the end
+// of the stream. badFrameCount counts the frames that were skipped.
+static bool adcStream_readFrame(FILE *stream, adcStream_block_t *block,
+                                uint32_t *badFrameCount) {
+  uint8_t header[FRAME_HEADER_BYTE_COUNT];
+  while (true) {
+    // Hunt for the sync word a byte at a time.
+    int byte = fgetc(stream);
+    if (byte == EOF)
+      return false;
+    if (byte != (ADC_STREAM_SYNC & BYTE_MASK))
+      continue;
+    byte = fgetc(stream);
+    if (byte == EOF)
+      return false;
+    if (byte != ADC_STREAM_SYNC >> BITS_PER_BYTE) {
+      ungetc(byte, stream); // Could be the start of the real sync word.
+      continue;
+    }
+    uint16_t restByteCount = FRAME_HEADER_BYTE_COUNT - SYNC_BYTE_COUNT;
+    if (fread(header + SYNC_BYTE_COUNT, 1, restByteCount, stream) !=
+        restByteCount)
+      return false;
+    block->bitsPerSample = header[2];
+    block->adcInputMode = header[3];
+    block->sequence = adcStream_get32(header + 4);
+    block->timestamp = adcStream_get32(header + 8);
+    block->sampleCount = adcStream_get16(header + 12);
+    if ((block->bitsPerSample != ADC_STREAM_FORMAT_12_BIT &&
+         block->bitsPerSample != ADC_STREAM_FORMAT_16_BIT) ||
+        block->sampleCount > ADC_STREAM_BLOCK_SAMPLE_COUNT) {
+      (*badFrameCount)++;
+      continue;
+    }
+    uint16_t payloadByteCount =
+        adcStream_payloadByteCount(block->bitsPerSample, block->sampleCount);
+    uint8_t trailer[CHECKSUM_BYTE_COUNT];
+    if (fread(block->payload, 1, payloadByteCount, stream) !=
+            payloadByteCount ||
+        fread(trailer, 1, CHECKSUM_BYTE_COUNT, stream) != CHECKSUM_BYTE_COUNT)
+      return false;
+    uint16_t checksum = adcStream_fletcher16(0, header + SYNC_BYTE_COUNT,
+                                             restByteCount);
+    checksum = adcStream_fletcher16(checksum, block->payload, payloadByteCount);
+    if (checksum != adcStream_get16(trailer)) {
+      (*badFrameCount)++;
+      continue;
+    }
+    return true;
+  }
+}
+
+// Unpacks the samples in block.
+static void adcStream_unpackBlock(const adcStream_block_t *block,
+                                  adcCapture_sample_t samples[]) {
+  for (uint16_t i = 0; i < block->sampleCount; i++) {
+    if (block->bitsPerSample == ADC_STREAM_FORMAT_16_BIT) {
+      samples[i] = adcStream_get16(&block->payload[i * 2]);
+      continue;
+    }
+    const uint8_t *bytes = &block->payload[(i / 2) * 3];
+    if (i % 2 == 0)
+      samples[i] = bytes[0] | ((bytes[1] & NIBBLE_MASK) << BITS_PER_BYTE);
+    else
+      samples[i] =
+          (bytes[1] >> BITS_PER_NIBBLE) | (bytes[2] << BITS_PER_NIBBLE);
+  }
+}
+
+// Host side: converts a saved stream into an adcCapture file.
+bool adcStream_convertToCapture(FILE *stream, FILE *capture) {
+  static adcStream_block_t block;
+  static adcCapture_sample_t samples[ADC_STREAM_BLOCK_SAMPLE_COUNT];
+  uint32_t frameCount = 0;
+  uint32_t badFrameCount = 0;
+  uint32_t missingFrameCount = 0;
+  uint32_t expectedSequence = 0;
+  while (adcStream_readFrame(stream, &block, &badFrameCount)) {
+    if (frameCount == 0) {
+      adcCapture_header_t header = {.adcInputMode = block.adcInputMode,
+                                    .sampleRateHz = ADC_CAPTURE_SAMPLE_RATE_HZ};
+      adcCapture_writeHeader(capture, &header);
+    }
+    int32_t gap = (int32_t)(block.sequence - expectedSequence);
+    if (gap < 0) {
+      // The stream restarted or two streams were saved back to back. Capture
+      // time must only go forwards, so the capture ends here.
+      printf("adcStream_convertToCapture: frame %d follows frame %d, "
+             "stopping.\n",
+             block.sequence, expectedSequence - 1);
+      break;
+    }
+    if (gap > 0) {
+      printf("adcStream_convertToCapture: frames %d to %d are missing.\n",
+             expectedSequence, block.sequence - 1);
+      missingFrameCount += gap;
+    }
+    expectedSequence = block.sequence + 1;
+    adcStream_unpackBlock(&block, samples);
+    adcCapture_writeBlock(capture, block.timestamp, samples, block.sampleCount);
+    frameCount++;
+  }
+  printf("adcStream_convertToCapture: %d frames, %d missing, %d bad.\n",
+         frameCount, missingFrameCount, badFrameCount);
+  return frameCount > 0;
+}
+
+/*******************************************************
+ ****************** Test Routines **********************
+ ******************************************************/
+
+#define TEST_SAMPLE_STEP 37 // Makes neighbouring samples different.
+#define TEST_PARTIAL_BLOCK_SAMPLE_COUNT 100
+#define TEST_NOISE "\xAD noise between frames\n"
+
+static adcCapture_sample_t adcStream_testSample(uint32_t index) {
+  return (index * TEST_SAMPLE_STEP) & SAMPLE_12_BIT_MASK;
+}
+
+// Streams blockCount full blocks and a partial one in format. If dropBlock,
+// the ring is overfilled by one block before anything is flushed, so that
+// block must show up as a gap. Then converts the stream and checks the
+// capture against the samples that were streamed.
+static bool adcStream_runFormatTest(adcStream_format_t format,
+                                    uint32_t blockCount, bool dropBlock) {
+  static adcCapture_sample_t samples[ADC_CAPTURE_MAX_BLOCK_SAMPLE_COUNT];
+  FILE *stream = tmpfile();
+  FILE *capture = tmpfile();
+  if (stream == NULL || capture == NULL) {
+    printf("adcStream_runTest: could not create a temporary file.\n");
+    return false;
+  }
+  uint32_t sampleCount = blockCount * ADC_STREAM_BLOCK_SAMPLE_COUNT +
+                         TEST_PARTIAL_BLOCK_SAMPLE_COUNT;
+  uint32_t droppedBlock = ADC_STREAM_BLOCK_COUNT; // First one with no room.
+  adcStream_start(format, true, sampleCount);
+  bool success = true;
+  for (uint32_t i = 0; i < sampleCount; i++) {
+    // Without dropBlock, flush whenever a block is ready so none are lost.
+    if (!dropBlock || i == (droppedBlock + 1) * ADC_STREAM_BLOCK_SAMPLE_COUNT) {
+      if (adcStream_flush(stream) > 0 && dropBlock)
+        fputs(TEST_NOISE, stream);
+    }
+    adcStream_addSample(adcStream_testSample(i));
+  }
+  success &= !adcStream_isRunning();
+  adcStream_flush(stream);
+  success &= adcStream_getDroppedBlockCount() == (dropBlock ? 1 : 0);
+  rewind(stream);
+  success &= adcStream_convertToCapture(stream, capture);
+  rewind(capture);
+
+  adcCapture_header_t header;
+  success &= adcCapture_readHeader(capture, &header);
+  uint32_t timestamp;
+  uint32_t expectedTimestamp = 0;
+  uint16_t count;
+  while ((count = adcCapture_readBlock(capture, &timestamp, samples)) > 0) {
+    if (dropBlock &&
+        expectedTimestamp == droppedBlock * ADC_STREAM_BLOCK_SAMPLE_COUNT)
+      expectedTimestamp += ADC_STREAM_BLOCK_SAMPLE_COUNT;
+    if (timestamp != expectedTimestamp) {
+      printf("adcStream_runTest: block at %d, expected %d.\n", timestamp,
+             expectedTimestamp);
+      success = false;
+      break;
+    }
+    for (uint16_t i = 0; i < count; i++) {
+      if (samples[i] != adcStream_testSample(timestamp + i)) {
+        printf("adcStream_runTest: sample %d does not match.\n",
+               timestamp + i);
+        success = false;
+        break;
+      }
+    }
+    expectedTimestamp += count;
+  }
+  if (expectedTimestamp != sampleCount) {
+    printf("adcStream_runTest: capture ends at %d, expected %d.\n",
+           expectedTimestamp, sampleCount);
+    success = false;
+  }
+  fclose(stream);
+  fclose(capture);
+  return success;
+}
+
+// Streams a known pattern in both formats, converts it and checks the capture.
+bool adcStream_runTest() {
+  printf("Running adcStream_runTest()\n");
+  bool success = true;
+  success &= adcStream_runFormatTest(ADC_STREAM_FORMAT_16_BIT, 3, false);
+  success &= adcStream_runFormatTest(ADC_STREAM_FORMAT_12_BIT,
+                                     ADC_STREAM_BLOCK_COUNT + 2, true);
+  printf("adcStream_runTest %s.\n", success ? "passed" : "failed");
+  return success;
+}
@@ -0,0 +1,95 @@
+/*
+This software is provided for student assignment use in the Department of
+Electrical and Computer Engineering, Brigham Young University, Utah, USA.
+Users agree to not re-host, or redistribute the software, in source or binary
+form, to other persons or other institutions. Users may modify and use the
+source code for personal or educational use.
+For questions, contact Brad Hutchings or Jeff Goeders, https://ece.byu.edu/
+*/
+
+#ifndef ADCSTREAM_H_
+#define ADCSTREAM_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "adcCapture.h"
+
+// Full-rate raw ADC streaming. isr_function() hands every sample to
+// adcStream_addSample(), which packs it into the block being filled. Full
+// blocks wait in a ring of ADC_STREAM_BLOCK_COUNT blocks until the main loop
+// writes them out with adcStream_flush(), so the ISR never waits on the UART
+// and the main loop never touches a block that is still being filled. The
+// ring is single-producer/single-consumer like the ADC buffer (see isr.h).
+//
+// If the ring is full when a block fills, that block is dropped, but its
+// sequence number and samples are still counted, so the receiver sees the
+// missing sequence number and a timestamp gap. Two blocks is plain double
+// buffering and is enough for a sink that keeps up (a file on the emulator).
+// The UART can't carry 100 kHz of 12-bit samples, so for a lossless capture
+// over the UART the ring has to hold the whole capture; the default holds
+// about 5 seconds.
+//
+// Each block is written as one frame, all fields little-endian:
+//   uint16 sync (ADC_STREAM_SYNC), uint8 bits per sample (12 or 16),
+//   uint8 ADC input mode, uint32 sequence number, uint32 timestamp (index of
+//   the first sample, counted from adcStream_start()), uint16 sample count,
+//   the packed samples, uint16 Fletcher-16 checksum of everything after the
+//   sync word.
+// 16-bit samples are one little-endian uint16 each. 12-bit samples are packed
+// two to three bytes: the first sample is the low 12 bits and the second the
+// high 12 bits of a little-endian 24-bit value.
+//
+// adcStream_convertToCapture() turns a saved stream into an adcCapture file
+// that adcReplay can run through the detector.
+
+#define ADC_STREAM_SYNC 0xC5AD
+#define ADC_STREAM_BLOCK_SAMPLE_COUNT 2048
+#define ADC_STREAM_BLOCK_COUNT 256 // About 5.2 seconds at 100 kHz.
+
+typedef enum {
+  ADC_STREAM_FORMAT_12_BIT = 12, // 1.5 bytes per sample.
+  ADC_STREAM_FORMAT_16_BIT = 16  // 2 bytes per sample.
+} adcStream_format_t;
+
+// Starts packing samples handed to adcStream_addSample() in format, with
+// sequence numbers and timestamps starting at 0. Stops by itself after
+// sampleCount samples, or never if sampleCount is 0. adcInputMode is recorded
+// in every frame.
+void adcStream_start(adcStream_format_t format, bool adcInputMode,
+                     uint32_t sampleCount);
+
+// Stops packing samples. A partly filled block is finished and queued so
+// nothing already sampled is lost.
+void adcStream_stop();
+
+// Returns true while samples are being packed.
+bool adcStream_isRunning();
+
+// Called by isr_function() with every ADC sample. Does nothing unless the
+// stream is running.
+void adcStream_addSample(uint32_t adcValue);
+
+// Writes every full block to file, one frame each. Call from the main loop.
+// If file is NULL the frames go to the UART (stdout on the emulator); on the
+// board they bypass stdio, which would add a '\r' before every '\n' byte.
+// Returns the number of frames written.
+uint32_t adcStream_flush(FILE *file);
+
+// Returns the number of blocks dropped because the ring was full.
+uint32_t adcStream_getDroppedBlockCount();
+
+// Host side: reads frames from stream and writes them to capture as an
+// adcCapture file. Skips anything between frames, reports frames with a bad
+// checksum (they are dropped) and sequence numbers that are missing. If a
+// sequence number goes backwards (the stream restarted) the capture ends
+// there. Returns false if no frame could be read.
+bool adcStream_convertToCapture(FILE *stream, FILE *capture);
+
+// Streams a known pattern in both formats into a temporary file, including a
+// dropped block and some noise between frames, converts it and checks the
+// capture. Returns true if it matches.
+bool adcStream_runTest();
+
+#endif /* ADCSTREAM_H_ */
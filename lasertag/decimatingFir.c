@@ -0,0 +1,158 @@
+/*
+This software is provided for student assignment use in the Department of
+Electrical and Computer Engineering, Brigham Young University, Utah, USA.
+Users agree to not re-host, or redistribute the software, in source or binary
+form, to other persons or other institutions. Users may modify and use the
+source code for personal or educational use.
+For questions, contact Brad Hutchings or Jeff Goeders, https://ece.byu.edu/
+*/
+
+#include <assert.h>
+#include <stdio.h>
+
+#include "decimatingFir.h"
+#include "mirroredBuffer.h"
+
+// The coefficients belong to the caller (filter.c).
+static const double *coefficients = NULL;
+static uint32_t coefficientCount = 0;
+static uint16_t decimationFactor = 1;
+
+// The last coefficientCount inputs, mirrored (see mirroredBuffer.h) so that
+// computeOutput() can read them as one array. historyIndex always points to
+// the slot that the next input will be written to (the oldest input).
+static double
+    history[MIRRORED_BUFFER_COPY_COUNT * DECIMATING_FIR_MAX_COEFFICIENT_COUNT];
+static uint32_t historyIndex = 0;
+
+// One partially-accumulated output for each decimated output that the inputs
+// in history still contribute to. currentAccumulator is the output that will
+// be completed at the end of the current decimation block, the following
+// accumulators are the outputs for the blocks after that.
+static double accumulators[DECIMATING_FIR_MAX_COEFFICIENT_COUNT];
+static uint32_t accumulatorCount = 0;
+static uint32_t currentAccumulator = 0;
+
+// Number of inputs added to the current decimation block.
+static uint16_t phase = 0;
+
+// Most recently completed output.
+static double output = 0.0;
+
+// Keep track of the work performed, for benchmarking.
+static uint32_t multiplyAccumulateCount = 0;
+
+// Must call this prior to using any other decimatingFir functions.
+// The coefficient array is not copied so it must remain valid. All history is
+// set to 0.0.
+void decimatingFir_init(const double coefficientArray[], uint32_t count,
+                        uint16_t factor) {
+  if (count == 0 || count > DECIMATING_FIR_MAX_COEFFICIENT_COUNT) {
+    printf("decimatingFir_init(): coefficient count (%u) must be between 1 and "
+           "%d.\n",
+           count, DECIMATING_FIR_MAX_COEFFICIENT_COUNT);
+    assert(false);
+  }
+  if (factor == 0 || factor > DECIMATING_FIR_MAX_DECIMATION_FACTOR) {
+    printf("decimatingFir_init(): decimation factor (%u) must be between 1 and "
+           "%d.\n",
+           factor, DECIMATING_FIR_MAX_DECIMATION_FACTOR);
+    assert(false);
+  }
+  coefficients = coefficientArray;
+  coefficientCount = count;
+  decimationFactor = factor;
+  // An input contributes to at most this many decimated outputs.
+  accumulatorCount = (count + factor - 1) / factor;
+  currentAccumulator = 0;
+  phase = 0;
+  multiplyAccumulateCount = 0;
+  output = 0.0;
+  decimatingFir_fill(0.0);
+}
+
+// Adds a new input to the filter. Returns true if this input completed a
+// decimation block and a new output is available from
+// decimatingFir_getOutput().
+bool decimatingFir_addNewInput(double x) {
+  // Overwrite the oldest input.
+  mirroredBuffer_push(history, &historyIndex, coefficientCount, &x, sizeof(x));
+  // The output for the current block is computed after decimationFactor
+  // inputs, so this input is multiplied by coefficient
+  // (decimationFactor - 1 - phase) for the current block, and by every
+  // decimationFactor'th coefficient after that for the following blocks.
+  uint32_t accumulatorIndex = currentAccumulator;
+  for (uint32_t k = decimationFactor - 1 - phase; k < coefficientCount;
+       k += decimationFactor) {
+    accumulators[accumulatorIndex] += coefficients[k] * x;
+    if (++accumulatorIndex == accumulatorCount)
+      accumulatorIndex = 0;
+    multiplyAccumulateCount++;
+  }
+  // If the block isn't complete yet, there is no new output.
+  if (++phase < decimationFactor)
+    return false;
+  // The current output has all of its contributions. The accumulator is
+  // reused for the output that is accumulatorCount blocks away.
+  output = accumulators[currentAccumulator];
+  accumulators[currentAccumulator] = 0.0;
+  if (++currentAccumulator == accumulatorCount)
+    currentAccumulator = 0;
+  phase = 0;
+  return true;
+}
+
+// Returns the most recently completed decimated output.
+double decimatingFir_getOutput() { return output; }
+
+// Adds count inputs and writes every decimated output they complete to
+// outputs, in order. Returns the number of outputs written.
+uint32_t decimatingFir_filterBlock(const double inputs[], uint32_t count,
+                                   double outputs[]) {
+  uint32_t outputCount = 0;
+  for (uint32_t i = 0; i < count; i++) {
+    if (decimatingFir_addNewInput(inputs[i]))
+      outputs[outputCount++] = output;
+  }
+  return outputCount;
+}
+
+// Computes the FIR output for the current contents of the history, regardless
+// of where the filter is in the decimation block.
+double decimatingFir_computeOutput() {
+  // The newest input goes with coefficient 0.
+  const double *newest = mirroredBuffer_getNewest(
+      history, historyIndex, coefficientCount, sizeof(history[0]));
+  double sum = 0.0;
+  for (uint32_t k = 0; k < coefficientCount; k++)
+    sum += coefficients[k] * newest[-(int32_t)k];
+  multiplyAccumulateCount += coefficientCount;
+  return sum;
+}
+
+// Fills the entire input history with fillValue and recomputes the partially
+// accumulated outputs to match, as if fillValue had been the input forever.
+void decimatingFir_fill(double fillValue) {
+  for (uint32_t i = 0; i < MIRRORED_BUFFER_COPY_COUNT * coefficientCount; i++)
+    history[i] = fillValue;
+  historyIndex = 0;
+  // The accumulator for the output that is i blocks away already holds the
+  // products for every input received so far. Those inputs line up with every
+  // coefficient starting at (decimationFactor - phase) + i * decimationFactor.
+  for (uint32_t i = 0; i < accumulatorCount; i++) {
+    double sum = 0.0;
+    for (uint32_t k = (decimationFactor - phase) + i * decimationFactor;
+         k < coefficientCount; k++)
+      sum += coefficients[k];
+    accumulators[(currentAccumulator + i) % accumulatorCount] =
+        sum * fillValue;
+  }
+}
+
+// Returns the number of inputs added since the last decimated output.
+uint16_t decimatingFir_getPhase() { return phase; }
+
+// Returns the number of multiply-adds performed since decimatingFir_init().
+uint32_t decimatingFir_getMultiplyAccumulateCount() {
+  return multiplyAccumulateCount;
+}
@@ -0,0 +1,79 @@
+/*
+This software is provided for student assignment use in the Department of
+Electrical and Computer Engineering, Brigham Young University, Utah, USA.
+Users agree to not re-host, or redistribute the software, in source or binary
+form, to other persons or other institutions. Users may modify and use the
+source code for personal or educational use.
+For questions, contact Brad Hutchings or Jeff Goeders, https://ece.byu.edu/
+*/
+
+#ifndef DECIMATINGFIR_H_
+#define DECIMATINGFIR_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Polyphase implementation of the decimating FIR-filter.
+// Only every FILTER_FIR_DECIMATION_FACTOR'th output of the FIR-filter is ever
+// used, so instead of running the whole filter over xQueue each time an output
+// is wanted, each new input is multiplied against only the coefficients that
+// contribute to the outputs that will actually be kept. Those partial products
+// are accumulated as the samples arrive, so a complete output is ready as soon
+// as the last input of a decimation block is added. The total work is one
+// multiply-add per coefficient per decimated output, the same as running
+// filter_firFilter() once per decimation block. What changes is when it is
+// done: the work is spread evenly across the inputs instead of arriving as a
+// burst of every multiply-add on every FILTER_FIR_DECIMATION_FACTOR'th input,
+// so no single input pays for a whole output.
+//
+// filter.c uses this as the engine behind the existing API:
+// filter_addNewInput() forwards each input to decimatingFir_addNewInput(), and
+// filter_firFilter() returns decimatingFir_getOutput() when a decimation block
+// has just completed. decimatingFir_computeOutput() is still available for
+// callers that need an output at an arbitrary phase (the filterTest alignment
+// and arithmetic tests, for example).
+
+// Max number of FIR coefficients that the engine can hold.
+#define DECIMATING_FIR_MAX_COEFFICIENT_COUNT 128
+
+// Max decimation factor supported by the engine.
+#define DECIMATING_FIR_MAX_DECIMATION_FACTOR 32
+
+// Must call this prior to using any other decimatingFir functions.
+// The coefficient array is not copied so it must remain valid. All history is
+// set to 0.0.
+void decimatingFir_init(const double coefficients[], uint32_t coefficientCount,
+                        uint16_t decimationFactor);
+
+// Adds a new input to the filter. Returns true if this input completed a
+// decimation block and a new output is available from
+// decimatingFir_getOutput().
+bool decimatingFir_addNewInput(double x);
+
+// Returns the most recently completed decimated output.
+double decimatingFir_getOutput();
+
+// Adds count inputs and writes every decimated output they complete to
+// outputs, in order. Returns the number of outputs written, at most
+// count / decimation factor + 1. The decimation phase carries over between
+// calls so blocks can be any size.
+uint32_t decimatingFir_filterBlock(const double inputs[], uint32_t count,
+                                   double outputs[]);
+
+// Computes the FIR output for the current contents of the history, regardless
+// of where the filter is in the decimation block. This does a full pass over
+// the coefficients so avoid it in the detector loop.
+double decimatingFir_computeOutput();
+
+// Fills the entire input history with fillValue and recomputes the partially
+// accumulated outputs to match, as if fillValue had been the input forever.
+void decimatingFir_fill(double fillValue);
+
+// Returns the number of inputs added since the last decimated output.
+uint16_t decimatingFir_getPhase();
+
+// Returns the number of multiply-adds performed since decimatingFir_init().
+// Handy for checking how the work is spread over the inputs.
+uint32_t decimatingFir_getMultiplyAccumulateCount();
+
+#endif /* DECIMATINGFIR_H_ */
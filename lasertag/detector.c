@@ -0,0 +1,328 @@
+/*
+This software is provided for student assignment use in the Department of
+Electrical and Computer Engineering, Brigham Young University, Utah, USA.
+Users agree to not re-host, or redistribute the software, in source or binary
+form, to other persons or other institutions. Users may modify and use the
+source code for personal or educational use.
+For questions, contact Brad Hutchings or Jeff Goeders, https://ece.byu.edu/
+*/
+
+#include <stdio.h>
+
+#include "detector.h"
+#include "eventJournal.h"
+#include "filter.h"
+#include "filterBlock.h"
+#include "filterFixedPoint.h"
+#include "hitLedTimer.h"
+#include "hitThreshold.h"
+#include "isr.h"
+#include "lockoutTimer.h"
+#include "slidingDft.h"
+
+#define DETECTOR_ADC_MAX_VALUE 4095.0 // 12-bit XADC.
+// ADC values are removed from the ADC buffer this many at a time.
+#define DETECTOR_ADC_BLOCK_SIZE 256
+
+// A hit is the largest power value when it is larger than the median power
+// value times the fudge factor.
+#define DETECTOR_FUDGE_FACTOR_COUNT 6
+#define DETECTOR_DEFAULT_FUDGE_FACTOR_INDEX 2
+static const double detector_fudgeFactors[DETECTOR_FUDGE_FACTOR_COUNT] = {
+    25.0, 50.0, 100.0, 200.0, 500.0, 1000.0};
+static uint32_t fudgeFactorIndex = DETECTOR_DEFAULT_FUDGE_FACTOR_INDEX;
+
+static detector_engine_t currentEngine = DETECTOR_ENGINE_IIR;
+static detector_hitTest_t currentHitTest = DETECTOR_HIT_TEST_MEDIAN;
+static bool ignoredFrequencyFlags[FILTER_FREQUENCY_COUNT];
+static uint16_t decimationCount = 0;
+
+static bool hitDetectedFlag = false;
+static bool ignoreAllHitsFlag = false;
+static uint16_t lastHitFrequencyNumber = 0;
+static detector_hitCount_t hitCounts[FILTER_FREQUENCY_COUNT];
+
+// Always have to init things.
+// bool array is indexed by frequency number, array location set for true to
+// ignore, false otherwise. This way you can ignore multiple frequencies.
+// Uses DETECTOR_ENGINE_IIR.
+void detector_init(bool ignoredFrequencies[]) {
+  detector_initWithEngine(ignoredFrequencies, DETECTOR_ENGINE_IIR);
+}
+
+// Same as detector_init() but selects the engine used to compute power.
+void detector_initWithEngine(bool ignoredFrequencies[],
+                             detector_engine_t engine) {
+  for (uint16_t i = 0; i < FILTER_FREQUENCY_COUNT; i++) {
+    ignoredFrequencyFlags[i] = ignoredFrequencies[i];
+    hitCounts[i] = 0;
+  }
+  currentEngine = engine;
+  decimationCount = 0;
+  hitDetectedFlag = false;
+  ignoreAllHitsFlag = false;
+  lastHitFrequencyNumber = 0;
+  hitThreshold_init();
+  if (engine == DETECTOR_ENGINE_SLIDING_DFT)
+    slidingDft_init();
+  else if (engine == DETECTOR_ENGINE_IIR_BLOCK)
+    filterBlock_init();
+#ifdef FILTER_USE_FIXED_POINT
+  else
+    filterFixedPoint_init();
+#endif
+}
+
+// Copies the current power values from whichever engine the detector is using,
+// with the same contract as filter_getCurrentPowerValues().
+void detector_getCurrentPowerValues(double powerValues[]) {
+  switch (currentEngine) {
+  case DETECTOR_ENGINE_SLIDING_DFT:
+    slidingDft_getCurrentPowerValues(powerValues);
+    break;
+  case DETECTOR_ENGINE_IIR_BLOCK:
+    filterBlock_getCurrentPowerValues(powerValues);
+    break;
+  case DETECTOR_ENGINE_IIR:
+  default:
+#ifdef FILTER_USE_FIXED_POINT
+    filterFixedPoint_getCurrentPowerValues(powerValues);
+#else
+    filter_getCurrentPowerValues(powerValues);
+#endif
+    break;
+  }
+}
+
+// Runs the hit-detection algorithm on powerValues with the current fudge
+// factor, ignoring nothing. Returns true and sets frequencyNumber if the
+// largest power is a hit.
+bool detector_powerValuesIndicateHit(const double powerValues[],
+                                     uint16_t *frequencyNumber) {
+  double threshold = hitThreshold_getMedian(powerValues) *
+                     detector_fudgeFactors[fudgeFactorIndex];
+  // Find the frequency with the largest power.
+  uint16_t maxIndex = 0;
+  for (uint16_t i = 1; i < FILTER_FREQUENCY_COUNT; i++) {
+    if (powerValues[i] > powerValues[maxIndex])
+      maxIndex = i;
+  }
+  if (powerValues[maxIndex] > threshold) {
+    *frequencyNumber = maxIndex;
+    return true;
+  }
+  return false;
+}
+
+// Runs the engine on a decimated sample (FIR output) so the power values are
+// up to date.
+static void detector_runEngine() {
+  switch (currentEngine) {
+  case DETECTOR_ENGINE_SLIDING_DFT:
+    slidingDft_addNewInput(filter_firFilter());
+    break;
+  case DETECTOR_ENGINE_IIR:
+  default:
+#ifdef FILTER_USE_FIXED_POINT
+    filterFixedPoint_firFilter();
+    for (uint16_t i = 0; i < FILTER_FREQUENCY_COUNT; i++)
+      filterFixedPoint_iirFilter(i); // Also keeps the power up to date.
+#else
+    filter_firFilter();
+    for (uint16_t i = 0; i < FILTER_FREQUENCY_COUNT; i++) {
+      filter_iirFilter(i);
+      filter_computePower(i, false, false);
+    }
+#endif
+    break;
+  }
+}
+
+// Looks for a hit in the current power values and records it. Only looks if
+// the lockout timer isn't running and the last hit has been accounted for.
+static void detector_checkForHit() {
+  if (lockoutTimer_running() || hitDetectedFlag || ignoreAllHitsFlag)
+    return;
+  double powerValues[FILTER_FREQUENCY_COUNT];
+  detector_getCurrentPowerValues(powerValues);
+  uint16_t frequencyNumber;
+  bool hit = currentHitTest == DETECTOR_HIT_TEST_ADAPTIVE
+                 ? hitThreshold_check(powerValues,
+                                      detector_fudgeFactors[fudgeFactorIndex],
+                                      &frequencyNumber)
+                 : detector_powerValuesIndicateHit(powerValues,
+                                                   &frequencyNumber);
+  if (hit && !ignoredFrequencyFlags[frequencyNumber]) {
+    lockoutTimer_start();
+    hitLedTimer_start();
+    hitCounts[frequencyNumber]++;
+    lastHitFrequencyNumber = frequencyNumber;
+    hitDetectedFlag = true;
+    eventJournal_recordHit(frequencyNumber, powerValues);
+  }
+}
+
+// Feeds one ADC value through the filters and checks for a hit after every
+// decimated sample.
+static void detector_processAdcValue(isr_AdcValue_t rawAdcValue) {
+#if defined(FILTER_USE_FIXED_POINT)
+  // The sliding DFT still uses the FIR-filter in filter.c.
+  if (currentEngine == DETECTOR_ENGINE_SLIDING_DFT)
+    filter_addNewInput(detector_getScaledAdcValue(rawAdcValue));
+  else
+    filterFixedPoint_addNewInput(filterFixedPoint_fromAdc(rawAdcValue));
+#else
+  filter_addNewInput(detector_getScaledAdcValue(rawAdcValue));
+#endif
+  if (++decimationCount < FILTER_FIR_DECIMATION_FACTOR)
+    return; // Not time to run the rest of the filters yet.
+  decimationCount = 0;
+  detector_runEngine();
+  detector_checkForHit();
+}
+
+// Runs the block engine over every value currently in the ADC buffer, a block
+// at a time, checking for a hit after each block.
+static void detector_processAdcBlocks() {
+  static isr_AdcValue_t rawAdcValues[FILTER_BLOCK_MAX_INPUT_COUNT];
+  static double scaledAdcValues[FILTER_BLOCK_MAX_INPUT_COUNT];
+  uint32_t remainingCount = isr_adcBufferElementCount();
+  while (remainingCount > 0) {
+    uint32_t blockCount = isr_removeDataFromAdcBufferBatch(
+        rawAdcValues, remainingCount < FILTER_BLOCK_MAX_INPUT_COUNT
+                          ? remainingCount
+                          : FILTER_BLOCK_MAX_INPUT_COUNT);
+    if (blockCount == 0)
+      break;
+    for (uint32_t i = 0; i < blockCount; i++)
+      scaledAdcValues[i] = detector_getScaledAdcValue(rawAdcValues[i]);
+    if (filterBlock_processBlock(scaledAdcValues, blockCount) > 0)
+      detector_checkForHit();
+    remainingCount -= blockCount;
+  }
+}
+
+// Runs the entire detector: decimating fir-filter, iir-filters,
+// power-computation, hit-detection. The ADC buffer is a lock-free
+// single-producer/single-consumer ring so it is drained a block at a time
+// without disabling interrupts; interruptsCurrentlyEnabled no longer matters.
+void detector(bool interruptsCurrentlyEnabled) {
+  if (currentEngine == DETECTOR_ENGINE_IIR_BLOCK) {
+    detector_processAdcBlocks();
+    return;
+  }
+  isr_AdcValue_t rawAdcValues[DETECTOR_ADC_BLOCK_SIZE];
+  // Only process what is in the buffer now, more will show up while working.
+  uint32_t remainingCount = isr_adcBufferElementCount();
+  while (remainingCount > 0) {
+    uint32_t blockCount = isr_removeDataFromAdcBufferBatch(
+        rawAdcValues, remainingCount < DETECTOR_ADC_BLOCK_SIZE
+                          ? remainingCount
+                          : DETECTOR_ADC_BLOCK_SIZE);
+    if (blockCount == 0)
+      break;
+    for (uint32_t i = 0; i < blockCount; i++)
+      detector_processAdcValue(rawAdcValues[i]);
+    remainingCount -= blockCount;
+  }
+}
+
+// Returns true if a hit was detected.
+bool detector_hitDetected() { return hitDetectedFlag; }
+
+// Returns the frequency number that caused the hit.
+uint16_t detector_getFrequencyNumberOfLastHit() {
+  return lastHitFrequencyNumber;
+}
+
+// Clear the detected hit once you have accounted for it.
+void detector_clearHit() { hitDetectedFlag = false; }
+
+// Ignore all hits.
+void detector_ignoreAllHits(bool flagValue) { ignoreAllHitsFlag = flagValue; }
+
+// Get the current hit counts.
+void detector_getHitCounts(detector_hitCount_t hitArray[]) {
+  for (uint16_t i = 0; i < FILTER_FREQUENCY_COUNT; i++)
+    hitArray[i] = hitCounts[i];
+}
+
+// Selects how the detector decides whether the power values are a hit.
+void detector_setHitTest(detector_hitTest_t hitTest) {
+  currentHitTest = hitTest;
+}
+
+// Allows the fudge-factor index to be set externally from the detector.
+void detector_setFudgeFactorIndex(uint32_t factor) {
+  if (factor >= DETECTOR_FUDGE_FACTOR_COUNT) {
+    printf("detector_setFudgeFactorIndex(): index %u is too large, must be "
+           "less than %d.\n",
+           factor, DETECTOR_FUDGE_FACTOR_COUNT);
+    return;
+  }
+  fudgeFactorIndex = factor;
+}
+
+// Encapsulate ADC scaling for easier testing. Scales 0 to 4095 to -1.0 to 1.0.
+double detector_getScaledAdcValue(isr_AdcValue_t adcValue) {
+  return (adcValue * 2.0 / DETECTOR_ADC_MAX_VALUE) - 1.0;
+}
+
+/*******************************************************
+ ****************** Test Routines **********************
+ ******************************************************/
+
+// Test power values. Frequency 9 stands well above the median in the first
+// set, nothing does in the second.
+static const double detector_hitPowerValues[FILTER_FREQUENCY_COUNT] = {
+    150.0, 20.0, 40.0, 10.0, 15.0, 30.0, 35.0, 15.0, 25.0, 8000.0};
+static const double detector_noHitPowerValues[FILTER_FREQUENCY_COUNT] = {
+    150.0, 20.0, 40.0, 10.0, 15.0, 30.0, 35.0, 15.0, 25.0, 80.0};
+#define DETECTOR_TEST_HIT_FREQUENCY 9
+
+// Create two sets of power values and call the hit detection algorithm
+// on each set. With the same fudge factor, the hit detect algorithm
+// should detect a hit on the first set and not detect a hit on the second.
+void detector_runTest() {
+  printf("******** detector_runTest() **********\n");
+  bool success = true; // Be optimistic.
+  uint16_t frequencyNumber = 0;
+  if (!detector_powerValuesIndicateHit(detector_hitPowerValues,
+                                       &frequencyNumber) ||
+      frequencyNumber != DETECTOR_TEST_HIT_FREQUENCY) {
+    printf("detector_runTest: expected a hit on frequency %d.\n",
+           DETECTOR_TEST_HIT_FREQUENCY);
+    success = false;
+  }
+  if (detector_powerValuesIndicateHit(detector_noHitPowerValues,
+                                      &frequencyNumber)) {
+    printf("detector_runTest: detected a hit on frequency %d, expected no "
+           "hit.\n",
+           frequencyNumber);
+    success = false;
+  }
+  // The adaptive test starts with no noise floor, so it must agree.
+  hitThreshold_init();
+  if (!hitThreshold_check(detector_hitPowerValues,
+                          detector_fudgeFactors[fudgeFactorIndex],
+                          &frequencyNumber) ||
+      frequencyNumber != DETECTOR_TEST_HIT_FREQUENCY) {
+    printf("detector_runTest: adaptive test expected a hit on frequency %d.\n",
+           DETECTOR_TEST_HIT_FREQUENCY);
+    success = false;
+  }
+  if (hitThreshold_check(detector_noHitPowerValues,
+                         detector_fudgeFactors[fudgeFactorIndex],
+                         &frequencyNumber)) {
+    printf("detector_runTest: adaptive test detected a hit on frequency %d, "
+           "expected no hit.\n",
+           frequencyNumber);
+    success = false;
+  }
+  hitThreshold_init();
+  printf("detector_runTest ");
+  if (success)
+    printf("passed.\n");
+  else
+    printf("failed.\n");
+}
@@ -18,19 +18,46 @@ For questions, contact Brad Hutchings or Jeff Goeders, https://ece.byu.edu/
 
 typedef uint16_t detector_hitCount_t;
 
+// Ways the detector can compute the power at each player frequency.
+typedef enum {
+  // Decimating FIR, 10 IIR bandpass filters and their output power (filter.c).
+  DETECTOR_ENGINE_IIR,
+  // Decimating FIR followed by one sliding DFT bin per player frequency
+  // (slidingDft.c). Much less work per sample than the IIR filters.
+  DETECTOR_ENGINE_SLIDING_DFT,
+  // The same filters as DETECTOR_ENGINE_IIR run a block of ADC values at a
+  // time (filterBlock.c). Hits are checked once per block.
+  DETECTOR_ENGINE_IIR_BLOCK
+} detector_engine_t;
+
+// Ways the detector can decide whether the power values are a hit.
+typedef enum {
+  // The largest power is a hit if it is more than the median power times the
+  // fudge factor. No state, see detector_powerValuesIndicateHit().
+  DETECTOR_HIT_TEST_MEDIAN,
+  // The same test, plus a minimum power and a noise floor per channel
+  // (hitThreshold.c). Most calls stop at the minimum power.
+  DETECTOR_HIT_TEST_ADAPTIVE
+} detector_hitTest_t;
+
 // Always have to init things.
 // bool array is indexed by frequency number, array location set for true to
 // ignore, false otherwise. This way you can ignore multiple frequencies.
+// Uses DETECTOR_ENGINE_IIR.
 void detector_init(bool ignoredFrequencies[]);
 
+// Same as detector_init() but selects the engine used to compute power.
+void detector_initWithEngine(bool ignoredFrequencies[],
+                             detector_engine_t engine);
+
 // Runs the entire detector: decimating fir-filter, iir-filters,
 // power-computation, hit-detection. if interruptsCurrentlyEnabled = true,
-// interrupts are running. If interruptsCurrentlyEnabled = false you can pop
-// values from the ADC buffer without disabling interrupts. If
-// interruptsCurrentlyEnabled = true, do the following:
-// 1. disable interrupts.
-// 2. pop the value from the ADC buffer.
-// 3. re-enable interrupts.
+// interrupts are running. The ADC buffer is a lock-free single-producer/
+// single-consumer ring (see isr.h), so values are removed a block at a time
+// with isr_removeDataFromAdcBufferBatch() and interrupts are never disabled,
+// whatever interruptsCurrentlyEnabled is. With DETECTOR_ENGINE_IIR_BLOCK
+// everything pending (up to FILTER_BLOCK_MAX_INPUT_COUNT values at a time) is
+// filtered as one block and hit-detection runs once per block.
 // Ignore hits that are detected on the frequencies specified during
 // detector_init(). Your own frequency (based on the switches) is a good choice
 // to ignore. Assumption: draining the ADC buffer occurs faster than it can
@@ -56,6 +83,22 @@ void detector_ignoreAllHits(bool flagValue);
 // using a for-loop.
 void detector_getHitCounts(detector_hitCount_t hitArray[]);
 
+// Copies the current power values from whichever engine the detector is using,
+// with the same contract as filter_getCurrentPowerValues(). Use this instead
+// of filter_getCurrentPowerValues() for display so both engines work.
+void detector_getCurrentPowerValues(double powerValues[]);
+
+// Runs the hit-detection algorithm on powerValues with the current fudge
+// factor, ignoring nothing. Returns true and sets frequencyNumber if the
+// largest power is a hit. Does not change any detector state so it can be
+// used to evaluate power values from outside the detector.
+bool detector_powerValuesIndicateHit(const double powerValues[],
+                                     uint16_t *frequencyNumber);
+
+// Selects how the detector decides whether the power values are a hit. Kept
+// across detector_init(), DETECTOR_HIT_TEST_MEDIAN until this is called.
+void detector_setHitTest(detector_hitTest_t hitTest);
+
 // Allows the fudge-factor index to be set externally from the detector.
 // The actual values for fudge-factors is stored in an array found in detector.c
 void detector_setFudgeFactorIndex(uint32_t factor);
@@ -71,6 +114,7 @@ double detector_getScaledAdcValue(isr_AdcValue_t adcValue);
 // Create two sets of power values and call your hit detection algorithm
 // on each set. With the same fudge factor, your hit detect algorithm
 // should detect a hit on the first set and not detect a hit on the second.
+// Both hit tests are checked.
 void detector_runTest();
 
 #endif /* DETECTOR_H_ */
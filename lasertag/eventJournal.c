@@ -0,0 +1,424 @@
+/*
+This software is provided for student assignment use in the Department of
+Electrical and Computer Engineering, Brigham Young University, Utah, USA.
+Users agree to not re-host, or redistribute the software, in source or binary
+form, to other persons or other institutions. Users may modify and use the
+source code for personal or educational use.
+For questions, contact Brad Hutchings or Jeff Goeders, https://ece.byu.edu/
+*/
+
+#include <string.h>
+
+#include "eventJournal.h"
+#include "isr.h"
+
+#ifdef ZYBO_BOARD
+#include "xil_printf.h" // outbyte()
+#endif
+
+// Must be a power of two so free-running indices can be masked into the ring.
+#define EVENT_INDEX_MASK (EVENT_JOURNAL_EVENT_COUNT - 1)
+#define FRAME_HEADER_BYTE_COUNT 16 // Sync word included.
+#define POWER_BYTE_COUNT 4
+#define MAX_PAYLOAD_BYTE_COUNT (FILTER_FREQUENCY_COUNT * POWER_BYTE_COUNT)
+#define CHECKSUM_BYTE_COUNT 2
+#define SYNC_BYTE_COUNT 2
+#define BYTE_MASK 0xFF
+#define BITS_PER_BYTE 8
+#define FLETCHER_MODULUS 255
+#define TICKS_PER_SECOND 100000.0
+
+// One ring per producer. recordHit() (the main loop) or recordShot() (the ISR)
+// is the only writer of writeIndex, sequence and droppedCount, and
+// eventJournal_flush() the only writer of readIndex.
+typedef struct {
+  eventJournal_event_t events[EVENT_JOURNAL_EVENT_COUNT];
+  uint32_t writeIndex;
+  uint32_t readIndex;
+  uint32_t sequence; // Of the next event, recorded or not.
+  uint32_t droppedCount;
+} eventJournal_ring_t;
+
+static eventJournal_ring_t hitRing;
+static eventJournal_ring_t shotRing;
+
+// Empties both rings and restarts the sequence numbers.
+void eventJournal_init() {
+  memset(&hitRing, 0, sizeof(hitRing));
+  memset(&shotRing, 0, sizeof(shotRing));
+}
+
+// Returns the free slot in ring for the next event, or NULL (and counts the
+// event as dropped) if the ring is full. Either way uses up a sequence number.
+static eventJournal_event_t *eventJournal_claim(eventJournal_ring_t *ring) {
+  uint32_t read = __atomic_load_n(&ring->readIndex, __ATOMIC_ACQUIRE);
+  if (ring->writeIndex - read >= EVENT_JOURNAL_EVENT_COUNT) {
+    ring->sequence++;
+    ring->droppedCount++;
+    return NULL;
+  }
+  eventJournal_event_t *event =
+      &ring->events[ring->writeIndex & EVENT_INDEX_MASK];
+  event->sequence = ring->sequence++;
+  return event;
+}
+
+// Publishes the event claimed from ring, only after it is complete.
+static void eventJournal_publish(eventJournal_ring_t *ring) {
+  __atomic_store_n(&ring->writeIndex, ring->writeIndex + 1, __ATOMIC_RELEASE);
+}
+
+// Records a hit with the power values that caused it.
+void eventJournal_recordHit(uint16_t frequencyNumber,
+                            const double powerValues[]) {
+  eventJournal_event_t *event = eventJournal_claim(&hitRing);
+  if (event == NULL)
+    return;
+  // The newest ADC value the detector has taken, not the newest one sampled.
+  event->timestamp = isr_getRemovedSampleCount();
+  event->type = EVENT_JOURNAL_TYPE_HIT;
+  event->frequencyNumber = frequencyNumber;
+  event->flags = 0; // The detector only looks for hits outside the lockout.
+  event->powerCount = FILTER_FREQUENCY_COUNT;
+  for (uint16_t i = 0; i < FILTER_FREQUENCY_COUNT; i++)
+    event->powerValues[i] = powerValues[i];
+  eventJournal_publish(&hitRing);
+}
+
+// Records a shot, from the ISR.
+void eventJournal_recordShot(uint16_t frequencyNumber, bool lockoutFlag) {
+  eventJournal_event_t *event = eventJournal_claim(&shotRing);
+  if (event == NULL)
+    return;
+  event->timestamp = isr_getSampleCount();
+  event->type = EVENT_JOURNAL_TYPE_SHOT;
+  event->frequencyNumber = frequencyNumber;
+  event->flags = lockoutFlag ? EVENT_JOURNAL_FLAG_LOCKOUT : 0;
+  event->powerCount = 0;
+  eventJournal_publish(&shotRing);
+}
+
+// Fletcher-16 checksum, continuing from checksum.
+static uint16_t eventJournal_fletcher16(uint16_t checksum,
+                                        const uint8_t bytes[], uint32_t count) {
+  uint16_t sum1 = checksum & BYTE_MASK;
+  uint16_t sum2 = checksum >> BITS_PER_BYTE;
+  for (uint32_t i = 0; i < count; i++) {
+    sum1 = (sum1 + bytes[i]) % FLETCHER_MODULUS;
+    sum2 = (sum2 + sum1) % FLETCHER_MODULUS;
+  }
+  return (sum2 << BITS_PER_BYTE) | sum1;
+}
+
+static void eventJournal_put16(uint8_t bytes[], uint16_t value) {
+  bytes[0] = value & BYTE_MASK;
+  bytes[1] = value >> BITS_PER_BYTE;
+}
+
+static void eventJournal_put32(uint8_t bytes[], uint32_t value) {
+  eventJournal_put16(bytes, value & 0xFFFF);
+  eventJournal_put16(bytes + 2, value >> 16);
+}
+
+static uint16_t eventJournal_get16(const uint8_t bytes[]) {
+  return bytes[0] | (bytes[1] << BITS_PER_BYTE);
+}
+
+static uint32_t eventJournal_get32(const uint8_t bytes[]) {
+  return eventJournal_get16(bytes) |
+         ((uint32_t)eventJournal_get16(bytes + 2) << 16);
+}
+
+// Writes count bytes to file, or to the UART if file is NULL.
+static void eventJournal_write(FILE *file, const uint8_t bytes[],
+                               uint32_t count) {
+#ifdef ZYBO_BOARD
+  if (file == NULL) {
+    // Straight to the UART: the board's stdout adds a '\r' before every '\n'.
+    for (uint32_t i = 0; i < count; i++)
+      outbyte(bytes[i]);
+    return;
+  }
+#endif
+  fwrite(bytes, 1, count, file == NULL ? stdout : file);
+}
+
+// Writes event to file as one frame.
+static void eventJournal_writeFrame(FILE *file,
+                                    const eventJournal_event_t *event) {
+  uint8_t frame[FRAME_HEADER_BYTE_COUNT + MAX_PAYLOAD_BYTE_COUNT +
+                CHECKSUM_BYTE_COUNT];
+  eventJournal_put16(frame, EVENT_JOURNAL_SYNC);
+  frame[2] = event->type;
+  frame[3] = event->frequencyNumber;
+  frame[4] = event->flags;
+  frame[5] = event->powerCount;
+  eventJournal_put32(frame + 6, event->sequence);
+  eventJournal_put32(frame + 10, event->timestamp);
+  eventJournal_put16(frame + 14, 0); // Reserved, keeps the powers aligned.
+  uint8_t *payload = frame + FRAME_HEADER_BYTE_COUNT;
+  for (uint16_t i = 0; i < event->powerCount; i++) {
+    uint32_t bits;
+    memcpy(&bits, &event->powerValues[i], sizeof(bits));
+    eventJournal_put32(payload + i * POWER_BYTE_COUNT, bits);
+  }
+  uint32_t byteCount =
+      FRAME_HEADER_BYTE_COUNT + event->powerCount * POWER_BYTE_COUNT;
+  uint16_t checksum = eventJournal_fletcher16(0, frame + SYNC_BYTE_COUNT,
+                                              byteCount - SYNC_BYTE_COUNT);
+  eventJournal_put16(frame + byteCount, checksum);
+  eventJournal_write(file, frame, byteCount + CHECKSUM_BYTE_COUNT);
+}
+
+// Writes every recorded event to file, merging the two rings by timestamp.
+uint32_t eventJournal_flush(FILE *file) {
+  uint32_t frameCount = 0;
+  // Only this side writes the read indices.
+  uint32_t hitRead = hitRing.readIndex;
+  uint32_t shotRead = shotRing.readIndex;
+  uint32_t hitWrite = __atomic_load_n(&hitRing.writeIndex, __ATOMIC_ACQUIRE);
+  uint32_t shotWrite = __atomic_load_n(&shotRing.writeIndex, __ATOMIC_ACQUIRE);
+  while (hitRead != hitWrite || shotRead != shotWrite) {
+    eventJournal_ring_t *ring;
+    if (hitRead == hitWrite) {
+      ring = &shotRing;
+    } else if (shotRead == shotWrite) {
+      ring = &hitRing;
+    } else {
+      // Timestamps wrap, so compare their difference.
+      uint32_t hitTime = hitRing.events[hitRead & EVENT_INDEX_MASK].timestamp;
+      uint32_t shotTime =
+          shotRing.events[shotRead & EVENT_INDEX_MASK].timestamp;
+      ring = (int32_t)(hitTime - shotTime) <= 0 ? &hitRing : &shotRing;
+    }
+    uint32_t *read = ring == &hitRing ? &hitRead : &shotRead;
+    eventJournal_writeFrame(file, &ring->events[*read & EVENT_INDEX_MASK]);
+    frameCount++;
+    // Hand the slot back only after the event has been written.
+    __atomic_store_n(&ring->readIndex, ++(*read), __ATOMIC_RELEASE);
+  }
+  if (frameCount > 0)
+    fflush(file == NULL ? stdout : file);
+  return frameCount;
+}
+
+// Returns the number of events dropped because their ring was full.
+uint32_t eventJournal_getDroppedEventCount() {
+  return __atomic_load_n(&hitRing.droppedCount, __ATOMIC_RELAXED) +
+         __atomic_load_n(&shotRing.droppedCount, __ATOMIC_RELAXED);
+}
+
+// Reads the next frame with a good checksum into event. Skips bytes until a
+// sync word and skips frames that fail their checks.
+bool eventJournal_readEvent(FILE *stream, eventJournal_event_t *event,
+                            uint32_t *badFrameCount) {
+  uint8_t frame[FRAME_HEADER_BYTE_COUNT + MAX_PAYLOAD_BYTE_COUNT +
+                CHECKSUM_BYTE_COUNT];
+  while (true) {
+    // Hunt for the sync word a byte at a time.
+    int byte = fgetc(stream);
+    if (byte == EOF)
+      return false;
+    if (byte != (EVENT_JOURNAL_SYNC & BYTE_MASK))
+      continue;
+    byte = fgetc(stream);
+    if (byte == EOF)
+      return false;
+    if (byte != EVENT_JOURNAL_SYNC >> BITS_PER_BYTE) {
+      ungetc(byte, stream); // Could be the start of the real sync word.
+      continue;
+    }
+    uint16_t restByteCount = FRAME_HEADER_BYTE_COUNT - SYNC_BYTE_COUNT;
+    if (fread(frame + SYNC_BYTE_COUNT, 1, restByteCount, stream) !=
+        restByteCount)
+      return false;
+    event->type = frame[2];
+    event->frequencyNumber = frame[3];
+    event->flags = frame[4];
+    event->powerCount = frame[5];
+    event->sequence = eventJournal_get32(frame + 6);
+    event->timestamp = eventJournal_get32(frame + 10);
+    if ((event->type != EVENT_JOURNAL_TYPE_HIT &&
+         event->type != EVENT_JOURNAL_TYPE_SHOT) ||
+        event->frequencyNumber >= FILTER_FREQUENCY_COUNT ||
+        event->powerCount > FILTER_FREQUENCY_COUNT) {
+      (*badFrameCount)++;
+      continue;
+    }
+    uint32_t payloadByteCount = event->powerCount * POWER_BYTE_COUNT;
+    uint8_t *payload = frame + FRAME_HEADER_BYTE_COUNT;
+    if (fread(payload, 1, payloadByteCount + CHECKSUM_BYTE_COUNT, stream) !=
+        payloadByteCount + CHECKSUM_BYTE_COUNT)
+      return false;
+    uint16_t checksum = eventJournal_fletcher16(
+        0, frame + SYNC_BYTE_COUNT, restByteCount + payloadByteCount);
+    if (checksum != eventJournal_get16(payload + payloadByteCount)) {
+      (*badFrameCount)++;
+      continue;
+    }
+    for (uint16_t i = 0; i < event->powerCount; i++) {
+      uint32_t bits = eventJournal_get32(payload + i * POWER_BYTE_COUNT);
+      memcpy(&event->powerValues[i], &bits, sizeof(bits));
+    }
+    return true;
+  }
+}
+
+// Host side: writes the events in stream to text, one line each.
+uint32_t eventJournal_decode(FILE *stream, FILE *text) {
+  static const char *typeNames[] = {"", "hit", "shot"};
+  eventJournal_event_t event;
+  uint32_t eventCount = 0;
+  uint32_t badFrameCount = 0;
+  uint32_t missingEventCount = 0;
+  uint32_t restartCount = 0;
+  // Indexed by type, hits and shots are numbered separately.
+  uint32_t expectedSequences[] = {0, 0, 0};
+  fprintf(text, "# seconds event frequency lockout sequence powers\n");
+  while (eventJournal_readEvent(stream, &event, &badFrameCount)) {
+    uint32_t *expectedSequence = &expectedSequences[event.type];
+    int32_t gap = (int32_t)(event.sequence - *expectedSequence);
+    if (gap < 0) {
+      // The journal restarted (the board was reset or two journals were saved
+      // back to back), carry on from the new sequence number.
+      printf("eventJournal_decode: %s event %d follows %d, the journal "
+             "restarted.\n",
+             typeNames[event.type], event.sequence, *expectedSequence - 1);
+      restartCount++;
+    } else if (gap > 0) {
+      printf("eventJournal_decode: %s events %d to %d are missing.\n",
+             typeNames[event.type], *expectedSequence, event.sequence - 1);
+      missingEventCount += gap;
+    }
+    *expectedSequence = event.sequence + 1;
+    fprintf(text, "%.5f %s %d %c %d", event.timestamp / TICKS_PER_SECOND,
+            typeNames[event.type], event.frequencyNumber,
+            event.flags & EVENT_JOURNAL_FLAG_LOCKOUT ? 'L' : '-',
+            event.sequence);
+    for (uint16_t i = 0; i < event.powerCount; i++)
+      fprintf(text, " %.4e", event.powerValues[i]);
+    fprintf(text, "\n");
+    eventCount++;
+  }
+  printf("eventJournal_decode: %d events, %d missing, %d bad, %d restarts.\n",
+         eventCount, missingEventCount, badFrameCount, restartCount);
+  return eventCount;
+}
+
+/*******************************************************
+ ****************** Test Routines **********************
+ ******************************************************/
+
+#define TEST_ROUND_COUNT 10
+#define TEST_SHOT_TICKS 1000 // Time from one round to the next.
+#define TEST_HIT_DELAY_TICKS 300 // Hits are this far behind the shot.
+#define TEST_NOISE "\xA1 noise between flushes\n"
+
+// Moves time along by count ticks. The newest keep of them stay in the ADC
+// buffer, so the detector is that far behind.
+static void eventJournal_testTicks(uint32_t count, uint32_t keep) {
+  static isr_AdcValue_t values[TEST_SHOT_TICKS];
+  for (uint32_t i = 0; i < count; i++)
+    isr_addDataToAdcBuffer(0);
+  uint32_t removeCount = isr_adcBufferElementCount() - keep;
+  while (removeCount > 0)
+    removeCount -= isr_removeDataFromAdcBufferBatch(
+        values, removeCount < TEST_SHOT_TICKS ? removeCount : TEST_SHOT_TICKS);
+}
+
+// Power values for the hit in round, different for every round.
+static void eventJournal_testPowerValues(uint16_t round, double powerValues[]) {
+  for (uint16_t i = 0; i < FILTER_FREQUENCY_COUNT; i++)
+    powerValues[i] = (round + 1) * 1.5 + i * 0.25;
+}
+
+// Reads the events back from stream and checks them against the rounds: a
+// shot, then a hit TEST_HIT_DELAY_TICKS behind it (recorded after it, but
+// written before it). Both are dropped in droppedRound.
+static bool eventJournal_testReadBack(FILE *stream, uint32_t startTime,
+                                      uint16_t droppedRound) {
+  bool success = true;
+  eventJournal_event_t event;
+  uint32_t badFrameCount = 0;
+  uint32_t previousTime = startTime;
+  uint32_t hitCount = 0;
+  uint32_t shotCount = 0;
+  while (eventJournal_readEvent(stream, &event, &badFrameCount)) {
+    uint16_t frequencyNumber = event.sequence % FILTER_FREQUENCY_COUNT;
+    uint32_t roundTime = startTime + (event.sequence + 1) * TEST_SHOT_TICKS;
+    if ((int32_t)(event.timestamp - previousTime) < 0) {
+      printf("eventJournal_runTest: event at %d is out of order.\n",
+             event.timestamp);
+      success = false;
+    }
+    previousTime = event.timestamp;
+    if (event.type == EVENT_JOURNAL_TYPE_SHOT) {
+      success &= event.timestamp == roundTime;
+      success &= event.frequencyNumber == frequencyNumber;
+      success &= event.sequence != droppedRound;
+      success &= event.flags ==
+                 (event.sequence % 2 ? 0 : EVENT_JOURNAL_FLAG_LOCKOUT);
+      success &= event.powerCount == 0;
+      shotCount++;
+      continue;
+    }
+    double powerValues[FILTER_FREQUENCY_COUNT];
+    eventJournal_testPowerValues(event.sequence, powerValues);
+    success &= event.sequence != droppedRound;
+    success &= event.timestamp == roundTime - TEST_HIT_DELAY_TICKS;
+    success &= event.frequencyNumber == frequencyNumber;
+    success &= event.flags == 0;
+    success &= event.powerCount == FILTER_FREQUENCY_COUNT;
+    for (uint16_t i = 0; i < FILTER_FREQUENCY_COUNT; i++)
+      success &= event.powerValues[i] == (float)powerValues[i];
+    hitCount++;
+  }
+  success &= badFrameCount == 0;
+  success &= shotCount == droppedRound + 1;
+  success &= hitCount == droppedRound + 1;
+  if (!success)
+    printf("eventJournal_runTest: read back %d hits and %d shots.\n", hitCount,
+           shotCount);
+  return success;
+}
+
+// Records a shot and a hit per round. Flushes every round at first, then lets
+// both rings fill up so the next round is dropped, then flushes again and runs
+// one more round.
+bool eventJournal_runTest() {
+  printf("Running eventJournal_runTest()\n");
+  FILE *stream = tmpfile();
+  FILE *text = tmpfile();
+  if (stream == NULL || text == NULL) {
+    printf("eventJournal_runTest: could not create a temporary file.\n");
+    return false;
+  }
+  eventJournal_init();
+  eventJournal_testTicks(0, 0); // Start with an empty ADC buffer.
+  uint32_t startTime = isr_getSampleCount();
+  uint16_t droppedRound = TEST_ROUND_COUNT + EVENT_JOURNAL_EVENT_COUNT;
+  uint16_t roundCount = droppedRound + 2;
+  for (uint16_t round = 0; round < roundCount; round++) {
+    uint16_t frequencyNumber = round % FILTER_FREQUENCY_COUNT;
+    double powerValues[FILTER_FREQUENCY_COUNT];
+    eventJournal_testPowerValues(round, powerValues);
+    eventJournal_testTicks(TEST_SHOT_TICKS, TEST_HIT_DELAY_TICKS);
+    eventJournal_recordShot(frequencyNumber, round % 2 == 0);
+    eventJournal_recordHit(frequencyNumber, powerValues);
+    if ((round < TEST_ROUND_COUNT || round == droppedRound) &&
+        eventJournal_flush(stream) > 0)
+      fputs(TEST_NOISE, stream);
+  }
+  eventJournal_testTicks(0, 0);
+  bool success = eventJournal_getDroppedEventCount() == 2;
+  eventJournal_flush(stream);
+  rewind(stream);
+  success &= eventJournal_testReadBack(stream, startTime, droppedRound);
+  rewind(stream);
+  success &= eventJournal_decode(stream, text) == 2 * (roundCount - 1);
+  fclose(stream);
+  fclose(text);
+  eventJournal_init();
+  printf("eventJournal_runTest %s.\n", success ? "passed" : "failed");
+  return success;
+}
@@ -0,0 +1,114 @@
+/*
+This software is provided for student assignment use in the Department of
+Electrical and Computer Engineering, Brigham Young University, Utah, USA.
+Users agree to not re-host, or redistribute the software, in source or binary
+form, to other persons or other institutions. Users may modify and use the
+source code for personal or educational use.
+For questions, contact Brad Hutchings or Jeff Goeders, https://ece.byu.edu/
+*/
+
+#ifndef EVENTJOURNAL_H_
+#define EVENTJOURNAL_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "filter.h"
+
+// A journal of every hit and shot in a game, so hits can be matched up with
+// shooters, times and signal strengths afterwards. It is cheap enough to leave
+// on in real games: recording an event fills in one slot of a ring and
+// publishes it, and the main loop writes whatever has been recorded with
+// eventJournal_flush() when it has time.
+//
+// Hits are recorded by the detector in the main loop and shots by the trigger
+// in the ISR, so each has its own ring of EVENT_JOURNAL_EVENT_COUNT events.
+// Each ring has one producer and one consumer (eventJournal_flush()), the same
+// scheme as the ADC buffer (see isr.h), so nothing has to disable interrupts.
+// If a ring is full the event is dropped, but its sequence number is used up
+// so the decoder can tell.
+//
+// Timestamps are 100 kHz ticks since isr_init() (see isr_getSampleCount()).
+// A shot is stamped when it is recorded. A hit is stamped with the time of the
+// newest ADC value the detector has taken out of the ADC buffer, so it doesn't
+// depend on how far behind the main loop is (see
+// isr_getRemovedSampleCount()). eventJournal_flush() writes the
+// two rings merged in timestamp order.
+//
+// Each event is written as one frame, all fields little-endian:
+//   uint16 sync (EVENT_JOURNAL_SYNC), uint8 type (eventJournal_type_t),
+//   uint8 frequency number, uint8 flags, uint8 power count, uint32 sequence
+//   number (counted separately for hits and shots), uint32 timestamp, uint16
+//   reserved (0), the power values as IEEE 754 float32s, uint16 Fletcher-16
+//   checksum of everything after the sync word.
+// Hits carry all FILTER_FREQUENCY_COUNT power values, 58 bytes in all. Shots
+// carry none, 18 bytes.
+//
+// eventJournal_decode() turns a saved journal into text on the host, see
+// RUNNING_MODE_JOURNAL in main.c.
+
+#define EVENT_JOURNAL_SYNC 0xE7A1
+#define EVENT_JOURNAL_EVENT_COUNT 64 // Per ring, must be a power of two.
+
+// The shooter's lockout timer was running, i.e. they had just been hit.
+#define EVENT_JOURNAL_FLAG_LOCKOUT 0x01
+
+typedef enum {
+  EVENT_JOURNAL_TYPE_HIT = 1, // The detector counted a hit.
+  EVENT_JOURNAL_TYPE_SHOT = 2 // The trigger fired the transmitter.
+} eventJournal_type_t;
+
+typedef struct {
+  uint32_t sequence;
+  uint32_t timestamp; // 100 kHz ticks.
+  uint8_t type;       // eventJournal_type_t.
+  uint8_t frequencyNumber;
+  uint8_t flags;      // EVENT_JOURNAL_FLAG_*.
+  uint8_t powerCount; // Power values that follow, 0 for shots.
+  float powerValues[FILTER_FREQUENCY_COUNT];
+} eventJournal_event_t;
+
+// Empties both rings and restarts the sequence numbers. Don't call while
+// interrupts are enabled.
+void eventJournal_init();
+
+// Records a hit on frequencyNumber with the FILTER_FREQUENCY_COUNT power
+// values that caused it. Only call from the main loop (the detector).
+void eventJournal_recordHit(uint16_t frequencyNumber,
+                            const double powerValues[]);
+
+// Records a shot on frequencyNumber. lockoutFlag is whether the shooter's
+// lockout timer was running. Only call from the ISR (trigger_tick()).
+void eventJournal_recordShot(uint16_t frequencyNumber, bool lockoutFlag);
+
+// Writes every recorded event to file, oldest first, one frame each. Call
+// from the main loop. If file is NULL the frames go to the UART (stdout on the
+// emulator); on the board they bypass stdio, like adcStream_flush(). Returns
+// the number of frames written.
+uint32_t eventJournal_flush(FILE *file);
+
+// Returns the number of events dropped because their ring was full.
+uint32_t eventJournal_getDroppedEventCount();
+
+// Host side: reads the next frame with a good checksum from stream into event,
+// skipping anything between frames. badFrameCount counts the frames that
+// failed their checks and were skipped. Returns false at the end of the
+// stream.
+bool eventJournal_readEvent(FILE *stream, eventJournal_event_t *event,
+                            uint32_t *badFrameCount);
+
+// Host side: writes the events in stream to text, one line each: seconds,
+// "hit" or "shot", frequency number, 'L' if locked out or '-', sequence number
+// and the power values of hits. Reports missing sequence numbers and bad
+// frames. A sequence number that goes backwards is reported as a restart and
+// decoding carries on from it. Returns the number of events decoded.
+uint32_t eventJournal_decode(FILE *stream, FILE *text);
+
+// Records hits and shots out of timestamp order and past a full ring, flushes
+// them into a temporary file with some noise between flushes, and checks what
+// reads back. Uses the ADC buffer to move time along. Returns true if it all
+// matches.
+bool eventJournal_runTest();
+
+#endif /* EVENTJOURNAL_H_ */
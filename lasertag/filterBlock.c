@@ -0,0 +1,84 @@
+/*
+This software is provided for student assignment use in the Department of
+Electrical and Computer Engineering, Brigham Young University, Utah, USA.
+Users agree to not re-host, or redistribute the software, in source or binary
+form, to other persons or other institutions. Users may modify and use the
+source code for personal or educational use.
+For questions, contact Brad Hutchings or Jeff Goeders, https://ece.byu.edu/
+*/
+
+#include <assert.h>
+#include <stdio.h>
+
+#include "decimatingFir.h"
+#include "filter.h"
+#include "filterBlock.h"
+#include "filterPower.h"
+#include "iirBank.h"
+
+// A block of inputs completes at most this many decimated outputs.
+#define MAX_OUTPUT_COUNT                                                       \
+  (FILTER_BLOCK_MAX_INPUT_COUNT / FILTER_FIR_DECIMATION_FACTOR + 1)
+// Same row alignment as iirBank.c.
+#define ROW_ALIGNMENT 32
+
+// Outputs of each stage for the current block.
+static double firOutputs[MAX_OUTPUT_COUNT];
+static double iirOutputs[MAX_OUTPUT_COUNT][IIR_BANK_CHANNEL_COUNT]
+    __attribute__((aligned(ROW_ALIGNMENT)));
+#ifdef IIR_BANK_USE_FLOAT32
+// The same, for the float copy of the IIR bank.
+static float firOutputs32[MAX_OUTPUT_COUNT];
+static float iirOutputs32[MAX_OUTPUT_COUNT][IIR_BANK_CHANNEL_COUNT]
+    __attribute__((aligned(ROW_ALIGNMENT)));
+#endif
+
+// Power of every filter over the last FILTER_INPUT_PULSE_WIDTH IIR outputs.
+static filterPower_t filterPower;
+
+// Must call this prior to using any other filterBlock functions. Sets up the
+// decimating FIR and the IIR bank and zeroes all power values.
+void filterBlock_init() {
+  decimatingFir_init(filter_getFirCoefficientArray(),
+                     filter_getFirCoefficientCount(),
+                     FILTER_FIR_DECIMATION_FACTOR);
+  iirBank_init();
+  filterPower_init(&filterPower);
+}
+
+// Runs count inputs through the FIR, IIR filters and power computation.
+// Returns the number of decimated outputs the block produced.
+uint32_t filterBlock_processBlock(const double inputs[], uint32_t count) {
+  if (count > FILTER_BLOCK_MAX_INPUT_COUNT) {
+    printf("filterBlock_processBlock(): block of %u inputs is larger than "
+           "FILTER_BLOCK_MAX_INPUT_COUNT (%d).\n",
+           count, FILTER_BLOCK_MAX_INPUT_COUNT);
+    assert(false);
+  }
+  uint32_t outputCount = decimatingFir_filterBlock(inputs, count, firOutputs);
+#ifdef IIR_BANK_USE_FLOAT32
+  for (uint32_t n = 0; n < outputCount; n++)
+    firOutputs32[n] = (float)firOutputs[n];
+  iirBank_filterBlockFloat32(firOutputs32, outputCount, iirOutputs32);
+  for (uint32_t n = 0; n < outputCount; n++)
+    for (uint16_t i = 0; i < IIR_BANK_CHANNEL_COUNT; i++)
+      iirOutputs[n][i] = iirOutputs32[n][i];
+#else
+  iirBank_filterBlock(firOutputs, outputCount, iirOutputs);
+#endif
+  for (uint32_t n = 0; n < outputCount; n++)
+    filterPower_addOutputs(&filterPower, iirOutputs[n]);
+  return outputCount;
+}
+
+// Recomputes every power value from the stored IIR outputs.
+void filterBlock_recomputePower() {
+  filterPower_recomputeFromScratch(&filterPower);
+}
+
+// Copies the current power values into powerValues.
+void filterBlock_getCurrentPowerValues(double powerValues[]) {
+  const double *power = filterPower_getPowerValues(&filterPower);
+  for (uint16_t i = 0; i < FILTER_FREQUENCY_COUNT; i++)
+    powerValues[i] = power[i];
+}
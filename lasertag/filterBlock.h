@@ -0,0 +1,47 @@
+/*
+This software is provided for student assignment use in the Department of
+Electrical and Computer Engineering, Brigham Young University, Utah, USA.
+Users agree to not re-host, or redistribute the software, in source or binary
+form, to other persons or other institutions. Users may modify and use the
+source code for personal or educational use.
+For questions, contact Brad Hutchings or Jeff Goeders, https://ece.byu.edu/
+*/
+
+#ifndef FILTERBLOCK_H_
+#define FILTERBLOCK_H_
+
+#include <stdint.h>
+
+// Runs the whole filter chain a block of inputs at a time instead of one input
+// at a time: the decimating FIR (decimatingFir.c) runs over the entire block,
+// then the IIR filters (iirBank.c) run over all of the FIR outputs, then the
+// power of every filter is updated over all of the IIR outputs. Each stage's
+// coefficients and state stay in cache for the whole block and the detector
+// only has to check for a hit once per block.
+//
+// The coefficients come from filter.c but the state is separate, so this can
+// run in place of filter_addNewInput(), filter_firFilter(), filter_iirFilter()
+// and filter_computePower().
+
+// Largest number of inputs that filterBlock_processBlock() accepts at once.
+#define FILTER_BLOCK_MAX_INPUT_COUNT 2048
+
+// Must call this prior to using any other filterBlock functions. Sets up the
+// decimating FIR and the IIR bank and zeroes all power values.
+void filterBlock_init();
+
+// Runs count inputs (scaled ADC values, at most FILTER_BLOCK_MAX_INPUT_COUNT)
+// through the FIR, IIR filters and power computation. Returns the number of
+// decimated outputs the block produced.
+uint32_t filterBlock_processBlock(const double inputs[], uint32_t count);
+
+// Recomputes every power value from the stored IIR outputs. The running sums
+// already correct their own drift (see filterPower.h) so this is rarely
+// needed.
+void filterBlock_recomputePower();
+
+// Copies the current power values into powerValues, with the same contract as
+// filter_getCurrentPowerValues().
+void filterBlock_getCurrentPowerValues(double powerValues[]);
+
+#endif /* FILTERBLOCK_H_ */
@@ -0,0 +1,343 @@
+/*
+This software is provided for student assignment use in the Department of
+Electrical and Computer Engineering, Brigham Young University, Utah, USA.
+Users agree to not re-host, or redistribute the software, in source or binary
+form, to other persons or other institutions. Users may modify and use the
+source code for personal or educational use.
+For questions, contact Brad Hutchings or Jeff Goeders, https://ece.byu.edu/
+*/
+
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+
+#include "filter.h"
+#include "filterFixedPoint.h"
+#include "mirroredBuffer.h"
+
+#define DATA_MAX INT32_MAX
+#define DATA_MIN INT32_MIN
+// Upper limit on the coefficient fraction bits, leaves room for rounding.
+#define MAX_COEFFICIENT_FRACTION_BITS 62
+// The second word of each A-coefficient is scaled by this many more bits than
+// the first one. Kept well below 32 so the second accumulator can't overflow.
+#define IIR_A_EXTRA_FRACTION_BITS 24
+// The IIR feedback state keeps this many more fraction bits than a sample.
+#define IIR_STATE_EXTRA_FRACTION_BITS 32
+// Fraction bits kept in each square for the power. A full-scale square is
+// 2^42 so 2000 of them still fit easily in an int64_t.
+#define POWER_FRACTION_BITS 36
+
+// Quantized coefficients.
+static int32_t firCoefficients[FILTER_FIXED_POINT_MAX_FIR_COEFFICIENT_COUNT];
+static uint16_t firFractionBits;
+static uint32_t firCoefficientCount;
+static int32_t iirBCoefficients[FILTER_FREQUENCY_COUNT]
+                               [FILTER_FIXED_POINT_MAX_IIR_COEFFICIENT_COUNT];
+static uint16_t iirBFractionBits[FILTER_FREQUENCY_COUNT];
+static uint32_t iirBCoefficientCount;
+static int32_t iirACoefficients[FILTER_FREQUENCY_COUNT]
+                               [FILTER_FIXED_POINT_MAX_IIR_COEFFICIENT_COUNT];
+static int32_t iirACoefficientErrors
+    [FILTER_FREQUENCY_COUNT][FILTER_FIXED_POINT_MAX_IIR_COEFFICIENT_COUNT];
+static uint16_t iirAFractionBits[FILTER_FREQUENCY_COUNT];
+static uint32_t iirACoefficientCount;
+
+// Input queues, same roles as xQueue, yQueue and zQueue in filter.c. They are
+// mirrored (see mirroredBuffer.h) so the newest samples are always contiguous.
+// Each index points to the oldest value (the next one to be overwritten).
+static filterFixedPoint_data_t
+    xQueue[MIRRORED_BUFFER_COPY_COUNT *
+           FILTER_FIXED_POINT_MAX_FIR_COEFFICIENT_COUNT];
+static uint32_t xIndex;
+static filterFixedPoint_data_t
+    yQueue[MIRRORED_BUFFER_COPY_COUNT *
+           FILTER_FIXED_POINT_MAX_IIR_COEFFICIENT_COUNT];
+static uint32_t yIndex;
+// The IIR outputs are fed back with 32 extra fraction bits (Q3.60). The
+// recursion amplifies any rounding of the feedback enormously for these narrow
+// filters, so rounding them to Q3.28 swamps the out-of-band power.
+static int64_t
+    zQueue[FILTER_FREQUENCY_COUNT]
+          [MIRRORED_BUFFER_COPY_COUNT *
+           FILTER_FIXED_POINT_MAX_IIR_COEFFICIENT_COUNT];
+static uint32_t zIndex[FILTER_FREQUENCY_COUNT];
+
+// IIR output queues, only used for power so they don't need to be mirrored.
+static filterFixedPoint_data_t outputQueue[FILTER_FREQUENCY_COUNT]
+                                          [FILTER_INPUT_PULSE_WIDTH];
+static uint32_t outputIndex[FILTER_FREQUENCY_COUNT];
+
+// Sum of the squares of each output queue, in POWER_FRACTION_BITS (see
+// square()). Updated by every filterFixedPoint_iirFilter().
+static int64_t power[FILTER_FREQUENCY_COUNT];
+
+// Returns the number of fraction bits that lets coefficients be quantized to
+// int32_t with a dot-product against any int32_t data fitting in an int64_t.
+// This holds as long as the sum of the quantized magnitudes stays below 2^31.
+static uint16_t coefficientFractionBits(const double coefficients[],
+                                        uint32_t count) {
+  double magnitudeSum = 0.0;
+  for (uint32_t i = 0; i < count; i++)
+    magnitudeSum += fabs(coefficients[i]);
+  if (magnitudeSum >= DATA_MAX) {
+    printf("filterFixedPoint: coefficients are too large to quantize.\n");
+    assert(false);
+  }
+  uint16_t fractionBits = 0;
+  // Stop one short of 2^31 so rounding can't push things over.
+  while (fractionBits < MAX_COEFFICIENT_FRACTION_BITS &&
+         ldexp(magnitudeSum, fractionBits + 1) + count < DATA_MAX)
+    fractionBits++;
+  return fractionBits;
+}
+
+// Quantizes coefficients to int32_t with fractionBits. If errors is not NULL
+// the quantization error of each coefficient is quantized with
+// IIR_A_EXTRA_FRACTION_BITS more fraction bits and stored there.
+static void quantize(const double coefficients[], uint32_t count,
+                     uint16_t fractionBits, int32_t quantized[],
+                     int32_t errors[]) {
+  for (uint32_t i = 0; i < count; i++) {
+    double scaled = ldexp(coefficients[i], fractionBits);
+    quantized[i] = (int32_t)llround(scaled);
+    if (errors != NULL)
+      errors[i] = (int32_t)llround(
+          ldexp(scaled - quantized[i], IIR_A_EXTRA_FRACTION_BITS));
+  }
+}
+
+// Shifts with rounding and saturates the result to a sample.
+static filterFixedPoint_data_t roundAndShift(int64_t value,
+                                             uint16_t fractionBits) {
+  if (fractionBits > 0)
+    value = (value + ((int64_t)1 << (fractionBits - 1))) >> fractionBits;
+  if (value > DATA_MAX)
+    return DATA_MAX;
+  if (value < DATA_MIN)
+    return DATA_MIN;
+  return (filterFixedPoint_data_t)value;
+}
+
+// Dot-product of coefficients and the newest count values of a mirrored
+// queue. coefficients[0] goes with the newest value.
+static int64_t dotProduct(const int32_t coefficients[],
+                          const filterFixedPoint_data_t *newest,
+                          uint32_t count) {
+  int64_t sum = 0;
+  for (uint32_t k = 0; k < count; k++)
+    sum += (int64_t)coefficients[k] * newest[-(int32_t)k];
+  return sum;
+}
+
+// Dot-product of the A-coefficients and the newest count values of a Q3.60
+// zQueue, in the same scale as dotProduct() would give for Q3.28 data. The
+// upper word of each value is an ordinary Q3.28 sample and the lower word adds
+// the extra fraction bits. The coefficient errors only need the upper word.
+static int64_t feedbackDotProduct(const int32_t coefficients[],
+                                  const int32_t coefficientErrors[],
+                                  const int64_t *newest, uint32_t count) {
+  int64_t sum = 0;
+  for (uint32_t k = 0; k < count; k++) {
+    int64_t z = newest[-(int32_t)k];
+    int32_t upper = (int32_t)(z >> IIR_STATE_EXTRA_FRACTION_BITS);
+    uint32_t lower = (uint32_t)z;
+    sum += (int64_t)coefficients[k] * upper;
+    sum += ((int64_t)coefficients[k] * lower) >> IIR_STATE_EXTRA_FRACTION_BITS;
+    sum += ((int64_t)coefficientErrors[k] * upper) >> IIR_A_EXTRA_FRACTION_BITS;
+  }
+  return sum;
+}
+
+// Converts a value with 28 + fractionBits fraction bits to Q3.60, saturating
+// at the limits of a Q3.28 sample.
+static int64_t toFeedbackState(int64_t value, uint16_t fractionBits) {
+  const int64_t one = (int64_t)1 << IIR_STATE_EXTRA_FRACTION_BITS;
+  const int64_t max = (int64_t)DATA_MAX * one;
+  const int64_t min = (int64_t)DATA_MIN * one;
+  if (fractionBits >= IIR_STATE_EXTRA_FRACTION_BITS)
+    return value >> (fractionBits - IIR_STATE_EXTRA_FRACTION_BITS);
+  uint16_t shift = IIR_STATE_EXTRA_FRACTION_BITS - fractionBits;
+  if (value > (max >> shift))
+    return max;
+  if (value < (min >> shift))
+    return min;
+  return value * ((int64_t)1 << shift);
+}
+
+// Square of a Q3.28 sample, with POWER_FRACTION_BITS.
+static int64_t square(filterFixedPoint_data_t x) {
+  return ((int64_t)x * x) >>
+         (2 * FILTER_FIXED_POINT_DATA_FRACTION_BITS - POWER_FRACTION_BITS);
+}
+
+// Must call this prior to using any filterFixedPoint functions. Quantizes the
+// coefficients and zeroes all of the queues and power values.
+void filterFixedPoint_init() {
+  firCoefficientCount = filter_getFirCoefficientCount();
+  iirACoefficientCount = filter_getIirACoefficientCount();
+  iirBCoefficientCount = filter_getIirBCoefficientCount();
+  if (firCoefficientCount > FILTER_FIXED_POINT_MAX_FIR_COEFFICIENT_COUNT ||
+      iirACoefficientCount > FILTER_FIXED_POINT_MAX_IIR_COEFFICIENT_COUNT ||
+      iirBCoefficientCount > FILTER_FIXED_POINT_MAX_IIR_COEFFICIENT_COUNT) {
+    printf("filterFixedPoint_init(): filter.c has more coefficients than "
+           "filterFixedPoint can hold.\n");
+    assert(false);
+  }
+  firFractionBits = coefficientFractionBits(filter_getFirCoefficientArray(),
+                                            firCoefficientCount);
+  quantize(filter_getFirCoefficientArray(), firCoefficientCount,
+           firFractionBits, firCoefficients, NULL);
+  for (uint16_t i = 0; i < FILTER_FREQUENCY_COUNT; i++) {
+    iirBFractionBits[i] = coefficientFractionBits(
+        filter_getIirBCoefficientArray(i), iirBCoefficientCount);
+    quantize(filter_getIirBCoefficientArray(i), iirBCoefficientCount,
+             iirBFractionBits[i], iirBCoefficients[i], NULL);
+    iirAFractionBits[i] = coefficientFractionBits(
+        filter_getIirACoefficientArray(i), iirACoefficientCount);
+    quantize(filter_getIirACoefficientArray(i), iirACoefficientCount,
+             iirAFractionBits[i], iirACoefficients[i],
+             iirACoefficientErrors[i]);
+  }
+  // Zero out all of the queues.
+  for (uint32_t i = 0; i < MIRRORED_BUFFER_COPY_COUNT * firCoefficientCount;
+       i++)
+    xQueue[i] = 0;
+  xIndex = 0;
+  for (uint32_t i = 0; i < MIRRORED_BUFFER_COPY_COUNT * iirBCoefficientCount;
+       i++)
+    yQueue[i] = 0;
+  yIndex = 0;
+  for (uint16_t i = 0; i < FILTER_FREQUENCY_COUNT; i++) {
+    for (uint32_t j = 0;
+         j < MIRRORED_BUFFER_COPY_COUNT * iirACoefficientCount; j++)
+      zQueue[i][j] = 0;
+    zIndex[i] = 0;
+    for (uint32_t j = 0; j < FILTER_INPUT_PULSE_WIDTH; j++)
+      outputQueue[i][j] = 0;
+    outputIndex[i] = 0;
+    power[i] = 0;
+  }
+}
+
+// Converts a double to a Q3.28 sample (saturates).
+filterFixedPoint_data_t filterFixedPoint_fromDouble(double x) {
+  double scaled = round(ldexp(x, FILTER_FIXED_POINT_DATA_FRACTION_BITS));
+  if (scaled > DATA_MAX)
+    return DATA_MAX;
+  if (scaled < DATA_MIN)
+    return DATA_MIN;
+  return (filterFixedPoint_data_t)scaled;
+}
+
+// Converts a Q3.28 sample to a double.
+double filterFixedPoint_toDouble(filterFixedPoint_data_t x) {
+  return ldexp(x, -FILTER_FIXED_POINT_DATA_FRACTION_BITS);
+}
+
+#define ADC_BIT_COUNT 12
+#define ADC_MID_SCALE (1 << (ADC_BIT_COUNT - 1))
+// Converts a raw 12-bit XADC value to a Q3.28 sample between -1.0 and 1.0,
+// the same scaling as detector_getScaledAdcValue() but with a shift.
+filterFixedPoint_data_t filterFixedPoint_fromAdc(uint32_t adcValue) {
+  return ((filterFixedPoint_data_t)adcValue - ADC_MID_SCALE)
+         << (FILTER_FIXED_POINT_DATA_FRACTION_BITS - (ADC_BIT_COUNT - 1));
+}
+
+// Adds a new input to the FIR-filter input queue.
+void filterFixedPoint_addNewInput(filterFixedPoint_data_t x) {
+  mirroredBuffer_push(xQueue, &xIndex, firCoefficientCount, &x, sizeof(x));
+}
+
+// Invokes the FIR-filter. Output is returned and is also pushed on to the
+// IIR input queue.
+filterFixedPoint_data_t filterFixedPoint_firFilter() {
+  const filterFixedPoint_data_t *newest = mirroredBuffer_getNewest(
+      xQueue, xIndex, firCoefficientCount, sizeof(xQueue[0]));
+  filterFixedPoint_data_t y = roundAndShift(
+      dotProduct(firCoefficients, newest, firCoefficientCount),
+      firFractionBits);
+  mirroredBuffer_push(yQueue, &yIndex, iirBCoefficientCount, &y, sizeof(y));
+  return y;
+}
+
+// Invokes a single IIR filter. Output is returned and is also pushed onto the
+// output queue for filterNumber.
+filterFixedPoint_data_t filterFixedPoint_iirFilter(uint16_t filterNumber) {
+  const filterFixedPoint_data_t *newestY = mirroredBuffer_getNewest(
+      yQueue, yIndex, iirBCoefficientCount, sizeof(yQueue[0]));
+  const int64_t *newestZ =
+      mirroredBuffer_getNewest(zQueue[filterNumber], zIndex[filterNumber],
+                               iirACoefficientCount, sizeof(zQueue[0][0]));
+  int64_t bSum = dotProduct(iirBCoefficients[filterNumber], newestY,
+                            iirBCoefficientCount);
+  int64_t aSum = feedbackDotProduct(iirACoefficients[filterNumber],
+                                    iirACoefficientErrors[filterNumber],
+                                    newestZ, iirACoefficientCount);
+  // The B-coefficients are tiny compared to the A-coefficients, so rounding
+  // the B-sum to a sample on its own would throw away most of it. Line the
+  // two sums up at the smaller of the two scales before subtracting.
+  uint16_t aBits = iirAFractionBits[filterNumber];
+  uint16_t bBits = iirBFractionBits[filterNumber];
+  uint16_t commonBits = aBits < bBits ? aBits : bBits;
+  bSum >>= bBits - commonBits;
+  aSum >>= aBits - commonBits;
+  int64_t z = toFeedbackState(bSum - aSum, commonBits);
+  // Push the full-precision value onto the zQueue.
+  mirroredBuffer_push(zQueue[filterNumber], &zIndex[filterNumber],
+                      iirACoefficientCount, &z, sizeof(z));
+  filterFixedPoint_data_t output =
+      roundAndShift(z, IIR_STATE_EXTRA_FRACTION_BITS);
+  // Keep the power up to date. Integer math is exact, so removing the oldest
+  // square and adding the newest one never drifts.
+  uint32_t index = outputIndex[filterNumber];
+  power[filterNumber] +=
+      square(output) - square(outputQueue[filterNumber][index]);
+  outputQueue[filterNumber][index] = output;
+  if (++index == FILTER_INPUT_PULSE_WIDTH)
+    index = 0;
+  outputIndex[filterNumber] = index;
+  return output;
+}
+
+// Computes the power for the output queue of filterNumber, the same as
+// filter_computePower(). The power is kept up to date by
+// filterFixedPoint_iirFilter() so this only does work when forced.
+double filterFixedPoint_computePower(uint16_t filterNumber,
+                                     bool forceComputeFromScratch,
+                                     bool debugPrint) {
+  if (forceComputeFromScratch) {
+    int64_t sum = 0;
+    for (uint32_t i = 0; i < FILTER_INPUT_PULSE_WIDTH; i++)
+      sum += square(outputQueue[filterNumber][i]);
+    power[filterNumber] = sum;
+  }
+  double powerValue =
+      ldexp((double)power[filterNumber], -POWER_FRACTION_BITS);
+  if (debugPrint)
+    printf("filterFixedPoint power[%d]: %le\n", filterNumber, powerValue);
+  return powerValue;
+}
+
+// Copies the last computed power values into powerValues.
+void filterFixedPoint_getCurrentPowerValues(double powerValues[]) {
+  for (uint16_t i = 0; i < FILTER_FREQUENCY_COUNT; i++)
+    powerValues[i] =
+        ldexp((double)power[i], -POWER_FRACTION_BITS);
+}
+
+// Returns the number of fraction bits used for the FIR coefficients.
+uint16_t filterFixedPoint_getFirCoefficientFractionBits() {
+  return firFractionBits;
+}
+
+// Returns the number of fraction bits used for the A and B coefficients of
+// filterNumber.
+uint16_t
+filterFixedPoint_getIirACoefficientFractionBits(uint16_t filterNumber) {
+  return iirAFractionBits[filterNumber];
+}
+uint16_t
+filterFixedPoint_getIirBCoefficientFractionBits(uint16_t filterNumber) {
+  return iirBFractionBits[filterNumber];
+}
@@ -0,0 +1,96 @@
+/*
+This software is provided for student assignment use in the Department of
+Electrical and Computer Engineering, Brigham Young University, Utah, USA.
+Users agree to not re-host, or redistribute the software, in source or binary
+form, to other persons or other institutions. Users may modify and use the
+source code for personal or educational use.
+For questions, contact Brad Hutchings or Jeff Goeders, https://ece.byu.edu/
+*/
+
+#ifndef FILTERFIXEDPOINT_H_
+#define FILTERFIXEDPOINT_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Fixed-point version of the filter chain (decimating FIR, 10 IIR filters and
+// power computation). Everything is computed with integer multiply-adds so
+// the VFP is not needed in the detector loop, and samples take 4 bytes instead
+// of 8.
+//
+// Samples are signed Q3.28 (28 fraction bits), so the -1.0 to 1.0 range of
+// detector_getScaledAdcValue() has plenty of headroom. Each coefficient array
+// is quantized to 32 bits with its own scale (block floating-point): the
+// number of fraction bits is chosen from the sum of the absolute values of
+// the coefficients so that a dot-product with any Q3.28 data can not overflow
+// the 64-bit accumulator.
+//
+// The narrow IIR bandpass filters need two exceptions to get close to the
+// double version: the A-coefficients keep a second 32-bit word holding the
+// quantization error of the first one (the poles are too sensitive to 32-bit
+// coefficients), and the fed-back IIR outputs are kept with 64 bits (rounding
+// them to 32 bits is amplified by the recursion and swamps the out-of-band
+// power). The IIR output queues used for power are plain 32-bit samples.
+//
+// Coefficients are generated from filter_getFirCoefficientArray(),
+// filter_getIirACoefficientArray() and filter_getIirBCoefficientArray() by
+// filterFixedPoint_init(), so they always match the double version.
+
+// Uncomment this to have the detector run the fixed-point version of the
+// filter chain instead of filter.c.
+//#define FILTER_USE_FIXED_POINT
+
+// Number of fraction bits in a sample.
+#define FILTER_FIXED_POINT_DATA_FRACTION_BITS 28
+
+// Largest filters the fixed-point version will hold.
+#define FILTER_FIXED_POINT_MAX_FIR_COEFFICIENT_COUNT 128
+#define FILTER_FIXED_POINT_MAX_IIR_COEFFICIENT_COUNT 16
+
+typedef int32_t filterFixedPoint_data_t;
+
+// Must call this prior to using any filterFixedPoint functions. Quantizes the
+// coefficients and zeroes all of the queues and power values.
+void filterFixedPoint_init();
+
+// Converts a double to a Q3.28 sample (saturates).
+filterFixedPoint_data_t filterFixedPoint_fromDouble(double x);
+
+// Converts a Q3.28 sample to a double.
+double filterFixedPoint_toDouble(filterFixedPoint_data_t x);
+
+// Converts a raw 12-bit XADC value to a Q3.28 sample between -1.0 and 1.0,
+// the same scaling as detector_getScaledAdcValue() but with a shift.
+filterFixedPoint_data_t filterFixedPoint_fromAdc(uint32_t adcValue);
+
+// Adds a new input to the FIR-filter input queue.
+void filterFixedPoint_addNewInput(filterFixedPoint_data_t x);
+
+// Invokes the FIR-filter. Output is returned and is also pushed on to the
+// IIR input queue.
+filterFixedPoint_data_t filterFixedPoint_firFilter();
+
+// Invokes a single IIR filter. Output is returned and is also pushed onto the
+// output queue for filterNumber.
+filterFixedPoint_data_t filterFixedPoint_iirFilter(uint16_t filterNumber);
+
+// Computes the power for the output queue of filterNumber, the same as
+// filter_computePower(). Incremental updates are exact in fixed-point so they
+// never drift from a forced computation. Returned as a double so it can be
+// used in place of filter_computePower().
+double filterFixedPoint_computePower(uint16_t filterNumber,
+                                     bool forceComputeFromScratch,
+                                     bool debugPrint);
+
+// Copies the last computed power values into powerValues.
+void filterFixedPoint_getCurrentPowerValues(double powerValues[]);
+
+// Returns the number of fraction bits used for the FIR coefficients.
+uint16_t filterFixedPoint_getFirCoefficientFractionBits();
+
+// Returns the number of fraction bits used for the A and B coefficients of
+// filterNumber.
+uint16_t filterFixedPoint_getIirACoefficientFractionBits(uint16_t filterNumber);
+uint16_t filterFixedPoint_getIirBCoefficientFractionBits(uint16_t filterNumber);
+
+#endif /* FILTERFIXEDPOINT_H_ */
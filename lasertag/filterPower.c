@@ -0,0 +1,88 @@
+/*
+This software is provided for student assignment use in the Department of
+Electrical and Computer Engineering, Brigham Young University, Utah, USA.
+Users agree to not re-host, or redistribute the software, in source or binary
+form, to other persons or other institutions. Users may modify and use the
+source code for personal or educational use.
+For questions, contact Brad Hutchings or Jeff Goeders, https://ece.byu.edu/
+*/
+
+#include "filterPower.h"
+
+// Zeroes the window and all of the power values.
+void filterPower_init(filterPower_t *p) {
+  for (uint32_t n = 0; n < FILTER_POWER_WINDOW_LENGTH; n++) {
+    for (uint16_t i = 0; i < FILTER_POWER_CHANNEL_COUNT; i++)
+      p->window[n][i] = 0.0;
+  }
+  p->windowIndex = 0;
+  for (uint16_t i = 0; i < FILTER_POWER_CHANNEL_COUNT; i++) {
+    p->power[i] = 0.0;
+    p->shadowPower[i] = 0.0;
+    p->shadowCompensation[i] = 0.0;
+  }
+  p->shadowCount = 0;
+}
+
+// Adds the newest output of every filter and drops the oldest.
+void filterPower_addOutputs(filterPower_t *p, const double outputs[]) {
+  double *oldest = p->window[p->windowIndex];
+  for (uint16_t i = 0; i < FILTER_FREQUENCY_COUNT; i++) {
+    double newestSquare = outputs[i] * outputs[i];
+    p->power[i] += newestSquare - oldest[i] * oldest[i];
+    oldest[i] = outputs[i]; // The newest output replaces the oldest.
+    // Kahan-summation of the newest squares.
+    double y = newestSquare - p->shadowCompensation[i];
+    double t = p->shadowPower[i] + y;
+    p->shadowCompensation[i] = (t - p->shadowPower[i]) - y;
+    p->shadowPower[i] = t;
+  }
+  if (++p->windowIndex == FILTER_POWER_WINDOW_LENGTH)
+    p->windowIndex = 0;
+  if (++p->shadowCount < FILTER_POWER_WINDOW_LENGTH)
+    return;
+  // The shadow sums now cover exactly the outputs in the window, so they
+  // replace the running sums and any drift they have picked up.
+  for (uint16_t i = 0; i < FILTER_FREQUENCY_COUNT; i++) {
+    p->power[i] = p->shadowPower[i];
+    p->shadowPower[i] = 0.0;
+    p->shadowCompensation[i] = 0.0;
+  }
+  p->shadowCount = 0;
+}
+
+// Recomputes every power value from the window with a compensated sum.
+void filterPower_recomputeFromScratch(filterPower_t *p) {
+  for (uint16_t i = 0; i < FILTER_FREQUENCY_COUNT; i++) {
+    double sum = 0.0;
+    double compensation = 0.0;
+    for (uint32_t n = 0; n < FILTER_POWER_WINDOW_LENGTH; n++) {
+      double y = p->window[n][i] * p->window[n][i] - compensation;
+      double t = sum + y;
+      compensation = (t - sum) - y;
+      sum = t;
+    }
+    p->power[i] = sum;
+  }
+}
+
+// Returns the current power values (not a copy).
+const double *filterPower_getPowerValues(const filterPower_t *p) {
+  return p->power;
+}
+
+// Copies the power values into normalizedArray divided by the largest value,
+// and returns the index of the largest value in indexOfMaxValue.
+void filterPower_getNormalizedPowerValues(const filterPower_t *p,
+                                          double normalizedArray[],
+                                          uint16_t *indexOfMaxValue) {
+  uint16_t maxIndex = 0;
+  for (uint16_t i = 1; i < FILTER_FREQUENCY_COUNT; i++) {
+    if (p->power[i] > p->power[maxIndex])
+      maxIndex = i;
+  }
+  double maxValue = p->power[maxIndex];
+  for (uint16_t i = 0; i < FILTER_FREQUENCY_COUNT; i++)
+    normalizedArray[i] = maxValue > 0.0 ? p->power[i] / maxValue : 0.0;
+  *indexOfMaxValue = maxIndex;
+}
@@ -0,0 +1,76 @@
+/*
+This software is provided for student assignment use in the Department of
+Electrical and Computer Engineering, Brigham Young University, Utah, USA.
+Users agree to not re-host, or redistribute the software, in source or binary
+form, to other persons or other institutions. Users may modify and use the
+source code for personal or educational use.
+For questions, contact Brad Hutchings or Jeff Goeders, https://ece.byu.edu/
+*/
+
+#ifndef FILTERPOWER_H_
+#define FILTERPOWER_H_
+
+#include <stdint.h>
+
+#include "filter.h"
+
+// Incremental power (sum of squares over the last FILTER_INPUT_PULSE_WIDTH
+// IIR outputs) for all FILTER_FREQUENCY_COUNT filters at once. This is the
+// running-sum scheme described for filter_computePower(), done for every
+// channel in one call:
+//   power = power - oldest * oldest + newest * newest
+//
+// A running sum drifts: after a loud pulse leaves the window, the rounding
+// from adding and then subtracting its large squares is left behind in the
+// much smaller sum. To bound that, a second sum of the newest squares is
+// built up from zero alongside the running sum (with Kahan compensation).
+// After FILTER_INPUT_PULSE_WIDTH outputs it covers exactly the current window,
+// so it replaces the running sum and starts over. The drift never spans more
+// than one window and there is never a full pass over the window in the
+// detector loop.
+//
+// Outputs and sums are stored by channel (one row of all channels per output)
+// so each update is a short loop across the channels. filter.c can keep one
+// filterPower_t, call filterPower_addOutputs() once all of the IIR filters have
+// run and use filterPower_getPowerValues() for
+// filter_getCurrentPowerValues().
+
+// Channels in each row, padded to a multiple of 4 like IIR_BANK_CHANNEL_COUNT.
+#define FILTER_POWER_CHANNEL_COUNT ((FILTER_FREQUENCY_COUNT + 3) & ~3)
+#define FILTER_POWER_WINDOW_LENGTH FILTER_INPUT_PULSE_WIDTH
+
+typedef struct {
+  // The last FILTER_POWER_WINDOW_LENGTH outputs, windowIndex is the oldest.
+  double window[FILTER_POWER_WINDOW_LENGTH][FILTER_POWER_CHANNEL_COUNT];
+  uint32_t windowIndex;
+  double power[FILTER_POWER_CHANNEL_COUNT]; // Running sums.
+  // Sums of the squares added since shadowCount was last 0.
+  double shadowPower[FILTER_POWER_CHANNEL_COUNT];
+  double shadowCompensation[FILTER_POWER_CHANNEL_COUNT]; // Kahan terms.
+  uint32_t shadowCount;
+} filterPower_t;
+
+// Zeroes the window and all of the power values.
+void filterPower_init(filterPower_t *p);
+
+// Adds the newest output of every filter (outputs[0] to
+// outputs[FILTER_FREQUENCY_COUNT - 1]) and drops the oldest.
+void filterPower_addOutputs(filterPower_t *p, const double outputs[]);
+
+// Recomputes every power value from the window with a compensated sum. This is
+// a full pass over the window; filterPower_addOutputs() already bounds the
+// drift so the detector loop never needs it.
+void filterPower_recomputeFromScratch(filterPower_t *p);
+
+// Returns the current power values, FILTER_FREQUENCY_COUNT of them. This is
+// the array itself, not a copy, so it changes with the next
+// filterPower_addOutputs().
+const double *filterPower_getPowerValues(const filterPower_t *p);
+
+// Copies the power values into normalizedArray divided by the largest value,
+// and returns the index of the largest value in indexOfMaxValue.
+void filterPower_getNormalizedPowerValues(const filterPower_t *p,
+                                          double normalizedArray[],
+                                          uint16_t *indexOfMaxValue);
+
+#endif /* FILTERPOWER_H_ */
@@ -20,12 +20,19 @@ For questions, contact Brad Hutchings or Jeff Goeders, https://ece.byu.edu/
 #include <stdio.h>
 
 #ifdef ADC_THROUGH_DETECTOR_FILTER_TEST
-#include "detector.h"
 #include "isr.h"
 #endif
 
+#include "decimatingFir.h"
+#include "detector.h"
 #include "filter.h"
+#include "filterBlock.h"
+#include "filterPower.h"
+#include "filterFixedPoint.h"
 #include "histogram.h"
+#include "iirBank.h"
+#include "intervalTimer.h"
+#include "slidingDft.h"
 #include "utils.h"
 
 /****************************************************************************************************
@@ -430,7 +437,7 @@ void filterTest_runSquareWaveFirPowerTest(bool printMessageFlag,
                                  currentPeriodTickCount * PERIODS_TO_PLOT);
       utils_msDelay(INPUT_PLOT_VIEW_DELAY);
     }
-#ifdef DETECTOR_H_
+#ifdef ADC_THROUGH_DETECTOR_FILTER_TEST
     bool interruptsEnabled = false; // Need to tell the detector that interrupts
                                     // are not currently enabled.
     detector(interruptsEnabled, false); // Run the detector so that it runs the
@@ -602,6 +609,95 @@ void filterTest_runSquareWaveIirPowerTest(uint16_t filterNumber,
       testPeriodPowerValue, filterNumber); // Finally, plot the results.
 }
 
+#define FIXED_POINT_TEST_ERROR_LIMIT 1.0E-4
+// Runs the same square-wave input as filterTest_runSquareWaveIirPowerTest()
+// through both filter.c and filterFixedPoint, for every IIR filter and all 10
+// player frequencies, and compares the power values. Errors are reported
+// relative to the largest power seen by the filter (its own frequency) since
+// that is what the detector compares against. Returns false if any error is
+// larger than FIXED_POINT_TEST_ERROR_LIMIT.
+static bool filterTest_runFixedPointAccuracyTest(bool printMessageFlag) {
+  if (!filterTest_initFlag) {
+    printf("Must call filterTest_init() before running any filter tests.\n");
+    return false;
+  }
+  bool success = true; // Be optimistic.
+  double worstError = 0.0;
+  if (printMessageFlag)
+    printf("filterTest_runFixedPointAccuracyTest: relative power error "
+           "(filter by frequency).\n");
+  for (uint16_t filterNumber = 0; filterNumber < FILTER_FREQUENCY_COUNT;
+       filterNumber++) {
+    double doublePower[FILTER_FREQUENCY_COUNT];
+    double fixedPointPower[FILTER_FREQUENCY_COUNT];
+    double maxPower = 0.0;
+    for (uint16_t testPeriodIndex = 0; testPeriodIndex < FILTER_FREQUENCY_COUNT;
+         testPeriodIndex++) {
+      double power = 0.0;
+      filterTest_fillQueue(filter_getXQueue(), 0.0); // zero out the x-queue.
+      filterTest_fillQueue(filter_getYQueue(), 0.0); // zero out the y-queue.
+      filterTest_fillQueue(filter_getZQueue(filterNumber), 0.0);
+      filterFixedPoint_init(); // zero out all of the fixed-point queues.
+      uint16_t currentPeriodTickCount =
+          filterTest_firTestTickCounts[testPeriodIndex];
+      uint32_t totalTickCount = 0;
+      // Stop at exactly one pulse-width so both versions compute power over
+      // the same FILTER_INPUT_PULSE_WIDTH outputs.
+      while (totalTickCount < FILTER_TEST_PULSE_WIDTH_LENGTH) {
+        for (uint16_t freqTick = 0;
+             freqTick < currentPeriodTickCount &&
+             totalTickCount < FILTER_TEST_PULSE_WIDTH_LENGTH;
+             freqTick++) {
+          double filterValue =
+              computeFilterInput(freqTick, currentPeriodTickCount);
+          filter_addNewInput(filterValue);
+          filterFixedPoint_addNewInput(
+              filterFixedPoint_fromDouble(filterValue));
+          if (filterTest_decimatingFirFilter()) {
+            filter_iirFilter(filterNumber);
+            double iirOutput = filterTest_readMostRecentValueFromQueue(
+                filter_getZQueue(filterNumber));
+            power += iirOutput * iirOutput;
+            filterFixedPoint_firFilter();
+            filterFixedPoint_iirFilter(filterNumber);
+          }
+          totalTickCount++;
+        }
+      }
+      doublePower[testPeriodIndex] = power;
+      fixedPointPower[testPeriodIndex] =
+          filterFixedPoint_computePower(filterNumber, true, false);
+      if (power > maxPower)
+        maxPower = power;
+    }
+    if (printMessageFlag)
+      printf("IIR[%d]:", filterNumber);
+    for (uint16_t i = 0; i < FILTER_FREQUENCY_COUNT; i++) {
+      double error = fabs(fixedPointPower[i] - doublePower[i]) / maxPower;
+      if (error > worstError)
+        worstError = error;
+      if (error > FIXED_POINT_TEST_ERROR_LIMIT)
+        success = false;
+      if (printMessageFlag)
+        printf(" %7.1le", error);
+    }
+    if (printMessageFlag)
+      printf("\n");
+  }
+  if (printMessageFlag) {
+    printf("filterTest_runFixedPointAccuracyTest: FIR uses %d coefficient "
+           "fraction bits, worst error: %le\n",
+           filterFixedPoint_getFirCoefficientFractionBits(), worstError);
+    printf("filterTest_runFixedPointAccuracyTest ");
+    if (success)
+      printf("passed.\n");
+    else
+      printf("failed.\n");
+  }
+  filterFixedPoint_init(); // Leave things in a known state.
+  return success;
+}
+
 // Pushes a single 1.0 through the xQueue. Golden output data are just the FIR
 // coefficients in reverse order. If this test passes, you are multiplying the
 // coefficient with the correct element of xQueue. This is equivalent to passing
@@ -947,6 +1043,461 @@ bool filterTest_runPowerTest() {
   return firstComputeStatus & incrementalComputeStatus;
 }
 
+#define FILTER_POWER_TEST_LOUD_COUNT 3000  // Loud outputs first,
+#define FILTER_POWER_TEST_QUIET_COUNT 5000 // then these quiet ones,
+#define FILTER_POWER_TEST_EXTRA_COUNT 737  // then these, mid-window.
+#define FILTER_POWER_TEST_LOUD_AMPLITUDE 1.0E3
+#define FILTER_POWER_TEST_QUIET_AMPLITUDE 1.0E-3
+#define FILTER_POWER_TEST_EPSILON 1.0E-12 // Relative to the golden power.
+
+// Compares each power value with the sum of squares of goldenWindow, after
+// outputCount outputs. Returns false on any mismatch.
+static bool filterTest_checkFilterPower(
+    const filterPower_t *filterPower,
+    double goldenWindow[FILTER_INPUT_PULSE_WIDTH][FILTER_FREQUENCY_COUNT],
+    uint32_t outputCount) {
+  bool success = true; // Be optimistic.
+  const double *powerValues = filterPower_getPowerValues(filterPower);
+  for (uint16_t i = 0; i < FILTER_FREQUENCY_COUNT; i++) {
+    double goldenPower = 0.0;
+    for (uint32_t n = 0; n < FILTER_INPUT_PULSE_WIDTH; n++)
+      goldenPower += goldenWindow[n][i] * goldenWindow[n][i];
+    if (fabs(powerValues[i] - goldenPower) >
+        FILTER_POWER_TEST_EPSILON * goldenPower) {
+      success = false;
+      printf("filterTest_runFilterPowerTest: after %d outputs, power[%d]"
+             "(%24.20le) does not match the golden power(%24.20le).\n",
+             outputCount, i, powerValues[i], goldenPower);
+    }
+  }
+  return success;
+}
+
+// Checks filterPower against a golden sum of squares of the last
+// FILTER_INPUT_PULSE_WIDTH outputs. A loud burst goes through the window first
+// and is followed by quiet outputs, which leaves a plain running sum with
+// rounding far larger than the quiet power. The golden value is compared
+// once the burst has left the window, at a multiple of the window length (just
+// as the shadow sums are swapped in) and again part way through a window.
+static bool filterTest_runFilterPowerTest(bool printMessageFlag) {
+  bool success = true; // Be optimistic.
+  static filterPower_t filterPower;
+  static double goldenWindow[FILTER_INPUT_PULSE_WIDTH][FILTER_FREQUENCY_COUNT];
+  filterPower_init(&filterPower);
+  uint32_t windowEndCount =
+      FILTER_POWER_TEST_LOUD_COUNT + FILTER_POWER_TEST_QUIET_COUNT;
+  uint32_t totalCount = windowEndCount + FILTER_POWER_TEST_EXTRA_COUNT;
+  for (uint32_t n = 0; n < totalCount; n++) {
+    double amplitude = n < FILTER_POWER_TEST_LOUD_COUNT
+                           ? FILTER_POWER_TEST_LOUD_AMPLITUDE
+                           : FILTER_POWER_TEST_QUIET_AMPLITUDE;
+    double outputs[FILTER_FREQUENCY_COUNT];
+    for (uint16_t i = 0; i < FILTER_FREQUENCY_COUNT; i++) {
+      outputs[i] = amplitude * (2.0 * filterTest_randomValue0To1() - 1.0);
+      goldenWindow[n % FILTER_INPUT_PULSE_WIDTH][i] = outputs[i];
+    }
+    filterPower_addOutputs(&filterPower, outputs);
+    if (n + 1 == windowEndCount)
+      success &= filterTest_checkFilterPower(&filterPower, goldenWindow, n + 1);
+  }
+  success &=
+      filterTest_checkFilterPower(&filterPower, goldenWindow, totalCount);
+  if (printMessageFlag) {
+    printf("filterTest_runFilterPowerTest ");
+    if (success)
+      printf("passed.\n");
+    else
+      printf("failed.\n");
+  }
+  return success;
+}
+
+#define IIR_BANK_TEST_INPUT_COUNT 4000
+// Checks that iirBank_filterAll() gives the same outputs as calling
+// filter_iirFilter() for each filter. The same random inputs are pushed onto
+// the yQueue and given to the bank.
+static bool filterTest_runIirBankTest(bool printMessageFlag) {
+  bool success = true; // Be optimistic.
+  filter_fillQueue(filter_getYQueue(), 0.0); // zero-out the yQueue.
+  for (uint16_t i = 0; i < FILTER_FREQUENCY_COUNT; i++)
+    filter_fillQueue(filter_getZQueue(i), 0.0); // zero-out the zQueues.
+  iirBank_init();
+  double bankOutputs[FILTER_FREQUENCY_COUNT];
+  for (uint32_t n = 0; n < IIR_BANK_TEST_INPUT_COUNT && success; n++) {
+    double input = filterTest_randomValue0To1();
+    queue_overwritePush(filter_getYQueue(), input);
+    iirBank_filterAll(input, bankOutputs);
+    for (uint16_t i = 0; i < FILTER_FREQUENCY_COUNT; i++) {
+      double iirGoldenOutput = filter_iirFilter(i);
+      if (!filterTest_floatingPointEqual(bankOutputs[i], iirGoldenOutput)) {
+        success = false;
+        printf("filterTest_runIirBankTest: Output from IIR bank[%d](%24.20le) "
+               "does not match filter_iirFilter()(%24.20le) at input(%d).\n",
+               i, bankOutputs[i], iirGoldenOutput, n);
+        break;
+      }
+    }
+  }
+  if (printMessageFlag) {
+    printf("filterTest_runIirBankTest ");
+    if (success)
+      printf("passed.\n");
+    else
+      printf("failed.\n");
+  }
+  filter_init(); // Leave the filter in a known state.
+  return success;
+}
+
+#ifdef IIR_BANK_USE_FLOAT32
+// Relative to the largest double output so far. float has a 24-bit mantissa
+// and the narrow IIR filters amplify its rounding, so this is looser than
+// FILTER_BLOCK_TEST_EPSILON.
+#define IIR_BANK_FLOAT32_TEST_EPSILON 1.0E-4
+// Checks that iirBank_filterBlockFloat32() stays within
+// IIR_BANK_FLOAT32_TEST_EPSILON of iirBank_filterBlock(). The same random
+// inputs are given to both copies of the bank, one at a time, and every output
+// is compared. Also prints the largest relative error.
+static bool filterTest_runIirBankFloat32Test(bool printMessageFlag) {
+  bool success = true; // Be optimistic.
+  iirBank_init();
+  double maxOutput = 0.0;
+  double maxError = 0.0;
+  for (uint32_t n = 0; n < IIR_BANK_TEST_INPUT_COUNT && success; n++) {
+    double input = 2.0 * filterTest_randomValue0To1() - 1.0;
+    float input32 = (float)input;
+    double outputs[1][IIR_BANK_CHANNEL_COUNT];
+    float outputs32[1][IIR_BANK_CHANNEL_COUNT];
+    iirBank_filterBlock(&input, 1, outputs);
+    iirBank_filterBlockFloat32(&input32, 1, outputs32);
+    for (uint16_t i = 0; i < FILTER_FREQUENCY_COUNT; i++)
+      if (fabs(outputs[0][i]) > maxOutput)
+        maxOutput = fabs(outputs[0][i]);
+    for (uint16_t i = 0; i < FILTER_FREQUENCY_COUNT; i++) {
+      double error = fabs(outputs32[0][i] - outputs[0][i]) / maxOutput;
+      if (error > maxError)
+        maxError = error;
+      if (error > IIR_BANK_FLOAT32_TEST_EPSILON) {
+        success = false;
+        printf("filterTest_runIirBankFloat32Test: Output from float IIR "
+               "bank[%d](%24.20le) does not match the double bank(%24.20le) "
+               "at input(%d).\n",
+               i, outputs32[0][i], outputs[0][i], n);
+        break;
+      }
+    }
+  }
+  if (printMessageFlag) {
+    printf("filterTest_runIirBankFloat32Test: largest error %le of the "
+           "largest output.\n",
+           maxError);
+    printf("filterTest_runIirBankFloat32Test ");
+    if (success)
+      printf("passed.\n");
+    else
+      printf("failed.\n");
+  }
+  iirBank_init(); // Leave the bank in a known state.
+  return success;
+}
+#endif
+
+#define DECIMATING_FIR_TEST_INPUT_COUNT 5000
+// Checks the polyphase decimating FIR engine against a direct FIR computation.
+// Random inputs are fed to the engine and every time it completes a decimation
+// block, its output is compared with the sum of the products of the FIR
+// coefficients and the most recent inputs. Also prints how many multiply-adds
+// were performed, which is the same as running filter_firFilter() once per
+// output, and the most that were done for any one input, which is what the
+// engine saves: filter_firFilter() does all of them on every
+// FILTER_FIR_DECIMATION_FACTOR'th input.
+static bool filterTest_runDecimatingFirTest(bool printMessageFlag) {
+  bool success = true; // Be optimistic.
+  const double *coefficients = filter_getFirCoefficientArray();
+  uint32_t coefficientCount = filter_getFirCoefficientCount();
+  if (coefficientCount > DECIMATING_FIR_MAX_COEFFICIENT_COUNT) {
+    printf("filterTest_runDecimatingFirTest: FIR coefficient count (%d) is "
+           "larger than DECIMATING_FIR_MAX_COEFFICIENT_COUNT (%d).\n",
+           coefficientCount, DECIMATING_FIR_MAX_COEFFICIENT_COUNT);
+    return false;
+  }
+  decimatingFir_init(coefficients, coefficientCount,
+                     FILTER_FIR_DECIMATION_FACTOR);
+  // Golden inputs, newest at inputs[0].
+  double inputs[DECIMATING_FIR_MAX_COEFFICIENT_COUNT] = {0.0};
+  uint32_t outputCount = 0;
+  uint32_t maxInputMultiplyAddCount = 0; // The most for any one input.
+  for (uint32_t i = 0; i < DECIMATING_FIR_TEST_INPUT_COUNT; i++) {
+    for (uint32_t k = coefficientCount - 1; k > 0; k--)
+      inputs[k] = inputs[k - 1];
+    inputs[0] = filterTest_randomValue0To1();
+    uint32_t multiplyAddCount = decimatingFir_getMultiplyAccumulateCount();
+    bool outputFlag = decimatingFir_addNewInput(inputs[0]);
+    multiplyAddCount =
+        decimatingFir_getMultiplyAccumulateCount() - multiplyAddCount;
+    if (multiplyAddCount > maxInputMultiplyAddCount)
+      maxInputMultiplyAddCount = multiplyAddCount;
+    if (!outputFlag)
+      continue; // Not the end of a decimation block, nothing to check.
+    outputCount++;
+    double firGoldenOutput = 0.0;
+    for (uint32_t k = 0; k < coefficientCount; k++)
+      firGoldenOutput += coefficients[k] * inputs[k];
+    if (!filterTest_floatingPointEqual(decimatingFir_getOutput(),
+                                       firGoldenOutput)) {
+      success = false;
+      printf("filterTest_runDecimatingFirTest: Output from decimating FIR "
+             "(%24.20le) does not match test-data(%24.20le) at input(%d).\n",
+             decimatingFir_getOutput(), firGoldenOutput, i);
+      break;
+    }
+  }
+  if (printMessageFlag) {
+    printf("filterTest_runDecimatingFirTest: %d multiply-adds for %d outputs, "
+           "filter_firFilter() once per output uses %d.\n",
+           decimatingFir_getMultiplyAccumulateCount(), outputCount,
+           outputCount * coefficientCount);
+    printf("filterTest_runDecimatingFirTest: at most %d multiply-adds per "
+           "input, filter_firFilter() does %d on every %dth input.\n",
+           maxInputMultiplyAddCount, coefficientCount,
+           FILTER_FIR_DECIMATION_FACTOR);
+    printf("filterTest_runDecimatingFirTest ");
+    if (success)
+      printf("passed.\n");
+    else
+      printf("failed.\n");
+  }
+  filter_init(); // Leave the filter in a known state.
+  return success;
+}
+
+#define FILTER_BLOCK_TEST_BLOCK_COUNT 40
+// Relative to the largest power. The decimating FIR adds its products in a
+// different order than filter_firFilter() and the narrow IIR filters amplify
+// that rounding difference, so this can't be as tight as the other tests.
+#define FILTER_BLOCK_TEST_EPSILON 1.0E-5
+// Checks that filterBlock computes the same power values as running
+// filter_addNewInput(), filter_firFilter(), filter_iirFilter() and
+// filter_computePower() one input at a time. Random inputs are given to
+// filterBlock in blocks of random size, so decimation blocks straddle the
+// block boundaries, and the power values are compared after each block.
+static bool filterTest_runFilterBlockTest(bool printMessageFlag) {
+  bool success = true; // Be optimistic.
+  static double inputs[FILTER_BLOCK_MAX_INPUT_COUNT];
+  filter_init();
+  filterBlock_init();
+  uint16_t decimationCount = 0;
+  for (uint32_t block = 0; block < FILTER_BLOCK_TEST_BLOCK_COUNT && success;
+       block++) {
+    uint32_t count = 1 + rand() % FILTER_BLOCK_MAX_INPUT_COUNT;
+    for (uint32_t n = 0; n < count; n++) {
+      inputs[n] = 2.0 * filterTest_randomValue0To1() - 1.0;
+      filter_addNewInput(inputs[n]);
+      if (++decimationCount < FILTER_FIR_DECIMATION_FACTOR)
+        continue;
+      decimationCount = 0;
+      filter_firFilter();
+      for (uint16_t i = 0; i < FILTER_FREQUENCY_COUNT; i++) {
+        filter_iirFilter(i);
+        filter_computePower(i, false, false);
+      }
+    }
+    filterBlock_processBlock(inputs, count);
+    double goldenPowerValues[FILTER_FREQUENCY_COUNT];
+    double blockPowerValues[FILTER_FREQUENCY_COUNT];
+    filter_getCurrentPowerValues(goldenPowerValues);
+    filterBlock_getCurrentPowerValues(blockPowerValues);
+    double maxPower = findMax(goldenPowerValues, FILTER_FREQUENCY_COUNT);
+    for (uint16_t i = 0; i < FILTER_FREQUENCY_COUNT; i++) {
+      if (fabs(blockPowerValues[i] - goldenPowerValues[i]) >
+          FILTER_BLOCK_TEST_EPSILON * maxPower) {
+        success = false;
+        printf("filterTest_runFilterBlockTest: Power from filterBlock[%d]"
+               "(%24.20le) does not match filter_computePower()(%24.20le) "
+               "after block(%d).\n",
+               i, blockPowerValues[i], goldenPowerValues[i], block);
+        break;
+      }
+    }
+  }
+  if (printMessageFlag) {
+    printf("filterTest_runFilterBlockTest ");
+    if (success)
+      printf("passed.\n");
+    else
+      printf("failed.\n");
+  }
+  filter_init(); // Leave the filter in a known state.
+  return success;
+}
+
+#define ENGINE_BENCHMARK_NOISE_AMPLITUDE 0.2 // Uniform noise in +/- this.
+#define ENGINE_BENCHMARK_AMPLITUDE_COUNT 2
+static const double
+    filterTest_engineBenchmarkAmplitudes[ENGINE_BENCHMARK_AMPLITUDE_COUNT] = {
+        1.0, 0.05};
+#define ENGINE_BENCHMARK_NOISE_TRIAL_COUNT FILTER_FREQUENCY_COUNT
+#define ENGINE_BENCHMARK_IIR_TIMER INTERVAL_TIMER_1
+#define ENGINE_BENCHMARK_DFT_TIMER INTERVAL_TIMER_2
+// Frequency number used for "no hit" and for noise-only trials.
+#define ENGINE_BENCHMARK_NO_FREQUENCY FILTER_FREQUENCY_COUNT
+
+// How one engine did over all of the trials.
+typedef struct {
+  uint32_t correctHits;
+  uint32_t wrongHits; // Hit on a frequency that was not transmitted.
+  uint32_t misses;
+  uint32_t falseHits; // Hit when only noise was present.
+} filterTest_engineScore_t;
+
+// Adds the outcome of one trial to score.
+static void filterTest_scoreEngineTrial(filterTest_engineScore_t *score,
+                                        uint16_t hitFrequency,
+                                        uint16_t transmittedFrequency) {
+  if (transmittedFrequency == ENGINE_BENCHMARK_NO_FREQUENCY) {
+    if (hitFrequency != ENGINE_BENCHMARK_NO_FREQUENCY)
+      score->falseHits++;
+  } else if (hitFrequency == transmittedFrequency) {
+    score->correctHits++;
+  } else if (hitFrequency == ENGINE_BENCHMARK_NO_FREQUENCY) {
+    score->misses++;
+  } else {
+    score->wrongHits++;
+  }
+}
+
+// Runs one pulse-width of a square wave at frequencyNumber (or noise only if
+// frequencyNumber is ENGINE_BENCHMARK_NO_FREQUENCY) through the FIR filter and
+// hands each FIR output to both engines. iirHit and dftHit receive the first
+// frequency each engine would have reported as a hit. The pulse is preceded
+// by a pulse-width of noise so both engines start with a full window, as they
+// would on a running detector.
+static void filterTest_runEngineTrial(uint16_t frequencyNumber,
+                                      double amplitude, uint16_t *iirHit,
+                                      uint16_t *dftHit) {
+  // Start both engines from silence.
+  filterTest_fillQueue(filter_getXQueue(), 0.0);
+  filterTest_fillQueue(filter_getYQueue(), 0.0);
+  for (uint16_t i = 0; i < FILTER_FREQUENCY_COUNT; i++) {
+    filterTest_fillQueue(filter_getZQueue(i), 0.0);
+    filterTest_fillQueue(filter_getIirOutputQueue(i), 0.0);
+    filter_computePower(i, true, false); // Power of the zeroed outputs.
+  }
+  slidingDft_init();
+  *iirHit = ENGINE_BENCHMARK_NO_FREQUENCY;
+  *dftHit = ENGINE_BENCHMARK_NO_FREQUENCY;
+  uint16_t periodTickCount = 0;
+  if (frequencyNumber != ENGINE_BENCHMARK_NO_FREQUENCY)
+    periodTickCount = filterTest_firTestTickCounts[frequencyNumber];
+  uint16_t decimationCount = 0;
+  for (uint32_t tick = 0; tick < 2 * FILTER_TEST_PULSE_WIDTH_LENGTH; tick++) {
+    bool pulseFlag = tick >= FILTER_TEST_PULSE_WIDTH_LENGTH;
+    double input = ENGINE_BENCHMARK_NOISE_AMPLITUDE *
+                   (2.0 * filterTest_randomValue0To1() - 1.0);
+    if (pulseFlag && periodTickCount)
+      input += amplitude *
+               computeFilterInput(tick % periodTickCount, periodTickCount);
+    filter_addNewInput(input);
+    if (++decimationCount < FILTER_FIR_DECIMATION_FACTOR)
+      continue;
+    decimationCount = 0;
+    // The FIR filter is the same for both engines so it is not timed.
+    double firOutput = filter_firFilter();
+    double powerValues[FILTER_FREQUENCY_COUNT];
+    uint16_t hitFrequency;
+    intervalTimer_start(ENGINE_BENCHMARK_IIR_TIMER);
+    for (uint16_t i = 0; i < FILTER_FREQUENCY_COUNT; i++) {
+      filter_iirFilter(i);
+      filter_computePower(i, false, false);
+    }
+    intervalTimer_stop(ENGINE_BENCHMARK_IIR_TIMER);
+    filter_getCurrentPowerValues(powerValues);
+    if (pulseFlag && *iirHit == ENGINE_BENCHMARK_NO_FREQUENCY &&
+        detector_powerValuesIndicateHit(powerValues, &hitFrequency))
+      *iirHit = hitFrequency;
+    intervalTimer_start(ENGINE_BENCHMARK_DFT_TIMER);
+    slidingDft_addNewInput(firOutput);
+    intervalTimer_stop(ENGINE_BENCHMARK_DFT_TIMER);
+    slidingDft_getCurrentPowerValues(powerValues);
+    if (pulseFlag && *dftHit == ENGINE_BENCHMARK_NO_FREQUENCY &&
+        detector_powerValuesIndicateHit(powerValues, &hitFrequency))
+      *dftHit = hitFrequency;
+  }
+}
+
+// Prints the score and run-time of one engine.
+static void filterTest_printEngineScore(const char *name,
+                                        filterTest_engineScore_t *score,
+                                        uint32_t timerNumber) {
+  printf("%s: %d correct, %d wrong frequency, %d missed, %d false hits, "
+         "%lf seconds.\n",
+         name, score->correctHits, score->wrongHits, score->misses,
+         score->falseHits,
+         intervalTimer_getTotalDurationInSeconds(timerNumber));
+}
+
+// Compares the two detector engines (DETECTOR_ENGINE_IIR and
+// DETECTOR_ENGINE_SLIDING_DFT) on the same inputs: square waves at every
+// player frequency at full and low amplitude, plus noise-only trials, all with
+// noise added. Each engine's power values go through the detector's hit
+// algorithm and the hits, misses and false hits are counted. The time spent
+// in each engine after the FIR filter is also reported. Returns false if
+// either engine misses or mis-identifies a full-amplitude pulse.
+static bool filterTest_runDetectorEngineBenchmark(bool printMessageFlag) {
+  if (!filterTest_initFlag) {
+    printf("Must call filterTest_init() before running any filter tests.\n");
+    return false;
+  }
+  bool success = true; // Be optimistic.
+  intervalTimer_initCountUp(ENGINE_BENCHMARK_IIR_TIMER);
+  intervalTimer_initCountUp(ENGINE_BENCHMARK_DFT_TIMER);
+  filterTest_engineScore_t iirScore = {0};
+  filterTest_engineScore_t dftScore = {0};
+  uint16_t iirHit;
+  uint16_t dftHit;
+  for (uint16_t a = 0; a < ENGINE_BENCHMARK_AMPLITUDE_COUNT; a++) {
+    double amplitude = filterTest_engineBenchmarkAmplitudes[a];
+    for (uint16_t i = 0; i < FILTER_FREQUENCY_COUNT; i++) {
+      filterTest_runEngineTrial(i, amplitude, &iirHit, &dftHit);
+      filterTest_scoreEngineTrial(&iirScore, iirHit, i);
+      filterTest_scoreEngineTrial(&dftScore, dftHit, i);
+      // Only the first (full) amplitude has to be detected.
+      if (a == 0 && (iirHit != i || dftHit != i)) {
+        printf("filterTest_runDetectorEngineBenchmark: frequency %d at "
+               "amplitude %lf, IIR engine hit %d, sliding DFT engine hit %d "
+               "(%d means no hit).\n",
+               i, amplitude, iirHit, dftHit, ENGINE_BENCHMARK_NO_FREQUENCY);
+        success = false;
+      }
+    }
+  }
+  for (uint16_t n = 0; n < ENGINE_BENCHMARK_NOISE_TRIAL_COUNT; n++) {
+    filterTest_runEngineTrial(ENGINE_BENCHMARK_NO_FREQUENCY, 0.0, &iirHit,
+                              &dftHit);
+    filterTest_scoreEngineTrial(&iirScore, iirHit,
+                                ENGINE_BENCHMARK_NO_FREQUENCY);
+    filterTest_scoreEngineTrial(&dftScore, dftHit,
+                                ENGINE_BENCHMARK_NO_FREQUENCY);
+  }
+  if (printMessageFlag) {
+    printf("filterTest_runDetectorEngineBenchmark: %d pulses at each of %d "
+           "amplitudes and %d noise-only trials.\n",
+           FILTER_FREQUENCY_COUNT, ENGINE_BENCHMARK_AMPLITUDE_COUNT,
+           ENGINE_BENCHMARK_NOISE_TRIAL_COUNT);
+    filterTest_printEngineScore("IIR engine", &iirScore,
+                                ENGINE_BENCHMARK_IIR_TIMER);
+    filterTest_printEngineScore("sliding DFT engine", &dftScore,
+                                ENGINE_BENCHMARK_DFT_TIMER);
+    printf("filterTest_runDetectorEngineBenchmark ");
+    if (success)
+      printf("passed.\n");
+    else
+      printf("failed.\n");
+  }
+  filter_init(); // Leave the filter in a known state.
+  return success;
+}
+
 // Copies powerValues to currentPowerValues, the same array
 // that is used to hold the values after power has been computed
 // by filter_computePower().
@@ -965,8 +1516,13 @@ bool filterTest_runPowerTest() {
 #define TEST_IIR_FILTER_NUMBER 0
 // Performs several tests of the filter code.
 // 1. Test alignment of FIR constants with input.
-// 2. Test the arithmetic performed by the FIR filter.
+// 2. Test the arithmetic performed by the FIR filter and the decimating FIR.
 // 3. Test alignment of the IIR A and B coefficients.
+// 3a. Test the IIR bank against the individual IIR filters.
+// 3b. Test that the incremental power engine doesn't drift.
+// 3c. Test the accuracy of the fixed-point filters against filter.c.
+// 3d. Compare the IIR and sliding DFT detector engines.
+// 3e. Test the block filter chain against filter.c.
 // 4. Plots the frequency response of the FIR filter on the TFT display.
 // 5. Plots the frequency response of each of the IIR bandpass filters on the
 // TFT display. Returns true if all tests passed, false otherwise. Various
@@ -981,6 +1537,8 @@ bool filterTest_runTest() {
   success &= filterTest_runFirAlignmentTest(PRINT_INFO_MESSAGES);
   // Confirm that the FIR properly computes its output.
   success &= filterTest_runFirArithmeticTest(PRINT_INFO_MESSAGES);
+  // Confirm that the polyphase decimating FIR matches the direct FIR.
+  success &= filterTest_runDecimatingFirTest(PRINT_INFO_MESSAGES);
   // Confirm that the IIR A coefficients are properly aligned with the incoming
   // data.
   success &= filterTest_runIirAAlignmentTest(TEST_IIR_FILTER_NUMBER,
@@ -989,8 +1547,22 @@ bool filterTest_runTest() {
   // data.
   success &= filterTest_runIirBAlignmentTest(TEST_IIR_FILTER_NUMBER,
                                              PRINT_INFO_MESSAGES);
+  // Confirm that the IIR bank matches the individual IIR filters.
+  success &= filterTest_runIirBankTest(PRINT_INFO_MESSAGES);
+#ifdef IIR_BANK_USE_FLOAT32
+  // Compare the float copy of the IIR bank against the double one.
+  success &= filterTest_runIirBankFloat32Test(PRINT_INFO_MESSAGES);
+#endif
   // Verifies correct functionality of the power computation.
   success &= filterTest_runPowerTest();
+  // Verifies that the incremental power engine doesn't drift.
+  success &= filterTest_runFilterPowerTest(PRINT_INFO_MESSAGES);
+  // Compare the fixed-point filters against filter.c.
+  success &= filterTest_runFixedPointAccuracyTest(PRINT_INFO_MESSAGES);
+  // Compare hits and run-time of the two detector engines.
+  success &= filterTest_runDetectorEngineBenchmark(PRINT_INFO_MESSAGES);
+  // Confirm that filtering a block at a time matches filter.c.
+  success &= filterTest_runFilterBlockTest(PRINT_INFO_MESSAGES);
   // Plots the frequency response of the FIR filter against all user and other
   // test frequencies. All frequencies are expressed as a square wave.
   filterTest_runSquareWaveFirPowerTest(PRINT_INFO_MESSAGES, PLOT_INPUT);
@@ -13,6 +13,7 @@ For questions, contact Brad Hutchings or Jeff Goeders, https://ece.byu.edu/
 #include <string.h>
 
 #include "display.h"
+#include "displayGlyphCache.h"
 #include "filter.h"
 #include "histogram.h"
 #include "utils.h"
@@ -40,6 +41,41 @@ static char
 
 #define ONE_HALF(x) ((x) / 2) // Integer divide by 2.
 
+#define HISTOGRAM_LABEL_BACKGROUND_COLOR DISPLAY_BLACK
+#define HISTOGRAM_GLYPH_PIXEL_COUNT (DISPLAY_CHAR_WIDTH * DISPLAY_CHAR_HEIGHT)
+#define HISTOGRAM_MAX_ROW_SPAN_COUNT 2
+// Up to a few black rectangles per bar wait to be joined.
+#define HISTOGRAM_MAX_PENDING_FILL_COUNT (HISTOGRAM_MAX_BAR_COUNT * 8)
+
+typedef enum {
+  HISTOGRAM_ROW_BLACK,
+  HISTOGRAM_ROW_LABEL,
+  HISTOGRAM_ROW_BAR
+} histogram_row_t;
+
+// What has to be written to one row of a bar column: spans [x0, x1) relative
+// to the left of the bar, all in color.
+typedef struct {
+  uint16_t color;
+  uint16_t spanCount;
+  int16_t x0[HISTOGRAM_MAX_ROW_SPAN_COUNT];
+  int16_t x1[HISTOGRAM_MAX_ROW_SPAN_COUNT];
+} histogram_rowFill_t;
+
+typedef struct {
+  int16_t x;
+  int16_t y;
+  int16_t w;
+  int16_t h;
+} histogram_rect_t;
+
+static histogram_rect_t pendingFills[HISTOGRAM_MAX_PENDING_FILL_COUNT];
+static uint16_t pendingFillCount;
+static uint32_t updatePixelBudget;    // 0 means no limit.
+static uint16_t nextBarIndex;         // Where the next update starts.
+static uint32_t lastUpdatePixelCount; // Written by the last update.
+static bool updatePendingFlag;        // The budget stopped the last update.
+
 static bool initFlag =
     false; // Keep track whether histogram_init() has been called.
 // These are the default colors for the bars.
@@ -120,6 +156,11 @@ void histogram_init(uint16_t barCount) {
     topLabel[i][0] = 0;    // Start out with empty strings.
     oldTopLabel[i][0] = 0; // Start out with empty strings.
   }
+  pendingFillCount = 0;
+  updatePixelBudget = 0;
+  nextBarIndex = 0;
+  lastUpdatePixelCount = 0;
+  updatePendingFlag = false;
   for (int i = 0; i < HISTOGRAM_MAX_BAR_COUNT; i++) {
     strncpy(histogram_label[i], histogram_defaultLabel[i],
             HISTOGRAM_MAX_BAR_LABEL_WIDTH);
@@ -128,6 +169,7 @@ void histogram_init(uint16_t barCount) {
   }
   display_fillScreen(DISPLAY_BLACK);
   histogram_drawBottomLabels();
+  display_flush();
   initFlag = true;
 }
 
@@ -139,6 +181,7 @@ void histogram_redrawBottomLabels() {
                        (DISPLAY_CHAR_HEIGHT * HISTOGRAM_BOTTOM_LABEL_TEXT_SIZE),
                    display_width(), display_height(), DISPLAY_BLACK);
   histogram_drawBottomLabels();
+  display_flush();
 }
 
 // This function only updates the data for the histogram.
@@ -167,26 +210,16 @@ bool histogram_setBarData(histogram_index_t barIndex, histogram_data_t data,
            data, HISTOGRAM_MAX_BAR_DATA_IN_PIXELS - 1, barIndex);
     return false;
   }
-  // If it has changed, update the data in the array but don't render anything
-  // on the display.
-  if (data !=
-      currentBarData[barIndex]) { // Only modify the data if it has changed.
-    previousBarData[barIndex] =
-        currentBarData[barIndex]; // Save the old data so you render things
-                                  // properly.
-    // Copy the old string so that you can render things properly.
-    currentBarData[barIndex] = data; // Store the data because it changed.
-  }
-  // If the label has changed, move the previous data to old, new data to
-  // current. Labels are handled separately from data because the label may
-  // change even if the underlying bar data does not. This allows the top label
-  // to change and to be redrawn even if the bars stay the same height.
+  // Update the data in the array but don't render anything on the display.
+  // previousBarData and oldTopLabel keep what is on the display until
+  // histogram_updateDisplay() draws the change.
+  currentBarData[barIndex] = data;
+  // Labels are handled separately from data because the label may change even
+  // if the underlying bar data does not. This allows the top label to change
+  // and to be redrawn even if the bars stay the same height.
   if (strncmp(barTopLabel, topLabel[barIndex],
               HISTOGRAM_BAR_TOP_MAX_LABEL_WIDTH_IN_CHARS)) {
     // If you get here, the new label is different from the last one.
-    strncpy(oldTopLabel[barIndex], topLabel[barIndex],
-            HISTOGRAM_BAR_TOP_MAX_LABEL_WIDTH_IN_CHARS);
-    // Copy the current label to become the new old label.
     strncpy(topLabel[barIndex], barTopLabel,
             HISTOGRAM_BAR_TOP_MAX_LABEL_WIDTH_IN_CHARS);
     // Copy the new label to become the current label.
@@ -204,87 +237,274 @@ bool histogram_setBarData(histogram_index_t barIndex, histogram_data_t data,
   return true; // Everything is OK.
 }
 
-// Internal helper function.
-// Erases the old text (using a fillRect because it is small and fast) to erase
-// the old label, if required. Finds the position for the label, just above the
-// top of the bar.
-void histogram_drawTopLabel(uint16_t barIndex, histogram_data_t data,
-                            const char topLabel[], bool eraseOldLabel) {
-  if (eraseOldLabel) {
-    // Erase with a fillRect because the rect is small and should be faster than
-    // hitting individual label pixels.
-    display_fillRect(barIndex * (histogram_barWidth + HISTOGRAM_BAR_X_GAP),
-                     display_height() - data - HISTOGRAM_BAR_Y_GAP -
-                         DISPLAY_CHAR_HEIGHT - 1,
-                     histogram_barWidth, DISPLAY_CHAR_HEIGHT, DISPLAY_BLACK);
+// The renderer keeps what is on the display in previousBarData and
+// oldTopLabel, and histogram_updateDisplay() only writes the pixels that differ
+// from currentBarData and topLabel. A bar column, from the top, is black, then
+// the top label (DISPLAY_CHAR_HEIGHT rows, only if the bar isn't 0), a black
+// row, the bar (data - 1 rows) and a black row. Rows of a column that need the
+// same fill spans are drawn together, one display_fillRect() per span. Black
+// fills are held back and joined across neighbouring bars (the gap between
+// bars is black too). Labels are drawn a glyph at a time with a black
+// background, from the glyph cache (see displayGlyphCache.h), so a glyph never
+// needs erasing first, and a glyph that is already on the display at the same
+// place is skipped.
+
+// Returns the x-coordinate of the left of the bar.
+static int16_t histogram_getBarX(uint16_t barIndex) {
+  return barIndex * (histogram_barWidth + HISTOGRAM_BAR_X_GAP);
+}
+
+// Returns the row just below the bottom of the bars.
+static int16_t histogram_getBarBase() {
+  return display_height() - HISTOGRAM_BAR_Y_GAP;
+}
+
+// Returns the top row of the label over a bar of height data.
+static int16_t histogram_getLabelY(histogram_data_t data) {
+  return histogram_getBarBase() - data - DISPLAY_CHAR_HEIGHT - 1;
+}
+
+// Returns the x-coordinate, relative to the left of the bar, of the first
+// character of label. The label is centered over the bar.
+static int16_t histogram_getLabelXOffset(const char label[]) {
+  return ONE_HALF(histogram_barWidth -
+                  (int16_t)(strlen(label) * DISPLAY_CHAR_WIDTH));
+}
+
+// Returns what is in row y of a bar column with height data.
+static histogram_row_t histogram_getRowContent(int16_t y,
+                                               histogram_data_t data) {
+  int16_t labelY = histogram_getLabelY(data);
+  if (data != 0 && y >= labelY && y < labelY + DISPLAY_CHAR_HEIGHT)
+    return HISTOGRAM_ROW_LABEL;
+  if (y >= histogram_getBarBase() - data && y < histogram_getBarBase() - 1)
+    return HISTOGRAM_ROW_BAR;
+  return HISTOGRAM_ROW_BLACK;
+}
+
+// Adds the span [x0, x1) to fill, if it isn't empty.
+static void histogram_addSpan(histogram_rowFill_t *fill, int16_t x0,
+                              int16_t x1) {
+  if (x0 < x1 && fill->spanCount < HISTOGRAM_MAX_ROW_SPAN_COUNT) {
+    fill->x0[fill->spanCount] = x0;
+    fill->x1[fill->spanCount] = x1;
+    fill->spanCount++;
+  }
+}
+
+// Adds the parts of [x0, x1) that are outside [notX0, notX1) to fill.
+static void histogram_addSpanOutside(histogram_rowFill_t *fill, int16_t x0,
+                                     int16_t x1, int16_t notX0,
+                                     int16_t notX1) {
+  if (notX0 >= notX1) {
+    histogram_addSpan(fill, x0, x1);
+    return;
+  }
+  histogram_addSpan(fill, x0, notX0 < x1 ? notX0 : x1);
+  histogram_addSpan(fill, notX1 > x0 ? notX1 : x0, x1);
+}
+
+// Works out what row y of a bar column needs when it goes from height oldData
+// with oldLabel to height data with label. The label glyphs themselves are
+// not included.
+static histogram_rowFill_t
+histogram_getRowFill(uint16_t barIndex, int16_t y, histogram_data_t oldData,
+                     const char oldLabel[], histogram_data_t data,
+                     const char label[]) {
+  histogram_rowFill_t fill = {.color = DISPLAY_BLACK, .spanCount = 0};
+  histogram_row_t oldContent = histogram_getRowContent(y, oldData);
+  histogram_row_t content = histogram_getRowContent(y, data);
+  int16_t oldLabelX0 = histogram_getLabelXOffset(oldLabel);
+  int16_t oldLabelX1 = oldLabelX0 + strlen(oldLabel) * DISPLAY_CHAR_WIDTH;
+  int16_t labelX0 = histogram_getLabelXOffset(label);
+  int16_t labelX1 = labelX0 + strlen(label) * DISPLAY_CHAR_WIDTH;
+  bool labelMoved = oldData != data;
+  switch (content) {
+  case HISTOGRAM_ROW_BAR:
+    if (oldContent != HISTOGRAM_ROW_BAR) {
+      fill.color = histogram_barColors[barIndex];
+      histogram_addSpan(&fill, 0, histogram_barWidth);
+    }
+    break;
+  case HISTOGRAM_ROW_BLACK:
+    if (oldContent == HISTOGRAM_ROW_BAR)
+      histogram_addSpan(&fill, 0, histogram_barWidth);
+    else if (oldContent == HISTOGRAM_ROW_LABEL)
+      histogram_addSpan(&fill, oldLabelX0, oldLabelX1);
+    break;
+  case HISTOGRAM_ROW_LABEL:
+    // The glyphs cover [labelX0, labelX1), the rest of the row must be black.
+    if (oldContent == HISTOGRAM_ROW_BAR)
+      histogram_addSpanOutside(&fill, 0, histogram_barWidth, labelX0, labelX1);
+    else if (oldContent == HISTOGRAM_ROW_LABEL &&
+             (labelMoved || strcmp(oldLabel, label)))
+      histogram_addSpanOutside(&fill, oldLabelX0, oldLabelX1, labelX0,
+                               labelX1);
+    break;
+  }
+  return fill;
+}
+
+// Returns true if two row fills write the same pixels, so their rows can share
+// rectangles.
+static bool histogram_rowFillsMatch(const histogram_rowFill_t *a,
+                                    const histogram_rowFill_t *b) {
+  if (a->spanCount != b->spanCount ||
+      (a->spanCount > 0 && a->color != b->color))
+    return false;
+  for (uint16_t i = 0; i < a->spanCount; i++) {
+    if (a->x0[i] != b->x0[i] || a->x1[i] != b->x1[i])
+      return false;
+  }
+  return true;
+}
+
+// Fills a rectangle. Black ones are held back so they can be joined with the
+// ones from the neighbouring bars, see histogram_flushPendingFills().
+static void histogram_fill(int16_t x, int16_t y, int16_t w, int16_t h,
+                           uint16_t color) {
+  lastUpdatePixelCount += w * h;
+  if (color != DISPLAY_BLACK ||
+      pendingFillCount == HISTOGRAM_MAX_PENDING_FILL_COUNT) {
+    display_fillRect(x, y, w, h, color);
+    return;
+  }
+  for (uint16_t i = 0; i < pendingFillCount; i++) {
+    histogram_rect_t *rect = &pendingFills[i];
+    // Join a rectangle that ends at the right of the previous bar.
+    if (rect->y == y && rect->h == h &&
+        rect->x + rect->w + HISTOGRAM_BAR_X_GAP == x) {
+      rect->w += HISTOGRAM_BAR_X_GAP + w;
+      return;
+    }
+  }
+  pendingFills[pendingFillCount++] = (histogram_rect_t){x, y, w, h};
+}
+
+// Draws the black rectangles held back by histogram_fill().
+static void histogram_flushPendingFills() {
+  for (uint16_t i = 0; i < pendingFillCount; i++) {
+    histogram_rect_t *rect = &pendingFills[i];
+    display_fillRect(rect->x, rect->y, rect->w, rect->h, DISPLAY_BLACK);
+  }
+  pendingFillCount = 0;
+}
+
+// Writes, or only counts if draw is false, the pixels that change when the
+// bar goes from what is on the display to its current data and label. Returns
+// the number of pixels.
+static uint32_t histogram_renderBar(uint16_t barIndex, bool draw) {
+  histogram_data_t oldData = previousBarData[barIndex];
+  histogram_data_t data = currentBarData[barIndex];
+  const char *oldLabel = oldTopLabel[barIndex];
+  const char *label = topLabel[barIndex];
+  int16_t barX = histogram_getBarX(barIndex);
+  uint32_t pixelCount = 0;
+  // Only the rows between the highest label and the bottom can change.
+  histogram_data_t highest = oldData > data ? oldData : data;
+  int16_t top = histogram_getLabelY(highest);
+  int16_t bottom = histogram_getBarBase();
+  int16_t runY = top;
+  histogram_rowFill_t run =
+      histogram_getRowFill(barIndex, top, oldData, oldLabel, data, label);
+  for (int16_t y = top + 1; y <= bottom; y++) {
+    histogram_rowFill_t fill = {.spanCount = 0};
+    if (y < bottom)
+      fill = histogram_getRowFill(barIndex, y, oldData, oldLabel, data, label);
+    if (y < bottom && histogram_rowFillsMatch(&fill, &run))
+      continue;
+    // The run of matching rows ends here.
+    for (uint16_t i = 0; i < run.spanCount; i++) {
+      int16_t w = run.x1[i] - run.x0[i];
+      pixelCount += w * (y - runY);
+      if (draw)
+        histogram_fill(barX + run.x0[i], runY, w, y - runY, run.color);
+    }
+    run = fill;
+    runY = y;
+  }
+  if (data == 0)
+    return pixelCount;
+  // Draw every glyph of a label that moved, only the ones that changed of one
+  // that didn't.
+  int16_t labelX = barX + histogram_getLabelXOffset(label);
+  int16_t oldLabelX = barX + histogram_getLabelXOffset(oldLabel);
+  uint16_t oldLength = strlen(oldLabel);
+  for (uint16_t i = 0; label[i] != 0; i++) {
+    int16_t x = labelX + i * DISPLAY_CHAR_WIDTH;
+    int16_t oldIndex = (x - oldLabelX) / DISPLAY_CHAR_WIDTH;
+    if (oldData == data && x >= oldLabelX &&
+        (x - oldLabelX) % DISPLAY_CHAR_WIDTH == 0 && oldIndex < oldLength &&
+        oldLabel[oldIndex] == label[i])
+      continue;
+    pixelCount += HISTOGRAM_GLYPH_PIXEL_COUNT;
+    if (draw) {
+      lastUpdatePixelCount += HISTOGRAM_GLYPH_PIXEL_COUNT;
+      displayGlyphCache_drawChar(x, histogram_getLabelY(data), label[i],
+                                 histogram_barTopLabelColors[barIndex],
+                                 HISTOGRAM_LABEL_BACKGROUND_COLOR,
+                                 TOP_LABEL_TEXT_SIZE);
+    }
   }
-  uint16_t topLabelXOffset = ONE_HALF(
-      histogram_barWidth -
-      (strlen(topLabel) *
-       DISPLAY_CHAR_WIDTH)); // This helps to center the label over the bar.
-  display_setCursor(
-      barIndex * (histogram_barWidth + HISTOGRAM_BAR_X_GAP) +
-          topLabelXOffset, // This is the location of the top label.
-      display_height() - data - HISTOGRAM_BAR_Y_GAP - DISPLAY_CHAR_HEIGHT - 1);
-  display_setTextSize(TOP_LABEL_TEXT_SIZE); // Use tiny text to pack more
-                                            // characters into the label.
-  display_setTextColor(
-      histogram_barTopLabelColors[barIndex]); // Set the color of the label.
-  display_print(topLabel);                    // Draw the label.
+  return pixelCount;
+}
+
+// Returns true if the bar on the display isn't the bar's current data and
+// label.
+static bool histogram_barIsDirty(uint16_t barIndex) {
+  return previousBarData[barIndex] != currentBarData[barIndex] ||
+         strncmp(topLabel[barIndex], oldTopLabel[barIndex],
+                 HISTOGRAM_BAR_TOP_MAX_LABEL_WIDTH_IN_CHARS);
 }
 
 // This updates the display.
-// It loops across all bars, checking:
-// If the height of the bar has changed, redraw both the bar and the top label.
-// If the height of the bar has not changed, but the top label has changed,
-// update the label.
+// Writes only the pixels that changed since the last update, a bar at a time.
+// If a pixel budget is set, stops before the bar that would go over it, and
+// the next update starts there.
 void histogram_updateDisplay() {
   if (!initFlag) {
     printf("Error! histogram_displayUpdate(): must call histogram_init() "
            "before calling this function.\n");
     return;
   }
-  for (int i = 0; i < histogram_barCount; i++) {
-    histogram_data_t oldData = previousBarData[i]; // Get the previous data.
-    histogram_data_t data = currentBarData[i];     // Get the current bar data.
-    if (oldData !=
-        data) { // If the are not equal, redraw the bar and the top-label.
-      // Erase the old bar and extend the erase rectangle to include the
-      // top-label so that everything is erased at once. Also, redraw the top
-      // label.
-      display_fillRect(i * (histogram_barWidth + HISTOGRAM_BAR_X_GAP),
-                       display_height() - oldData - HISTOGRAM_BAR_Y_GAP -
-                           DISPLAY_CHAR_HEIGHT - 1,
-                       histogram_barWidth, oldData + DISPLAY_CHAR_HEIGHT + 1,
-                       DISPLAY_BLACK);
-      // Draw the new bar.
-      display_fillRect(i * (histogram_barWidth + HISTOGRAM_BAR_X_GAP),
-                       display_height() - data - HISTOGRAM_BAR_Y_GAP,
-                       histogram_barWidth, data - 1, histogram_barColors[i]);
-      if (data != 0) { // Only draw the top label if the bar-data != 0.
-        histogram_drawTopLabel(i, data, topLabel[i],
-                               false); // false means that the old label does
-                                       // not need to be erased.
-        previousBarData[i] = currentBarData[i]; // Old data and new data are the
-                                                // same after the update.
-        // Old label and new label are the same after the update.
-        strncpy(oldTopLabel[i], topLabel[i],
-                HISTOGRAM_BAR_TOP_MAX_LABEL_WIDTH_IN_CHARS);
+  lastUpdatePixelCount = 0;
+  updatePendingFlag = false;
+  uint32_t spentPixelCount = 0;
+  uint16_t barIndex = nextBarIndex;
+  for (uint16_t count = 0; count < histogram_barCount; count++) {
+    if (histogram_barIsDirty(barIndex)) {
+      uint32_t cost = histogram_renderBar(barIndex, false);
+      // Always draw at least one bar so every bar gets drawn eventually.
+      if (updatePixelBudget != 0 && spentPixelCount != 0 &&
+          spentPixelCount + cost > updatePixelBudget) {
+        updatePendingFlag = true;
+        break;
       }
-    } else if ((data != 0) &&
-               strncmp(topLabel[i], oldTopLabel[i],
-                       HISTOGRAM_BAR_TOP_MAX_LABEL_WIDTH_IN_CHARS)) {
-      histogram_drawTopLabel(
-          i, data, topLabel[i],
-          true); // True means that the old label needs to be erased.
-      // After the update, copy the label to old data so that it won't reupdate
-      // until the next change.
-      strncpy(oldTopLabel[i], topLabel[i],
+      histogram_renderBar(barIndex, true);
+      spentPixelCount += cost;
+      previousBarData[barIndex] = currentBarData[barIndex];
+      strncpy(oldTopLabel[barIndex], topLabel[barIndex],
               HISTOGRAM_BAR_TOP_MAX_LABEL_WIDTH_IN_CHARS);
     }
+    barIndex = (barIndex + 1) % histogram_barCount;
   }
+  nextBarIndex = barIndex;
+  histogram_flushPendingFills();
+  display_flush();
+}
+
+// Returns true if some bars weren't drawn by the last
+// histogram_updateDisplay() because of the pixel budget.
+bool histogram_updatePending() { return updatePendingFlag; }
+
+// Limits the pixels written by each histogram_updateDisplay(), 0 for no limit.
+void histogram_setUpdatePixelBudget(uint32_t pixelCount) {
+  updatePixelBudget = pixelCount;
 }
 
+// Returns the number of pixels written by the last histogram_updateDisplay().
+uint32_t histogram_getLastUpdatePixelCount() { return lastUpdatePixelCount; }
+
 // Set the bar-color for each bar. This overwrites the defaults. Call
 // histogram_init() to restore the defaults.
 void histogram_setBarColor(histogram_index_t barIndex, uint16_t color) {
@@ -310,22 +530,74 @@ void histogram_setBarLabel(histogram_index_t barIndex, const char *label) {
 // Sets the size of the characters used in the bottom labels.
 void histogram_setBottomLabelTextSize(uint16_t size) {}
 
+// Returns the pixels the renderer used to write for a bar going from oldData
+// with oldLabel to data with label: it erased the old bar and label, drew the
+// whole new bar and label, and erased and redrew a label that changed on its
+// own.
+static uint32_t histogram_getFullRedrawPixelCount(histogram_data_t oldData,
+                                                  const char oldLabel[],
+                                                  histogram_data_t data,
+                                                  const char label[]) {
+  uint32_t labelPixelCount = strlen(label) * HISTOGRAM_GLYPH_PIXEL_COUNT;
+  if (oldData != data)
+    return histogram_barWidth * (oldData + DISPLAY_CHAR_HEIGHT + 1) +
+           (data == 0 ? 0
+                      : histogram_barWidth * (data - 1) + labelPixelCount);
+  if (data != 0 && strcmp(oldLabel, label))
+    return histogram_barWidth * DISPLAY_CHAR_HEIGHT + labelPixelCount;
+  return 0;
+}
+
 // Runs a short test that writes random values to the histogram bar-values as
-// specified by the #defines below.
+// specified by the #defines below. The first half sets every bar to a random
+// value, the second moves each bar a little, labelled with its value, the way
+// the power display changes. Prints the pixels written per update by each
+// half, and what redrawing every changed bar whole would have written.
 #define RANDOM_LABEL "99"
 #define HISTOGRAM_RUN_TEST_ITERATION_COUNT 10
 #define HISTOGRAM_RUN_TEST_LOOP_DELAY_MS 500
+#define HISTOGRAM_RUN_TEST_MAX_STEP 10 // Pixels a bar moves in the second half.
 void histogram_runTest() {
   histogram_init(
       HISTOGRAM_DEFAULT_BAR_COUNT); // Must init the histogram data structures.
-  for (int i = 0; i < HISTOGRAM_RUN_TEST_ITERATION_COUNT;
+  uint32_t pixelCount = 0;
+  uint32_t fullRedrawPixelCount = 0;
+  for (int i = 0; i < 2 * HISTOGRAM_RUN_TEST_ITERATION_COUNT;
        i++) { // Loop as required.
     for (int j = 0; j < histogram_barCount;
          j++) { // set each of the bar values.
-      histogram_setBarData(j, rand() % HISTOGRAM_MAX_BAR_DATA_IN_PIXELS,
-                           RANDOM_LABEL); // set the bar data to a random value.
+      if (i < HISTOGRAM_RUN_TEST_ITERATION_COUNT) {
+        histogram_setBarData(j, rand() % HISTOGRAM_MAX_BAR_DATA_IN_PIXELS,
+                             RANDOM_LABEL); // set the bar data to a random
+                                            // value.
+        continue;
+      }
+      int16_t data = currentBarData[j] +
+                     rand() % (2 * HISTOGRAM_RUN_TEST_MAX_STEP + 1) -
+                     HISTOGRAM_RUN_TEST_MAX_STEP;
+      if (data < 0)
+        data = 0;
+      if (data > HISTOGRAM_MAX_BAR_DATA_IN_PIXELS)
+        data = HISTOGRAM_MAX_BAR_DATA_IN_PIXELS;
+      char label[HISTOGRAM_BAR_TOP_MAX_LABEL_WIDTH_IN_CHARS];
+      snprintf(label, HISTOGRAM_BAR_TOP_MAX_LABEL_WIDTH_IN_CHARS, "%d", data);
+      histogram_setBarData(j, data, label);
+    }
+    for (int j = 0; j < histogram_barCount; j++)
+      fullRedrawPixelCount += histogram_getFullRedrawPixelCount(
+          previousBarData[j], oldTopLabel[j], currentBarData[j], topLabel[j]);
+    histogram_updateDisplay(); // update the display.
+    pixelCount += histogram_getLastUpdatePixelCount();
+    if (i % HISTOGRAM_RUN_TEST_ITERATION_COUNT ==
+        HISTOGRAM_RUN_TEST_ITERATION_COUNT - 1) {
+      printf("histogram_runTest(): %s: %d pixels per update, %d redrawing "
+             "whole bars.\n",
+             i < HISTOGRAM_RUN_TEST_ITERATION_COUNT ? "random" : "small steps",
+             pixelCount / HISTOGRAM_RUN_TEST_ITERATION_COUNT,
+             fullRedrawPixelCount / HISTOGRAM_RUN_TEST_ITERATION_COUNT);
+      pixelCount = 0;
+      fullRedrawPixelCount = 0;
     }
-    histogram_updateDisplay();                       // update the display.
     utils_msDelay(HISTOGRAM_RUN_TEST_LOOP_DELAY_MS); // Slow the update so you
                                                      // can see it happen.
   }
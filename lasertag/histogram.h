@@ -10,6 +10,7 @@ For questions, contact Brad Hutchings or Jeff Goeders, https://ece.byu.edu/
 #ifndef HISTOGRAM_H_
 #define HISTOGRAM_H_
 
+#include <stdbool.h>
 #include <stdint.h>
 
 #include "display.h"
@@ -84,8 +85,25 @@ void histogram_redrawBottomLabels();
 void histogram_setBottomLabelTextSize(uint16_t);
 
 // Call this to draw the histogram with the data from histogram_setBarData().
+// Only the pixels that changed since the last update are written, with as few
+// display_fillRect() calls as it can. If a pixel budget is set, stops before
+// the bar that would go over it, and the next call carries on from there.
 void histogram_updateDisplay();
 
+// Returns true if the last histogram_updateDisplay() stopped at the pixel
+// budget with bars left to draw.
+bool histogram_updatePending();
+
+// Limits the pixels each histogram_updateDisplay() writes, so drawing can't
+// hold up the detector for long. Time on the display is roughly proportional
+// to the pixels written. At least one bar is always drawn. 0 (the default, set
+// by histogram_init()) means no limit.
+void histogram_setUpdatePixelBudget(uint32_t pixelCount);
+
+// Returns the number of pixels written by the last histogram_updateDisplay(),
+// counting a whole character cell for each label glyph.
+uint32_t histogram_getLastUpdatePixelCount();
+
 // Used to plot the power response for user frequencies 0-9.
 void histogram_plotUserFrequencyPower(double powerValue[]);
 
@@ -0,0 +1,255 @@
+/*
+This software is provided for student assignment use in the Department of
+Electrical and Computer Engineering, Brigham Young University, Utah, USA.
+Users agree to not re-host, or redistribute the software, in source or binary
+form, to other persons or other institutions. Users may modify and use the
+source code for personal or educational use.
+For questions, contact Brad Hutchings or Jeff Goeders, https://ece.byu.edu/
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "filter.h"
+#include "hitThreshold.h"
+
+// The median of the power values (lower of the two middle values).
+#define HIT_THRESHOLD_MEDIAN_INDEX ((FILTER_FREQUENCY_COUNT - 1) / 2)
+
+static double noiseFloors[FILTER_FREQUENCY_COUNT];
+static uint32_t quietCallCount; // Short-circuited calls in a row.
+static uint32_t checkCount;
+static uint32_t shortCircuitCount;
+
+// Zeroes the noise floors and the call counts.
+void hitThreshold_init() {
+  for (uint16_t i = 0; i < FILTER_FREQUENCY_COUNT; i++)
+    noiseFloors[i] = 0.0;
+  quietCallCount = 0;
+  checkCount = 0;
+  shortCircuitCount = 0;
+}
+
+// Swaps two doubles.
+static void hitThreshold_swap(double *a, double *b) {
+  double temp = *a;
+  *a = *b;
+  *b = temp;
+}
+
+// Returns the k'th smallest of the first count values, reordering values.
+double hitThreshold_select(double values[], uint16_t count, uint16_t k) {
+  int16_t left = 0;
+  int16_t right = count - 1;
+  while (left < right) {
+    // Order the first, middle and last values and split around the middle
+    // one, so sorted or reversed input doesn't make it quadratic.
+    int16_t middle = left + (right - left) / 2;
+    if (values[middle] < values[left])
+      hitThreshold_swap(&values[middle], &values[left]);
+    if (values[right] < values[left])
+      hitThreshold_swap(&values[right], &values[left]);
+    if (values[right] < values[middle])
+      hitThreshold_swap(&values[right], &values[middle]);
+    double pivot = values[middle];
+    int16_t i = left;
+    int16_t j = right;
+    while (i <= j) {
+      while (values[i] < pivot)
+        i++;
+      while (values[j] > pivot)
+        j--;
+      if (i <= j) {
+        hitThreshold_swap(&values[i], &values[j]);
+        i++;
+        j--;
+      }
+    }
+    // values[left..j] <= pivot <= values[i..right], anything between is the
+    // pivot.
+    if (k <= j)
+      right = j;
+    else if (k >= i)
+      left = i;
+    else
+      return values[k];
+  }
+  return values[k];
+}
+
+// Returns the median of the power values without changing them.
+double hitThreshold_getMedian(const double powerValues[]) {
+  double values[FILTER_FREQUENCY_COUNT];
+  memcpy(values, powerValues, sizeof(values));
+  return hitThreshold_select(values, FILTER_FREQUENCY_COUNT,
+                             HIT_THRESHOLD_MEDIAN_INDEX);
+}
+
+// Moves every noise floor toward its newest power value.
+static void hitThreshold_updateNoiseFloors(const double powerValues[]) {
+  for (uint16_t i = 0; i < FILTER_FREQUENCY_COUNT; i++)
+    noiseFloors[i] += (powerValues[i] - noiseFloors[i]) /
+                      HIT_THRESHOLD_NOISE_FLOOR_CALL_COUNT;
+}
+
+// Runs the adaptive hit test, updating the noise floors.
+bool hitThreshold_check(const double powerValues[], double fudgeFactor,
+                        uint16_t *frequencyNumber) {
+  checkCount++;
+  uint16_t maxIndex = 0;
+  for (uint16_t i = 1; i < FILTER_FREQUENCY_COUNT; i++) {
+    if (powerValues[i] > powerValues[maxIndex])
+      maxIndex = i;
+  }
+  double maxPower = powerValues[maxIndex];
+  if (maxPower < HIT_THRESHOLD_MIN_POWER) {
+    shortCircuitCount++;
+    if (quietCallCount < HIT_THRESHOLD_NOISE_FLOOR_CALL_COUNT)
+      quietCallCount++;
+    return false;
+  }
+  if (quietCallCount == HIT_THRESHOLD_NOISE_FLOOR_CALL_COUNT) {
+    // Long enough that smoothing would have brought the floors down this far.
+    for (uint16_t i = 0; i < FILTER_FREQUENCY_COUNT; i++) {
+      if (noiseFloors[i] > HIT_THRESHOLD_MIN_POWER)
+        noiseFloors[i] = HIT_THRESHOLD_MIN_POWER;
+    }
+  }
+  quietCallCount = 0;
+  // The noise floor test is cheaper than the median, so it goes first.
+  if (maxPower > noiseFloors[maxIndex] * HIT_THRESHOLD_NOISE_FLOOR_FACTOR &&
+      maxPower > hitThreshold_getMedian(powerValues) * fudgeFactor) {
+    *frequencyNumber = maxIndex;
+    return true;
+  }
+  hitThreshold_updateNoiseFloors(powerValues);
+  return false;
+}
+
+// Returns the noise floor of one channel.
+double hitThreshold_getNoiseFloor(uint16_t frequencyNumber) {
+  return noiseFloors[frequencyNumber];
+}
+
+// Returns the number of hitThreshold_check() calls since hitThreshold_init().
+uint32_t hitThreshold_getCheckCount() { return checkCount; }
+
+// Returns how many of those stopped at HIT_THRESHOLD_MIN_POWER.
+uint32_t hitThreshold_getShortCircuitCount() { return shortCircuitCount; }
+
+/*******************************************************
+ ****************** Test Routines **********************
+ ******************************************************/
+
+#define TEST_SELECT_TRIAL_COUNT 1000
+#define TEST_FUDGE_FACTOR 100.0
+#define TEST_BACKGROUND_POWER 1.0
+#define TEST_NOISY_CHANNEL 3
+#define TEST_NOISY_CHANNEL_POWER 30.0
+#define TEST_QUIET_CHANNEL 5
+// More than the median times TEST_FUDGE_FACTOR, but less than the noisy
+// channel's floor times HIT_THRESHOLD_NOISE_FLOOR_FACTOR.
+#define TEST_PULSE_POWER 110.0
+#define TEST_STRONG_PULSE_POWER 150.0
+
+// Test power values. Frequency 9 stands well above the median in the first
+// set, nothing does in the second (the same as detector_runTest()).
+static const double testHitPowerValues[FILTER_FREQUENCY_COUNT] = {
+    150.0, 20.0, 40.0, 10.0, 15.0, 30.0, 35.0, 15.0, 25.0, 8000.0};
+static const double testNoHitPowerValues[FILTER_FREQUENCY_COUNT] = {
+    150.0, 20.0, 40.0, 10.0, 15.0, 30.0, 35.0, 15.0, 25.0, 80.0};
+#define TEST_HIT_FREQUENCY 9
+
+// For qsort().
+static int hitThreshold_compareDoubles(const void *a, const void *b) {
+  double x = *(const double *)a;
+  double y = *(const double *)b;
+  return (x > y) - (x < y);
+}
+
+// Checks hitThreshold_select() against qsort() for every k of random arrays
+// of every length up to FILTER_FREQUENCY_COUNT, with repeated values.
+static bool hitThreshold_testSelect() {
+  for (uint16_t trial = 0; trial < TEST_SELECT_TRIAL_COUNT; trial++) {
+    uint16_t count = trial % FILTER_FREQUENCY_COUNT + 1;
+    double values[FILTER_FREQUENCY_COUNT];
+    double sorted[FILTER_FREQUENCY_COUNT];
+    for (uint16_t i = 0; i < count; i++)
+      values[i] = rand() % (trial % 2 ? 4 : 1000); // Odd trials repeat a lot.
+    memcpy(sorted, values, sizeof(values));
+    qsort(sorted, count, sizeof(double), hitThreshold_compareDoubles);
+    for (uint16_t k = 0; k < count; k++) {
+      double copy[FILTER_FREQUENCY_COUNT];
+      memcpy(copy, values, sizeof(values));
+      if (hitThreshold_select(copy, count, k) != sorted[k]) {
+        printf("hitThreshold_runTest: select %d of %d gave the wrong value.\n",
+               k, count);
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+// Calls hitThreshold_check() with every channel at TEST_BACKGROUND_POWER
+// except channel, which is at power. Returns the frequency hit or
+// FILTER_FREQUENCY_COUNT for no hit.
+static uint16_t hitThreshold_testCheck(uint16_t channel, double power) {
+  double powerValues[FILTER_FREQUENCY_COUNT];
+  for (uint16_t i = 0; i < FILTER_FREQUENCY_COUNT; i++)
+    powerValues[i] = i == channel ? power : TEST_BACKGROUND_POWER;
+  uint16_t frequencyNumber;
+  if (hitThreshold_check(powerValues, TEST_FUDGE_FACTOR, &frequencyNumber))
+    return frequencyNumber;
+  return FILTER_FREQUENCY_COUNT;
+}
+
+// Checks quickselect against a sort, then the hit test.
+bool hitThreshold_runTest() {
+  printf("Running hitThreshold_runTest()\n");
+  bool success = hitThreshold_testSelect();
+  hitThreshold_init();
+  uint16_t frequencyNumber = 0;
+  // The same verdicts as the sorted-median test.
+  success &= hitThreshold_check(testHitPowerValues, TEST_FUDGE_FACTOR,
+                                &frequencyNumber) &&
+             frequencyNumber == TEST_HIT_FREQUENCY;
+  success &= !hitThreshold_check(testNoHitPowerValues, TEST_FUDGE_FACTOR,
+                                 &frequencyNumber);
+  // Anything below the minimum power is short-circuited.
+  double quietPowerValues[FILTER_FREQUENCY_COUNT] = {0.0};
+  quietPowerValues[TEST_HIT_FREQUENCY] = HIT_THRESHOLD_MIN_POWER / 2;
+  success &= !hitThreshold_check(quietPowerValues, TEST_FUDGE_FACTOR,
+                                 &frequencyNumber);
+  success &= hitThreshold_getShortCircuitCount() == 1;
+  success &= hitThreshold_getCheckCount() == 3;
+
+  // Let the noisy channel's floor settle at its background power.
+  hitThreshold_init();
+  for (uint32_t i = 0; i < 8 * HIT_THRESHOLD_NOISE_FLOOR_CALL_COUNT; i++)
+    hitThreshold_testCheck(TEST_NOISY_CHANNEL, TEST_NOISY_CHANNEL_POWER);
+  double floor = hitThreshold_getNoiseFloor(TEST_NOISY_CHANNEL);
+  success &= floor > 0.99 * TEST_NOISY_CHANNEL_POWER;
+  // The same pulse is a hit on a quiet channel but not on the noisy one, a
+  // stronger one is a hit on both.
+  success &= hitThreshold_testCheck(TEST_QUIET_CHANNEL, TEST_PULSE_POWER) ==
+             TEST_QUIET_CHANNEL;
+  success &= hitThreshold_testCheck(TEST_NOISY_CHANNEL, TEST_PULSE_POWER) ==
+             FILTER_FREQUENCY_COUNT;
+  success &= hitThreshold_testCheck(TEST_NOISY_CHANNEL,
+                                    TEST_STRONG_PULSE_POWER) ==
+             TEST_NOISY_CHANNEL;
+  // A long quiet stretch brings the floor back down.
+  for (uint32_t i = 0; i < HIT_THRESHOLD_NOISE_FLOOR_CALL_COUNT; i++)
+    hitThreshold_check(quietPowerValues, TEST_FUDGE_FACTOR, &frequencyNumber);
+  success &= hitThreshold_testCheck(TEST_NOISY_CHANNEL, TEST_PULSE_POWER) ==
+             TEST_NOISY_CHANNEL;
+  // Still needs more than the median times the fudge factor.
+  double medianThreshold = TEST_FUDGE_FACTOR * TEST_BACKGROUND_POWER;
+  success &= hitThreshold_testCheck(TEST_QUIET_CHANNEL, medianThreshold) ==
+             FILTER_FREQUENCY_COUNT;
+  hitThreshold_init();
+  printf("hitThreshold_runTest %s.\n", success ? "passed" : "failed");
+  return success;
+}
@@ -0,0 +1,82 @@
+/*
+This software is provided for student assignment use in the Department of
+Electrical and Computer Engineering, Brigham Young University, Utah, USA.
+Users agree to not re-host, or redistribute the software, in source or binary
+form, to other persons or other institutions. Users may modify and use the
+source code for personal or educational use.
+For questions, contact Brad Hutchings or Jeff Goeders, https://ece.byu.edu/
+*/
+
+#ifndef HITTHRESHOLD_H_
+#define HITTHRESHOLD_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Hit detection for the detector's DETECTOR_HIT_TEST_ADAPTIVE (see
+// detector.h). As with the sorted-median test, the largest power is a hit when
+// it is more than the median power times the fudge factor. Three things keep
+// it cheap and make it harder to fool:
+//
+// 1. If the largest power is below HIT_THRESHOLD_MIN_POWER nothing else is
+//    done. That is the usual case, nobody is shooting, so most calls are a
+//    pass over the 10 values looking for the largest.
+// 2. Each channel keeps an exponentially smoothed noise floor, updated with
+//    every call that isn't a hit. The largest power must also be more than
+//    HIT_THRESHOLD_NOISE_FLOOR_FACTOR times its own channel's floor, so a
+//    channel with a noisy background (lights, a nearby transmitter ramping up)
+//    needs a stronger pulse than a quiet one. If it isn't, the median is never
+//    needed.
+// 3. The median is found with quickselect (median-of-three pivots) on a copy
+//    of the values instead of sorting them. With only 10 values
+//    median-of-medians would cost more than it saves.
+//
+// The floors don't move while calls are short-circuited. After a quiet stretch
+// at least as long as the smoothing time they are lowered to
+// HIT_THRESHOLD_MIN_POWER, which is what smoothing the quiet values would have
+// done. A channel that stays above the threshold all of the time keeps
+// hitting, as it does with the sorted-median test. Ignore its frequency in
+// detector_init() instead.
+
+// Power below this is never a hit. Roughly a tone of 2 ADC LSBs amplitude over
+// the FILTER_INPUT_PULSE_WIDTH power window, about 50 times the power of the
+// ADC noise in one channel.
+#define HIT_THRESHOLD_MIN_POWER 1.0e-3
+// The largest power must be this many times its channel's noise floor.
+#define HIT_THRESHOLD_NOISE_FLOOR_FACTOR 4.0
+// Noise floors move 1/HIT_THRESHOLD_NOISE_FLOOR_CALL_COUNT of the way to the
+// newest power each call, about 0.4 seconds at one call per decimated sample.
+#define HIT_THRESHOLD_NOISE_FLOOR_CALL_COUNT 4096
+
+// Zeroes the noise floors and the call counts.
+void hitThreshold_init();
+
+// Returns the k'th smallest of the first count values (k = 0 is the smallest),
+// reordering values. Quickselect, O(count) on average.
+double hitThreshold_select(double values[], uint16_t count, uint16_t k);
+
+// Returns the median of the FILTER_FREQUENCY_COUNT power values (the lower of
+// the two middle values) without changing them.
+double hitThreshold_getMedian(const double powerValues[]);
+
+// Runs the adaptive hit test on the FILTER_FREQUENCY_COUNT power values with
+// fudgeFactor, updating the noise floors. Returns true and sets
+// frequencyNumber if the largest power is a hit.
+bool hitThreshold_check(const double powerValues[], double fudgeFactor,
+                        uint16_t *frequencyNumber);
+
+// Returns the noise floor of one channel.
+double hitThreshold_getNoiseFloor(uint16_t frequencyNumber);
+
+// Returns the number of hitThreshold_check() calls since hitThreshold_init().
+uint32_t hitThreshold_getCheckCount();
+
+// Returns how many of those stopped at HIT_THRESHOLD_MIN_POWER.
+uint32_t hitThreshold_getShortCircuitCount();
+
+// Checks quickselect against a sort, then the hit test: the minimum power,
+// a noise floor that is learned and then forgotten, and that a hit still
+// needs the median times the fudge factor. Returns true if everything passes.
+bool hitThreshold_runTest();
+
+#endif /* HITTHRESHOLD_H_ */
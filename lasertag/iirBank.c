@@ -0,0 +1,317 @@
+/*
+This software is provided for student assignment use in the Department of
+Electrical and Computer Engineering, Brigham Young University, Utah, USA.
+Users agree to not re-host, or redistribute the software, in source or binary
+form, to other persons or other institutions. Users may modify and use the
+source code for personal or educational use.
+For questions, contact Brad Hutchings or Jeff Goeders, https://ece.byu.edu/
+*/
+
+#include <assert.h>
+#include <stdio.h>
+
+#ifdef IIR_BANK_USE_FLOAT32
+#include <complex.h>
+#include <math.h>
+#endif
+
+#include "iirBank.h"
+#include "mirroredBuffer.h"
+
+// Keep rows on a 32-byte boundary (4 doubles).
+#define ROW_ALIGNMENT 32
+// Length of the mirrored input and output histories.
+#define HISTORY_SIZE                                                           \
+  (MIRRORED_BUFFER_COPY_COUNT * IIR_BANK_MAX_COEFFICIENT_COUNT)
+
+static uint32_t aCoefficientCount;
+static uint32_t bCoefficientCount;
+
+// Coefficients, row k is coefficient k of every filter.
+static double aCoefficients[IIR_BANK_MAX_COEFFICIENT_COUNT]
+                           [IIR_BANK_CHANNEL_COUNT]
+    __attribute__((aligned(ROW_ALIGNMENT)));
+static double bCoefficients[IIR_BANK_MAX_COEFFICIENT_COUNT]
+                           [IIR_BANK_CHANNEL_COUNT]
+    __attribute__((aligned(ROW_ALIGNMENT)));
+
+// Inputs, shared by all of the filters. The histories are mirrored (see
+// mirroredBuffer.h) so the newest values are always contiguous. yIndex points
+// to the oldest input.
+static double yHistory[HISTORY_SIZE];
+static uint32_t yIndex;
+
+// Outputs, row k is the output of every filter from k + 1 samples ago once a
+// new input is added. zIndex points to the oldest row.
+static double zHistory[HISTORY_SIZE][IIR_BANK_CHANNEL_COUNT]
+    __attribute__((aligned(ROW_ALIGNMENT)));
+static uint32_t zIndex;
+
+#ifdef IIR_BANK_USE_FLOAT32
+// A filter with n A-coefficients is split into (n + 1) / 2 sections.
+#define MAX_SECTION_COUNT ((IIR_BANK_MAX_COEFFICIENT_COUNT + 1) / 2)
+// Durand-Kerner iterations used to find the poles.
+#define POLE_ITERATION_COUNT 500
+// Poles with a smaller imaginary part than this are taken as real.
+#define REAL_POLE_EPSILON 1.0E-9
+// Largest difference allowed between the A-coefficients and the product of
+// the sections, relative to the largest A-coefficient. This only catches
+// poles that were not found: clustered poles can't be found to much better
+// than 1.0E-7 in double.
+#define SECTION_PRODUCT_EPSILON 1.0E-5
+
+// The float copy. Its B-summation is the same as the double bank's, but its
+// A-summation is a cascade of second-order sections, 1 / (1 + a1 z^-1 +
+// a2 z^-2): rounding all of the A-coefficients of a narrow filter to float
+// moves its poles outside the unit circle. Row s holds section s of every
+// filter.
+static uint32_t sectionCount;
+static float bCoefficients32[IIR_BANK_MAX_COEFFICIENT_COUNT]
+                            [IIR_BANK_CHANNEL_COUNT]
+    __attribute__((aligned(ROW_ALIGNMENT)));
+static float a1Coefficients32[MAX_SECTION_COUNT][IIR_BANK_CHANNEL_COUNT]
+    __attribute__((aligned(ROW_ALIGNMENT)));
+static float a2Coefficients32[MAX_SECTION_COUNT][IIR_BANK_CHANNEL_COUNT]
+    __attribute__((aligned(ROW_ALIGNMENT)));
+static float yHistory32[HISTORY_SIZE];
+static uint32_t yIndex32;
+// The last two outputs of every section.
+static float z1History32[MAX_SECTION_COUNT][IIR_BANK_CHANNEL_COUNT]
+    __attribute__((aligned(ROW_ALIGNMENT)));
+static float z2History32[MAX_SECTION_COUNT][IIR_BANK_CHANNEL_COUNT]
+    __attribute__((aligned(ROW_ALIGNMENT)));
+
+// Finds the poles, the roots of z^n + a[0] z^(n-1) + ... + a[n-1], with the
+// Durand-Kerner method.
+static void iirBank_findPoles(const double a[], uint32_t n,
+                              double complex poles[]) {
+  for (uint32_t k = 0; k < n; k++)
+    poles[k] = cpow(0.4 + 0.9 * I, k);
+  for (uint32_t iteration = 0; iteration < POLE_ITERATION_COUNT; iteration++) {
+    for (uint32_t k = 0; k < n; k++) {
+      double complex value = 1.0;
+      for (uint32_t j = 0; j < n; j++)
+        value = value * poles[k] + a[j];
+      double complex product = 1.0;
+      for (uint32_t j = 0; j < n; j++)
+        if (j != k)
+          product *= poles[k] - poles[j];
+      poles[k] -= value / product;
+    }
+  }
+}
+
+// Pairs the n poles into (n + 1) / 2 sections. A pole with a positive
+// imaginary part goes with its conjugate and real poles go two to a section.
+// If n is odd, the last real pole gets a first-order section (a2 is 0.0).
+// Returns false if the poles can't be paired that way.
+static bool iirBank_pairPoles(const double complex poles[], uint32_t n,
+                              double a1[], double a2[]) {
+  uint32_t section = 0;
+  uint32_t realCount = 0;
+  double real[IIR_BANK_MAX_COEFFICIENT_COUNT];
+  for (uint32_t k = 0; k < n; k++) {
+    if (fabs(cimag(poles[k])) < REAL_POLE_EPSILON) {
+      real[realCount++] = creal(poles[k]);
+    } else if (cimag(poles[k]) > 0.0) {
+      a1[section] = -2.0 * creal(poles[k]);
+      a2[section] = creal(poles[k] * conj(poles[k]));
+      section++;
+    }
+  }
+  if (2 * section + realCount != n)
+    return false; // Some pole is missing its conjugate.
+  for (uint32_t k = 0; k < realCount; k += 2) {
+    bool pair = k + 1 < realCount;
+    a1[section] = -(real[k] + (pair ? real[k + 1] : 0.0));
+    a2[section] = pair ? real[k] * real[k + 1] : 0.0;
+    section++;
+  }
+  return true;
+}
+
+// Returns the largest difference between the n A-coefficients and the
+// product of the sections, relative to the largest A-coefficient.
+static double iirBank_getSectionError(const double a[], uint32_t n,
+                                      const double a1[], const double a2[]) {
+  double product[IIR_BANK_MAX_COEFFICIENT_COUNT + 2] = {1.0};
+  uint32_t order = 0;
+  for (uint32_t s = 0; s < (n + 1) / 2; s++) {
+    order += 2;
+    for (uint32_t k = order; k >= 2; k--)
+      product[k] += a1[s] * product[k - 1] + a2[s] * product[k - 2];
+    product[1] += a1[s];
+  }
+  double error = 0.0;
+  double largest = 0.0;
+  for (uint32_t k = 0; k < n; k++) {
+    error = fmax(error, fabs(product[k + 1] - a[k]));
+    largest = fmax(largest, fabs(a[k]));
+  }
+  return error / largest;
+}
+
+// Sets up the float copy from the double coefficients and zeroes it.
+static void iirBank_initFloat32() {
+  sectionCount = (aCoefficientCount + 1) / 2;
+  for (uint32_t k = 0; k < IIR_BANK_MAX_COEFFICIENT_COUNT; k++)
+    for (uint16_t i = 0; i < IIR_BANK_CHANNEL_COUNT; i++)
+      bCoefficients32[k][i] = (float)bCoefficients[k][i];
+  for (uint32_t s = 0; s < MAX_SECTION_COUNT; s++) {
+    for (uint16_t i = 0; i < IIR_BANK_CHANNEL_COUNT; i++) {
+      a1Coefficients32[s][i] = 0.0f; // Padding columns pass 0.0 through.
+      a2Coefficients32[s][i] = 0.0f;
+      z1History32[s][i] = 0.0f;
+      z2History32[s][i] = 0.0f;
+    }
+  }
+  for (uint16_t i = 0; i < FILTER_FREQUENCY_COUNT; i++) {
+    double a[IIR_BANK_MAX_COEFFICIENT_COUNT];
+    for (uint32_t k = 0; k < aCoefficientCount; k++)
+      a[k] = aCoefficients[k][i];
+    double complex poles[IIR_BANK_MAX_COEFFICIENT_COUNT];
+    double a1[MAX_SECTION_COUNT] = {0.0};
+    double a2[MAX_SECTION_COUNT] = {0.0};
+    iirBank_findPoles(a, aCoefficientCount, poles);
+    if (!iirBank_pairPoles(poles, aCoefficientCount, a1, a2) ||
+        iirBank_getSectionError(a, aCoefficientCount, a1, a2) >
+            SECTION_PRODUCT_EPSILON) {
+      printf("iirBank_init(): could not split IIR filter %d into "
+             "second-order sections.\n",
+             i);
+      assert(false);
+    }
+    for (uint32_t s = 0; s < sectionCount; s++) {
+      a1Coefficients32[s][i] = (float)a1[s];
+      a2Coefficients32[s][i] = (float)a2[s];
+    }
+  }
+  for (uint32_t k = 0; k < HISTORY_SIZE; k++)
+    yHistory32[k] = 0.0f;
+  yIndex32 = 0;
+}
+#endif
+
+// Must call this prior to using any other iirBank functions. Copies the
+// coefficients from filter_getIirACoefficientArray() and
+// filter_getIirBCoefficientArray() and zeroes all inputs and outputs.
+void iirBank_init() {
+  aCoefficientCount = filter_getIirACoefficientCount();
+  bCoefficientCount = filter_getIirBCoefficientCount();
+  if (aCoefficientCount > IIR_BANK_MAX_COEFFICIENT_COUNT ||
+      bCoefficientCount > IIR_BANK_MAX_COEFFICIENT_COUNT) {
+    printf("iirBank_init(): filter.c has more IIR coefficients than the iirBank "
+           "can hold.\n");
+    assert(false);
+  }
+  // Transpose the coefficients into rows, padding columns stay 0.0.
+  for (uint32_t k = 0; k < IIR_BANK_MAX_COEFFICIENT_COUNT; k++) {
+    for (uint16_t i = 0; i < IIR_BANK_CHANNEL_COUNT; i++) {
+      bool used = i < FILTER_FREQUENCY_COUNT;
+      aCoefficients[k][i] = (used && k < aCoefficientCount)
+                                ? filter_getIirACoefficientArray(i)[k]
+                                : 0.0;
+      bCoefficients[k][i] = (used && k < bCoefficientCount)
+                                ? filter_getIirBCoefficientArray(i)[k]
+                                : 0.0;
+    }
+  }
+  for (uint32_t k = 0; k < HISTORY_SIZE; k++) {
+    yHistory[k] = 0.0;
+    for (uint16_t i = 0; i < IIR_BANK_CHANNEL_COUNT; i++)
+      zHistory[k][i] = 0.0;
+  }
+  yIndex = 0;
+  zIndex = 0;
+#ifdef IIR_BANK_USE_FLOAT32
+  iirBank_initFloat32();
+#endif
+}
+
+// Adds a new input and advances every IIR filter by one sample. sum receives
+// all IIR_BANK_CHANNEL_COUNT new outputs.
+static void iirBank_advance(double input, double sum[]) {
+  mirroredBuffer_push(yHistory, &yIndex, bCoefficientCount, &input,
+                      sizeof(input));
+  for (uint16_t i = 0; i < IIR_BANK_CHANNEL_COUNT; i++)
+    sum[i] = 0.0;
+  // B-summation, the newest input goes with coefficient 0.
+  const double *newestY = mirroredBuffer_getNewest(
+      yHistory, yIndex, bCoefficientCount, sizeof(yHistory[0]));
+  for (uint32_t k = 0; k < bCoefficientCount; k++) {
+    const double y = newestY[-(int32_t)k];
+    for (uint16_t i = 0; i < IIR_BANK_CHANNEL_COUNT; i++)
+      sum[i] += bCoefficients[k][i] * y;
+  }
+  // A-summation, the newest output row goes with coefficient 0.
+  const double(*newestZ)[IIR_BANK_CHANNEL_COUNT] = mirroredBuffer_getNewest(
+      zHistory, zIndex, aCoefficientCount, sizeof(zHistory[0]));
+  for (uint32_t k = 0; k < aCoefficientCount; k++) {
+    const double *z = newestZ[-(int32_t)k];
+    for (uint16_t i = 0; i < IIR_BANK_CHANNEL_COUNT; i++)
+      sum[i] -= aCoefficients[k][i] * z[i];
+  }
+  // The new outputs replace the oldest row.
+  mirroredBuffer_push(zHistory, &zIndex, aCoefficientCount, sum,
+                      sizeof(zHistory[0]));
+}
+
+// Adds a new input (FIR output) and advances every IIR filter by one sample.
+// outputs[i] receives the new output of filter i, for all
+// FILTER_FREQUENCY_COUNT filters.
+void iirBank_filterAll(double input, double outputs[]) {
+  double sum[IIR_BANK_CHANNEL_COUNT] __attribute__((aligned(ROW_ALIGNMENT)));
+  iirBank_advance(input, sum);
+  for (uint16_t i = 0; i < FILTER_FREQUENCY_COUNT; i++)
+    outputs[i] = sum[i];
+}
+
+// Runs every IIR filter over count inputs. Row n of outputs receives the
+// outputs of all of the filters for inputs[n] (padding columns included).
+void iirBank_filterBlock(const double inputs[], uint32_t count,
+                         double outputs[][IIR_BANK_CHANNEL_COUNT]) {
+  for (uint32_t n = 0; n < count; n++)
+    iirBank_advance(inputs[n], outputs[n]);
+}
+
+#ifdef IIR_BANK_USE_FLOAT32
+// Same as iirBank_advance(), with the float copy of the bank.
+static void iirBank_advanceFloat32(float input, float sum[]) {
+  mirroredBuffer_push(yHistory32, &yIndex32, bCoefficientCount, &input,
+                      sizeof(input));
+  for (uint16_t i = 0; i < IIR_BANK_CHANNEL_COUNT; i++)
+    sum[i] = 0.0f;
+  const float *newestY = mirroredBuffer_getNewest(
+      yHistory32, yIndex32, bCoefficientCount, sizeof(yHistory32[0]));
+  for (uint32_t k = 0; k < bCoefficientCount; k++) {
+    const float y = newestY[-(int32_t)k];
+    for (uint16_t i = 0; i < IIR_BANK_CHANNEL_COUNT; i++)
+      sum[i] += bCoefficients32[k][i] * y;
+  }
+  // Each section filters the output of the one before it.
+  for (uint32_t s = 0; s < sectionCount; s++) {
+    for (uint16_t i = 0; i < IIR_BANK_CHANNEL_COUNT; i++) {
+      float z = sum[i] - a1Coefficients32[s][i] * z1History32[s][i] -
+                a2Coefficients32[s][i] * z2History32[s][i];
+      z2History32[s][i] = z1History32[s][i];
+      z1History32[s][i] = z;
+      sum[i] = z;
+    }
+  }
+}
+
+// Same as iirBank_filterBlock(), with the float copy of the bank. The float
+// copy has its own inputs and outputs, separate from the double bank's.
+void iirBank_filterBlockFloat32(const float inputs[], uint32_t count,
+                                float outputs[][IIR_BANK_CHANNEL_COUNT]) {
+  for (uint32_t n = 0; n < count; n++)
+    iirBank_advanceFloat32(inputs[n], outputs[n]);
+}
+#endif
+
+// Returns the most recent output of filterNumber.
+double iirBank_getOutput(uint16_t filterNumber) {
+  const double(*newestZ)[IIR_BANK_CHANNEL_COUNT] = mirroredBuffer_getNewest(
+      zHistory, zIndex, aCoefficientCount, sizeof(zHistory[0]));
+  return (*newestZ)[filterNumber];
+}
@@ -0,0 +1,69 @@
+/*
+This software is provided for student assignment use in the Department of
+Electrical and Computer Engineering, Brigham Young University, Utah, USA.
+Users agree to not re-host, or redistribute the software, in source or binary
+form, to other persons or other institutions. Users may modify and use the
+source code for personal or educational use.
+For questions, contact Brad Hutchings or Jeff Goeders, https://ece.byu.edu/
+*/
+
+#ifndef IIRBANK_H_
+#define IIRBANK_H_
+
+#include <stdint.h>
+
+#include "filter.h"
+
+// Runs all FILTER_FREQUENCY_COUNT IIR filters together, one input at a time.
+// All of the filters share the same input (the FIR output) and have the same
+// number of coefficients, so the coefficients and the fed-back outputs are
+// stored by tap rather than by filter: row k holds tap k for every filter, one
+// filter per column. The inner loops then run across the filters with no
+// dependencies between columns, which is the form compilers vectorize
+// (iirBank.c is built with -O3 for that reason).
+//
+// filter.c can use iirBank_filterAll() in place of calling filter_iirFilter()
+// once per filter and push the outputs onto its output queues.
+
+// Uncomment this to also keep a float copy of the bank, which filterBlock.c
+// then uses in place of the double one. ARMv7 NEON has four float lanes and no
+// double lanes, so on the board only the float loops are vectorized (iirBank.c
+// is built with -mfpu=neon there). The float copy runs each filter's
+// A-summation as a cascade of second-order sections, which iirBank_init()
+// works out from the double coefficients.
+//#define IIR_BANK_USE_FLOAT32
+
+// Number of columns in each row. Padded up to a multiple of 4 so rows stay
+// aligned and vector loops have no leftover columns. The padding columns have
+// zero coefficients and always output 0.0.
+#define IIR_BANK_CHANNEL_COUNT ((FILTER_FREQUENCY_COUNT + 3) & ~3)
+
+// Largest number of A or B coefficients the bank will hold.
+#define IIR_BANK_MAX_COEFFICIENT_COUNT 16
+
+// Must call this prior to using any other iirBank functions. Copies the
+// coefficients from filter_getIirACoefficientArray() and
+// filter_getIirBCoefficientArray() and zeroes all inputs and outputs.
+void iirBank_init();
+
+// Adds a new input (FIR output) and advances every IIR filter by one sample.
+// outputs[i] receives the new output of filter i, for all
+// FILTER_FREQUENCY_COUNT filters.
+void iirBank_filterAll(double input, double outputs[]);
+
+// Runs every IIR filter over count inputs. Row n of outputs receives the
+// outputs of all of the filters for inputs[n] (padding columns included).
+void iirBank_filterBlock(const double inputs[], uint32_t count,
+                         double outputs[][IIR_BANK_CHANNEL_COUNT]);
+
+#ifdef IIR_BANK_USE_FLOAT32
+// Same as iirBank_filterBlock(), with the float copy of the bank. The float
+// copy has its own inputs and outputs, separate from the double bank's.
+void iirBank_filterBlockFloat32(const float inputs[], uint32_t count,
+                                float outputs[][IIR_BANK_CHANNEL_COUNT]);
+#endif
+
+// Returns the most recent output of filterNumber.
+double iirBank_getOutput(uint16_t filterNumber);
+
+#endif /* IIRBANK_H_ */
@@ -0,0 +1,152 @@
+/*
+This software is provided for student assignment use in the Department of
+Electrical and Computer Engineering, Brigham Young University, Utah, USA.
+Users agree to not re-host, or redistribute the software, in source or binary
+form, to other persons or other institutions. Users may modify and use the
+source code for personal or educational use.
+For questions, contact Brad Hutchings or Jeff Goeders, https://ece.byu.edu/
+*/
+
+#include <stdio.h>
+#include <string.h>
+
+#include "adcStream.h"
+#include "hitLedTimer.h"
+#include "interrupts.h"
+#include "isr.h"
+#include "isrProfiler.h"
+#include "lockoutTimer.h"
+#include "sound.h"
+#include "transmitter.h"
+#include "trigger.h"
+
+// The ADC buffer is a single-producer/single-consumer ring: isr_function() is
+// the only writer of writeIndex and the detector is the only writer of
+// readIndex. Each side publishes its index with a release store after it is
+// done with the data, and reads the other side's index with an acquire load
+// before touching the data, so neither side ever needs interrupts disabled.
+// The indices run freely and wrap at 2^32, so writeIndex - readIndex is always
+// the element count and a full buffer is never confused with an empty one.
+
+// Must be a power of two so free-running indices can be masked into the
+// buffer. About 0.33 seconds of samples at 100 kHz.
+#define ADC_BUFFER_SIZE 32768
+#define ADC_BUFFER_INDEX_MASK (ADC_BUFFER_SIZE - 1)
+
+static isr_AdcValue_t adcBuffer[ADC_BUFFER_SIZE];
+static uint32_t writeIndex;    // Only written by the producer (ISR).
+static uint32_t readIndex;     // Only written by the consumer (detector).
+static uint32_t overflowCount; // Only written by the producer (ISR).
+
+// Performs inits for anything in isr.c
+void isr_init() {
+  writeIndex = 0;
+  readIndex = 0;
+  overflowCount = 0;
+  isrProfiler_init();
+  transmitter_init();
+  trigger_init();
+  hitLedTimer_init();
+  lockoutTimer_init();
+  sound_init();
+}
+
+// This function is invoked by the timer interrupt at 100 kHz.
+// Each part is timed by isrProfiler, one timer read between parts, if
+// ISR_PROFILER_ENABLED is defined.
+void isr_function() {
+  isrProfiler_ticks_t start = ISR_PROFILER_NOW();
+  isr_AdcValue_t adcValue = interrupts_getAdcData();
+  isr_addDataToAdcBuffer(adcValue);
+  adcStream_addSample(adcValue); // Does nothing unless streaming.
+  isrProfiler_ticks_t time = ISR_PROFILER_RECORD(ISR_PROFILER_ADC, start);
+  transmitter_tick();
+  time = ISR_PROFILER_RECORD(ISR_PROFILER_TRANSMITTER, time);
+  trigger_tick();
+  time = ISR_PROFILER_RECORD(ISR_PROFILER_TRIGGER, time);
+  hitLedTimer_tick();
+  time = ISR_PROFILER_RECORD(ISR_PROFILER_HIT_LED_TIMER, time);
+  lockoutTimer_tick();
+  time = ISR_PROFILER_RECORD(ISR_PROFILER_LOCKOUT_TIMER, time);
+  sound_tick();
+  (void)ISR_PROFILER_RECORD(ISR_PROFILER_SOUND, time);
+  (void)ISR_PROFILER_RECORD(ISR_PROFILER_ISR, start);
+}
+
+// This adds data to the ADC buffer. If the buffer is full the value is dropped
+// (the producer can't move readIndex) and counted, see
+// isr_getAdcBufferOverflowCount().
+void isr_addDataToAdcBuffer(isr_AdcValue_t value) {
+  uint32_t write = writeIndex; // Only this side writes it, no ordering needed.
+  uint32_t read = __atomic_load_n(&readIndex, __ATOMIC_ACQUIRE);
+  if (write - read >= ADC_BUFFER_SIZE) {
+    overflowCount++;
+    return;
+  }
+  adcBuffer[write & ADC_BUFFER_INDEX_MASK] = value;
+  // Publish the value only after it is in the buffer.
+  __atomic_store_n(&writeIndex, write + 1, __ATOMIC_RELEASE);
+}
+
+// This removes a value from the ADC buffer.
+isr_AdcValue_t isr_removeDataFromAdcBuffer() {
+  uint32_t read = readIndex; // Only this side writes it, no ordering needed.
+  uint32_t write = __atomic_load_n(&writeIndex, __ATOMIC_ACQUIRE);
+  if (write == read) {
+    printf("isr_removeDataFromAdcBuffer(): ADC buffer is empty.\n");
+    return 0;
+  }
+  isr_AdcValue_t value = adcBuffer[read & ADC_BUFFER_INDEX_MASK];
+  // Hand the slot back only after the value has been read.
+  __atomic_store_n(&readIndex, read + 1, __ATOMIC_RELEASE);
+  return value;
+}
+
+// Removes up to maxCount values from the ADC buffer into values, oldest first,
+// and returns how many were removed.
+uint32_t isr_removeDataFromAdcBufferBatch(isr_AdcValue_t values[],
+                                          uint32_t maxCount) {
+  uint32_t read = readIndex;
+  uint32_t write = __atomic_load_n(&writeIndex, __ATOMIC_ACQUIRE);
+  uint32_t count = write - read;
+  if (count > maxCount)
+    count = maxCount;
+  // Copy in at most two pieces: up to the end of the buffer, then from the
+  // start.
+  uint32_t start = read & ADC_BUFFER_INDEX_MASK;
+  uint32_t firstCount = ADC_BUFFER_SIZE - start;
+  if (firstCount > count)
+    firstCount = count;
+  memcpy(values, &adcBuffer[start], firstCount * sizeof(isr_AdcValue_t));
+  memcpy(&values[firstCount], adcBuffer,
+         (count - firstCount) * sizeof(isr_AdcValue_t));
+  __atomic_store_n(&readIndex, read + count, __ATOMIC_RELEASE);
+  return count;
+}
+
+// This returns the number of values in the ADC buffer.
+uint32_t isr_adcBufferElementCount() {
+  return __atomic_load_n(&writeIndex, __ATOMIC_ACQUIRE) -
+         __atomic_load_n(&readIndex, __ATOMIC_ACQUIRE);
+}
+
+// Returns the number of ADC values dropped because the buffer was full.
+uint32_t isr_getAdcBufferOverflowCount() {
+  return __atomic_load_n(&overflowCount, __ATOMIC_RELAXED);
+}
+
+// Returns the number of ADC values handed to isr_addDataToAdcBuffer() since
+// isr_init(). Every value either moves writeIndex or is counted as dropped, so
+// the ISR doesn't need a counter of its own.
+uint32_t isr_getSampleCount() {
+  return __atomic_load_n(&writeIndex, __ATOMIC_ACQUIRE) +
+         __atomic_load_n(&overflowCount, __ATOMIC_RELAXED);
+}
+
+// Returns the number of ADC values removed from the ADC buffer or dropped
+// since isr_init(). This is isr_getSampleCount() -
+// isr_adcBufferElementCount() without the race between the two reads:
+// writeIndex cancels out and readIndex only moves on this side.
+uint32_t isr_getRemovedSampleCount() {
+  return readIndex + __atomic_load_n(&overflowCount, __ATOMIC_RELAXED);
+}
@@ -19,6 +19,9 @@ typedef uint32_t
 // accurate timing. A buffer for storing values from the Analog to Digital
 // Converter (ADC) is implemented in isr.c Values are added to this buffer by
 // the code in isr.c. Values are removed from this buffer by code in detector.c
+// The buffer is a single-producer/single-consumer ring: only isr_function()
+// adds values and only the detector removes them, so neither side has to
+// disable interrupts.
 
 // Performs inits for anything in isr.c
 void isr_init();
@@ -32,7 +35,27 @@ void isr_addDataToAdcBuffer(isr_AdcValue_t value);
 // This removes a value from the ADC buffer.
 isr_AdcValue_t isr_removeDataFromAdcBuffer();
 
+// Removes up to maxCount values from the ADC buffer into values, oldest first,
+// and returns how many were removed.
+uint32_t isr_removeDataFromAdcBufferBatch(isr_AdcValue_t values[],
+                                          uint32_t maxCount);
+
 // This returns the number of values in the ADC buffer.
 uint32_t isr_adcBufferElementCount();
 
+// Returns the number of ADC values dropped because the buffer was full.
+uint32_t isr_getAdcBufferOverflowCount();
+
+// Returns the number of ADC values handed to isr_addDataToAdcBuffer() since
+// isr_init(), dropped ones included. That is the time since isr_init() in
+// 100 kHz ticks, wrapping after about 11.9 hours.
+uint32_t isr_getSampleCount();
+
+// Returns the number of ADC values removed from the ADC buffer or dropped
+// since isr_init(): isr_getSampleCount() as of the newest value the consumer
+// has taken. Only call from the consumer (the main loop). It needs no
+// interrupt masking because the consumer is the only side that moves
+// readIndex.
+uint32_t isr_getRemovedSampleCount();
+
 #endif /* ISR_H_ */
@@ -0,0 +1,247 @@
+/*
+This software is provided for student assignment use in the Department of
+Electrical and Computer Engineering, Brigham Young University, Utah, USA.
+Users agree to not re-host, or redistribute the software, in source or binary
+form, to other persons or other institutions. Users may modify and use the
+source code for personal or educational use.
+For questions, contact Brad Hutchings or Jeff Goeders, https://ece.byu.edu/
+*/
+
+#include <stdio.h>
+
+#include "isrProfiler.h"
+
+#ifdef ZYBO_BOARD
+#include "xparameters.h"
+#include "xpseudo_asm.h"
+#include "xreg_cortexa9.h"
+// The cycle counter counts CPU clocks.
+#define TICKS_PER_SECOND XPAR_CPU_CORTEXA9_0_CPU_CLK_FREQ_HZ
+#define PMCR_ENABLE 0x1              // Turn on the counters.
+#define PMCR_RESET_CYCLE_COUNTER 0x4 // Zero the cycle counter.
+#define PMCNTENSET_CYCLE_COUNTER 0x80000000 // Let the cycle counter run.
+#else
+#include <time.h>
+#define TICKS_PER_SECOND 1000000000 // Nanoseconds.
+#define NANOSECONDS_PER_SECOND 1000000000
+#endif
+
+#define MICROSECONDS_PER_SECOND 1000000.0
+#define TICKS_PER_MICROSECOND (TICKS_PER_SECOND / MICROSECONDS_PER_SECOND)
+#define BITS_PER_TICK_COUNT 32
+
+typedef struct {
+  uint32_t count;
+  isrProfiler_ticks_t minTicks;
+  isrProfiler_ticks_t maxTicks;
+  uint64_t totalTicks;
+  uint32_t histogram[ISR_PROFILER_HISTOGRAM_BUCKET_COUNT];
+} isrProfiler_stats_t;
+
+// Only written by isr_function(), read by the main loop for display, so a
+// reading can be off by one interrupt's worth.
+static isrProfiler_stats_t stats[ISR_PROFILER_PART_COUNT];
+
+static const char *partNames[ISR_PROFILER_PART_COUNT] = {
+    "adc", "transmitter", "trigger", "hitLedTimer",
+    "lockoutTimer", "sound", "isr total"};
+
+// Starts the cycle counter (on the board) and clears all statistics.
+void isrProfiler_init() {
+#ifdef ZYBO_BOARD
+  mtcp(XREG_CP15_PERF_MONITOR_CTRL, PMCR_ENABLE | PMCR_RESET_CYCLE_COUNTER);
+  mtcp(XREG_CP15_COUNT_ENABLE_SET, PMCNTENSET_CYCLE_COUNTER);
+#endif
+  isrProfiler_reset();
+}
+
+// Clears all statistics.
+void isrProfiler_reset() {
+  for (uint16_t part = 0; part < ISR_PROFILER_PART_COUNT; part++) {
+    stats[part].count = 0;
+    stats[part].minTicks = UINT32_MAX;
+    stats[part].maxTicks = 0;
+    stats[part].totalTicks = 0;
+    for (uint16_t bucket = 0; bucket < ISR_PROFILER_HISTOGRAM_BUCKET_COUNT;
+         bucket++)
+      stats[part].histogram[bucket] = 0;
+  }
+}
+
+// Returns the current time in ticks.
+isrProfiler_ticks_t isrProfiler_now() {
+#ifdef ZYBO_BOARD
+  return mfcp(XREG_CP15_PERF_CYCLE_COUNTER);
+#else
+  struct timespec time;
+  clock_gettime(CLOCK_MONOTONIC, &time);
+  // Only differences are used, so wrapping at 2^32 is fine.
+  return (isrProfiler_ticks_t)((uint64_t)time.tv_sec * NANOSECONDS_PER_SECOND +
+                               time.tv_nsec);
+#endif
+}
+
+// Adds one duration to the statistics for part.
+static void isrProfiler_addDuration(isrProfiler_part_t part,
+                                    isrProfiler_ticks_t ticks) {
+  isrProfiler_stats_t *partStats = &stats[part];
+  partStats->count++;
+  partStats->totalTicks += ticks;
+  if (ticks < partStats->minTicks)
+    partStats->minTicks = ticks;
+  if (ticks > partStats->maxTicks)
+    partStats->maxTicks = ticks;
+  // The bucket is the number of significant bits in ticks.
+  uint16_t bucket = ticks == 0 ? 0 : BITS_PER_TICK_COUNT - __builtin_clz(ticks);
+  partStats->histogram[bucket]++;
+}
+
+// Records the time from start until now against part and returns now.
+isrProfiler_ticks_t isrProfiler_record(isrProfiler_part_t part,
+                                       isrProfiler_ticks_t start) {
+  isrProfiler_ticks_t now = isrProfiler_now();
+  isrProfiler_addDuration(part, now - start);
+  return now;
+}
+
+// Returns the number of times part has been recorded.
+uint32_t isrProfiler_getCount(isrProfiler_part_t part) {
+  return stats[part].count;
+}
+
+// Returns the shortest time recorded for part, in microseconds.
+double isrProfiler_getMinMicroseconds(isrProfiler_part_t part) {
+  if (stats[part].count == 0)
+    return 0.0;
+  return stats[part].minTicks / TICKS_PER_MICROSECOND;
+}
+
+// Returns the mean time recorded for part, in microseconds.
+double isrProfiler_getMeanMicroseconds(isrProfiler_part_t part) {
+  if (stats[part].count == 0)
+    return 0.0;
+  return (double)stats[part].totalTicks / stats[part].count /
+         TICKS_PER_MICROSECOND;
+}
+
+// Returns the longest time recorded for part, in microseconds.
+double isrProfiler_getMaxMicroseconds(isrProfiler_part_t part) {
+  return stats[part].maxTicks / TICKS_PER_MICROSECOND;
+}
+
+// Returns the top of the first histogram bucket with at least fraction of the
+// recorded times at or below it.
+double isrProfiler_getPercentileMicroseconds(isrProfiler_part_t part,
+                                             double fraction) {
+  uint32_t needed = (uint32_t)(fraction * stats[part].count + 0.5);
+  uint32_t seen = 0;
+  for (uint16_t bucket = 0; bucket < ISR_PROFILER_HISTOGRAM_BUCKET_COUNT;
+       bucket++) {
+    seen += stats[part].histogram[bucket];
+    if (seen >= needed && seen > 0) {
+      // Largest tick count that lands in this bucket.
+      double topTicks = bucket == 0 ? 0.0 : (double)(1ULL << bucket) - 1;
+      return topTicks / TICKS_PER_MICROSECOND;
+    }
+  }
+  return 0.0;
+}
+
+// Returns a short name for part.
+const char *isrProfiler_getName(isrProfiler_part_t part) {
+  return partNames[part];
+}
+
+// Prints the statistics and histogram for every part to the console.
+void isrProfiler_print() {
+  printf("isr profile (us)   count       min      mean       max     p99   "
+         "p99.9\n");
+  for (uint16_t part = 0; part < ISR_PROFILER_PART_COUNT; part++) {
+    printf("%-14s %9ld %9.3f %9.3f %9.3f %7.3f %7.3f\n", partNames[part],
+           (long)stats[part].count, isrProfiler_getMinMicroseconds(part),
+           isrProfiler_getMeanMicroseconds(part),
+           isrProfiler_getMaxMicroseconds(part),
+           isrProfiler_getPercentileMicroseconds(part, 0.99),
+           isrProfiler_getPercentileMicroseconds(part, 0.999));
+  }
+  printf("histograms, count of times under each bound (us):\n");
+  for (uint16_t part = 0; part < ISR_PROFILER_PART_COUNT; part++) {
+    printf("%-14s", partNames[part]);
+    for (uint16_t bucket = 0; bucket < ISR_PROFILER_HISTOGRAM_BUCKET_COUNT;
+         bucket++) {
+      if (stats[part].histogram[bucket] == 0)
+        continue;
+      double boundTicks = bucket == 0 ? 1.0 : (double)(1ULL << bucket);
+      printf(" <%.3f:%ld", boundTicks / TICKS_PER_MICROSECOND,
+             (long)stats[part].histogram[bucket]);
+    }
+    printf("\n");
+  }
+}
+
+/*******************************************************
+ ****************** Test Routines **********************
+ ******************************************************/
+
+#define TEST_PART ISR_PROFILER_SOUND
+#define TEST_DURATION_COUNT 1000
+#define TEST_SLOW_DURATION_COUNT 10 // The tail: 1% of the durations.
+#define TEST_FAST_TICKS 100 // In bucket 7, 64 to 127.
+#define TEST_FAST_BUCKET 7
+#define TEST_FAST_BUCKET_TOP_TICKS 127
+#define TEST_SLOW_TICKS 5000 // In bucket 13, 4096 to 8191.
+#define TEST_SLOW_BUCKET 13
+#define TEST_SLOW_BUCKET_TOP_TICKS 8191
+#define TEST_EPSILON 1e-9
+
+// Returns true if a and b are the same to within rounding.
+static bool isrProfiler_isClose(double a, double b) {
+  return a - b < TEST_EPSILON && b - a < TEST_EPSILON;
+}
+
+// Feeds known durations into the statistics and checks them.
+bool isrProfiler_runTest() {
+  printf("Running isrProfiler_runTest()\n");
+  isrProfiler_reset();
+  bool success = true;
+  for (uint32_t i = 0; i < TEST_DURATION_COUNT; i++) {
+    isrProfiler_addDuration(TEST_PART, i < TEST_SLOW_DURATION_COUNT
+                                           ? TEST_SLOW_TICKS
+                                           : TEST_FAST_TICKS);
+  }
+  isrProfiler_addDuration(ISR_PROFILER_ADC, 0);
+  double meanTicks = ((double)TEST_SLOW_DURATION_COUNT * TEST_SLOW_TICKS +
+                      (double)(TEST_DURATION_COUNT - TEST_SLOW_DURATION_COUNT) *
+                          TEST_FAST_TICKS) /
+                     TEST_DURATION_COUNT;
+  success &= isrProfiler_getCount(TEST_PART) == TEST_DURATION_COUNT;
+  success &= isrProfiler_isClose(isrProfiler_getMinMicroseconds(TEST_PART),
+                                 TEST_FAST_TICKS / TICKS_PER_MICROSECOND);
+  success &= isrProfiler_isClose(isrProfiler_getMaxMicroseconds(TEST_PART),
+                                 TEST_SLOW_TICKS / TICKS_PER_MICROSECOND);
+  success &= isrProfiler_isClose(isrProfiler_getMeanMicroseconds(TEST_PART),
+                                 meanTicks / TICKS_PER_MICROSECOND);
+  // 99% of the durations are fast, anything past that reaches into the tail.
+  success &= isrProfiler_isClose(
+      isrProfiler_getPercentileMicroseconds(TEST_PART, 0.99),
+      TEST_FAST_BUCKET_TOP_TICKS / TICKS_PER_MICROSECOND);
+  success &= isrProfiler_isClose(
+      isrProfiler_getPercentileMicroseconds(TEST_PART, 0.999),
+      TEST_SLOW_BUCKET_TOP_TICKS / TICKS_PER_MICROSECOND);
+  success &= stats[TEST_PART].histogram[TEST_FAST_BUCKET] ==
+             TEST_DURATION_COUNT - TEST_SLOW_DURATION_COUNT;
+  success &=
+      stats[TEST_PART].histogram[TEST_SLOW_BUCKET] == TEST_SLOW_DURATION_COUNT;
+  // A zero duration goes in bucket 0 and has a zero percentile.
+  success &= stats[ISR_PROFILER_ADC].histogram[0] == 1;
+  success &= isrProfiler_getPercentileMicroseconds(ISR_PROFILER_ADC, 1.0) == 0;
+  // Nothing recorded at all.
+  success &= isrProfiler_getMeanMicroseconds(ISR_PROFILER_TRIGGER) == 0;
+  // Timing real code must give a count and a sane duration.
+  isrProfiler_ticks_t start = isrProfiler_now();
+  isrProfiler_record(ISR_PROFILER_TRIGGER, start);
+  success &= isrProfiler_getCount(ISR_PROFILER_TRIGGER) == 1;
+  isrProfiler_reset();
+  printf("isrProfiler_runTest %s.\n", success ? "passed" : "failed");
+  return success;
+}
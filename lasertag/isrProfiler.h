@@ -0,0 +1,104 @@
+/*
+This software is provided for student assignment use in the Department of
+Electrical and Computer Engineering, Brigham Young University, Utah, USA.
+Users agree to not re-host, or redistribute the software, in source or binary
+form, to other persons or other institutions. Users may modify and use the
+source code for personal or educational use.
+For questions, contact Brad Hutchings or Jeff Goeders, https://ece.byu.edu/
+*/
+
+#ifndef ISRPROFILER_H_
+#define ISRPROFILER_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Times each part of isr_function() on every interrupt, so the part that is
+// eating the 10 us budget can be found. The worst case is what matters: one
+// ISR that runs past the next interrupt can cost an ADC sample. So each part
+// keeps its min, max and mean, plus a log2 histogram for the tail.
+//
+// Times are in ticks of isrProfiler_now(): CPU cycles from the Cortex-A9
+// cycle counter on the board, nanoseconds from clock_gettime() on the
+// emulator. Both wrap at 2^32, which is fine for measuring anything shorter
+// than a few seconds.
+
+// Uncomment this to have isr_function() time its parts. Profiling costs
+// seven timer reads and updates per interrupt, so leave it off in real
+// games. Without it isr_function() records nothing and the run-time
+// statistics leave the ISR parts out.
+//#define ISR_PROFILER_ENABLED
+
+typedef uint32_t isrProfiler_ticks_t;
+
+// The parts of isr_function() that are timed.
+typedef enum {
+  ISR_PROFILER_ADC, // Reading the ADC and buffering/streaming the value.
+  ISR_PROFILER_TRANSMITTER,
+  ISR_PROFILER_TRIGGER,
+  ISR_PROFILER_HIT_LED_TIMER,
+  ISR_PROFILER_LOCKOUT_TIMER,
+  ISR_PROFILER_SOUND,
+  ISR_PROFILER_ISR, // All of isr_function().
+  ISR_PROFILER_PART_COUNT
+} isrProfiler_part_t;
+
+// Bucket 0 counts durations of 0 ticks, bucket b > 0 counts durations from
+// 2^(b-1) to 2^b - 1 ticks.
+#define ISR_PROFILER_HISTOGRAM_BUCKET_COUNT 33
+
+// Starts the cycle counter (on the board) and clears all statistics.
+void isrProfiler_init();
+
+// Clears all statistics. Don't call while interrupts are enabled.
+void isrProfiler_reset();
+
+// Returns the current time in ticks.
+isrProfiler_ticks_t isrProfiler_now();
+
+// Records the time from start until now against part and returns now, so the
+// next part can be timed from it:
+//   isrProfiler_ticks_t time = isrProfiler_now();
+//   transmitter_tick();
+//   time = isrProfiler_record(ISR_PROFILER_TRANSMITTER, time);
+isrProfiler_ticks_t isrProfiler_record(isrProfiler_part_t part,
+                                       isrProfiler_ticks_t start);
+
+// What isr_function() calls. These are isrProfiler_now() and
+// isrProfiler_record() if ISR_PROFILER_ENABLED is defined and compile to
+// nothing otherwise.
+#ifdef ISR_PROFILER_ENABLED
+#define ISR_PROFILER_NOW() isrProfiler_now()
+#define ISR_PROFILER_RECORD(part, start) isrProfiler_record(part, start)
+#else
+#define ISR_PROFILER_NOW() ((isrProfiler_ticks_t)0)
+#define ISR_PROFILER_RECORD(part, start) ((void)(start), (isrProfiler_ticks_t)0)
+#endif
+
+// Returns the number of times part has been recorded.
+uint32_t isrProfiler_getCount(isrProfiler_part_t part);
+
+// Return the shortest, mean and longest time recorded for part, in
+// microseconds. All are 0 if nothing has been recorded.
+double isrProfiler_getMinMicroseconds(isrProfiler_part_t part);
+double isrProfiler_getMeanMicroseconds(isrProfiler_part_t part);
+double isrProfiler_getMaxMicroseconds(isrProfiler_part_t part);
+
+// Returns a time, in microseconds, that at least fraction (e.g. 0.999) of the
+// recorded times for part are under. Comes from the histogram, so it is the
+// top of a power-of-two bucket and is never more than twice the real value.
+double isrProfiler_getPercentileMicroseconds(isrProfiler_part_t part,
+                                             double fraction);
+
+// Returns a short name for part.
+const char *isrProfiler_getName(isrProfiler_part_t part);
+
+// Prints the statistics and histogram for every part to the console.
+void isrProfiler_print();
+
+// Feeds known durations into the statistics and checks min, max, mean, the
+// histogram and the percentiles. Clears all statistics when done. Returns true
+// if everything matches.
+bool isrProfiler_runTest();
+
+#endif /* ISRPROFILER_H_ */
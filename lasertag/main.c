@@ -19,21 +19,51 @@ For questions, contact Brad Hutchings or Jeff Goeders, https://ece.byu.edu/
 // Uncomment to run two-player mode, Milestone 5
 // #define RUNNING_MODE_M5
 
+// Uncomment to stream raw ADC values, see runningModes_streamRawAdcValues().
+// #define RUNNING_MODE_STREAM
+
+// Uncomment to replay RUNNING_MODE_REPLAY_FILE through every detector engine,
+// with both hit tests.
+// If RUNNING_MODE_STREAM_FILE exists (a stream saved from the UART or from
+// RUNNING_MODE_STREAM on the emulator) it is converted to the capture first.
+// If RUNNING_MODE_REPLAY_SHOT_FILE exists the hits are scored against the
+// shots listed in it (see adcReplay.h).
+// Emulator only, the board has no file system.
+// #define RUNNING_MODE_REPLAY
+#define RUNNING_MODE_REPLAY_FILE "capture.adc"
+#define RUNNING_MODE_REPLAY_SHOT_FILE "capture.shots"
+
+// Uncomment to decode the event journal in RUNNING_MODE_JOURNAL_FILE to text
+// in RUNNING_MODE_JOURNAL_TEXT_FILE (see eventJournal_decode()). The journal
+// can come from shooter mode on the emulator or be the UART output of the
+// board saved to a file, the text between frames is skipped.
+// Emulator only, the board has no file system.
+// #define RUNNING_MODE_JOURNAL
+#define RUNNING_MODE_JOURNAL_TEXT_FILE "game.txt"
+
 #include <assert.h>
 #include <stdio.h>
 
+#include "adcCapture.h"
+#include "adcReplay.h"
+#include "adcStream.h"
 #include "buttons.h"
 #include "detector.h"
+#include "eventJournal.h"
+#include "hitThreshold.h"
 #include "filter.h"
 #include "filterTest.h"
 #include "hitLedTimer.h"
 #include "interrupts.h"
 #include "isr.h"
+#include "isrProfiler.h"
 #include "leds.h"
 #include "lockoutTimer.h"
 #include "mio.h"
 #include "runningModes.h"
 #include "sound.h"
+#include "soundMixer.h"
+#include "sounds/adpcm.h"
 #include "switches.h"
 #include "transmitter.h"
 #include "trigger.h"
@@ -50,7 +80,14 @@ int main() {
   // filterTest_runTest(); // M3 T1
   // transmitter_runTest(); // M3 T2
   // detector_runTest(); // M3 T3
+  // hitThreshold_runTest();
   // sound_runTest(); // M4
+  // adcCapture_runTest(); // Emulator only.
+  // adcStream_runTest(); // Emulator only.
+  // eventJournal_runTest(); // Emulator only.
+  // isrProfiler_runTest();
+  // adpcm_runTest();
+  // soundMixer_runTest();
 #endif
 
 #ifdef RUNNING_MODE_M3_T2
@@ -91,5 +128,50 @@ int main() {
   runningModes_twoTeams();
 #endif
 
+#ifdef RUNNING_MODE_STREAM
+  runningModes_streamRawAdcValues();
+#endif
+
+#ifdef RUNNING_MODE_REPLAY
+  FILE *stream = fopen(RUNNING_MODE_STREAM_FILE, "rb");
+  if (stream != NULL) {
+    FILE *capture = fopen(RUNNING_MODE_REPLAY_FILE, "wb");
+    if (capture != NULL) {
+      adcStream_convertToCapture(stream, capture);
+      fclose(capture);
+    }
+    fclose(stream);
+  }
+  detector_hitTest_t hitTests[] = {DETECTOR_HIT_TEST_MEDIAN,
+                                   DETECTOR_HIT_TEST_ADAPTIVE};
+  const char *hitTestNames[] = {"median", "adaptive"};
+  for (uint16_t i = 0; i < sizeof(hitTests) / sizeof(hitTests[0]); i++) {
+    printf("Hit test: %s.\n", hitTestNames[i]);
+    detector_setHitTest(hitTests[i]);
+    adcReplay_runScored(RUNNING_MODE_REPLAY_FILE, RUNNING_MODE_REPLAY_SHOT_FILE,
+                        DETECTOR_ENGINE_IIR, NULL);
+    adcReplay_runScored(RUNNING_MODE_REPLAY_FILE, RUNNING_MODE_REPLAY_SHOT_FILE,
+                        DETECTOR_ENGINE_SLIDING_DFT, NULL);
+    adcReplay_runScored(RUNNING_MODE_REPLAY_FILE, RUNNING_MODE_REPLAY_SHOT_FILE,
+                        DETECTOR_ENGINE_IIR_BLOCK, NULL);
+  }
+#endif
+
+#ifdef RUNNING_MODE_JOURNAL
+  FILE *journal = fopen(RUNNING_MODE_JOURNAL_FILE, "rb");
+  if (journal != NULL) {
+    FILE *text = fopen(RUNNING_MODE_JOURNAL_TEXT_FILE, "w");
+    if (text != NULL) {
+      eventJournal_decode(journal, text);
+      fclose(text);
+    } else {
+      printf("main: could not open %s.\n", RUNNING_MODE_JOURNAL_TEXT_FILE);
+    }
+    fclose(journal);
+  } else {
+    printf("main: could not open %s.\n", RUNNING_MODE_JOURNAL_FILE);
+  }
+#endif
+
   return 0;
 }
@@ -0,0 +1,32 @@
+/*
+This software is provided for student assignment use in the Department of
+Electrical and Computer Engineering, Brigham Young University, Utah, USA.
+Users agree to not re-host, or redistribute the software, in source or binary
+form, to other persons or other institutions. Users may modify and use the
+source code for personal or educational use.
+For questions, contact Brad Hutchings or Jeff Goeders, https://ece.byu.edu/
+*/
+
+
+#include <string.h>
+
+#include "mirroredBuffer.h"
+
+// Copies the elementSize bytes at value over the oldest element of buffer, in
+// both copies, and advances *index to the new oldest element.
+void mirroredBuffer_push(void *buffer, uint32_t *index, uint32_t count,
+                         const void *value, size_t elementSize) {
+  uint8_t *bytes = buffer;
+  memcpy(&bytes[*index * elementSize], value, elementSize);
+  memcpy(&bytes[(*index + count) * elementSize], value, elementSize);
+  if (++(*index) == count)
+    *index = 0;
+}
+
+// Returns a pointer to the newest element of buffer. The older elements are
+// just below it, down to the oldest one at newest[-(count - 1)].
+void *mirroredBuffer_getNewest(void *buffer, uint32_t index, uint32_t count,
+                               size_t elementSize) {
+  // The newest element is just below index, in the mirror.
+  return &((uint8_t *)buffer)[(index + count - 1) * elementSize];
+}
@@ -0,0 +1,38 @@
+/*
+This software is provided for student assignment use in the Department of
+Electrical and Computer Engineering, Brigham Young University, Utah, USA.
+Users agree to not re-host, or redistribute the software, in source or binary
+form, to other persons or other institutions. Users may modify and use the
+source code for personal or educational use.
+For questions, contact Brad Hutchings or Jeff Goeders, https://ece.byu.edu/
+*/
+
+
+#ifndef MIRROREDBUFFER_H_
+#define MIRROREDBUFFER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+// A mirrored buffer holds the last count elements of a stream twice,
+// back-to-back, in an array of MIRRORED_BUFFER_COPY_COUNT * count elements.
+// index is the oldest element (the next one to be overwritten), so the newest
+// count elements are always elements index to index + count - 1, oldest first,
+// and filter loops can walk them with a pointer and no wrap-around arithmetic.
+// The filters store doubles, floats, fixed-point values and rows of them, so
+// the element size is passed in.
+
+// Size arrays as MIRRORED_BUFFER_COPY_COUNT times the largest count.
+#define MIRRORED_BUFFER_COPY_COUNT 2
+
+// Copies the elementSize bytes at value over the oldest element of buffer, in
+// both copies, and advances *index to the new oldest element.
+void mirroredBuffer_push(void *buffer, uint32_t *index, uint32_t count,
+                         const void *value, size_t elementSize);
+
+// Returns a pointer to the newest element of buffer. The older elements are
+// just below it, down to the oldest one at newest[-(count - 1)].
+void *mirroredBuffer_getNewest(void *buffer, uint32_t index, uint32_t count,
+                               size_t elementSize);
+
+#endif /* MIRROREDBUFFER_H_ */
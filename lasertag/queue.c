@@ -0,0 +1,131 @@
+/*
+This software is provided for student assignment use in the Department of
+Electrical and Computer Engineering, Brigham Young University, Utah, USA.
+Users agree to not re-host, or redistribute the software, in source or binary
+form, to other persons or other institutions. Users may modify and use the
+source code for personal or educational use.
+For questions, contact Brad Hutchings or Jeff Goeders, https://ece.byu.edu/
+*/
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "queue.h"
+
+// Allocates memory for the queue (the data* pointer) and initializes all
+// parts of the data structure. Prints out an error message if malloc() fails
+// and calls assert(false) to print-out line-number information and die.
+void queue_init(queue_t *q, queue_size_t size, const char *name) {
+  // One extra slot so that full and empty can be told apart.
+  q->size = size + 1;
+  q->indexIn = 0;
+  q->indexOut = 0;
+  q->elementCount = 0;
+  q->underflowFlag = false;
+  q->overflowFlag = false;
+  q->data = (queue_data_t *)malloc(q->size * sizeof(queue_data_t));
+  if (q->data == NULL) {
+    printf("queue_init(): malloc() failed for queue: %s\n", name);
+    assert(false);
+  }
+  strncpy(q->name, name, QUEUE_MAX_NAME_SIZE - 1);
+  q->name[QUEUE_MAX_NAME_SIZE - 1] = '\0';
+}
+
+// Get the user-assigned name for the queue.
+const char *queue_name(queue_t *q) { return q->name; }
+
+// Returns the capacity of the queue.
+queue_size_t queue_size(queue_t *q) { return q->size - 1; }
+
+// Returns true if the queue is full.
+bool queue_full(queue_t *q) { return q->elementCount == q->size - 1; }
+
+// Returns true if the queue is empty.
+bool queue_empty(queue_t *q) { return q->elementCount == 0; }
+
+// If the queue is not full, pushes a new element into the queue and clears the
+// underflowFlag. IF the queue is full, set the overflowFlag, print an error
+// message and DO NOT change the queue.
+void queue_push(queue_t *q, queue_data_t value) {
+  if (queue_full(q)) {
+    q->overflowFlag = true;
+    printf("queue_push(): queue %s is full.\n", q->name);
+    return;
+  }
+  q->data[q->indexIn] = value;
+  if (++q->indexIn == q->size)
+    q->indexIn = 0;
+  q->elementCount++;
+  q->underflowFlag = false;
+}
+
+// If the queue is not empty, remove and return the oldest element in the queue.
+// If the queue is empty, set the underflowFlag, print an error message, and DO
+// NOT change the queue.
+queue_data_t queue_pop(queue_t *q) {
+  if (queue_empty(q)) {
+    q->underflowFlag = true;
+    printf("queue_pop(): queue %s is empty.\n", q->name);
+    return QUEUE_RETURN_ERROR_VALUE;
+  }
+  queue_data_t value = q->data[q->indexOut];
+  if (++q->indexOut == q->size)
+    q->indexOut = 0;
+  q->elementCount--;
+  q->overflowFlag = false;
+  return value;
+}
+
+// If the queue is full, call queue_pop() and then call queue_push().
+// If the queue is not full, just call queue_push().
+void queue_overwritePush(queue_t *q, queue_data_t value) {
+  if (queue_full(q))
+    queue_pop(q);
+  queue_push(q, value);
+}
+
+// Provides random-access read capability to the queue.
+// Low-valued indexes access older queue elements while higher-value indexes
+// access newer elements (according to the order that they were added). Print a
+// meaningful error message if an error condition is detected.
+queue_data_t queue_readElementAt(queue_t *q, queue_index_t index) {
+  if (index >= q->elementCount) {
+    printf("queue_readElementAt(): index %u is out of range for queue %s "
+           "(element count: %u).\n",
+           index, q->name, q->elementCount);
+    return QUEUE_RETURN_ERROR_VALUE;
+  }
+  queue_index_t dataIndex = q->indexOut + index;
+  if (dataIndex >= q->size)
+    dataIndex -= q->size;
+  return q->data[dataIndex];
+}
+
+// Returns a count of the elements currently contained in the queue.
+queue_size_t queue_elementCount(queue_t *q) { return q->elementCount; }
+
+// Returns true if an underflow has occurred (queue_pop() called on an empty
+// queue).
+bool queue_underflow(queue_t *q) { return q->underflowFlag; }
+
+// Returns true if an overflow has occurred (queue_push() called on a full
+// queue).
+bool queue_overflow(queue_t *q) { return q->overflowFlag; }
+
+// Frees the storage that you malloc'd before.
+void queue_garbageCollect(queue_t *q) {
+  free(q->data);
+  q->data = NULL;
+}
+
+// Prints the current contents of the queue. Handy for debugging.
+// This must print out the contents of the queue in the order of oldest element
+// first to newest element last.
+void queue_print(queue_t *q) {
+  printf("queue %s:\n", q->name);
+  for (queue_index_t i = 0; i < q->elementCount; i++)
+    printf("%lf\n", queue_readElementAt(q, i));
+}
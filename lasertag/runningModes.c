@@ -13,15 +13,18 @@ For questions, contact Brad Hutchings or Jeff Goeders, https://ece.byu.edu/
 #include <stdlib.h>
 #include <string.h>
 
+#include "adcStream.h"
 #include "buttons.h"
 #include "detector.h"
 #include "display.h"
+#include "eventJournal.h"
 #include "filter.h"
 #include "histogram.h"
 #include "hitLedTimer.h"
 #include "interrupts.h"
 #include "intervalTimer.h"
 #include "isr.h"
+#include "isrProfiler.h"
 #include "lockoutTimer.h"
 #include "runningModes.h"
 #include "switches.h"
@@ -47,12 +50,21 @@ For questions, contact Brad Hutchings or Jeff Goeders, https://ece.byu.edu/
 
 #define ISR_CUMULATIVE_TIMER INTERVAL_TIMER_TIMER_0 // Used by the ISR.
 #define TOTAL_RUNTIME_TIMER INTERVAL_TIMER_1 // Used to compute total run-time.
+// Interval timer 2 generates the transmitter's square wave when
+// TRANSMITTER_USE_TIMER_PWM is defined, then run-time in main isn't measured.
+#ifndef TRANSMITTER_USE_TIMER_PWM
 #define MAIN_CUMULATIVE_TIMER                                                  \
   INTERVAL_TIMER_2 // Used to compute cumulative run-time in main.
+#endif
 
 #define SYSTEM_TICKS_PER_HISTOGRAM_UPDATE                                      \
   30000 // Update the histogram about 3 times per second.
 
+// Most pixels one histogram update may write in continuous mode, about a
+// third of the screen, so drawing never keeps the detector away from the ADC
+// buffer for long. The rest is drawn on the next passes of the loop.
+#define RUNNING_MODE_HISTOGRAM_PIXEL_BUDGET 25000
+
 #define RUNNING_MODE_WARNING_TEXT_SIZE 2 // Upsize the text for visibility.
 #define RUNNING_MODE_WARNING_TEXT_COLOR DISPLAY_RED // Red for more visibility.
 #define RUNNING_MODE_NORMAL_TEXT_SIZE 1 // Normal size for reporting.
@@ -66,6 +78,10 @@ For questions, contact Brad Hutchings or Jeff Goeders, https://ece.byu.edu/
 // good performance.
 #define SUGGESTED_REMAINING_ELEMENT_COUNT 500
 
+// runningModes_streamRawAdcValues() records this much at 100 kHz. The
+// default stream ring holds all of it, so nothing is dropped over the UART.
+#define RUNNING_MODE_STREAM_SECONDS 5
+
 // Defined to make things more readable.
 #define INTERRUPTS_CURRENTLY_ENABLED true
 #define INTERRUPTS_CURRENTLY_DISABLE false
@@ -84,8 +100,10 @@ uint32_t detectorInvocationCount = 0;
 // interval_timer(0) is the cumulative run-time of the ISR,
 // interval_timer(1) is the total run-time,
 // interval_timer(2) is the time spent in main running the filters, updating the
-// display, and so forth. No comments in the code, the print statements are
-// self-explanatory.
+// display, and so forth. If ISR_PROFILER_ENABLED, also shows the worst-case
+// and mean time of each part of isr_function() from isrProfiler, and prints
+// its histograms to the console. No comments in the code, the print statements
+// are self-explanatory.
 void runningModes_printRunTimeStatistics() {
   char sprintfBuffer[MAX_BUFFER_SIZE]; // Generic message buffer.
   // Setup the screen.
@@ -122,6 +140,7 @@ void runningModes_printRunTimeStatistics() {
   display_print(sprintfBuffer);
   display_println("%)");
   display_printChar('\n');
+#ifdef MAIN_CUMULATIVE_TIMER
   mainLoopRunningSeconds =
       intervalTimer_getTotalDurationInSeconds(MAIN_CUMULATIVE_TIMER);
   // Print out cumulative spent in detector.
@@ -134,10 +153,23 @@ void runningModes_printRunTimeStatistics() {
   display_print(sprintfBuffer);
   display_println("%)");
   display_printChar('\n');
+#endif
   uint32_t interruptCount = interrupts_isrInvocationCount();
   // Print out total interrupt count.
   display_print("Total interrupts:            ");
   display_printlnDecimalInt(interruptCount);
+#ifdef ISR_PROFILER_ENABLED
+  // Worst case and mean time for each part of the ISR, the worst case is what
+  // decides whether ADC samples get dropped. The histograms go to the console.
+  display_println("ISR part      max us  mean us");
+  for (uint16_t part = 0; part < ISR_PROFILER_PART_COUNT; part++) {
+    sprintf(sprintfBuffer, "%-12s %7.2f %8.3f", isrProfiler_getName(part),
+            isrProfiler_getMaxMicroseconds(part),
+            isrProfiler_getMeanMicroseconds(part));
+    display_println(sprintfBuffer);
+  }
+  isrProfiler_print();
+#endif
   display_printChar('\n');
   display_print("Detector invocation count: ");
   // Print out detector invocations per second.
@@ -167,6 +199,7 @@ void runningModes_printRunTimeStatistics() {
     display_printDecimalInt(SUGGESTED_REMAINING_ELEMENT_COUNT);
     display_println(" elements.");
   }
+  display_flush();
 }
 
 // Group all of the inits together to reduce visual clutter.
@@ -177,6 +210,7 @@ void runningModes_initAll() {
   filter_init();
   isr_init(); // includes: transmitter, trigger, hitLedTimer, lockoutTimer, &
               // sound init
+  eventJournal_init();
 }
 
 // Returns the current switch-setting
@@ -195,6 +229,7 @@ uint16_t runningModes_getFrequencySetting() {
 // channel on the TFT. Transmit frequency is selected via the slide-switches.
 void runningModes_continuous() {
   runningModes_initAll(); // All necessary inits are called here.
+  histogram_setUpdatePixelBudget(RUNNING_MODE_HISTOGRAM_PIXEL_BUDGET);
   bool ignoredFrequenciesArray[FILTER_FREQUENCY_COUNT];
   // setup the ignore frequencies array so you don't ignore any frequency.
   for (uint16_t i = 0; i < FILTER_FREQUENCY_COUNT; i++)
@@ -219,8 +254,10 @@ void runningModes_continuous() {
       ISR_CUMULATIVE_TIMER); // Used to measure ISR execution time.
   intervalTimer_reset(
       TOTAL_RUNTIME_TIMER); // Used to measure total program execution time.
+#ifdef MAIN_CUMULATIVE_TIMER
   intervalTimer_reset(
       MAIN_CUMULATIVE_TIMER); // Used to measure main-loop execution time.
+#endif
   intervalTimer_start(
       TOTAL_RUNTIME_TIMER);            // Start measuring total execution time.
   transmitter_setContinuousMode(true); // Run the transmitter continuously.
@@ -235,20 +272,26 @@ void runningModes_continuous() {
     histogramSystemTicks++;    // Keep track of ticks so you know when to update
                                // the histogram.
     // Run filters, compute power, etc.
+#ifdef MAIN_CUMULATIVE_TIMER
     intervalTimer_start(MAIN_CUMULATIVE_TIMER); // Measure run-time when you are
                                                 // doing something.
+#endif
     detector(INTERRUPTS_CURRENTLY_ENABLED); // Interrupts are currently enabled.
+#ifdef MAIN_CUMULATIVE_TIMER
     intervalTimer_stop(MAIN_CUMULATIVE_TIMER);
+#endif
     // If enough ticks have transpired, update the histogram.
     if (histogramSystemTicks >= SYSTEM_TICKS_PER_HISTOGRAM_UPDATE) {
       double powerValues[FILTER_FREQUENCY_COUNT]; // Copy the current power
                                                   // values to here.
-      filter_getCurrentPowerValues(
+      detector_getCurrentPowerValues(
           powerValues); // Copy the current power values.
       histogram_plotUserFrequencyPower(
           powerValues); // Plot the power values on the TFT.
       histogramSystemTicks =
           0; // Reset the tick count and wait for the next update time.
+    } else if (histogram_updatePending()) {
+      histogram_updateDisplay(); // Bars left over from the last update.
     }
   }
   interrupts_disableArmInts();           // Stop interrupts.
@@ -260,8 +303,20 @@ void runningModes_continuous() {
 // Game-playing mode. Each shot is registered on the histogram on the TFT.
 // Press BTN0 or the gun-trigger to shoot.
 // Transmit frequency is selected via the slide-switches.
+// Every hit and shot is written to the event journal, to the UART on the board
+// or to RUNNING_MODE_JOURNAL_FILE on the emulator.
 void runningModes_shooter() {
   runningModes_initAll();
+#ifdef ZYBO_BOARD
+  FILE *journalFile = NULL; // eventJournal_flush() writes straight to the UART.
+#else
+  FILE *journalFile = fopen(RUNNING_MODE_JOURNAL_FILE, "wb");
+  if (journalFile == NULL) {
+    printf("runningModes_shooter: could not open %s.\n",
+           RUNNING_MODE_JOURNAL_FILE);
+    return;
+  }
+#endif
   // Init the ignored-frequencies so no frequencies are ignored.
   bool ignoredFrequencies[FILTER_FREQUENCY_COUNT];
   for (uint16_t i = 0; i < FILTER_FREQUENCY_COUNT; i++)
@@ -285,8 +340,10 @@ void runningModes_shooter() {
       ISR_CUMULATIVE_TIMER); // Used to measure ISR execution time.
   intervalTimer_reset(
       TOTAL_RUNTIME_TIMER); // Used to measure total program execution time.
+#ifdef MAIN_CUMULATIVE_TIMER
   intervalTimer_reset(
       MAIN_CUMULATIVE_TIMER); // Used to measure main-loop execution time.
+#endif
   intervalTimer_start(
       TOTAL_RUNTIME_TIMER);   // Start measuring total execution time.
   interrupts_enableArmInts(); // The ARM will start seeing interrupts after
@@ -298,8 +355,10 @@ void runningModes_shooter() {
     transmitter_setFrequencyNumber(
         runningModes_getFrequencySetting());    // Read the switches and switch
                                                 // frequency as required.
+#ifdef MAIN_CUMULATIVE_TIMER
     intervalTimer_start(MAIN_CUMULATIVE_TIMER); // Measure run-time when you are
                                                 // doing something.
+#endif
     histogramSystemTicks++; // Keep track of ticks so you know when to update
                             // the histogram.
     // Run filters, compute power, run hit-detection.
@@ -313,14 +372,23 @@ void runningModes_shooter() {
       detector_getHitCounts(hitCounts);       // Get the current hit counts.
       histogram_plotUserHits(hitCounts);      // Plot the hit counts on the TFT.
     }
+    eventJournal_flush(journalFile); // Does nothing unless there are events.
+#ifdef MAIN_CUMULATIVE_TIMER
     intervalTimer_stop(
         MAIN_CUMULATIVE_TIMER); // All done with actual processing.
+#endif
   }
   interrupts_disableArmInts(); // Done with loop, disable the interrupts.
   hitLedTimer_turnLedOff();    // Save power :-)
   runningModes_printRunTimeStatistics(); // Print the run-time statistics to the
                                          // TFT.
+  // Anything recorded since the last flush.
+  eventJournal_flush(journalFile);
+#ifndef ZYBO_BOARD
+  fclose(journalFile);
+#endif
   printf("Shooter mode terminated after detecting %d shots.\n", hitCount);
+  printf("%d journal events dropped.\n", eventJournal_getDroppedEventCount());
 }
 
 // This mode simply dumps raw ADC values to the console.
@@ -341,3 +409,37 @@ void runningModes_dumpRawAdcValues() {
     printf("raw ADC value: %d\n", signExtendedValue);
   }
 }
+
+// Streams RUNNING_MODE_STREAM_SECONDS of raw ADC values at the full 100 kHz as
+// adcStream frames, to the UART on the board or to RUNNING_MODE_STREAM_FILE on
+// the emulator. isr_function() packs the samples and this loop writes out
+// whole blocks, so no samples are lost to printf.
+void runningModes_streamRawAdcValues() {
+  runningModes_initAll();
+#ifdef ZYBO_BOARD
+  FILE *file = NULL; // adcStream_flush() writes straight to the UART.
+#else
+  FILE *file = fopen(RUNNING_MODE_STREAM_FILE, "wb");
+  if (file == NULL) {
+    printf("runningModes_streamRawAdcValues: could not open %s.\n",
+           RUNNING_MODE_STREAM_FILE);
+    return;
+  }
+#endif
+  interrupts_initAll(true); // Sets up interrupts and the XADC.
+  adcStream_start(ADC_STREAM_FORMAT_12_BIT, interrupts_getAdcInputMode(),
+                  RUNNING_MODE_STREAM_SECONDS * ADC_CAPTURE_SAMPLE_RATE_HZ);
+  interrupts_enableTimerGlobalInts();
+  interrupts_startArmPrivateTimer();
+  interrupts_enableArmInts();
+  while (adcStream_isRunning())
+    adcStream_flush(file);
+  interrupts_disableArmInts();
+  adcStream_flush(file); // The last block.
+#ifndef ZYBO_BOARD
+  fclose(file);
+#endif
+  // Anything between frames is skipped when the stream is converted.
+  printf("\nStreamed %d seconds, %d blocks dropped.\n",
+         RUNNING_MODE_STREAM_SECONDS, adcStream_getDroppedBlockCount());
+}
@@ -19,6 +19,13 @@ For questions, contact Brad Hutchings or Jeff Goeders, https://ece.byu.edu/
 #define LIVES 3
 #define HITS_PER_LIFE 5
 
+// Where runningModes_streamRawAdcValues() writes on the emulator, and where
+// main.c's replay mode looks for a stream to convert.
+#define RUNNING_MODE_STREAM_FILE "capture.adcs"
+// Where shooter mode's event journal goes on the emulator (the board uses the
+// UART), and what main.c's journal mode decodes.
+#define RUNNING_MODE_JOURNAL_FILE "game.evj"
+
 #include <stdint.h>
 
 // Prints out various run-time statistics on the TFT display.
@@ -27,8 +34,10 @@ For questions, contact Brad Hutchings or Jeff Goeders, https://ece.byu.edu/
 // interval_timer(0) is the cumulative run-time of the ISR,
 // interval_timer(1) is the total run-time,
 // interval_timer(2) is the time spent in main running the filters, updating the
-// display, and so forth. No comments in the code, the print statements are
-// self-explanatory.
+// display, and so forth. If ISR_PROFILER_ENABLED, also shows the worst-case
+// and mean time of each part of isr_function() from isrProfiler, and prints
+// its histograms to the console. No comments in the code, the print statements
+// are self-explanatory.
 void runningModes_printRunTimeStatistics();
 
 // Group all of the inits together to reduce visual clutter.
@@ -68,4 +77,10 @@ void runningModes_creative();
 // Will loop forever. Stop the program with an external reset or Ctl-C.
 void runningModes_dumpRawAdcValues();
 
+// This mode streams a few seconds of raw ADC values at the full 100 kHz, as
+// framed binary blocks (see adcStream.h), to the UART on the board or to a file
+// on the emulator. Use this for captures, runningModes_dumpRawAdcValues() can't
+// keep up with the sample rate.
+void runningModes_streamRawAdcValues();
+
 #endif /* RUNNINGMODES_H_ */
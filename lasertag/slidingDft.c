@@ -0,0 +1,158 @@
+/*
+This software is provided for student assignment use in the Department of
+Electrical and Computer Engineering, Brigham Young University, Utah, USA.
+Users agree to not re-host, or redistribute the software, in source or binary
+form, to other persons or other institutions. Users may modify and use the
+source code for personal or educational use.
+For questions, contact Brad Hutchings or Jeff Goeders, https://ece.byu.edu/
+*/
+
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+
+#include "filter.h"
+#include "slidingDft.h"
+
+// Window length, in decimated samples.
+#define WINDOW_LENGTH FILTER_INPUT_PULSE_WIDTH
+// Longest phasor table, more than enough for filter_frequencyTickTable.
+#define MAX_PHASOR_COUNT 128
+
+// e^(-jwn) for each frequency, one period of it.
+static double phasorCos[FILTER_FREQUENCY_COUNT][MAX_PHASOR_COUNT];
+static double phasorSin[FILTER_FREQUENCY_COUNT][MAX_PHASOR_COUNT];
+static uint16_t phasorCount[FILTER_FREQUENCY_COUNT];
+// Phasor index for the next input, and for the input that leaves the window
+// when it is added.
+static uint16_t newPhasorIndex[FILTER_FREQUENCY_COUNT];
+static uint16_t oldPhasorIndex[FILTER_FREQUENCY_COUNT];
+
+// The inputs currently in the window. windowIndex points to the oldest.
+static double window[WINDOW_LENGTH];
+static uint32_t windowIndex;
+
+// Sum of x[n] * e^(-jwn) over the window, for each frequency.
+static double real[FILTER_FREQUENCY_COUNT];
+static double imaginary[FILTER_FREQUENCY_COUNT];
+// Sums of the terms added since shadowCount was last 0. After WINDOW_LENGTH
+// inputs they cover exactly the window and replace the running sums.
+static double shadowReal[FILTER_FREQUENCY_COUNT];
+static double shadowImaginary[FILTER_FREQUENCY_COUNT];
+static uint32_t shadowCount;
+
+// Greatest common divisor, used to find the period of each phasor.
+static uint16_t greatestCommonDivisor(uint16_t a, uint16_t b) {
+  while (b != 0) {
+    uint16_t remainder = a % b;
+    a = b;
+    b = remainder;
+  }
+  return a;
+}
+
+// Must call this prior to using any other slidingDft functions. Builds the
+// phasor tables and zeroes the window.
+void slidingDft_init() {
+  for (uint16_t i = 0; i < FILTER_FREQUENCY_COUNT; i++) {
+    // Frequency i is one period every filter_frequencyTickTable[i] ticks at
+    // 100 kHz, so after decimation w = 2*pi*decimation/tickCount. That
+    // repeats after tickCount/gcd(tickCount, decimation) samples.
+    uint16_t tickCount = filter_frequencyTickTable[i];
+    uint16_t count =
+        tickCount /
+        greatestCommonDivisor(tickCount, FILTER_FIR_DECIMATION_FACTOR);
+    if (count > MAX_PHASOR_COUNT) {
+      printf("slidingDft_init(): phasor table for frequency %d is too long "
+             "(%d).\n",
+             i, count);
+      assert(false);
+    }
+    phasorCount[i] = count;
+    for (uint16_t n = 0; n < count; n++) {
+      double angle =
+          2.0 * M_PI * FILTER_FIR_DECIMATION_FACTOR * n / (double)tickCount;
+      phasorCos[i][n] = cos(angle);
+      phasorSin[i][n] = sin(angle);
+    }
+    // The input that leaves the window is WINDOW_LENGTH samples older than
+    // the one that is added.
+    newPhasorIndex[i] = 0;
+    oldPhasorIndex[i] = (count - (WINDOW_LENGTH % count)) % count;
+    real[i] = 0.0;
+    imaginary[i] = 0.0;
+    shadowReal[i] = 0.0;
+    shadowImaginary[i] = 0.0;
+  }
+  for (uint32_t i = 0; i < WINDOW_LENGTH; i++)
+    window[i] = 0.0;
+  windowIndex = 0;
+  shadowCount = 0;
+}
+
+// Adds a new (decimated) input to every bin and removes the oldest one.
+void slidingDft_addNewInput(double x) {
+  double old = window[windowIndex];
+  window[windowIndex] = x;
+  if (++windowIndex == WINDOW_LENGTH)
+    windowIndex = 0;
+  for (uint16_t i = 0; i < FILTER_FREQUENCY_COUNT; i++) {
+    uint16_t newIndex = newPhasorIndex[i];
+    uint16_t oldIndex = oldPhasorIndex[i];
+    double newReal = x * phasorCos[i][newIndex];
+    double newImaginary = x * phasorSin[i][newIndex];
+    real[i] += newReal - old * phasorCos[i][oldIndex];
+    imaginary[i] -= newImaginary - old * phasorSin[i][oldIndex];
+    shadowReal[i] += newReal;
+    shadowImaginary[i] -= newImaginary;
+    if (++newIndex == phasorCount[i])
+      newIndex = 0;
+    if (++oldIndex == phasorCount[i])
+      oldIndex = 0;
+    newPhasorIndex[i] = newIndex;
+    oldPhasorIndex[i] = oldIndex;
+  }
+  if (++shadowCount < WINDOW_LENGTH)
+    return;
+  // The shadow sums now cover exactly the inputs in the window, so they
+  // replace the running sums and any drift they have picked up.
+  for (uint16_t i = 0; i < FILTER_FREQUENCY_COUNT; i++) {
+    real[i] = shadowReal[i];
+    imaginary[i] = shadowImaginary[i];
+    shadowReal[i] = 0.0;
+    shadowImaginary[i] = 0.0;
+  }
+  shadowCount = 0;
+}
+
+// Recomputes every bin from the inputs in the window. A full pass over the
+// window, only needed to check the running sums.
+void slidingDft_recomputeFromScratch() {
+  for (uint16_t i = 0; i < FILTER_FREQUENCY_COUNT; i++) {
+    // The oldest input in the window is the next one to leave, so it goes
+    // with oldPhasorIndex.
+    uint16_t phasorIndex = oldPhasorIndex[i];
+    double sumReal = 0.0;
+    double sumImaginary = 0.0;
+    for (uint32_t n = 0; n < WINDOW_LENGTH; n++) {
+      uint32_t index = windowIndex + n;
+      if (index >= WINDOW_LENGTH)
+        index -= WINDOW_LENGTH;
+      sumReal += window[index] * phasorCos[i][phasorIndex];
+      sumImaginary -= window[index] * phasorSin[i][phasorIndex];
+      if (++phasorIndex == phasorCount[i])
+        phasorIndex = 0;
+    }
+    real[i] = sumReal;
+    imaginary[i] = sumImaginary;
+  }
+}
+
+// Copies the current energy at each player frequency into powerValues.
+// |sum|^2 of a sine-wave of amplitude A over N samples is (A*N/2)^2 while the
+// sum of its squares is A^2*N/2, so scale by 2/N.
+void slidingDft_getCurrentPowerValues(double powerValues[]) {
+  for (uint16_t i = 0; i < FILTER_FREQUENCY_COUNT; i++)
+    powerValues[i] = (2.0 / WINDOW_LENGTH) *
+                     (real[i] * real[i] + imaginary[i] * imaginary[i]);
+}
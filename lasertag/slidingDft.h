@@ -0,0 +1,51 @@
+/*
+This software is provided for student assignment use in the Department of
+Electrical and Computer Engineering, Brigham Young University, Utah, USA.
+Users agree to not re-host, or redistribute the software, in source or binary
+form, to other persons or other institutions. Users may modify and use the
+source code for personal or educational use.
+For questions, contact Brad Hutchings or Jeff Goeders, https://ece.byu.edu/
+*/
+
+#ifndef SLIDINGDFT_H_
+#define SLIDINGDFT_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Alternative to the IIR filters and power computation. The detector only
+// needs the energy at the FILTER_FREQUENCY_COUNT player frequencies over the
+// last FILTER_INPUT_PULSE_WIDTH decimated samples, so this keeps one sliding
+// DFT bin per player frequency instead: each new FIR output is added to every
+// bin and the output that just left the window is taken back out. That is a
+// few multiply-adds per frequency per sample instead of a 10th-order IIR
+// filter plus the power update.
+//
+// The player frequencies are not on exact DFT bins for a
+// FILTER_INPUT_PULSE_WIDTH window, so each bin keeps its sum referenced to
+// absolute time (x[n] * e^(-jwn)) rather than using the usual rotating form.
+// The phasor e^(-jwn) repeats every few samples for every frequency in
+// filter_frequencyTickTable, so it comes from a small exact table and never
+// drifts. The running sums still pick up rounding from adding and then
+// removing each input, so, as in filterPower.h, a second sum of the newest
+// terms is built up from zero and replaces them once per window.
+
+// Must call this prior to using any other slidingDft functions. Builds the
+// phasor tables and zeroes the window.
+void slidingDft_init();
+
+// Adds a new (decimated) input to every bin and removes the oldest one.
+void slidingDft_addNewInput(double x);
+
+// Recomputes every bin from the inputs in the window. This is a full pass
+// over the window; slidingDft_addNewInput() already bounds the drift so the
+// detector loop never needs it.
+void slidingDft_recomputeFromScratch();
+
+// Copies the current energy at each player frequency into powerValues. This
+// follows the filter_getCurrentPowerValues() contract: values are scaled so a
+// sine-wave that fills the window gives the same power as the sum of the
+// squares of its samples, which is what the IIR filter outputs give.
+void slidingDft_getCurrentPowerValues(double powerValues[]);
+
+#endif /* SLIDINGDFT_H_ */
@@ -0,0 +1,303 @@
+/*
+This software is provided for student assignment use in the Department of
+Electrical and Computer Engineering, Brigham Young University, Utah, USA.
+Users agree to not re-host, or redistribute the software, in source or binary
+form, to other persons or other institutions. Users may modify and use the
+source code for personal or educational use.
+For questions, contact Brad Hutchings or Jeff Goeders, https://ece.byu.edu/
+*/
+
+#include <math.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "soundMixer.h"
+#include "sounds/adpcm.h"
+
+#define GAIN_SHIFT 8 // log2(SOUND_MIXER_UNITY_GAIN)
+// Keeps the sum of every voice at full scale from overflowing 32 bits.
+#define MAX_GAIN (4 * SOUND_MIXER_UNITY_GAIN)
+
+typedef struct {
+  bool active;
+  const uint8_t *data; // NULL for silence.
+  adpcm_decoder_t decoder;
+  uint32_t remainingSampleCount;
+  uint16_t gain;
+  uint8_t priority;
+} soundMixer_voice_t;
+
+static soundMixer_voice_t voices[SOUND_MIXER_VOICE_COUNT];
+
+// Stops every voice.
+void soundMixer_init() { soundMixer_stopAll(); }
+
+// Returns the voice to play a sound with priority in, or SOUND_MIXER_NO_VOICE.
+static int8_t soundMixer_chooseVoice(const uint8_t *data, uint8_t priority) {
+  // Restart the sound if it is already playing.
+  for (int8_t voice = 0; voice < SOUND_MIXER_VOICE_COUNT; voice++)
+    if (voices[voice].active && data != NULL && voices[voice].data == data)
+      return voice;
+  int8_t victim = SOUND_MIXER_NO_VOICE;
+  for (int8_t voice = 0; voice < SOUND_MIXER_VOICE_COUNT; voice++) {
+    if (!voices[voice].active)
+      return voice;
+    if (victim == SOUND_MIXER_NO_VOICE ||
+        voices[voice].priority < voices[victim].priority ||
+        (voices[voice].priority == voices[victim].priority &&
+         voices[voice].remainingSampleCount <
+             voices[victim].remainingSampleCount))
+      victim = voice;
+  }
+  return voices[victim].priority <= priority ? victim : SOUND_MIXER_NO_VOICE;
+}
+
+// Starts playing sampleCount samples of data in a free voice, or in one taken
+// from a lower priority sound.
+int8_t soundMixer_play(const uint8_t *data, uint32_t sampleCount,
+                       uint16_t gain, uint8_t priority) {
+  int8_t voice = soundMixer_chooseVoice(data, priority);
+  if (voice == SOUND_MIXER_NO_VOICE)
+    return voice;
+  soundMixer_voice_t *newVoice = &voices[voice];
+  newVoice->data = data;
+  if (data != NULL)
+    adpcm_initDecoder(&newVoice->decoder, data);
+  newVoice->remainingSampleCount = sampleCount;
+  newVoice->gain = gain > MAX_GAIN ? MAX_GAIN : gain;
+  newVoice->priority = priority;
+  newVoice->active = sampleCount > 0;
+  return voice;
+}
+
+// Stops voice.
+void soundMixer_stop(int8_t voice) {
+  if (voice < 0 || voice >= SOUND_MIXER_VOICE_COUNT) {
+    printf("soundMixer_stop: voice %d does not exist.\n", voice);
+    return;
+  }
+  voices[voice].active = false;
+}
+
+// Stops every voice.
+void soundMixer_stopAll() {
+  for (int8_t voice = 0; voice < SOUND_MIXER_VOICE_COUNT; voice++)
+    voices[voice].active = false;
+}
+
+// Returns true if any voice is playing.
+bool soundMixer_isBusy() { return soundMixer_getActiveVoiceCount() > 0; }
+
+// Returns the number of voices playing.
+uint8_t soundMixer_getActiveVoiceCount() {
+  uint8_t count = 0;
+  for (int8_t voice = 0; voice < SOUND_MIXER_VOICE_COUNT; voice++)
+    count += voices[voice].active;
+  return count;
+}
+
+// Mixes the next samples of every voice into samples.
+uint16_t soundMixer_mix(int16_t samples[], uint16_t sampleCount) {
+  static int32_t sums[SOUND_MIXER_BLOCK_SAMPLE_COUNT];
+  if (sampleCount > SOUND_MIXER_BLOCK_SAMPLE_COUNT)
+    sampleCount = SOUND_MIXER_BLOCK_SAMPLE_COUNT;
+  for (uint16_t i = 0; i < sampleCount; i++)
+    sums[i] = 0;
+  uint16_t mixedCount = 0;
+  for (int8_t voice = 0; voice < SOUND_MIXER_VOICE_COUNT; voice++) {
+    soundMixer_voice_t *thisVoice = &voices[voice];
+    if (!thisVoice->active)
+      continue;
+    uint16_t count = thisVoice->remainingSampleCount < sampleCount
+                         ? thisVoice->remainingSampleCount
+                         : sampleCount;
+    if (thisVoice->data != NULL) {
+      int32_t gain = thisVoice->gain;
+      for (uint16_t i = 0; i < count; i++)
+        sums[i] += adpcm_decodeNext(&thisVoice->decoder) * gain;
+    }
+    thisVoice->remainingSampleCount -= count;
+    if (thisVoice->remainingSampleCount == 0)
+      thisVoice->active = false;
+    if (count > mixedCount)
+      mixedCount = count;
+  }
+  // Saturate rather than let loud sounds wrap around.
+  for (uint16_t i = 0; i < mixedCount; i++) {
+    int32_t sample = sums[i] >> GAIN_SHIFT;
+    if (sample > INT16_MAX)
+      sample = INT16_MAX;
+    else if (sample < INT16_MIN)
+      sample = INT16_MIN;
+    samples[i] = sample;
+  }
+  return mixedCount;
+}
+
+/*******************************************************
+ ****************** Test Routines **********************
+ ******************************************************/
+
+#define TEST_SAMPLE_RATE 48000
+#define TEST_SAMPLE_COUNT 48000 // One second per sound.
+#define TEST_SOUND_COUNT 5      // More sounds than voices.
+#define TEST_TONE_HZ 440.0
+#define TEST_AMPLITUDE (INT16_MAX * 0.9) // Two of these saturate.
+#define TEST_HALF_GAIN (SOUND_MIXER_UNITY_GAIN / 2)
+#define TEST_SHORT_SAMPLE_COUNT 100 // A block and a bit.
+#define TEST_LOW_PRIORITY 1
+#define TEST_MEDIUM_PRIORITY 2
+#define TEST_HIGH_PRIORITY 3
+#define TEST_BENCHMARK_REPEAT_COUNT 10
+#define NANOSECONDS_PER_SECOND 1e9
+
+#define TEST_ENCODED_BYTE_COUNT                                                \
+  ((TEST_SAMPLE_COUNT / ADPCM_BLOCK_SAMPLE_COUNT + 1) * ADPCM_BLOCK_BYTE_COUNT)
+
+static uint8_t testSounds[TEST_SOUND_COUNT][TEST_ENCODED_BYTE_COUNT];
+static int16_t testDecoded[TEST_SOUND_COUNT][TEST_SAMPLE_COUNT];
+
+// Encodes a tone per test sound, each a different pitch.
+static void soundMixer_makeTestSounds() {
+  static int16_t samples[TEST_SAMPLE_COUNT];
+  for (uint16_t sound = 0; sound < TEST_SOUND_COUNT; sound++) {
+    for (uint32_t i = 0; i < TEST_SAMPLE_COUNT; i++)
+      samples[i] = TEST_AMPLITUDE * sin(2 * M_PI * TEST_TONE_HZ * (sound + 1) *
+                                        i / TEST_SAMPLE_RATE);
+    adpcm_encode(samples, TEST_SAMPLE_COUNT, testSounds[sound]);
+    adpcm_decode(testSounds[sound], TEST_SAMPLE_COUNT, testDecoded[sound]);
+  }
+}
+
+// Plays the first soundCount test sounds at gain, mixes all of them a block at
+// a time and checks the result against the decoded sounds added up.
+static bool soundMixer_checkMix(uint16_t soundCount, uint16_t gain) {
+  static int16_t mixed[SOUND_MIXER_BLOCK_SAMPLE_COUNT];
+  soundMixer_init();
+  for (uint16_t sound = 0; sound < soundCount; sound++)
+    soundMixer_play(testSounds[sound], TEST_SAMPLE_COUNT, gain,
+                    TEST_LOW_PRIORITY);
+  uint32_t index = 0;
+  uint16_t count;
+  while ((count = soundMixer_mix(mixed, SOUND_MIXER_BLOCK_SAMPLE_COUNT))) {
+    for (uint16_t i = 0; i < count; i++, index++) {
+      int32_t expected = 0;
+      for (uint16_t sound = 0; sound < soundCount; sound++)
+        expected += testDecoded[sound][index] * gain;
+      expected >>= GAIN_SHIFT;
+      expected = expected > INT16_MAX   ? INT16_MAX
+                 : expected < INT16_MIN ? INT16_MIN
+                                        : expected;
+      if (mixed[i] != expected) {
+        printf("soundMixer_runTest: %d sounds, sample %d is %d, expected %d.\n",
+               soundCount, index, mixed[i], expected);
+        return false;
+      }
+    }
+  }
+  if (index != TEST_SAMPLE_COUNT) {
+    printf("soundMixer_runTest: mixed %d samples, expected %d.\n", index,
+           TEST_SAMPLE_COUNT);
+    return false;
+  }
+  return !soundMixer_isBusy();
+}
+
+// Checks that new sounds take the right voices when every voice is busy.
+static bool soundMixer_checkPriorities() {
+  bool success = true;
+  soundMixer_init();
+  // Voices 0 to 3: low, medium, medium with less left, high.
+  soundMixer_play(testSounds[0], TEST_SAMPLE_COUNT, SOUND_MIXER_UNITY_GAIN,
+                  TEST_LOW_PRIORITY);
+  soundMixer_play(testSounds[1], TEST_SAMPLE_COUNT, SOUND_MIXER_UNITY_GAIN,
+                  TEST_MEDIUM_PRIORITY);
+  soundMixer_play(testSounds[2], TEST_SHORT_SAMPLE_COUNT,
+                  SOUND_MIXER_UNITY_GAIN, TEST_MEDIUM_PRIORITY);
+  soundMixer_play(testSounds[3], TEST_SAMPLE_COUNT, SOUND_MIXER_UNITY_GAIN,
+                  TEST_HIGH_PRIORITY);
+  // Nothing is lower than this.
+  success &= soundMixer_play(testSounds[4], TEST_SAMPLE_COUNT,
+                             SOUND_MIXER_UNITY_GAIN,
+                             0) == SOUND_MIXER_NO_VOICE;
+  // Replaces the low priority sound.
+  success &= soundMixer_play(testSounds[4], TEST_SAMPLE_COUNT,
+                             SOUND_MIXER_UNITY_GAIN, TEST_MEDIUM_PRIORITY) == 0;
+  // Replaces the medium priority sound that has the least left.
+  success &= soundMixer_play(testSounds[0], TEST_SAMPLE_COUNT,
+                             SOUND_MIXER_UNITY_GAIN, TEST_MEDIUM_PRIORITY) == 2;
+  // A sound that is playing restarts in its own voice.
+  success &= soundMixer_play(testSounds[3], TEST_SAMPLE_COUNT,
+                             SOUND_MIXER_UNITY_GAIN, TEST_LOW_PRIORITY) == 3;
+  success &= soundMixer_getActiveVoiceCount() == SOUND_MIXER_VOICE_COUNT;
+  soundMixer_stop(1);
+  success &= soundMixer_getActiveVoiceCount() == SOUND_MIXER_VOICE_COUNT - 1;
+  soundMixer_stopAll();
+  success &= !soundMixer_isBusy();
+  if (!success)
+    printf("soundMixer_runTest: voices were not chosen by priority.\n");
+  return success;
+}
+
+// Checks that silence takes a voice for its length and mixes to zeros.
+static bool soundMixer_checkSilence() {
+  static int16_t mixed[SOUND_MIXER_BLOCK_SAMPLE_COUNT];
+  bool success = true;
+  soundMixer_init();
+  soundMixer_play(NULL, TEST_SHORT_SAMPLE_COUNT, SOUND_MIXER_UNITY_GAIN,
+                  TEST_LOW_PRIORITY);
+  uint32_t total = 0;
+  uint16_t count;
+  while ((count = soundMixer_mix(mixed, SOUND_MIXER_BLOCK_SAMPLE_COUNT))) {
+    for (uint16_t i = 0; i < count; i++)
+      success &= mixed[i] == 0;
+    total += count;
+  }
+  success &= total == TEST_SHORT_SAMPLE_COUNT && !soundMixer_isBusy();
+  if (!success)
+    printf("soundMixer_runTest: silence was not silent or was the wrong "
+           "length.\n");
+  return success;
+}
+
+// Returns the time to mix voiceCount sounds, in ns per output sample, mixing
+// blockSampleCount samples per call.
+static double soundMixer_timeMix(uint16_t voiceCount,
+                                 uint16_t blockSampleCount) {
+  static int16_t mixed[SOUND_MIXER_BLOCK_SAMPLE_COUNT];
+  clock_t start = clock();
+  for (uint16_t repeat = 0; repeat < TEST_BENCHMARK_REPEAT_COUNT; repeat++) {
+    soundMixer_init();
+    for (uint16_t voice = 0; voice < voiceCount; voice++)
+      soundMixer_play(testSounds[voice], TEST_SAMPLE_COUNT,
+                      SOUND_MIXER_UNITY_GAIN, TEST_LOW_PRIORITY);
+    while (soundMixer_mix(mixed, blockSampleCount))
+      ;
+  }
+  return (double)(clock() - start) / CLOCKS_PER_SEC * NANOSECONDS_PER_SECOND /
+         ((double)TEST_SAMPLE_COUNT * TEST_BENCHMARK_REPEAT_COUNT);
+}
+
+// Checks mixing, saturation, the priority policy and silence, then prints the
+// mix cost per sample for each number of voices.
+bool soundMixer_runTest() {
+  printf("Running soundMixer_runTest()\n");
+  soundMixer_makeTestSounds();
+  bool success = true;
+  // One voice is the decoded sound, two at full gain saturate.
+  for (uint16_t voices = 1; voices <= SOUND_MIXER_VOICE_COUNT; voices++)
+    success &= soundMixer_checkMix(voices, SOUND_MIXER_UNITY_GAIN);
+  success &= soundMixer_checkMix(SOUND_MIXER_VOICE_COUNT, TEST_HALF_GAIN);
+  success &= soundMixer_checkPriorities();
+  success &= soundMixer_checkSilence();
+  printf("voices  ns/sample (block of %d)  ns/sample (one at a time)\n",
+         SOUND_MIXER_BLOCK_SAMPLE_COUNT);
+  for (uint16_t voices = 1; voices <= SOUND_MIXER_VOICE_COUNT; voices++) {
+    printf("%6d %25.2f %26.2f\n", voices,
+           soundMixer_timeMix(voices, SOUND_MIXER_BLOCK_SAMPLE_COUNT),
+           soundMixer_timeMix(voices, 1));
+  }
+  soundMixer_init();
+  printf("soundMixer_runTest %s.\n", success ? "passed" : "failed");
+  return success;
+}
@@ -0,0 +1,70 @@
+/*
+This software is provided for student assignment use in the Department of
+Electrical and Computer Engineering, Brigham Young University, Utah, USA.
+Users agree to not re-host, or redistribute the software, in source or binary
+form, to other persons or other institutions. Users may modify and use the
+source code for personal or educational use.
+For questions, contact Brad Hutchings or Jeff Goeders, https://ece.byu.edu/
+*/
+
+#ifndef SOUNDMIXER_H_
+#define SOUNDMIXER_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Mixes up to SOUND_MIXER_VOICE_COUNT sounds at once, so a new sound no longer
+// cuts off the one that is playing. Each voice has its own encoded sound data
+// (see sounds/adpcm.h), position and gain. soundMixer_mix() produces a block
+// of samples at a time: each voice decodes its share of the block into a
+// 32-bit accumulator, and the sum is saturated to 16 bits once at the end.
+// Doing it a block at a time keeps the per-voice overhead out of the
+// per-sample path, so the cost per sample stays flat as voices are added.
+//
+// When every voice is busy, a new sound takes the voice playing the lowest
+// priority sound, as long as that priority is no higher than its own. Of
+// equal priorities, the voice with the least left to play is taken. A sound
+// that is already playing is restarted in the same voice, so rapid gunfire
+// doesn't use up every voice.
+//
+// Not thread safe: call everything from one context (sound_tick()).
+
+#define SOUND_MIXER_VOICE_COUNT 4
+#define SOUND_MIXER_BLOCK_SAMPLE_COUNT 64
+#define SOUND_MIXER_UNITY_GAIN 256 // Gains are in 1/256ths.
+#define SOUND_MIXER_NO_VOICE -1
+
+// Stops every voice.
+void soundMixer_init();
+
+// Starts playing sampleCount samples of data in a free voice, or in one taken
+// from a lower priority sound. data may be NULL for silence that still takes
+// up a voice. Returns the voice, or SOUND_MIXER_NO_VOICE if every voice is
+// playing something with a higher priority.
+int8_t soundMixer_play(const uint8_t *data, uint32_t sampleCount,
+                       uint16_t gain, uint8_t priority);
+
+// Stops voice.
+void soundMixer_stop(int8_t voice);
+
+// Stops every voice.
+void soundMixer_stopAll();
+
+// Returns true if any voice is playing.
+bool soundMixer_isBusy();
+
+// Returns the number of voices playing.
+uint8_t soundMixer_getActiveVoiceCount();
+
+// Mixes the next samples of every voice into samples, at most
+// SOUND_MIXER_BLOCK_SAMPLE_COUNT of them. Returns the number of samples mixed,
+// which is less than sampleCount only when the last voice finishes, and 0 when
+// nothing is playing.
+uint16_t soundMixer_mix(int16_t samples[], uint16_t sampleCount);
+
+// Checks mixing, saturation, the priority policy and silence, then prints the
+// mix cost per sample for each number of voices, mixing a block at a time and
+// a sample at a time. Returns true if the checks pass.
+bool soundMixer_runTest();
+
+#endif /* SOUNDMIXER_H_ */
@@ -0,0 +1,303 @@
+/*
+This software is provided for student assignment use in the Department of
+Electrical and Computer Engineering, Brigham Young University, Utah, USA.
+Users agree to not re-host, or redistribute the software, in source or binary
+form, to other persons or other institutions. Users may modify and use the
+source code for personal or educational use.
+For questions, contact Brad Hutchings or Jeff Goeders, https://ece.byu.edu/
+*/
+
+#include <math.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "adpcm.h"
+
+#define STEP_INDEX_MAX 88
+#define SIGN_BIT 0x8
+#define NIBBLE_MASK 0xF
+#define BITS_PER_NIBBLE 4
+#define BITS_PER_BYTE 8
+#define BYTE_MASK 0xFF
+
+// Standard IMA-ADPCM tables.
+static const int16_t stepSizes[STEP_INDEX_MAX + 1] = {
+    7,     8,     9,     10,    11,    12,    13,    14,    16,    17,
+    19,    21,    23,    25,    28,    31,    34,    37,    41,    45,
+    50,    55,    60,    66,    73,    80,    88,    97,    107,   118,
+    130,   143,   157,   173,   190,   209,   230,   253,   279,   307,
+    337,   371,   408,   449,   494,   544,   598,   658,   724,   796,
+    876,   963,   1060,  1166,  1282,  1411,  1552,  1707,  1878,  2066,
+    2272,  2499,  2749,  3024,  3327,  3660,  4026,  4428,  4871,  5358,
+    5894,  6484,  7132,  7845,  8630,  9493,  10442, 11487, 12635, 13899,
+    15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767};
+
+static const int8_t stepIndexChanges[SIGN_BIT] = {-1, -1, -1, -1, 2, 4, 6, 8};
+
+// Applies code to predictor and stepIndex, the same way for the encoder and
+// the decoder so they stay in step.
+static void adpcm_applyCode(uint8_t code, int16_t *predictor,
+                            uint8_t *stepIndex) {
+  int32_t step = stepSizes[*stepIndex];
+  // difference = (code magnitude + 1/2) * step / 4, without multiplying.
+  int32_t difference = step >> 3;
+  if (code & 4)
+    difference += step;
+  if (code & 2)
+    difference += step >> 1;
+  if (code & 1)
+    difference += step >> 2;
+  int32_t sample = *predictor + ((code & SIGN_BIT) ? -difference : difference);
+  if (sample > INT16_MAX)
+    sample = INT16_MAX;
+  else if (sample < INT16_MIN)
+    sample = INT16_MIN;
+  *predictor = sample;
+  int16_t index = *stepIndex + stepIndexChanges[code & ~SIGN_BIT];
+  if (index < 0)
+    index = 0;
+  else if (index > STEP_INDEX_MAX)
+    index = STEP_INDEX_MAX;
+  *stepIndex = index;
+}
+
+// Returns the code that takes predictor closest to sample.
+static uint8_t adpcm_encodeSample(int16_t sample, int16_t predictor,
+                                  uint8_t stepIndex) {
+  int32_t step = stepSizes[stepIndex];
+  int32_t difference = sample - predictor;
+  uint8_t code = 0;
+  if (difference < 0) {
+    code = SIGN_BIT;
+    difference = -difference;
+  }
+  if (difference >= step) {
+    code |= 4;
+    difference -= step;
+  }
+  if (difference >= step >> 1) {
+    code |= 2;
+    difference -= step >> 1;
+  }
+  if (difference >= step >> 2)
+    code |= 1;
+  return code;
+}
+
+// Returns the number of bytes needed to encode sampleCount samples.
+uint32_t adpcm_getEncodedByteCount(uint32_t sampleCount) {
+  uint32_t remainder = sampleCount % ADPCM_BLOCK_SAMPLE_COUNT;
+  uint32_t byteCount =
+      sampleCount / ADPCM_BLOCK_SAMPLE_COUNT * ADPCM_BLOCK_BYTE_COUNT;
+  if (remainder > 0)
+    byteCount += ADPCM_BLOCK_HEADER_BYTE_COUNT + (remainder + 1) / 2;
+  return byteCount;
+}
+
+// Encodes sampleCount samples into encoded.
+void adpcm_encode(const int16_t samples[], uint32_t sampleCount,
+                  uint8_t encoded[]) {
+  int16_t predictor = 0;
+  uint8_t stepIndex = 0;
+  uint8_t *block = encoded;
+  for (uint32_t i = 0; i < sampleCount; i++) {
+    uint16_t blockIndex = i % ADPCM_BLOCK_SAMPLE_COUNT;
+    if (blockIndex == 0) {
+      if (i > 0)
+        block += ADPCM_BLOCK_BYTE_COUNT;
+      // The state carries on from the last block, the header records it.
+      block[0] = (uint16_t)predictor & BYTE_MASK;
+      block[1] = (uint16_t)predictor >> BITS_PER_BYTE;
+      block[2] = stepIndex;
+      block[3] = 0;
+    }
+    uint8_t code = adpcm_encodeSample(samples[i], predictor, stepIndex);
+    adpcm_applyCode(code, &predictor, &stepIndex);
+    uint8_t *byte = &block[ADPCM_BLOCK_HEADER_BYTE_COUNT + blockIndex / 2];
+    if (blockIndex % 2 == 0)
+      *byte = code;
+    else
+      *byte |= code << BITS_PER_NIBBLE;
+  }
+}
+
+// Starts decoding the encoded data from its first sample.
+void adpcm_initDecoder(adpcm_decoder_t *decoder, const uint8_t encoded[]) {
+  decoder->data = encoded;
+  decoder->blockIndex = 0;
+  decoder->predictor = 0;
+  decoder->stepIndex = 0;
+}
+
+// Returns the next sample.
+int16_t adpcm_decodeNext(adpcm_decoder_t *decoder) {
+  const uint8_t *block = decoder->data;
+  if (decoder->blockIndex == 0) {
+    decoder->predictor = (int16_t)(block[0] | (block[1] << BITS_PER_BYTE));
+    decoder->stepIndex = block[2];
+    if (decoder->stepIndex > STEP_INDEX_MAX)
+      decoder->stepIndex = STEP_INDEX_MAX; // Damaged, don't index past the end.
+  }
+  uint8_t byte =
+      block[ADPCM_BLOCK_HEADER_BYTE_COUNT + decoder->blockIndex / 2];
+  uint8_t code = decoder->blockIndex % 2 == 0 ? byte & NIBBLE_MASK
+                                              : byte >> BITS_PER_NIBBLE;
+  adpcm_applyCode(code, &decoder->predictor, &decoder->stepIndex);
+  if (++decoder->blockIndex == ADPCM_BLOCK_SAMPLE_COUNT) {
+    decoder->data += ADPCM_BLOCK_BYTE_COUNT;
+    decoder->blockIndex = 0;
+  }
+  return decoder->predictor;
+}
+
+// Decodes sampleCount samples from encoded into samples.
+void adpcm_decode(const uint8_t encoded[], uint32_t sampleCount,
+                  int16_t samples[]) {
+  adpcm_decoder_t decoder;
+  adpcm_initDecoder(&decoder, encoded);
+  for (uint32_t i = 0; i < sampleCount; i++)
+    samples[i] = adpcm_decodeNext(&decoder);
+}
+
+#define IDENTICAL_SNR 1000.0 // dB, returned when there is no noise at all.
+#define DB_PER_DECADE_OF_POWER 10.0
+
+// Returns the signal-to-noise ratio, in dB, of decoded compared to original.
+double adpcm_computeSnr(const int16_t original[], const int16_t decoded[],
+                        uint32_t sampleCount) {
+  double signalPower = 0.0;
+  double noisePower = 0.0;
+  for (uint32_t i = 0; i < sampleCount; i++) {
+    double error = (double)decoded[i] - original[i];
+    signalPower += (double)original[i] * original[i];
+    noisePower += error * error;
+  }
+  if (noisePower == 0.0)
+    return IDENTICAL_SNR;
+  if (signalPower == 0.0)
+    return -IDENTICAL_SNR; // Nothing but noise.
+  return DB_PER_DECADE_OF_POWER * log10(signalPower / noisePower);
+}
+
+/*******************************************************
+ ****************** Test Routines **********************
+ ******************************************************/
+
+#define TEST_SAMPLE_RATE 48000
+#define TEST_SAMPLE_COUNT 48013 // One second, and a partial last block.
+#define TEST_AMPLITUDE (INT16_MAX / 2)
+#define TEST_TONE_HZ 440.0
+#define TEST_HIGH_TONE_HZ 4000.0
+#define TEST_SWEEP_START_HZ 100.0
+#define TEST_SWEEP_END_HZ 12000.0
+#define TEST_SQUARE_PERIOD 96 // 500 Hz.
+#define TEST_DECODE_REPEAT_COUNT 20 // For a measurable decode time.
+#define NANOSECONDS_PER_SECOND 1e9
+
+typedef enum {
+  TEST_TONE,
+  TEST_HIGH_TONE,
+  TEST_SWEEP,
+  TEST_NOISE,
+  TEST_SILENCE,
+  TEST_SQUARE,
+  TEST_SIGNAL_COUNT
+} adpcm_testSignal_t;
+
+static const char *testSignalNames[TEST_SIGNAL_COUNT] = {
+    "440 Hz tone", "4 kHz tone", "sweep", "noise", "silence", "square"};
+
+// Lowest acceptable SNR for each test signal, in dB. ADPCM follows tones and
+// sweeps closely, can't predict noise, and needs several samples to ramp its
+// step size up for each full scale edge of the square.
+static const double testMinimumSnrs[TEST_SIGNAL_COUNT] = {40.0, 24.0, 18.0,
+                                                          12.0, 100.0, 4.0};
+
+// Fills samples with signal.
+static void adpcm_makeTestSignal(adpcm_testSignal_t signal, int16_t samples[]) {
+  uint32_t random = 1;
+  double phase = 0.0;
+  for (uint32_t i = 0; i < TEST_SAMPLE_COUNT; i++) {
+    double t = (double)i / TEST_SAMPLE_RATE;
+    double value = 0.0;
+    switch (signal) {
+    case TEST_TONE:
+      value = sin(2 * M_PI * TEST_TONE_HZ * t);
+      break;
+    case TEST_HIGH_TONE:
+      value = sin(2 * M_PI * TEST_HIGH_TONE_HZ * t);
+      break;
+    case TEST_SWEEP: {
+      double fraction = (double)i / TEST_SAMPLE_COUNT;
+      phase += 2 * M_PI *
+               (TEST_SWEEP_START_HZ +
+                fraction * (TEST_SWEEP_END_HZ - TEST_SWEEP_START_HZ)) /
+               TEST_SAMPLE_RATE;
+      value = sin(phase);
+      break;
+    }
+    case TEST_NOISE:
+      random = random * 1103515245 + 12345; // Same every run.
+      value = (double)(random >> 16) / UINT16_MAX * 2 - 1;
+      break;
+    case TEST_SILENCE:
+      value = 0.0;
+      break;
+    case TEST_SQUARE:
+      // Full scale, to check clamping at both ends.
+      samples[i] = (i % TEST_SQUARE_PERIOD) < TEST_SQUARE_PERIOD / 2
+                       ? INT16_MAX
+                       : INT16_MIN;
+      continue;
+    default:
+      break;
+    }
+    samples[i] = (int16_t)(value * TEST_AMPLITUDE);
+  }
+}
+
+// Encodes and decodes test signals and checks the SNR of each.
+bool adpcm_runTest() {
+  static int16_t original[TEST_SAMPLE_COUNT];
+  static int16_t decoded[TEST_SAMPLE_COUNT];
+  static uint8_t encoded[(TEST_SAMPLE_COUNT / ADPCM_BLOCK_SAMPLE_COUNT + 1) *
+                         ADPCM_BLOCK_BYTE_COUNT];
+  printf("Running adpcm_runTest()\n");
+  bool success = true;
+  uint32_t byteCount = adpcm_getEncodedByteCount(TEST_SAMPLE_COUNT);
+  printf("%d samples, %d bytes raw, %d bytes encoded.\n", TEST_SAMPLE_COUNT,
+         (int)(TEST_SAMPLE_COUNT * sizeof(int16_t)), byteCount);
+  for (uint16_t signal = 0; signal < TEST_SIGNAL_COUNT; signal++) {
+    adpcm_makeTestSignal(signal, original);
+    adpcm_encode(original, TEST_SAMPLE_COUNT, encoded);
+    clock_t start = clock();
+    for (uint16_t repeat = 0; repeat < TEST_DECODE_REPEAT_COUNT; repeat++)
+      adpcm_decode(encoded, TEST_SAMPLE_COUNT, decoded);
+    double nanosecondsPerSample =
+        (double)(clock() - start) / CLOCKS_PER_SEC * NANOSECONDS_PER_SECOND /
+        ((double)TEST_SAMPLE_COUNT * TEST_DECODE_REPEAT_COUNT);
+    double snr = adpcm_computeSnr(original, decoded, TEST_SAMPLE_COUNT);
+    bool passed = snr >= testMinimumSnrs[signal];
+    printf("%-12s SNR %7.2f dB (minimum %5.1f), decode %5.2f ns/sample%s\n",
+           testSignalNames[signal], snr, testMinimumSnrs[signal],
+           nanosecondsPerSample, passed ? "" : "  FAILED");
+    success &= passed;
+  }
+  // A damaged block must not affect the blocks after it.
+  adpcm_makeTestSignal(TEST_TONE, original);
+  adpcm_encode(original, TEST_SAMPLE_COUNT, encoded);
+  adpcm_decode(encoded, TEST_SAMPLE_COUNT, decoded);
+  for (uint16_t i = 0; i < ADPCM_BLOCK_BYTE_COUNT; i++)
+    encoded[i] = ~encoded[i];
+  static int16_t damaged[TEST_SAMPLE_COUNT];
+  adpcm_decode(encoded, TEST_SAMPLE_COUNT, damaged);
+  for (uint32_t i = ADPCM_BLOCK_SAMPLE_COUNT; i < TEST_SAMPLE_COUNT; i++) {
+    if (damaged[i] != decoded[i]) {
+      printf("adpcm_runTest: damage in block 0 reached sample %d.\n", i);
+      success = false;
+      break;
+    }
+  }
+  printf("adpcm_runTest %s.\n", success ? "passed" : "failed");
+  return success;
+}
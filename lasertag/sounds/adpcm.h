@@ -0,0 +1,69 @@
+/*
+This software is provided for student assignment use in the Department of
+Electrical and Computer Engineering, Brigham Young University, Utah, USA.
+Users agree to not re-host, or redistribute the software, in source or binary
+form, to other persons or other institutions. Users may modify and use the
+source code for personal or educational use.
+For questions, contact Brad Hutchings or Jeff Goeders, https://ece.byu.edu/
+*/
+
+#ifndef ADPCM_H_
+#define ADPCM_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// IMA-ADPCM codec for the sound assets. wav2c encodes the 16-bit samples of a
+// .wav file to 4 bits each, and sound_tick() decodes them one sample at a time
+// as it fills the I2S FIFO, so the assets take about a quarter of the space.
+//
+// The data is a series of blocks of ADPCM_BLOCK_SAMPLE_COUNT samples (the last
+// block may be shorter). Each block starts with a header, the decoder state
+// before its first sample: the predicted sample (int16, little-endian) and the
+// step index (uint8), then a zero byte. Then come the samples, two per byte,
+// the first in the low nibble. Since every block carries its own state, a
+// damaged byte only affects the rest of its block.
+
+#define ADPCM_BLOCK_SAMPLE_COUNT 256
+#define ADPCM_BLOCK_HEADER_BYTE_COUNT 4
+#define ADPCM_BLOCK_BYTE_COUNT                                                 \
+  (ADPCM_BLOCK_HEADER_BYTE_COUNT + ADPCM_BLOCK_SAMPLE_COUNT / 2)
+
+// Decodes a stream of blocks one sample at a time.
+typedef struct {
+  const uint8_t *data;  // Start of the block being decoded.
+  uint16_t blockIndex;  // Next sample within the block.
+  int16_t predictor;    // Last decoded sample.
+  uint8_t stepIndex;    // Index into the step-size table.
+} adpcm_decoder_t;
+
+// Returns the number of bytes needed to encode sampleCount samples.
+uint32_t adpcm_getEncodedByteCount(uint32_t sampleCount);
+
+// Encodes sampleCount samples into encoded, which must hold
+// adpcm_getEncodedByteCount(sampleCount) bytes.
+void adpcm_encode(const int16_t samples[], uint32_t sampleCount,
+                  uint8_t encoded[]);
+
+// Starts decoding the encoded data from its first sample.
+void adpcm_initDecoder(adpcm_decoder_t *decoder, const uint8_t encoded[]);
+
+// Returns the next sample. The caller keeps count of the samples, decoding
+// past the last one reads past the end of the data.
+int16_t adpcm_decodeNext(adpcm_decoder_t *decoder);
+
+// Decodes sampleCount samples from encoded into samples.
+void adpcm_decode(const uint8_t encoded[], uint32_t sampleCount,
+                  int16_t samples[]);
+
+// Returns the signal-to-noise ratio, in dB, of decoded compared to original.
+// Returns a large value if they are identical.
+double adpcm_computeSnr(const int16_t original[], const int16_t decoded[],
+                        uint32_t sampleCount);
+
+// Encodes and decodes test signals (tones, a sweep, noise, silence and a full
+// scale square wave), checks the SNR of each, and prints the decode time per
+// sample. Returns true if every signal decodes well enough.
+bool adpcm_runTest();
+
+#endif /* ADPCM_H_ */
@@ -1,82718 +0,0 @@
-// This file was generated by executing this statement: wav2c pacmanDeath.wav
-
-#include <stdint.h>
-
-uint16_t pacmanDeath_wav[82712] = {
-32761,
-32765,
-32782,
-32793,
-32799,
-32801,
-32803,
-32795,
-32796,
-32784,
-32776,
-32773,
-32764,
-32764,
-32758,
-32761,
-32757,
-32761,
-32759,
-32758,
-32753,
-32752,
-32743,
-32743,
-32735,
-32742,
-32740,
-32758,
-32761,
-32780,
-32783,
-32792,
-32791,
-32788,
-32787,
-32783,
-32786,
-32787,
-32792,
-32793,
-32798,
-32790,
-32790,
-32784,
-32780,
-32786,
-32783,
-32797,
-32796,
-32803,
-32803,
-32798,
-32796,
-32782,
-32778,
-32767,
-32758,
-32755,
-32742,
-32746,
-32739,
-32748,
-32746,
-32760,
-32762,
-32772,
-32773,
-32777,
-32777,
-32777,
-32776,
-32774,
-32768,
-32766,
-32752,
-32752,
-32740,
-32744,
-32743,
-32746,
-32753,
-32748,
-32746,
-32729,
-32719,
-32703,
-32700,
-32701,
-32716,
-32735,
-32759,
-32779,
-32789,
-32793,
-32783,
-32772,
-32752,
-32745,
-32727,
-32738,
-32731,
-32748,
-32754,
-32765,
-32777,
-32786,
-32793,
-32800,
-32799,
-32802,
-32795,
-32794,
-32787,
-32781,
-32780,
-32773,
-32777,
-32772,
-32772,
-32768,
-32770,
-32765,
-32769,
-32768,
-32772,
-32773,
-32776,
-32771,
-32774,
-32767,
-32773,
-32768,
-32777,
-32781,
-32786,
-32790,
-32788,
-32782,
-32775,
-32768,
-32760,
-32757,
-32758,
-32760,
-32768,
-32773,
-32777,
-32780,
-32778,
-32777,
-32770,
-32769,
-32762,
-32764,
-32758,
-32757,
-32752,
-32749,
-32744,
-32744,
-32742,
-32750,
-32761,
-32776,
-32793,
-32810,
-32822,
-32832,
-32830,
-32829,
-32815,
-32802,
-32786,
-32769,
-32759,
-32751,
-32751,
-32758,
-32765,
-32775,
-32783,
-32781,
-32782,
-32771,
-32761,
-32758,
-32744,
-32752,
-32746,
-32758,
-32762,
-32774,
-32783,
-32797,
-32802,
-32812,
-32802,
-32802,
-32779,
-32770,
-32752,
-32746,
-32744,
-32747,
-32753,
-32757,
-32755,
-32755,
-32748,
-32750,
-32753,
-32764,
-32772,
-32783,
-32785,
-32784,
-32785,
-32781,
-32788,
-32793,
-32807,
-32812,
-32816,
-32811,
-32798,
-32790,
-32780,
-32782,
-32787,
-32795,
-32797,
-32796,
-32783,
-32771,
-32751,
-32743,
-32733,
-32738,
-32741,
-32748,
-32752,
-32758,
-32760,
-32768,
-32769,
-32776,
-32778,
-32781,
-32786,
-32788,
-32801,
-32810,
-32831,
-32840,
-32849,
-32842,
-32831,
-32813,
-32793,
-32779,
-32768,
-32760,
-32755,
-32745,
-32737,
-32729,
-32727,
-32729,
-32742,
-32751,
-32767,
-32766,
-32762,
-32747,
-32728,
-32713,
-32701,
-32691,
-32690,
-32683,
-32679,
-32675,
-32674,
-32678,
-32690,
-32702,
-32725,
-32732,
-32745,
-32747,
-32738,
-32744,
-32732,
-32739,
-32736,
-32740,
-32738,
-32745,
-32741,
-32749,
-32749,
-32752,
-32749,
-32741,
-32731,
-32719,
-32717,
-32719,
-32731,
-32744,
-32753,
-32753,
-32747,
-32724,
-32720,
-32707,
-32726,
-32747,
-32777,
-32810,
-32822,
-32840,
-32833,
-32835,
-32836,
-32839,
-32851,
-32853,
-32851,
-32835,
-32814,
-32791,
-32769,
-32759,
-32750,
-32753,
-32744,
-32742,
-32720,
-32712,
-32697,
-32698,
-32705,
-32719,
-32740,
-32757,
-32775,
-32783,
-32791,
-32791,
-32788,
-32787,
-32776,
-32776,
-32769,
-32776,
-32782,
-32794,
-32801,
-32800,
-32785,
-32764,
-32729,
-32703,
-32681,
-32669,
-32673,
-32679,
-32683,
-32694,
-32691,
-32706,
-32720,
-32747,
-32787,
-32820,
-32851,
-32863,
-32855,
-32837,
-32805,
-32781,
-32765,
-32752,
-32761,
-32760,
-32773,
-32775,
-32780,
-32787,
-32791,
-32805,
-32813,
-32819,
-32822,
-32804,
-32793,
-32754,
-32728,
-32686,
-32664,
-32641,
-32640,
-32647,
-32675,
-32703,
-32735,
-32756,
-32762,
-32763,
-32746,
-32736,
-32721,
-32718,
-32714,
-32714,
-32709,
-32704,
-32697,
-32706,
-32716,
-32756,
-32790,
-32833,
-32859,
-32865,
-32847,
-32818,
-32780,
-32753,
-32740,
-32734,
-32745,
-32744,
-32751,
-32747,
-32746,
-32756,
-32770,
-32798,
-32824,
-32835,
-32828,
-32799,
-32752,
-32705,
-32665,
-32646,
-32649,
-32666,
-32689,
-32708,
-32715,
-32716,
-32706,
-32707,
-32705,
-32724,
-32737,
-32753,
-32756,
-32744,
-32717,
-32684,
-32653,
-32628,
-32624,
-32633,
-32656,
-32689,
-32712,
-32735,
-32738,
-32733,
-32716,
-32699,
-32681,
-32678,
-32677,
-32697,
-32715,
-32754,
-32775,
-32810,
-32817,
-32826,
-32809,
-32793,
-32767,
-32755,
-32749,
-32770,
-32795,
-32842,
-32877,
-32909,
-32916,
-32904,
-32871,
-32825,
-32768,
-32725,
-32672,
-32652,
-32631,
-32631,
-32648,
-32670,
-32703,
-32731,
-32757,
-32764,
-32767,
-32751,
-32739,
-32726,
-32726,
-32734,
-32752,
-32762,
-32774,
-32762,
-32755,
-32730,
-32721,
-32713,
-32727,
-32745,
-32773,
-32795,
-32808,
-32810,
-32800,
-32781,
-32764,
-32741,
-32737,
-32731,
-32740,
-32748,
-32761,
-32764,
-32773,
-32764,
-32759,
-32755,
-32753,
-32766,
-32787,
-32813,
-32836,
-32851,
-32845,
-32826,
-32792,
-32754,
-32722,
-32703,
-32696,
-32707,
-32724,
-32745,
-32765,
-32775,
-32788,
-32791,
-32792,
-32794,
-32788,
-32790,
-32783,
-32781,
-32775,
-32769,
-32762,
-32758,
-32754,
-32761,
-32771,
-32795,
-32821,
-32846,
-32862,
-32859,
-32846,
-32811,
-32773,
-32734,
-32701,
-32684,
-32669,
-32674,
-32670,
-32686,
-32689,
-32709,
-32716,
-32732,
-32735,
-32737,
-32734,
-32728,
-32727,
-32728,
-32726,
-32719,
-32699,
-32672,
-32641,
-32627,
-32634,
-32670,
-32724,
-32771,
-32797,
-32785,
-32742,
-32692,
-32666,
-32677,
-32737,
-32808,
-32857,
-32847,
-32771,
-32652,
-32554,
-32529,
-32606,
-32781,
-32962,
-33092,
-33064,
-32896,
-32627,
-32391,
-32315,
-32475,
-32851,
-33306,
-33646,
-33668,
-33314,
-32634,
-31928,
-31556,
-31935,
-33327,
-35799,
-39101,
-42800,
-46275,
-48970,
-50448,
-50561,
-49427,
-47428,
-45080,
-42904,
-41349,
-40657,
-40894,
-41946,
-43592,
-45578,
-47662,
-49673,
-51469,
-52990,
-54169,
-54974,
-55401,
-55468,
-55272,
-54972,
-54757,
-54843,
-55383,
-56418,
-57891,
-59564,
-61161,
-62310,
-62720,
-62124,
-60422,
-57603,
-53799,
-49263,
-44302,
-39320,
-34708,
-30834,
-27996,
-26321,
-25822,
-26299,
-27471,
-28965,
-30445,
-31644,
-32423,
-32770,
-32773,
-32587,
-32384,
-32323,
-32541,
-33144,
-34194,
-35727,
-37706,
-40048,
-42569,
-45053,
-47215,
-48817,
-49651,
-49624,
-48753,
-47161,
-45070,
-42740,
-40451,
-38460,
-36969,
-36144,
-36046,
-36702,
-38025,
-39891,
-42100,
-44426,
-46637,
-48526,
-49947,
-50841,
-51223,
-51217,
-50991,
-50758,
-50723,
-51035,
-51797,
-52989,
-54529,
-56211,
-57806,
-59012,
-59566,
-59221,
-57823,
-55322,
-51803,
-47477,
-42680,
-37805,
-33301,
-29527,
-26796,
-25208,
-24766,
-25260,
-26433,
-27933,
-29464,
-30764,
-31702,
-32222,
-32386,
-32299,
-32124,
-32010,
-32118,
-32574,
-33455,
-34825,
-36639,
-38847,
-41268,
-43724,
-45947,
-47711,
-48793,
-49067,
-48491,
-47148,
-45214,
-42940,
-40623,
-38537,
-36929,
-35976,
-35761,
-36309,
-37541,
-39340,
-41518,
-43864,
-46150,
-48159,
-49722,
-50735,
-51196,
-51182,
-50881,
-50493,
-50259,
-50356,
-50901,
-51901,
-53282,
-54857,
-56401,
-57634,
-58276,
-58087,
-56872,
-54561,
-51179,
-46925,
-42096,
-37117,
-32426,
-28444,
-25484,
-23698,
-23080,
-23442,
-24503,
-25922,
-27384,
-28631,
-29528,
-30017,
-30148,
-30024,
-29788,
-29591,
-29577,
-29880,
-30592,
-31779,
-33440,
-35509,
-37852,
-40259,
-42488,
-44278,
-45403,
-45732,
-45199,
-43898,
-41982,
-39708,
-37335,
-35151,
-33367,
-32174,
-31673,
-31905,
-32854,
-34419,
-36465,
-38766,
-41107,
-43223,
-44915,
-46036,
-46549,
-46522,
-46144,
-45645,
-45296,
-45327,
-45875,
-46985,
-48560,
-50398,
-52227,
-53710,
-54545,
-54452,
-53274,
-50940,
-47557,
-43317,
-38575,
-33702,
-29150,
-25263,
-22367,
-20587,
-19951,
-20302,
-21391,
-22900,
-24499,
-25917,
-26966,
-27566,
-27758,
-27630,
-27364,
-27110,
-27043,
-27286,
-27931,
-29036,
-30601,
-32577,
-34843,
-37224,
-39468,
-41327,
-42546,
-42953,
-42479,
-41191,
-39253,
-36951,
-34564,
-32394,
-30660,
-29537,
-29090,
-29366,
-30303,
-31836,
-33820,
-36072,
-38376,
-40490,
-42197,
-43355,
-43902,
-43912,
-43557,
-43067,
-42705,
-42686,
-43132,
-44082,
-45438,
-47037,
-48636,
-49981,
-50798,
-50865,
-49983,
-48071,
-45114,
-41234,
-36680,
-31767,
-26936,
-22573,
-19058,
-16637,
-15397,
-15277,
-16048,
-17391,
-18963,
-20420,
-21554,
-22222,
-22446,
-22328,
-22034,
-21767,
-21714,
-22021,
-22811,
-24111,
-25928,
-28175,
-30702,
-33325,
-35769,
-37809,
-39193,
-39783,
-39508,
-38437,
-36712,
-34582,
-32299,
-30146,
-28349,
-27103,
-26539,
-26711,
-27623,
-29183,
-31253,
-33608,
-36014,
-38213,
-40000,
-41247,
-41918,
-42086,
-41907,
-41587,
-41339,
-41356,
-41761,
-42601,
-43854,
-45385,
-47020,
-48512,
-49580,
-49963,
-49423,
-47806,
-45082,
-41337,
-36822,
-31880,
-26957,
-22481,
-18846,
-16321,
-15006,
-14854,
-15630,
-17026,
-18674,
-20246,
-21500,
-22295,
-22636,
-22598,
-22358,
-22090,
-21988,
-22222,
-22900,
-24110,
-25848,
-28063,
-30611,
-33301,
-35862,
-38052,
-39606,
-40377,
-40283,
-39369,
-37778,
-35729,
-33480,
-31303,
-29442,
-28102,
-27448,
-27546,
-28428,
-30007,
-32132,
-34590,
-37106,
-39418,
-41308,
-42610,
-43308,
-43445,
-43205,
-42786,
-42449,
-42376,
-42741,
-43584,
-44881,
-46505,
-48253,
-49868,
-51066,
-51571,
-51148,
-49646,
-47021,
-43367,
-38914,
-34017,
-29098,
-24610,
-20945,
-18380,
-17028,
-16832,
-17560,
-18898,
-20479,
-21975,
-23149,
-23874,
-24155,
-24079,
-23808,
-23526,
-23398,
-23591,
-24202,
-25298,
-26890,
-28924,
-31287,
-33809,
-36270,
-38424,
-40057,
-40962,
-41052,
-40298,
-38794,
-36727,
-34343,
-31950,
-29837,
-28270,
-27435,
-27426,
-28225,
-29719,
-31704,
-33948,
-36201,
-38249,
-39930,
-41153,
-41903,
-42218,
-42209,
-42007,
-41782,
-41703,
-41908,
-42526,
-43560,
-44985,
-46610,
-48220,
-49478,
-50100,
-49777,
-48361,
-45780,
-42158,
-37728,
-32859,
-27964,
-23472,
-19731,
-17009,
-15404,
-14891,
-15294,
-16356,
-17752,
-19195,
-20414,
-21261,
-21677,
-21712,
-21491,
-21211,
-21034,
-21176,
-21724,
-22778,
-24321,
-26299,
-28590,
-31021,
-33396,
-35478,
-37072,
-37977,
-38101,
-37395,
-35965,
-33960,
-31658,
-29339,
-27289,
-25766,
-24914,
-24832,
-25481,
-26792,
-28589,
-30704,
-32913,
-35015,
-36836,
-38225,
-39129,
-39546,
-39568,
-39351,
-39091,
-38977,
-39192,
-39814,
-40877,
-42290,
-43897,
-45463,
-46710,
-47358,
-47131,
-45857,
-43432,
-39930,
-35535,
-30594,
-25525,
-20779,
-16762,
-13773,
-11951,
-11286,
-11601,
-12638,
-14071,
-15603,
-16976,
-18025,
-18681,
-18953,
-18943,
-18788,
-18666,
-18758,
-19220,
-20171,
-21661,
-23666,
-26080,
-28715,
-31334,
-33667,
-35461,
-36518,
-36722,
-36069,
-34658,
-32683,
-30400,
-28081,
-26010,
-24396,
-23429,
-23194,
-23725,
-24966,
-26810,
-29060,
-31516,
-33914,
-36043,
-37708,
-38816,
-39354,
-39409,
-39160,
-38812,
-38605,
-38728,
-39306,
-40371,
-41859,
-43590,
-45338,
-46782,
-47643,
-47624,
-46552,
-44326,
-41014,
-36799,
-32005,
-27040,
-22335,
-18310,
-15272,
-13407,
-12732,
-13097,
-14237,
-15818,
-17486,
-18983,
-20092,
-20784,
-21074,
-21096,
-21014,
-20970,
-21145,
-21612,
-22491,
-23793,
-25543,
-27681,
-30097,
-32609,
-34981,
-36953,
-38283,
-38801,
-38430,
-37245,
-35402,
-33181,
-30871,
-28765,
-27129,
-26105,
-25827,
-26277,
-27424,
-29141,
-31271,
-33610,
-35939,
-38047,
-39737,
-40910,
-41505,
-41597,
-41327,
-40899,
-40567,
-40526,
-40953,
-41891,
-43297,
-44994,
-46733,
-48200,
-49076,
-49096,
-48053,
-45890,
-42653,
-38542,
-33865,
-29002,
-24367,
-20347,
-17234,
-15217,
-14317,
-14421,
-15293,
-16636,
-18125,
-19494,
-20550,
-21198,
-21466,
-21429,
-21246,
-21082,
-21092,
-21430,
-22186,
-23425,
-25141,
-27275,
-29678,
-32175,
-34502,
-36423,
-37697,
-38169,
-37765,
-36543,
-34652,
-32341,
-29904,
-27639,
-25818,
-24637,
-24216,
-24579,
-25662,
-27338,
-29420,
-31704,
-33970,
-36021,
-37695,
-38882,
-39551,
-39729,
-39546,
-39164,
-38815,
-38704,
-39021,
-39857,
-41202,
-42931,
-44788,
-46468,
-47613,
-47912,
-47145,
-45196,
-42132,
-38129,
-33507,
-28655,
-23978,
-19871,
-16628,
-14454,
-13406,
-13410,
-14282,
-15738,
-17476,
-19186,
-20621,
-21619,
-22130,
-22207,
-22003,
-21704,
-21550,
-21722,
-22380,
-23578,
-25303,
-27451,
-29862,
-32309,
-34586,
-36445,
-37729,
-38285,
-38063,
-37085,
-35444,
-33336,
-30969,
-28642,
-26586,
-25054,
-24204,
-24113,
-24793,
-26135,
-28011,
-30196,
-32506,
-34704,
-36636,
-38146,
-39177,
-39701,
-39798,
-39567,
-39193,
-38861,
-38763,
-39053,
-39819,
-41050,
-42657,
-44429,
-46111,
-47382,
-47953,
-47562,
-46060,
-43413,
-39725,
-35239,
-30298,
-25304,
-20672,
-16763,
-13842,
-12045,
-11362,
-11655,
-12680,
-14137,
-15720,
-17165,
-18280,
-18970,
-19242,
-19169,
-18909,
-18629,
-18506,
-18713,
-19359,
-20526,
-22220,
-24377,
-26871,
-29502,
-32052,
-34257,
-35924,
-36862,
-37009,
-36359,
-35015,
-33136,
-30947,
-28662,
-26543,
-24781,
-23576,
-23057,
-23290,
-24280,
-25934,
-28090,
-30532,
-32994,
-35245,
-37075,
-38366,
-39105,
-39338,
-39233,
-38958,
-38721,
-38693,
-39000,
-39703,
-40796,
-42198,
-43764,
-45301,
-46569,
-47326,
-47321,
-46373,
-44355,
-41276,
-37252,
-32549,
-27518,
-22600,
-18210,
-14726,
-12370,
-11246,
-11241,
-12152,
-13625,
-15330,
-16936,
-18215,
-19060,
-19461,
-19516,
-19380,
-19207,
-19171,
-19389,
-19950,
-20927,
-22327,
-24161,
-26373,
-28856,
-31455,
-33935,
-36051,
-37546,
-38228,
-37994,
-36869,
-35004,
-32663,
-30153,
-27814,
-25909,
-24663,
-24163,
-24451,
-25449,
-27052,
-29094,
-31398,
-33763,
-35995,
-37915,
-39374,
-40305,
-40691,
-40623,
-40259,
-39803,
-39492,
-39522,
-40034,
-41070,
-42571,
-44363,
-46202,
-47787,
-48813,
-49015,
-48202,
-46294,
-43326,
-39472,
-34993,
-30245,
-25606,
-21443,
-18061,
-15666,
-14333,
-14013,
-14540,
-15668,
-17113,
-18592,
-19887,
-20838,
-21391,
-21575,
-21480,
-21265,
-21086,
-21113,
-21475,
-22276,
-23550,
-25290,
-27416,
-29794,
-32258,
-34576,
-36559,
-37986,
-38725,
-38702,
-37920,
-36492,
-34592,
-32437,
-30292,
-28372,
-26898,
-25998,
-25773,
-26232,
-27335,
-28990,
-31023,
-33269,
-35491,
-37505,
-39128,
-40259,
-40877,
-41036,
-40881,
-40585,
-40345,
-40337,
-40672,
-41418,
-42537,
-43948,
-45478,
-46933,
-48051,
-48605,
-48344,
-47118,
-44835,
-41540,
-37404,
-32704,
-27832,
-23186,
-19171,
-16082,
-14106,
-13264,
-13435,
-14378,
-15778,
-17330,
-18748,
-19852,
-20560,
-20867,
-20883,
-20725,
-20546,
-20497,
-20695,
-21247,
-22222,
-23648,
-25510,
-27737,
-30186,
-32665,
-34932,
-36752,
-37900,
-38250,
-37742,
-36435,
-34500,
-32145,
-29680,
-27365,
-25474,
-24215,
-23705,
-24007,
-25062,
-26751,
-28890,
-31243,
-33588,
-35713,
-37450,
-38711,
-39463,
-39759,
-39705,
-39451,
-39178,
-39051,
-39243,
-39831,
-40875,
-42293,
-43958,
-45625,
-47022,
-47826,
-47781,
-46675,
-44439,
-41124,
-36934,
-32165,
-27222,
-22496,
-18370,
-15139,
-12967,
-11909,
-11857,
-12626,
-13920,
-15461,
-16945,
-18179,
-19019,
-19446,
-19523,
-19372,
-19166,
-19068,
-19228,
-19766,
-20746,
-22202,
-24091,
-26343,
-28809,
-31311,
-33617,
-35508,
-36778,
-37290,
-37000,
-35949,
-34294,
-32238,
-30035,
-27935,
-26154,
-24883,
-24231,
-24271,
-25010,
-26380,
-28280,
-30530,
-32929,
-35247,
-37281,
-38856,
-39906,
-40412,
-40484,
-40271,
-39979,
-39812,
-39939,
-40457,
-41399,
-42698,
-44220,
-45780,
-47132,
-48051,
-48295,
-47684,
-46099,
-43497,
-39977,
-35714,
-31034,
-26297,
-21935,
-18298,
-15687,
-14215,
-13865,
-14459,
-15697,
-17270,
-18833,
-20175,
-21127,
-21668,
-21838,
-21756,
-21558,
-21392,
-21407,
-21710,
-22415,
-23572,
-25205,
-27273,
-29662,
-32202,
-34665,
-36799,
-38377,
-39202,
-39194,
-38350,
-36796,
-34733,
-32424,
-30153,
-28178,
-26708,
-25883,
-25762,
-26346,
-27549,
-29269,
-31334,
-33577,
-35789,
-37800,
-39437,
-40595,
-41237,
-41393,
-41196,
-40821,
-40478,
-40382,
-40681,
-41462,
-42709,
-44290,
-46011,
-47598,
-48756,
-49217,
-48746,
-47229,
-44629,
-41075,
-36762,
-32034,
-27231,
-22762,
-18936,
-16028,
-14161,
-13352,
-13494,
-14370,
-15724,
-17257,
-18710,
-19875,
-20617,
-20917,
-20822,
-20482,
-20072,
-19809,
-19877,
-20418,
-21507,
-23134,
-25208,
-27592,
-30072,
-32457,
-34518,
-36077,
-36983,
-37154,
-36564,
-35279,
-33427,
-31212,
-28883,
-26689,
-24886,
-23656,
-23130,
-23364,
-24306,
-25888,
-27933,
-30264,
-32677,
-34949,
-36912,
-38413,
-39395,
-39869,
-39937,
-39768,
-39554,
-39508,
-39770,
-40435,
-41497,
-42880,
-44433,
-45955,
-47225,
-48006,
-48091,
-47299,
-45533,
-42774,
-39133,
-34823,
-30173,
-25572,
-21427,
-18085,
-15797,
-14656,
-14596,
-15408,
-16782,
-18367,
-19854,
-20996,
-21678,
-21888,
-21728,
-21352,
-20945,
-20672,
-20680,
-21059,
-21885,
-23172,
-24915,
-27065,
-29496,
-32046,
-34485,
-36548,
-38006,
-38658,
-38417,
-37319,
-35499,
-33201,
-30728,
-28359,
-26389,
-25000,
-24340,
-24446,
-25294,
-26774,
-28748,
-30992,
-33319,
-35488,
-37335,
-38723,
-39596,
-39981,
-39965,
-39714,
-39400,
-39225,
-39337,
-39852,
-40796,
-42128,
-43715,
-45366,
-46835,
-47857,
-48180,
-47603,
-45989,
-43325,
-39693,
-35312,
-30486,
-25606,
-21059,
-17218,
-14354,
-12617,
-12012,
-12386,
-13498,
-15015,
-16622,
-18033,
-19064,
-19632,
-19777,
-19612,
-19321,
-19101,
-19121,
-19534,
-20398,
-21759,
-23560,
-25739,
-28158,
-30667,
-33072,
-35178,
-36780,
-37721,
-37885,
-37254,
-35898,
-33972,
-31710,
-29373,
-27223,
-25502,
-24381,
-23980,
-24347,
-25440,
-27179,
-29385,
-31854,
-34333,
-36589,
-38402,
-39663,
-40322,
-40471,
-40257,
-39896,
-39604,
-39577,
-39929,
-40722,
-41917,
-43414,
-45052,
-46606,
-47843,
-48481,
-48308,
-47112,
-44827,
-41482,
-37253,
-32458,
-27477,
-22767,
-18697,
-15611,
-13644,
-12848,
-13070,
-14085,
-15588,
-17263,
-18838,
-20114,
-20974,
-21420,
-21501,
-21359,
-21149,
-21032,
-21187,
-21704,
-22706,
-24181,
-26131,
-28435,
-30958,
-33483,
-35788,
-37637,
-38834,
-39247,
-38830,
-37643,
-35832,
-33634,
-31307,
-29142,
-27381,
-26217,
-25776,
-26082,
-27104,
-28727,
-30786,
-33086,
-35416,
-37566,
-39373,
-40709,
-41528,
-41857,
-41797,
-41513,
-41192,
-41047,
-41215,
-41815,
-42840,
-44225,
-45802,
-47356,
-48628,
-49374,
-49369,
-48457,
-46567,
-43716,
-40041,
-35764,
-31186,
-26662,
-22550,
-19155,
-16722,
-15346,
-15005,
-15551,
-16718,
-18214,
-19730,
-21019,
-21939,
-22421,
-22529,
-22376,
-22126,
-21950,
-22008,
-22406,
-23241,
-24531,
-26266,
-28375,
-30736,
-33176,
-35488,
-37450,
-38848,
-39537,
-39428,
-38547,
-36999,
-34985,
-32744,
-30546,
-28632,
-27210,
-26423,
-26341,
-26973,
-28243,
-30034,
-32179,
-34473,
-36717,
-38713,
-40305,
-41394,
-41958,
-42053,
-41805,
-41411,
-41064,
-40985,
-41304,
-42119,
-43381,
-44988,
-46696,
-48260,
-49345,
-49720,
-49132,
-47507,
-44833,
-41244,
-36984,
-32347,
-27711,
-23395,
-19731,
-16924,
-15108,
-14295,
-14383,
-15206,
-16496,
-18024,
-19493,
-20745,
-21613,
-22077,
-22161,
-21980,
-21675,
-21427,
-21379,
-21674,
-22395,
-23575,
-25206,
-27212,
-29487,
-31862,
-34158,
-36161,
-37687,
-38574,
-38719,
-38120,
-36814,
-34984,
-32793,
-30513,
-28365,
-26571,
-25313,
-24689,
-24771,
-25530,
-26910,
-28777,
-30978,
-33311,
-35590,
-37613,
-39244,
-40370,
-40991,
-41133,
-40958,
-40602,
-40306,
-40221,
-40517,
-41251,
-42426,
-43942,
-45634,
-47276,
-48609,
-49375,
-49336,
-48322,
-46244,
-43126,
-39122,
-34481,
-29568,
-24764,
-20451,
-16950,
-14454,
-13040,
-12645,
-13094,
-14162,
-15574,
-17084,
-18487,
-19617,
-20403,
-20803,
-20877,
-20702,
-20445,
-20246,
-20313,
-20762,
-21725,
-23213,
-25200,
-27565,
-30138,
-32715,
-35080,
-37019,
-38384,
-39029,
-38936,
-38105,
-36646,
-34726,
-32553,
-30374,
-28423,
-26898,
-25959,
-25685,
-26091,
-27131,
-28699,
-30653,
-32825,
-35033,
-37104,
-38878,
-40252,
-41150,
-41599,
-41649,
-41446,
-41154,
-40950,
-41005,
-41429,
-42277,
-43520,
-45052,
-46695,
-48222,
-49389,
-49949,
-49695,
-48493,
-46280,
-43121,
-39171,
-34692,
-30018,
-25514,
-21529,
-18357,
-16168,
-15048,
-14883,
-15545,
-16719,
-18182,
-19623,
-20879,
-21795,
-22347,
-22560,
-22518,
-22349,
-22191,
-22169,
-22420,
-23031,
-24061,
-25543,
-27422,
-29633,
-32019,
-34411,
-36596,
-38371,
-39556,
-40025,
-39719,
-38672,
-36989,
-34861,
-32521,
-30217,
-28203,
-26677,
-25793,
-25636,
-26192,
-27430,
-29188,
-31327,
-33625,
-35875,
-37890,
-39500,
-40623,
-41235,
-41394,
-41228,
-40909,
-40611,
-40512,
-40724,
-41323,
-42304,
-43605,
-45114,
-46653,
-48028,
-49003,
-49349,
-48862,
-47393,
-44888,
-41412,
-37141,
-32393,
-27514,
-22932,
-18982,
-15962,
-14000,
-13125,
-13190,
-13995,
-15246,
-16667,
-18010,
-19087,
-19814,
-20154,
-20180,
-19973,
-19685,
-19445,
-19404,
-19677,
-20368,
-21538,
-23194,
-25307,
-27754,
-30396,
-32997,
-35347,
-37216,
-38413,
-38851,
-38465,
-37357,
-35642,
-33544,
-31293,
-29142,
-27320,
-26022,
-25383,
-25483,
-26322,
-27832,
-29889,
-32287,
-34830,
-37264,
-39397,
-41067,
-42182,
-42749,
-42835,
-42603,
-42222,
-41918,
-41833,
-42125,
-42811,
-43895,
-45256,
-46750,
-48175,
-49316,
-49959,
-49905,
-49006,
-47162,
-44371,
-40727,
-36413,
-31738,
-27041,
-22710,
-19068,
-16373,
-14723,
-14115,
-14393,
-15325,
-16647,
-18089,
-19434,
-20538,
-21297,
-21709,
-21797,
-21655,
-21401,
-21192,
-21185,
-21540,
-22357,
-23694,
-25514,
-27731,
-30161,
-32630,
-34909,
-36828,
-38219,
-38974,
-39025,
-38364,
-37048,
-35189,
-32982,
-30652,
-28470,
-26689,
-25520,
-25092,
-25452,
-26533,
-28221,
-30316,
-32633,
-34953,
-37117,
-38954,
-40382,
-41319,
-41795,
-41842,
-41609,
-41238,
-40929,
-40849,
-41135,
-41848,
-42987,
-44449,
-46075,
-47648,
-48909,
-49610,
-49503,
-48419,
-46253,
-43039,
-38923,
-34192,
-29211,
-24402,
-20149,
-16766,
-14436,
-13193,
-12946,
-13507,
-14621,
-16042,
-17525,
-18883,
-19975,
-20718,
-21090,
-21132,
-20947,
-20681,
-20530,
-20657,
-21225,
-22307,
-23909,
-25963,
-28331,
-30836,
-33299,
-35523,
-37344,
-38613,
-39205,
-39063,
-38175,
-36617,
-34561,
-32217,
-29888,
-27816,
-26265,
-25357,
-25193,
-25725,
-26890,
-28557,
-30574,
-32792,
-35045,
-37162,
-39008,
-40424,
-41360,
-41779,
-41770,
-41472,
-41083,
-40826,
-40870,
-41349,
-42278,
-43605,
-45180,
-46807,
-48248,
-49276,
-49666,
-49243,
-47898,
-45579,
-42362,
-38380,
-33910,
-29252,
-24795,
-20862,
-17768,
-15674,
-14650,
-14605,
-15357,
-16633,
-18152,
-19640,
-20908,
-21817,
-22358,
-22547,
-22508,
-22352,
-22234,
-22280,
-22614,
-23320,
-24455,
-26023,
-27991,
-30252,
-32670,
-35048,
-37172,
-38843,
-39879,
-40180,
-39713,
-38547,
-36816,
-34737,
-32528,
-30433,
-28654,
-27350,
-26642,
-26573,
-27159,
-28344,
-30038,
-32104,
-34362,
-36614,
-38663,
-40336,
-41519,
-42186,
-42377,
-42222,
-41904,
-41591,
-41491,
-41692,
-42301,
-43276,
-44591,
-46090,
-47624,
-48973,
-49904,
-50194,
-49629,
-48078,
-45492,
-41958,
-37672,
-32953,
-28179,
-23738,
-19986,
-17162,
-15400,
-14678,
-14866,
-15749,
-17044,
-18512,
-19892,
-21036,
-21833,
-22260,
-22360,
-22229,
-21993,
-21825,
-21855,
-22251,
-23085,
-24423,
-26239,
-28444,
-30907,
-33416,
-35786,
-37781,
-39244,
-40030,
-40079,
-39397,
-38067,
-36219,
-34067,
-31813,
-29704,
-27957,
-26743,
-26194,
-26347,
-27190,
-28621,
-30508,
-32655,
-34884,
-36995,
-38832,
-40270,
-41233,
-41723,
-41775,
-41527,
-41118,
-40761,
-40623,
-40861,
-41553,
-42690,
-44180,
-45837,
-47432,
-48713,
-49420,
-49355,
-48367,
-46385,
-43442,
-39654,
-35238,
-30503,
-25793,
-21476,
-17892,
-15264,
-13738,
-13269,
-13719,
-14834,
-16314,
-17874,
-19267,
-20342,
-21018,
-21315,
-21304,
-21106,
-20864,
-20730,
-20839,
-21314,
-22235,
-23633,
-25489,
-27714,
-30169,
-32666,
-35006,
-36972,
-38388,
-39113,
-39075,
-38277,
-36805,
-34808,
-32516,
-30173,
-28053,
-26382,
-25351,
-25064,
-25544,
-26731,
-28492,
-30648,
-32994,
-35319,
-37441,
-39205,
-40523,
-41350,
-41714,
-41705,
-41443,
-41108,
-40860,
-40869,
-41248,
-42070,
-43304,
-44876,
-46585,
-48214,
-49472,
-50085,
-49814,
-48502,
-46089,
-42676,
-38440,
-33722,
-28865,
-24284,
-20308,
-17227,
-15179,
-14207,
-14210,
-15009,
-16345,
-17947,
-19545,
-20926,
-21944,
-22531,
-22708,
-22571,
-22263,
-21967,
-21862,
-22091,
-22775,
-23946,
-25600,
-27661,
-30004,
-32473,
-34897,
-37075,
-38842,
-40036,
-40531,
-40283,
-39295,
-37671,
-35586,
-33278,
-31015,
-29059,
-27631,
-26872,
-26847,
-27534,
-28829,
-30597,
-32665,
-34850,
-36999,
-38934,
-40556,
-41753,
-42500,
-42805,
-42752,
-42473,
-42140,
-41937,
-42023,
-42504,
-43418,
-44708,
-46245,
-47834,
-49230,
-50195,
-50486,
-49935,
-48409,
-45911,
-42499,
-38379,
-33808,
-29126,
-24705,
-20856,
-17889,
-15930,
-15050,
-15137,
-16004,
-17365,
-18937,
-20425,
-21641,
-22448,
-22829,
-22855,
-22623,
-22323,
-22075,
-22048,
-22344,
-23033,
-24177,
-25748,
-27723,
-29990,
-32402,
-34771,
-36870,
-38493,
-39453,
-39648,
-39042,
-37723,
-35830,
-33594,
-31256,
-29063,
-27236,
-25945,
-25306,
-25371,
-26131,
-27510,
-29386,
-31586,
-33907,
-36144,
-38101,
-39627,
-40642,
-41130,
-41160,
-40876,
-40444,
-40084,
-39955,
-40211,
-40910,
-42046,
-43518,
-45169,
-46770,
-48090,
-48874,
-48929,
-48077,
-46272,
-43504,
-39908,
-35690,
-31131,
-26586,
-22388,
-18858,
-16234,
-14632,
-14065,
-14405,
-15441,
-16914,
-18546,
-20107,
-21422,
-22391,
-22995,
-23272,
-23314,
-23228,
-23155,
-23224,
-23565,
-24289,
-25453,
-27079,
-29113,
-31445,
-33895,
-36264,
-38322,
-39889,
-40802,
-40999,
-40454,
-39261,
-37524,
-35448,
-33210,
-31041,
-29123,
-27638,
-26700,
-26395,
-26736,
-27694,
-29185,
-31084,
-33239,
-35470,
-37604,
-39471,
-40946,
-41939,
-42442,
-42501,
-42240,
-41827,
-41442,
-41264,
-41420,
-41982,
-42950,
-44254,
-45777,
-47344,
-48765,
-49829,
-50321,
-50060,
-48880,
-46722,
-43581,
-39609,
-35034,
-30193,
-25461,
-21216,
-17761,
-15304,
-13919,
-13550,
-14038,
-15146,
-16612,
-18173,
-19619,
-20779,
-21569,
-21968,
-22020,
-21827,
-21524,
-21271,
-21217,
-21492,
-22193,
-23351,
-24968,
-26969,
-29250,
-31664,
-34035,
-36188,
-37945,
-39158,
-39718,
-39565,
-38720,
-37254,
-35316,
-33105,
-30826,
-28728,
-26994,
-25813,
-25270,
-25425,
-26240,
-27641,
-29501,
-31653,
-33927,
-36147,
-38142,
-39786,
-40984,
-41696,
-41961,
-41844,
-41517,
-41123,
-40872,
-40895,
-41312,
-42150,
-43366,
-44849,
-46428,
-47889,
-49030,
-49607,
-49458,
-48416,
-46428,
-43491,
-39731,
-35353,
-30665,
-26006,
-21742,
-18168,
-15512,
-13882,
-13242,
-13487,
-14395,
-15735,
-17260,
-18753,
-20044,
-21030,
-21650,
-21932,
-21924,
-21750,
-21541,
-21452,
-21627,
-22177,
-23167,
-24615,
-26459,
-28617,
-30934,
-33259,
-35415,
-37244,
-38601,
-39380,
-39515,
-38988,
-37855,
-36202,
-34205,
-32053,
-29967,
-28180,
-26856,
-26154,
-26127,
-26774,
-28033,
-29769,
-31835,
-34062,
-36268,
-38314,
-40049,
-41384,
-42257,
-42667,
-42671,
-42388,
-41982,
-41638,
-41537,
-41812,
-42524,
-43663,
-45114,
-46727,
-48274,
-49552,
-50319,
-50410,
-49653,
-47982,
-45361,
-41893,
-37726,
-33153,
-28490,
-24107,
-20345,
-17450,
-15579,
-14730,
-14800,
-15583,
-16828,
-18286,
-19733,
-21010,
-22006,
-22685,
-23037,
-23124,
-23023,
-22843,
-22731,
-22804,
-23204,
-24014,
-25275,
-26979,
-29039,
-31338,
-33696,
-35947,
-37887,
-39375,
-40260,
-40481,
-39998,
-38866,
-37175,
-35097,
-32835,
-30615,
-28680,
-27212,
-26383,
-26251,
-26831,
-28046,
-29764,
-31825,
-34046,
-36246,
-38282,
-40017,
-41369,
-42285,
-42756,
-42827,
-42582,
-42171,
-41755,
-41525,
-41637,
-42194,
-43219,
-44639,
-46290,
-47944,
-49342,
-50230,
-50401,
-49707,
-48086,
-45551,
-42203,
-38219,
-33819,
-29308,
-24966,
-21117,
-18008,
-15815,
-14632,
-14398,
-14993,
-16171,
-17684,
-19259,
-20676,
-21784,
-22494,
-22823,
-22814,
-22592,
-22289,
-22046,
-22014,
-22296,
-22988,
-24132,
-25721,
-27707,
-29980,
-32403,
-34796,
-36965,
-38727,
-39906,
-40392,
-40121,
-39117,
-37481,
-35381,
-33055,
-30729,
-28673,
-27060,
-26064,
-25747,
-26128,
-27161,
-28732,
-30721,
-32940,
-35233,
-37399,
-39293,
-40769,
-41762,
-42259,
-42314,
-42061,
-41651,
-41278,
-41109,
-41278,
-41859,
-42865,
-44229,
-45834,
-47489,
-48993,
-50099,
-50586,
-50260,
-48970,
-46684,
-43431,
-39381,
-34783,
-29957,
-25260,
-21041,
-17576,
-15085,
-13633,
-13200,
-13653,
-14760,
-16280,
-17924,
-19479,
-20748,
-21658,
-22158,
-22326,
-22233,
-22029,
-21840,
-21806,
-22037,
-22629,
-23641,
-25099,
-26978,
-29211,
-31669,
-34178,
-36529,
-38504,
-39907,
-40592,
-40494,
-39624,
-38106,
-36096,
-33848,
-31572,
-29533,
-27899,
-26831,
-26415,
-26662,
-27569,
-29026,
-30936,
-33130,
-35439,
-37684,
-39700,
-41344,
-42536,
-43235,
-43475,
-43356,
-43009,
-42624,
-42354,
-42367,
-42755,
-43565,
-44756,
-46230,
-47806,
-49294,
-50444,
-51056,
-50918,
-49915,
-47968,
-45124,
-41479,
-37256,
-32707,
-28171,
-23957,
-20375,
-17652,
-15922,
-15212,
-15417,
-16358,
-17759,
-19372,
-20905,
-22197,
-23092,
-23583,
-23692,
-23528,
-23225,
-22925,
-22787,
-22922,
-23448,
-24408,
-25834,
-27674,
-29847,
-32213,
-34587,
-36801,
-38636,
-39970,
-40647,
-40637,
-39919,
-38572,
-36712,
-34530,
-32224,
-30043,
-28191,
-26864,
-26176,
-26190,
-26867,
-28135,
-29849,
-31853,
-33987,
-36085,
-38008,
-39634,
-40868,
-41659,
-41999,
-41959,
-41631,
-41213,
-40846,
-40749,
-41001,
-41702,
-42791,
-44186,
-45718,
-47175,
-48362,
-49043,
-49047,
-48210,
-46438,
-43706,
-40081,
-35732,
-30927,
-26016,
-21370,
-17364,
-14270,
-12269,
-11378,
-11492,
-12385,
-13789,
-15396,
-16981,
-18336,
-19386,
-20090,
-20487,
-20658,
-20679,
-20682,
-20749,
-21011,
-21563,
-22486,
-23848,
-25640,
-27816,
-30245,
-32762,
-35154,
-37222,
-38783,
-39719,
-39969,
-39542,
-38514,
-36995,
-35154,
-33153,
-31200,
-29475,
-28157,
-27397,
-27272,
-27829,
-29007,
-30706,
-32761,
-34982,
-37177,
-39163,
-40806,
-42002,
-42722,
-42980,
-42846,
-42461,
-41968,
-41561,
-41403,
-41610,
-42267,
-43341,
-44758,
-46355,
-47931,
-49269,
-50141,
-50357,
-49751,
-48222,
-45754,
-42383,
-38294,
-33704,
-28953,
-24389,
-20363,
-17160,
-14970,
-13848,
-13720,
-14410,
-15660,
-17194,
-18752,
-20118,
-21159,
-21800,
-22059,
-22001,
-21741,
-21428,
-21208,
-21237,
-21626,
-22472,
-23783,
-25561,
-27705,
-30102,
-32583,
-34961,
-37048,
-38668,
-39678,
-39985,
-39572,
-38468,
-36813,
-34750,
-32515,
-30312,
-28357,
-26832,
-25860,
-25524,
-25846,
-26800,
-28311,
-30257,
-32492,
-34820,
-37067,
-39032,
-40581,
-41616,
-42129,
-42177,
-41899,
-41462,
-41076,
-40896,
-41084,
-41672,
-42697,
-44053,
-45633,
-47247,
-48682,
-49721,
-50132,
-49731,
-48376,
-46019,
-42692,
-38570,
-33896,
-29023,
-24322,
-20150,
-16815,
-14497,
-13266,
-13049,
-13677,
-14894,
-16444,
-18040,
-19499,
-20646,
-21424,
-21822,
-21888,
-21733,
-21467,
-21251,
-21210,
-21485,
-22161,
-23302,
-24905,
-26921,
-29241,
-31718,
-34173,
-36398,
-38230,
-39476,
-40054,
-39891,
-39029,
-37554,
-35645,
-33495,
-31351,
-29417,
-27886,
-26893,
-26507,
-26757,
-27610,
-28995,
-30811,
-32917,
-35155,
-37342,
-39313,
-40907,
-42034,
-42657,
-42821,
-42649,
-42290,
-41947,
-41765,
-41893,
-42389,
-43271,
-44485,
-45939,
-47465,
-48902,
-50018,
-50604,
-50465,
-49432,
-47447,
-44523,
-40794,
-36496,
-31921,
-27420,
-23303,
-19871,
-17297,
-15705,
-15066,
-15295,
-16197,
-17540,
-19074,
-20558,
-21806,
-22708,
-23220,
-23396,
-23322,
-23145,
-22992,
-22998,
-23270,
-23861,
-24845,
-26198,
-27940,
-29989,
-32258,
-34600,
-36834,
-38757,
-40182,
-40951,
-40973,
-40257,
-38866,
-36973,
-34783,
-32532,
-30452,
-28737,
-27543,
-26968,
-27045,
-27766,
-29049,
-30807,
-32876,
-35102,
-37302,
-39296,
-40946,
-42136,
-42824,
-43040,
-42867,
-42463,
-42003,
-41678,
-41648,
-42025,
-42851,
-44088,
-45632,
-47301,
-48883,
-50130,
-50811,
-50719,
-49725,
-47768,
-44894,
-41248,
-37051,
-32588,
-28170,
-24089,
-20600,
-17884,
-16052,
-15101,
-14996,
-15568,
-16669,
-18053,
-19533,
-20891,
-22003,
-22764,
-23174,
-23266,
-23153,
-22944,
-22782,
-22775,
-23033,
-23607,
-24557,
-25876,
-27558,
-29543,
-31733,
-34004,
-36183,
-38093,
-39573,
-40460,
-40703,
-40246,
-39173,
-37567,
-35604,
-33451,
-31315,
-29366,
-27786,
-26689,
-26193,
-26313,
-27080,
-28401,
-30206,
-32326,
-34615,
-36881,
-38965,
-40700,
-42000,
-42777,
-43066,
-42915,
-42474,
-41914,
-41432,
-41215,
-41391,
-42028,
-43110,
-44525,
-46133,
-47725,
-49104,
-50077,
-50480,
-50176,
-49076,
-47124,
-44329,
-40766,
-36586,
-32026,
-27375,
-22974,
-19131,
-16120,
-14101,
-13121,
-13114,
-13895,
-15234,
-16862,
-18523,
-20025,
-21204,
-22011,
-22419,
-22499,
-22333,
-22068,
-21829,
-21765,
-21985,
-22572,
-23578,
-24991,
-26790,
-28880,
-31178,
-33534,
-35811,
-37824,
-39425,
-40433,
-40759,
-40331,
-39174,
-37402,
-35184,
-32760,
-30387,
-28304,
-26714,
-25754,
-25494,
-25929,
-27011,
-28626,
-30647,
-32915,
-35261,
-37514,
-39524,
-41145,
-42310,
-42961,
-43149,
-42942,
-42499,
-41966,
-41538,
-41355,
-41541,
-42161,
-43198,
-44606,
-46232,
-47930,
-49462,
-50639,
-51217,
-51045,
-49964,
-47944,
-44997,
-41252,
-36924,
-32289,
-27685,
-23439,
-19853,
-17149,
-15454,
-14766,
-14985,
-15912,
-17307,
-18907,
-20487,
-21854,
-22904,
-23576,
-23884,
-23884,
-23670,
-23359,
-23093,
-23000,
-23211,
-23822,
-24888,
-26400,
-28316,
-30501,
-32835,
-35140,
-37251,
-39028,
-40322,
-41047,
-41125,
-40540,
-39315,
-37555,
-35399,
-33080,
-30805,
-28835,
-27339,
-26469,
-26263,
-26709,
-27728,
-29205,
-31010,
-33015,
-35081,
-37090,
-38906,
-40417,
-41525,
-42185,
-42386,
-42214,
-41789,
-41281,
-40877,
-40734,
-40970,
-41632,
-42714,
-44114,
-45716,
-47325,
-48741,
-49758,
-50152,
-49772,
-48477,
-46239,
-43108,
-39223,
-34827,
-30209,
-25697,
-21601,
-18177,
-15621,
-13999,
-13320,
-13459,
-14257,
-15485,
-16917,
-18332,
-19553,
-20458,
-20987,
-21148,
-21010,
-20676,
-20296,
-19999,
-19941,
-20214,
-20908,
-22050,
-23626,
-25587,
-27840,
-30258,
-32695,
-34990,
-36975,
-38500,
-39440,
-39704,
-39285,
-38205,
-36593,
-34593,
-32426,
-30299,
-28425,
-26980,
-26095,
-25850,
-26262,
-27307,
-28898,
-30918,
-33213,
-35600,
-37906,
-39953,
-41612,
-42797,
-43489,
-43740,
-43645,
-43353,
-43019,
-42784,
-42788,
-43078,
-43717,
-44656,
-45845,
-47176,
-48498,
-49661,
-50478,
-50774,
-50392,
-49206,
-47157,
-44257,
-40596,
-36371,
-31820,
-27270,
-23019,
-19378,
-16569,
-14729,
-13894,
-13968,
-14795,
-16123,
-17707,
-19295,
-20694,
-21769,
-22462,
-22781,
-22794,
-22609,
-22340,
-22141,
-22105,
-22363,
-22970,
-23986,
-25413,
-27225,
-29345,
-31675,
-34051,
-36321,
-38283,
-39779,
-40653,
-40824,
-40254,
-39009,
-37198,
-35014,
-32672,
-30398,
-28403,
-26861,
-25884,
-25553,
-25863,
-26792,
-28260,
-30161,
-32358,
-34694,
-36995,
-39088,
-40823,
-42095,
-42841,
-43097,
-42943,
-42527,
-42037,
-41647,
-41519,
-41769,
-42434,
-43508,
-44899,
-46481,
-48074,
-49484,
-50489,
-50889,
-50500,
-49196,
-46920,
-43714,
-39715,
-35154,
-30354,
-25642,
-21380,
-17846,
-15252,
-13696,
-13147,
-13489,
-14508,
-15956,
-17578,
-19145,
-20483,
-21484,
-22112,
-22389,
-22383,
-22200,
-21947,
-21751,
-21727,
-21969,
-22579,
-23596,
-25059,
-26935,
-29154,
-31582,
-34065,
-36386,
-38375,
-39844,
-40661,
-40769,
-40140,
-38852,
-37010,
-34799,
-32410,
-30087,
-28039,
-26477,
-25545,
-25334,
-25846,
-27019,
-28730,
-30796,
-33057,
-35313,
-37423,
-39259,
-40721,
-41772,
-42375,
-42577,
-42437,
-42082,
-41658,
-41344,
-41288,
-41625,
-42394,
-43594,
-45107,
-46800,
-48436,
-49832,
-50732,
-50981,
-50413,
-48948,
-46574,
-43355,
-39438,
-35068,
-30520,
-26126,
-22183,
-18955,
-16604,
-15211,
-14729,
-15045,
-15967,
-17283,
-18771,
-20235,
-21518,
-22511,
-23157,
-23466,
-23469,
-23286,
-23009,
-22809,
-22788,
-23089,
-23766,
-24880,
-26405,
-28295,
-30453,
-32747,
-35030,
-37130,
-38891,
-40156,
-40822,
-40816,
-40138,
-38851,
-37079,
-34995,
-32809,
-30727,
-28947,
-27626,
-26863,
-26715,
-27170,
-28183,
-29661,
-31489,
-33540,
-35664,
-37722,
-39563,
-41077,
-42165,
-42802,
-42997,
-42845,
-42472,
-42056,
-41758,
-41735,
-42078,
-42827,
-43946,
-45343,
-46876,
-48362,
-49616,
-50431,
-50632,
-50064,
-48635,
-46315,
-43164,
-39337,
-35049,
-30594,
-26267,
-22358,
-19114,
-16687,
-15171,
-14534,
-14698,
-15494,
-16723,
-18170,
-19618,
-20893,
-21870,
-22489,
-22757,
-22750,
-22573,
-22353,
-22240,
-22311,
-22694,
-23418,
-24525,
-26020,
-27860,
-29983,
-32271,
-34579,
-36718,
-38516,
-39795,
-40437,
-40385,
-39647,
-38305,
-36496,
-34385,
-32167,
-30030,
-28152,
-26696,
-25773,
-25477,
-25819,
-26790,
-28301,
-30233,
-32437,
-34732,
-36952,
-38944,
-40568,
-41750,
-42440,
-42671,
-42517,
-42119,
-41643,
-41279,
-41181,
-41466,
-42181,
-43285,
-44697,
-46238,
-47753,
-49024,
-49892,
-50163,
-49717,
-48429,
-46259,
-43216,
-39393,
-35001,
-30288,
-25613,
-21305,
-17686,
-14993,
-13330,
-12718,
-13002,
-14010,
-15456,
-17107,
-18720,
-20126,
-21220,
-21936,
-22314,
-22370,
-22232,
-21991,
-21784,
-21754,
-22013,
-22666,
-23780,
-25347,
-27340,
-29635,
-32093,
-34531,
-36756,
-38594,
-39889,
-40540,
-40483,
-39741,
-38355,
-36482,
-34262,
-31944,
-29721,
-27835,
-26457,
-25711,
-25660,
-26279,
-27500,
-29194,
-31225,
-33429,
-35662,
-37774,
-39644,
-41151,
-42230,
-42837,
-42995,
-42801,
-42375,
-41914,
-41588,
-41556,
-41925,
-42726,
-43911,
-45395,
-47006,
-48592,
-49942,
-50876,
-51202,
-50761,
-49437,
-47173,
-44009,
-40081,
-35634,
-30969,
-26452,
-22409,
-19132,
-16795,
-15471,
-15107,
-15569,
-16647,
-18103,
-19705,
-21236,
-22532,
-23482,
-24037,
-24217,
-24085,
-23772,
-23409,
-23164,
-23167,
-23532,
-24327,
-25568,
-27232,
-29239,
-31491,
-33831,
-36128,
-38184,
-39868,
-41012,
-41522,
-41346,
-40477,
-39013,
-37067,
-34852,
-32560,
-30439,
-28665,
-27414,
-26771,
-26775,
-27400,
-28560,
-30154,
-32033,
-34074,
-36121,
-38066,
-39773,
-41162,
-42151,
-42710,
-42858,
-42656,
-42233,
-41746,
-41376,
-41279,
-41585,
-42329,
-43498,
-44976,
-46588,
-48138,
-49389,
-50130,
-50191,
-49421,
-47772,
-45236,
-41895,
-37923,
-33532,
-29015,
-24668,
-20773,
-17588,
-15257,
-13877,
-13406,
-13748,
-14716,
-16093,
-17636,
-19134,
-20382,
-21269,
-21730,
-21777,
-21519,
-21066,
-20627,
-20336,
-20366,
-20792,
-21671,
-22983,
-24681,
-26681,
-28881,
-31182,
-33442,
-35547,
-37332,
-38666,
-39416,
-39500,
-38887,
-37643,
-35875,
-33799,
-31618,
-29587,
-27896,
-26730,
-26179,
-26310,
-27093,
-28488,
-30367,
-32611,
-35021,
-37435,
-39631,
-41479,
-42829,
-43656,
-43975,
-43896,
-43579,
-43212,
-42988,
-43043,
-43492,
-44324,
-45515,
-46924,
-48405,
-49753,
-50776,
-51267,
-51055,
-50009,
-48053,
-45203,
-41551,
-37296,
-32705,
-28108,
-23840,
-20208,
-17434,
-15645,
-14838,
-14911,
-15661,
-16867,
-18258,
-19648,
-20838,
-21753,
-22332,
-22604,
-22621,
-22480,
-22293,
-22195,
-22303,
-22751,
-23610,
-24944,
-26728,
-28895,
-31313,
-33794,
-36141,
-38134,
-39601,
-40406,
-40478,
-39822,
-38504,
-36661,
-34471,
-32146,
-29912,
-27988,
-26563,
-25775,
-25707,
-26361,
-27676,
-29520,
-31723,
-34087,
-36416,
-38530,
-40283,
-41581,
-42378,
-42696,
-42610,
-42251,
-41790,
-41416,
-41294,
-41572,
-42291,
-43457,
-44944,
-46597,
-48188,
-49485,
-50259,
-50323,
-49519,
-47789,
-45105,
-41575,
-37350,
-32710,
-27961,
-23474,
-19573,
-16539,
-14531,
-13573,
-13591,
-14359,
-15649,
-17177,
-18698,
-20045,
-21073,
-21747,
-22065,
-22077,
-21891,
-21629,
-21447,
-21494,
-21913,
-22779,
-24156,
-25979,
-28188,
-30612,
-33094,
-35445,
-37484,
-39058,
-40031,
-40318,
-39881,
-38747,
-37018,
-34857,
-32498,
-30184,
-28180,
-26688,
-25856,
-25748,
-26346,
-27562,
-29271,
-31306,
-33507,
-35714,
-37766,
-39542,
-40932,
-41861,
-42335,
-42374,
-42111,
-41686,
-41300,
-41124,
-41318,
-41954,
-43042,
-44503,
-46168,
-47849,
-49290,
-50276,
-50586,
-50062,
-48604,
-46192,
-42894,
-38867,
-34364,
-29685,
-25187,
-21203,
-18005,
-15785,
-14597,
-14375,
-14968,
-16114,
-17586,
-19110,
-20522,
-21667,
-22489,
-22972,
-23147,
-23094,
-22906,
-22717,
-22659,
-22875,
-23473,
-24531,
-26054,
-28001,
-30251,
-32649,
-35009,
-37133,
-38849,
-40008,
-40496,
-40278,
-39351,
-37811,
-35803,
-33539,
-31263,
-29220,
-27626,
-26649,
-26351,
-26769,
-27802,
-29374,
-31308,
-33474,
-35693,
-37820,
-39706,
-41234,
-42313,
-42924,
-43089,
-42909,
-42543,
-42157,
-41949,
-42047,
-42547,
-43451,
-44711,
-46182,
-47718,
-49092,
-50116,
-50571,
-50295,
-49150,
-47081,
-44113,
-40364,
-36060,
-31479,
-26972,
-22861,
-19456,
-16958,
-15473,
-14987,
-15369,
-16417,
-17869,
-19465,
-20960,
-22190,
-23035,
-23485,
-23579,
-23413,
-23131,
-22867,
-22775,
-22966,
-23543,
-24548,
-26008,
-27877,
-30077,
-32480,
-34902,
-37165,
-39046,
-40386,
-41033,
-40933,
-40089,
-38598,
-36620,
-34362,
-32070,
-29952,
-28242,
-27063,
-26541,
-26697,
-27508,
-28904,
-30755,
-32901,
-35177,
-37377,
-39356,
-40943,
-42067,
-42675,
-42829,
-42616,
-42209,
-41790,
-41540,
-41610,
-42089,
-42982,
-44243,
-45743,
-47302,
-48747,
-49843,
-50409,
-50264,
-49251,
-47314,
-44423,
-40682,
-36281,
-31502,
-26707,
-22260,
-18513,
-15712,
-13999,
-13363,
-13665,
-14684,
-16129,
-17726,
-19249,
-20506,
-21435,
-21993,
-22232,
-22220,
-22066,
-21881,
-21803,
-21941,
-22433,
-23337,
-24738,
-26583,
-28836,
-31322,
-33883,
-36276,
-38311,
-39779,
-40570,
-40608,
-39912,
-38567,
-36711,
-34542,
-32272,
-30125,
-28312,
-27008,
-26334,
-26358,
-27067,
-28392,
-30213,
-32362,
-34661,
-36929,
-38994,
-40715,
-42001,
-42800,
-43123,
-43058,
-42717,
-42287,
-41938,
-41850,
-42135,
-42865,
-44002,
-45468,
-47095,
-48685,
-50020,
-50871,
-51037,
-50361,
-48720,
-46122,
-42613,
-38403,
-33758,
-29034,
-24594,
-20794,
-17873,
-16000,
-15170,
-15290,
-16157,
-17524,
-19130,
-20728,
-22129,
-23188,
-23847,
-24099,
-24016,
-23717,
-23359,
-23119,
-23155,
-23587,
-24491,
-25865,
-27665,
-29781,
-32084,
-34412,
-36602,
-38490,
-39924,
-40780,
-40975,
-40480,
-39336,
-37660,
-35609,
-33418,
-31284,
-29444,
-28048,
-27231,
-27046,
-27502,
-28552,
-30116,
-32060,
-34248,
-36491,
-38620,
-40463,
-41880,
-42800,
-43204,
-43163,
-42808,
-42319,
-41892,
-41710,
-41898,
-42529,
-43579,
-44973,
-46545,
-48118,
-49451,
-50345,
-50573,
-49975,
-48446,
-45941,
-42540,
-38415,
-33813,
-29097,
-24603,
-20680,
-17594,
-15493,
-14420,
-14281,
-14908,
-16056,
-17492,
-18972,
-20315,
-21374,
-22071,
-22391,
-22364,
-22095,
-21711,
-21376,
-21263,
-21502,
-22194,
-23383,
-25019,
-27047,
-29316,
-31682,
-33979,
-36019,
-37656,
-38731,
-39131,
-38804,
-37745,
-36045,
-33874,
-31437,
-29013,
-26842,
-25157,
-24106,
-23796,
-24211,
-25319,
-26989,
-29072,
-31400,
-33768,
-36015,
-37967,
-39513,
-40587,
-41179,
-41366,
-41250,
-40997,
-40774,
-40727,
-40992,
-41627,
-42637,
-43978,
-45518,
-47117,
-48567,
-49673,
-50216,
-50030,
-48958,
-46952,
-44016,
-40289,
-35988,
-31421,
-26950,
-22922,
-19649,
-17326,
-16032,
-15712,
-16192,
-17243,
-18575,
-19959,
-21176,
-22112,
-22702,
-22950,
-22923,
-22702,
-22413,
-22185,
-22140,
-22411,
-23072,
-24182,
-25738,
-27682,
-29910,
-32275,
-34611,
-36726,
-38466,
-39657,
-40207,
-40036,
-39153,
-37635,
-35609,
-33306,
-30934,
-28764,
-27012,
-25843,
-25377,
-25621,
-26551,
-28053,
-29999,
-32213,
-34528,
-36771,
-38771,
-40413,
-41583,
-42259,
-42461,
-42270,
-41857,
-41378,
-41058,
-41045,
-41472,
-42369,
-43691,
-45310,
-47017,
-48591,
-49758,
-50312,
-50056,
-48876,
-46738,
-43686,
-39853,
-35461,
-30785,
-26150,
-21887,
-18294,
-15598,
-13932,
-13293,
-13575,
-14576,
-16029,
-17660,
-19225,
-20529,
-21462,
-21996,
-22148,
-22027,
-21741,
-21459,
-21318,
-21474,
-22040,
-23079,
-24616,
-26587,
-28899,
-31383,
-33872,
-36156,
-38075,
-39459,
-40212,
-40254,
-39596,
-38266,
-36413,
-34185,
-31827,
-29571,
-27657,
-26292,
-25600,
-25659,
-26425,
-27829,
-29703,
-31886,
-34171,
-36396,
-38375,
-40006,
-41185,
-41900,
-42172,
-42096,
-41803,
-41462,
-41240,
-41286,
-41702,
-42529,
-43733,
-45220,
-46832,
-48373,
-49621,
-50352,
-50370,
-49517,
-47715,
-44963,
-41369,
-37131,
-32538,
-27917,
-23620,
-19953,
-17145,
-15337,
-14519,
-14619,
-15420,
-16719,
-18232,
-19757,
-21091,
-22125,
-22799,
-23124,
-23165,
-23014,
-22806,
-22672,
-22749,
-23152,
-23962,
-25220,
-26914,
-28971,
-31281,
-33670,
-35965,
-37965,
-39497,
-40425,
-40650,
-40167,
-39012,
-37314,
-35251,
-33027,
-30890,
-29035,
-27659,
-26873,
-26752,
-27281,
-28416,
-30040,
-32035,
-34226,
-36469,
-38565,
-40395,
-41805,
-42739,
-43180,
-43185,
-42892,
-42469,
-42120,
-42017,
-42299,
-43004,
-44125,
-45540,
-47096,
-48600,
-49829,
-50607,
-50733,
-50094,
-48581,
-46190,
-42962,
-39057,
-34683,
-30155,
-25791,
-21915,
-18807,
-16631,
-15474,
-15264,
-15876,
-17050,
-18570,
-20145,
-21588,
-22730,
-23483,
-23847,
-23858,
-23639,
-23317,
-23055,
-23010,
-23291,
-24023,
-25212,
-26884,
-28950,
-31303,
-33774,
-36165,
-38260,
-39857,
-40790,
-40950,
-40327,
-38981,
-37083,
-34839,
-32520,
-30371,
-28619,
-27438,
-26924,
-27116,
-27981,
-29426,
-31321,
-33485,
-35747,
-37891,
-39771,
-41235,
-42221,
-42721,
-42807,
-42591,
-42260,
-41969,
-41908,
-42188,
-42892,
-44001,
-45456,
-47080,
-48686,
-49998,
-50775,
-50773,
-49817,
-47823,
-44815,
-40928,
-36418,
-31600,
-26848,
-22526,
-18942,
-16322,
-14769,
-14264,
-14660,
-15749,
-17220,
-18823,
-20279,
-21427,
-22165,
-22486,
-22478,
-22250,
-21994,
-21849,
-21987,
-22513,
-23495,
-24960,
-26853,
-29103,
-31549,
-34031,
-36346,
-38294,
-39695,
-40404,
-40342,
-39506,
-37975,
-35914,
-33540,
-31131,
-28937,
-27218,
-26134,
-25801,
-26220,
-27339,
-29024,
-31114,
-33424,
-35753,
-37940,
-39807,
-41253,
-42199,
-42648,
-42659,
-42377,
-41973,
-41665,
-41632,
-42006,
-42846,
-44100,
-45654,
-47295,
-48811,
-49930,
-50454,
-50164,
-48955,
-46749,
-43597,
-39619,
-35069,
-30255,
-25566,
-21376,
-18008,
-15687,
-14483,
-14332,
-15030,
-16298,
-17826,
-19332,
-20604,
-21527,
-22066,
-22271,
-22253,
-22131,
-22059,
-22157,
-22540,
-23291,
-24455,
-26039,
-27993,
-30236,
-32617,
-34977,
-37114,
-38846,
-40003,
-40472,
-40201,
-39226,
-37652,
-35664,
-33489,
-31370,
-29540,
-28186,
-27432,
-27344,
-27901,
-29057,
-30688,
-32677,
-34850,
-37046,
-39090,
-40821,
-42122,
-42920,
-43236,
-43145,
-42822,
-42448,
-42238,
-42342,
-42866,
-43810,
-45113,
-46624,
-48156,
-49493,
-50403,
-50684,
-50136,
-48648,
-46157,
-42732,
-38543,
-33876,
-29106,
-24629,
-20814,
-17939,
-16144,
-15425,
-15633,
-16539,
-17852,
-19304,
-20660,
-21768,
-22526,
-22943,
-23033,
-22914,
-22682,
-22494,
-22483,
-22782,
-23499,
-24676,
-26333,
-28385,
-30730,
-33184,
-35552,
-37621,
-39183,
-40089,
-40223,
-39584,
-38224,
-36308,
-34041,
-31691,
-29497,
-27705,
-26461,
-25891,
-26002,
-26773,
-28108,
-29887,
-31950,
-34128,
-36243,
-38120,
-39632,
-40671,
-41229,
-41333,
-41122,
-40744,
-40410,
-40292,
-40532,
-41211,
-42312,
-43758,
-45385,
-46985,
-48320,
-49140,
-49230,
-48400,
-46564,
-43692,
-39901,
-35389,
-30476,
-25532,
-20964,
-17143,
-14342,
-12731,
-12285,
-12883,
-14238,
-16046,
-17945,
-19684,
-21030,
-21920,
-22338,
-22385,
-22189,
-21915,
-21730,
-21779,
-22196,
-23069,
-24447,
-26331,
-28638,
-31244,
-33948,
-36520,
-38728,
-40349,
-41239,
-41321,
-40607,
-39221,
-37312,
-35128,
-32895,
-30850,
-29203,
-28102,
-27645,
-27865,
-28730,
-30154,
-32005,
-34111,
-36295,
-38366,
-40159,
-41556,
-42461,
-42895,
-42896,
-42612,
-42203,
-41874,
-41797,
-42110,
-42873,
-44057,
-45555,
-47176,
-48695,
-49848,
-50410,
-50166,
-48990,
-46827,
-43718,
-39802,
-35316,
-30558,
-25888,
-21654,
-18173,
-15669,
-14253,
-13901,
-14459,
-15685,
-17277,
-18932,
-20399,
-21508,
-22171,
-22433,
-22362,
-22130,
-21893,
-21811,
-22023,
-22625,
-23670,
-25171,
-27086,
-29325,
-31763,
-34221,
-36509,
-38414,
-39759,
-40392,
-40249,
-39332,
-37739,
-35647,
-33288,
-30922,
-28817,
-27182,
-26193,
-25936,
-26415,
-27578,
-29298,
-31408,
-33727,
-36049,
-38190,
-39993,
-41332,
-42164,
-42496,
-42427,
-42107,
-41741,
-41532,
-41654,
-42213,
-43224,
-44616,
-46230,
-47859,
-49269,
-50228,
-50543,
-50041,
-48625,
-46249,
-42952,
-38877,
-34245,
-29392,
-24690,
-20524,
-17234,
-15022,
-13965,
-13966,
-14798,
-16158,
-17719,
-19205,
-20408,
-21245,
-21693,
-21830,
-21758,
-21601,
-21498,
-21560,
-21905,
-22617,
-23756,
-25345,
-27347,
-29661,
-32148,
-34594,
-36799,
-38541,
-39642,
-40013,
-39588,
-38472,
-36756,
-34682,
-32461,
-30359,
-28580,
-27317,
-26663,
-26684,
-27350,
-28600,
-30316,
-32355,
-34545,
-36711,
-38670,
-40288,
-41444,
-42120,
-42337,
-42214,
-41918,
-41635,
-41554,
-41810,
-42479,
-43555,
-44956,
-46536,
-48094,
-49417,
-50268,
-50442,
-49758,
-48113,
-45474,
-41942,
-37696,
-33048,
-28357,
-24001,
-20341,
-17603,
-15946,
-15324,
-15619,
-16590,
-17957,
-19457,
-20849,
-21976,
-22741,
-23141,
-23210,
-23059,
-22812,
-22614,
-22623,
-22957,
-23724,
-24973,
-26683,
-28806,
-31183,
-33674,
-36041,
-38102,
-39646,
-40524,
-40653,
-40003,
-38657,
-36755,
-34519,
-32198,
-30049,
-28309,
-27141,
-26664,
-26892,
-27791,
-29261,
-31155,
-33316,
-35545,
-37675,
-39521,
-40966,
-41910,
-42370,
-42385,
-42120,
-41733,
-41443,
-41408,
-41764,
-42546,
-43733,
-45213,
-46823,
-48358,
-49589,
-50293,
-50259,
-49328,
-47409,
-44503,
-40740,
-36329,
-31624,
-26969,
-22772,
-19338,
-16887,
-15514,
-15143,
-15625,
-16690,
-18079,
-19514,
-20800,
-21795,
-22451,
-22768,
-22832,
-22713,
-22565,
-22482,
-22607,
-23042,
-23871,
-25159,
-26888,
-29021,
-31405,
-33887,
-36214,
-38177,
-39558,
-40214,
-40084,
-39197,
-37669,
-35687,
-33477,
-31276,
-29300,
-27746,
-26741,
-26385,
-26695,
-27651,
-29165,
-31109,
-33301,
-35561,
-37670,
-39475,
-40823,
-41674,
-42021,
-41969,
-41662,
-41284,
-41045,
-41087,
-41555,
-42451,
-43760,
-45326,
-46978,
-48472,
-49567,
-50026,
-49659,
-48339,
-46013,
-42755,
-38689,
-34096,
-29274,
-24609,
-20456,
-17130,
-14832,
-13653,
-13524,
-14262,
-15604,
-17226,
-18852,
-20247,
-21270,
-21882,
-22112,
-22067,
-21871,
-21677,
-21616,
-21830,
-22410,
-23450,
-24976,
-26967,
-29338,
-31927,
-34513,
-36853,
-38694,
-39840,
-40184,
-39691,
-38465,
-36659,
-34506,
-32239,
-30100,
-28272,
-26930,
-26171,
-26069,
-26632,
-27827,
-29564,
-31690,
-34035,
-36367,
-38498,
-40246,
-41502,
-42246,
-42517,
-42453,
-42208,
-41990,
-41940,
-42222,
-42871,
-43913,
-45264,
-46797,
-48336,
-49663,
-50567,
-50813,
-50251,
-48740,
-46265,
-42892,
-38791,
-34249,
-29599,
-25209,
-21432,
-18521,
-16650,
-15816,
-15927,
-16761,
-18057,
-19533,
-20947,
-22120,
-22948,
-23419,
-23564,
-23492,
-23320,
-23205,
-23278,
-23686,
-24506,
-25800,
-27544,
-29661,
-32015,
-34425,
-36685,
-38609,
-40018,
-40806,
-40899,
-40316,
-39102,
-37403,
-35369,
-33216,
-31153,
-29395,
-28121,
-27464,
-27493,
-28204,
-29527,
-31329,
-33441,
-35660,
-37796,
-39666,
-41137,
-42139,
-42657,
-42758,
-42568,
-42240,
-41975,
-41917,
-42211,
-42899,
-43980,
-45360,
-46894,
-48381,
-49594,
-50302,
-50295,
-49403,
-47544,
-44705,
-41004,
-36659,
-31961,
-27300,
-23021,
-19473,
-16879,
-15348,
-14860,
-15256,
-16297,
-17695,
-19172,
-20488,
-21501,
-22117,
-22376,
-22329,
-22121,
-21877,
-21749,
-21855,
-22302,
-23147,
-24433,
-26125,
-28188,
-30484,
-32886,
-35173,
-37154,
-38599,
-39354,
-39298,
-38432,
-36831,
-34688,
-32257,
-29822,
-27683,
-26050,
-25113,
-24925,
-25482,
-26714,
-28469,
-30605,
-32930,
-35265,
-37436,
-39285,
-40703,
-41623,
-42068,
-42116,
-41927,
-41694,
-41622,
-41874,
-42556,
-43678,
-45149,
-46812,
-48412,
-49708,
-50415,
-50329,
-49279,
-47210,
-44167,
-40310,
-35916,
-31319,
-26909,
-23035,
-19995,
-17956,
-16960,
-16907,
-17588,
-18742,
-20071,
-21333,
-22335,
-22979,
-23254,
-23218,
-22990,
-22718,
-22559,
-22661,
-23140,
-24079,
-25500,
-27374,
-29605,
-32034,
-34474,
-36685,
-38463,
-39612,
-40008,
-39622,
-38488,
-36762,
-34635,
-32364,
-30200,
-28386,
-27109,
-26505,
-26630,
-27473,
-28949,
-30907,
-33160,
-35483,
-37666,
-39515,
-40905,
-41774,
-42151,
-42129,
-41872,
-41564,
-41392,
-41523,
-42056,
-43037,
-44417,
-46069,
-47791,
-49326,
-50371,
-50660,
-49943,
-48103,
-45115,
-41133,
-36413,
-31347,
-26361,
-21876,
-18255,
-15717,
-14351,
-14089,
-14726,
-15986,
-17550,
-19112,
-20454,
-21408,
-21950,
-22098,
-21979,
-21734,
-21530,
-21543,
-21893,
-22713,
-24023,
-25854,
-28095,
-30638,
-33248,
-35713,
-37754,
-39179,
-39814,
-39607,
-38609,
-36939,
-34837,
-32528,
-30294,
-28356,
-26910,
-26085,
-25944,
-26511,
-27715,
-29473,
-31612,
-33958,
-36288,
-38404,
-40118,
-41318,
-41971,
-42125,
-41937,
-41590,
-41333,
-41345,
-41795,
-42707,
-44041,
-45636,
-47270,
-48682,
-49611,
-49830,
-49170,
-47551,
-44959,
-41491,
-37319,
-32711,
-27989,
-23520,
-19649,
-16677,
-14783,
-14022,
-14288,
-15360,
-16919,
-18637,
-20215,
-21443,
-22218,
-22554,
-22533,
-22323,
-22079,
-21983,
-22175,
-22759,
-23821,
-25351,
-27344,
-29666,
-32186,
-34670,
-36903,
-38632,
-39697,
-39956,
-39413,
-38118,
-36257,
-34036,
-31731,
-29596,
-27873,
-26748,
-26342,
-26699,
-27782,
-29483,
-31627,
-33998,
-36371,
-38524,
-40279,
-41534,
-42247,
-42475,
-42337,
-42008,
-41684,
-41565,
-41790,
-42464,
-43574,
-45060,
-46733,
-48382,
-49711,
-50458,
-50364,
-49263,
-47076,
-43872,
-39817,
-35219,
-30442,
-25879,
-21910,
-18807,
-16754,
-15771,
-15773,
-16542,
-17820,
-19314,
-20763,
-21968,
-22803,
-23237,
-23318,
-23149,
-22903,
-22728,
-22824,
-23298,
-24265,
-25733,
-27674,
-29959,
-32442,
-34888,
-37106,
-38860,
-39997,
-40398,
-40035,
-38956,
-37291,
-35239,
-33022,
-30914,
-29110,
-27841,
-27195,
-27265,
-28013,
-29382,
-31228,
-33388,
-35665,
-37856,
-39774,
-41275,
-42271,
-42759,
-42821,
-42595,
-42294,
-42106,
-42221,
-42723,
-43661,
-44934,
-46435,
-47934,
-49235,
-50086,
-50287,
-49659,
-48078,
-45510,
-42016,
-37771,
-33072,
-28287,
-23836,
-20099,
-17364,
-15777,
-15311,
-15784,
-16921,
-18381,
-19861,
-21129,
-22043,
-22583,
-22787,
-22765,
-22635,
-22531,
-22570,
-22869,
-23513,
-24592,
-26119,
-28104,
-30430,
-32960,
-35461,
-37671,
-39350,
-40274,
-40334,
-39513,
-37917,
-35746,
-33286,
-30819,
-28659,
-27022,
-26089,
-25933,
-26549,
-27868,
-29739,
-31991,
-34405,
-36767,
-38877,
-40563,
-41719,
-42322,
-42415,
-42156,
-41725,
-41363,
-41282,
-41634,
-42500,
-43843,
-45517,
-47323,
-48957,
-50151,
-50618,
-50154,
-48634,
-46036,
-42477,
-38149,
-33384,
-28538,
-24010,
-20151,
-17237,
-15406,
-14681,
-14910,
-15885,
-17279,
-18819,
-20223,
-21323,
-22029,
-22350,
-22369,
-22218,
-22060,
-22042,
-22318,
-22984,
-24108,
-25715,
-27741,
-30105,
-32621,
-35094,
-37288,
-38976,
-39993,
-40215,
-39652,
-38366,
-36542,
-34405,
-32206,
-30198,
-28592,
-27541,
-27154,
-27444,
-28399,
-29919,
-31888,
-34115,
-36419,
-38575,
-40414,
-41783,
-42624,
-42962,
-42896,
-42626,
-42337,
-42260,
-42531,
-43240,
-44374,
-45827,
-47443,
-48985,
-50239,
-50943,
-50906,
-49953,
-47994,
-45043,
-41201,
-36716,
-31914,
-27194,
-22969,
-19584,
-17272,
-16126,
-16048,
-16838,
-18173,
-19731,
-21213,
-22413,
-23211,
-23617,
-23685,
-23558,
-23363,
-23261,
-23367,
-23802,
-24637,
-25926,
-27663,
-29799,
-32201,
-34706,
-37057,
-39044,
-40403,
-41001,
-40742,
-39661,
-37904,
-35675,
-33253,
-30924,
-28937,
-27513,
-26784,
-26814,
-27586,
-29017,
-30952,
-33201,
-35546,
-37756,
-39644,
-41068,
-41948,
-42320,
-42257,
-41932,
-41537,
-41265,
-41291,
-41730,
-42611,
-43903,
-45457,
-47084,
-48516,
-49478,
-49698,
-48964,
-47147,
-44255,
-40406,
-35872,
-30993,
-26179,
-21819,
-18251,
-15689,
-14233,
-13818,
-14291,
-15387,
-16823,
-18311,
-19610,
-20566,
-21095,
-21221,
-21029,
-20671,
-20324,
-20172,
-20381,
-21071,
-22298,
-24055,
-26251,
-28733,
-31304,
-33719,
-35774,
-37254,
-38048,
-38087,
-37402,
-36098,
-34339,
-32334,
-30309,
-28487,
-27062,
-26193,
-25972,
-26446,
-27567,
-29265,
-31361,
-33689,
-36029,
-38179,
-39985,
-41314,
-42152,
-42517,
-42541,
-42379,
-42224,
-42265,
-42637,
-43415,
-44593,
-46072,
-47678,
-49192,
-50348,
-50893,
-50608,
-49325,
-46978,
-43614,
-39395,
-34610,
-29636,
-24887,
-20778,
-17625,
-15624,
-14811,
-15047,
-16082,
-17582,
-19210,
-20682,
-21801,
-22478,
-22730,
-22644,
-22360,
-22039,
-21839,
-21916,
-22381,
-23339,
-24809,
-26786,
-29163,
-31780,
-34409,
-36794,
-38675,
-39846,
-40160,
-39601,
-38226,
-36234,
-33853,
-31395,
-29134,
-27334,
-26178,
-25781,
-26154,
-27249,
-28929,
-31021,
-33324,
-35626,
-37735,
-39492,
-40788,
-41586,
-41911,
-41863,
-41594,
-41300,
-41169,
-41380,
-42032,
-43156,
-44674,
-46429,
-48146,
-49568,
-50348,
-50268,
-49113,
-46848,
-43518,
-39332,
-34583,
-29648,
-24911,
-20753,
-17439,
-15183,
-14011,
-13872,
-14571,
-15852,
-17421,
-18986,
-20320,
-21263,
-21774,
-21885,
-21734,
-21480,
-21325,
-21436,
-21955,
-22955,
-24463,
-26419,
-28733,
-31235,
-33741,
-36033,
-37907,
-39169,
-39717,
-39462,
-38480,
-36840,
-34766,
-32455,
-30181,
-28172,
-26655,
-25786,
-25677,
-26347,
-27752,
-29749,
-32142,
-34679,
-37107,
-39191,
-40764,
-41756,
-42182,
-42170,
-41897,
-41566,
-41394,
-41522,
-42049,
-43001,
-44297,
-45839,
-47423,
-48843,
-49848,
-50198,
-49693,
-48178,
-45611,
-42068,
-37739,
-32956,
-28103,
-23609,
-19854,
-17112,
-15528,
-15063,
-15556,
-16738,
-18273,
-19884,
-21293,
-22379,
-23050,
-23354,
-23348,
-23180,
-22966,
-22885,
-23054,
-23623,
-24673,
-26249,
-28319,
-30768,
-33402,
-35979,
-38210,
-39874,
-40748,
-40779,
-39955,
-38421,
-36377,
-34082,
-31815,
-29816,
-28313,
-27424,
-27246,
-27775,
-28951,
-30670,
-32760,
-35038,
-37288,
-39314,
-40943,
-42067,
-42651,
-42754,
-42507,
-42112,
-41786,
-41729,
-42088,
-42922,
-44188,
-45765,
-47434,
-48972,
-50096,
-50594,
-50257,
-48974,
-46717,
-43538,
-39619,
-35196,
-30606,
-26192,
-22302,
-19217,
-17116,
-16066,
-15988,
-16697,
-17933,
-19383,
-20793,
-21920,
-22669,
-23014,
-23034,
-22896,
-22764,
-22841,
-23259,
-24128,
-25466,
-27259,
-29407,
-31788,
-34223,
-36507,
-38430,
-39779,
-40405,
-40205,
-39213,
-37527,
-35393,
-33064,
-30870,
-29062,
-27860,
-27371,
-27629,
-28570,
-30093,
-32024,
-34195,
-36398,
-38454,
-40183,
-41466,
-42244,
-42534,
-42458,
-42183,
-41938,
-41924,
-42312,
-43172,
-44488,
-46109,
-47829,
-49345,
-50363,
-50594,
-49827,
-47934,
-44952,
-41010,
-36409,
-31515,
-26742,
-22502,
-19111,
-16779,
-15563,
-15372,
-16005,
-17177,
-18581,
-19941,
-21046,
-21777,
-22118,
-22142,
-21978,
-21803,
-21788,
-22082,
-22807,
-24006,
-25697,
-27800,
-30210,
-32738,
-35172,
-37268,
-38801,
-39590,
-39537,
-38642,
-37034,
-34905,
-32551,
-30260,
-28299,
-26916,
-26224,
-26322,
-27170,
-28693,
-30733,
-33093,
-35544,
-37846,
-39796,
-41229,
-42097,
-42403,
-42303,
-41954,
-41619,
-41484,
-41748,
-42477,
-43688,
-45258,
-46999,
-48642,
-49866,
-50376,
-49889,
-48248,
-45408,
-41491,
-36768,
-31640,
-26571,
-22012,
-18363,
-15847,
-14561,
-14401,
-15143,
-16470,
-18048,
-19570,
-20826,
-21680,
-22139,
-22250,
-22157,
-22010,
-21974,
-22199,
-22807,
-23879,
-25451,
-27488,
-29896,
-32493,
-35054,
-37311,
-39012,
-39950,
-40021,
-39214,
-37668,
-35569,
-33227,
-30903,
-28899,
-27430,
-26655,
-26661,
-27443,
-28922,
-30954,
-33331,
-35811,
-38156,
-40146,
-41627,
-42544,
-42906,
-42855,
-42556,
-42239,
-42115,
-42349,
-43045,
-44199,
-45718,
-47399,
-48984,
-50161,
-50636,
-50164,
-48604,
-45933,
-42293,
-37915,
-33177,
-28459,
-24169,
-20639,
-18093,
-16631,
-16214,
-16670,
-17761,
-19182,
-20644,
-21918,
-22831,
-23335,
-23450,
-23294,
-23024,
-22829,
-22892,
-23362,
-24339,
-25854,
-27859,
-30231,
-32775,
-35246,
-37396,
-38977,
-39831,
-39855,
-39073,
-37600,
-35620,
-33398,
-31180,
-29235,
-27755,
-26910,
-26770,
-27358,
-28613,
-30411,
-32580,
-34904,
-37162,
-39128,
-40648,
-41607,
-42019,
-41958,
-41624,
-41229,
-41026,
-41204,
-41870,
-43030,
-44555,
-46235,
-47790,
-48931,
-49398,
-48980,
-47564,
-45127,
-41739,
-37598,
-32963,
-28195,
-23684,
-19804,
-16870,
-15059,
-14394,
-14734,
-15788,
-17226,
-18672,
-19873,
-20642,
-20964,
-20899,
-20616,
-20293,
-20109,
-20235,
-20761,
-21789,
-23305,
-25307,
-27668,
-30259,
-32848,
-35207,
-37093,
-38308,
-38726,
-38329,
-37173,
-35442,
-33347,
-31170,
-29169,
-27591,
-26621,
-26385,
-26924,
-28199,
-30099,
-32433,
-34988,
-37496,
-39741,
-41515,
-42718,
-43327,
-43436,
-43209,
-42885,
-42690,
-42829,
-43419,
-44480,
-45915,
-47557,
-49146,
-50435,
-51132,
-51027,
-49929,
-47763,
-44551,
-40436,
-35700,
-30719,
-25939,
-21794,
-18634,
-16667,
-15913,
-16211,
-17267,
-18717,
-20206,
-21463,
-22320,
-22745,
-22790,
-22592,
-22303,
-22093,
-22120,
-22508,
-23372,
-24749,
-26650,
-28978,
-31580,
-34229,
-36649,
-38592,
-39822,
-40217,
-39736,
-38472,
-36590,
-34352,
-32022,
-29894,
-28201,
-27133,
-26812,
-27253,
-28428,
-30196,
-32385,
-34763,
-37095,
-39147,
-40760,
-41817,
-42329,
-42370,
-42119,
-41785,
-41596,
-41739,
-42326,
-43395,
-44854,
-46563,
-48277,
-49729,
-50643,
-50743,
-49843,
-47813,
-44674,
-40559,
-35764,
-30667,
-25738,
-21408,
-18047,
-15880,
-14942,
-15119,
-16131,
-17634,
-19273,
-20735,
-21823,
-22444,
-22623,
-22480,
-22173,
-21912,
-21861,
-22189,
-22993,
-24327,
-26176,
-28460,
-31036,
-33682,
-36181,
-38235,
-39662,
-40243,
-39952,
-38793,
-36955,
-34655,
-32218,
-29930,
-28085,
-26875,
-26433,
-26779,
-27872,
-29571,
-31708,
-34054,
-36383,
-38476,
-40151,
-41318,
-41936,
-42099,
-41944,
-41676,
-41508,
-41616,
-42121,
-43064,
-44391,
-45971,
-47600,
-49031,
-49988,
-50211,
-49474,
-47653,
-44725,
-40828,
-36225,
-31294,
-26486,
-22220,
-18864,
-16624,
-15557,
-15558,
-16375,
-17710,
-19225,
-20639,
-21758,
-22476,
-22800,
-22827,
-22686,
-22561,
-22614,
-22984,
-23785,
-25059,
-26796,
-28927,
-31315,
-33763,
-36070,
-37981,
-39316,
-39914,
-39724,
-38775,
-37200,
-35198,
-33019,
-30916,
-29133,
-27854,
-27225,
-27303,
-28092,
-29516,
-31441,
-33677,
-36003,
-38184,
-40030,
-41381,
-42196,
-42489,
-42404,
-42107,
-41840,
-41785,
-42129,
-42927,
-44185,
-45765,
-47470,
-49013,
-50098,
-50419,
-49755,
-47968,
-45063,
-41189,
-36616,
-31732,
-26947,
-22680,
-19261,
-16903,
-15683,
-15509,
-16182,
-17415,
-18881,
-20305,
-21455,
-22220,
-22586,
-22623,
-22483,
-22329,
-22339,
-22659,
-23390,
-24594,
-26258,
-28332,
-30681,
-33147,
-35494,
-37512,
-38961,
-39693,
-39605,
-38719,
-37137,
-35068,
-32761,
-30497,
-28544,
-27121,
-26386,
-26430,
-27236,
-28738,
-30770,
-33121,
-35558,
-37813,
-39703,
-41066,
-41853,
-42122,
-41984,
-41654,
-41346,
-41259,
-41571,
-42339,
-43571,
-45138,
-46856,
-48446,
-49622,
-50072,
-49563,
-47926,
-45140,
-41317,
-36721,
-31731,
-26785,
-22336,
-18749,
-16284,
-15016,
-14865,
-15605,
-16911,
-18454,
-19912,
-21073,
-21814,
-22134,
-22106,
-21886,
-21613,
-21487,
-21619,
-22162,
-23164,
-24679,
-26657,
-29019,
-31573,
-34112,
-36366,
-38080,
-39057,
-39165,
-38409,
-36888,
-34814,
-32449,
-30106,
-28049,
-26527,
-25705,
-25656,
-26410,
-27861,
-29892,
-32282,
-34804,
-37200,
-39253,
-40782,
-41714,
-42053,
-41927,
-41526,
-41102,
-40895,
-41097,
-41823,
-43058,
-44701,
-46510,
-48225,
-49496,
-50050,
-49618,
-48074,
-45386,
-41677,
-37191,
-32281,
-27361,
-22844,
-19102,
-16379,
-14798,
-14323,
-14774,
-15903,
-17383,
-18926,
-20287,
-21305,
-21917,
-22149,
-22094,
-21908,
-21765,
-21848,
-22316,
-23277,
-24792,
-26811,
-29239,
-31861,
-34451,
-36729,
-38471,
-39490,
-39692,
-39092,
-37783,
-35949,
-33823,
-31653,
-29701,
-28179,
-27270,
-27080,
-27634,
-28900,
-30727,
-32948,
-35315,
-37603,
-39596,
-41140,
-42162,
-42658,
-42739,
-42538,
-42272,
-42135,
-42315,
-42928,
-44017,
-45497,
-47219,
-48886,
-50221,
-50868,
-50595,
-49211,
-46711,
-43190,
-38922,
-34234,
-29539,
-25212,
-21591,
-18904,
-17266,
-16663,
-16959,
-17935,
-19300,
-20773,
-22082,
-23058,
-23595,
-23726,
-23554,
-23253,
-23031,
-23073,
-23531,
-24498,
-25988,
-27950,
-30274,
-32768,
-35247,
-37452,
-39173,
-40230,
-40487,
-39950,
-38673,
-36837,
-34679,
-32447,
-30423,
-28799,
-27772,
-27417,
-27784,
-28841,
-30492,
-32591,
-34933,
-37273,
-39387,
-41056,
-42159,
-42662,
-42652,
-42302,
-41861,
-41554,
-41614,
-42127,
-43138,
-44538,
-46144,
-47725,
-48976,
-49652,
-49496,
-48353,
-46144,
-42916,
-38837,
-34193,
-29343,
-24712,
-20670,
-17558,
-15543,
-14684,
-14860,
-15834,
-17287,
-18878,
-20296,
-21332,
-21862,
-21916,
-21611,
-21153,
-20783,
-20734,
-21181,
-22237,
-23900,
-26086,
-28625,
-31280,
-33799,
-35921,
-37438,
-38194,
-38128,
-37272,
-35752,
-33779,
-31613,
-29547,
-27848,
-26750,
-26397,
-26847,
-28049,
-29874,
-32115,
-34523,
-36856,
-38884,
-40467,
-41524,
-42086,
-42256,
-42213,
-42147,
-42265,
-42702,
-43556,
-44808,
-46371,
-48065,
-49637,
-50810,
-51277,
-50793,
-49170,
-46364,
-42481,
-37776,
-32668,
-27615,
-23118,
-19568,
-17216,
-16119,
-16153,
-17034,
-18421,
-19944,
-21317,
-22341,
-22949,
-23151,
-23076,
-22853,
-22691,
-22734,
-23170,
-24082,
-25557,
-27541,
-29948,
-32561,
-35140,
-37391,
-39052,
-39928,
-39908,
-39019,
-37371,
-35207,
-32793,
-30455,
-28478,
-27117,
-26535,
-26809,
-27897,
-29681,
-31931,
-34404,
-36820,
-38937,
-40591,
-41675,
-42216,
-42305,
-42121,
-41874,
-41787,
-42030,
-42730,
-43883,
-45412,
-47111,
-48719,
-49898,
-50357,
-49809,
-48118,
-45242,
-41318,
-36628,
-31548,
-26554,
-22078,
-18507,
-16087,
-14890,
-14821,
-15642,
-17018,
-18597,
-20065,
-21203,
-21902,
-22174,
-22125,
-21908,
-21732,
-21771,
-22199,
-23131,
-24622,
-26658,
-29114,
-31816,
-34484,
-36840,
-38600,
-39546,
-39576,
-38695,
-37042,
-34853,
-32428,
-30075,
-28101,
-26729,
-26132,
-26371,
-27425,
-29167,
-31411,
-33889,
-36352,
-38525,
-40239,
-41372,
-41930,
-42014,
-41796,
-41500,
-41344,
-41530,
-42154,
-43264,
-44754,
-46458,
-48100,
-49361,
-49930,
-49514,
-47963,
-45210,
-41403,
-36788,
-31789,
-26830,
-22400,
-18845,
-16436,
-15236,
-15159,
-15967,
-17334,
-18899,
-20358,
-21476,
-22154,
-22404,
-22330,
-22124,
-21960,
-22046,
-22513,
-23466,
-24940,
-26900,
-29251,
-31817,
-34374,
-36656,
-38403,
-39399,
-39518,
-38750,
-37223,
-35150,
-32838,
-30589,
-28699,
-27381,
-26791,
-26964,
-27903,
-29490,
-31577,
-33949,
-36362,
-38573,
-40367,
-41607,
-42247,
-42372,
-42142,
-41813,
-41611,
-41766,
-42385,
-43486,
-44981,
-46656,
-48267,
-49498,
-50062,
-49714,
-48275,
-45710,
-42101,
-37692,
-32842,
-27993,
-23592,
-20023,
-17553,
-16260,
-16079,
-16773,
-18039,
-19535,
-20956,
-22100,
-22830,
-23167,
-23170,
-23008,
-22851,
-22895,
-23304,
-24194,
-25624,
-27557,
-29892,
-32438,
-34960,
-37190,
-38884,
-39838,
-39955,
-39224,
-37753,
-35754,
-33483,
-31257,
-29344,
-27990,
-27346,
-27480,
-28369,
-29900,
-31907,
-34175,
-36475,
-38591,
-40336,
-41595,
-42321,
-42572,
-42468,
-42213,
-42024,
-42101,
-42604,
-43564,
-44948,
-46570,
-48192,
-49495,
-50179,
-49953,
-48647,
-46175,
-42635,
-38241,
-33359,
-28427,
-23908,
-20208,
-17614,
-16235,
-16008,
-16706,
-17994,
-19523,
-20956,
-22077,
-22762,
-23022,
-22956,
-22715,
-22500,
-22485,
-22840,
-23688,
-25078,
-27013,
-29372,
-31991,
-34607,
-36946,
-38740,
-39764,
-39916,
-39172,
-37653,
-35567,
-33176,
-30787,
-28697,
-27145,
-26332,
-26346,
-27191,
-28777,
-30912,
-33361,
-35847,
-38113,
-39959,
-41253,
-41978,
-42205,
-42086,
-41829,
-41648,
-41743,
-42252,
-43233,
-44630,
-46307,
-47994,
-49417,
-50206,
-50108,
-48866,
-46426,
-42843,
-38352,
-33323,
-28203,
-23474,
-19548,
-16734,
-15166,
-14796,
-15425,
-16716,
-18305,
-19850,
-21069,
-21857,
-22168,
-22142,
-21934,
-21767,
-21823,
-22279,
-23213,
-24680,
-26641,
-28996,
-31591,
-34200,
-36571,
-38451,
-39606,
-39911,
-39308,
-37906,
-35885,
-33534,
-31160,
-29079,
-27540,
-26730,
-26738,
-27550,
-29089,
-31160,
-33560,
-36004,
-38270,
-40120,
-41441,
-42181,
-42416,
-42299,
-42037,
-41873,
-41992,
-42549,
-43566,
-45009,
-46690,
-48388,
-49784,
-50572,
-50467,
-49268,
-46896,
-43435,
-39107,
-34292,
-29417,
-24952,
-21273,
-18656,
-17201,
-16843,
-17383,
-18516,
-19923,
-21301,
-22418,
-23162,
-23499,
-23518,
-23354,
-23191,
-23213,
-23584,
-24406,
-25749,
-27574,
-29809,
-32287,
-34795,
-37101,
-38953,
-40140,
-40532,
-40062,
-38812,
-36936,
-34690,
-32366,
-30275,
-28671,
-27757,
-27641,
-28318,
-29722,
-31674,
-33969,
-36338,
-38551,
-40367,
-41674,
-42384,
-42578,
-42374,
-42015,
-41713,
-41710,
-42143,
-43071,
-44446,
-46101,
-47791,
-49229,
-50078,
-50082,
-48997,
-46752,
-43368,
-39065,
-34164,
-29124,
-24409,
-20445,
-17557,
-15867,
-15352,
-15805,
-16915,
-18351,
-19779,
-20979,
-21804,
-22222,
-22296,
-22132,
-21900,
-21770,
-21915,
-22486,
-23587,
-25231,
-27381,
-29861,
-32457,
-34883,
-36852,
-38133,
-38571,
-38120,
-36872,
-34982,
-32725,
-30368,
-28213,
-26500,
-25436,
-25127,
-25620,
-26853,
-28701,
-30955,
-33375,
-35689,
-37679,
-39146,
-40037,
-40357,
-40262,
-39959,
-39713,
-39756,
-40274,
-41322,
-42850,
-44680,
-46537,
-48113,
-49075,
-49155,
-48151,
-45993,
-42718,
-38539,
-33758,
-28803,
-24139,
-20191,
-17318,
-15692,
-15321,
-16002,
-17421,
-19165,
-20876,
-22253,
-23154,
-23568,
-23596,
-23422,
-23236,
-23220,
-23519,
-24233,
-25406,
-27049,
-29095,
-31429,
-33868,
-36168,
-38070,
-39343,
-39798,
-39391,
-38152,
-36272,
-33987,
-31617,
-29456,
-27774,
-26770,
-26556,
-27152,
-28490,
-30411,
-32700,
-35101,
-37366,
-39260,
-40660,
-41484,
-41802,
-41724,
-41460,
-41218,
-41215,
-41600,
-42455,
-43756,
-45388,
-47115,
-48660,
-49669,
-49846,
-48931,
-46804,
-43494,
-39194,
-34260,
-29121,
-24275,
-20139,
-17053,
-15180,
-14509,
-14872,
-15980,
-17475,
-19027,
-20346,
-21268,
-21744,
-21826,
-21670,
-21457,
-21395,
-21657,
-22380,
-23631,
-25418,
-27673,
-30245,
-32944,
-35491,
-37636,
-39104,
-39731,
-39418,
-38230,
-36319,
-33967,
-31493,
-29216,
-27441,
-26349,
-26080,
-26640,
-27959,
-29899,
-32237,
-34746,
-37151,
-39232,
-40799,
-41766,
-42146,
-42058,
-41714,
-41349,
-41219,
-41496,
-42286,
-43565,
-45198,
-46963,
-48546,
-49644,
-49917,
-49147,
-47174,
-44014,
-39832,
-34939,
-29771,
-24808,
-20505,
-17225,
-15165,
-14351,
-14618,
-15696,
-17215,
-18838,
-20267,
-21309,
-21904,
-22070,
-21952,
-21716,
-21574,
-21723,
-22317,
-23459,
-25176,
-27397,
-29989,
-32722,
-35337,
-37556,
-39121,
-39866,
-39695,
-38668,
-36919,
-34718,
-32350,
-30147,
-28375,
-27262,
-26918,
-27382,
-28582,
-30387,
-32599,
-34995,
-37331,
-39390,
-40998,
-42045,
-42531,
-42535,
-42249,
-41898,
-41742,
-41971,
-42716,
-43962,
-45580,
-47340,
-48913,
-49994,
-50261,
-49515,
-47625,
-44641,
-40698,
-36115,
-31248,
-26551,
-22420,
-19210,
-17121,
-16195,
-16329,
-17239,
-18638,
-20137,
-21498,
-22487,
-23066,
-23252,
-23172,
-22996,
-22913,
-23089,
-23679,
-24752,
-26352,
-28414,
-30821,
-33375,
-35827,
-37928,
-39423,
-40157,
-40025,
-39081,
-37440,
-35331,
-33041,
-30849,
-29062,
-27882,
-27482,
-27890,
-29078,
-30882,
-33100,
-35468,
-37724,
-39658,
-41102,
-42012,
-42407,
-42416,
-42219,
-42031,
-42070,
-42500,
-43423,
-44807,
-46526,
-48307,
-49814,
-50663,
-50504,
-49113,
-46406,
-42535,
-37789,
-32653,
-27622,
-23201,
-19768,
-17534,
-16531,
-16612,
-17496,
-18852,
-20333,
-21655,
-22638,
-23194,
-23360,
-23256,
-23055,
-22966,
-23183,
-23860,
-25089,
-26885,
-29157,
-31745,
-34404,
-36842,
-38790,
-39977,
-40271,
-39619,
-38128,
-36012,
-33589,
-31194,
-29180,
-27794,
-27221,
-27496,
-28574,
-30293,
-32448,
-34791,
-37077,
-39087,
-40662,
-41707,
-42223,
-42306,
-42111,
-41878,
-41816,
-42136,
-42929,
-44203,
-45826,
-47550,
-49067,
-50009,
-50061,
-48975,
-46640,
-43121,
-38627,
-33565,
-28391,
-23636,
-19743,
-17028,
-15621,
-15430,
-16202,
-17552,
-19086,
-20452,
-21425,
-21941,
-22039,
-21898,
-21719,
-21696,
-22034,
-22811,
-24131,
-25948,
-28220,
-30782,
-33439,
-35927,
-37959,
-39303,
-39751,
-39273,
-37916,
-35895,
-33510,
-31089,
-28993,
-27473,
-26744,
-26873,
-27849,
-29542,
-31753,
-34214,
-36654,
-38796,
-40458,
-41523,
-42014,
-42062,
-41864,
-41690,
-41745,
-42211,
-43125,
-44467,
-46061,
-47701,
-49101,
-49967,
-50029,
-49063,
-46946,
-43683,
-39448,
-34549,
-29447,
-24631,
-20583,
-17659,
-16029,
-15656,
-16316,
-17648,
-19254,
-20780,
-21964,
-22694,
-22975,
-22931,
-22736,
-22608,
-22737,
-23300,
-24393,
-26067,
-28253,
-30814,
-33519,
-36083,
-38207,
-39648,
-40220,
-39889,
-38725,
-36919,
-34745,
-32506,
-30497,
-28983,
-28139,
-28079,
-28807,
-30241,
-32223,
-34514,
-36865,
-39003,
-40736,
-41908,
-42526,
-42646,
-42459,
-42184,
-42054,
-42274,
-42946,
-44100,
-45615,
-47299,
-48847,
-49930,
-50222,
-49455,
-47492,
-44337,
-40185,
-35375,
-30368,
-25651,
-21692,
-18793,
-17138,
-16662,
-17173,
-18338,
-19784,
-21173,
-22243,
-22868,
-23045,
-22882,
-22574,
-22335,
-22387,
-22894,
-23968,
-25611,
-27769,
-30269,
-32898,
-35387,
-37457,
-38879,
-39466,
-39168,
-38005,
-36168,
-33895,
-31516,
-29359,
-27713,
-26801,
-26729,
-27502,
-29003,
-31050,
-33383,
-35746,
-37883,
-39603,
-40764,
-41359,
-41429,
-41155,
-40751,
-40458,
-40526,
-41079,
-42189,
-43733,
-45516,
-47189,
-48407,
-48799,
-48096,
-46157,
-42988,
-38787,
-33883,
-28712,
-23770,
-19495,
-16269,
-14273,
-13548,
-13913,
-15070,
-16624,
-18189,
-19450,
-20234,
-20514,
-20406,
-20128,
-19926,
-20041,
-20644,
-21827,
-23601,
-25874,
-28522,
-31309,
-34018,
-36361,
-38090,
-39000,
-38974,
-38025,
-36304,
-34076,
-31695,
-29526,
-27905,
-27051,
-27094,
-27997,
-29649,
-31840,
-34310,
-36818,
-39096,
-40972,
-42301,
-43050,
-43267,
-43100,
-42752,
-42484,
-42499,
-42969,
-43940,
-45329,
-46945,
-48494,
-49627,
-50029,
-49415,
-47637,
-44692,
-40715,
-36028,
-31023,
-26185,
-21954,
-18691,
-16605,
-15719,
-15892,
-16836,
-18204,
-19642,
-20875,
-21726,
-22155,
-22222,
-22073,
-21909,
-21920,
-22293,
-23161,
-24582,
-26551,
-28952,
-31602,
-34224,
-36541,
-38255,
-39155,
-39138,
-38211,
-36533,
-34358,
-31987,
-29757,
-27950,
-26789,
-26417,
-26868,
-28098,
-29967,
-32277,
-34763,
-37174,
-39233,
-40788,
-41712,
-42072,
-41971,
-41675,
-41419,
-41483,
-42017,
-43096,
-44633,
-46422,
-48156,
-49469,
-50005,
-49487,
-47732,
-44755,
-40685,
-35877,
-30727,
-25753,
-21380,
-17996,
-15781,
-14787,
-14858,
-15729,
-17066,
-18528,
-19842,
-20815,
-21392,
-21593,
-21558,
-21461,
-21507,
-21885,
-22752,
-24175,
-26154,
-28575,
-31243,
-33894,
-36233,
-37994,
-38959,
-39033,
-38223,
-36658,
-34575,
-32250,
-30004,
-28122,
-26847,
-26334,
-26657,
-27780,
-29578,
-31849,
-34336,
-36759,
-38883,
-40499,
-41526,
-41969,
-41945,
-41669,
-41378,
-41337,
-41720,
-42643,
-44053,
-45793,
-47573,
-49024,
-49780,
-49503,
-48003,
-45221,
-41323,
-36612,
-31534,
-26598,
-22257,
-18898,
-16724,
-15761,
-15877,
-16791,
-18162,
-19644,
-20949,
-21885,
-22394,
-22513,
-22393,
-22226,
-22220,
-22565,
-23394,
-24765,
-26667,
-28975,
-31539,
-34097,
-36417,
-38220,
-39309,
-39539,
-38899,
-37459,
-35460,
-33160,
-30925,
-29053,
-27820,
-27369,
-27761,
-28899,
-30649,
-32761,
-35025,
-37185,
-39073,
-40536,
-41517,
-42022,
-42130,
-41992,
-41808,
-41790,
-42137,
-42962,
-44286,
-45988,
-47811,
-49427,
-50417,
-50451,
-49256,
-46744,
-43035,
-38398,
-33292,
-28218,
-23673,
-20074,
-17650,
-16467,
-16401,
-17174,
-18466,
-19903,
-21224,
-22214,
-22815,
-23047,
-23023,
-22905,
-22865,
-23073,
-23684,
-24773,
-26406,
-28516,
-30994,
-33616,
-36106,
-38160,
-39501,
-39932,
-39399,
-37975,
-35886,
-33454,
-31031,
-28966,
-27535,
-26897,
-27121,
-28155,
-29849,
-32012,
-34376,
-36702,
-38735,
-40314,
-41331,
-41805,
-41846,
-41646,
-41453,
-41489,
-41927,
-42846,
-44205,
-45858,
-47569,
-49039,
-49959,
-50047,
-49080,
-46946,
-43675,
-39438,
-34581,
-29532,
-24800,
-20832,
-17975,
-16384,
-16010,
-16624,
-17859,
-19334,
-20696,
-21711,
-22295,
-22474,
-22395,
-22239,
-22199,
-22447,
-23113,
-24269,
-25935,
-28055,
-30500,
-33075,
-35507,
-37532,
-38876,
-39366,
-38933,
-37628,
-35661,
-33300,
-30891,
-28764,
-27202,
-26402,
-26469,
-27374,
-29016,
-31176,
-33604,
-36011,
-38145,
-39805,
-40904,
-41437,
-41541,
-41379,
-41216,
-41232,
-41630,
-42479,
-43766,
-45402,
-47140,
-48735,
-49833,
-50126,
-49339,
-47320,
-44065,
-39766,
-34769,
-29559,
-24656,
-20535,
-17549,
-15832,
-15357,
-15870,
-17054,
-18513,
-19920,
-21027,
-21713,
-21982,
-21926,
-21732,
-21584,
-21710,
-22260,
-23369,
-25060,
-27276,
-29877,
-32608,
-35213,
-37379,
-38866,
-39504,
-39221,
-38100,
-36294,
-34084,
-31774,
-29672,
-28079,
-27173,
-27103,
-27842,
-29331,
-31350,
-33692,
-36067,
-38243,
-40010,
-41259,
-41969,
-42209,
-42153,
-41979,
-41941,
-42203,
-42908,
-44067,
-45602,
-47303,
-48886,
-50020,
-50364,
-49673,
-47794,
-44746,
-40720,
-36031,
-31129,
-26479,
-22510,
-19562,
-17792,
-17198,
-17603,
-18707,
-20152,
-21584,
-22736,
-23432,
-23677,
-23538,
-23240,
-22993,
-23049,
-23575,
-24684,
-26384,
-28594,
-31148,
-33817,
-36339,
-38452,
-39917,
-40582,
-40366,
-39317,
-37577,
-35392,
-33047,
-30874,
-29143,
-28096,
-27859,
-28470,
-29853,
-31837,
-34184,
-36621,
-38859,
-40681,
-41927,
-42561,
-42666,
-42415,
-42057,
-41852,
-42009,
-42661,
-43816,
-45354,
-47071,
-48644,
-49785,
-50146,
-49520,
-47730,
-44798,
-40843,
-36175,
-31188,
-26360,
-22152,
-18929,
-16914,
-16130,
-16408,
-17455,
-18868,
-20317,
-21477,
-22236,
-22526,
-22475,
-22199,
-21911,
-21740,
-21848,
-22305,
-23177,
-24480,
-26186,
-28237,
-30505,
-32826,
-34989,
-36777,
-37996,
-38504,
-38251,
-37272,
-35693,
-33705,
-31529,
-29403,
-27527,
-26082,
-25184,
-24910,
-25281,
-26277,
-27805,
-29764,
-31957,
-34221,
-36323,
-38099,
-39410,
-40193,
-40483,
-40384,
-40056,
-39723,
-39553,
-39721,
-40303,
-41318,
-42700,
-44322,
-46002,
-47511,
-48629,
-49107,
-48759,
-47442,
-45111,
-41836,
-37806,
-33321,
-28745,
-24471,
-20839,
-18117,
-16424,
-15764,
-15999,
-16919,
-18255,
-19754,
-21180,
-22367,
-23224,
-23699,
-23844,
-23714,
-23431,
-23136,
-22955,
-23057,
-23526,
-24473,
-25905,
-27789,
-30028,
-32434,
-34814,
-36925,
-38556,
-39541,
-39773,
-39257,
-38053,
-36327,
-34267,
-32104,
-30058,
-28328,
-27067,
-26403,
-26385,
-27034,
-28303,
-30081,
-32228,
-34538,
-36809,
-38829,
-40439,
-41530,
-42077,
-42148,
-41859,
-41410,
-40988,
-40791,
-40954,
-41557,
-42598,
-43984,
-45566,
-47138,
-48449,
-49278,
-49388,
-48634,
-46910,
-44227,
-40673,
-36449,
-31844,
-27194,
-22862,
-19187,
-16422,
-14717,
-14090,
-14403,
-15454,
-16926,
-18548,
-20031,
-21214,
-21983,
-22347,
-22364,
-22163,
-21879,
-21679,
-21687,
-22049,
-22831,
-24098,
-25832,
-27957,
-30351,
-32811,
-35136,
-37102,
-38515,
-39254,
-39238,
-38501,
-37127,
-35277,
-33151,
-30980,
-28973,
-27346,
-26245,
-25777,
-25991,
-26852,
-28302,
-30192,
-32382,
-34662,
-36862,
-38779,
-40291,
-41280,
-41759,
-41770,
-41467,
-41046,
-40711,
-40664,
-41025,
-41842,
-43059,
-44555,
-46133,
-47575,
-48682,
-49221,
-49066,
-48057,
-46153,
-43345,
-39733,
-35509,
-30957,
-26421,
-22276,
-18831,
-16346,
-14894,
-14464,
-14866,
-15881,
-17214,
-18628,
-19911,
-20943,
-21662,
-22068,
-22214,
-22167,
-22055,
-21975,
-22092,
-22508,
-23357,
-24675,
-26467,
-28649,
-31062,
-33514,
-35774,
-37616,
-38887,
-39438,
-39274,
-38404,
-36960,
-35111,
-33051,
-31015,
-29196,
-27784,
-26905,
-26653,
-27037,
-28039,
-29558,
-31472,
-33605,
-35777,
-37794,
-39492,
-40755,
-41517,
-41812,
-41724,
-41413,
-41073,
-40884,
-41000,
-41518,
-42440,
-43713,
-45207,
-46736,
-48102,
-49082,
-49471,
-49088,
-47814,
-45584,
-42459,
-38566,
-34181,
-29607,
-25240,
-21402,
-18412,
-16410,
-15467,
-15464,
-16223,
-17480,
-18954,
-20409,
-21636,
-22546,
-23069,
-23276,
-23208,
-23033,
-22851,
-22839,
-23086,
-23719,
-24763,
-26244,
-28109,
-30267,
-32585,
-34890,
-36986,
-38684,
-39801,
-40214,
-39865,
-38792,
-37110,
-35035,
-32807,
-30682,
-28910,
-27635,
-26993,
-26988,
-27619,
-28796,
-30443,
-32412,
-34575,
-36748,
-38762,
-40440,
-41663,
-42352,
-42543,
-42340,
-41918,
-41490,
-41261,
-41372,
-41922,
-42883,
-44200,
-45709,
-47253,
-48598,
-49545,
-49870,
-49381,
-47958,
-45531,
-42183,
-38081,
-33526,
-28888,
-24547,
-20864,
-18082,
-16333,
-15597,
-15741,
-16544,
-17749,
-19108,
-20416,
-21508,
-22318,
-22789,
-22975,
-22911,
-22718,
-22507,
-22422,
-22606,
-23176,
-24223,
-25777,
-27798,
-30170,
-32716,
-35202,
-37387,
-39058,
-40027,
-40226,
-39635,
-38360,
-36552,
-34430,
-32229,
-30167,
-28469,
-27269,
-26706,
-26814,
-27590,
-28971,
-30817,
-32972,
-35222,
-37367,
-39228,
-40658,
-41608,
-42068,
-42134,
-41920,
-41612,
-41364,
-41334,
-41640,
-42321,
-43390,
-44758,
-46293,
-47811,
-49070,
-49838,
-49881,
-49021,
-47164,
-44326,
-40621,
-36308,
-31681,
-27129,
-22983,
-19568,
-17069,
-15595,
-15105,
-15462,
-16458,
-17821,
-19307,
-20675,
-21768,
-22487,
-22825,
-22837,
-22639,
-22394,
-22244,
-22363,
-22853,
-23791,
-25197,
-27021,
-29183,
-31524,
-33896,
-36083,
-37922,
-39235,
-39905,
-39873,
-39145,
-37802,
-35998,
-33920,
-31803,
-29868,
-28321,
-27316,
-26961,
-27274,
-28238,
-29752,
-31676,
-33842,
-36062,
-38146,
-39950,
-41344,
-42281,
-42752,
-42843,
-42656,
-42370,
-42151,
-42155,
-42517,
-43280,
-44436,
-45886,
-47460,
-48930,
-50047,
-50548,
-50243,
-48970,
-46706,
-43507,
-39564,
-35144,
-30592,
-26255,
-22468,
-19477,
-17435,
-16375,
-16210,
-16784,
-17855,
-19195,
-20564,
-21788,
-22731,
-23340,
-23608,
-23606,
-23428,
-23221,
-23127,
-23300,
-23841,
-24841,
-26289,
-28152,
-30316,
-32619,
-34894,
-36936,
-38575,
-39665,
-40096,
-39835,
-38901,
-37394,
-35463,
-33333,
-31207,
-29350,
-27925,
-27105,
-26942,
-27450,
-28561,
-30152,
-32082,
-34153,
-36207,
-38061,
-39579,
-40678,
-41309,
-41519,
-41399,
-41098,
-40793,
-40652,
-40812,
-41354,
-42282,
-43534,
-44986,
-46447,
-47727,
-48587,
-48831,
-48279,
-46812,
-44397,
-41096,
-37085,
-32630,
-28067,
-23756,
-20029,
-17142,
-15233,
-14323,
-14296,
-14972,
-16079,
-17389,
-18653,
-19720,
-20479,
-20912,
-21047,
-20976,
-20807,
-20682,
-20730,
-21076,
-21810,
-22989,
-24622,
-26660,
-29012,
-31515,
-34000,
-36233,
-38027,
-39180,
-39586,
-39190,
-38052,
-36305,
-34177,
-31922,
-29819,
-28101,
-26963,
-26500,
-26754,
-27671,
-29160,
-31080,
-33268,
-35543,
-37730,
-39665,
-41215,
-42307,
-42910,
-43084,
-42939,
-42619,
-42318,
-42171,
-42318,
-42817,
-43681,
-44844,
-46209,
-47596,
-48828,
-49664,
-49897,
-49307,
-47770,
-45220,
-41741,
-37517,
-32869,
-28162,
-23808,
-20137,
-17423,
-15758,
-15142,
-15411,
-16341,
-17655,
-19087,
-20418,
-21489,
-22218,
-22596,
-22670,
-22531,
-22307,
-22128,
-22136,
-22457,
-23185,
-24383,
-26050,
-28127,
-30492,
-32969,
-35342,
-37391,
-38912,
-39755,
-39847,
-39185,
-37875,
-36061,
-33963,
-31804,
-29805,
-28176,
-27058,
-26572,
-26748,
-27590,
-29002,
-30882,
-33037,
-35289,
-37434,
-39289,
-40738,
-41690,
-42166,
-42220,
-41996,
-41652,
-41366,
-41312,
-41594,
-42296,
-43386,
-44795,
-46351,
-47855,
-49054,
-49709,
-49605,
-48576,
-46563,
-43587,
-39797,
-35435,
-30806,
-26280,
-22188,
-18852,
-16457,
-15120,
-14785,
-15320,
-16476,
-17980,
-19544,
-20929,
-21970,
-22584,
-22790,
-22672,
-22369,
-22052,
-21877,
-21992,
-22506,
-23467,
-24899,
-26747,
-28922,
-31294,
-33680,
-35892,
-37726,
-39015,
-39621,
-39478,
-38607,
-37088,
-35108,
-32881,
-30659,
-28691,
-27193,
-26315,
-26144,
-26696,
-27893,
-29633,
-31729,
-34011,
-36270,
-38343,
-40067,
-41364,
-42170,
-42531,
-42505,
-42242,
-41890,
-41634,
-41622,
-41980,
-42749,
-43924,
-45393,
-46993,
-48490,
-49625,
-50144,
-49818,
-48513,
-46173,
-42881,
-38827,
-34303,
-29669,
-25303,
-21536,
-18631,
-16723,
-15819,
-15827,
-16536,
-17717,
-19107,
-20492,
-21686,
-22595,
-23161,
-23413,
-23404,
-23250,
-23077,
-23033,
-23251,
-23852,
-24895,
-26406,
-28317,
-30527,
-32869,
-35159,
-37201,
-38816,
-39865,
-40249,
-39945,
-38974,
-37449,
-35518,
-33403,
-31315,
-29496,
-28108,
-27301,
-27123,
-27566,
-28577,
-30040,
-31847,
-33865,
-35948,
-37982,
-39804,
-41313,
-42396,
-43007,
-43165,
-42950,
-42522,
-42072,
-41798,
-41866,
-42372,
-43324,
-44649,
-46190,
-47748,
-49094,
-50003,
-50278,
-49766,
-48367,
-46071,
-42926,
-39101,
-34809,
-30366,
-26078,
-22281,
-19226,
-17106,
-15966,
-15778,
-16356,
-17503,
-18934,
-20411,
-21736,
-22766,
-23445,
-23791,
-23849,
-23738,
-23552,
-23419,
-23445,
-23727,
-24348,
-25353,
-26764,
-28537,
-30603,
-32821,
-35034,
-37049,
-38695,
-39807,
-40303,
-40111,
-39286,
-37881,
-36071,
-34009,
-31923,
-30003,
-28451,
-27409,
-26987,
-27207,
-28061,
-29456,
-31271,
-33351,
-35520,
-37611,
-39475,
-40975,
-42047,
-42647,
-42826,
-42666,
-42318,
-41948,
-41739,
-41826,
-42323,
-43225,
-44503,
-46002,
-47558,
-48951,
-49949,
-50372,
-50027,
-48830,
-46727,
-43762,
-40060,
-35816,
-31305,
-26832,
-22721,
-19266,
-16685,
-15105,
-14525,
-14833,
-15820,
-17221,
-18763,
-20199,
-21368,
-22169,
-22600,
-22728,
-22642,
-22487,
-22362,
-22403,
-22686,
-23304,
-24301,
-25701,
-27491,
-29598,
-31904,
-34248,
-36431,
-38261,
-39558,
-40199,
-40122,
-39340,
-37944,
-36071,
-33924,
-31710,
-29656,
-27960,
-26789,
-26259,
-26405,
-27231,
-28621,
-30476,
-32598,
-34827,
-36969,
-38888,
-40440,
-41584,
-42256,
-42526,
-42443,
-42157,
-41811,
-41575,
-41596,
-41980,
-42772,
-43945,
-45399,
-46965,
-48443,
-49600,
-50220,
-50111,
-49142,
-47243,
-44458,
-40883,
-36752,
-32328,
-27937,
-23899,
-20494,
-17918,
-16290,
-15582,
-15715,
-16504,
-17729,
-19174,
-20616,
-21891,
-22875,
-23509,
-23788,
-23785,
-23587,
-23363,
-23230,
-23371,
-23859,
-24792,
-26159,
-27931,
-30013,
-32279,
-34577,
-36738,
-38594,
-39984,
-40784,
-40897,
-40319,
-39079,
-37318,
-35207,
-32984,
-30877,
-29118,
-27864,
-27248,
-27287,
-27979,
-29218,
-30902,
-32860,
-34954,
-37001,
-38874,
-40432,
-41604,
-42325,
-42634,
-42564,
-42274,
-41888,
-41605,
-41561,
-41880,
-42605,
-43705,
-45082,
-46578,
-48002,
-49156,
-49842,
-49895,
-49177,
-47603,
-45149,
-41862,
-37892,
-33467,
-28906,
-24554,
-20764,
-17799,
-15843,
-14911,
-14913,
-15648,
-16851,
-18279,
-19686,
-20927,
-21882,
-22519,
-22833,
-22873,
-22707,
-22448,
-22216,
-22157,
-22408,
-23068,
-24199,
-25785,
-27755,
-29979,
-32285,
-34489,
-36413,
-37888,
-38797,
-39049,
-38610,
-37518,
-35851,
-33773,
-31484,
-29214,
-27203,
-25669,
-24752,
-24563,
-25083,
-26261,
-27961,
-30012,
-32246,
-34466,
-36539,
-38321,
-39734,
-40742,
-41321,
-41543,
-41470,
-41243,
-41009,
-40923,
-41127,
-41704,
-42689,
-44015,
-45562,
-47132,
-48515,
-49477,
-49829,
-49418,
-48150,
-46020,
-43063,
-39436,
-35321,
-31009,
-26784,
-22992,
-19889,
-17695,
-16507,
-16280,
-16882,
-18070,
-19564,
-21103,
-22452,
-23466,
-24077,
-24289,
-24185,
-23858,
-23460,
-23115,
-22975,
-23149,
-23747,
-24801,
-26344,
-28297,
-30571,
-32998,
-35380,
-37523,
-39207,
-40301,
-40670,
-40315,
-39258,
-37635,
-35620,
-33422,
-31271,
-29365,
-27884,
-26952,
-26632,
-26955,
-27871,
-29324,
-31180,
-33307,
-35523,
-37656,
-39536,
-41023,
-42038,
-42552,
-42627,
-42379,
-41971,
-41597,
-41422,
-41586,
-42160,
-43145,
-44466,
-45997,
-47552,
-48925,
-49914,
-50298,
-49935,
-48687,
-46521,
-43473,
-39657,
-35320,
-30708,
-26204,
-22097,
-18719,
-16253,
-14811,
-14366,
-14777,
-15828,
-17252,
-18784,
-20204,
-21349,
-22132,
-22548,
-22638,
-22506,
-22261,
-22057,
-22007,
-22255,
-22882,
-23956,
-25489,
-27432,
-29692,
-32114,
-34518,
-36705,
-38488,
-39705,
-40259,
-40087,
-39233,
-37768,
-35856,
-33689,
-31482,
-29474,
-27844,
-26770,
-26328,
-26564,
-27429,
-28851,
-30678,
-32785,
-34973,
-37108,
-39007,
-40560,
-41670,
-42301,
-42485,
-42310,
-41925,
-41505,
-41239,
-41264,
-41702,
-42549,
-43782,
-45267,
-46836,
-48299,
-49417,
-50010,
-49872,
-48891,
-46988,
-44195,
-40617,
-36472,
-32024,
-27613,
-23546,
-20125,
-17541,
-15915,
-15232,
-15402,
-16232,
-17507,
-18965,
-20408,
-21627,
-22530,
-23057,
-23239,
-23158,
-22942,
-22733,
-22679,
-22902,
-23495,
-24494,
-25920,
-27698,
-29763,
-31977,
-34193,
-36250,
-37986,
-39252,
-39944,
-39999,
-39402,
-38229,
-36570,
-34611,
-32529,
-30543,
-28841,
-27606,
-26934,
-26918,
-27522,
-28714,
-30365,
-32341,
-34465,
-36580,
-38507,
-40137,
-41349,
-42111,
-42431,
-42375,
-42079,
-41693,
-41398,
-41348,
-41654,
-42373,
-43470,
-44858,
-46379,
-47836,
-49026,
-49724,
-49753,
-48960,
-47266,
-44666,
-41257,
-37212,
-32822,
-28386,
-24261,
-20731,
-18034,
-16278,
-15480,
-15530,
-16256,
-17429,
-18823,
-20223,
-21459,
-22417,
-23028,
-23301,
-23284,
-23071,
-22802,
-22616,
-22658,
-23051,
-23863,
-25133,
-26813,
-28848,
-31080,
-33389,
-35574,
-37474,
-38926,
-39801,
-40014,
-39557,
-38462,
-36862,
-34919,
-32840,
-30837,
-29110,
-27810,
-27061,
-26903,
-27352,
-28357,
-29842,
-31683,
-33749,
-35861,
-37875,
-39619,
-40987,
-41892,
-42341,
-42374,
-42128,
-41750,
-41421,
-41314,
-41533,
-42168,
-43184,
-44525,
-46033,
-47535,
-48808,
-49650,
-49857,
-49282,
-47825,
-45470,
-42281,
-38413,
-34104,
-29646,
-25354,
-21544,
-18450,
-16253,
-14997,
-14646,
-15053,
-16028,
-17332,
-18755,
-20085,
-21190,
-21972,
-22406,
-22520,
-22399,
-22156,
-21954,
-21921,
-22213,
-22914,
-24068,
-25682,
-27657,
-29912,
-32260,
-34561,
-36614,
-38272,
-39377,
-39829,
-39585,
-38643,
-37113,
-35116,
-32895,
-30649,
-28646,
-27068,
-26084,
-25767,
-26148,
-27157,
-28712,
-30653,
-32832,
-35062,
-37187,
-39045,
-40523,
-41551,
-42102,
-42228,
-42028,
-41643,
-41265,
-41046,
-41158,
-41673,
-42627,
-43955,
-45525,
-47140,
-48577,
-49587,
-49969,
-49542,
-48221,
-45978,
-42895,
-39119,
-34882,
-30463,
-26161,
-22275,
-19063,
-16701,
-15283,
-14791,
-15111,
-16067,
-17404,
-18906,
-20325,
-21522,
-22378,
-22877,
-23052,
-22997,
-22833,
-22708,
-22748,
-23079,
-23782,
-24896,
-26427,
-28313,
-30468,
-32759,
-35029,
-37117,
-38851,
-40083,
-40713,
-40657,
-39939,
-38605,
-36794,
-34691,
-32518,
-30499,
-28860,
-27758,
-27314,
-27559,
-28459,
-29922,
-31796,
-33916,
-36096,
-38167,
-39985,
-41438,
-42458,
-43044,
-43216,
-43080,
-42750,
-42383,
-42143,
-42166,
-42560,
-43367,
-44557,
-46030,
-47617,
-49098,
-50240,
-50811,
-50611,
-49526,
-47487,
-44570,
-40889,
-36685,
-32233,
-27842,
-23833,
-20460,
-17930,
-16340,
-15693,
-15882,
-16738,
-18013,
-19475,
-20879,
-22059,
-22882,
-23335,
-23433,
-23283,
-23015,
-22765,
-22682,
-22867,
-23400,
-24324,
-25627,
-27285,
-29217,
-31333,
-33507,
-35592,
-37449,
-38913,
-39872,
-40217,
-39911,
-38979,
-37480,
-35587,
-33433,
-31269,
-29255,
-27603,
-26443,
-25870,
-25933,
-26607,
-27835,
-29513,
-31504,
-33658,
-35806,
-37796,
-39483,
-40763,
-41572,
-41909,
-41828,
-41462,
-40952,
-40504,
-40266,
-40385,
-40923,
-41871,
-43165,
-44649,
-46176,
-47535,
-48561,
-49080,
-48952,
-48084,
-46405,
-43918,
-40683,
-36839,
-32609,
-28259,
-24118,
-20471,
-17593,
-15630,
-14637,
-14547,
-15184,
-16341,
-17756,
-19223,
-20562,
-21675,
-22505,
-23063,
-23374,
-23495,
-23503,
-23473,
-23513,
-23725,
-24221,
-25095,
-26391,
-28128,
-30215,
-32560,
-34955,
-37234,
-39178,
-40631,
-41462,
-41605,
-41049,
-39851,
-38123,
-36018,
-33739,
-31495,
-29502,
-27938,
-26951,
-26601,
-26907,
-27808,
-29200,
-30955,
-32921,
-34963,
-36934,
-38732,
-40236,
-41387,
-42134,
-42479,
-42478,
-42227,
-41864,
-41551,
-41430,
-41621,
-42186,
-43123,
-44377,
-45823,
-47321,
-48684,
-49730,
-50279,
-50156,
-49237,
-47430,
-44733,
-41218,
-37062,
-32524,
-27925,
-23615,
-19907,
-17050,
-15186,
-14330,
-14385,
-15158,
-16410,
-17888,
-19370,
-20681,
-21706,
-22399,
-22756,
-22819,
-22670,
-22404,
-22149,
-22038,
-22195,
-22739,
-23723,
-25175,
-27034,
-29206,
-31548,
-33881,
-36054,
-37893,
-39276,
-40101,
-40300,
-39848,
-38785,
-37175,
-35182,
-32980,
-30798,
-28853,
-27334,
-26380,
-26054,
-26354,
-27223,
-28561,
-30250,
-32180,
-34206,
-36224,
-38101,
-39714,
-40974,
-41804,
-42195,
-42194,
-41913,
-41498,
-41136,
-40985,
-41175,
-41770,
-42763,
-44072,
-45571,
-47074,
-48392,
-49323,
-49686,
-49343,
-48187,
-46197,
-43396,
-39895,
-35881,
-31582,
-27282,
-23271,
-19800,
-17086,
-15247,
-14309,
-14207,
-14796,
-15872,
-17230,
-18655,
-19983,
-21089,
-21897,
-22393,
-22594,
-22575,
-22421,
-22272,
-22234,
-22465,
-23028,
-24012,
-25400,
-27164,
-29194,
-31382,
-33569,
-35625,
-37395,
-38767,
-39622,
-39895,
-39548,
-38599,
-37139,
-35293,
-33258,
-31226,
-29405,
-27958,
-27011,
-26626,
-26819,
-27563,
-28795,
-30428,
-32356,
-34440,
-36535,
-38490,
-40146,
-41411,
-42205,
-42543,
-42495,
-42180,
-41778,
-41444,
-41342,
-41579,
-42199,
-43203,
-44495,
-45962,
-47432,
-48720,
-49644,
-50038,
-49757,
-48716,
-46858,
-44205,
-40830,
-36895,
-32605,
-28256,
-24128,
-20547,
-17733,
-15875,
-14991,
-15030,
-15797,
-17064,
-18559,
-20049,
-21352,
-22358,
-23032,
-23383,
-23476,
-23390,
-23206,
-23051,
-22998,
-23187,
-23680,
-24573,
-25869,
-27564,
-29572,
-31777,
-34030,
-36165,
-38022,
-39457,
-40354,
-40638,
-40274,
-39289,
-37752,
-35812,
-33636,
-31459,
-29483,
-27930,
-26946,
-26626,
-26994,
-27978,
-29494,
-31364,
-33442,
-35542,
-37523,
-39253,
-40641,
-41634,
-42214,
-42420,
-42314,
-42013,
-41638,
-41349,
-41257,
-41489,
-42090,
-43074,
-44380,
-45903,
-47470,
-48905,
-49984,
-50509,
-50306,
-49239,
-47248,
-44361,
-40687,
-36440,
-31898,
-27391,
-23243,
-19762,
-17149,
-15522,
-14875,
-15085,
-15965,
-17256,
-18720,
-20119,
-21308,
-22169,
-22694,
-22903,
-22872,
-22699,
-22482,
-22320,
-22312,
-22531,
-23062,
-23957,
-25251,
-26948,
-28986,
-31272,
-33642,
-35911,
-37870,
-39348,
-40187,
-40336,
-39769,
-38574,
-36870,
-34826,
-32648,
-30524,
-28669,
-27233,
-26366,
-26127,
-26541,
-27554,
-29062,
-30924,
-32981,
-35078,
-37074,
-38857,
-40334,
-41440,
-42153,
-42456,
-42417,
-42112,
-41692,
-41324,
-41177,
-41390,
-42049,
-43135,
-44578,
-46205,
-47822,
-49199,
-50138,
-50445,
-50003,
-48711,
-46570,
-43607,
-39960,
-35810,
-31414,
-27066,
-23066,
-19678,
-17102,
-15456,
-14723,
-14844,
-15618,
-16861,
-18317,
-19785,
-21077,
-22070,
-22715,
-22999,
-23010,
-22832,
-22611,
-22476,
-22557,
-22943,
-23714,
-24870,
-26424,
-28295,
-30420,
-32651,
-34871,
-36898,
-38598,
-39825,
-40487,
-40531,
-39964,
-38848,
-37282,
-35426,
-33433,
-31497,
-29783,
-28446,
-27613,
-27352,
-27694,
-28607,
-30005,
-31786,
-33786,
-35868,
-37875,
-39671,
-41158,
-42253,
-42935,
-43218,
-43166,
-42898,
-42545,
-42272,
-42220,
-42488,
-43142,
-44146,
-45438,
-46867,
-48270,
-49455,
-50236,
-50452,
-49973,
-48705,
-46640,
-43786,
-40285,
-36284,
-32039,
-27816,
-23898,
-20549,
-17972,
-16279,
-15511,
-15569,
-16327,
-17544,
-19004,
-20470,
-21751,
-22728,
-23330,
-23582,
-23545,
-23330,
-23074,
-22890,
-22908,
-23202,
-23835,
-24837,
-26198,
-27895,
-29854,
-31988,
-34153,
-36212,
-37972,
-39293,
-40021,
-40084,
-39466,
-38215,
-36467,
-34392,
-32190,
-30073,
-28217,
-26775,
-25856,
-25513,
-25771,
-26601,
-27943,
-29693,
-31718,
-33857,
-35934,
-37804,
-39314,
-40416,
-41059,
-41309,
-41235,
-40964,
-40629,
-40356,
-40263,
-40443,
-40952,
-41813,
-42998,
-44409,
-45906,
-47275,
-48277,
-48677,
-48269,
-46937,
-44656,
-41511,
-37692,
-33448,
-29084,
-24890,
-21143,
-18058,
-15796,
-14426,
-13943,
-14253,
-15186,
-16542,
-18058,
-19541,
-20793,
-21738,
-22332,
-22639,
-22736,
-22735,
-22735,
-22824,
-23053,
-23504,
-24203,
-25226,
-26600,
-28343,
-30414,
-32721,
-35097,
-37347,
-39244,
-40596,
-41262,
-41174,
-40354,
-38897,
-36964,
-34747,
-32460,
-30305,
-28467,
-27098,
-26299,
-26136,
-26600,
-27657,
-29199,
-31093,
-33182,
-35296,
-37280,
-39008,
-40372,
-41339,
-41880,
-42064,
-41936,
-41644,
-41297,
-41054,
-41039,
-41361,
-42065,
-43162,
-44560,
-46136,
-47691,
-49009,
-49860,
-50061,
-49439,
-47941,
-45544,
-42342,
-38496,
-34214,
-29784,
-25475,
-21582,
-18339,
-15934,
-14451,
-13896,
-14162,
-15078,
-16411,
-17927,
-19392,
-20640,
-21552,
-22099,
-22296,
-22244,
-22027,
-21803,
-21674,
-21770,
-22174,
-22952,
-24131,
-25701,
-27619,
-29790,
-32101,
-34390,
-36503,
-38268,
-39542,
-40212,
-40216,
-39546,
-38264,
-36485,
-34376,
-32140,
-29981,
-28119,
-26712,
-25897,
-25728,
-26209,
-27281,
-28832,
-30723,
-32807,
-34918,
-36937,
-38714,
-40179,
-41248,
-41899,
-42149,
-42066,
-41762,
-41407,
-41151,
-41171,
-41559,
-42362,
-43540,
-44971,
-46499,
-47915,
-49041,
-49693,
-49741,
-49076,
-47638,
-45403,
-42414,
-38766,
-34648,
-30299,
-26024,
-22122,
-18870,
-16458,
-14982,
-14411,
-14636,
-15462,
-16682,
-18075,
-19464,
-20695,
-21673,
-22345,
-22698,
-22785,
-22681,
-22513,
-22413,
-22521,
-22932,
-23726,
-24903,
-26447,
-28276,
-30320,
-32452,
-34584,
-36565,
-38277,
-39575,
-40319,
-40434,
-39857,
-38639,
-36891,
-34789,
-32571,
-30467,
-28686,
-27394,
-26683,
-26581,
-27070,
-28084,
-29529,
-31312,
-33306,
-35391,
-37440,
-39307,
-40885,
-42056,
-42779,
-43043,
-42922,
-42539,
-42055,
-41656,
-41499,
-41695,
-42307,
-43293,
-44598,
-46071,
-47563,
-48902,
-49907,
-50416,
-50274,
-49364,
-47613,
-45025,
-41688,
-37771,
-33526,
-29235,
-25187,
-21642,
-18778,
-16719,
-15479,
-15040,
-15296,
-16133,
-17379,
-18866,
-20391,
-21787,
-22904,
-23650,
-24015,
-24045,
-23850,
-23569,
-23331,
-23262,
-23436,
-23922,
-24756,
-25950,
-27522,
-29424,
-31588,
-33885,
-36128,
-38142,
-39727,
-40766,
-41180,
-40978,
-40208,
-38970,
-37350,
-35474,
-33451,
-31423,
-29555,
-28015,
-26969,
-26532,
-26746,
-27578,
-28916,
-30611,
-32510,
-34475,
-36407,
-38222,
-39848,
-41202,
-42200,
-42777,
-42911,
-42668,
-42180,
-41653,
-41291,
-41283,
-41707,
-42578,
-43789,
-45216,
-46693,
-48088,
-49272,
-50139,
-50567,
-50424,
-49569,
-47898,
-45365,
-42036,
-38079,
-33751,
-29376,
-25246,
-21643,
-18736,
-16648,
-15396,
-14965,
-15245,
-16122,
-17394,
-18862,
-20298,
-21505,
-22360,
-22815,
-22916,
-22773,
-22531,
-22311,
-22223,
-22309,
-22612,
-23157,
-23980,
-25135,
-26650,
-28528,
-30685,
-32993,
-35245,
-37256,
-38835,
-39887,
-40347,
-40246,
-39600,
-38480,
-36938,
-35055,
-32952,
-30804,
-28813,
-27230,
-26223,
-25928,
-26343,
-27386,
-28895,
-30694,
-32635,
-34594,
-36511,
-38319,
-39943,
-41308,
-42289,
-42833,
-42911,
-42613,
-42083,
-41546,
-41195,
-41191,
-41604,
-42401,
-43515,
-44806,
-46171,
-47475,
-48616,
-49449,
-49812,
-49545,
-48472,
-46517,
-43683,
-40095,
-35995,
-31676,
-27445,
-23573,
-20253,
-17613,
-15711,
-14572,
-14170,
-14470,
-15358,
-16701,
-18288,
-19903,
-21344,
-22444,
-23151,
-23461,
-23475,
-23303,
-23077,
-22905,
-22875,
-23072,
-23559,
-24421,
-25688,
-27395,
-29460,
-31784,
-34167,
-36402,
-38317,
-39735,
-40624,
-40918,
-40683,
-39924,
-38718,
-37108,
-35192,
-33102,
-31017,
-29152,
-27706,
-26845,
-26639,
-27088,
-28101,
-29545,
-31284,
-33188,
-35156,
-37090,
-38905,
-40483,
-41728,
-42549,
-42912,
-42862,
-42516,
-42044,
-41648,
-41482,
-41662,
-42206,
-43086,
-44220,
-45502,
-46844,
-48113,
-49224,
-50013,
-50337,
-50042,
-48972,
-47081,
-44349,
-40902,
-36913,
-32652,
-28374,
-24375,
-20871,
-18065,
-16066,
-14937,
-14645,
-15102,
-16143,
-17547,
-19101,
-20562,
-21775,
-22630,
-23099,
-23235,
-23115,
-22866,
-22586,
-22402,
-22389,
-22635,
-23214,
-24153,
-25499,
-27206,
-29214,
-31412,
-33636,
-35737,
-37553,
-38954,
-39849,
-40177,
-39917,
-39085,
-37733,
-35954,
-33897,
-31726,
-29667,
-27888,
-26585,
-25840,
-25713,
-26171,
-27144,
-28534,
-30230,
-32124,
-34102,
-36046,
-37836,
-39335,
-40455,
-41122,
-41340,
-41189,
-40777,
-40298,
-39886,
-39706,
-39827,
-40303,
-41123,
-42258,
-43633,
-45160,
-46694,
-48065,
-49064,
-49464,
-49083,
-47791,
-45556,
-42474,
-38707,
-34528,
-30204,
-26033,
-22247,
-19068,
-16635,
-15049,
-14339,
-14454,
-15285,
-16636,
-18280,
-19970,
-21496,
-22710,
-23545,
-24021,
-24194,
-24181,
-24051,
-23902,
-23788,
-23768,
-23924,
-24326,
-25072,
-26221,
-27794,
-29739,
-31949,
-34236,
-36421,
-38298,
-39722,
-40577,
-40826,
-40444,
-39498,
-38039,
-36195,
-34103,
-31929,
-29867,
-28098,
-26782,
-26034,
-25910,
-26409,
-27469,
-28994,
-30858,
-32926,
-35053,
-37109,
-38963,
-40508,
-41673,
-42407,
-42730,
-42693,
-42407,
-42006,
-41648,
-41473,
-41601,
-42097,
-42980,
-44186,
-45632,
-47143,
-48568,
-49701,
-50388,
-50457,
-49816,
-48373,
-46132,
-43120,
-39464,
-35330,
-30962,
-26634,
-22624,
-19205,
-16552,
-14799,
-13928,
-13880,
-14489,
-15567,
-16916,
-18343,
-19701,
-20866,
-21759,
-22346,
-22624,
-22639,
-22475,
-22244,
-22073,
-22099,
-22415,
-23121,
-24215,
-25729,
-27566,
-29685,
-31936,
-34210,
-36332,
-38165,
-39556,
-40391,
-40613,
-40200,
-39196,
-37707,
-35844,
-33787,
-31685,
-29723,
-28054,
-26834,
-26171,
-26140,
-26737,
-27923,
-29560,
-31520,
-33610,
-35691,
-37616,
-39296,
-40659,
-41667,
-42294,
-42553,
-42461,
-42125,
-41644,
-41204,
-40956,
-41051,
-41574,
-42518,
-43817,
-45321,
-46862,
-48265,
-49353,
-50007,
-50070,
-49459,
-48048,
-45804,
-42716,
-38912,
-34572,
-30032,
-25609,
-21673,
-18478,
-16190,
-14851,
-14379,
-14635,
-15431,
-16595,
-17954,
-19364,
-20696,
-21822,
-22658,
-23151,
-23301,
-23188,
-22929,
-22664,
-22548,
-22667,
-23091,
-23831,
-24878,
-26227,
-27856,
-29749,
-31854,
-34060,
-36225,
-38130,
-39589,
-40435,
-40577,
-40044,
-38910,
-37344,
-35503,
-33551,
-31625,
-29844,
-28327,
-27187,
-26547,
-26486,
-27053,
-28204,
-29844,
-31801,
-33893,
-35951,
-37831,
-39463,
-40779,
-41767,
-42407,
-42705,
-42685,
-42430,
-42042,
-41699,
-41548,
-41736,
-42325,
-43306,
-44580,
-46006,
-47425,
-48659,
-49593,
-50069,
-50000,
-49244,
-47736,
-45392,
-42277,
-38480,
-34256,
-29883,
-25695,
-21978,
-18949,
-16724,
-15329,
-14716,
-14792,
-15446,
-16543,
-17933,
-19448,
-20894,
-22115,
-22962,
-23395,
-23438,
-23209,
-22876,
-22606,
-22540,
-22762,
-23297,
-24149,
-25294,
-26732,
-28448,
-30419,
-32574,
-34791,
-36884,
-38666,
-39948,
-40610,
-40617,
-39991,
-38842,
-37276,
-35431,
-33419,
-31375,
-29441,
-27785,
-26583,
-25988,
-26085,
-26891,
-28294,
-30148,
-32231,
-34366,
-36399,
-38226,
-39796,
-41057,
-41963,
-42482,
-42587,
-42323,
-41806,
-41204,
-40748,
-40618,
-40941,
-41729,
-42898,
-44287,
-45725,
-47062,
-48179,
-49022,
-49491,
-49508,
-48918,
-47577,
-45369,
-42264,
-38379,
-33960,
-29353,
-24950,
-21082,
-18004,
-15826,
-14555,
-14108,
-14351,
-15147,
-16327,
-17744,
-19211,
-20562,
-21644,
-22338,
-22642,
-22580,
-22304,
-21956,
-21701,
-21652,
-21881,
-22410,
-23253,
-24406,
-25892,
-27686,
-29777,
-32039,
-34336,
-36443,
-38165,
-39310,
-39808,
-39621,
-38843,
-37571,
-35942,
-34084,
-32115,
-30169,
-28383,
-26933,
-25960,
-25609,
-25914,
-26853,
-28314,
-30118,
-32122,
-34143,
-36123,
-37949,
-39610,
-40992,
-42055,
-42691,
-42874,
-42652,
-42133,
-41555,
-41119,
-41054,
-41442,
-42313,
-43541,
-44989,
-46476,
-47852,
-49006,
-49816,
-50187,
-49969,
-49036,
-47266,
-44631,
-41205,
-37196,
-32879,
-28601,
-24636,
-21232,
-18506,
-16523,
-15279,
-14752,
-14900,
-15653,
-16905,
-18470,
-20146,
-21679,
-22890,
-23652,
-23969,
-23930,
-23704,
-23459,
-23340,
-23434,
-23783,
-24391,
-25287,
-26476,
-27996,
-29838,
-31948,
-34202,
-36419,
-38392,
-39938,
-40929,
-41315,
-41108,
-40385,
-39206,
-37678,
-35868,
-33892,
-31878,
-30000,
-28439,
-27385,
-26938,
-27162,
-27996,
-29343,
-31049,
-32972,
-34988,
-36989,
-38890,
-40579,
-41960,
-42916,
-43396,
-43393,
-43014,
-42420,
-41841,
-41477,
-41480,
-41897,
-42697,
-43770,
-44994,
-46254,
-47466,
-48563,
-49473,
-50082,
-50248,
-49779,
-48534,
-46385,
-43376,
-39610,
-35362,
-30917,
-26627,
-22749,
-19512,
-17017,
-15306,
-14361,
-14102,
-14465,
-15327,
-16572,
-18046,
-19578,
-20991,
-22132,
-22883,
-23206,
-23144,
-22803,
-22357,
-21961,
-21782,
-21898,
-22361,
-23144,
-24229,
-25558,
-27133,
-28912,
-30882,
-32962,
-35037,
-36936,
-38470,
-39475,
-39852,
-39581,
-38731,
-37418,
-35774,
-33921,
-31958,
-29982,
-28099,
-26478,
-25270,
-24691,
-24818,
-25704,
-27220,
-29176,
-31323,
-33446,
-35395,
-37142,
-38679,
-40051,
-41241,
-42165,
-42745,
-42869,
-42565,
-41946,
-41258,
-40776,
-40745,
-41286,
-42359,
-43813,
-45400,
-46921,
-48231,
-49281,
-50071,
-50592,
-50761,
-50439,
-49409,
-47525,
-44699,
-41041,
-36781,
-32273,
-27885,
-23930,
-20613,
-18046,
-16225,
-15150,
-14743,
-14999,
-15811,
-17087,
-18650,
-20270,
-21744,
-22864,
-23548,
-23784,
-23670,
-23339,
-22951,
-22616,
-22449,
-22469,
-22767,
-23336,
-24279,
-25589,
-27316,
-29380,
-31691,
-34071,
-36329,
-38281,
-39771,
-40708,
-41063,
-40843,
-40107,
-38909,
-37330,
-35454,
-33386,
-31271,
-29266,
-27565,
-26345,
-25748,
-25843,
-26623,
-27965,
-29732,
-31706,
-33730,
-35675,
-37452,
-39048,
-40427,
-41566,
-42416,
-42899,
-42992,
-42697,
-42135,
-41474,
-40945,
-40757,
-41035,
-41811,
-42984,
-44405,
-45876,
-47253,
-48427,
-49333,
-49915,
-50076,
-49687,
-48579,
-46628,
-43770,
-40105,
-35841,
-31311,
-26869,
-22837,
-19434,
-16795,
-14924,
-13826,
-13429,
-13702,
-14559,
-15891,
-17523,
-19227,
-20767,
-21940,
-22636,
-22863,
-22725,
-22396,
-22050,
-21818,
-21773,
-21935,
-22315,
-22918,
-23813,
-25044,
-26672,
-28671,
-30957,
-33346,
-35630,
-37591,
-39063,
-39972,
-40291,
-40083,
-39399,
-38315,
-36881,
-35150,
-33205,
-31158,
-29175,
-27451,
-26169,
-25492,
-25487,
-26152,
-27402,
-29081,
-31030,
-33075,
-35090,
-36974,
-38664,
-40112,
-41276,
-42116,
-42604,
-42722,
-42514,
-42063,
-41523,
-41064,
-40877,
-41075,
-41736,
-42801,
-44168,
-45661,
-47098,
-48322,
-49201,
-49644,
-49564,
-48896,
-47549,
-45481,
-42682,
-39236,
-35316,
-31173,
-27098,
-23367,
-20193,
-17707,
-15948,
-14909,
-14545,
-14795,
-15593,
-16826,
-18337,
-19936,
-21376,
-22486,
-23129,
-23319,
-23168,
-22854,
-22578,
-22469,
-22583,
-22907,
-23377,
-23990,
-24765,
-25811,
-27229,
-29077,
-31314,
-33759,
-36160,
-38221,
-39727,
-40552,
-40728,
-40347,
-39567,
-38487,
-37184,
-35656,
-33934,
-32061,
-30185,
-28496,
-27230,
-26558,
-26589,
-27285,
-28542,
-30166,
-31994,
-33867,
-35708,
-37455,
-39067,
-40491,
-41651,
-42473,
-42899,
-42938,
-42647,
-42166,
-41658,
-41293,
-41206,
-41476,
-42125,
-43098,
-44331,
-45691,
-47072,
-48330,
-49339,
-49944,
-50014,
-49411,
-48046,
-45873,
-42930,
-39342,
-35312,
-31115,
-27025,
-23309,
-20159,
-17693,
-15948,
-14903,
-14518,
-14720,
-15463,
-16637,
-18128,
-19752,
-21297,
-22557,
-23387,
-23732,
-23663,
-23348,
-22968,
-22736,
-22715,
-22959,
-23406,
-24023,
-24795,
-25790,
-27089,
-28792,
-30889,
-33275,
-35716,
-37934,
-39641,
-40667,
-40948,
-40547,
-39614,
-38293,
-36698,
-34923,
-32981,
-30984,
-29028,
-27309,
-26047,
-25396,
-25476,
-26229,
-27547,
-29221,
-31073,
-32957,
-34806,
-36593,
-38307,
-39894,
-41267,
-42299,
-42881,
-42985,
-42642,
-42045,
-41367,
-40881,
-40725,
-41008,
-41725,
-42791,
-44096,
-45518,
-46926,
-48227,
-49292,
-49991,
-50175,
-49674,
-48378,
-46205,
-43205,
-39503,
-35326,
-30956,
-26693,
-22790,
-19472,
-16837,
-14974,
-13851,
-13462,
-13711,
-14541,
-15804,
-17374,
-19041,
-20621,
-21912,
-22795,
-23211,
-23230,
-22970,
-22635,
-22381,
-22348,
-22582,
-23070,
-23793,
-24706,
-25844,
-27245,
-28958,
-31006,
-33284,
-35641,
-37815,
-39559,
-40677,
-41070,
-40780,
-39914,
-38649,
-37115,
-35428,
-33640,
-31806,
-30014,
-28387,
-27124,
-26386,
-26312,
-26924,
-28128,
-29766,
-31631,
-33552,
-35430,
-37207,
-38888,
-40430,
-41789,
-42838,
-43492,
-43675,
-43438,
-42911,
-42316,
-41882,
-41792,
-42132,
-42878,
-43930,
-45148,
-46426,
-47659,
-48808,
-49788,
-50504,
-50788,
-50456,
-49308,
-47266,
-44308,
-40615,
-36425,
-32073,
-27879,
-24106,
-20937,
-18468,
-16711,
-15663,
-15263,
-15466,
-16184,
-17313,
-18706,
-20187,
-21579,
-22718,
-23498,
-23886,
-23924,
-23726,
-23433,
-23196,
-23131,
-23314,
-23768,
-24495,
-25469,
-26690,
-28151,
-29842,
-31763,
-33803,
-35886,
-37793,
-39373,
-40440,
-40898,
-40720,
-39960,
-38716,
-37124,
-35296,
-33340,
-31370,
-29480,
-27837,
-26567,
-25848,
-25747,
-26311,
-27430,
-28979,
-30749,
-32597,
-34391,
-36099,
-37690,
-39162,
-40448,
-41462,
-42081,
-42240,
-41945,
-41331,
-40618,
-40078,
-39926,
-40294,
-41153,
-42390,
-43788,
-45183,
-46417,
-47436,
-48202,
-48673,
-48768,
-48339,
-47218,
-45262,
-42434,
-38804,
-34612,
-30139,
-25751,
-21725,
-18297,
-15601,
-13687,
-12576,
-12233,
-12605,
-13599,
-15061,
-16798,
-18578,
-20177,
-21435,
-22248,
-22641,
-22689,
-22532,
-22315,
-22157,
-22140,
-22336,
-22770,
-23489,
-24527,
-25899,
-27620,
-29630,
-31854,
-34146,
-36351,
-38307,
-39865,
-40933,
-41436,
-41383,
-40768,
-39670,
-38142,
-36290,
-34223,
-32089,
-30050,
-28292,
-26988,
-26284,
-26242,
-26882,
-28078,
-29707,
-31561,
-33481,
-35344,
-37082,
-38671,
-40098,
-41322,
-42281,
-42877,
-43053,
-42796,
-42219,
-41508,
-40920,
-40682,
-40954,
-41738,
-42949,
-44376,
-45830,
-47145,
-48235,
-49068,
-49621,
-49832,
-49563,
-48641,
-46880,
-44209,
-40657,
-36458,
-31921,
-27439,
-23344,
-19878,
-17163,
-15226,
-14028,
-13533,
-13686,
-14440,
-15694,
-17291,
-19005,
-20598,
-21836,
-22610,
-22886,
-22783,
-22466,
-22118,
-21889,
-21855,
-22039,
-22447,
-23077,
-23977,
-25195,
-26779,
-28731,
-30957,
-33311,
-35581,
-37550,
-39064,
-40003,
-40363,
-40173,
-39497,
-38412,
-36982,
-35265,
-33353,
-31341,
-29395,
-27683,
-26396,
-25678,
-25623,
-26235,
-27428,
-29076,
-30980,
-32999,
-34976,
-36825,
-38493,
-39943,
-41137,
-42035,
-42581,
-42739,
-42535,
-42035,
-41422,
-40877,
-40630,
-40816,
-41503,
-42622,
-44029,
-45524,
-46927,
-48090,
-48953,
-49444,
-49550,
-49166,
-48191,
-46500,
-43995,
-40716,
-36774,
-32460,
-28083,
-23998,
-20465,
-17666,
-15656,
-14433,
-13928,
-14082,
-14814,
-16023,
-17569,
-19246,
-20846,
-22130,
-22982,
-23331,
-23273,
-22956,
-22576,
-22303,
-22243,
-22432,
-22862,
-23521,
-24420,
-25593,
-27102,
-28945,
-31094,
-33402,
-35683,
-37716,
-39311,
-40340,
-40774,
-40647,
-40030,
-39034,
-37700,
-36119,
-34321,
-32394,
-30458,
-28662,
-27202,
-26243,
-25917,
-26267,
-27247,
-28730,
-30539,
-32485,
-34419,
-36229,
-37879,
-39354,
-40665,
-41793,
-42683,
-43283,
-43510,
-43376,
-42932,
-42330,
-41778,
-41470,
-41562,
-42106,
-43040,
-44240,
-45532,
-46782,
-47894,
-48837,
-49572,
-50068,
-50194,
-49797,
-48684,
-46720,
-43877,
-40273,
-36159,
-31863,
-27732,
-24029,
-20936,
-18505,
-16724,
-15554,
-14940,
-14888,
-15357,
-16335,
-17700,
-19302,
-20924,
-22345,
-23399,
-23988,
-24142,
-23962,
-23626,
-23288,
-23095,
-23104,
-23340,
-23777,
-24393,
-25199,
-26222,
-27532,
-29163,
-31114,
-33300,
-35560,
-37677,
-39435,
-40658,
-41257,
-41254,
-40715,
-39784,
-38551,
-37111,
-35483,
-33710,
-31819,
-29941,
-28221,
-26880,
-26100,
-26009,
-26625,
-27856,
-29528,
-31433,
-33394,
-35281,
-37036,
-38640,
-40087,
-41342,
-42347,
-43021,
-43294,
-43174,
-42710,
-42071,
-41444,
-41043,
-41022,
-41453,
-42317,
-43495,
-44846,
-46203,
-47441,
-48493,
-49296,
-49829,
-50019,
-49755,
-48902,
-47299,
-44868,
-41607,
-37670,
-33316,
-28893,
-24743,
-21150,
-18279,
-16177,
-14800,
-14059,
-13873,
-14182,
-14944,
-16106,
-17559,
-19148,
-20657,
-21882,
-22685,
-23009,
-22945,
-22634,
-22282,
-22037,
-22001,
-22180,
-22551,
-23060,
-23729,
-24579,
-25725,
-27232,
-29137,
-31374,
-33796,
-36167,
-38259,
-39847,
-40811,
-41108,
-40783,
-39949,
-38706,
-37194,
-35469,
-33635,
-31732,
-29890,
-28193,
-26826,
-25905,
-25567,
-25851,
-26738,
-28122,
-29851,
-31763,
-33717,
-35609,
-37403,
-39036,
-40513,
-41740,
-42678,
-43216,
-43341,
-43050,
-42471,
-41768,
-41155,
-40833,
-40918,
-41465,
-42414,
-43655,
-45050,
-46460,
-47772,
-48895,
-49729,
-50186,
-50131,
-49460,
-48054,
-45880,
-42961,
-39426,
-35467,
-31341,
-27300,
-23588,
-20388,
-17828,
-15967,
-14826,
-14376,
-14569,
-15325,
-16537,
-18059,
-19718,
-21321,
-22677,
-23647,
-24161,
-24234,
-23985,
-23556,
-23142,
-22870,
-22846,
-23071,
-23560,
-24255,
-25187,
-26359,
-27823,
-29596,
-31643,
-33858,
-36063,
-38052,
-39633,
-40681,
-41153,
-41084,
-40552,
-39652,
-38440,
-36957,
-35239,
-33319,
-31333,
-29406,
-27781,
-26621,
-26103,
-26265,
-27065,
-28383,
-30018,
-31820,
-33623,
-35370,
-37002,
-38543,
-39944,
-41198,
-42207,
-42898,
-43199,
-43096,
-42650,
-42010,
-41366,
-40927,
-40864,
-41242,
-42060,
-43192,
-44502,
-45822,
-47034,
-48059,
-48846,
-49347,
-49479,
-49114,
-48109,
-46324,
-43727,
-40361,
-36433,
-32215,
-28029,
-24161,
-20823,
-18105,
-16045,
-14599,
-13744,
-13440,
-13687,
-14433,
-15623,
-17104,
-18692,
-20181,
-21366,
-22157,
-22495,
-22482,
-22208,
-21854,
-21528,
-21338,
-21328,
-21522,
-21937,
-22591,
-23537,
-24808,
-26437,
-28407,
-30622,
-32950,
-35186,
-37125,
-38594,
-39474,
-39742,
-39439,
-38672,
-37551,
-36186,
-34648,
-32991,
-31264,
-29550,
-27954,
-26648,
-25782,
-25498,
-25865,
-26854,
-28362,
-30226,
-32263,
-34334,
-36326,
-38175,
-39854,
-41308,
-42506,
-43369,
-43849,
-43939,
-43672,
-43186,
-42627,
-42198,
-42043,
-42258,
-42863,
-43786,
-44923,
-46139,
-47317,
-48368,
-49228,
-49844,
-50146,
-50043,
-49402,
-48090,
-46007,
-43120,
-39514,
-35375,
-31002,
-26716,
-22840,
-19598,
-17117,
-15427,
-14450,
-14124,
-14318,
-15000,
-16051,
-17426,
-18947,
-20483,
-21793,
-22760,
-23247,
-23307,
-23032,
-22617,
-22249,
-22074,
-22152,
-22491,
-23028,
-23742,
-24624,
-25722,
-27107,
-28830,
-30874,
-33142,
-35458,
-37588,
-39334,
-40521,
-41077,
-41009,
-40382,
-39302,
-37878,
-36201,
-34358,
-32441,
-30535,
-28778,
-27298,
-26253,
-25743,
-25857,
-26574,
-27828,
-29489,
-31385,
-33372,
-35314,
-37140,
-38793,
-40262,
-41496,
-42462,
-43080,
-43315,
-43143,
-42648,
-41964,
-41305,
-40880,
-40866,
-41333,
-42267,
-43528,
-44962,
-46385,
-47668,
-48722,
-49490,
-49928,
-49956,
-49466,
-48336,
-46466,
-43821,
-40467,
-36570,
-32373,
-28162,
-24202,
-20709,
-17835,
-15646,
-14181,
-13413,
-13319,
-13833,
-14866,
-16289,
-17940,
-19607,
-21118,
-22275,
-23006,
-23278,
-23166,
-22822,
-22403,
-22084,
-21972,
-22127,
-22551,
-23208,
-24089,
-25173,
-26509,
-28125,
-30017,
-32154,
-34380,
-36525,
-38372,
-39731,
-40515,
-40689,
-40332,
-39535,
-38403,
-36998,
-35365,
-33525,
-31557,
-29577,
-27778,
-26393,
-25600,
-25541,
-26200,
-27475,
-29173,
-31073,
-33011,
-34850,
-36576,
-38164,
-39641,
-40967,
-42086,
-42903,
-43333,
-43361,
-43013,
-42445,
-41824,
-41361,
-41219,
-41484,
-42162,
-43181,
-44410,
-45727,
-47009,
-48178,
-49167,
-49899,
-50283,
-50174,
-49429,
-47896,
-45513,
-42319,
-38471,
-34252,
-29978,
-25961,
-22457,
-19590,
-17409,
-15887,
-14958,
-14592,
-14744,
-15401,
-16505,
-17935,
-19533,
-21062,
-22344,
-23206,
-23625,
-23644,
-23408,
-23092,
-22843,
-22760,
-22890,
-23207,
-23713,
-24386,
-25271,
-26418,
-27878,
-29669,
-31726,
-33943,
-36105,
-38040,
-39525,
-40463,
-40793,
-40550,
-39837,
-38745,
-37405,
-35861,
-34193,
-32420,
-30628,
-28924,
-27457,
-26416,
-25937,
-26119,
-26942,
-28302,
-30020,
-31903,
-33791,
-35586,
-37252,
-38795,
-40202,
-41449,
-42432,
-43070,
-43268,
-43042,
-42474,
-41762,
-41130,
-40803,
-40910,
-41497,
-42483,
-43725,
-45060,
-46341,
-47470,
-48406,
-49100,
-49518,
-49569,
-49123,
-48055,
-46218,
-43598,
-40205,
-36247,
-31943,
-27640,
-23625,
-20174,
-17444,
-15522,
-14366,
-13931,
-14079,
-14734,
-15763,
-17074,
-18517,
-19947,
-21193,
-22114,
-22620,
-22714,
-22489,
-22106,
-21753,
-21577,
-21655,
-21996,
-22531,
-23219,
-24012,
-24974,
-26169,
-27701,
-29607,
-31826,
-34203,
-36499,
-38455,
-39867,
-40611,
-40678,
-40154,
-39160,
-37823,
-36255,
-34507,
-32665,
-30778,
-28974,
-27390,
-26188,
-25516,
-25453,
-26019,
-27128,
-28664,
-30446,
-32347,
-34226,
-36037,
-37719,
-39268,
-40638,
-41773,
-42604,
-43051,
-43087,
-42748,
-42146,
-41466,
-40931,
-40715,
-40964,
-41681,
-42794,
-44167,
-45603,
-46979,
-48152,
-49072,
-49670,
-49875,
-49598,
-48704,
-47088,
-44694,
-41550,
-37809,
-33701,
-29512,
-25527,
-21969,
-18992,
-16673,
-15015,
-14034,
-13675,
-13947,
-14768,
-16068,
-17691,
-19442,
-21110,
-22482,
-23420,
-23875,
-23876,
-23580,
-23132,
-22741,
-22520,
-22573,
-22903,
-23510,
-24359,
-25440,
-26781,
-28380,
-30282,
-32404,
-34673,
-36879,
-38847,
-40356,
-41293,
-41606,
-41344,
-40611,
-39523,
-38172,
-36609,
-34861,
-32973,
-31029,
-29194,
-27678,
-26684,
-26381,
-26790,
-27851,
-29373,
-31144,
-32979,
-34742,
-36418,
-37994,
-39513,
-40925,
-42176,
-43119,
-43671,
-43752,
-43424,
-42825,
-42157,
-41654,
-41484,
-41738,
-42428,
-43459,
-44730,
-46095,
-47438,
-48649,
-49613,
-50216,
-50318,
-49788,
-48502,
-46409,
-43512,
-39951,
-35905,
-31676,
-27532,
-23759,
-20553,
-18042,
-16262,
-15197,
-14778,
-14945,
-15605,
-16682,
-18048,
-19559,
-21018,
-22253,
-23088,
-23482,
-23450,
-23135,
-22728,
-22417,
-22343,
-22547,
-23024,
-23701,
-24555,
-25590,
-26861,
-28453,
-30373,
-32568,
-34856,
-36986,
-38700,
-39797,
-40184,
-39912,
-39079,
-37854,
-36340,
-34617,
-32725,
-30705,
-28672,
-26792,
-25299,
-24400,
-24244,
-24845,
-26092,
-27790,
-29722,
-31692,
-33627,
-35458,
-37207,
-38837,
-40275,
-41415,
-42132,
-42364,
-42149,
-41618,
-41007,
-40535,
-40409,
-40716,
-41453,
-42531,
-43815,
-45188,
-46539,
-47807,
-48892,
-49705,
-50084,
-49864,
-48879,
-47029,
-44294,
-40811,
-36772,
-32507,
-28301,
-24475,
-21217,
-18694,
-16926,
-15915,
-15593,
-15864,
-16630,
-17765,
-19117,
-20546,
-21859,
-22929,
-23626,
-23924,
-23856,
-23546,
-23144,
-22835,
-22720,
-22898,
-23355,
-24068,
-25008,
-26150,
-27537,
-29187,
-31123,
-33283,
-35531,
-37646,
-39400,
-40563,
-41040,
-40805,
-39966,
-38677,
-37096,
-35344,
-33507,
-31623,
-29783,
-28084,
-26706,
-25833,
-25604,
-26093,
-27229,
-28864,
-30776,
-32789,
-34732,
-36593,
-38305,
-39908,
-41305,
-42427,
-43127,
-43338,
-43058,
-42440,
-41714,
-41173,
-41037,
-41432,
-42312,
-43539,
-44898,
-46224,
-47395,
-48389,
-49195,
-49777,
-50044,
-49791,
-48815,
-46932,
-44080,
-40369,
-36048,
-31478,
-27031,
-23024,
-19660,
-17036,
-15156,
-13991,
-13484,
-13603,
-14278,
-15432,
-16917,
-18547,
-20108,
-21413,
-22319,
-22793,
-22864,
-22666,
-22343,
-22056,
-21925,
-22036,
-22423,
-23107,
-24082,
-25353,
-26913,
-28752,
-30818,
-33028,
-35238,
-37274,
-38950,
-40098,
-40631,
-40495,
-39779,
-38543,
-36964,
-35133,
-33194,
-31222,
-29355,
-27701,
-26441,
-25718,
-25659,
-26303,
-27575,
-29315,
-31301,
-33303,
-35186,
-36854,
-38336,
-39647,
-40810,
-41775,
-42449,
-42734,
-42589,
-42090,
-41423,
-40850,
-40636,
-40942,
-41807,
-43092,
-44605,
-46096,
-47418,
-48470,
-49251,
-49753,
-49924,
-49643,
-48707,
-46959,
-44277,
-40745,
-36570,
-32097,
-27721,
-23763,
-20460,
-17907,
-16104,
-15005,
-14555,
-14701,
-15404,
-16558,
-18046,
-19633,
-21131,
-22305,
-23084,
-23415,
-23432,
-23243,
-23032,
-22882,
-22884,
-23025,
-23341,
-23847,
-24603,
-25701,
-27182,
-29071,
-31271,
-33647,
-35966,
-38032,
-39649,
-40702,
-41156,
-41020,
-40356,
-39241,
-37744,
-35961,
-33975,
-31932,
-29970,
-28292,
-27054,
-26420,
-26447,
-27137,
-28384,
-30031,
-31895,
-33807,
-35644,
-37348,
-38896,
-40283,
-41494,
-42465,
-43127,
-43406,
-43282,
-42825,
-42188,
-41601,
-41294,
-41439,
-42102,
-43216,
-44629,
-46129,
-47540,
-48724,
-49621,
-50184,
-50375,
-50073,
-49158,
-47453,
-44886,
-41467,
-37385,
-32928,
-28484,
-24387,
-20924,
-18224,
-16320,
-15175,
-14708,
-14867,
-15584,
-16775,
-18313,
-19988,
-21572,
-22829,
-23609,
-23879,
-23730,
-23357,
-22946,
-22692,
-22642,
-22836,
-23217,
-23779,
-24543,
-25590,
-27014,
-28855,
-31069,
-33495,
-35886,
-37985,
-39566,
-40521,
-40832,
-40602,
-39918,
-38912,
-37620,
-36082,
-34317,
-32394,
-30434,
-28636,
-27207,
-26334,
-26141,
-26621,
-27717,
-29250,
-31073,
-33002,
-34944,
-36791,
-38516,
-40040,
-41322,
-42287,
-42872,
-43059,
-42864,
-42397,
-41809,
-41292,
-41040,
-41179,
-41788,
-42816,
-44166,
-45665,
-47129,
-48406,
-49349,
-49881,
-49909,
-49374,
-48186,
-46289,
-43642,
-40297,
-36381,
-32129,
-27826,
-23779,
-20249,
-17414,
-15363,
-14097,
-13571,
-13708,
-14428,
-15612,
-17139,
-18802,
-20404,
-21727,
-22613,
-23018,
-22994,
-22703,
-22348,
-22103,
-22084,
-22315,
-22772,
-23408,
-24234,
-25293,
-26670,
-28439,
-30571,
-32959,
-35379,
-37552,
-39247,
-40303,
-40685,
-40480,
-39792,
-38772,
-37471,
-35943,
-34185,
-32253,
-30269,
-28415,
-26944,
-26051,
-25884,
-26448,
-27641,
-29296,
-31196,
-33189,
-35148,
-37020,
-38761,
-40319,
-41632,
-42599,
-43168,
-43303,
-43062,
-42576,
-42019,
-41591,
-41445,
-41680,
-42322,
-43310,
-44575,
-45958,
-47384,
-48670,
-49748,
-50429,
-50632,
-50181,
-49002,
-47008,
-44232,
-40754,
-36777,
-32541,
-28355,
-24474,
-21160,
-18520,
-16663,
-15537,
-15116,
-15294,
-15996,
-17107,
-18518,
-20062,
-21571,
-22847,
-23750,
-24195,
-24214,
-23924,
-23515,
-23179,
-23052,
-23209,
-23629,
-24277,
-25110,
-26136,
-27417,
-29007,
-30952,
-33165,
-35504,
-37683,
-39470,
-40615,
-41050,
-40773,
-39928,
-38659,
-37128,
-35421,
-33596,
-31706,
-29832,
-28120,
-26760,
-25934,
-25770,
-26287,
-27387,
-28907,
-30639,
-32446,
-34222,
-35948,
-37605,
-39174,
-40550,
-41638,
-42285,
-42460,
-42178,
-41605,
-40948,
-40457,
-40294,
-40557,
-41204,
-42155,
-43277,
-44471,
-45658,
-46786,
-47786,
-48544,
-48901,
-48657,
-47644,
-45743,
-42961,
-39408,
-35322,
-30966,
-26648,
-22612,
-19066,
-16151,
-13950,
-12513,
-11836,
-11894,
-12589,
-13794,
-15307,
-16939,
-18454,
-19715,
-20597,
-21105,
-21289,
-21277,
-21199,
-21193,
-21329,
-21659,
-22174,
-22872,
-23755,
-24851,
-26211,
-27881,
-29852,
-32067,
-34369,
-36552,
-38404,
-39723,
-40424,
-40474,
-39960,
-38975,
-37656,
-36073,
-34320,
-32458,
-30591,
-28882,
-27501,
-26647,
-26446,
-26926,
-28015,
-29542,
-31303,
-33130,
-34898,
-36579,
-38161,
-39651,
-40981,
-42068,
-42766,
-43016,
-42786,
-42235,
-41541,
-40997,
-40802,
-41087,
-41844,
-42956,
-44252,
-45571,
-46799,
-47871,
-48765,
-49420,
-49730,
-49537,
-48641,
-46895,
-44241,
-40745,
-36638,
-32211,
-27818,
-23761,
-20267,
-17477,
-15432,
-14139,
-13543,
-13607,
-14241,
-15355,
-16794,
-18401,
-19949,
-21292,
-22256,
-22811,
-22956,
-22805,
-22483,
-22166,
-21974,
-22022,
-22350,
-22981,
-23916,
-25136,
-26652,
-28435,
-30457,
-32642,
-34862,
-36940,
-38696,
-39952,
-40589,
-40576,
-39936,
-38773,
-37213,
-35382,
-33395,
-31366,
-29411,
-27665,
-26305,
-25465,
-25283,
-25780,
-26903,
-28496,
-30365,
-32310,
-34204,
-35968,
-37610,
-39122,
-40493,
-41632,
-42441,
-42804,
-42698,
-42215,
-41537,
-40960,
-40714,
-40980,
-41768,
-42968,
-44382,
-45799,
-47086,
-48159,
-49024,
-49657,
-49983,
-49860,
-49049,
-47385,
-44734,
-41193,
-36966,
-32423,
-27951,
-23876,
-20435,
-17709,
-15717,
-14421,
-13794,
-13819,
-14469,
-15666,
-17247,
-18980,
-20596,
-21859,
-22652,
-22952,
-22903,
-22661,
-22424,
-22300,
-22349,
-22565,
-22939,
-23493,
-24296,
-25431,
-26977,
-28923,
-31179,
-33559,
-35836,
-37803,
-39299,
-40257,
-40659,
-40543,
-39934,
-38862,
-37366,
-35494,
-33396,
-31234,
-29259,
-27691,
-26699,
-26372,
-26689,
-27557,
-28854,
-30442,
-32239,
-34156,
-36127,
-38061,
-39826,
-41296,
-42343,
-42908,
-43014,
-42769,
-42352,
-41947,
-41730,
-41806,
-42215,
-42948,
-43949,
-45148,
-46467,
-47801,
-49037,
-50002,
-50536,
-50445,
-49590,
-47899,
-45367,
-42106,
-38283,
-34136,
-29910,
-25876,
-22246,
-19250,
-17004,
-15622,
-15083,
-15327,
-16192,
-17472,
-18951,
-20409,
-21690,
-22693,
-23376,
-23768,
-23900,
-23862,
-23706,
-23551,
-23468,
-23588,
-23997,
-24790,
-25999,
-27619,
-29563,
-31723,
-33930,
-36041,
-37905,
-39409,
-40471,
-41021,
-41030,
-40473,
-39371,
-37793,
-35846,
-33715,
-31595,
-29709,
-28252,
-27357,
-27099,
-27467,
-28393,
-29774,
-31478,
-33383,
-35365,
-37305,
-39111,
-40656,
-41878,
-42695,
-43089,
-43103,
-42805,
-42344,
-41873,
-41546,
-41502,
-41814,
-42512,
-43559,
-44874,
-46336,
-47802,
-49113,
-50101,
-50597,
-50442,
-49508,
-47713,
-45057,
-41615,
-37566,
-33161,
-28705,
-24513,
-20861,
-17971,
-15958,
-14851,
-14584,
-15024,
-15999,
-17306,
-18758,
-20162,
-21387,
-22311,
-22892,
-23120,
-23057,
-22795,
-22462,
-22189,
-22096,
-22275,
-22791,
-23675,
-24933,
-26552,
-28484,
-30654,
-32950,
-35219,
-37281,
-38951,
-40071,
-40532,
-40300,
-39423,
-38006,
-36204,
-34196,
-32132,
-30193,
-28484,
-27149,
-26280,
-25953,
-26223,
-27062,
-28430,
-30191,
-32218,
-34326,
-36383,
-38258,
-39855,
-41133,
-42034,
-42565,
-42741,
-42609,
-42286,
-41898,
-41623,
-41603,
-41973,
-42740,
-43900,
-45299,
-46799,
-48201,
-49345,
-50069,
-50269,
-49824,
-48663,
-46722,
-44001,
-40550,
-36537,
-32180,
-27798,
-23686,
-20137,
-17337,
-15401,
-14322,
-14034,
-14405,
-15295,
-16530,
-17968,
-19425,
-20760,
-21837,
-22568,
-22942,
-22998,
-22856,
-22653,
-22549,
-22643,
-23033,
-23730,
-24745,
-26068,
-27671,
-29537,
-31606,
-33792,
-35958,
-37937,
-39544,
-40634,
-41088,
-40902,
-40094,
-38776,
-37084,
-35140,
-33129,
-31166,
-29427,
-28048,
-27161,
-26874,
-27216,
-28171,
-29636,
-31478,
-33525,
-35619,
-37626,
-39429,
-40957,
-42132,
-42917,
-43276,
-43250,
-42904,
-42386,
-41877,
-41557,
-41591,
-42047,
-42925,
-44132,
-45527,
-46950,
-48260,
-49323,
-50046,
-50309,
-50005,
-49010,
-47229,
-44608,
-41207,
-37185,
-32797,
-28384,
-24258,
-20724,
-17960,
-16084,
-15069,
-14867,
-15340,
-16342,
-17696,
-19216,
-20695,
-21974,
-22891,
-23408,
-23511,
-23316,
-22955,
-22589,
-22368,
-22373,
-22671,
-23259,
-24166,
-25371,
-26900,
-28718,
-30788,
-32980,
-35156,
-37082,
-38607,
-39540,
-39832,
-39458,
-38493,
-37035,
-35220,
-33183,
-31073,
-29053,
-27286,
-25945,
-25166,
-25040,
-25574,
-26701,
-28284,
-30151,
-32151,
-34133,
-36013,
-37711,
-39177,
-40338,
-41147,
-41545,
-41538,
-41201,
-40659,
-40121,
-39772,
-39791,
-40248,
-41158,
-42421,
-43902,
-45452,
-46893,
-48095,
-48907,
-49180,
-48786,
-47590,
-45534,
-42632,
-39015,
-34897,
-30587,
-26378,
-22569,
-19355,
-16884,
-15197,
-14314,
-14188,
-14756,
-15915,
-17493,
-19300,
-21082,
-22612,
-23727,
-24325,
-24473,
-24270,
-23937,
-23636,
-23546,
-23722,
-24217,
-25000,
-26068,
-27405,
-29013,
-30862,
-32903,
-35001,
-37005,
-38718,
-39982,
-40684,
-40778,
-40301,
-39316,
-37911,
-36201,
-34259,
-32224,
-30227,
-28443,
-27053,
-26219,
-26029,
-26523,
-27598,
-29157,
-31003,
-33009,
-35037,
-36993,
-38797,
-40366,
-41599,
-42422,
-42776,
-42689,
-42272,
-41705,
-41219,
-41010,
-41224,
-41882,
-42934,
-44240,
-45652,
-47023,
-48237,
-49205,
-49818,
-49976,
-49525,
-48334,
-46315,
-43434,
-39815,
-35644,
-31223,
-26868,
-22886,
-19519,
-16936,
-15216,
-14363,
-14329,
-14984,
-16171,
-17672,
-19257,
-20700,
-21836,
-22553,
-22861,
-22830,
-22597,
-22312,
-22099,
-22050,
-22210,
-22615,
-23280,
-24259,
-25567,
-27247,
-29258,
-31514,
-33872,
-36118,
-38056,
-39500,
-40319,
-40470,
-39949,
-38829,
-37213,
-35235,
-33058,
-30866,
-28853,
-27212,
-26104,
-25620,
-25803,
-26576,
-27859,
-29490,
-31346,
-33308,
-35269,
-37172,
-38910,
-40419,
-41583,
-42340,
-42655,
-42566,
-42183,
-41678,
-41235,
-41034,
-41192,
-41747,
-42688,
-43916,
-45330,
-46779,
-48130,
-49212,
-49868,
-49922,
-49212,
-47656,
-45195,
-41941,
-38036,
-33760,
-29408,
-25272,
-21626,
-18642,
-16458,
-15084,
-14527,
-14666,
-15408,
-16568,
-17968,
-19422,
-20748,
-21830,
-22582,
-23011,
-23150,
-23103,
-22958,
-22834,
-22813,
-22992,
-23424,
-24188,
-25302,
-26800,
-28631,
-30729,
-32961,
-35164,
-37177,
-38827,
-40011,
-40632,
-40674,
-40142,
-39081,
-37577,
-35728,
-33685,
-31600,
-29676,
-28060,
-26942,
-26382,
-26456,
-27116,
-28300,
-29899,
-31778,
-33823,
-35889,
-37869,
-39627,
-41056,
-42076,
-42628,
-42747,
-42502,
-42053,
-41557,
-41218,
-41150,
-41463,
-42148,
-43169,
-44428,
-45807,
-47185,
-48428,
-49407,
-49986,
-50006,
-49350,
-47899,
-45614,
-42540,
-38801,
-34622,
-30291,
-26087,
-22327,
-19209,
-16915,
-15493,
-14939,
-15151,
-15983,
-17240,
-18707,
-20187,
-21495,
-22509,
-23169,
-23466,
-23471,
-23277,
-22998,
-22764,
-22668,
-22804,
-23236,
-23997,
-25115,
-26576,
-28344,
-30348,
-32488,
-34623,
-36631,
-38340,
-39640,
-40407,
-40568,
-40095,
-39002,
-37367,
-35337,
-33083,
-30844,
-28836,
-27269,
-26282,
-25953,
-26266,
-27163,
-28522,
-30219,
-32125,
-34129,
-36121,
-38000,
-39668,
-41016,
-41982,
-42506,
-42614,
-42373,
-41915,
-41403,
-41003,
-40860,
-41069,
-41665,
-42637,
-43895,
-45350,
-46824,
-48185,
-49208,
-49738,
-49574,
-48602,
-46743,
-44013,
-40528,
-36475,
-32128,
-27771,
-23706,
-20169,
-17351,
-15350,
-14180,
-13800,
-14082,
-14902,
-16078,
-17450,
-18858,
-20153,
-21223,
-22003,
-22437,
-22572,
-22451,
-22189,
-21930,
-21792,
-21929,
-22419,
-23332,
-24672,
-26406,
-28454,
-30705,
-33024,
-35250,
-37240,
-38826,
-39914,
-40387,
-40257,
-39508,
-38249,
-36575,
-34632,
-32580,
-30557,
-28729,
-27221,
-26170,
-25663,
-25775,
-26496,
-27789,
-29533,
-31576,
-33745,
-35861,
-37787,
-39412,
-40676,
-41551,
-42040,
-42189,
-42045,
-41735,
-41368,
-41114,
-41111,
-41477,
-42254,
-43424,
-44868,
-46428,
-47915,
-49146,
-49968,
-50264,
-49941,
-48934,
-47195,
-44715,
-41518,
-37730,
-33526,
-29185,
-25014,
-21308,
-18337,
-16232,
-15061,
-14750,
-15174,
-16148,
-17467,
-18955,
-20410,
-21711,
-22722,
-23382,
-23689,
-23671,
-23464,
-23182,
-22992,
-23015,
-23328,
-23981,
-24961,
-26256,
-27828,
-29656,
-31689,
-33857,
-36061,
-38115,
-39863,
-41094,
-41681,
-41538,
-40690,
-39233,
-37340,
-35208,
-33046,
-31042,
-29359,
-28126,
-27439,
-27358,
-27885,
-28992,
-30569,
-32486,
-34562,
-36633,
-38543,
-40177,
-41462,
-42369,
-42893,
-43081,
-42975,
-42683,
-42322,
-42030,
-41968,
-42249,
-42947,
-44060,
-45477,
-47051,
-48545,
-49740,
-50418,
-50416,
-49617,
-47987,
-45525,
-42321,
-38507,
-34297,
-29935,
-25732,
-21962,
-18896,
-16690,
-15425,
-15038,
-15414,
-16328,
-17585,
-18955,
-20286,
-21438,
-22333,
-22923,
-23198,
-23182,
-22951,
-22611,
-22312,
-22205,
-22438,
-23110,
-24255,
-25854,
-27798,
-29974,
-32216,
-34372,
-36301,
-37865,
-38952,
-39472,
-39358,
-38608,
-37262,
-35435,
-33312,
-31083,
-28999,
-27234,
-25971,
-25285,
-25228,
-25769,
-26862,
-28401,
-30286,
-32372,
-34522,
-36581,
-38403,
-39886,
-40939,
-41572,
-41814,
-41767,
-41576,
-41371,
-41311,
-41486,
-41975,
-42790,
-43893,
-45217,
-46617,
-47958,
-49056,
-49731,
-49832,
-49218,
-47814,
-45607,
-42650,
-39075,
-35080,
-30909,
-26838,
-23152,
-20077,
-17818,
-16449,
-15974,
-16289,
-17203,
-18491,
-19911,
-21242,
-22335,
-23084,
-23491,
-23575,
-23438,
-23177,
-22918,
-22776,
-22856,
-23254,
-24024,
-25214,
-26792,
-28721,
-30885,
-33159,
-35376,
-37369,
-38990,
-40091,
-40593,
-40432,
-39623,
-38228,
-36369,
-34220,
-31988,
-29895,
-28137,
-26883,
-26231,
-26218,
-26820,
-27962,
-29538,
-31428,
-33489,
-35602,
-37607,
-39397,
-40838,
-41858,
-42420,
-42553,
-42351,
-41963,
-41566,
-41336,
-41413,
-41883,
-42754,
-43968,
-45411,
-46920,
-48329,
-49450,
-50116,
-50172,
-49492,
-47985,
-45624,
-42447,
-38578,
-34233,
-29679,
-25256,
-21275,
-18025,
-15700,
-14380,
-14031,
-14501,
-15578,
-16998,
-18515,
-19920,
-21061,
-21863,
-22320,
-22453,
-22367,
-22146,
-21912,
-21797,
-21885,
-22304,
-23097,
-24316,
-25945,
-27933,
-30184,
-32554,
-34890,
-36991,
-38706,
-39857,
-40358,
-40139,
-39237,
-37722,
-35758,
-33534,
-31266,
-29184,
-27464,
-26273,
-25695,
-25764,
-26466,
-27711,
-29395,
-31375,
-33489,
-35595,
-37538,
-39212,
-40520,
-41420,
-41902,
-42000,
-41809,
-41435,
-41038,
-40776,
-40784,
-41179,
-42001,
-43216,
-44731,
-46355,
-47892,
-49094,
-49753,
-49686,
-48775,
-46984,
-44336,
-40957,
-37007,
-32746,
-28430,
-24355,
-20784,
-17932,
-15943,
-14868,
-14657,
-15184,
-16260,
-17653,
-19155,
-20554,
-21723,
-22554,
-23046,
-23198,
-23119,
-22885,
-22645,
-22516,
-22623,
-23063,
-23905,
-25171,
-26844,
-28864,
-31107,
-33453,
-35713,
-37722,
-39314,
-40338,
-40716,
-40398,
-39425,
-37890,
-35948,
-33798,
-31646,
-29699,
-28135,
-27068,
-26591,
-26702,
-27387,
-28569,
-30164,
-32043,
-34091,
-36159,
-38100,
-39798,
-41122,
-42021,
-42477,
-42537,
-42320,
-41964,
-41644,
-41511,
-41675,
-42212,
-43103,
-44313,
-45710,
-47169,
-48500,
-49539,
-50088,
-49999,
-49135,
-47437,
-44899,
-41617,
-37747,
-33537,
-29248,
-25187,
-21599,
-18721,
-16665,
-15500,
-15179,
-15584,
-16551,
-17861,
-19306,
-20692,
-21867,
-22731,
-23251,
-23444,
-23384,
-23173,
-22936,
-22804,
-22891,
-23306,
-24107,
-25327,
-26948,
-28896,
-31076,
-33325,
-35499,
-37410,
-38924,
-39911,
-40294,
-40057,
-39218,
-37864,
-36123,
-34142,
-32122,
-30229,
-28653,
-27520,
-26952,
-26972,
-27608,
-28769,
-30392,
-32321,
-34417,
-36518,
-38461,
-40116,
-41374,
-42182,
-42542,
-42522,
-42238,
-41846,
-41519,
-41397,
-41602,
-42174,
-43107,
-44331,
-45731,
-47163,
-48466,
-49474,
-50018,
-49954,
-49145,
-47511,
-45023,
-41739,
-37798,
-33432,
-28932,
-24617,
-20804,
-17737,
-15595,
-14423,
-14177,
-14700,
-15794,
-17201,
-18711,
-20102,
-21255,
-22075,
-22561,
-22728,
-22676,
-22475,
-22270,
-22158,
-22264,
-22684,
-23493,
-24730,
-26384,
-28399,
-30657,
-33021,
-35300,
-37328,
-38926,
-39970,
-40365,
-40082,
-39139,
-37634,
-35691,
-33513,
-31297,
-29270,
-27628,
-26523,
-26052,
-26244,
-27060,
-28427,
-30213,
-32287,
-34485,
-36652,
-38630,
-40279,
-41498,
-42229,
-42492,
-42368,
-42002,
-41571,
-41248,
-41183,
-41460,
-42113,
-43109,
-44379,
-45818,
-47303,
-48685,
-49795,
-50444,
-50448,
-49624,
-47889,
-45206,
-41691,
-37548,
-33069,
-28598,
-24465,
-20946,
-18235,
-16426,
-15508,
-15409,
-15974,
-17039,
-18388,
-19848,
-21226,
-22381,
-23225,
-23698,
-23843,
-23722,
-23461,
-23209,
-23107,
-23293,
-23850,
-24832,
-26236,
-28006,
-30072,
-32292,
-34550,
-36678,
-38536,
-39977,
-40882,
-41171,
-40805,
-39814,
-38282,
-36357,
-34232,
-32110,
-30214,
-28698,
-27715,
-27313,
-27515,
-28281,
-29525,
-31162,
-33055,
-35091,
-37121,
-39022,
-40651,
-41919,
-42747,
-43126,
-43115,
-42801,
-42361,
-41950,
-41736,
-41857,
-42367,
-43284,
-44535,
-45993,
-47507,
-48867,
-49894,
-50389,
-50189,
-49184,
-47299,
-44568,
-41072,
-37010,
-32632,
-28236,
-24145,
-20619,
-17887,
-16046,
-15125,
-15020,
-15591,
-16622,
-17907,
-19239,
-20458,
-21442,
-22132,
-22506,
-22600,
-22486,
-22255,
-22043,
-21949,
-22109,
-22590,
-23464,
-24732,
-26373,
-28306,
-30429,
-32598,
-34666,
-36474,
-37877,
-38770,
-39059,
-38730,
-37797,
-36340,
-34487,
-32392,
-30250,
-28250,
-26580,
-25393,
-24800,
-24853,
-25551,
-26821,
-28547,
-30582,
-32746,
-34875,
-36816,
-38440,
-39681,
-40494,
-40908,
-40984,
-40834,
-40594,
-40410,
-40423,
-40736,
-41412,
-42441,
-43766,
-45255,
-46755,
-48072,
-49027,
-49449,
-49205,
-48209,
-46420,
-43872,
-40641,
-36885,
-32809,
-28664,
-24731,
-21271,
-18527,
-16644,
-15694,
-15617,
-16283,
-17457,
-18901,
-20359,
-21633,
-22588,
-23168,
-23387,
-23322,
-23081,
-22778,
-22550,
-22485,
-22697,
-23235,
-24149,
-25454,
-27113,
-29081,
-31248,
-33486,
-35632,
-37533,
-39003,
-39937,
-40209,
-39815,
-38763,
-37169,
-35178,
-32993,
-30812,
-28860,
-27274,
-26222,
-25741,
-25887,
-26622,
-27897,
-29615,
-31650,
-33855,
-36065,
-38116,
-39853,
-41170,
-41995,
-42353,
-42298,
-41982,
-41544,
-41187,
-41034,
-41225,
-41791,
-42741,
-43995,
-45448,
-46933,
-48280,
-49299,
-49797,
-49620,
-48621,
-46738,
-43955,
-40369,
-36159,
-31590,
-26993,
-22705,
-19041,
-16249,
-14451,
-13661,
-13783,
-14599,
-15903,
-17401,
-18908,
-20219,
-21243,
-21927,
-22276,
-22357,
-22234,
-22033,
-21850,
-21817,
-22026,
-22572,
-23512,
-24855,
-26606,
-28659,
-30946,
-33291,
-35538,
-37521,
-39049,
-40013,
-40295,
-39882,
-38789,
-37137,
-35062,
-32799,
-30541,
-28546,
-26980,
-25997,
-25674,
-25999,
-26935,
-28357,
-30154,
-32165,
-34268,
-36318,
-38205,
-39812,
-41056,
-41863,
-42238,
-42203,
-41889,
-41438,
-41053,
-40909,
-41142,
-41824,
-42920,
-44343,
-45921,
-47455,
-48754,
-49613,
-49889,
-49445,
-48198,
-46114,
-43223,
-39627,
-35511,
-31128,
-26789,
-22811,
-19493,
-17042,
-15581,
-15093,
-15462,
-16472,
-17870,
-19388,
-20801,
-21939,
-22724,
-23142,
-23252,
-23162,
-22975,
-22842,
-22854,
-23122,
-23719,
-24695,
-26071,
-27846,
-29937,
-32256,
-34626,
-36857,
-38748,
-40101,
-40777,
-40702,
-39888,
-38429,
-36489,
-34290,
-32055,
-30038,
-28417,
-27354,
-26931,
-27163,
-28007,
-29377,
-31126,
-33126,
-35206,
-37227,
-39052,
-40573,
-41700,
-42414,
-42705,
-42667,
-42402,
-42088,
-41881,
-41947,
-42370,
-43201,
-44369,
-45786,
-47255,
-48607,
-49620,
-50124,
-49939,
-48961,
-47102,
-44382,
-40877,
-36784,
-32357,
-27939,
-23855,
-20429,
-17870,
-16299,
-15689,
-15924,
-16792,
-18060,
-19482,
-20860,
-22023,
-22888,
-23401,
-23591,
-23521,
-23305,
-23081,
-22998,
-23189,
-23756,
-24751,
-26175,
-27976,
-30057,
-32299,
-34549,
-36655,
-38448,
-39779,
-40522,
-40584,
-39965,
-38708,
-36961,
-34905,
-32775,
-30779,
-29121,
-27934,
-27300,
-27269,
-27818,
-28920,
-30498,
-32437,
-34600,
-36803,
-38861,
-40587,
-41854,
-42593,
-42824,
-42662,
-42251,
-41808,
-41499,
-41477,
-41836,
-42576,
-43688,
-45047,
-46546,
-47994,
-49214,
-49991,
-50132,
-49467,
-47880,
-45341,
-41925,
-37801,
-33257,
-28617,
-24254,
-20491,
-17594,
-15694,
-14834,
-14891,
-15694,
-16970,
-18469,
-19938,
-21191,
-22105,
-22638,
-22804,
-22699,
-22428,
-22144,
-22000,
-22117,
-22621,
-23554,
-24941,
-26736,
-28844,
-31146,
-33473,
-35670,
-37554,
-38985,
-39830,
-40012,
-39513,
-38369,
-36700,
-34672,
-32499,
-30400,
-28584,
-27225,
-26430,
-26260,
-26716,
-27748,
-29275,
-31178,
-33312,
-35521,
-37628,
-39471,
-40919,
-41879,
-42354,
-42385,
-42119,
-41712,
-41367,
-41239,
-41468,
-42100,
-43133,
-44474,
-45992,
-47490,
-48769,
-49604,
-49803,
-49200,
-47699,
-45270,
-41984,
-38004,
-33574,
-29013,
-24652,
-20814,
-17771,
-15684,
-14616,
-14501,
-15173,
-16406,
-17928,
-19505,
-20921,
-22042,
-22803,
-23196,
-23283,
-23154,
-22936,
-22761,
-22771,
-23082,
-23790,
-24942,
-26540,
-28510,
-30758,
-33106,
-35396,
-37428,
-39049,
-40112,
-40536,
-40279,
-39373,
-37901,
-36011,
-33891,
-31758,
-29840,
-28327,
-27375,
-27075,
-27442,
-28435,
-29956,
-31850,
-33974,
-36134,
-38179,
-39947,
-41338,
-42269,
-42746,
-42808,
-42565,
-42179,
-41808,
-41629,
-41772,
-42310,
-43254,
-44548,
-46046,
-47601,
-48968,
-49961,
-50344,
-49965,
-48697,
-46507,
-43452,
-39669,
-35395,
-30925,
-26574,
-22670,
-19459,
-17139,
-15774,
-15333,
-15690,
-16637,
-17939,
-19368,
-20699,
-21809,
-22585,
-23027,
-23161,
-23064,
-22851,
-22640,
-22560,
-22734,
-23248,
-24185,
-25542,
-27317,
-29403,
-31687,
-33997,
-36147,
-37944,
-39222,
-39838,
-39726,
-38876,
-37361,
-35350,
-33038,
-30707,
-28580,
-26914,
-25833,
-25446,
-25724,
-26619,
-28017,
-29788,
-31796,
-33905,
-35967,
-37842,
-39394,
-40493,
-41097,
-41194,
-40894,
-40370,
-39829,
-39514,
-39572,
-40118,
-41124,
-42508,
-44092,
-45692,
-47096,
-48121,
-48595,
-48378,
-47355,
-45472,
-42732,
-39233,
-35174,
-30817,
-26515,
-22575,
-19309,
-16892,
-15423,
-14862,
-15095,
-15931,
-17167,
-18595,
-20026,
-21324,
-22370,
-23114,
-23547,
-23697,
-23671,
-23576,
-23569,
-23786,
-24354,
-25333,
-26761,
-28578,
-30696,
-32973,
-35244,
-37329,
-39063,
-40301,
-40923,
-40890,
-40168,
-38845,
-37021,
-34887,
-32649,
-30543,
-28783,
-27554,
-26967,
-27068,
-27820,
-29131,
-30860,
-32844,
-34920,
-36934,
-38746,
-40256,
-41373,
-42066,
-42344,
-42275,
-41971,
-41611,
-41347,
-41362,
-41753,
-42563,
-43755,
-45213,
-46769,
-48222,
-49362,
-49988,
-49932,
-49054,
-47286,
-44614,
-41134,
-37018,
-32535,
-28002,
-23768,
-20128,
-17330,
-15483,
-14609,
-14605,
-15304,
-16490,
-17927,
-19409,
-20746,
-21809,
-22523,
-22857,
-22879,
-22667,
-22392,
-22194,
-22251,
-22666,
-23533,
-24849,
-26587,
-28647,
-30912,
-33228,
-35440,
-37377,
-38881,
-39803,
-40065,
-39593,
-38463,
-36749,
-34657,
-32405,
-30233,
-28371,
-26999,
-26230,
-26129,
-26669,
-27805,
-29414,
-31382,
-33543,
-35732,
-37800,
-39577,
-40973,
-41895,
-42360,
-42408,
-42179,
-41818,
-41517,
-41430,
-41689,
-42334,
-43372,
-44690,
-46165,
-47596,
-48788,
-49540,
-49673,
-49044,
-47570,
-45225,
-42066,
-38232,
-33942,
-29482,
-25174,
-21337,
-18243,
-16074,
-14905,
-14688,
-15262,
-16407,
-17851,
-19341,
-20681,
-21715,
-22396,
-22727,
-22773,
-22651,
-22469,
-22380,
-22481,
-22894,
-23675,
-24868,
-26461,
-28412,
-30617,
-32947,
-35230,
-37284,
-38926,
-40005,
-40405,
-40092,
-39091,
-37517,
-35535,
-33370,
-31241,
-29381,
-27952,
-27097,
-26863,
-27267,
-28243,
-29713,
-31540,
-33591,
-35709,
-37736,
-39532,
-40973,
-41981,
-42530,
-42653,
-42451,
-42078,
-41699,
-41514,
-41641,
-42191,
-43154,
-44473,
-45992,
-47532,
-48852,
-49760,
-50030,
-49538,
-48167,
-45913,
-42819,
-39042,
-34783,
-30344,
-26030,
-22160,
-19014,
-16761,
-15500,
-15167,
-15634,
-16676,
-18042,
-19502,
-20841,
-21944,
-22716,
-23164,
-23317,
-23246,
-23064,
-22880,
-22832,
-23039,
-23615,
-24619,
-26088,
-27963,
-30162,
-32509,
-34832,
-36918,
-38586,
-39687,
-40118,
-39861,
-38947,
-37483,
-35628,
-33567,
-31515,
-29665,
-28194,
-27238,
-26869,
-27129,
-27975,
-29347,
-31124,
-33163,
-35303,
-37374,
-39218,
-40714,
-41766,
-42365,
-42524,
-42365,
-42005,
-41629,
-41399,
-41448,
-41876,
-42695,
-43874,
-45289,
-46792,
-48170,
-49229,
-49749,
-49570,
-48554,
-46648,
-43860,
-40306,
-36167,
-31721,
-27281,
-23179,
-19725,
-17140,
-15556,
-14971,
-15265,
-16235,
-17611,
-19122,
-20539,
-21680,
-22466,
-22874,
-22956,
-22810,
-22552,
-22317,
-22227,
-22401,
-22922,
-23853,
-25207,
-26954,
-29013,
-31259,
-33533,
-35653,
-37449,
-38751,
-39453,
-39474,
-38827,
-37562,
-35815,
-33757,
-31597,
-29556,
-27829,
-26584,
-25932,
-25927,
-26564,
-27785,
-29486,
-31529,
-33748,
-35971,
-38015,
-39737,
-41010,
-41789,
-42089,
-41986,
-41647,
-41229,
-40940,
-40926,
-41301,
-42095,
-43273,
-44727,
-46291,
-47774,
-48947,
-49611,
-49569,
-48684,
-46878,
-44154,
-40620,
-36456,
-31950,
-27408,
-23187,
-19573,
-16822,
-15047,
-14276,
-14403,
-15245,
-16551,
-18071,
-19564,
-20848,
-21808,
-22404,
-22644,
-22623,
-22426,
-22207,
-22085,
-22204,
-22657,
-23527,
-24836,
-26563,
-28630,
-30922,
-33267,
-35512,
-37454,
-38949,
-39855,
-40096,
-39643,
-38540,
-36893,
-34880,
-32710,
-30628,
-28841,
-27555,
-26870,
-26858,
-27493,
-28699,
-30372,
-32369,
-34534,
-36721,
-38762,
-40509,
-41854,
-42704,
-43066,
-43004,
-42655,
-42228,
-41915,
-41917,
-42338,
-43222,
-44500,
-46036,
-47630,
-49063,
-50106,
-50561,
-50246,
-49063,
-46939,
-43923,
-40140,
-35813,
-31265,
-26844,
-22913,
-19782,
-17631,
-16541,
-16430,
-17099,
-18317,
-19757,
-21214,
-22438,
-23352,
-23876,
-24066,
-23979,
-23743,
-23490,
-23367,
-23512,
-24029,
-24998,
-26431,
-28278,
-30449,
-32757,
-35048,
-37081,
-38709,
-39750,
-40135,
-39809,
-38824,
-37276,
-35330,
-33192,
-31089,
-29249,
-27874,
-27101,
-27008,
-27599,
-28779,
-30458,
-32420,
-34537,
-36586,
-38452,
-39978,
-41122,
-41815,
-42121,
-42081,
-41844,
-41547,
-41364,
-41425,
-41852,
-42665,
-43842,
-45270,
-46759,
-48095,
-49012,
-49276,
-48687,
-47124,
-44563,
-41106,
-36952,
-32401,
-27801,
-23500,
-19809,
-16958,
-15060,
-14134,
-14083,
-14739,
-15878,
-17262,
-18646,
-19850,
-20718,
-21204,
-21328,
-21185,
-20944,
-20779,
-20871,
-21358,
-22311,
-23753,
-25619,
-27829,
-30235,
-32704,
-35044,
-37102,
-38681,
-39644,
-39877,
-39352,
-38129,
-36359,
-34275,
-32129,
-30199,
-28678,
-27733,
-27412,
-27730,
-28621,
-30012,
-31787,
-33822,
-35971,
-38072,
-39961,
-41483,
-42537,
-43074,
-43151,
-42879,
-42447,
-42053,
-41890,
-42094,
-42719,
-43763,
-45105,
-46612,
-48069,
-49267,
-49991,
-50037,
-49258,
-47547,
-44895,
-41387,
-37205,
-32636,
-28023,
-23740,
-20122,
-17430,
-15800,
-15221,
-15567,
-16588,
-17992,
-19500,
-20841,
-21879,
-22518,
-22786,
-22762,
-22565,
-22341,
-22229,
-22351,
-22811,
-23674,
-24972,
-26701,
-28774,
-31105,
-33492,
-35767,
-37704,
-39116,
-39863,
-39857,
-39123,
-37729,
-35860,
-33709,
-31519,
-29525,
-27921,
-26871,
-26470,
-26746,
-27684,
-29180,
-31119,
-33306,
-35570,
-37698,
-39536,
-40946,
-41869,
-42307,
-42341,
-42104,
-41758,
-41497,
-41460,
-41779,
-42502,
-43605,
-45018,
-46568,
-48071,
-49278,
-49962,
-49889,
-48899,
-46896,
-43890,
-40025,
-35523,
-30742,
-26042,
-21821,
-18393,
-15982,
-14663,
-14385,
-14957,
-16123,
-17587,
-19074,
-20368,
-21337,
-21926,
-22169,
-22138,
-21965,
-21775,
-21728,
-21941,
-22540,
-23585,
-25109,
-27057,
-29340,
-31782,
-34202,
-36380,
-38129,
-39295,
-39779,
-39552,
-38649,
-37172,
-35274,
-33154,
-31032,
-29129,
-27642,
-26729,
-26468,
-26896,
-27944,
-29523,
-31467,
-33624,
-35790,
-37819,
-39541,
-40847,
-41682,
-42033,
-41987,
-41664,
-41266,
-40978,
-40994,
-41423,
-42307,
-43595,
-45143,
-46763,
-48209,
-49248,
-49670,
-49280,
-47995,
-45744,
-42605,
-38723,
-34341,
-29791,
-25423,
-21593,
-18583,
-16576,
-15603,
-15596,
-16334,
-17576,
-19026,
-20439,
-21627,
-22480,
-22965,
-23130,
-23051,
-22861,
-22694,
-22679,
-22945,
-23576,
-24634,
-26128,
-28011,
-30194,
-32522,
-34830,
-36897,
-38556,
-39622,
-39999,
-39646,
-38596,
-36980,
-34970,
-32796,
-30698,
-28905,
-27615,
-26950,
-26996,
-27721,
-29069,
-30892,
-33012,
-35245,
-37371,
-39250,
-40729,
-41758,
-42328,
-42494,
-42374,
-42106,
-41856,
-41768,
-41972,
-42530,
-43479,
-44748,
-46231,
-47743,
-49059,
-49928,
-50123,
-49438,
-47769,
-45117,
-41573,
-37384,
-32835,
-28298,
-24115,
-20599,
-17961,
-16314,
-15643,
-15844,
-16717,
-18028,
-19518,
-20963,
-22165,
-23020,
-23473,
-23558,
-23386,
-23083,
-22837,
-22801,
-23110,
-23864,
-25080,
-26750,
-28783,
-31061,
-33419,
-35681,
-37646,
-39145,
-40023,
-40179,
-39607,
-38351,
-36564,
-34446,
-32235,
-30180,
-28491,
-27336,
-26813,
-26958,
-27741,
-29092,
-30879,
-32961,
-35154,
-37271,
-39144,
-40623,
-41629,
-42141,
-42232,
-42024,
-41697,
-41441,
-41410,
-41730,
-42445,
-43532,
-44899,
-46403,
-47842,
-49023,
-49706,
-49706,
-48841,
-47025,
-44245,
-40596,
-36298,
-31643,
-27015,
-22770,
-19270,
-16723,
-15258,
-14828,
-15269,
-16342,
-17744,
-19215,
-20522,
-21535,
-22193,
-22513,
-22575,
-22477,
-22355,
-22323,
-22511,
-23019,
-23926,
-25275,
-27050,
-29179,
-31532,
-33917,
-36137,
-37961,
-39235,
-39808,
-39659,
-38794,
-37336,
-35436,
-33304,
-31164,
-29232,
-27708,
-26744,
-26436,
-26820,
-27860,
-29454,
-31461,
-33684,
-35943,
-38028,
-39809,
-41156,
-42042,
-42470,
-42535,
-42355,
-42104,
-41935,
-42008,
-42416,
-43220,
-44370,
-45784,
-47279,
-48645,
-49647,
-50046,
-49648,
-48338,
-46056,
-42900,
-39007,
-34666,
-30167,
-25874,
-22088,
-19068,
-16980,
-15863,
-15663,
-16219,
-17313,
-18695,
-20135,
-21428,
-22444,
-23125,
-23463,
-23549,
-23463,
-23373,
-23394,
-23681,
-24323,
-25395,
-26902,
-28803,
-30993,
-33323,
-35616,
-37670,
-39312,
-40384,
-40785,
-40496,
-39518,
-37997,
-36045,
-33916,
-31805,
-29953,
-28559,
-27747,
-27617,
-28148,
-29290,
-30919,
-32881,
-35003,
-37119,
-39052,
-40681,
-41880,
-42618,
-42885,
-42777,
-42422,
-42019,
-41760,
-41821,
-42312,
-43255,
-44577,
-46135,
-47699,
-49054,
-49944,
-50178,
-49579,
-48066,
-45603,
-42278,
-38255,
-33794,
-29246,
-24952,
-21271,
-18441,
-16612,
-15790,
-15846,
-16588,
-17743,
-19080,
-20365,
-21459,
-22250,
-22715,
-22867,
-22781,
-22558,
-22347,
-22290,
-22530,
-23174,
-24270,
-25809,
-27712,
-29863,
-32090,
-34232,
-36104,
-37547,
-38428,
-38639,
-38156,
-36990,
-35271,
-33173,
-30939,
-28837,
-27100,
-25922,
-25415,
-25599,
-26434,
-27807,
-29585,
-31604,
-33700,
-35715,
-37492,
-38915,
-39891,
-40412,
-40506,
-40312,
-39972,
-39699,
-39657,
-39991,
-40762,
-41965,
-43498,
-45210,
-46882,
-48271,
-49137,
-49248,
-48442,
-46624,
-43815,
-40143,
-35850,
-31266,
-26751,
-22678,
-19346,
-16965,
-15624,
-15278,
-15783,
-16914,
-18402,
-19990,
-21446,
-22608,
-23394,
-23787,
-23846,
-23690,
-23441,
-23269,
-23293,
-23637,
-24371,
-25535,
-27108,
-29043,
-31215,
-33484,
-35658,
-37532,
-38926,
-39674,
-39691,
-38978,
-37600,
-35743,
-33593,
-31416,
-29421,
-27816,
-26749,
-26297,
-26515,
-27367,
-28798,
-30692,
-32881,
-35190,
-37390,
-39298,
-40751,
-41662,
-42043,
-41982,
-41642,
-41239,
-40950,
-40961,
-41353,
-42161,
-43334,
-44763,
-46290,
-47727,
-48861,
-49469,
-49351,
-48347,
-46362,
-43418,
-39630,
-35247,
-30592,
-26037,
-21947,
-18625,
-16268,
-14952,
-14621,
-15111,
-16194,
-17591,
-19061,
-20367,
-21385,
-22026,
-22311,
-22310,
-22140,
-21950,
-21880,
-22066,
-22607,
-23565,
-24967,
-26775,
-28922,
-31268,
-33654,
-35853,
-37687,
-38933,
-39476,
-39260,
-38290,
-36729,
-34730,
-32559,
-30440,
-28611,
-27243,
-26464,
-26337,
-26861,
-27992,
-29630,
-31630,
-33828,
-36031,
-38055,
-39740,
-40977,
-41713,
-41991,
-41897,
-41604,
-41280,
-41117,
-41263,
-41791,
-42747,
-44031,
-45546,
-47080,
-48421,
-49340,
-49610,
-49072,
-47599,
-45179,
-41874,
-37862,
-33408,
-28836,
-24511,
-20767,
-17877,
-16006,
-15187,
-15318,
-16190,
-17527,
-19020,
-20420,
-21519,
-22225,
-22544,
-22551,
-22396,
-22243,
-22257,
-22579,
-23301,
-24468,
-26069,
-28046,
-30279,
-32628,
-34889,
-36898,
-38440,
-39389,
-39630,
-39146,
-37994,
-36300,
-34269,
-32118,
-30110,
-28456,
-27347,
-26909,
-27177,
-28148,
-29703,
-31704,
-33943,
-36206,
-38296,
-40024,
-41306,
-42068,
-42390,
-42341,
-42111,
-41868,
-41788,
-42019,
-42637,
-43654,
-44998,
-46531,
-48032,
-49271,
-49976,
-49916,
-48925,
-46897,
-43892,
-40032,
-35609,
-30960,
-26468,
-22520,
-19402,
-17313,
-16301,
-16275,
-17032,
-18294,
-19763,
-21164,
-22310,
-23076,
-23470,
-23531,
-23405,
-23209,
-23115,
-23242,
-23705,
-24593,
-25926,
-27714,
-29864,
-32247,
-34672,
-36884,
-38673,
-39820,
-40197,
-39794,
-38650,
-36953,
-34912,
-32772,
-30782,
-29143,
-28021,
-27523,
-27690,
-28515,
-29916,
-31762,
-33879,
-36056,
-38089,
-39810,
-41083,
-41882,
-42227,
-42220,
-42026,
-41799,
-41726,
-41925,
-42496,
-43437,
-44710,
-46173,
-47651,
-48916,
-49725,
-49854,
-49131,
-47446,
-44813,
-41313,
-37188,
-32698,
-28229,
-24111,
-20687,
-18179,
-16721,
-16269,
-16701,
-17737,
-19106,
-20496,
-21683,
-22520,
-22969,
-23079,
-22962,
-22770,
-22639,
-22714,
-23082,
-23825,
-24977,
-26542,
-28479,
-30690,
-33029,
-35295,
-37274,
-38746,
-39543,
-39575,
-38831,
-37412,
-35500,
-33309,
-31129,
-29177,
-27684,
-26802,
-26612,
-27139,
-28326,
-30056,
-32173,
-34467,
-36741,
-38779,
-40427,
-41571,
-42178,
-42309,
-42071,
-41671,
-41297,
-41167,
-41428,
-42158,
-43345,
-44875,
-46558,
-48141,
-49347,
-49907,
-49594,
-48262,
-45857,
-42453,
-38243,
-33523,
-28685,
-24130,
-20247,
-17332,
-15539,
-14882,
-15216,
-16277,
-17761,
-19335,
-20749,
-21820,
-22469,
-22724,
-22654,
-22421,
-22157,
-22042,
-22207,
-22780,
-23831,
-25388,
-27399,
-29756,
-32274,
-34739,
-36897,
-38548,
-39494,
-39671,
-39048,
-37737,
-35887,
-33731,
-31516,
-29496,
-27891,
-26880,
-26556,
-26964,
-28044,
-29688,
-31734,
-33976,
-36225,
-38281,
-40001,
-41283,
-42091,
-42455,
-42467,
-42266,
-42027,
-41918,
-42104,
-42671,
-43653,
-44992,
-46533,
-48071,
-49335,
-50057,
-50003,
-48989,
-46958,
-43938,
-40103,
-35715,
-31122,
-26696,
-22796,
-19710,
-17614,
-16560,
-16461,
-17124,
-18288,
-19673,
-21019,
-22143,
-22926,
-23357,
-23470,
-23379,
-23204,
-23095,
-23178,
-23583,
-24386,
-25651,
-27360,
-29453,
-31790,
-34187,
-36418,
-38256,
-39500,
-40020,
-39754,
-38760,
-37152,
-35142,
-32963,
-30868,
-29091,
-27817,
-27178,
-27229,
-27962,
-29282,
-31074,
-33130,
-35283,
-37312,
-39067,
-40414,
-41301,
-41727,
-41783,
-41581,
-41314,
-41135,
-41214,
-41657,
-42501,
-43722,
-45194,
-46738,
-48117,
-49062,
-49334,
-48703,
-47060,
-44373,
-40757,
-36442,
-31769,
-27115,
-22888,
-19405,
-16895,
-15452,
-15003,
-15402,
-16378,
-17676,
-19022,
-20222,
-21132,
-21700,
-21938,
-21911,
-21752,
-21586,
-21591,
-21884,
-22596,
-23768,
-25410,
-27439,
-29734,
-32102,
-34347,
-36243,
-37605,
-38290,
-38211,
-37390,
-35908,
-33955,
-31771,
-29616,
-27766,
-26413,
-25714,
-25712,
-26384,
-27647,
-29369,
-31403,
-33586,
-35756,
-37744,
-39416,
-40638,
-41376,
-41629,
-41528,
-41245,
-41023,
-41078,
-41575,
-42586,
-44035,
-45779,
-47557,
-49102,
-50153,
-50489,
-49974,
-48530,
-46172,
-42981,
-39112,
-34808,
-30344,
-26075,
-22303,
-19340,
-17348,
-16405,
-16425,
-17199,
-18459,
-19881,
-21207,
-22236,
-22878,
-23144,
-23113,
-22937,
-22752,
-22725,
-22957,
-23552,
-24557,
-25992,
-27820,
-29977,
-32314,
-34674,
-36819,
-38542,
-39638,
-39969,
-39496,
-38266,
-36435,
-34235,
-31930,
-29797,
-28074,
-26939,
-26502,
-26788,
-27769,
-29324,
-31318,
-33543,
-35810,
-37903,
-39664,
-40957,
-41740,
-42042,
-41957,
-41660,
-41330,
-41171,
-41334,
-41928,
-42965,
-44387,
-46038,
-47693,
-49090,
-49935,
-49976,
-49024,
-46986,
-43907,
-39955,
-35415,
-30655,
-26077,
-22036,
-18840,
-16646,
-15510,
-15338,
-15950,
-17089,
-18486,
-19886,
-21088,
-21963,
-22463,
-22619,
-22511,
-22291,
-22108,
-22139,
-22523,
-23377,
-24746,
-26622,
-28903,
-31433,
-33994,
-36332,
-38220,
-39447,
-39908,
-39559,
-38481,
-36816,
-34779,
-32615,
-30544,
-28793,
-27510,
-26822,
-26777,
-27403,
-28626,
-30377,
-32476,
-34748,
-36969,
-38930,
-40472,
-41486,
-41985,
-42034,
-41821,
-41524,
-41368,
-41503,
-42033,
-42968,
-44241,
-45709,
-47195,
-48471,
-49324,
-49534,
-48931,
-47391,
-44893,
-41490,
-37386,
-32850,
-28259,
-23991,
-20404,
-17758,
-16185,
-15668,
-16048,
-17080,
-18448,
-19886,
-21136,
-22075,
-22631,
-22850,
-22818,
-22667,
-22545,
-22583,
-22912,
-23620,
-24768,
-26373,
-28387,
-30719,
-33189,
-35607,
-37715,
-39307,
-40186,
-40255,
-39506,
-38035,
-36033,
-33748,
-31460,
-29433,
-27895,
-27005,
-26843,
-27410,
-28632,
-30373,
-32459,
-34677,
-36834,
-38733,
-40250,
-41293,
-41857,
-42004,
-41838,
-41536,
-41255,
-41183,
-41442,
-42120,
-43219,
-44656,
-46281,
-47834,
-49068,
-49668,
-49412,
-48131,
-45777,
-42455,
-38363,
-33835,
-29239,
-24955,
-21320,
-18574,
-16841,
-16126,
-16299,
-17166,
-18434,
-19855,
-21158,
-22172,
-22811,
-23058,
-23006,
-22791,
-22564,
-22502,
-22726,
-23336,
-24385,
-25867,
-27746,
-29921,
-32262,
-34580,
-36674,
-38336,
-39378,
-39699,
-39240,
-38090,
-36379,
-34335,
-32193,
-30208,
-28573,
-27465,
-26971,
-27144,
-27961,
-29365,
-31221,
-33378,
-35624,
-37748,
-39563,
-40913,
-41738,
-42058,
-41970,
-41664,
-41322,
-41162,
-41322,
-41902,
-42898,
-44246,
-45796,
-47347,
-48660,
-49490,
-49590,
-48794,
-46968,
-44139,
-40403,
-36025,
-31323,
-26706,
-22554,
-19201,
-16866,
-15625,
-15410,
-16027,
-17206,
-18636,
-20053,
-21220,
-22041,
-22455,
-22537,
-22385,
-22145,
-21980,
-22023,
-22406,
-23198,
-24464,
-26163,
-28272,
-30625,
-33094,
-35428,
-37419,
-38842,
-39524,
-39391,
-38434,
-36788,
-34641,
-32277,
-29981,
-28029,
-26645,
-25971,
-26063,
-26890,
-28358,
-30286,
-32508,
-34782,
-36935,
-38767,
-40171,
-41071,
-41489,
-41515,
-41284,
-41004,
-40841,
-40981,
-41512,
-42481,
-43821,
-45412,
-47043,
-48476,
-49452,
-49713,
-49073,
-47397,
-44690,
-41039,
-36704,
-31984,
-27295,
-23001,
-19464,
-16891,
-15412,
-14966,
-15407,
-16486,
-17904,
-19389,
-20695,
-21664,
-22222,
-22393,
-22257,
-21988,
-21738,
-21704,
-22017,
-22781,
-24030,
-25748,
-27836,
-30190,
-32616,
-34960,
-36998,
-38574,
-39512,
-39732,
-39194,
-37961,
-36182,
-34061,
-31875,
-29857,
-28254,
-27200,
-26793,
-27008,
-27802,
-29051,
-30655,
-32469,
-34392,
-36292,
-38069,
-39612,
-40828,
-41665,
-42086,
-42150,
-41923,
-41568,
-41225,
-41073,
-41224,
-41772,
-42712,
-43993,
-45484,
-47011,
-48374,
-49366,
-49800,
-49519,
-48446,
-46535,
-43855,
-40511,
-36691,
-32623,
-28570,
-24780,
-21501,
-18909,
-17130,
-16201,
-16078,
-16638,
-17711,
-19073,
-20520,
-21850,
-22916,
-23644,
-23994,
-24044,
-23846,
-23573,
-23321,
-23253,
-23456,
-24012,
-24951,
-26267,
-27904,
-29794,
-31806,
-33839,
-35730,
-37364,
-38603,
-39354,
-39551,
-39178,
-38253,
-36873,
-35142,
-33234,
-31320,
-29564,
-28146,
-27163,
-26725,
-26844,
-27525,
-28695,
-30278,
-32127,
-34127,
-36092,
-37906,
-39418,
-40550,
-41249,
-41524,
-41447,
-41117,
-40696,
-40324,
-40158,
-40305,
-40826,
-41720,
-42930,
-44335,
-45778,
-47077,
-48029,
-48468,
-48222,
-47194,
-45329,
-42642,
-39239,
-35276,
-31008,
-26698,
-22662,
-19160,
-16430,
-14584,
-13682,
-13622,
-14277,
-15412,
-16810,
-18259,
-19578,
-20677,
-21477,
-21999,
-22266,
-22346,
-22333,
-22306,
-22396,
-22676,
-23268,
-24201,
-25529,
-27206,
-29177,
-31324,
-33516,
-35605,
-37446,
-38905,
-39867,
-40263,
-40036,
-39216,
-37859,
-36102,
-34130,
-32141,
-30363,
-28954,
-28053,
-27712,
-27923,
-28644,
-29787,
-31260,
-32965,
-34799,
-36641,
-38386,
-39891,
-41069,
-41837,
-42191,
-42181,
-41918,
-41553,
-41245,
-41133,
-41322,
-41847,
-42715,
-43859,
-45196,
-46580,
-47861,
-48841,
-49326,
-49133,
-48113,
-46199,
-43416,
-39886,
-35823,
-31517,
-27257,
-23354,
-20039,
-17495,
-15818,
-15015,
-15023,
-15701,
-16868,
-18297,
-19776,
-21105,
-22143,
-22815,
-23125,
-23132,
-22953,
-22708,
-22532,
-22530,
-22781,
-23354,
-24269,
-25556,
-27186,
-29114,
-31251,
-33454,
-35575,
-37413,
-38817,
-39646,
-39817,
-39332,
-38222,
-36619,
-34663,
-32553,
-30468,
-28612,
-27134,
-26182,
-25816,
-26083,
-26930,
-28294,
-30048,
-32046,
-34141,
-36179,
-38028,
-39569,
-40736,
-41469,
-41801,
-41769,
-41498,
-41124,
-40812,
-40716,
-40945,
-41560,
-42556,
-43840,
-45305,
-46747,
-48004,
-48861,
-49159,
-48747,
-47538,
-45486,
-42645,
-39115,
-35103,
-30850,
-26654,
-22784,
-19511,
-16994,
-15351,
-14576,
-14593,
-15266,
-16395,
-17789,
-19234,
-20566,
-21637,
-22377,
-22749,
-22802,
-22618,
-22325,
-22075,
-22005,
-22245,
-22867,
-23915,
-25377,
-27186,
-29275,
-31496,
-33732,
-35817,
-37598,
-38934,
-39703,
-39834,
-39311,
-38190,
-36572,
-34641,
-32570,
-30585,
-28851,
-27534,
-26723,
-26484,
-26817,
-27686,
-29027,
-30729,
-32675,
-34722,
-36713,
-38517,
-39996,
-41086,
-41730,
-41967,
-41874,
-41565,
-41207,
-40945,
-40914,
-41228,
-41903,
-42940,
-44248,
-45697,
-47122,
-48339,
-49158,
-49416,
-48991,
-47784,
-45789,
-43040,
-39643,
-35791,
-31696,
-27640,
-23888,
-20699,
-18258,
-16687,
-15988,
-16085,
-16807,
-17949,
-19272,
-20581,
-21707,
-22561,
-23105,
-23362,
-23394,
-23289,
-23147,
-23073,
-23169,
-23516,
-24192,
-25218,
-26607,
-28306,
-30248,
-32301,
-34356,
-36244,
-37858,
-39057,
-39764,
-39903,
-39467,
-38465,
-36995,
-35162,
-33162,
-31167,
-29395,
-28009,
-27142,
-26867,
-27192,
-28065,
-29408,
-31098,
-33012,
-35016,
-36975,
-38763,
-40263,
-41386,
-42085,
-42360,
-42276,
-41957,
-41545,
-41231,
-41143,
-41401,
-42034,
-43032,
-44294,
-45702,
-47091,
-48286,
-49129,
-49448,
-49122,
-48037,
-46155,
-43492,
-40136,
-36272,
-32134,
-28014,
-24200,
-20961,
-18479,
-16871,
-16127,
-16168,
-16835,
-17926,
-19232,
-20562,
-21754,
-22700,
-23347,
-23685,
-23766,
-23664,
-23483,
-23349,
-23360,
-23630,
-24212,
-25162,
-26474,
-28119,
-30031,
-32108,
-34218,
-36218,
-37945,
-39241,
-39995,
-40095,
-39550,
-38377,
-36707,
-34704,
-32562,
-30509,
-28724,
-27380,
-26575,
-26376,
-26770,
-27730,
-29151,
-30938,
-32943,
-35013,
-37008,
-38771,
-40191,
-41202,
-41753,
-41908,
-41728,
-41364,
-40959,
-40679,
-40648,
-40972,
-41675,
-42750,
-44101,
-45621,
-47123,
-48444,
-49378,
-49748,
-49398,
-48226,
-46177,
-43294,
-39685,
-35554,
-31172,
-26838,
-22878,
-19554,
-17089,
-15566,
-14993,
-15253,
-16145,
-17453,
-18908,
-20322,
-21510,
-22401,
-22939,
-23173,
-23154,
-22981,
-22773,
-22630,
-22684,
-23016,
-23720,
-24816,
-26322,
-28166,
-30262,
-32482,
-34654,
-36643,
-38280,
-39447,
-40066,
-40067,
-39485,
-38342,
-36768,
-34899,
-32919,
-31017,
-29377,
-28144,
-27424,
-27272,
-27667,
-28589,
-29929,
-31613,
-33505,
-35492,
-37438,
-39216,
-40705,
-41822,
-42507,
-42781,
-42699,
-42392,
-42004,
-41706,
-41647,
-41917,
-42586,
-43606,
-44919,
-46380,
-47819,
-49051,
-49879,
-50133,
-49669,
-48405,
-46317,
-43457,
-39959,
-36012,
-31875,
-27814,
-24115,
-21000,
-18662,
-17177,
-16557,
-16701,
-17454,
-18602,
-19927,
-21234,
-22356,
-23213,
-23749,
-23997,
-24007,
-23867,
-23678,
-23545,
-23575,
-23862,
-24491,
-25504,
-26911,
-28669,
-30680,
-32813,
-34908,
-36794,
-38336,
-39406,
-39938,
-39889,
-39273,
-38139,
-36578,
-34711,
-32718,
-30757,
-29045,
-27720,
-26928,
-26721,
-27106,
-28027,
-29393,
-31078,
-32969,
-34923,
-36829,
-38560,
-40000,
-41067,
-41692,
-41897,
-41729,
-41331,
-40867,
-40509,
-40418,
-40678,
-41314,
-42291,
-43501,
-44822,
-46102,
-47191,
-47928,
-48172,
-47752,
-46569,
-44529,
-41655,
-38037,
-33882,
-29470,
-25129,
-21175,
-17891,
-15447,
-13934,
-13331,
-13519,
-14343,
-15585,
-17041,
-18500,
-19808,
-20830,
-21523,
-21883,
-21973,
-21910,
-21809,
-21813,
-22020,
-22512,
-23321,
-24467,
-25915,
-27641,
-29580,
-31644,
-33745,
-35724,
-37465,
-38792,
-39605,
-39808,
-39386,
-38388,
-36906,
-35115,
-33179,
-31309,
-29677,
-28436,
-27706,
-27540,
-27957,
-28907,
-30300,
-32013,
-33900,
-35810,
-37606,
-39163,
-40410,
-41274,
-41774,
-41914,
-41786,
-41489,
-41155,
-40928,
-40930,
-41252,
-41946,
-42978,
-44284,
-45721,
-47130,
-48314,
-49098,
-49287,
-48758,
-47395,
-45177,
-42141,
-38434,
-34260,
-29925,
-25727,
-21994,
-18957,
-16791,
-15528,
-15131,
-15439,
-16291,
-17462,
-18779,
-20077,
-21227,
-22139,
-22758,
-23061,
-23080,
-22884,
-22587,
-22336,
-22283,
-22555,
-23238,
-24361,
-25894,
-27754,
-29850,
-32030,
-34193,
-36179,
-37868,
-39120,
-39818,
-39878,
-39267,
-38033,
-36288,
-34229,
-32068,
-30052,
-28368,
-27176,
-26561,
-26539,
-27100,
-28164,
-29652,
-31444,
-33414,
-35413,
-37297,
-38931,
-40205,
-41066,
-41510,
-41590,
-41411,
-41102,
-40808,
-40661,
-40769,
-41198,
-41978,
-43075,
-44422,
-45878,
-47287,
-48451,
-49167,
-49262,
-48587,
-47071,
-44716,
-41596,
-37878,
-33775,
-29554,
-25484,
-21826,
-18787,
-16517,
-15076,
-14455,
-14568,
-15267,
-16394,
-17745,
-19162,
-20483,
-21594,
-22423,
-22936,
-23154,
-23124,
-22947,
-22717,
-22576,
-22628,
-22983,
-23716,
-24867,
-26426,
-28350,
-30518,
-32812,
-35041,
-37051,
-38676,
-39799,
-40354,
-40327,
-39746,
-38690,
-37239,
-35517,
-33626,
-31718,
-29924,
-28402,
-27296,
-26713,
-26724,
-27329,
-28464,
-30025,
-31865,
-33845,
-35824,
-37687,
-39340,
-40687,
-41681,
-42272,
-42469,
-42336,
-41980,
-41571,
-41275,
-41248,
-41581,
-42298,
-43341,
-44604,
-45960,
-47265,
-48412,
-49274,
-49751,
-49720,
-49062,
-47669,
-45493,
-42555,
-38977,
-34983,
-30837,
-26853,
-23289,
-20356,
-18177,
-16791,
-16175,
-16250,
-16896,
-17972,
-19305,
-20711,
-22027,
-23088,
-23830,
-24204,
-24289,
-24156,
-23956,
-23786,
-23762,
-23939,
-24369,
-25086,
-26118,
-27488,
-29192,
-31182,
-33345,
-35537,
-37551,
-39216,
-40364,
-40924,
-40862,
-40240,
-39129,
-37645,
-35909,
-34029,
-32168,
-30438,
-29026,
-28044,
-27618,
-27773,
-28500,
-29704,
-31269,
-33049,
-34921,
-36772,
-38502,
-40044,
-41297,
-42206,
-42722,
-42837,
-42627,
-42205,
-41740,
-41403,
-41338,
-41620,
-42266,
-43223,
-44406,
-45706,
-47017,
-48208,
-49152,
-49679,
-49625,
-48815,
-47159,
-44620,
-41312,
-37433,
-33270,
-29132,
-25296,
-21989,
-19331,
-17411,
-16215,
-15743,
-15912,
-16659,
-17817,
-19243,
-20703,
-22018,
-23032,
-23660,
-23926,
-23907,
-23726,
-23518,
-23365,
-23346,
-23487,
-23831,
-24428,
-25342,
-26634,
-28321,
-30353,
-32602,
-34866,
-36933,
-38584,
-39691,
-40171,
-40041,
-39351,
-38180,
-36620,
-34777,
-32755,
-30736,
-28869,
-27378,
-26404,
-26064,
-26364,
-27249,
-28573,
-30211,
-32004,
-33867,
-35721,
-37501,
-39140,
-40531,
-41581,
-42199,
-42380,
-42174,
-41741,
-41275,
-40976,
-41002,
-41427,
-42229,
-43341,
-44623,
-45972,
-47253,
-48364,
-49184,
-49570,
-49385,
-48474,
-46764,
-44226,
-40963,
-37151,
-33038,
-28909,
-25008,
-21576,
-18752,
-16665,
-15352,
-14832,
-15041,
-15868,
-17129,
-18603,
-20061,
-21300,
-22201,
-22723,
-22918,
-22892,
-22771,
-22658,
-22634,
-22743,
-23027,
-23532,
-24327,
-25467,
-27003,
-28911,
-31100,
-33417,
-35648,
-37607,
-39127,
-40108,
-40532,
-40389,
-39754,
-38648,
-37160,
-35366,
-33396,
-31431,
-29666,
-28307,
-27516,
-27361,
-27842,
-28857,
-30261,
-31927,
-33702,
-35527,
-37315,
-39004,
-40521,
-41747,
-42604,
-43011,
-42994,
-42628,
-42090,
-41568,
-41250,
-41272,
-41675,
-42449,
-43507,
-44756,
-46086,
-47403,
-48579,
-49494,
-49971,
-49838,
-48938,
-47160,
-44513,
-41099,
-37130,
-32898,
-28700,
-24840,
-21534,
-18958,
-17179,
-16230,
-16044,
-16530,
-17517,
-18825,
-20228,
-21552,
-22616,
-23364,
-23755,
-23860,
-23750,
-23541,
-23314,
-23153,
-23121,
-23276,
-23694,
-24444,
-25569,
-27105,
-28985,
-31124,
-33349,
-35472,
-37313,
-38720,
-39584,
-39870,
-39568,
-38719,
-37400,
-35696,
-33760,
-31732,
-29820,
-28178,
-26974,
-26304,
-26192,
-26627,
-27521,
-28789,
-30323,
-32045,
-33847,
-35666,
-37372,
-38881,
-40072,
-40883,
-41285,
-41322,
-41099,
-40754,
-40449,
-40311,
-40436,
-40858,
-41582,
-42555,
-43713,
-44967,
-46198,
-47269,
-48025,
-48274,
-47887,
-46713,
-44733,
-41954,
-38523,
-34626,
-30524,
-26484,
-22770,
-19597,
-17131,
-15459,
-14596,
-14488,
-15017,
-16028,
-17335,
-18760,
-20143,
-21338,
-22284,
-22915,
-23263,
-23362,
-23307,
-23197,
-23153,
-23287,
-23679,
-24414,
-25485,
-26921,
-28641,
-30610,
-32718,
-34865,
-36938,
-38776,
-40273,
-41257,
-41667,
-41415,
-40536,
-39084,
-37215,
-35092,
-32917,
-30887,
-29161,
-27884,
-27148,
-27002,
-27447,
-28444,
-29893,
-31675,
-33636,
-35620,
-37493,
-39131,
-40468,
-41449,
-42064,
-42326,
-42283,
-42002,
-41608,
-41227,
-41012,
-41091,
-41539,
-42371,
-43531,
-44879,
-46284,
-47554,
-48575,
-49208,
-49374,
-48975,
-47935,
-46170,
-43645,
-40383,
-36503,
-32230,
-27872,
-23772,
-20252,
-17558,
-15797,
-14985,
-14985,
-15628,
-16704,
-18000,
-19356,
-20626,
-21704,
-22523,
-23047,
-23266,
-23250,
-23057,
-22821,
-22655,
-22670,
-22952,
-23560,
-24498,
-25788,
-27379,
-29247,
-31297,
-33436,
-35507,
-37352,
-38802,
-39707,
-39996,
-39631,
-38672,
-37234,
-35441,
-33487,
-31505,
-29672,
-28121,
-26977,
-26347,
-26284,
-26805,
-27862,
-29348,
-31142,
-33074,
-35023,
-36862,
-38513,
-39921,
-41029,
-41815,
-42239,
-42315,
-42091,
-41666,
-41206,
-40889,
-40885,
-41306,
-42172,
-43418,
-44885,
-46389,
-47727,
-48720,
-49256,
-49202,
-48528,
-47136,
-45033,
-42207,
-38755,
-34820,
-30662,
-26547,
-22790,
-19640,
-17253,
-15722,
-14989,
-14988,
-15553,
-16557,
-17826,
-19229,
-20601,
-21826,
-22767,
-23380,
-23636,
-23608,
-23418,
-23200,
-23116,
-23258,
-23701,
-24452,
-25505,
-26838,
-28428,
-30255,
-32261,
-34357,
-36401,
-38205,
-39594,
-40400,
-40551,
-40045,
-38963,
-37462,
-35682,
-33803,
-31938,
-30219,
-28738,
-27607,
-26925,
-26778,
-27218,
-28226,
-29729,
-31588,
-33630,
-35690,
-37609,
-39279,
-40624,
-41599,
-42194,
-42420,
-42321,
-41995,
-41559,
-41183,
-41013,
-41176,
-41730,
-42653,
-43863,
-45218,
-46578,
-47783,
-48721,
-49264,
-49322,
-48772,
-47534,
-45530,
-42769,
-39337,
-35412,
-31272,
-27207,
-23520,
-20449,
-18134,
-16652,
-15957,
-15981,
-16590,
-17633,
-18950,
-20350,
-21674,
-22749,
-23486,
-23835,
-23841,
-23615,
-23296,
-23037,
-22960,
-23129,
-23590,
-24325,
-25355,
-26661,
-28258,
-30124,
-32196,
-34352,
-36424,
-38190,
-39477,
-40129,
-40109,
-39445,
-38251,
-36673,
-34873,
-32993,
-31169,
-29514,
-28145,
-27181,
-26712,
-26813,
-27472,
-28645,
-30192,
-31976,
-33831,
-35635,
-37300,
-38767,
-40007,
-40971,
-41638,
-41966,
-41970,
-41712,
-41300,
-40920,
-40728,
-40884,
-41442,
-42401,
-43652,
-45057,
-46447,
-47661,
-48562,
-49017,
-48901,
-48116,
-46552,
-44204,
-41100,
-37408,
-33353,
-29238,
-25337,
-21915,
-19106,
-17021,
-15630,
-14942,
-14861,
-15356,
-16305,
-17595,
-19041,
-20458,
-21639,
-22467,
-22871,
-22917,
-22721,
-22452,
-22261,
-22267,
-22520,
-23051,
-23854,
-24953,
-26365,
-28098,
-30131,
-32356,
-34616,
-36697,
-38387,
-39524,
-40031,
-39902,
-39223,
-38088,
-36600,
-34861,
-32948,
-30981,
-29098,
-27479,
-26314,
-25759,
-25878,
-26666,
-27981,
-29682,
-31565,
-33505,
-35400,
-37193,
-38845,
-40275,
-41404,
-42123,
-42383,
-42208,
-41713,
-41124,
-40660,
-40545,
-40879,
-41661,
-42792,
-44097,
-45439,
-46670,
-47739,
-48561,
-49071,
-49127,
-48569,
-47227,
-44998,
-41903,
-38093,
-33866,
-29560,
-25522,
-22014,
-19191,
-17112,
-15757,
-15097,
-15073,
-15644,
-16725,
-18178,
-19825,
-21417,
-22750,
-23655,
-24084,
-24100,
-23845,
-23505,
-23236,
-23148,
-23276,
-23634,
-24205,
-25012,
-26091,
-27496,
-29240,
-31288,
-33522,
-35764,
-37810,
-39461,
-40584,
-41099,
-41036,
-40428,
-39396,
-38019,
-36412,
-34662,
-32882,
-31173,
-29666,
-28486,
-27740,
-27515,
-27837,
-28688,
-29982,
-31614,
-33430,
-35311,
-37122,
-38791,
-40242,
-41448,
-42352,
-42940,
-43172,
-43066,
-42680,
-42125,
-41570,
-41214,
-41198,
-41655,
-42544,
-43805,
-45244,
-46687,
-47965,
-48940,
-49531,
-49662,
-49255,
-48213,
-46448,
-43905,
-40628,
-36773,
-32606,
-28445,
-24627,
-21375,
-18843,
-17043,
-15928,
-15422,
-15459,
-15990,
-16966,
-18291,
-19814,
-21307,
-22561,
-23386,
-23724,
-23636,
-23296,
-22914,
-22684,
-22694,
-22953,
-23402,
-23965,
-24647,
-25482,
-26601,
-28080,
-29958,
-32134,
-34409,
-36513,
-38201,
-39288,
-39720,
-39544,
-38874,
-37831,
-36517,
-34974,
-33249,
-31387,
-29492,
-27724,
-26271,
-25320,
-24982,
-25304,
-26208,
-27589,
-29274,
-31131,
-33039,
-34913,
-36691,
-38304,
-39668,
-40719,
-41376,
-41642,
-41549,
-41218,
-40808,
-40493,
-40424,
-40702,
-41345,
-42321,
-43522,
-44837,
-46145,
-47340,
-48334,
-49033,
-49337,
-49133,
-48298,
-46729,
-44378,
-41293,
-37610,
-33590,
-29517,
-25726,
-22446,
-19879,
-18061,
-16986,
-16563,
-16688,
-17263,
-18193,
-19365,
-20672,
-21948,
-23052,
-23841,
-24239,
-24264,
-24013,
-23638,
-23326,
-23199,
-23341,
-23773,
-24449,
-25368,
-26495,
-27870,
-29489,
-31366,
-33399,
-35472,
-37381,
-38945,
-40008,
-40510,
-40441,
-39883,
-38901,
-37588,
-35993,
-34188,
-32248,
-30326,
-28578,
-27235,
-26431,
-26283,
-26766,
-27779,
-29172,
-30769,
-32466,
-34187,
-35903,
-37604,
-39213,
-40647,
-41762,
-42447,
-42652,
-42420,
-41906,
-41320,
-40879,
-40769,
-41046,
-41729,
-42701,
-43871,
-45108,
-46340,
-47486,
-48480,
-49227,
-49581,
-49398,
-48498,
-46789,
-44229,
-40911,
-37017,
-32811,
-28601,
-24666,
-21251,
-18510,
-16516,
-15275,
-14735,
-14808,
-15408,
-16406,
-17692,
-19112,
-20511,
-21740,
-22656,
-23192,
-23344,
-23184,
-22868,
-22540,
-22365,
-22430,
-22782,
-23409,
-24304,
-25435,
-26840,
-28511,
-30463,
-32616,
-34842,
-36927,
-38670,
-39858,
-40423,
-40330,
-39697,
-38619,
-37240,
-35623,
-33847,
-31936,
-30021,
-28222,
-26776,
-25883,
-25687,
-26241,
-27421,
-29051,
-30860,
-32680,
-34354,
-35900,
-37319,
-38673,
-39924,
-40993,
-41754,
-42088,
-41988,
-41527,
-40924,
-40405,
-40209,
-40451,
-41142,
-42186,
-43427,
-44714,
-45947,
-47053,
-48001,
-48725,
-49114,
-49015,
-48262,
-46710,
-44338,
-41198,
-37497,
-33485,
-29451,
-25655,
-22302,
-19529,
-17429,
-16032,
-15354,
-15361,
-15980,
-17084,
-18507,
-20038,
-21487,
-22683,
-23515,
-23972,
-24074,
-23942,
-23680,
-23421,
-23259,
-23271,
-23500,
-23976,
-24721,
-25767,
-27116,
-28798,
-30747,
-32898,
-35100,
-37164,
-38918,
-40170,
-40842,
-40889,
-40365,
-39366,
-38002,
-36378,
-34584,
-32704,
-30839,
-29131,
-27747,
-26858,
-26613,
-27046,
-28111,
-29647,
-31437,
-33292,
-35043,
-36655,
-38111,
-39456,
-40689,
-41748,
-42538,
-42937,
-42897,
-42459,
-41794,
-41145,
-40758,
-40834,
-41411,
-42441,
-43731,
-45110,
-46380,
-47469,
-48306,
-48887,
-49146,
-48993,
-48277,
-46858,
-44648,
-41669,
-38059,
-34080,
-30012,
-26164,
-22760,
-19962,
-17852,
-16451,
-15766,
-15735,
-16316,
-17363,
-18729,
-20208,
-21587,
-22711,
-23462,
-23841,
-23894,
-23745,
-23513,
-23310,
-23216,
-23274,
-23531,
-24004,
-24755,
-25808,
-27210,
-28937,
-30936,
-33080,
-35214,
-37136,
-38702,
-39754,
-40253,
-40192,
-39622,
-38650,
-37356,
-35842,
-34176,
-32433,
-30690,
-29073,
-27706,
-26767,
-26371,
-26613,
-27472,
-28857,
-30590,
-32488,
-34371,
-36143,
-37737,
-39163,
-40405,
-41441,
-42200,
-42610,
-42626,
-42278,
-41708,
-41112,
-40742,
-40773,
-41306,
-42287,
-43579,
-44973,
-46296,
-47403,
-48245,
-48775,
-48965,
-48721,
-47920,
-46411,
-44119,
-41047,
-37346,
-33281,
-29157,
-25285,
-21888,
-19106,
-16980,
-15521,
-14710,
-14544,
-14996,
-16012,
-17437,
-19088,
-20686,
-22012,
-22898,
-23295,
-23297,
-23048,
-22745,
-22535,
-22490,
-22638,
-22953,
-23436,
-24120,
-25074,
-26386,
-28087,
-30154,
-32440,
-34765,
-36871,
-38579,
-39723,
-40270,
-40234,
-39683,
-38720,
-37410,
-35848,
-34090,
-32243,
-30412,
-28763,
-27434,
-26582,
-26299,
-26606,
-27493,
-28825,
-30507,
-32369,
-34295,
-36180,
-37942,
-39527,
-40875,
-41925,
-42630,
-42934,
-42865,
-42466,
-41893,
-41319,
-40952,
-40954,
-41419,
-42333,
-43601,
-45050,
-46510,
-47826,
-48873,
-49586,
-49872,
-49648,
-48800,
-47205,
-44804,
-41621,
-37810,
-33640,
-29445,
-25567,
-22253,
-19659,
-17797,
-16623,
-16040,
-15988,
-16407,
-17271,
-18502,
-19973,
-21501,
-22859,
-23871,
-24431,
-24564,
-24389,
-24090,
-23839,
-23745,
-23855,
-24137,
-24576,
-25173,
-25996,
-27136,
-28668,
-30600,
-32809,
-35114,
-37229,
-38936,
-40060,
-40549,
-40448,
-39870,
-38902,
-37655,
-36140,
-34422,
-32542,
-30619,
-28838,
-27372,
-26438,
-26114,
-26443,
-27339,
-28660,
-30262,
-31981,
-33745,
-35460,
-37108,
-38612,
-39920,
-40947,
-41610,
-41896,
-41802,
-41442,
-40949,
-40497,
-40247,
-40307,
-40732,
-41497,
-42535,
-43733,
-44979,
-46153,
-47157,
-47873,
-48204,
-48006,
-47167,
-45573,
-43184,
-40040,
-36290,
-32173,
-27979,
-24009,
-20505,
-17631,
-15458,
-13994,
-13191,
-13017,
-13411,
-14310,
-15618,
-17159,
-18738,
-20119,
-21124,
-21668,
-21774,
-21608,
-21353,
-21228,
-21332,
-21712,
-22293,
-23022,
-23838,
-24784,
-25945,
-27433,
-29296,
-31486,
-33830,
-36063,
-37936,
-39233,
-39878,
-39911,
-39437,
-38595,
-37489,
-36144,
-34608,
-32886,
-31104,
-29419,
-28073,
-27257,
-27111,
-27634,
-28694,
-30120,
-31682,
-33259,
-34782,
-36265,
-37730,
-39178,
-40515,
-41624,
-42337,
-42579,
-42349,
-41796,
-41130,
-40619,
-40446,
-40726,
-41430,
-42455,
-43648,
-44870,
-46027,
-47067,
-47957,
-48648,
-49037,
-48978,
-48295,
-46844,
-44541,
-41428,
-37660,
-33493,
-29244,
-25219,
-21677,
-18793,
-16643,
-15239,
-14520,
-14433,
-14867,
-15759,
-16972,
-18389,
-19835,
-21146,
-22160,
-22800,
-23030,
-22952,
-22681,
-22407,
-22254,
-22331,
-22667,
-23254,
-24084,
-25150,
-26487,
-28127,
-30067,
-32256,
-34536,
-36705,
-38533,
-39826,
-40486,
-40506,
-39969,
-38988,
-37682,
-36115,
-34349,
-32421,
-30443,
-28559,
-27003,
-25978,
-25656,
-26090,
-27193,
-28792,
-30638,
-32536,
-34331,
-35993,
-37509,
-38930,
-40217,
-41328,
-42137,
-42552,
-42527,
-42116,
-41474,
-40817,
-40372,
-40313,
-40697,
-41513,
-42620,
-43883,
-45154,
-46321,
-47344,
-48160,
-48754,
-49030,
-48878,
-48150,
-46701,
-44451,
-41406,
-37696,
-33559,
-29289,
-25227,
-21627,
-18697,
-16518,
-15088,
-14346,
-14211,
-14589,
-15410,
-16586,
-18002,
-19525,
-20962,
-22161,
-22985,
-23387,
-23427,
-23225,
-22955,
-22776,
-22783,
-23012,
-23441,
-24014,
-24725,
-25576,
-26643,
-27995,
-29661,
-31637,
-33781,
-35937,
-37878,
-39409,
-40400,
-40783,
-40591,
-39883,
-38778,
-37352,
-35731,
-33964,
-32175,
-30439,
-28901,
-27669,
-26883,
-26605,
-26889,
-27682,
-28915,
-30449,
-32163,
-33939,
-35691,
-37377,
-38956,
-40392,
-41637,
-42599,
-43207,
-43395,
-43175,
-42627,
-41929,
-41288,
-40922,
-40988,
-41531,
-42514,
-43789,
-45188,
-46544,
-47733,
-48676,
-49327,
-49630,
-49517,
-48880,
-47610,
-45636,
-42952,
-39651,
-35926,
-32012,
-28189,
-24675,
-21655,
-19218,
-17419,
-16257,
-15717,
-15773,
-16366,
-17426,
-18809,
-20361,
-21874,
-23171,
-24112,
-24624,
-24741,
-24547,
-24200,
-23843,
-23608,
-23571,
-23752,
-24160,
-24762,
-25585,
-26632,
-27958,
-29574,
-31462,
-33528,
-35619,
-37545,
-39116,
-40197,
-40717,
-40695,
-40197,
-39318,
-38142,
-36726,
-35111,
-33347,
-31519,
-29762,
-28252,
-27171,
-26664,
-26800,
-27542,
-28782,
-30335,
-32042,
-33760,
-35409,
-36971,
-38433,
-39800,
-41029,
-42057,
-42792,
-43172,
-43177,
-42855,
-42336,
-41783,
-41387,
-41280,
-41563,
-42211,
-43186,
-44346,
-45586,
-46783,
-47853,
-48730,
-49338,
-49581,
-49341,
-48465,
-46847,
-44413,
-41220,
-37419,
-33281,
-29105,
-25206,
-21810,
-19069,
-17013,
-15623,
-14834,
-14587,
-14848,
-15566,
-16686,
-18101,
-19639,
-21123,
-22339,
-23175,
-23548,
-23543,
-23244,
-22864,
-22521,
-22365,
-22439,
-22754,
-23308,
-24077,
-25085,
-26351,
-27912,
-29758,
-31844,
-34041,
-36174,
-38046,
-39465,
-40318,
-40550,
-40218,
-39400,
-38244,
-36831,
-35264,
-33571,
-31802,
-30024,
-28345,
-26941,
-25983,
-25632,
-25963,
-26932,
-28417,
-30203,
-32090,
-33923,
-35621,
-37175,
-38628,
-39964,
-41170,
-42120,
-42722,
-42872,
-42593,
-41985,
-41268,
-40680,
-40445,
-40678,
-41384,
-42460,
-43741,
-45058,
-46288,
-47354,
-48225,
-48874,
-49235,
-49214,
-48655,
-47432,
-45434,
-42672,
-39237,
-35344,
-31258,
-27282,
-23669,
-20624,
-18248,
-16577,
-15582,
-15198,
-15365,
-15993,
-17026,
-18339,
-19825,
-21299,
-22612,
-23591,
-24178,
-24348,
-24212,
-23913,
-23621,
-23482,
-23557,
-23861,
-24342,
-24972,
-25732,
-26681,
-27892,
-29441,
-31335,
-33497,
-35750,
-37859,
-39595,
-40769,
-41305,
-41215,
-40577,
-39526,
-38153,
-36566,
-34820,
-32998,
-31189,
-29523,
-28150,
-27214,
-26817,
-26990,
-27705,
-28854,
-30321,
-31970,
-33696,
-35427,
-37101,
-38683,
-40106,
-41318,
-42236,
-42798,
-42976,
-42779,
-42305,
-41686,
-41096,
-40720,
-40681,
-41063,
-41842,
-42942,
-44219,
-45540,
-46752,
-47783,
-48532,
-48959,
-48982,
-48511,
-47447,
-45700,
-43242,
-40119,
-36484,
-32558,
-28607,
-24895,
-21622,
-18934,
-16890,
-15503,
-14750,
-14596,
-14997,
-15869,
-17113,
-18565,
-20048,
-21362,
-22361,
-22937,
-23110,
-22939,
-22579,
-22177,
-21877,
-21773,
-21907,
-22283,
-22884,
-23696,
-24728,
-25993,
-27502,
-29242,
-31155,
-33126,
-35014,
-36650,
-37896,
-38656,
-38892,
-38621,
-37906,
-36808,
-35413,
-33781,
-31995,
-30143,
-28368,
-26813,
-25669,
-25055,
-25074,
-25710,
-26883,
-28449,
-30226,
-32075,
-33877,
-35588,
-37184,
-38664,
-39999,
-41143,
-42021,
-42572,
-42763,
-42628,
-42273,
-41840,
-41523,
-41453,
-41746,
-42409,
-43404,
-44618,
-45937,
-47234,
-48412,
-49388,
-50078,
-50400,
-50227,
-49444,
-47932,
-45632,
-42572,
-38895,
-34824,
-30674,
-26726,
-23243,
-20375,
-18189,
-16664,
-15742,
-15368,
-15485,
-16071,
-17055,
-18359,
-19816,
-21250,
-22459,
-23292,
-23701,
-23716,
-23469,
-23134,
-22839,
-22726,
-22791,
-23073,
-23510,
-24126,
-24939,
-26008,
-27398,
-29112,
-31109,
-33258,
-35381,
-37288,
-38799,
-39808,
-40269,
-40202,
-39679,
-38767,
-37541,
-36067,
-34383,
-32573,
-30717,
-28962,
-27464,
-26400,
-25898,
-26041,
-26795,
-28076,
-29701,
-31501,
-33318,
-35047,
-36665,
-38159,
-39543,
-40784,
-41807,
-42520,
-42819,
-42694,
-42198,
-41510,
-40856,
-40462,
-40509,
-41033,
-41994,
-43225,
-44556,
-45827,
-46937,
-47850,
-48549,
-49002,
-49141,
-48819,
-47884,
-46192,
-43672,
-40389,
-36510,
-32316,
-28123,
-24232,
-20884,
-18216,
-16286,
-15059,
-14486,
-14477,
-14971,
-15875,
-17110,
-18540,
-20023,
-21369,
-22440,
-23092,
-23332,
-23184,
-22822,
-22407,
-22118,
-22075,
-22313,
-22821,
-23530,
-24408,
-25437,
-26666,
-28148,
-29923,
-31959,
-34144,
-36281,
-38153,
-39553,
-40356,
-40529,
-40130,
-39262,
-38054,
-36599,
-34974,
-33242,
-31468,
-29762,
-28265,
-27124,
-26479,
-26402,
-26893,
-27880,
-29230,
-30812,
-32501,
-34212,
-35903,
-37537,
-39081,
-40481,
-41641,
-42480,
-42921,
-42940,
-42591,
-42002,
-41344,
-40837,
-40635,
-40856,
-41519,
-42542,
-43813,
-45160,
-46454,
-47580,
-48471,
-49056,
-49293,
-49059,
-48279,
-46821,
-44636,
-41752,
-38279,
-34445,
-30508,
-26746,
-23368,
-20544,
-18320,
-16736,
-15758,
-15380,
-15559,
-16260,
-17383,
-18808,
-20328,
-21768,
-22925,
-23700,
-24055,
-24053,
-23819,
-23503,
-23241,
-23127,
-23213,
-23496,
-23986,
-24663,
-25565,
-26709,
-28139,
-29839,
-31771,
-33819,
-35823,
-37620,
-39027,
-39949,
-40331,
-40187,
-39593,
-38617,
-37343,
-35824,
-34116,
-32278,
-30423,
-28694,
-27273,
-26350,
-26039,
-26397,
-27356,
-28764,
-30444,
-32199,
-33921,
-35542,
-37064,
-38505,
-39848,
-41044,
-41989,
-42579,
-42748,
-42518,
-41985,
-41356,
-40828,
-40600,
-40776,
-41363,
-42296,
-43430,
-44641,
-45804,
-46859,
-47755,
-48460,
-48898,
-48975,
-48534,
-47437,
-45575,
-42917,
-39572,
-35716,
-31652,
-27666,
-24051,
-20983,
-18580,
-16831,
-15699,
-15115,
-15023,
-15396,
-16197,
-17372,
-18812,
-20345,
-21774,
-22897,
-23596,
-23829,
-23688,
-23316,
-22913,
-22621,
-22537,
-22682,
-23018,
-23536,
-24220,
-25137,
-26346,
-27918,
-29845,
-32032,
-34318,
-36451,
-38239,
-39476,
-40114,
-40131,
-39622,
-38682,
-37417,
-35913,
-34231,
-32439,
-30613,
-28875,
-27357,
-26223,
-25603,
-25577,
-26163,
-27280,
-28812,
-30586,
-32451,
-34271,
-35992,
-37560,
-38990,
-40249,
-41304,
-42085,
-42511,
-42539,
-42198,
-41599,
-40939,
-40442,
-40308,
-40647,
-41458,
-42619,
-43969,
-45306,
-46521,
-47521,
-48304,
-48847,
-49094,
-48939,
-48210,
-46766,
-44502,
-41455,
-37774,
-33729,
-29628,
-25766,
-22362,
-19534,
-17337,
-15737,
-14727,
-14263,
-14340,
-14918,
-15949,
-17307,
-18855,
-20401,
-21778,
-22851,
-23544,
-23856,
-23860,
-23649,
-23367,
-23122,
-23014,
-23105,
-23416,
-23948,
-24700,
-25653,
-26823,
-28207,
-29819,
-31619,
-33563,
-35525,
-37381,
-38977,
-40180,
-40913,
-41132,
-40877,
-40189,
-39161,
-37849,
-36328,
-34653,
-32901,
-31163,
-29574,
-28272,
-27408,
-27078,
-27329,
-28134,
-29375,
-30927,
-32614,
-34311,
-35940,
-37451,
-38854,
-40157,
-41336,
-42363,
-43142,
-43602,
-43685,
-43395,
-42822,
-42131,
-41516,
-41188,
-41269,
-41819,
-42772,
-44001,
-45325,
-46586,
-47668,
-48516,
-49124,
-49493,
-49588,
-49346,
-48607,
-47255,
-45147,
-42287,
-38752,
-34784,
-30665,
-26734,
-23243,
-20375,
-18181,
-16632,
-15651,
-15164,
-15124,
-15525,
-16348,
-17553,
-19032,
-20603,
-22065,
-23206,
-23908,
-24132,
-23973,
-23574,
-23139,
-22807,
-22691,
-22805,
-23132,
-23629,
-24278,
-25085,
-26104,
-27363,
-28899,
-30671,
-32590,
-34535,
-36332,
-37853,
-38979,
-39636,
-39828,
-39551,
-38874,
-37834,
-36510,
-34950,
-33237,
-31430,
-29633,
-27935,
-26478,
-25368,
-24747,
-24674,
-25203,
-26272,
-27789,
-29581,
-31476,
-33324,
-35016,
-36530,
-37876,
-39085,
-40185,
-41123,
-41834,
-42208,
-42195,
-41804,
-41170,
-40492,
-40025,
-39958,
-40411,
-41331,
-42590,
-43977,
-45303,
-46456,
-47401,
-48163,
-48778,
-49206,
-49342,
-48979,
-47929,
-46034,
-43290,
-39832,
-35932,
-31922,
-28123,
-24752,
-21940,
-19683,
-17950,
-16691,
-15886,
-15568,
-15760,
-16471,
-17631,
-19104,
-20676,
-22137,
-23288,
-24024,
-24337,
-24292,
-24035,
-23690,
-23402,
-23221,
-23206,
-23333,
-23628,
-24077,
-24746,
-25657,
-26887,
-28434,
-30283,
-32343,
-34479,
-36522,
-38288,
-39646,
-40465,
-40747,
-40476,
-39753,
-38652,
-37284,
-35720,
-34040,
-32282,
-30535,
-28866,
-27407,
-26288,
-25640,
-25564,
-26084,
-27157,
-28653,
-30415,
-32267,
-34092,
-35794,
-37376,
-38811,
-40131,
-41277,
-42203,
-42804,
-43027,
-42838,
-42323,
-41609,
-40911,
-40425,
-40309,
-40646,
-41405,
-42504,
-43778,
-45104,
-46349,
-47444,
-48343,
-48999,
-49353,
-49295,
-48693,
-47404,
-45340,
-42486,
-38954,
-34955,
-30789,
-26749,
-23120,
-20051,
-17635,
-15839,
-14615,
-13905,
-13682,
-13949,
-14701,
-15902,
-17431,
-19106,
-20700,
-21988,
-22838,
-23204,
-23166,
-22890,
-22539,
-22281,
-22176,
-22254,
-22468,
-22801,
-23248,
-23865,
-24733,
-25939,
-27515,
-29436,
-31595,
-33811,
-35916,
-37708,
-39070,
-39929,
-40261,
-40106,
-39511,
-38538,
-37260,
-35728,
-34024,
-32220,
-30416,
-28727,
-27277,
-26186,
-25569,
-25478,
-25953,
-26935,
-28353,
-30058,
-31917,
-33786,
-35560,
-37182,
-38613,
-39865,
-40912,
-41757,
-42335,
-42618,
-42567,
-42215,
-41650,
-41024,
-40539,
-40355,
-40617,
-41322,
-42418,
-43747,
-45129,
-46425,
-47499,
-48333,
-48876,
-49135,
-49037,
-48503,
-47406,
-45653,
-43201,
-40118,
-36552,
-32740,
-28939,
-25376,
-22245,
-19628,
-17586,
-16119,
-15216,
-14889,
-15103,
-15846,
-17026,
-18510,
-20126,
-21655,
-22932,
-23813,
-24260,
-24319,
-24089,
-23736,
-23383,
-23152,
-23091,
-23217,
-23525,
-23996,
-24664,
-25556,
-26732,
-28239,
-30046,
-32113,
-34271,
-36365,
-38189,
-39591,
-40480,
-40821,
-40665,
-40088,
-39178,
-38021,
-36662,
-35141,
-33494,
-31780,
-30088,
-28559,
-27327,
-26557,
-26321,
-26688,
-27584,
-28934,
-30564,
-32343,
-34125,
-35840,
-37432,
-38897,
-40210,
-41353,
-42258,
-42868,
-43117,
-43000,
-42566,
-41938,
-41299,
-40816,
-40676,
-40932,
-41623,
-42645,
-43888,
-45195,
-46439,
-47524,
-48400,
-49021,
-49362,
-49350,
-48898,
-47900,
-46247,
-43906,
-40895,
-37353,
-33485,
-29560,
-25834,
-22532,
-19798,
-17691,
-16219,
-15333,
-15000,
-15169,
-15813,
-16870,
-18247,
-19804,
-21356,
-22718,
-23738,
-24333,
-24506,
-24362,
-24019,
-23650,
-23345,
-23198,
-23208,
-23382,
-23717,
-24222,
-24970,
-26000,
-27393,
-29128,
-31170,
-33377,
-35578,
-37579,
-39194,
-40317,
-40870,
-40894,
-40418,
-39548,
-38353,
-36906,
-35264,
-33477,
-31625,
-29801,
-28157,
-26822,
-25962,
-25659,
-25968,
-26839,
-28179,
-29837,
-31660,
-33505,
-35281,
-36921,
-38422,
-39751,
-40916,
-41852,
-42528,
-42872,
-42871,
-42545,
-41997,
-41381,
-40883,
-40678,
-40873,
-41506,
-42498,
-43738,
-45047,
-46306,
-47408,
-48315,
-48997,
-49442,
-49555,
-49250,
-48366,
-46786,
-44450,
-41399,
-37778,
-33830,
-29824,
-26016,
-22630,
-19771,
-17526,
-15885,
-14847,
-14383,
-14466,
-15045,
-16060,
-17372,
-18864,
-20341,
-21660,
-22697,
-23383,
-23730,
-23801,
-23694,
-23535,
-23411,
-23406,
-23541,
-23836,
-24281,
-24899,
-25714,
-26780,
-28138,
-29807,
-31753,
-33880,
-36035,
-38029,
-39693,
-40881,
-41528,
-41627,
-41227,
-40418,
-39272,
-37882,
-36280,
-34543,
-32720,
-30915,
-29257,
-27897,
-26983,
-26635,
-26898,
-27734,
-29052,
-30671,
-32445,
-34208,
-35881,
-37415,
-38811,
-40088,
-41220,
-42184,
-42889,
-43271,
-43287,
-42962,
-42402,
-41772,
-41267,
-41043,
-41215,
-41777,
-42677,
-43786,
-44975,
-46145,
-47214,
-48153,
-48923,
-49466,
-49700,
-49479,
-48672,
-47158,
-44884,
-41898,
-38340,
-34429,
-30444,
-26630,
-23218,
-20346,
-18090,
-16459,
-15431,
-14956,
-15002,
-15500,
-16411,
-17613,
-19003,
-20406,
-21662,
-22639,
-23239,
-23468,
-23376,
-23086,
-22737,
-22456,
-22331,
-22408,
-22678,
-23131,
-23735,
-24504,
-25460,
-26651,
-28107,
-29839,
-31774,
-33814,
-35768,
-37464,
-38728,
-39449,
-39611,
-39231,
-38437,
-37297,
-35942,
-34393,
-32703,
-30888,
-29004,
-27179,
-25555,
-24345,
-23702,
-23742,
-24453,
-25747,
-27428,
-29311,
-31207,
-32999,
-34655,
-36164,
-37572,
-38863,
-40018,
-40942,
-41564,
-41802,
-41683,
-41252,
-40704,
-40180,
-39905,
-39978,
-40460,
-41314,
-42433,
-43696,
-44981,
-46198,
-47292,
-48218,
-48926,
-49324,
-49296,
-48688,
-47389,
-45328,
-42540,
-39160,
-35388,
-31499,
-27725,
-24286,
-21317,
-18895,
-17054,
-15788,
-15097,
-14956,
-15342,
-16181,
-17383,
-18790,
-20248,
-21582,
-22657,
-23396,
-23768,
-23828,
-23659,
-23369,
-23073,
-22842,
-22754,
-22819,
-23085,
-23543,
-24244,
-25204,
-26464,
-28023,
-29871,
-31910,
-34045,
-36089,
-37898,
-39306,
-40208,
-40554,
-40348,
-39651,
-38551,
-37144,
-35531,
-33781,
-31981,
-30190,
-28516,
-27058,
-25955,
-25320,
-25259,
-25788,
-26887,
-28417,
-30234,
-32146,
-34017,
-35747,
-37297,
-38687,
-39913,
-40983,
-41837,
-42411,
-42626,
-42472,
-41981,
-41307,
-40627,
-40164,
-40076,
-40449,
-41268,
-42417,
-43747,
-45086,
-46314,
-47340,
-48144,
-48695,
-48977,
-48925,
-48435,
-47398,
-45698,
-43299,
-40226,
-36624,
-32699,
-28727,
-24959,
-21624,
-18849,
-16699,
-15154,
-14166,
-13685,
-13669,
-14093,
-14935,
-16139,
-17602,
-19189,
-20707,
-22005,
-22942,
-23479,
-23631,
-23508,
-23217,
-22906,
-22647,
-22519,
-22533,
-22693,
-23027,
-23530,
-24271,
-25276,
-26580,
-28193,
-30059,
-32104,
-34195,
-36187,
-37932,
-39299,
-40210,
-40613,
-40534,
-40015,
-39139,
-37987,
-36628,
-35122,
-33511,
-31851,
-30194,
-28650,
-27318,
-26344,
-25837,
-25878,
-26483,
-27593,
-29095,
-30825,
-32645,
-34401,
-36050,
-37533,
-38881,
-40097,
-41185,
-42101,
-42800,
-43185,
-43245,
-42955,
-42421,
-41765,
-41172,
-40808,
-40798,
-41186,
-41959,
-43003,
-44217,
-45454,
-46635,
-47684,
-48572,
-49262,
-49701,
-49801,
-49441,
-48488,
-46849,
-44477,
-41436,
-37875,
-34018,
-30140,
-26478,
-23234,
-20516,
-18370,
-16779,
-15713,
-15136,
-15046,
-15417,
-16246,
-17451,
-18921,
-20499,
-21991,
-23242,
-24133,
-24617,
-24730,
-24568,
-24235,
-23883,
-23586,
-23438,
-23460,
-23676,
-24075,
-24669,
-25450,
-26445,
-27662,
-29119,
-30796,
-32656,
-34607,
-36534,
-38299,
-39754,
-40800,
-41360,
-41415,
-41004,
-40176,
-39022,
-37616,
-36037,
-34356,
-32649,
-30986,
-29465,
-28173,
-27205,
-26649,
-26547,
-26935,
-27777,
-29014,
-30537,
-32231,
-33971,
-35659,
-37239,
-38671,
-39974,
-41122,
-42117,
-42890,
-43385,
-43533,
-43317,
-42793,
-42095,
-41413,
-40957,
-40877,
-41258,
-42057,
-43161,
-44398,
-45613,
-46692,
-47604,
-48355,
-48969,
-49446,
-49701,
-49615,
-48991,
-47681,
-45570,
-42681,
-39141,
-35188,
-31122,
-27223,
-23741,
-20805,
-18482,
-16738,
-15532,
-14801,
-14529,
-14697,
-15318,
-16346,
-17700,
-19231,
-20751,
-22063,
-23029,
-23562,
-23698,
-23530,
-23204,
-22858,
-22616,
-22507,
-22571,
-22761,
-23087,
-23546,
-24184,
-25060,
-26226,
-27710,
-29486,
-31478,
-33576,
-35627,
-37501,
-39064,
-40225,
-40932,
-41152,
-40902,
-40209,
-39121,
-37711,
-36049,
-34227,
-32351,
-30506,
-28823,
-27387,
-26312,
-25671,
-25518,
-25875,
-26697,
-27939,
-29463,
-31184,
-32953,
-34702,
-36350,
-37881,
-39273,
-40520,
-41589,
-42434,
-42982,
-43192,
-43023,
-42545,
-41833,
-41102,
-40503,
-40253,
-40440,
-41103,
-42160,
-43479,
-44868,
-46183,
-47303,
-48177,
-48824,
-49225,
-49410,
-49268,
-48724,
-47590,
-45772,
-43192,
-39926,
-36143,
-32118,
-28149,
-24525,
-21429,
-18961,
-17110,
-15822,
-15010,
-14646,
-14691,
-15174,
-16073,
-17339,
-18857,
-20434,
-21891,
-23023,
-23752,
-24035,
-23987,
-23722,
-23426,
-23224,
-23188,
-23348,
-23651,
-24061,
-24546,
-25119,
-25834,
-26785,
-28033,
-29625,
-31524,
-33614,
-35748,
-37717,
-39365,
-40555,
-41240,
-41415,
-41154,
-40518,
-39588,
-38416,
-37033,
-35471,
-33770,
-32005,
-30269,
-28716,
-27463,
-26652,
-26357,
-26602,
-27359,
-28530,
-30002,
-31634,
-33317,
-34958,
-36515,
-37960,
-39293,
-40498,
-41550,
-42395,
-42960,
-43193,
-43068,
-42625,
-41972,
-41261,
-40682,
-40396,
-40507,
-41049,
-41951,
-43104,
-44355,
-45571,
-46660,
-47566,
-48277,
-48772,
-49021,
-48937,
-48415,
-47320,
-45565,
-43106,
-40018,
-36441,
-32623,
-28797,
-25226,
-22068,
-19452,
-17394,
-15901,
-14913,
-14419,
-14375,
-14768,
-15562,
-16674,
-18008,
-19407,
-20711,
-21788,
-22526,
-22914,
-22971,
-22796,
-22503,
-22205,
-21997,
-21936,
-22028,
-22279,
-22655,
-23157,
-23810,
-24643,
-25734,
-27121,
-28814,
-30783,
-32881,
-34965,
-36814,
-38263,
-39184,
-39537,
-39365,
-38767,
-37866,
-36759,
-35518,
-34164,
-32700,
-31161,
-29584,
-28106,
-26847,
-25983,
-25609,
-25797,
-26517,
-27676,
-29162,
-30820,
-32561,
-34297,
-35990,
-37621,
-39156,
-40567,
-41782,
-42748,
-43395,
-43693,
-43653,
-43329,
-42827,
-42272,
-41811,
-41558,
-41607,
-41983,
-42674,
-43602,
-44685,
-45799,
-46870,
-47809,
-48576,
-49129,
-49415,
-49380,
-48916,
-47927,
-46317,
-44026,
-41094,
-37612,
-33790,
-29863,
-26094,
-22704,
-19855,
-17616,
-16005,
-14969,
-14459,
-14428,
-14825,
-15631,
-16770,
-18169,
-19675,
-21131,
-22371,
-23257,
-23738,
-23822,
-23615,
-23250,
-22872,
-22615,
-22528,
-22648,
-22947,
-23396,
-24001,
-24754,
-25728,
-26936,
-28435,
-30189,
-32142,
-34164,
-36114,
-37824,
-39179,
-40082,
-40518,
-40493,
-40070,
-39301,
-38249,
-36955,
-35456,
-33789,
-32012,
-30226,
-28550,
-27137,
-26136,
-25656,
-25760,
-26425,
-27567,
-29048,
-30722,
-32434,
-34105,
-35663,
-37122,
-38472,
-39744,
-40898,
-41903,
-42661,
-43114,
-43190,
-42917,
-42349,
-41648,
-40981,
-40554,
-40488,
-40874,
-41670,
-42790,
-44071,
-45369,
-46545,
-47540,
-48317,
-48872,
-49199,
-49220,
-48854,
-47942,
-46378,
-44088,
-41105,
-37574,
-33709,
-29788,
-26053,
-22710,
-19868,
-17576,
-15834,
-14620,
-13940,
-13779,
-14155,
-15013,
-16286,
-17815,
-19425,
-20924,
-22145,
-22995,
-23446,
-23540,
-23386,
-23090,
-22775,
-22538,
-22433,
-22519,
-22789,
-23267,
-23931,
-24788,
-25832,
-27071,
-28501,
-30128,
-31918,
-33814,
-35728,
-37524,
-39070,
-40236,
-40916,
-41083,
-40732,
-39951,
-38806,
-37427,
-35873,
-34234,
-32557,
-30898,
-29332,
-27949,
-26861,
-26190,
-26030,
-26424,
-27374,
-28769,
-30501,
-32370,
-34242,
-35978,
-37526,
-38866,
-40041,
-41059,
-41951,
-42660,
-43139,
-43309,
-43142,
-42664,
-42005,
-41316,
-40834,
-40684,
-40989,
-41711,
-42761,
-43981,
-45212,
-46340,
-47308,
-48106,
-48734,
-49171,
-49336,
-49104,
-48313,
-46841,
-44620,
-41704,
-38235,
-34449,
-30604,
-26952,
-23674,
-20884,
-18616,
-16869,
-15600,
-14815,
-14484,
-14640,
-15267,
-16320,
-17720,
-19295,
-20873,
-22252,
-23284,
-23881,
-24065,
-23913,
-23585,
-23222,
-22966,
-22876,
-22984,
-23257,
-23665,
-24192,
-24848,
-25683,
-26743,
-28086,
-29699,
-31555,
-33544,
-35546,
-37416,
-39010,
-40233,
-40995,
-41279,
-41078,
-40429,
-39397,
-38039,
-36449,
-34693,
-32868,
-31048,
-29351,
-27859,
-26711,
-25976,
-25756,
-26054,
-26866,
-28092,
-29633,
-31332,
-33092,
-34794,
-36409,
-37889,
-39249,
-40453,
-41487,
-42284,
-42792,
-42956,
-42775,
-42290,
-41617,
-40916,
-40363,
-40125,
-40305,
-40924,
-41933,
-43187,
-44544,
-45837,
-46964,
-47869,
-48540,
-48983,
-49176,
-49053,
-48473,
-47310,
-45409,
-42736,
-39352,
-35439,
-31295,
-27216,
-23511,
-20351,
-17842,
-15965,
-14637,
-13809,
-13399,
-13425,
-13873,
-14763,
-16017,
-17546,
-19146,
-20632,
-21823,
-22607,
-22964,
-22967,
-22734,
-22427,
-22164,
-22038,
-22078,
-22286,
-22635,
-23128,
-23770,
-24621,
-25719,
-27132,
-28841,
-30830,
-32962,
-35101,
-37054,
-38660,
-39798,
-40402,
-40493,
-40120,
-39385,
-38362,
-37114,
-35681,
-34073,
-32339,
-30547,
-28821,
-27329,
-26236,
-25696,
-25773,
-26465,
-27669,
-29234,
-31000,
-32802,
-34555,
-36201,
-37728,
-39133,
-40397,
-41470,
-42290,
-42790,
-42928,
-42727,
-42261,
-41678,
-41141,
-40832,
-40873,
-41328,
-42181,
-43337,
-44671,
-46028,
-47281,
-48339,
-49131,
-49632,
-49782,
-49526,
-48783,
-47444,
-45465,
-42815,
-39591,
-35944,
-32111,
-28345,
-24879,
-21888,
-19469,
-17657,
-16434,
-15777,
-15661,
-16047,
-16917,
-18160,
-19678,
-21265,
-22743,
-23927,
-24704,
-25049,
-25021,
-24747,
-24376,
-24048,
-23853,
-23837,
-24008,
-24352,
-24888,
-25625,
-26625,
-27908,
-29507,
-31368,
-33414,
-35494,
-37457,
-39138,
-40418,
-41210,
-41506,
-41304,
-40682,
-39677,
-38377,
-36837,
-35126,
-33327,
-31528,
-29843,
-28411,
-27341,
-26766,
-26718,
-27229,
-28221,
-29599,
-31222,
-32944,
-34675,
-36309,
-37846,
-39235,
-40484,
-41538,
-42355,
-42852,
-42998,
-42772,
-42268,
-41598,
-40974,
-40558,
-40515,
-40905,
-41701,
-42807,
-44072,
-45352,
-46528,
-47522,
-48297,
-48816,
-49033,
-48863,
-48191,
-46905,
-44927,
-42239,
-38941,
-35192,
-31240,
-27349,
-23751,
-20633,
-18092,
-16155,
-14807,
-13991,
-13681,
-13817,
-14396,
-15337,
-16590,
-17992,
-19405,
-20628,
-21536,
-22034,
-22148,
-21962,
-21646,
-21364,
-21254,
-21401,
-21794,
-22422,
-23203,
-24141,
-25221,
-26520,
-28068,
-29904,
-31980,
-34170,
-36313,
-38185,
-39632,
-40531,
-40861,
-40673,
-40062,
-39143,
-38003,
-36696,
-35256,
-33702,
-32091,
-30508,
-29103,
-28021,
-27426,
-27399,
-27964,
-29038,
-30489,
-32129,
-33813,
-35412,
-36882,
-38223,
-39449,
-40586,
-41593,
-42420,
-42969,
-43184,
-43030,
-42593,
-41979,
-41403,
-41028,
-41005,
-41392,
-42148,
-43184,
-44349,
-45522,
-46605,
-47553,
-48337,
-48947,
-49319,
-49351,
-48905,
-47825,
-46004,
-43415,
-40130,
-36341,
-32310,
-28312,
-24613,
-21386,
-18742,
-16709,
-15275,
-14411,
-14102,
-14323,
-15046,
-16198,
-17653,
-19231,
-20731,
-21967,
-22811,
-23241,
-23293,
-23120,
-22845,
-22620,
-22519,
-22571,
-22770,
-23094,
-23545,
-24161,
-25005,
-26154,
-27639,
-29464,
-31529,
-33705,
-35809,
-37665,
-39124,
-40099,
-40560,
-40511,
-40023,
-39126,
-37921,
-36422,
-34743,
-32895,
-31032,
-29226,
-27639,
-26400,
-25630,
-25416,
-25773,
-26677,
-28012,
-29669,
-31477,
-33331,
-35112,
-36780,
-38295,
-39650,
-40817,
-41755,
-42398,
-42695,
-42620,
-42217,
-41599,
-40951,
-40458,
-40318,
-40602,
-41333,
-42402,
-43664,
-44954,
-46147,
-47164,
-47992,
-48609,
-48988,
-49042,
-48630,
-47612,
-45856,
-43340,
-40134,
-36418,
-32462,
-28523,
-24856,
-21619,
-18913,
-16772,
-15205,
-14210,
-13783,
-13922,
-14583,
-15692,
-17113,
-18673,
-20186,
-21493,
-22476,
-23099,
-23375,
-23385,
-23226,
-22998,
-22800,
-22690,
-22724,
-22936,
-23355,
-24013,
-24934,
-26136,
-27621,
-29366,
-31309,
-33357,
-35387,
-37248,
-38801,
-39917,
-40515,
-40569,
-40102,
-39191,
-37929,
-36422,
-34762,
-33025,
-31283,
-29617,
-28125,
-26927,
-26159,
-25915,
-26261,
-27165,
-28530,
-30203,
-32008,
-33798,
-35489,
-37033,
-38461,
-39758,
-40940,
-41923,
-42641,
-42995,
-42955,
-42550,
-41915,
-41226,
-40688,
-40475,
-40667,
-41273,
-42217,
-43366,
-44613,
-45836,
-46981,
-47980,
-48795,
-49332,
-49496,
-49138,
-48149,
-46436,
-44004,
-40935,
-37394,
-33613,
-29829,
-26267,
-23085,
-20401,
-18249,
-16657,
-15619,
-15126,
-15184,
-15751,
-16775,
-18138,
-19675,
-21201,
-22515,
-23486,
-24037,
-24193,
-24048,
-23740,
-23412,
-23190,
-23124,
-23249,
-23546,
-23997,
-24625,
-25441,
-26517,
-27885,
-29567,
-31506,
-33616,
-35713,
-37638,
-39209,
-40298,
-40857,
-40867,
-40409,
-39542,
-38380,
-36978,
-35423,
-33748,
-32044,
-30368,
-28854,
-27612,
-26770,
-26436,
-26647,
-27405,
-28624,
-30188,
-31939,
-33749,
-35480,
-37094,
-38531,
-39823,
-40942,
-41892,
-42614,
-43055,
-43163,
-42927,
-42413,
-41757,
-41152,
-40785,
-40823,
-41310,
-42215,
-43404,
-44704,
-45962,
-47066,
-47967,
-48658,
-49120,
-49299,
-49076,
-48297,
-46810,
-44542,
-41507,
-37874,
-33880,
-29827,
-25989,
-22565,
-19686,
-17379,
-15664,
-14516,
-13940,
-13941,
-14489,
-15548,
-16968,
-18598,
-20207,
-21616,
-22669,
-23304,
-23546,
-23476,
-23233,
-22937,
-22697,
-22585,
-22626,
-22843,
-23231,
-23827,
-24648,
-25749,
-27147,
-28856,
-30821,
-32954,
-35117,
-37136,
-38851,
-40121,
-40856,
-41038,
-40696,
-39913,
-38783,
-37408,
-35845,
-34172,
-32411,
-30648,
-28960,
-27495,
-26395,
-25825,
-25868,
-26558,
-27814,
-29485,
-31374,
-33306,
-35129,
-36802,
-38295,
-39655,
-40873,
-41934,
-42751,
-43234,
-43318,
-43000,
-42379,
-41637,
-40990,
-40661,
-40768,
-41365,
-42353,
-43615,
-44949,
-46233,
-47351,
-48281,
-48997,
-49507,
-49742,
-49622,
-49005,
-47755,
-45779,
-43063,
-39709,
-35903,
-31928,
-28041,
-24515,
-21512,
-19135,
-17395,
-16265,
-15691,
-15630,
-16050,
-16903,
-18124,
-19598,
-21156,
-22618,
-23800,
-24580,
-24917,
-24863,
-24544,
-24133,
-23774,
-23592,
-23622,
-23878,
-24321,
-24931,
-25708,
-26694,
-27921,
-29450,
-31249,
-33261,
-35356,
-37342,
-39059,
-40338,
-41098,
-41313,
-41027,
-40315,
-39272,
-37978,
-36484,
-34852,
-33116,
-31363,
-29701,
-28253,
-27189,
-26608,
-26613,
-27188,
-28283,
-29751,
-31448,
-33202,
-34898,
-36451,
-37844,
-39063,
-40138,
-41046,
-41752,
-42210,
-42343,
-42146,
-41658,
-40992,
-40340,
-39891,
-39828,
-40218,
-41070,
-42233,
-43558,
-44844,
-45966,
-46855,
-47503,
-47927,
-48105,
-47971,
-47375,
-46170,
-44222,
-41511,
-38130,
-34301,
-30310,
-26452,
-22954,
-19960,
-17512,
-15607,
-14213,
-13333,
-12981,
-13181,
-13923,
-15127,
-16637,
-18240,
-19705,
-20847,
-21556,
-21843,
-21775,
-21522,
-21220,
-21012,
-20979,
-21148,
-21527,
-22096,
-22848,
-23797,
-24948,
-26336,
-27944,
-29756,
-31705,
-33687,
-35597,
-37291,
-38669,
-39628,
-40130,
-40146,
-39728,
-38899,
-37764,
-36370,
-34818,
-33172,
-31523,
-29975,
-28636,
-27632,
-27068,
-27015,
-27503,
-28457,
-29801,
-31356,
-33008,
-34627,
-36156,
-37571,
-38885,
-40085,
-41159,
-42017,
-42600,
-42808,
-42645,
-42150,
-41469,
-40796,
-40324,
-40226,
-40575,
-41360,
-42480,
-43787,
-45121,
-46361,
-47412,
-48240,
-48821,
-49107,
-49047,
-48509,
-47373,
-45528,
-42919,
-39603,
-35746,
-31600,
-27483,
-23676,
-20414,
-17813,
-15898,
-14620,
-13910,
-13696,
-13952,
-14652,
-15765,
-17208,
-18826,
-20420,
-21776,
-22726,
-23207,
-23252,
-23007,
-22649,
-22347,
-22224,
-22296,
-22561,
-22964,
-23485,
-24166,
-25062,
-26274,
-27854,
-29789,
-31978,
-34251,
-36375,
-38156,
-39423,
-40106,
-40206,
-39799,
-38969,
-37836,
-36447,
-34878,
-33157,
-31354,
-29570,
-27946,
-26656,
-25861,
-25676,
-26125,
-27157,
-28616,
-30350,
-32174,
-33983,
-35712,
-37332,
-38853,
-40207,
-41361,
-42179,
-42600,
-42581,
-42168,
-41531,
-40847,
-40370,
-40243,
-40573,
-41327,
-42412,
-43674,
-44977,
-46198,
-47274,
-48144,
-48777,
-49078,
-48956,
-48259,
-46876,
-44715,
-41789,
-38205,
-34175,
-29992,
-25949,
-22341,
-19354,
-17109,
-15609,
-14798,
-14593,
-14890,
-15619,
-16700,
-18042,
-19535,
-21010,
-22301,
-23251,
-23771,
-23868,
-23645,
-23266,
-22927,
-22755,
-22838,
-23155,
-23676,
-24345,
-25180,
-26212,
-27547,
-29223,
-31244,
-33494,
-35771,
-37834,
-39451,
-40469,
-40832,
-40599,
-39864,
-38775,
-37417,
-35874,
-34201,
-32437,
-30696,
-29089,
-27782,
-26928,
-26621,
-26912,
-27741,
-29010,
-30568,
-32291,
-34045,
-35783,
-37425,
-38961,
-40322,
-41467,
-42308,
-42801,
-42905,
-42667,
-42167,
-41573,
-41047,
-40771,
-40856,
-41358,
-42243,
-43416,
-44751,
-46104,
-47373,
-48442,
-49249,
-49700,
-49698,
-49146,
-47928,
-45997,
-43351,
-40089,
-36393,
-32493,
-28653,
-25094,
-22007,
-19487,
-17611,
-16363,
-15763,
-15741,
-16278,
-17254,
-18576,
-20059,
-21543,
-22838,
-23823,
-24411,
-24618,
-24507,
-24211,
-23861,
-23599,
-23508,
-23649,
-24031,
-24645,
-25497,
-26571,
-27908,
-29494,
-31330,
-33332,
-35384,
-37313,
-38939,
-40112,
-40745,
-40821,
-40403,
-39579,
-38434,
-37048,
-35446,
-33680,
-31820,
-29984,
-28358,
-27133,
-26480,
-26497,
-27148,
-28331,
-29842,
-31514,
-33196,
-34838,
-36424,
-37985,
-39499,
-40913,
-42096,
-42924,
-43282,
-43168,
-42659,
-41956,
-41277,
-40856,
-40829,
-41254,
-42076,
-43174,
-44414,
-45657,
-46826,
-47858,
-48714,
-49337,
-49629,
-49447,
-48633,
-47051,
-44634,
-41435,
-37619,
-33465,
-29298,
-25424,
-22086,
-19395,
-17389,
-15998,
-15160,
-14804,
-14918,
-15473,
-16468,
-17803,
-19333,
-20858,
-22142,
-23034,
-23464,
-23469,
-23212,
-22859,
-22601,
-22527,
-22693,
-23057,
-23603,
-24301,
-25197,
-26345,
-27811,
-29613,
-31692,
-33910,
-36068,
-37949,
-39375,
-40232,
-40498,
-40218,
-39485,
-38404,
-37058,
-35518,
-33817,
-32032,
-30223,
-28541,
-27134,
-26167,
-25781,
-26031,
-26888,
-28243,
-29910,
-31730,
-33535,
-35266,
-36870,
-38378,
-39760,
-41000,
-41988,
-42638,
-42859,
-42651,
-42113,
-41427,
-40831,
-40539,
-40691,
-41314,
-42327,
-43569,
-44886,
-46124,
-47216,
-48115,
-48796,
-49215,
-49276,
-48833,
-47756,
-45906,
-43278,
-39938,
-36084,
-31977,
-27926,
-24200,
-21025,
-18522,
-16749,
-15677,
-15255,
-15400,
-16029,
-17053,
-18374,
-19848,
-21338,
-22656,
-23669,
-24264,
-24435,
-24249,
-23859,
-23444,
-23165,
-23138,
-23385,
-23898,
-24606,
-25499,
-26567,
-27866,
-29447,
-31325,
-33431,
-35629,
-37689,
-39410,
-40596,
-41174,
-41147,
-40597,
-39652,
-38400,
-36935,
-35279,
-33500,
-31653,
-29887,
-28341,
-27226,
-26643,
-26700,
-27337,
-28473,
-29945,
-31601,
-33316,
-35008,
-36634,
-38169,
-39583,
-40815,
-41792,
-42427,
-42669,
-42518,
-42042,
-41392,
-40749,
-40313,
-40234,
-40598,
-41382,
-42510,
-43821,
-45167,
-46416,
-47466,
-48261,
-48750,
-48859,
-48503,
-47558,
-45934,
-43567,
-40529,
-36934,
-33045,
-29107,
-25391,
-22087,
-19319,
-17135,
-15552,
-14560,
-14163,
-14347,
-15077,
-16259,
-17735,
-19304,
-20740,
-21862,
-22567,
-22834,
-22763,
-22471,
-22134,
-21855,
-21728,
-21780,
-22012,
-22434,
-23056,
-23922,
-25079,
-26564,
-28362,
-30413,
-32567,
-34659,
-36479,
-37878,
-38734,
-39038,
-38811,
-38166,
-37174,
-35942,
-34492,
-32887,
-31153,
-29405,
-27763,
-26445,
-25613,
-25427,
-25922,
-27023,
-28581,
-30377,
-32235,
-34027,
-35713,
-37309,
-38839,
-40301,
-41620,
-42695,
-43390,
-43648,
-43479,
-43011,
-42446,
-42000,
-41857,
-42103,
-42732,
-43648,
-44726,
-45833,
-46887,
-47832,
-48640,
-49262,
-49618,
-49573,
-48978,
-47682,
-45606,
-42758,
-39259,
-35327,
-31247,
-27302,
-23742,
-20739,
-18372,
-16662,
-15570,
-15053,
-15067,
-15564,
-16498,
-17758,
-19227,
-20698,
-21999,
-22958,
-23493,
-23622,
-23433,
-23101,
-22778,
-22600,
-22629,
-22872,
-23315,
-23934,
-24762,
-25833,
-27219,
-28944,
-30964,
-33173,
-35368,
-37353,
-38917,
-39944,
-40385,
-40277,
-39713,
-38784,
-37595,
-36172,
-34595,
-32866,
-31084,
-29362,
-27848,
-26733,
-26152,
-26200,
-26873,
-28077,
-29658,
-31429,
-33243,
-34975,
-36604,
-38101,
-39495,
-40742,
-41793,
-42533,
-42884,
-42799,
-42343,
-41669,
-41005,
-40587,
-40591,
-41074,
-41992,
-43178,
-44466,
-45684,
-46752,
-47632,
-48339,
-48842,
-49070,
-48876,
-48051,
-46470,
-44000,
-40747,
-36858,
-32650,
-28445,
-24546,
-21183,
-18476,
-16470,
-15135,
-14429,
-14292,
-14682,
-15510,
-16711,
-18117,
-19593,
-20938,
-22016,
-22709,
-23011,
-22974,
-22730,
-22430,
-22226,
-22203,
-22417,
-22844,
-23452,
-24216,
-25142,
-26279,
-27696,
-29434,
-31471,
-33703,
-35936,
-37930,
-39461,
-40377,
-40612,
-40239,
-39355,
-38135,
-36686,
-35104,
-33434,
-31710,
-30015,
-28450,
-27183,
-26369,
-26135,
-26522,
-27485,
-28888,
-30575,
-32371,
-34173,
-35894,
-37525,
-39033,
-40388,
-41525,
-42346,
-42787,
-42800,
-42442,
-41829,
-41157,
-40638,
-40449,
-40704,
-41420,
-42513,
-43856,
-45264,
-46605,
-47747,
-48631,
-49189,
-49383,
-49121,
-48335,
-46899,
-44783,
-41968,
-38579,
-34794,
-30868,
-27073,
-23631,
-20723,
-18419,
-16762,
-15720,
-15287,
-15415,
-16068,
-17162,
-18574,
-20121,
-21602,
-22825,
-23649,
-24043,
-24045,
-23797,
-23448,
-23166,
-23032,
-23126,
-23415,
-23917,
-24605,
-25506,
-26651,
-28076,
-29780,
-31711,
-33766,
-35766,
-37560,
-38959,
-39875,
-40250,
-40113,
-39521,
-38566,
-37322,
-35858,
-34223,
-32480,
-30715,
-29051,
-27661,
-26687,
-26291,
-26501,
-27320,
-28609,
-30216,
-31959,
-33696,
-35359,
-36904,
-38353,
-39691,
-40874,
-41837,
-42471,
-42727,
-42596,
-42162,
-41587,
-41048,
-40749,
-40771,
-41189,
-41937,
-42942,
-44098,
-45310,
-46499,
-47601,
-48518,
-49151,
-49339,
-48948,
-47826,
-45917,
-43225,
-39868,
-36044,
-32006,
-28032,
-24359,
-21189,
-18626,
-16737,
-15502,
-14897,
-14858,
-15329,
-16231,
-17459,
-18878,
-20317,
-21599,
-22564,
-23125,
-23264,
-23082,
-22724,
-22360,
-22138,
-22127,
-22340,
-22744,
-23301,
-24017,
-24947,
-26175,
-27763,
-29726,
-31943,
-34248,
-36379,
-38124,
-39319,
-39920,
-39963,
-39549,
-38783,
-37720,
-36394,
-34808,
-32984,
-31043,
-29119,
-27465,
-26270,
-25712,
-25842,
-26610,
-27882,
-29481,
-31242,
-33044,
-34812,
-36518,
-38121,
-39580,
-40807,
-41726,
-42246,
-42357,
-42101,
-41600,
-41054,
-40640,
-40549,
-40861,
-41602,
-42683,
-43977,
-45324,
-46589,
-47667,
-48499,
-49029,
-49191,
-48883,
-47975,
-46325,
-43869,
-40607,
-36705,
-32429,
-28126,
-24153,
-20779,
-18188,
-16403,
-15392,
-15033,
-15232,
-15896,
-16932,
-18263,
-19732,
-21189,
-22438,
-23330,
-23805,
-23885,
-23706,
-23431,
-23228,
-23201,
-23394,
-23789,
-24372,
-25148,
-26168,
-27515,
-29230,
-31310,
-33628,
-35986,
-38127,
-39821,
-40909,
-41347,
-41168,
-40481,
-39395,
-37995,
-36359,
-34537,
-32627,
-30765,
-29133,
-27917,
-27289,
-27305,
-27960,
-29133,
-30660,
-32383,
-34158,
-35906,
-37580,
-39140,
-40552,
-41732,
-42612,
-43109,
-43213,
-42954,
-42470,
-41913,
-41480,
-41330,
-41546,
-42168,
-43121,
-44316,
-45619,
-46896,
-48061,
-48990,
-49628,
-49847,
-49554,
-48624,
-46948,
-44500,
-41294,
-37509,
-33360,
-29174,
-25253,
-21866,
-19198,
-17310,
-16203,
-15778,
-15952,
-16602,
-17641,
-18938,
-20369,
-21756,
-22936,
-23755,
-24138,
-24099,
-23754,
-23273,
-22856,
-22644,
-22728,
-23105,
-23764,
-24647,
-25783,
-27166,
-28846,
-30802,
-32944,
-35109,
-37061,
-38586,
-39512,
-39798,
-39475,
-38692,
-37564,
-36225,
-34715,
-33072,
-31320,
-29541,
-27881,
-26540,
-25708,
-25527,
-26016,
-27089,
-28572,
-30274,
-32021,
-33733,
-35360,
-36917,
-38370,
-39666,
-40697,
-41353,
-41572,
-41378,
-40887,
-40322,
-39879,
-39773,
-40082,
-40827,
-41911,
-43225,
-44608,
-45965,
-47167,
-48125,
-48733,
-48863,
-48408,
-47274,
-45426,
-42908,
-39826,
-36360,
-32704,
-29069,
-25644,
-22585,
-20038,
-18100,
-16852,
-16321,
-16483,
-17249,
-18471,
-19942,
-21453,
-22794,
-23817,
-24439,
-24658,
-24547,
-24218,
-23820,
-23466,
-23273,
-23288,
-23553,
-24084,
-24892,
-25997,
-27423,
-29145,
-31142,
-33281,
-35418,
-37346,
-38882,
-39875,
-40267,
-40076,
-39380,
-38302,
-36945,
-35391,
-33703,
-31928,
-30166,
-28531,
-27215,
-26366,
-26141,
-26561,
-27586,
-29064,
-30816,
-32678,
-34508,
-36267,
-37897,
-39395,
-40689,
-41698,
-42334,
-42522,
-42309,
-41789,
-41185,
-40703,
-40544,
-40807,
-41486,
-42501,
-43703,
-44984,
-46226,
-47373,
-48346,
-49047,
-49332,
-49017,
-47939,
-45997,
-43204,
-39695,
-35717,
-31565,
-27524,
-23838,
-20652,
-18073,
-16133,
-14870,
-14286,
-14373,
-15070,
-16254,
-17743,
-19313,
-20737,
-21853,
-22559,
-22872,
-22872,
-22690,
-22464,
-22292,
-22249,
-22361,
-22647,
-23135,
-23853,
-24868,
-26216,
-27917,
-29926,
-32124,
-34345,
-36376,
-38025,
-39137,
-39640,
-39524,
-38876,
-37770,
-36351,
-34682,
-32872,
-30992,
-29160,
-27507,
-26209,
-25413,
-25251,
-25741,
-26836,
-28376,
-30192,
-32096,
-33968,
-35738,
-37385,
-38893,
-40220,
-41278,
-41967,
-42200,
-41980,
-41402,
-40673,
-40050,
-39759,
-39959,
-40658,
-41773,
-43128,
-44549,
-45895,
-47078,
-48047,
-48739,
-49044,
-48812,
-47860,
-46062,
-43372,
-39915,
-35922,
-31725,
-27667,
-24013,
-20949,
-18542,
-16787,
-15661,
-15136,
-15198,
-15808,
-16902,
-18322,
-19876,
-21329,
-22477,
-23215,
-23516,
-23495,
-23289,
-23072,
-22975,
-23047,
-23318,
-23743,
-24325,
-25069,
-26023,
-27250,
-28777,
-30603,
-32634,
-34727,
-36691,
-38339,
-39508,
-40117,
-40126,
-39586,
-38577,
-37207,
-35577,
-33808,
-31985,
-30229,
-28661,
-27407,
-26608,
-26352,
-26700,
-27617,
-29026,
-30756,
-32673,
-34588,
-36434,
-38100,
-39585,
-40831,
-41808,
-42460,
-42732,
-42634,
-42226,
-41660,
-41148,
-40882,
-41038,
-41646,
-42662,
-43926,
-45267,
-46525,
-47600,
-48441,
-49022,
-49273,
-49092,
-48299,
-46744,
-44314,
-41059,
-37146,
-32918,
-28712,
-24910,
-21714,
-19253,
-17507,
-16404,
-15863,
-15831,
-16283,
-17176,
-18448,
-19929,
-21432,
-22721,
-23637,
-24098,
-24154,
-23948,
-23643,
-23428,
-23372,
-23543,
-23906,
-24461,
-25221,
-26223,
-27542,
-29199,
-31174,
-33349,
-35547,
-37556,
-39178,
-40273,
-40787,
-40712,
-40126,
-39084,
-37685,
-36002,
-34133,
-32191,
-30325,
-28690,
-27456,
-26731,
-26601,
-27040,
-28006,
-29358,
-30984,
-32750,
-34547,
-36311,
-37957,
-39445,
-40699,
-41647,
-42242,
-42438,
-42280,
-41858,
-41325,
-40895,
-40727,
-40971,
-41650,
-42708,
-44010,
-45386,
-46672,
-47783,
-48621,
-49191,
-49406,
-49194,
-48400,
-46875,
-44506,
-41294,
-37384,
-33052,
-28675,
-24606,
-21151,
-18455,
-16562,
-15401,
-14878,
-14902,
-15419,
-16368,
-17681,
-19215,
-20769,
-22124,
-23082,
-23547,
-23557,
-23248,
-22835,
-22520,
-22433,
-22631,
-23082,
-23761,
-24629,
-25737,
-27121,
-28844,
-30875,
-33117,
-35367,
-37396,
-39000,
-40035,
-40486,
-40383,
-39827,
-38898,
-37651,
-36111,
-34322,
-32352,
-30376,
-28577,
-27203,
-26416,
-26323,
-26888,
-28004,
-29484,
-31175,
-32929,
-34692,
-36413,
-38080,
-39631,
-40995,
-42056,
-42734,
-42981,
-42840,
-42423,
-41916,
-41493,
-41341,
-41540,
-42136,
-43053,
-44224,
-45493,
-46779,
-47953,
-48944,
-49657,
-49991,
-49835,
-49045,
-47533,
-45212,
-42142,
-38441,
-34352,
-30186,
-26245,
-22807,
-20053,
-18060,
-16821,
-16276,
-16333,
-16903,
-17901,
-19207,
-20686,
-22153,
-23411,
-24304,
-24734,
-24725,
-24401,
-23947,
-23570,
-23410,
-23544,
-23957,
-24614,
-25469,
-26532,
-27843,
-29451,
-31362,
-33495,
-35674,
-37667,
-39245,
-40239,
-40614,
-40404,
-39758,
-38786,
-37592,
-36199,
-34612,
-32849,
-30990,
-29214,
-27735,
-26793,
-26529,
-26986,
-28053,
-29554,
-31256,
-32994,
-34665,
-36231,
-37722,
-39109,
-40361,
-41365,
-42015,
-42231,
-42034,
-41525,
-40909,
-40408,
-40207,
-40425,
-41053,
-42020,
-43180,
-44405,
-45569,
-46602,
-47436,
-48007,
-48231,
-47982,
-47140,
-45585,
-43274,
-40228,
-36595,
-32572,
-28456,
-24517,
-21017,
-18147,
-16007,
-14625,
-13966,
-13927,
-14423,
-15305,
-16466,
-17751,
-19011,
-20117,
-20918,
-21381,
-21479,
-21309,
-21010,
-20733,
-20635,
-20795,
-21249,
-21980,
-22959,
-24168,
-25631,
-27362,
-29385,
-31616,
-33942,
-36113,
-37922,
-39142,
-39683,
-39556,
-38882,
-37827,
-36559,
-35162,
-33694,
-32151,
-30569,
-29045,
-27733,
-26851,
-26563,
-26967,
-28019,
-29577,
-31414,
-33342,
-35187,
-36911,
-38483,
-39918,
-41180,
-42183,
-42822,
-43011,
-42751,
-42155,
-41427,
-40816,
-40538,
-40705,
-41330,
-42296,
-43483,
-44732,
-45963,
-47108,
-48097,
-48842,
-49183,
-48926,
-47905,
-46000,
-43257,
-39808,
-35930,
-31901,
-27999,
-24412,
-21276,
-18637,
-16574,
-15115,
-14338,
-14264,
-14861,
-16019,
-17508,
-19095,
-20526,
-21630,
-22345,
-22696,
-22784,
-22730,
-22641,
-22555,
-22547,
-22605,
-22821,
-23263,
-24032,
-25216,
-26817,
-28796,
-30996,
-33253,
-35357,
-37157,
-38526,
-39410,
-39772,
-39614,
-38933,
-37764,
-36164,
-34242,
-32175,
-30159,
-28424,
-27145,
-26454,
-26380,
-26907,
-27926,
-29341,
-31026,
-32878,
-34800,
-36686,
-38427,
-39919,
-41050,
-41777,
-42076,
-42022,
-41722,
-41326,
-40991,
-40834,
-40953,
-41368,
-42093,
-43082,
-44273,
-45586,
-46880,
-48018,
-48801,
-49049,
-48590,
-47305,
-45166,
-42223,
-38634,
-34609,
-30407,
-26304,
-22531,
-19324,
-16813,
-15118,
-14252,
-14176,
-14780,
-15893,
-17321,
-18841,
-20277,
-21467,
-22345,
-22872,
-23101,
-23087,
-22938,
-22745,
-22606,
-22619,
-22858,
-23393,
-24287,
-25548,
-27185,
-29131,
-31283,
-33518,
-35641,
-37515,
-38948,
-39853,
-40133,
-39798,
-38880,
-37475,
-35720,
-33757,
-31772,
-29915,
-28355,
-27223,
-26614,
-26584,
-27127,
-28184,
-29670,
-31437,
-33365,
-35305,
-37148,
-38805,
-40188,
-41261,
-41976,
-42339,
-42377,
-42159,
-41810,
-41472,
-41299,
-41419,
-41912,
-42773,
-43963,
-45327,
-46751,
-48038,
-49062,
-49662,
-49740,
-49171,
-47897,
-45866,
-43095,
-39690,
-35804,
-31702,
-27652,
-23943,
-20818,
-18438,
-16874,
-16118,
-16071,
-16606,
-17566,
-18766,
-20070,
-21306,
-22374,
-23164,
-23659,
-23846,
-23810,
-23641,
-23463,
-23401,
-23547,
-23974,
-24713,
-25776,
-27146,
-28798,
-30670,
-32700,
-34759,
-36727,
-38436,
-39747,
-40535,
-40740,
-40343,
-39407,
-38019,
-36308,
-34415,
-32483,
-30673,
-29119,
-27980,
-27362,
-27337,
-27928,
-29057,
-30626,
-32459,
-34400,
-36297,
-38044,
-39568,
-40826,
-41785,
-42427,
-42726,
-42712,
-42430,
-42009,
-41592,
-41365,
-41456,
-41957,
-42851,
-44059,
-45439,
-46832,
-48085,
-49067,
-49655,
-49739,
-49188,
-47893,
-45771,
-42828,
-39162,
-35010,
-30668,
-26498,
-22803,
-19826,
-17671,
-16366,
-15823,
-15950,
-16602,
-17655,
-18965,
-20374,
-21719,
-22828,
-23598,
-23954,
-23958,
-23697,
-23347,
-23049,
-22928,
-23042,
-23413,
-24040,
-24937,
-26119,
-27629,
-29461,
-31562,
-33800,
-35959,
-37821,
-39162,
-39857,
-39859,
-39230,
-38082,
-36560,
-34803,
-32923,
-31048,
-29286,
-27784,
-26695,
-26144,
-26225,
-26932,
-28187,
-29843,
-31722,
-33667,
-35545,
-37295,
-38854,
-40202,
-41266,
-42011,
-42372,
-42372,
-42068,
-41617,
-41210,
-41041,
-41256,
-41911,
-42954,
-44283,
-45714,
-47104,
-48293,
-49167,
-49611,
-49518,
-48759,
-47246,
-44914,
-41810,
-38063,
-33919,
-29675,
-25638,
-22072,
-19154,
-16978,
-15555,
-14861,
-14827,
-15385,
-16424,
-17791,
-19314,
-20763,
-21957,
-22751,
-23102,
-23075,
-22807,
-22486,
-22280,
-22300,
-22616,
-23215,
-24103,
-25269,
-26719,
-28470,
-30489,
-32698,
-34946,
-37036,
-38759,
-39948,
-40507,
-40432,
-39780,
-38657,
-37179,
-35438,
-33558,
-31642,
-29839,
-28334,
-27277,
-26837,
-27058,
-27929,
-29326,
-31077,
-32998,
-34927,
-36762,
-38423,
-39882,
-41078,
-41976,
-42512,
-42678,
-42502,
-42105,
-41651,
-41335,
-41319,
-41688,
-42450,
-43512,
-44757,
-46034,
-47238,
-48270,
-49058,
-49505,
-49500,
-48888,
-47553,
-45383,
-42425,
-38769,
-34692,
-30467,
-26440,
-22882,
-20007,
-17921,
-16662,
-16179,
-16386,
-17153,
-18308,
-19669,
-21026,
-22216,
-23079,
-23582,
-23724,
-23603,
-23359,
-23104,
-22964,
-22984,
-23214,
-23659,
-24364,
-25352,
-26676,
-28338,
-30290,
-32424,
-34542,
-36461,
-37969,
-38944,
-39331,
-39126,
-38420,
-37269,
-35793,
-34062,
-32198,
-30327,
-28606,
-27227,
-26325,
-26021,
-26320,
-27169,
-28443,
-29989,
-31689,
-33431,
-35169,
-36835,
-38375,
-39692,
-40692,
-41277,
-41428,
-41194,
-40714,
-40196,
-39825,
-39784,
-40132,
-40878,
-41925,
-43178,
-44493,
-45765,
-46876,
-47694,
-48078,
-47868,
-46910,
-45120,
-42493,
-39141,
-35274,
-31177,
-27142,
-23438,
-20276,
-17777,
-16022,
-15007,
-14724,
-15076,
-15982,
-17255,
-18726,
-20184,
-21443,
-22390,
-22969,
-23220,
-23237,
-23144,
-23070,
-23107,
-23332,
-23773,
-24473,
-25458,
-26745,
-28358,
-30261,
-32386,
-34612,
-36766,
-38677,
-40166,
-41119,
-41450,
-41157,
-40281,
-38893,
-37137,
-35120,
-33030,
-31016,
-29245,
-27875,
-27007,
-26712,
-27005,
-27837,
-29133,
-30780,
-32651,
-34624,
-36558,
-38346,
-39856,
-41025,
-41771,
-42116,
-42093,
-41822,
-41442,
-41101,
-40950,
-41070,
-41519,
-42282,
-43315,
-44531,
-45844,
-47127,
-48264,
-49105,
-49503,
-49305,
-48391,
-46686,
-44186,
-40984,
-37221,
-33143,
-28987,
-25032,
-21521,
-18653,
-16574,
-15347,
-14972,
-15337,
-16307,
-17637,
-19121,
-20522,
-21687,
-22506,
-22974,
-23121,
-23057,
-22874,
-22683,
-22571,
-22604,
-22849,
-23360,
-24187,
-25365,
-26905,
-28765,
-30854,
-33054,
-35175,
-37075,
-38575,
-39569,
-39971,
-39766,
-38964,
-37655,
-35927,
-33946,
-31885,
-29927,
-28265,
-27042,
-26367,
-26272,
-26758,
-27729,
-29114,
-30781,
-32622,
-34535,
-36409,
-38151,
-39660,
-40860,
-41674,
-42097,
-42141,
-41890,
-41475,
-41032,
-40730,
-40689,
-40993,
-41682,
-42716,
-44021,
-45472,
-46900,
-48131,
-48978,
-49267,
-48853,
-47658,
-45638,
-42872,
-39459,
-35608,
-31542,
-27510,
-23767,
-20508,
-17926,
-16096,
-15084,
-14829,
-15255,
-16204,
-17495,
-18944,
-20362,
-21603,
-22575,
-23209,
-23529,
-23567,
-23419,
-23187,
-22997,
-22961,
-23193,
-23768,
-24731,
-26087,
-27787,
-29757,
-31876,
-34013,
-36026,
-37778,
-39145,
-40031,
-40362,
-40110,
-39300,
-37974,
-36272,
-34312,
-32299,
-30395,
-28777,
-27581,
-26891,
-26765,
-27184,
-28114,
-29471,
-31151,
-33045,
-35013,
-36936,
-38689,
-40156,
-41268,
-41960,
-42242,
-42165,
-41824,
-41373,
-40971,
-40772,
-40910,
-41426,
-42332,
-43534,
-44908,
-46304,
-47549,
-48527,
-49098,
-49179,
-48688,
-47539,
-45705,
-43145,
-39933,
-36180,
-32111,
-28001,
-24153,
-20863,
-18337,
-16694,
-15944,
-15973,
-16634,
-17704,
-19001,
-20319,
-21541,
-22524,
-23234,
-23622,
-23730,
-23604,
-23358,
-23098,
-22955,
-23025,
-23384,
-24069,
-25079,
-26403,
-27995,
-29818,
-31798,
-33854,
-35858,
-37672,
-39133,
-40085,
-40436,
-40106,
-39154,
-37649,
-35771,
-33705,
-31647,
-29794,
-28291,
-27256,
-26761,
-26823,
-27421,
-28499,
-29950,
-31661,
-33508,
-35353,
-37104,
-38654,
-39945,
-40929,
-41570,
-41887,
-41883,
-41662,
-41295,
-40944,
-40742,
-40808,
-41237,
-42023,
-43130,
-44432,
-45793,
-47036,
-48018,
-48575,
-48607,
-47981,
-46642,
-44533,
-41687,
-38201,
-34257,
-30117,
-26067,
-22400,
-19345,
-17046,
-15564,
-14850,
-14823,
-15340,
-16271,
-17478,
-18813,
-20146,
-21332,
-22245,
-22817,
-23009,
-22885,
-22562,
-22193,
-21954,
-21986,
-22370,
-23163,
-24332,
-25861,
-27684,
-29731,
-31924,
-34126,
-36200,
-37953,
-39216,
-39838,
-39748,
-38964,
-37577,
-35769,
-33739,
-31691,
-29817,
-28250,
-27106,
-26453,
-26342,
-26787,
-27776,
-29240,
-31077,
-33140,
-35257,
-37265,
-39007,
-40387,
-41342,
-41874,
-42019,
-41875,
-41546,
-41191,
-40942,
-40946,
-41299,
-42035,
-43143,
-44504,
-45980,
-47381,
-48502,
-49196,
-49283,
-48694,
-47333,
-45201,
-42309,
-38764,
-34728,
-30449,
-26227,
-22383,
-19205,
-16908,
-15578,
-15185,
-15583,
-16554,
-17856,
-19273,
-20620,
-21793,
-22711,
-23357,
-23725,
-23843,
-23765,
-23585,
-23415,
-23401,
-23669,
-24331,
-25430,
-26974,
-28877,
-31033,
-33295,
-35494,
-37488,
-39126,
-40274,
-40857,
-40784,
-40088,
-38789,
-37041,
-35001,
-32895,
-30942,
-29333,
-28221,
-27690,
-27758,
-28401,
-29528,
-31056,
-32842,
-34780,
-36720,
-38542,
-40119,
-41367,
-42211,
-42657,
-42729,
-42525,
-42178,
-41816,
-41604,
-41641,
-42015,
-42745,
-43793,
-45087,
-46481,
-47834,
-48951,
-49653,
-49776,
-49162,
-47740,
-45476,
-42432,
-38756,
-34665,
-30439,
-26376,
-22768,
-19838,
-17755,
-16560,
-16218,
-16601,
-17519,
-18761,
-20114,
-21384,
-22446,
-23199,
-23636,
-23762,
-23667,
-23431,
-23184,
-23037,
-23106,
-23483,
-24225,
-25369,
-26886,
-28730,
-30798,
-32959,
-35061,
-36942,
-38449,
-39449,
-39850,
-39612,
-38745,
-37340,
-35507,
-33447,
-31333,
-29396,
-27786,
-26673,
-26116,
-26164,
-26772,
-27882,
-29379,
-31148,
-33054,
-34966,
-36754,
-38306,
-39530,
-40362,
-40798,
-40856,
-40651,
-40284,
-39932,
-39735,
-39823,
-40281,
-41128,
-42314,
-43741,
-45252,
-46656,
-47776,
-48414,
-48429,
-47710,
-46205,
-43933,
-40955,
-37425,
-33516,
-29482,
-25564,
-22042,
-19127,
-17030,
-15809,
-15508,
-15985,
-17095,
-18569,
-20180,
-21678,
-22910,
-23776,
-24264,
-24437,
-24392,
-24245,
-24133,
-24132,
-24350,
-24824,
-25602,
-26696,
-28095,
-29763,
-31632,
-33593,
-35517,
-37252,
-38646,
-39587,
-39969,
-39775,
-39013,
-37762,
-36133,
-34282,
-32359,
-30550,
-28990,
-27837,
-27174,
-27078,
-27558,
-28568,
-30045,
-31847,
-33840,
-35864,
-37760,
-39403,
-40685,
-41554,
-41998,
-42068,
-41860,
-41509,
-41173,
-41004,
-41120,
-41603,
-42449,
-43612,
-44976,
-46397,
-47704,
-48737,
-49319,
-49325,
-48618,
-47131,
-44824,
-41751,
-38022,
-33853,
-29512,
-25316,
-21569,
-18537,
-16384,
-15183,
-14884,
-15347,
-16365,
-17711,
-19149,
-20497,
-21610,
-22412,
-22885,
-23058,
-23005,
-22820,
-22623,
-22521,
-22633,
-23034,
-23807,
-24963,
-26502,
-28365,
-30452,
-32639,
-34772,
-36686,
-38241,
-39299,
-39785,
-39636,
-38884,
-37567,
-35816,
-33791,
-31668,
-29685,
-28012,
-26828,
-26242,
-26293,
-26965,
-28175,
-29807,
-31710,
-33749,
-35760,
-37624,
-39216,
-40449,
-41270,
-41676,
-41703,
-41458,
-41071,
-40689,
-40482,
-40545,
-40976,
-41774,
-42915,
-44290,
-45779,
-47195,
-48358,
-49061,
-49126,
-48402,
-46801,
-44327,
-41054,
-37170,
-32922,
-28602,
-24535,
-20982,
-18175,
-16244,
-15226,
-15062,
-15616,
-16679,
-18041,
-19472,
-20792,
-21872,
-22629,
-23062,
-23206,
-23139,
-22961,
-22779,
-22702,
-22836,
-23262,
-24048,
-25224,
-26784,
-28678,
-30807,
-33034,
-35196,
-37117,
-38629,
-39598,
-39937,
-39618,
-38684,
-37238,
-35432,
-33454,
-31507,
-29758,
-28386,
-27470,
-27097,
-27268,
-27949,
-29095,
-30590,
-32353,
-34230,
-36118,
-37871,
-39382,
-40572,
-41371,
-41796,
-41868,
-41694,
-41386,
-41099,
-40973,
-41131,
-41647,
-42533,
-43749,
-45168,
-46648,
-47982,
-48992,
-49477,
-49309,
-48362,
-46610,
-44062,
-40823,
-37055,
-32996,
-28908,
-25079,
-21766,
-19165,
-17393,
-16471,
-16319,
-16819,
-17771,
-18993,
-20289,
-21507,
-22516,
-23245,
-23653,
-23764,
-23645,
-23405,
-23165,
-23081,
-23257,
-23789,
-24721,
-26033,
-27688,
-29597,
-31649,
-33733,
-35707,
-37439,
-38796,
-39665,
-39959,
-39653,
-38771,
-37398,
-35684,
-33785,
-31899,
-30185,
-28793,
-27834,
-27366,
-27444,
-28041,
-29140,
-30649,
-32468,
-34448,
-36442,
-38283,
-39851,
-41033,
-41806,
-42170,
-42206,
-42016,
-41741,
-41514,
-41462,
-41679,
-42206,
-43065,
-44178,
-45482,
-46812,
-48031,
-48947,
-49407,
-49253,
-48382,
-46740,
-44321,
-41220,
-37556,
-33557,
-29447,
-25517,
-22011,
-19164,
-17121,
-15956,
-15640,
-16056,
-17030,
-18330,
-19737,
-21049,
-22111,
-22846,
-23220,
-23287,
-23123,
-22850,
-22604,
-22491,
-22648,
-23124,
-23994,
-25239,
-26853,
-28750,
-30852,
-33022,
-35127,
-37015,
-38529,
-39545,
-39957,
-39716,
-38847,
-37424,
-35591,
-33547,
-31483,
-29612,
-28094,
-27054,
-26555,
-26631,
-27252,
-28372,
-29920,
-31779,
-33841,
-35938,
-37933,
-39658,
-41008,
-41893,
-42321,
-42336,
-42071,
-41674,
-41318,
-41160,
-41299,
-41806,
-42661,
-43818,
-45162,
-46557,
-47842,
-48837,
-49374,
-49286,
-48437,
-46754,
-44216,
-40903,
-36988,
-32711,
-28393,
-24342,
-20864,
-18171,
-16389,
-15529,
-15500,
-16138,
-17241,
-18588,
-20003,
-21317,
-22436,
-23279,
-23832,
-24101,
-24133,
-24008,
-23825,
-23706,
-23772,
-24129,
-24857,
-25989,
-27522,
-29391,
-31509,
-33726,
-35900,
-37845,
-39410,
-40432,
-40835,
-40542,
-39617,
-38115,
-36230,
-34133,
-32055,
-30192,
-28724,
-27758,
-27383,
-27592,
-28367,
-29626,
-31270,
-33166,
-35179,
-37160,
-38964,
-40485,
-41626,
-42352,
-42671,
-42644,
-42366,
-41988,
-41642,
-41485,
-41630,
-42142,
-43047,
-44269,
-45713,
-47191,
-48509,
-49468,
-49860,
-49560,
-48461,
-46548,
-43860,
-40521,
-36688,
-32609,
-28517,
-24697,
-21386,
-18791,
-17032,
-16145,
-16067,
-16657,
-17717,
-19030,
-20381,
-21612,
-22589,
-23271,
-23620,
-23695,
-23534,
-23250,
-22951,
-22757,
-22812,
-23204,
-24023,
-25275,
-26937,
-28901,
-31051,
-33220,
-35250,
-37001,
-38331,
-39158,
-39397,
-39030,
-38065,
-36575,
-34683,
-32564,
-30428,
-28475,
-26921,
-25874,
-25450,
-25639,
-26411,
-27682,
-29329,
-31243,
-33257,
-35258,
-37075,
-38603,
-39732,
-40414,
-40661,
-40552,
-40214,
-39812,
-39520,
-39462,
-39755,
-40400,
-41396,
-42637,
-44023,
-45397,
-46604,
-47490,
-47881,
-47660,
-46700,
-44972,
-42467,
-39296,
-35605,
-31625,
-27620,
-23846,
-20566,
-17963,
-16172,
-15243,
-15134,
-15739,
-16875,
-18333,
-19887,
-21333,
-22519,
-23346,
-23809,
-23942,
-23863,
-23684,
-23550,
-23574,
-23849,
-24438,
-25371,
-26638,
-28218,
-30033,
-31994,
-33981,
-35844,
-37452,
-38660,
-39374,
-39527,
-39108,
-38151,
-36744,
-34999,
-33082,
-31141,
-29372,
-27911,
-26910,
-26450,
-26574,
-27276,
-28483,
-30104,
-31999,
-34034,
-36046,
-37910,
-39478,
-40667,
-41417,
-41711,
-41636,
-41290,
-40861,
-40529,
-40469,
-40795,
-41562,
-42713,
-44145,
-45670,
-47093,
-48204,
-48812,
-48773,
-47958,
-46318,
-43850,
-40621,
-36800,
-32603,
-28332,
-24292,
-20789,
-18052,
-16233,
-15347,
-15333,
-16004,
-17144,
-18520,
-19887,
-21093,
-21994,
-22546,
-22761,
-22696,
-22471,
-22212,
-22068,
-22168,
-22618,
-23480,
-24774,
-26468,
-28482,
-30707,
-32987,
-35173,
-37078,
-38554,
-39464,
-39717,
-39299,
-38235,
-36647,
-34691,
-32581,
-30528,
-28752,
-27415,
-26651,
-26519,
-27012,
-28082,
-29610,
-31462,
-33478,
-35505,
-37384,
-39008,
-40271,
-41131,
-41583,
-41668,
-41482,
-41154,
-40847,
-40717,
-40904,
-41490,
-42490,
-43833,
-45379,
-46926,
-48240,
-49108,
-49312,
-48736,
-47282,
-44964,
-41866,
-38123,
-33992,
-29705,
-25597,
-21929,
-18968,
-16875,
-15718,
-15461,
-15969,
-17032,
-18414,
-19876,
-21208,
-22293,
-23021,
-23425,
-23519,
-23419,
-23229,
-23085,
-23100,
-23386,
-24017,
-25033,
-26438,
-28192,
-30214,
-32380,
-34547,
-36525,
-38153,
-39264,
-39737,
-39519,
-38629,
-37159,
-35284,
-33206,
-31159,
-29358,
-27983,
-27160,
-26953,
-27365,
-28353,
-29816,
-31640,
-33658,
-35724,
-37666,
-39351,
-40670,
-41555,
-42021,
-42105,
-41927,
-41626,
-41353,
-41270,
-41478,
-42044,
-42974,
-44189,
-45582,
-46979,
-48195,
-49051,
-49361,
-49005,
-47873,
-45939,
-43221,
-39829,
-35923,
-31763,
-27630,
-23832,
-20668,
-18334,
-16961,
-16530,
-16918,
-17920,
-19260,
-20704,
-22008,
-23057,
-23755,
-24122,
-24210,
-24106,
-23928,
-23788,
-23792,
-24048,
-24630,
-25597,
-26961,
-28694,
-30720,
-32902,
-35104,
-37118,
-38793,
-39959,
-40507,
-40388,
-39608,
-38250,
-36460,
-34419,
-32342,
-30443,
-28897,
-27864,
-27414,
-27587,
-28348,
-29618,
-31283,
-33203,
-35220,
-37183,
-38945,
-40390,
-41445,
-42079,
-42312,
-42237,
-41957,
-41639,
-41427,
-41461,
-41838,
-42599,
-43715,
-45092,
-46577,
-47967,
-49048,
-49599,
-49443,
-48442,
-46552,
-43794,
-40301,
-36274,
-31980,
-27733,
-23840,
-20569,
-18131,
-16617,
-16030,
-16257,
-17109,
-18342,
-19725,
-21026,
-22106,
-22862,
-23286,
-23411,
-23318,
-23113,
-22910,
-22826,
-22969,
-23434,
-24284,
-25563,
-27241,
-29271,
-31502,
-33806,
-35948,
-37770,
-39079,
-39752,
-39741,
-39036,
-37742,
-35987,
-33972,
-31902,
-29985,
-28406,
-27306,
-26768,
-26834,
-27478,
-28645,
-30236,
-32129,
-34180,
-36233,
-38138,
-39742,
-40952,
-41692,
-41988,
-41900,
-41582,
-41188,
-40912,
-40887,
-41232,
-41962,
-43052,
-44409,
-45873,
-47299,
-48460,
-49195,
-49284,
-48599,
-47021,
-44538,
-41220,
-37245,
-32878,
-28445,
-24290,
-20716,
-17966,
-16165,
-15326,
-15362,
-16091,
-17290,
-18723,
-20156,
-21417,
-22372,
-22966,
-23209,
-23159,
-22938,
-22677,
-22529,
-22634,
-23092,
-23988,
-25318,
-27069,
-29137,
-31409,
-33713,
-35882,
-37732,
-39113,
-39902,
-40030,
-39495,
-38355,
-36730,
-34802,
-32760,
-30820,
-29169,
-27963,
-27302,
-27233,
-27740,
-28773,
-30236,
-32009,
-33971,
-35962,
-37863,
-39522,
-40842,
-41739,
-42202,
-42262,
-42035,
-41660,
-41329,
-41201,
-41416,
-42036,
-43058,
-44396,
-45909,
-47399,
-48664,
-49484,
-49676,
-49081,
-47615,
-45248,
-42077,
-38244,
-34018,
-29702,
-25618,
-22079,
-19316,
-17462,
-16551,
-16485,
-17113,
-18197,
-19521,
-20852,
-22035,
-22939,
-23523,
-23781,
-23776,
-23588,
-23340,
-23159,
-23156,
-23459,
-24124,
-25207,
-26696,
-28524,
-30613,
-32790,
-34923,
-36807,
-38302,
-39265,
-39610,
-39309,
-38383,
-36932,
-35089,
-33039,
-30988,
-29136,
-27680,
-26756,
-26461,
-26818,
-27777,
-29248,
-31072,
-33090,
-35120,
-37002,
-38600,
-39829,
-40629,
-41019,
-41044,
-40809,
-40454,
-40133,
-39990,
-40160,
-40698,
-41625,
-42872,
-44308,
-45783,
-47062,
-47981,
-48302,
-47906,
-46647,
-44513,
-41525,
-37832,
-33643,
-29250,
-24980,
-21147,
-18021,
-15776,
-14474,
-14083,
-14443,
-15376,
-16646,
-18039,
-19399,
-20562,
-21487,
-22105,
-22458,
-22577,
-22553,
-22496,
-22526,
-22770,
-23343,
-24311,
-25719,
-27523,
-29659,
-31978,
-34328,
-36499,
-38324,
-39611,
-40270,
-40210,
-39481,
-38144,
-36382,
-34386,
-32383,
-30595,
-29191,
-28308,
-28008,
-28290,
-29112,
-30384,
-31990,
-33808,
-35699,
-37530,
-39174,
-40514,
-41481,
-42019,
-42165,
-41976,
-41598,
-41192,
-40942,
-41000,
-41465,
-42358,
-43620,
-45108,
-46638,
-47987,
-48945,
-49330,
-48994,
-47861,
-45893,
-43137,
-39701,
-35761,
-31563,
-27391,
-23539,
-20290,
-17841,
-16310,
-15695,
-15886,
-16703,
-17909,
-19266,
-20572,
-21662,
-22453,
-22909,
-23063,
-22982,
-22771,
-22556,
-22464,
-22636,
-23155,
-24120,
-25525,
-27355,
-29518,
-31866,
-34235,
-36437,
-38266,
-39594,
-40262,
-40250,
-39537,
-38214,
-36417,
-34326,
-32166,
-30148,
-28477,
-27305,
-26750,
-26835,
-27560,
-28826,
-30524,
-32492,
-34562,
-36569,
-38360,
-39818,
-40864,
-41484,
-41688,
-41589,
-41285,
-40949,
-40738,
-40786,
-41199,
-42010,
-43186,
-44621,
-46160,
-47593,
-48717,
-49322,
-49245,
-48360,
-46622,
-44027,
-40690,
-36754,
-32477,
-28125,
-24021,
-20451,
-17662,
-15803,
-14918,
-14932,
-15673,
-16902,
-18363,
-19816,
-21071,
-22026,
-22629,
-22912,
-22942,
-22825,
-22666,
-22606,
-22728,
-23159,
-23952,
-25150,
-26745,
-28668,
-30820,
-33045,
-35182,
-37039,
-38476,
-39340,
-39573,
-39140,
-38096,
-36539,
-34648,
-32604,
-30642,
-28948,
-27694,
-26991,
-26884,
-27380,
-28404,
-29889,
-31690,
-33701,
-35745,
-37691,
-39382,
-40695,
-41568,
-41972,
-41988,
-41725,
-41372,
-41094,
-41065,
-41379,
-42077,
-43116,
-44409,
-45804,
-47146,
-48256,
-48959,
-49098,
-48533,
-47168,
-44963,
-41976,
-38319,
-34238,
-30000,
-25936,
-22351,
-19495,
-17530,
-16506,
-16361,
-16945,
-18030,
-19382,
-20757,
-21966,
-22886,
-23448,
-23674,
-23633,
-23429,
-23202,
-23074,
-23165,
-23570,
-24345,
-25522,
-27085,
-28982,
-31119,
-33354,
-35532,
-37463,
-38974,
-39924,
-40204,
-39805,
-38765,
-37208,
-35310,
-33270,
-31296,
-29584,
-28262,
-27461,
-27213,
-27543,
-28418,
-29763,
-31486,
-33439,
-35481,
-37419,
-39125,
-40440,
-41325,
-41745,
-41792,
-41563,
-41239,
-40971,
-40911,
-41167,
-41772,
-42731,
-43953,
-45335,
-46708,
-47898,
-48716,
-48976,
-48540,
-47288,
-45202,
-42305,
-38739,
-34696,
-30453,
-26313,
-22574,
-19513,
-17308,
-16047,
-15708,
-16139,
-17143,
-18455,
-19837,
-21097,
-22101,
-22798,
-23204,
-23348,
-23336,
-23210,
-23095,
-23069,
-23253,
-23752,
-24657,
-26016,
-27804,
-29940,
-32236,
-34521,
-36544,
-38159,
-39206,
-39633,
-39418,
-38605,
-37265,
-35520,
-33501,
-31402,
-29401,
-27713,
-26479,
-25823,
-25762,
-26270,
-27247,
-28585,
-30163,
-31890,
-33684,
-35466,
-37159,
-38650,
-39848,
-40660,
-41052,
-41054,
-40762,
-40334,
-39929,
-39706,
-39752,
-40123,
-40785,
-41714,
-42801,
-44018,
-45236,
-46401,
-47367,
-48006,
-48164,
-47673,
-46450,
-44406,
-41626,
-38199,
-34352,
-30331,
-26397,
-22800,
-19728,
-17316,
-15622,
-14654,
-14367,
-14684,
-15503,
-16696,
-18107,
-19576,
-20924,
-22009,
-22732,
-23060,
-23055,
-22827,
-22534,
-22327,
-22301,
-22516,
-22961,
-23620,
-24476,
-25547,
-26875,
-28501,
-30415,
-32549,
-34720,
-36732,
-38327,
-39357,
-39715,
-39444,
-38631,
-37430,
-35966,
-34348,
-32647,
-30937,
-29318,
-27924,
-26912,
-26420,
-26525,
-27211,
-28369,
-29846,
-31462,
-33112,
-34722,
-36291,
-37812,
-39247,
-40515,
-41489,
-42055,
-42175,
-41888,
-41382,
-40859,
-40570,
-40657,
-41177,
-42062,
-43186,
-44395,
-45576,
-46657,
-47603,
-48375,
-48896,
-49029,
-48618,
-47488,
-45567,
-42845,
-39478,
-35665,
-31719,
-27883,
-24423,
-21482,
-19166,
-17521,
-16535,
-16198,
-16433,
-17163,
-18260,
-19561,
-20906,
-22118,
-23077,
-23707,
-23990,
-23988,
-23787,
-23513,
-23290,
-23210,
-23353,
-23751,
-24421,
-25368,
-26588,
-28072,
-29803,
-31715,
-33724,
-35686,
-37427,
-38800,
-39649,
-39932,
-39639,
-38852,
-37674,
-36219,
-34579,
-32849,
-31087,
-29416,
-27949,
-26855,
-26272,
-26301,
-26951,
-28129,
-29683,
-31406,
-33145,
-34782,
-36287,
-37654,
-38898,
-39965,
-40800,
-41286,
-41385,
-41093,
-40549,
-39948,
-39520,
-39466,
-39862,
-40688,
-41818,
-43078,
-44326,
-45451,
-46418,
-47183,
-47699,
-47850,
-47476,
-46404,
-44519,
-41802,
-38375,
-34477,
-30403,
-26458,
-22886,
-19853,
-17443,
-15699,
-14623,
-14223,
-14468,
-15302,
-16585,
-18151,
-19754,
-21193,
-22301,
-22990,
-23302,
-23301,
-23139,
-22932,
-22772,
-22733,
-22836,
-23133,
-23669,
-24496,
-25693,
-27261,
-29200,
-31402,
-33715,
-35957,
-37923,
-39456,
-40457,
-40868,
-40728,
-40080,
-39012,
-37612,
-35955,
-34147,
-32275,
-30484,
-28912,
-27720,
-27048,
-26978,
-27518,
-28603,
-30088,
-31807,
-33600,
-35337,
-36954,
-38416,
-39706,
-40792,
-41623,
-42128,
-42260,
-42041,
-41553,
-40985,
-40540,
-40416,
-40737,
-41500,
-42620,
-43919,
-45236,
-46422,
-47409,
-48145,
-48617,
-48739,
-48408,
-47465,
-45779,
-43286,
-40058,
-36266,
-32221,
-28214,
-24554,
-21424,
-18953,
-17160,
-16038,
-15558,
-15676,
-16341,
-17445,
-18832,
-20308,
-21654,
-22704,
-23360,
-23628,
-23600,
-23407,
-23187,
-23024,
-22983,
-23062,
-23308,
-23740,
-24449,
-25514,
-26976,
-28839,
-30982,
-33237,
-35395,
-37238,
-38633,
-39490,
-39819,
-39657,
-39067,
-38113,
-36824,
-35276,
-33517,
-31671,
-29887,
-28332,
-27185,
-26574,
-26557,
-27131,
-28201,
-29654,
-31331,
-33111,
-34880,
-36573,
-38134,
-39520,
-40680,
-41548,
-42078,
-42224,
-42026,
-41553,
-40979,
-40485,
-40261,
-40452,
-41084,
-42126,
-43426,
-44815,
-46114,
-47185,
-47934,
-48298,
-48218,
-47628,
-46444,
-44600,
-42071,
-38927,
-35317,
-31497,
-27718,
-24255,
-21268,
-18882,
-17114,
-15963,
-15411,
-15433,
-16007,
-17054,
-18439,
-19968,
-21392,
-22523,
-23205,
-23449,
-23339,
-23073,
-22811,
-22714,
-22804,
-23085,
-23502,
-24034,
-24725,
-25664,
-26947,
-28642,
-30684,
-32937,
-35145,
-37066,
-38480,
-39280,
-39480,
-39143,
-38417,
-37383,
-36120,
-34663,
-33040,
-31317,
-29621,
-28107,
-26973,
-26356,
-26344,
-26933,
-28032,
-29513,
-31226,
-33030,
-34845,
-36565,
-38150,
-39516,
-40612,
-41371,
-41769,
-41814,
-41580,
-41180,
-40767,
-40482,
-40458,
-40758,
-41399,
-42341,
-43484,
-44725,
-45943,
-47016,
-47844,
-48314,
-48324,
-47774,
-46570,
-44669,
-42074,
-38890,
-35280,
-31494,
-27783,
-24401,
-21519,
-19255,
-17628,
-16623,
-16199,
-16295,
-16879,
-17856,
-19142,
-20557,
-21931,
-23059,
-23814,
-24141,
-24102,
-23838,
-23524,
-23323,
-23320,
-23550,
-23970,
-24559,
-25309,
-26262,
-27507,
-29081,
-30984,
-33105,
-35232,
-37147,
-38610,
-39496,
-39771,
-39492,
-38785,
-37747,
-36473,
-34991,
-33343,
-31591,
-29843,
-28293,
-27122,
-26514,
-26546,
-27196,
-28362,
-29858,
-31537,
-33262,
-34970,
-36629,
-38217,
-39670,
-40912,
-41826,
-42332,
-42404,
-42116,
-41597,
-41061,
-40681,
-40606,
-40900,
-41544,
-42471,
-43593,
-44797,
-46021,
-47147,
-48111,
-48753,
-48960,
-48558,
-47441,
-45543,
-42891,
-39602,
-35868,
-31939,
-28063,
-24479,
-21376,
-18871,
-17053,
-15921,
-15475,
-15638,
-16347,
-17446,
-18817,
-20244,
-21580,
-22640,
-23347,
-23671,
-23670,
-23480,
-23235,
-23082,
-23101,
-23320,
-23731,
-24312,
-25059,
-26017,
-27245,
-28807,
-30699,
-32842,
-35056,
-37110,
-38765,
-39843,
-40269,
-40069,
-39355,
-38251,
-36885,
-35329,
-33639,
-31875,
-30122,
-28542,
-27304,
-26589,
-26496,
-27035,
-28122,
-29576,
-31254,
-32981,
-34710,
-36389,
-38017,
-39540,
-40880,
-41899,
-42501,
-42624,
-42336,
-41791,
-41221,
-40853,
-40864,
-41299,
-42130,
-43213,
-44421,
-45625,
-46750,
-47753,
-48585,
-49168,
-49364,
-49015,
-47941,
-46067,
-43374,
-40006,
-36182,
-32190,
-28331,
-24841,
-21893,
-19585,
-17927,
-16917,
-16499,
-16626,
-17226,
-18214,
-19456,
-20818,
-22121,
-23221,
-23999,
-24403,
-24464,
-24271,
-23980,
-23733,
-23671,
-23867,
-24352,
-25107,
-26108,
-27308,
-28718,
-30309,
-32087,
-33978,
-35894,
-37664,
-39134,
-40139,
-40596,
-40478,
-39843,
-38779,
-37405,
-35805,
-34080,
-32302,
-30592,
-29088,
-27964,
-27364,
-27403,
-28058,
-29251,
-30782,
-32464,
-34123,
-35676,
-37106,
-38444,
-39717,
-40884,
-41872,
-42538,
-42802,
-42638,
-42154,
-41550,
-41079,
-40938,
-41266,
-42018,
-43099,
-44319,
-45517,
-46592,
-47493,
-48201,
-48698,
-48874,
-48593,
-47668,
-45964,
-43423,
-40154,
-36342,
-32309,
-28349,
-24739,
-21659,
-19206,
-17415,
-16273,
-15763,
-15850,
-16456,
-17501,
-18800,
-20190,
-21466,
-22474,
-23131,
-23423,
-23415,
-23211,
-22929,
-22668,
-22519,
-22524,
-22755,
-23237,
-24031,
-25167,
-26639,
-28433,
-30443,
-32557,
-34615,
-36445,
-37921,
-38903,
-39358,
-39238,
-38597,
-37476,
-35983,
-34208,
-32285,
-30334,
-28514,
-26957,
-25821,
-25207,
-25197,
-25780,
-26906,
-28424,
-30210,
-32071,
-33918,
-35638,
-37216,
-38601,
-39779,
-40692,
-41281,
-41512,
-41390,
-41005,
-40522,
-40132,
-40030,
-40337,
-41077,
-42176,
-43496,
-44872,
-46176,
-47316,
-48233,
-48880,
-49163,
-48969,
-48141,
-46559,
-44171,
-41045,
-37360,
-33396,
-29447,
-25787,
-22614,
-20037,
-18103,
-16815,
-16154,
-16114,
-16630,
-17639,
-18977,
-20460,
-21861,
-22993,
-23724,
-24033,
-23984,
-23719,
-23386,
-23133,
-23029,
-23128,
-23407,
-23878,
-24537,
-25432,
-26599,
-28093,
-29898,
-31943,
-34104,
-36162,
-37939,
-39240,
-39959,
-40084,
-39662,
-38818,
-37667,
-36328,
-34850,
-33282,
-31638,
-29981,
-28414,
-27096,
-26200,
-25880,
-26204,
-27148,
-28578,
-30308,
-32136,
-33926,
-35582,
-37107,
-38504,
-39774,
-40885,
-41736,
-42245,
-42345,
-42058,
-41509,
-40881,
-40410,
-40265,
-40558,
-41263,
-42296,
-43491,
-44709,
-45842,
-46822,
-47634,
-48245,
-48593,
-48572,
-48034,
-46828,
-44862,
-42117,
-38700,
-34822,
-30762,
-26830,
-23281,
-20321,
-18030,
-16443,
-15497,
-15143,
-15297,
-15902,
-16887,
-18149,
-19565,
-20960,
-22163,
-23027,
-23476,
-23539,
-23308,
-22966,
-22660,
-22534,
-22632,
-22953,
-23455,
-24102,
-24912,
-25926,
-27227,
-28856,
-30800,
-32950,
-35127,
-37109,
-38691,
-39743,
-40202,
-40114,
-39554,
-38621,
-37403,
-35956,
-34336,
-32606,
-30857,
-29232,
-27871,
-26936,
-26525,
-26681,
-27375,
-28510,
-29963,
-31590,
-33294,
-34971,
-36594,
-38106,
-39482,
-40674,
-41611,
-42236,
-42504,
-42412,
-42037,
-41496,
-40959,
-40610,
-40571,
-40941,
-41690,
-42754,
-44003,
-45296,
-46525,
-47570,
-48376,
-48840,
-48898,
-48415,
-47319,
-45520,
-43036,
-39949,
-36426,
-32704,
-29021,
-25596,
-22599,
-20126,
-18225,
-16923,
-16196,
-16050,
-16438,
-17299,
-18528,
-19964,
-21434,
-22748,
-23761,
-24385,
-24618,
-24521,
-24224,
-23866,
-23586,
-23479,
-23599,
-23952,
-24540,
-25341,
-26362,
-27625,
-29139,
-30896,
-32848,
-34860,
-36791,
-38440,
-39665,
-40356,
-40500,
-40140,
-39365,
-38278,
-36939,
-35415,
-33733,
-31961,
-30215,
-28638,
-27439,
-26769,
-26737,
-27339,
-28468,
-29949,
-31593,
-33234,
-34796,
-36255,
-37637,
-38965,
-40213,
-41322,
-42171,
-42676,
-42782,
-42520,
-42024,
-41449,
-41012,
-40850,
-41063,
-41651,
-42556,
-43664,
-44878,
-46075,
-47189,
-48139,
-48836,
-49198,
-49074,
-48357,
-46915,
-44722,
-41802,
-38315,
-34478,
-30582,
-26898,
-23646,
-20972,
-18918,
-17474,
-16593,
-16213,
-16311,
-16846,
-17784,
-19031,
-20450,
-21858,
-23067,
-23929,
-24372,
-24436,
-24220,
-23901,
-23610,
-23472,
-23519,
-23757,
-24168,
-24745,
-25530,
-26576,
-27950,
-29659,
-31659,
-33797,
-35893,
-37717,
-39099,
-39922,
-40170,
-39897,
-39212,
-38215,
-37006,
-35620,
-34098,
-32459,
-30771,
-29151,
-27743,
-26741,
-26271,
-26427,
-27196,
-28461,
-30073,
-31837,
-33604,
-35287,
-36842,
-38278,
-39593,
-40757,
-41704,
-42344,
-42607,
-42478,
-42037,
-41431,
-40871,
-40546,
-40598,
-41067,
-41906,
-42995,
-44200,
-45387,
-46479,
-47407,
-48145,
-48617,
-48740,
-48372,
-47395,
-45678,
-43222,
-40050,
-36364,
-32381,
-28400,
-24694,
-21482,
-18922,
-17067,
-15924,
-15414,
-15476,
-15992,
-16892,
-18059,
-19385,
-20737,
-21969,
-22952,
-23596,
-23871,
-23834,
-23594,
-23301,
-23092,
-23057,
-23240,
-23625,
-24186,
-24918,
-25838,
-27012,
-28492,
-30302,
-32380,
-34587,
-36709,
-38524,
-39831,
-40530,
-40591,
-40100,
-39158,
-37913,
-36452,
-34878,
-33232,
-31597,
-30053,
-28716,
-27720,
-27167,
-27142,
-27639,
-28615,
-29952,
-31520,
-33202,
-34875,
-36499,
-38006,
-39391,
-40597,
-41591,
-42295,
-42671,
-42683,
-42383,
-41860,
-41293,
-40856,
-40731,
-41003,
-41714,
-42763,
-44031,
-45346,
-46554,
-47571,
-48317,
-48760,
-48871,
-48542,
-47729,
-46276,
-44170,
-41389,
-38069,
-34386,
-30608,
-26974,
-23708,
-20950,
-18782,
-17227,
-16278,
-15916,
-16114,
-16815,
-17939,
-19339,
-20838,
-22245,
-23378,
-24127,
-24448,
-24400,
-24096,
-23696,
-23342,
-23157,
-23192,
-23482,
-23994,
-24726,
-25657,
-26802,
-28178,
-29782,
-31594,
-33501,
-35390,
-37076,
-38398,
-39252,
-39561,
-39383,
-38755,
-37806,
-36589,
-35176,
-33596,
-31883,
-30119,
-28431,
-27000,
-26019,
-25631,
-25906,
-26783,
-28135,
-29748,
-31458,
-33115,
-34676,
-36142,
-37522,
-38822,
-39969,
-40865,
-41407,
-41524,
-41250,
-40699,
-40060,
-39553,
-39337,
-39515,
-40083,
-40956,
-42040,
-43195,
-44356,
-45451,
-46435,
-47253,
-47800,
-47952,
-47556,
-46480,
-44650,
-42070,
-38855,
-35202,
-31370,
-27626,
-24218,
-21306,
-19015,
-17346,
-16305,
-15830,
-15884,
-16418,
-17358,
-18633,
-20095,
-21595,
-22939,
-23992,
-24644,
-24910,
-24859,
-24624,
-24377,
-24205,
-24217,
-24389,
-24740,
-25237,
-25906,
-26795,
-27954,
-29439,
-31203,
-33181,
-35191,
-37051,
-38585,
-39641,
-40189,
-40213,
-39795,
-38994,
-37896,
-36538,
-34977,
-33258,
-31464,
-29732,
-28204,
-27063,
-26446,
-26431,
-27024,
-28134,
-29626,
-31330,
-33097,
-34818,
-36435,
-37931,
-39275,
-40469,
-41416,
-42086,
-42383,
-42321,
-41942,
-41399,
-40858,
-40530,
-40539,
-40961,
-41756,
-42824,
-44025,
-45239,
-46360,
-47341,
-48142,
-48702,
-48956,
-48752,
-47981,
-46484,
-44245,
-41263,
-37719,
-33813,
-29839,
-26066,
-22719,
-19959,
-17860,
-16423,
-15629,
-15398,
-15684,
-16399,
-17466,
-18766,
-20159,
-21482,
-22571,
-23321,
-23668,
-23660,
-23411,
-23070,
-22812,
-22730,
-22898,
-23276,
-23850,
-24562,
-25439,
-26518,
-27876,
-29561,
-31547,
-33724,
-35897,
-37827,
-39299,
-40173,
-40405,
-40056,
-39242,
-38100,
-36737,
-35227,
-33608,
-31932,
-30260,
-28725,
-27449,
-26612,
-26294,
-26559,
-27357,
-28589,
-30119,
-31803,
-33536,
-35239,
-36868,
-38382,
-39734,
-40865,
-41693,
-42158,
-42243,
-41969,
-41472,
-40882,
-40410,
-40211,
-40393,
-40989,
-41938,
-43124,
-44411,
-45660,
-46774,
-47685,
-48330,
-48663,
-48575,
-47977,
-46733,
-44788,
-42127,
-38869,
-35185,
-31363,
-27634,
-24261,
-21377,
-19078,
-17383,
-16281,
-15757,
-15793,
-16359,
-17383,
-18749,
-20281,
-21762,
-23017,
-23877,
-24315,
-24355,
-24134,
-23796,
-23498,
-23351,
-23394,
-23662,
-24111,
-24763,
-25607,
-26688,
-28027,
-29635,
-31475,
-33444,
-35406,
-37184,
-38626,
-39613,
-40090,
-40061,
-39586,
-38741,
-37597,
-36218,
-34642,
-32917,
-31135,
-29405,
-27914,
-26835,
-26321,
-26453,
-27201,
-28432,
-29979,
-31616,
-33241,
-34754,
-36187,
-37570,
-38918,
-40211,
-41316,
-42120,
-42483,
-42388,
-41905,
-41237,
-40605,
-40263,
-40327,
-40843,
-41717,
-42812,
-43965,
-45081,
-46087,
-46981,
-47735,
-48294,
-48539,
-48304,
-47423,
-45772,
-43332,
-40200,
-36567,
-32711,
-28897,
-25382,
-22326,
-19839,
-17951,
-16654,
-15932,
-15739,
-16054,
-16813,
-17927,
-19278,
-20686,
-21997,
-23042,
-23733,
-24045,
-24037,
-23824,
-23547,
-23328,
-23252,
-23357,
-23637,
-24095,
-24726,
-25583,
-26711,
-28154,
-29924,
-31931,
-34057,
-36089,
-37844,
-39132,
-39884,
-40052,
-39714,
-38956,
-37868,
-36565,
-35070,
-33469,
-31789,
-30126,
-28592,
-27320,
-26454,
-26102,
-26298,
-27034,
-28198,
-29660,
-31271,
-32905,
-34491,
-35984,
-37393,
-38698,
-39887,
-40888,
-41627,
-42021,
-42038,
-41717,
-41166,
-40567,
-40108,
-39957,
-40202,
-40850,
-41811,
-42965,
-44164,
-45306,
-46319,
-47178,
-47869,
-48352,
-48556,
-48356,
-47620,
-46212,
-44082,
-41236,
-37816,
-34018,
-30109,
-26349,
-22962,
-20108,
-17857,
-16242,
-15226,
-14769,
-14833,
-15352,
-16284,
-17522,
-18951,
-20399,
-21716,
-22737,
-23395,
-23657,
-23605,
-23351,
-23042,
-22803,
-22715,
-22813,
-23089,
-23531,
-24133,
-24921,
-25938,
-27237,
-28821,
-30675,
-32686,
-34729,
-36622,
-38224,
-39409,
-40115,
-40342,
-40106,
-39475,
-38490,
-37217,
-35694,
-34005,
-32214,
-30457,
-28856,
-27565,
-26715,
-26384,
-26620,
-27366,
-28554,
-30035,
-31691,
-33384,
-35044,
-36597,
-38045,
-39347,
-40512,
-41477,
-42211,
-42648,
-42778,
-42609,
-42235,
-41766,
-41384,
-41206,
-41363,
-41857,
-42669,
-43697,
-44818,
-45940,
-46969,
-47865,
-48597,
-49113,
-49345,
-49173,
-48477,
-47122,
-45074,
-42325,
-39025,
-35353,
-31566,
-27906,
-24579,
-21729,
-19434,
-17718,
-16571,
-15986,
-15915,
-16348,
-17203,
-18402,
-19808,
-21256,
-22597,
-23663,
-24392,
-24731,
-24746,
-24531,
-24213,
-23927,
-23762,
-23786,
-24001,
-24419,
-25002,
-25766,
-26714,
-27883,
-29296,
-30954,
-32811,
-34764,
-36673,
-38365,
-39680,
-40507,
-40779,
-40517,
-39791,
-38691,
-37347,
-35821,
-34209,
-32533,
-30868,
-29273,
-27863,
-26775,
-26140,
-26072,
-26598,
-27680,
-29178,
-30929,
-32726,
-34446,
-35988,
-37354,
-38556,
-39633,
-40565,
-41317,
-41797,
-41933,
-41716,
-41193,
-40522,
-39909,
-39538,
-39578,
-40055,
-40925,
-42056,
-43278,
-44461,
-45502,
-46372,
-47063,
-47561,
-47811,
-47708,
-47109,
-45868,
-43908,
-41213,
-37903,
-34179,
-30303,
-26550,
-23159,
-20280,
-18028,
-16392,
-15374,
-14909,
-14949,
-15447,
-16323,
-17503,
-18866,
-20277,
-21587,
-22678,
-23458,
-23909,
-24072,
-24024,
-23893,
-23770,
-23749,
-23865,
-24139,
-24564,
-25144,
-25890,
-26838,
-28033,
-29496,
-31237,
-33175,
-35214,
-37177,
-38891,
-40198,
-40979,
-41201,
-40893,
-40141,
-39056,
-37743,
-36282,
-34720,
-33100,
-31460,
-29885,
-28484,
-27400,
-26769,
-26683,
-27165,
-28163,
-29533,
-31144,
-32805,
-34444,
-35968,
-37391,
-38706,
-39912,
-40973,
-41816,
-42358,
-42535,
-42344,
-41854,
-41215,
-40605,
-40229,
-40208,
-40622,
-41426,
-42524,
-43777,
-45035,
-46204,
-47202,
-48003,
-48569,
-48848,
-48743,
-48145,
-46920,
-45003,
-42384,
-39162,
-35528,
-31721,
-28000,
-24572,
-21605,
-19152,
-17267,
-15912,
-15096,
-14801,
-15021,
-15726,
-16844,
-18240,
-19747,
-21168,
-22329,
-23126,
-23513,
-23565,
-23373,
-23095,
-22846,
-22716,
-22745,
-22938,
-23278,
-23776,
-24443,
-25333,
-26500,
-27963,
-29738,
-31723,
-33831,
-35859,
-37667,
-39070,
-39983,
-40349,
-40183,
-39563,
-38570,
-37318,
-35887,
-34351,
-32755,
-31145,
-29589,
-28170,
-27015,
-26258,
-26014,
-26359,
-27274,
-28660,
-30354,
-32153,
-33901,
-35475,
-36873,
-38108,
-39257,
-40322,
-41274,
-42010,
-42399,
-42371,
-41931,
-41204,
-40435,
-39858,
-39717,
-40082,
-40941,
-42117,
-43421,
-44653,
-45711,
-46570,
-47270,
-47848,
-48286,
-48474,
-48241,
-47387,
-45762,
-43330,
-40177,
-36526,
-32645,
-28833,
-25310,
-22250,
-19722,
-17758,
-16355,
-15500,
-15201,
-15422,
-16135,
-17237,
-18606,
-20065,
-21447,
-22600,
-23418,
-23876,
-23992,
-23861,
-23589,
-23304,
-23105,
-23062,
-23216,
-23565,
-24109,
-24843,
-25770,
-26918,
-28301,
-29935,
-31773,
-33750,
-35719,
-37524,
-39002,
-40015,
-40502,
-40453,
-39930,
-39028,
-37849,
-36472,
-34971,
-33373,
-31750,
-30155,
-28715,
-27549,
-26797,
-26564,
-26883,
-27725,
-28996,
-30524,
-32198,
-33846,
-35429,
-36888,
-38229,
-39462,
-40557,
-41479,
-42149,
-42494,
-42488,
-42142,
-41574,
-40946,
-40451,
-40290,
-40545,
-41262,
-42326,
-43586,
-44869,
-46002,
-46931,
-47616,
-48107,
-48410,
-48505,
-48260,
-47535,
-46127,
-43944,
-40992,
-37416,
-33508,
-29579,
-25954,
-22840,
-20343,
-18454,
-17111,
-16254,
-15832,
-15874,
-16375,
-17333,
-18662,
-20195,
-21721,
-23026,
-23942,
-24419,
-24486,
-24282,
-23952,
-23659,
-23479,
-23475,
-23632,
-23940,
-24416,
-25059,
-25942,
-27082,
-28504,
-30184,
-32032,
-33955,
-35806,
-37464,
-38817,
-39775,
-40297,
-40366,
-39995,
-39241,
-38156,
-36826,
-35320,
-33714,
-32075,
-30473,
-29000,
-27761,
-26888,
-26497,
-26669,
-27429,
-28688,
-30313,
-32095,
-33850,
-35439,
-36819,
-37999,
-39068,
-40051,
-40978,
-41748,
-42270,
-42421,
-42173,
-41603,
-40885,
-40273,
-39989,
-40181,
-40866,
-41925,
-43183,
-44437,
-45567,
-46503,
-47284,
-47918,
-48421,
-48693,
-48573,
-47870,
-46407,
-44127,
-41086,
-37482,
-33585,
-29704,
-26075,
-22892,
-20222,
-18094,
-16497,
-15412,
-14854,
-14825,
-15320,
-16295,
-17633,
-19177,
-20717,
-22073,
-23081,
-23687,
-23887,
-23780,
-23502,
-23183,
-22967,
-22896,
-23035,
-23338,
-23829,
-24476,
-25322,
-26395,
-27745,
-29377,
-31263,
-33303,
-35348,
-37225,
-38772,
-39862,
-40434,
-40498,
-40091,
-39312,
-38220,
-36903,
-35398,
-33777,
-32095,
-30460,
-28986,
-27811,
-27051,
-26779,
-27022,
-27730,
-28816,
-30165,
-31656,
-33205,
-34742,
-36245,
-37681,
-39042,
-40283,
-41345,
-42172,
-42685,
-42862,
-42716,
-42317,
-41795,
-41314,
-41023,
-41060,
-41467,
-42232,
-43257,
-44414,
-45574,
-46631,
-47539,
-48258,
-48785,
-49033,
-48932,
-48292,
-46995,
-44918,
-42083,
-38628,
-34802,
-30919,
-27280,
-24091,
-21482,
-19429,
-17907,
-16825,
-16181,
-15977,
-16254,
-17026,
-18222,
-19706,
-21256,
-22650,
-23695,
-24302,
-24500,
-24379,
-24128,
-23867,
-23716,
-23716,
-23837,
-24081,
-24406,
-24854,
-25468,
-26333,
-27493,
-28981,
-30742,
-32680,
-34661,
-36502,
-38079,
-39243,
-39941,
-40137,
-39853,
-39152,
-38091,
-36765,
-35236,
-33582,
-31876,
-30193,
-28639,
-27322,
-26360,
-25860,
-25890,
-26450,
-27502,
-28896,
-30513,
-32180,
-33792,
-35284,
-36643,
-37877,
-39010,
-40006,
-40813,
-41345,
-41524,
-41337,
-40840,
-40185,
-39565,
-39190,
-39197,
-39649,
-40482,
-41579,
-42770,
-43929,
-44959,
-45838,
-46546,
-47075,
-47347,
-47246,
-46608,
-45291,
-43212,
-40400,
-36999,
-33246,
-29429,
-25813,
-22613,
-19948,
-17859,
-16321,
-15297,
-14737,
-14640,
-14978,
-15760,
-16904,
-18341,
-19878,
-21363,
-22597,
-23465,
-23928,
-24018,
-23872,
-23626,
-23442,
-23405,
-23555,
-23879,
-24338,
-24912,
-25614,
-26496,
-27627,
-29063,
-30796,
-32747,
-34780,
-36703,
-38340,
-39565,
-40287,
-40532,
-40322,
-39744,
-38856,
-37719,
-36366,
-34847,
-33195,
-31510,
-29858,
-28375,
-27156,
-26306,
-25907,
-25987,
-26560,
-27571,
-28941,
-30548,
-32264,
-33960,
-35556,
-36993,
-38277,
-39415,
-40430,
-41295,
-41968,
-42357,
-42400,
-42079,
-41457,
-40696,
-40007,
-39611,
-39667,
-40233,
-41231,
-42510,
-43857,
-45108,
-46151,
-46978,
-47613,
-48115,
-48459,
-48576,
-48301,
-47456,
-45888,
-43541,
-40478,
-36881,
-33006,
-29141,
-25519,
-22337,
-19668,
-17558,
-15983,
-14922,
-14362,
-14278,
-14664,
-15469,
-16629,
-18023,
-19511,
-20927,
-22130,
-23011,
-23528,
-23689,
-23583,
-23303,
-22987,
-22726,
-22604,
-22646,
-22880,
-23287,
-23892,
-24703,
-25750,
-27055,
-28621,
-30398,
-32323,
-34278,
-36133,
-37774,
-39087,
-39996,
-40477,
-40496,
-40100,
-39306,
-38192,
-36817,
-35258,
-33596,
-31903,
-30262,
-28759,
-27472,
-26512,
-25953,
-25873,
-26302,
-27203,
-28517,
-30099,
-31826,
-33558,
-35207,
-36725,
-38102,
-39354,
-40476,
-41447,
-42204,
-42675,
-42811,
-42585,
-42080,
-41405,
-40754,
-40314,
-40220,
-40568,
-41319,
-42393,
-43633,
-44888,
-46045,
-47016,
-47797,
-48364,
-48720,
-48807,
-48524,
-47757,
-46370,
-44312,
-41574,
-38292,
-34643,
-30890,
-27270,
-24000,
-21210,
-18971,
-17288,
-16132,
-15473,
-15285,
-15542,
-16229,
-17282,
-18615,
-20093,
-21550,
-22834,
-23798,
-24387,
-24595,
-24491,
-24220,
-23891,
-23660,
-23580,
-23694,
-23982,
-24411,
-24949,
-25613,
-26426,
-27459,
-28768,
-30360,
-32222,
-34214,
-36211,
-37998,
-39438,
-40397,
-40841,
-40785,
-40316,
-39509,
-38481,
-37268,
-35934,
-34489,
-32966,
-31417,
-29924,
-28606,
-27589,
-26988,
-26875,
-27276,
-28142,
-29386,
-30883,
-32499,
-34137,
-35705,
-37164,
-38503,
-39710,
-40779,
-41689,
-42380,
-42824,
-42956,
-42785,
-42345,
-41740,
-41123,
-40654,
-40490,
-40722,
-41364,
-42357,
-43565,
-44839,
-46041,
-47068,
-47879,
-48460,
-48806,
-48884,
-48630,
-47924,
-46659,
-44750,
-42183,
-39054,
-35523,
-31831,
-28219,
-24897,
-22034,
-19698,
-17919,
-16687,
-15951,
-15709,
-15901,
-16520,
-17478,
-18719,
-20093,
-21481,
-22725,
-23715,
-24374,
-24690,
-24709,
-24514,
-24226,
-23949,
-23771,
-23738,
-23877,
-24160,
-24609,
-25194,
-25966,
-26942,
-28179,
-29673,
-31427,
-33326,
-35280,
-37097,
-38647,
-39778,
-40421,
-40555,
-40219,
-39485,
-38451,
-37185,
-35768,
-34233,
-32625,
-31002,
-29434,
-28040,
-26943,
-26263,
-26100,
-26463,
-27337,
-28592,
-30109,
-31725,
-33327,
-34845,
-36250,
-37556,
-38786,
-39924,
-40953,
-41788,
-42357,
-42596,
-42479,
-42062,
-41460,
-40831,
-40362,
-40190,
-40411,
-41028,
-41974,
-43129,
-44358,
-45529,
-46571,
-47425,
-48076,
-48508,
-48655,
-48460,
-47781,
-46529,
-44619,
-42045,
-38907,
-35363,
-31660,
-28023,
-24674,
-21754,
-19342,
-17457,
-16079,
-15188,
-14773,
-14824,
-15347,
-16279,
-17566,
-19045,
-20556,
-21929,
-22994,
-23696,
-24002,
-23991,
-23766,
-23456,
-23171,
-22993,
-22962,
-23092,
-23393,
-23860,
-24528,
-25400,
-26524,
-27879,
-29476,
-31241,
-33118,
-34994,
-36754,
-38281,
-39458,
-40197,
-40454,
-40220,
-39554,
-38540,
-37289,
-35906,
-34472,
-33032,
-31611,
-30241,
-28959,
-27864,
-27070,
-26696,
-26847,
-27534,
-28709,
-30229,
-31931,
-33633,
-35231,
-36667,
-37954,
-39140,
-40242,
-41266,
-42134,
-42769,
-43068,
-43002,
-42603,
-41991,
-41332,
-40832,
-40625,
-40821,
-41399,
-42299,
-43393,
-44549,
-45666,
-46676,
-47548,
-48268,
-48802,
-49087,
-49018,
-48461,
-47290,
-45433,
-42885,
-39759,
-36221,
-32517,
-28882,
-25520,
-22581,
-20135,
-18202,
-16788,
-15853,
-15421,
-15450,
-15951,
-16851,
-18068,
-19466,
-20882,
-22165,
-23180,
-23864,
-24193,
-24224,
-24037,
-23738,
-23427,
-23184,
-23054,
-23081,
-23266,
-23627,
-24182,
-24949,
-25959,
-27238,
-28766,
-30536,
-32439,
-34389,
-36234,
-37836,
-39076,
-39863,
-40155,
-39974,
-39349,
-38371,
-37112,
-35655,
-34074,
-32425,
-30776,
-29186,
-27736,
-26517,
-25619,
-25135,
-25128,
-25608,
-26561,
-27883,
-29473,
-31183,
-32895,
-34516,
-35998,
-37336,
-38525,
-39585,
-40469,
-41158,
-41558,
-41652,
-41430,
-40959,
-40399,
-39901,
-39674,
-39819,
-40395,
-41344,
-42528,
-43809,
-45011,
-46075,
-46942,
-47642,
-48186,
-48562,
-48706,
-48473,
-47718,
-46289,
-44121,
-41259,
-37838,
-34120,
-30365,
-26856,
-23783,
-21268,
-19325,
-17925,
-16989,
-16473,
-16334,
-16572,
-17176,
-18128,
-19346,
-20714,
-22053,
-23197,
-24012,
-24427,
-24470,
-24232,
-23863,
-23505,
-23274,
-23221,
-23352,
-23637,
-24043,
-24571,
-25245,
-26129,
-27277,
-28722,
-30439,
-32357,
-34344,
-36254,
-37941,
-39284,
-40203,
-40665,
-40662,
-40230,
-39407,
-38259,
-36845,
-35247,
-33538,
-31805,
-30143,
-28643,
-27407,
-26520,
-26060,
-26068,
-26548,
-27460,
-28723,
-30224,
-31859,
-33518,
-35141,
-36682,
-38116,
-39442,
-40613,
-41595,
-42313,
-42713,
-42750,
-42457,
-41902,
-41232,
-40625,
-40247,
-40234,
-40646,
-41452,
-42557,
-43810,
-45068,
-46196,
-47139,
-47863,
-48371,
-48681,
-48730,
-48464,
-47738,
-46437,
-44461,
-41800,
-38539,
-34864,
-31020,
-27275,
-23858,
-20934,
-18583,
-16814,
-15598,
-14890,
-14656,
-14870,
-15509,
-16530,
-17840,
-19318,
-20778,
-22073,
-23037,
-23626,
-23816,
-23709,
-23426,
-23109,
-22880,
-22802,
-22902,
-23145,
-23515,
-23983,
-24589,
-25372,
-26421,
-27774,
-29445,
-31373,
-33428,
-35447,
-37251,
-38694,
-39685,
-40201,
-40261,
-39925,
-39260,
-38301,
-37104,
-35670,
-34058,
-32309,
-30547,
-28876,
-27469,
-26440,
-25903,
-25905,
-26423,
-27397,
-28710,
-30236,
-31862,
-33487,
-35053,
-36528,
-37890,
-39143,
-40247,
-41188,
-41891,
-42323,
-42445,
-42263,
-41849,
-41297,
-40769,
-40406,
-40336,
-40639,
-41298,
-42268,
-43418,
-44632,
-45791,
-46811,
-47648,
-48276,
-48676,
-48800,
-48576,
-47897,
-46661,
-44794,
-42289,
-39218,
-35743,
-32068,
-28440,
-25064,
-22114,
-19680,
-17802,
-16473,
-15656,
-15334,
-15456,
-16020,
-16945,
-18178,
-19573,
-20992,
-22267,
-23254,
-23882,
-24118,
-24051,
-23772,
-23440,
-23178,
-23063,
-23147,
-23394,
-23788,
-24288,
-24892,
-25641,
-26579,
-27784,
-29269,
-31028,
-32965,
-34957,
-36819,
-38409,
-39574,
-40261,
-40435,
-40144,
-39461,
-38464,
-37249,
-35867,
-34380,
-32838,
-31275,
-29791,
-28443,
-27368,
-26655,
-26400,
-26643,
-27370,
-28515,
-29945,
-31555,
-33173,
-34759,
-36206,
-37556,
-38772,
-39893,
-40871,
-41677,
-42228,
-42479,
-42388,
-42010,
-41423,
-40802,
-40296,
-40081,
-40232,
-40793,
-41690,
-42820,
-44039,
-45213,
-46254,
-47107,
-47763,
-48226,
-48470,
-48453,
-48067,
-47191,
-45718,
-43561,
-40766,
-37416,
-33750,
-29983,
-26407,
-23201,
-20519,
-18404,
-16832,
-15769,
-15137,
-14918,
-15085,
-15628,
-16527,
-17709,
-19067,
-20452,
-21711,
-22705,
-23357,
-23651,
-23634,
-23418,
-23105,
-22818,
-22624,
-22576,
-22666,
-22902,
-23250,
-23734,
-24360,
-25171,
-26204,
-27480,
-29002,
-30726,
-32570,
-34444,
-36208,
-37771,
-39009,
-39873,
-40304,
-40315,
-39912,
-39154,
-38089,
-36787,
-35314,
-33731,
-32102,
-30488,
-28964,
-27594,
-26489,
-25711,
-25361,
-25474,
-26068,
-27098,
-28484,
-30103,
-31830,
-33559,
-35198,
-36717,
-38098,
-39337,
-40447,
-41387,
-42120,
-42592,
-42752,
-42592,
-42167,
-41561,
-40935,
-40442,
-40215,
-40360,
-40877,
-41733,
-42816,
-44011,
-45199,
-46290,
-47248,
-48028,
-48647,
-49047,
-49193,
-48986,
-48318,
-47085,
-45227,
-42732,
-39686,
-36234,
-32576,
-28951,
-25555,
-22571,
-20089,
-18160,
-16759,
-15860,
-15404,
-15353,
-15691,
-16371,
-17383,
-18630,
-20031,
-21426,
-22695,
-23693,
-24355,
-24671,
-24685,
-24518,
-24266,
-24061,
-23949,
-23977,
-24126,
-24379,
-24723,
-25169,
-25761,
-26553,
-27608,
-28944,
-30566,
-32400,
-34344,
-36270,
-38017,
-39483,
-40545,
-41169,
-41331,
-41071,
-40435,
-39501,
-38327,
-36988,
-35516,
-33978,
-32383,
-30831,
-29355,
-28083,
-27099,
-26506,
-26378,
-26733,
-27551,
-28744,
-30207,
-31795,
-33411,
-34947,
-36387,
-37700,
-38930,
-40058,
-41107,
-42000,
-42690,
-43080,
-43135,
-42835,
-42273,
-41562,
-40895,
-40443,
-40329,
-40636,
-41315,
-42289,
-43415,
-44549,
-45601,
-46495,
-47240,
-47827,
-48283,
-48560,
-48606,
-48291,
-47505,
-46127,
-44111,
-41470,
-38307,
-34793,
-31136,
-27561,
-24261,
-21377,
-19000,
-17147,
-15813,
-14964,
-14567,
-14594,
-15031,
-15832,
-16961,
-18306,
-19758,
-21145,
-22333,
-23181,
-23646,
-23715,
-23493,
-23076,
-22636,
-22274,
-22087,
-22095,
-22284,
-22621,
-23065,
-23623,
-24310,
-25204,
-26351,
-27807,
-29553,
-31526,
-33597,
-35617,
-37404,
-38846,
-39824,
-40328,
-40357,
-39968,
-39232,
-38221,
-37000,
-35642,
-34191,
-32721,
-31273,
-29918,
-28716,
-27745,
-27064,
-26756,
-26848,
-27386,
-28326,
-29624,
-31160,
-32827,
-34494,
-36072,
-37514,
-38797,
-39953,
-40976,
-41878,
-42605,
-43104,
-43301,
-43162,
-42720,
-42044,
-41322,
-40701,
-40375,
-40448,
-40950,
-41831,
-42958,
-44187,
-45355,
-46378,
-47195,
-47817,
-48274,
-48587,
-48728,
-48643,
-48182,
-47243,
-45670,
-43446,
-40578,
-37216,
-33555,
-29840,
-26299,
-23125,
-20428,
-18267,
-16628,
-15495,
-14819,
-14596,
-14797,
-15417,
-16411,
-17707,
-19189,
-20701,
-22094,
-23216,
-23978,
-24345,
-24361,
-24105,
-23728,
-23322,
-23028,
-22878,
-22925,
-23142,
-23521,
-24045,
-24713,
-25551,
-26578,
-27826,
-29291,
-30960,
-32758,
-34608,
-36380,
-37973,
-39240,
-40118,
-40514,
-40434,
-39898,
-38977,
-37770,
-36386,
-34911,
-33413,
-31934,
-30488,
-29113,
-27845,
-26767,
-25982,
-25594,
-25684,
-26287,
-27345,
-28779,
-30423,
-32150,
-33831,
-35405,
-36844,
-38169,
-39390,
-40505,
-41477,
-42232,
-42694,
-42809,
-42566,
-42031,
-41327,
-40621,
-40086,
-39857,
-40012,
-40548,
-41402,
-42456,
-43590,
-44694,
-45700,
-46566,
-47296,
-47875,
-48275,
-48443,
-48255,
-47617,
-46390,
-44524,
-42005,
-38922,
-35431,
-31742,
-28096,
-24691,
-21706,
-19222,
-17287,
-15886,
-14980,
-14544,
-14533,
-14946,
-15735,
-16867,
-18243,
-19739,
-21213,
-22491,
-23479,
-24082,
-24321,
-24242,
-23968,
-23609,
-23294,
-23092,
-23051,
-23179,
-23452,
-23873,
-24414,
-25116,
-25986,
-27084,
-28411,
-29992,
-31750,
-33632,
-35490,
-37208,
-38650,
-39711,
-40342,
-40526,
-40301,
-39730,
-38884,
-37828,
-36619,
-35289,
-33865,
-32385,
-30885,
-29449,
-28160,
-27129,
-26455,
-26229,
-26486,
-27225,
-28384,
-29858,
-31520,
-33234,
-34891,
-36418,
-37793,
-38999,
-40076,
-41008,
-41795,
-42384,
-42728,
-42780,
-42536,
-42054,
-41436,
-40842,
-40421,
-40296,
-40547,
-41149,
-42055,
-43131,
-44278,
-45385,
-46395,
-47269,
-47997,
-48554,
-48892,
-48930,
-48554,
-47656,
-46143,
-43986,
-41223,
-37978,
-34427,
-30796,
-27290,
-24107,
-21364,
-19141,
-17446,
-16259,
-15543,
-15254,
-15369,
-15853,
-16678,
-17790,
-19089,
-20483,
-21803,
-22955,
-23801,
-24317,
-24495,
-24412,
-24171,
-23889,
-23663,
-23565,
-23609,
-23788,
-24091,
-24484,
-25009,
-25686,
-26586,
-27755,
-29228,
-30962,
-32900,
-34892,
-36799,
-38463,
-39754,
-40592,
-40951,
-40851,
-40355,
-39548,
-38503,
-37300,
-35975,
-34577,
-33108,
-31620,
-30148,
-28775,
-27606,
-26739,
-26288,
-26304,
-26809,
-27753,
-29033,
-30541,
-32135,
-33729,
-35246,
-36670,
-37989,
-39216,
-40335,
-41310,
-42083,
-42587,
-42768,
-42611,
-42167,
-41519,
-40830,
-40249,
-39926,
-39965,
-40391,
-41178,
-42216,
-43396,
-44578,
-45677,
-46631,
-47423,
-48050,
-48501,
-48733,
-48659,
-48167,
-47125,
-45445,
-43095,
-40128,
-36690,
-32990,
-29263,
-25746,
-22614,
-19988,
-17909,
-16376,
-15330,
-14755,
-14580,
-14815,
-15419,
-16370,
-17609,
-19028,
-20505,
-21873,
-23003,
-23788,
-24189,
-24239,
-24021,
-23671,
-23304,
-23045,
-22937,
-23021,
-23267,
-23658,
-24176,
-24823,
-25638,
-26667,
-27947,
-29503,
-31285,
-33233,
-35196,
-37051,
-38632,
-39841,
-40596,
-40898,
-40759,
-40268,
-39476,
-38470,
-37294,
-35979,
-34563,
-33048,
-31511,
-29991,
-28613,
-27477,
-26695,
-26371,
-26533,
-27192,
-28281,
-29699,
-31324,
-33034,
-34716,
-36315,
-37764,
-39077,
-40221,
-41213,
-42016,
-42614,
-42955,
-43027,
-42826,
-42397,
-41832,
-41244,
-40778,
-40557,
-40672,
-41152,
-41974,
-43043,
-44247,
-45459,
-46574,
-47518,
-48272,
-48795,
-49112,
-49145,
-48862,
-48129,
-46864,
-44966,
-42437,
-39337,
-35826,
-32140,
-28512,
-25192,
-22322,
-20010,
-18231,
-16966,
-16112,
-15651,
-15519,
-15751,
-16327,
-17258,
-18467,
-19864,
-21284,
-22577,
-23602,
-24270,
-24570,
-24558,
-24333,
-24025,
-23736,
-23550,
-23494,
-23580,
-23787,
-24114,
-24572,
-25192,
-26031,
-27123,
-28493,
-30114,
-31913,
-33788,
-35593,
-37210,
-38515,
-39448,
-39972,
-40107,
-39874,
-39339,
-38528,
-37493,
-36252,
-34833,
-33272,
-31618,
-29951,
-28374,
-26999,
-25952,
-25318,
-25177,
-25526,
-26348,
-27538,
-29004,
-30604,
-32240,
-33812,
-35282,
-36618,
-37833,
-38909,
-39861,
-40629,
-41191,
-41486,
-41471,
-41186,
-40650,
-40013,
-39394,
-38966,
-38838,
-39102,
-39744,
-40718,
-41906,
-43179,
-44428,
-45552,
-46514,
-47272,
-47818,
-48114,
-48094,
-47677,
-46757,
-45235,
-43101,
-40340,
-37117,
-33570,
-29965,
-26522,
-23444,
-20874,
-18844,
-17352,
-16311,
-15657,
-15326,
-15301,
-15601,
-16243,
-17233,
-18520,
-19985,
-21478,
-22801,
-23827,
-24441,
-24664,
-24553,
-24242,
-23868,
-23537,
-23325,
-23238,
-23277,
-23406,
-23636,
-23968,
-24459,
-25134,
-26046,
-27187,
-28553,
-30093,
-31759,
-33479,
-35199,
-36835,
-38321,
-39564,
-40482,
-41009,
-41098,
-40744,
-39993,
-38908,
-37590,
-36124,
-34589,
-33040,
-31507,
-30028,
-28638,
-27395,
-26391,
-25698,
-25419,
-25595,
-26241,
-27306,
-28701,
-30299,
-31975,
-33615,
-35145,
-36530,
-37781,
-38910,
-39942,
-40880,
-41682,
-42312,
-42680,
-42758,
-42512,
-42013,
-41332,
-40656,
-40109,
-39871,
-40000,
-40533,
-41394,
-42485,
-43659,
-44795,
-45818,
-46671,
-47381,
-47931,
-48346,
-48568,
-48535,
-48137,
-47258,
-45836,
-43811,
-41253,
-38218,
-34882,
-31396,
-27939,
-24671,
-21723,
-19189,
-17141,
-15593,
-14552,
-13988,
-13859,
-14127,
-14738,
-15647,
-16805,
-18134,
-19554,
-20935,
-22179,
-23141,
-23780,
-24046,
-23999,
-23734,
-23369,
-23034,
-22819,
-22760,
-22876,
-23111,
-23471,
-23908,
-24477,
-25204,
-26149,
-27360,
-28825,
-30524,
-32369,
-34253,
-36073,
-37698,
-39066,
-40079,
-40728,
-40966,
-40833,
-40328,
-39527,
-38465,
-37223,
-35847,
-34394,
-32899,
-31413,
-29972,
-28653,
-27528,
-26689,
-26225,
-26186,
-26606,
-27441,
-28634,
-30070,
-31636,
-33238,
-34782,
-36234,
-37575,
-38798,
-39916,
-40916,
-41764,
-42439,
-42865,
-43032,
-42916,
-42546,
-42004,
-41390,
-40838,
-40483,
-40410,
-40682,
-41292,
-42177,
-43252,
-44391,
-45508,
-46512,
-47367,
-48058,
-48569,
-48913,
-49021,
-48870,
-48326,
-47323,
-45766,
-43623,
-40934,
-37791,
-34364,
-30847,
-27443,
-24325,
-21614,
-19380,
-17638,
-16368,
-15538,
-15122,
-15093,
-15440,
-16144,
-17156,
-18415,
-19818,
-21230,
-22537,
-23598,
-24363,
-24780,
-24892,
-24768,
-24503,
-24216,
-23982,
-23862,
-23877,
-24007,
-24242,
-24555,
-24971,
-25515,
-26260,
-27252,
-28539,
-30103,
-31891,
-33799,
-35688,
-37438,
-38919,
-40072,
-40846,
-41250,
-41295,
-41008,
-40419,
-39543,
-38427,
-37086,
-35597,
-33995,
-32381,
-30809,
-29382,
-28160,
-27222,
-26628,
-26418,
-26618,
-27215,
-28176,
-29423,
-30876,
-32427,
-34000,
-35508,
-36934,
-38232,
-39424,
-40493,
-41431,
-42215,
-42790,
-43127,
-43175,
-42943,
-42474,
-41840,
-41192,
-40643,
-40345,
-40376,
-40777,
-41520,
-42516,
-43655,
-44818,
-45904,
-46859,
-47652,
-48284,
-48758,
-49040,
-49074,
-48759,
-47969,
-46616,
-44617,
-42001,
-38856,
-35346,
-31692,
-28112,
-24801,
-21900,
-19484,
-17554,
-16095,
-15052,
-14405,
-14132,
-14248,
-14747,
-15637,
-16847,
-18302,
-19845,
-21334,
-22601,
-23553,
-24113,
-24310,
-24209,
-23911,
-23562,
-23239,
-23040,
-22982,
-23070,
-23284,
-23606,
-24031,
-24574,
-25282,
-26182,
-27331,
-28715,
-30336,
-32111,
-33969,
-35783,
-37451,
-38862,
-39937,
-40627,
-40900,
-40786,
-40291,
-39500,
-38432,
-37181,
-35767,
-34252,
-32670,
-31065,
-29507,
-28066,
-26852,
-25961,
-25498,
-25518,
-26046,
-27031,
-28388,
-29979,
-31668,
-33332,
-34886,
-36289,
-37545,
-38686,
-39735,
-40709,
-41589,
-42314,
-42829,
-43056,
-42977,
-42597,
-42002,
-41310,
-40676,
-40245,
-40135,
-40397,
-41024,
-41941,
-43040,
-44197,
-45303,
-46293,
-47117,
-47791,
-48296,
-48655,
-48803,
-48703,
-48219,
-47270,
-45746,
-43617,
-40911,
-37732,
-34261,
-30709,
-27296,
-24202,
-21556,
-19408,
-17752,
-16548,
-15738,
-15282,
-15177,
-15421,
-16037,
-17010,
-18283,
-19758,
-21279,
-22688,
-23836,
-24617,
-25004,
-25031,
-24789,
-24411,
-24012,
-23701,
-23537,
-23544,
-23710,
-24011,
-24423,
-24937,
-25563,
-26333,
-27282,
-28449,
-29850,
-31456,
-33235,
-35062,
-36846,
-38431,
-39717,
-40603,
-41055,
-41066,
-40693,
-39991,
-39050,
-37919,
-36657,
-35286,
-33828,
-32310,
-30783,
-29303,
-27979,
-26906,
-26182,
-25895,
-26059,
-26681,
-27687,
-28989,
-30477,
-32030,
-33580,
-35043,
-36413,
-37673,
-38827,
-39883,
-40810,
-41583,
-42144,
-42448,
-42450,
-42169,
-41631,
-40945,
-40230,
-39632,
-39290,
-39300,
-39708,
-40481,
-41551,
-42766,
-44009,
-45134,
-46065,
-46765,
-47241,
-47526,
-47643,
-47582,
-47287,
-46641,
-45537,
-43840,
-41515,
-38581,
-35156,
-31458,
-27716,
-24197,
-21097,
-18552,
-16611,
-15251,
-14396,
-13975,
-13902,
-14148,
-14698,
-15538,
-16669,
-18019,
-19506,
-20987,
-22320,
-23378,
-24082,
-24431,
-24473,
-24331,
-24114,
-23938,
-23864,
-23911,
-24069,
-24311,
-24627,
-25039,
-25586,
-26332,
-27319,
-28567,
-30047,
-31702,
-33438,
-35164,
-36793,
-38248,
-39481,
-40435,
-41084,
-41376,
-41313,
-40876,
-40103,
-39037,
-37745,
-36304,
-34782,
-33223,
-31685,
-30187,
-28803,
-27579,
-26615,
-26002,
-25811,
-26112,
-26875,
-28069,
-29556,
-31223,
-32919,
-34537,
-36018,
-37332,
-38505,
-39575,
-40543,
-41430,
-42164,
-42699,
-42964,
-42911,
-42577,
-42000,
-41344,
-40713,
-40299,
-40164,
-40399,
-40963,
-41818,
-42853,
-43979,
-45094,
-46134,
-47056,
-47814,
-48403,
-48773,
-48883,
-48678,
-48062,
-46982,
-45365,
-43197,
-40506,
-37379,
-33955,
-30422,
-26957,
-23754,
-20937,
-18592,
-16760,
-15417,
-14551,
-14113,
-14085,
-14440,
-15152,
-16179,
-17448,
-18859,
-20285,
-21602,
-22678,
-23466,
-23903,
-24051,
-23949,
-23714,
-23436,
-23203,
-23070,
-23061,
-23180,
-23413,
-23754,
-24215,
-24820,
-25617,
-26641,
-27916,
-29437,
-31148,
-32982,
-34813,
-36554,
-38080,
-39317,
-40209,
-40713,
-40834,
-40568,
-39961,
-39044,
-37887,
-36542,
-35076,
-33545,
-31997,
-30483,
-29058,
-27776,
-26733,
-25994,
-25662,
-25774,
-26354,
-27354,
-28690,
-30235,
-31865,
-33465,
-34968,
-36348,
-37607,
-38774,
-39854,
-40849,
-41696,
-42357,
-42731,
-42809,
-42567,
-42073,
-41432,
-40789,
-40279,
-40045,
-40131,
-40577,
-41321,
-42284,
-43373,
-44482,
-45550,
-46523,
-47375,
-48091,
-48628,
-48950,
-48976,
-48634,
-47834,
-46524,
-44664,
-42288,
-39443,
-36262,
-32868,
-29459,
-26175,
-23204,
-20627,
-18556,
-16974,
-15893,
-15249,
-14997,
-15100,
-15523,
-16249,
-17258,
-18487,
-19869,
-21258,
-22540,
-23567,
-24262,
-24595,
-24603,
-24384,
-24056,
-23735,
-23510,
-23419,
-23467,
-23637,
-23904,
-24271,
-24758,
-25410,
-26279,
-27404,
-28791,
-30409,
-32190,
-34025,
-35809,
-37419,
-38774,
-39805,
-40476,
-40791,
-40743,
-40382,
-39702,
-38766,
-37576,
-36188,
-34642,
-33005,
-31345,
-29764,
-28335,
-27172,
-26330,
-25889,
-25858,
-26266,
-27046,
-28176,
-29532,
-31060,
-32626,
-34188,
-35663,
-37036,
-38298,
-39437,
-40468,
-41352,
-42070,
-42560,
-42780,
-42706,
-42344,
-41785,
-41115,
-40511,
-40094,
-40003,
-40286,
-40941,
-41891,
-43023,
-44200,
-45322,
-46296,
-47111,
-47739,
-48196,
-48451,
-48445,
-48076,
-47219,
-45766,
-43658,
-40911,
-37631,
-34009,
-30283,
-26692,
-23446,
-20687,
-18479,
-16838,
-15705,
-15059,
-14822,
-15004,
-15555,
-16466,
-17666,
-19060,
-20502,
-21844,
-22926,
-23663,
-24000,
-24001,
-23747,
-23377,
-23023,
-22765,
-22671,
-22724,
-22922,
-23221,
-23634,
-24176,
-24896,
-25862,
-27101,
-28638,
-30412,
-32359,
-34328,
-36208,
-37830,
-39105,
-39942,
-40314,
-40250,
-39784,
-39014,
-38010,
-36837,
-35559,
-34171,
-32709,
-31169,
-29619,
-28130,
-26843,
-25892,
-25401,
-25465,
-26066,
-27150,
-28577,
-30190,
-31853,
-33465,
-34977,
-36393,
-37732,
-38991,
-40169,
-41184,
-41984,
-42471,
-42615,
-42418,
-41952,
-41335,
-40717,
-40239,
-40033,
-40155,
-40633,
-41408,
-42412,
-43529,
-44670,
-45741,
-46692,
-47496,
-48116,
-48543,
-48708,
-48534,
-47928,
-46768,
-45008,
-42607,
-39655,
-36272,
-32673,
-29075,
-25687,
-22686,
-20167,
-18180,
-16708,
-15732,
-15192,
-15085,
-15356,
-16010,
-16983,
-18225,
-19612,
-21040,
-22342,
-23424,
-24183,
-24613,
-24729,
-24629,
-24406,
-24177,
-24025,
-23999,
-24111,
-24365,
-24730,
-25221,
-25847,
-26646,
-27670,
-28952,
-30487,
-32259,
-34148,
-36061,
-37834,
-39336,
-40457,
-41124,
-41318,
-41075,
-40447,
-39531,
-38392,
-37114,
-35740,
-34306,
-32852,
-31393,
-30009,
-28745,
-27730,
-27027,
-26752,
-26930,
-27578,
-28638,
-30017,
-31591,
-33244,
-34863,
-36393,
-37786,
-39048,
-40171,
-41155,
-41974,
-42583,
-42928,
-42975,
-42713,
-42195,
-41526,
-40842,
-40315,
-40068,
-40202,
-40724,
-41588,
-42681,
-43877,
-45041,
-46102,
-46982,
-47687,
-48191,
-48484,
-48509,
-48182,
-47390,
-46042,
-44062,
-41481,
-38358,
-34878,
-31229,
-27648,
-24324,
-21418,
-19006,
-17131,
-15776,
-14912,
-14506,
-14531,
-14964,
-15767,
-16894,
-18237,
-19686,
-21083,
-22281,
-23172,
-23678,
-23814,
-23637,
-23262,
-22816,
-22422,
-22164,
-22086,
-22201,
-22486,
-22927,
-23513,
-24261,
-25199,
-26373,
-27795,
-29472,
-31341,
-33315,
-35271,
-37053,
-38556,
-39643,
-40301,
-40479,
-40255,
-39652,
-38775,
-37660,
-36387,
-34974,
-33482,
-31942,
-30441,
-29054,
-27899,
-27070,
-26662,
-26714,
-27238,
-28172,
-29447,
-30934,
-32549,
-34169,
-35763,
-37254,
-38660,
-39931,
-41074,
-42040,
-42775,
-43244,
-43379,
-43198,
-42724,
-42050,
-41314,
-40662,
-40245,
-40159,
-40468,
-41125,
-42090,
-43208,
-44403,
-45527,
-46549,
-47399,
-48074,
-48550,
-48782,
-48704,
-48216,
-47217,
-45614,
-43387,
-40559,
-37264,
-33680,
-30032,
-26542,
-23396,
-20713,
-18547,
-16894,
-15710,
-14958,
-14599,
-14624,
-15042,
-15829,
-16958,
-18328,
-19809,
-21250,
-22482,
-23397,
-23940,
-24114,
-24015,
-23734,
-23409,
-23137,
-22988,
-22991,
-23158,
-23471,
-23940,
-24571,
-25389,
-26438,
-27732,
-29284,
-31044,
-32947,
-34864,
-36676,
-38229,
-39433,
-40200,
-40525,
-40427,
-39969,
-39221,
-38248,
-37095,
-35788,
-34345,
-32790,
-31166,
-29558,
-28077,
-26845,
-25992,
-25602,
-25720,
-26341,
-27380,
-28757,
-30337,
-32007,
-33686,
-35281,
-36779,
-38135,
-39350,
-40408,
-41280,
-41938,
-42348,
-42476,
-42333,
-41938,
-41374,
-40749,
-40208,
-39863,
-39852,
-40192,
-40904,
-41897,
-43067,
-44284,
-45432,
-46432,
-47238,
-47836,
-48212,
-48335,
-48140,
-47533,
-46386,
-44630,
-42208,
-39190,
-35713,
-31988,
-28288,
-24830,
-21832,
-19366,
-17491,
-16134,
-15256,
-14769,
-14656,
-14886,
-15483,
-16416,
-17645,
-19070,
-20538,
-21899,
-22999,
-23742,
-24110,
-24136,
-23937,
-23635,
-23342,
-23169,
-23136,
-23272,
-23545,
-23945,
-24467,
-25132,
-25978,
-27046,
-28370,
-29939,
-31712,
-33600,
-35483,
-37239,
-38739,
-39890,
-40632,
-40940,
-40836,
-40348,
-39544,
-38473,
-37195,
-35761,
-34216,
-32618,
-31018,
-29504,
-28165,
-27106,
-26436,
-26221,
-26509,
-27277,
-28448,
-29913,
-31523,
-33163,
-34726,
-36171,
-37486,
-38694,
-39806,
-40822,
-41690,
-42358,
-42738,
-42797,
-42531,
-42013,
-41369,
-40755,
-40326,
-40204,
-40437,
-41031,
-41895,
-42952,
-44069,
-45173,
-46183,
-47074,
-47817,
-48393,
-48759,
-48842,
-48544,
-47742,
-46349,
-44295,
-41605,
-38383,
-34803,
-31119,
-27556,
-24348,
-21618,
-19432,
-17766,
-16550,
-15732,
-15257,
-15141,
-15402,
-16072,
-17133,
-18505,
-20037,
-21549,
-22843,
-23801,
-24345,
-24535,
-24441,
-24225,
-23986,
-23819,
-23754,
-23790,
-23914,
-24130,
-24454,
-24943,
-25651,
-26625,
-27880,
-29400,
-31115,
-32957,
-34818,
-36594,
-38203,
-39530,
-40530,
-41115,
-41282,
-41006,
-40351,
-39349,
-38110,
-36684,
-35165,
-33588,
-32008,
-30472,
-29044,
-27809,
-26865,
-26313,
-26225,
-26642,
-27521,
-28803,
-30343,
-32024,
-33710,
-35310,
-36772,
-38086,
-39249,
-40286,
-41185,
-41927,
-42461,
-42747,
-42743,
-42462,
-41958,
-41334,
-40746,
-40330,
-40235,
-40505,
-41165,
-42130,
-43291,
-44517,
-45680,
-46707,
-47555,
-48203,
-48656,
-48856,
-48757,
-48230,
-47164,
-45471,
-43101,
-40130,
-36680,
-32974,
-29253,
-25745,
-22629,
-20011,
-17921,
-16345,
-15239,
-14567,
-14308,
-14457,
-15014,
-15945,
-17197,
-18634,
-20133,
-21500,
-22634,
-23408,
-23834,
-23934,
-23815,
-23579,
-23341,
-23161,
-23097,
-23143,
-23312,
-23596,
-24027,
-24628,
-25462,
-26552,
-27925,
-29556,
-31383,
-33323,
-35242,
-37039,
-38583,
-39805,
-40627,
-41040,
-41031,
-40640,
-39900,
-38876,
-37612,
-36183,
-34628,
-33022,
-31425,
-29909,
-28569,
-27490,
-26762,
-26465,
-26626,
-27262,
-28306,
-29689,
-31272,
-32949,
-34607,
-36170,
-37607,
-38909,
-40086,
-41145,
-42067,
-42799,
-43298,
-43483,
-43350,
-42917,
-42282,
-41593,
-41014,
-40701,
-40761,
-41217,
-42023,
-43078,
-44231,
-45380,
-46406,
-47281,
-47980,
-48510,
-48850,
-48960,
-48737,
-48078,
-46850,
-44993,
-42474,
-39394,
-35897,
-32218,
-28600,
-25267,
-22379,
-20027,
-18208,
-16897,
-16007,
-15520,
-15382,
-15632,
-16257,
-17253,
-18549,
-20022,
-21498,
-22803,
-23787,
-24370,
-24563,
-24442,
-24137,
-23788,
-23497,
-23341,
-23315,
-23431,
-23641,
-23972,
-24419,
-25050,
-25897,
-27011,
-28387,
-30003,
-31780,
-33623,
-35418,
-37051,
-38425,
-39459,
-40108,
-40350,
-40196,
-39679,
-38837,
-37730,
-36406,
-34911,
-33307,
-31634,
-29982,
-28425,
-27071,
-26028,
-25393,
-25233,
-25572,
-26385,
-27581,
-29068,
-30687,
-32344,
-33924,
-35390,
-36710,
-37901,
-38967,
-39907,
-40686,
-41263,
-41562,
-41566,
-41255,
-40701,
-40029,
-39371,
-38923,
-38785,
-39049,
-39704,
-40679,
-41863,
-43121,
-44350,
-45450,
-46403,
-47154,
-47700,
-47976,
-47907,
-47378,
-46279,
-44527,
-42107,
-39095,
-35649,
-32009,
-28428,
-25135,
-22303,
-20000,
-18238,
-16953,
-16096,
-15620,
-15540,
-15871,
-16640,
-17812,
-19283,
-20880,
-22389,
-23596,
-24378,
-24677,
-24573,
-24194,
-23719,
-23286,
-23001,
-22902,
-22976,
-23225,
-23628,
-24214,
-25024,
-26080,
-27408,
-28972,
-30722,
-32562,
-34404,
-36141,
-37691,
-38963,
-39885,
-40391,
-40439,
-40020,
-39169,
-37950,
-36467,
-34826,
-33121,
-31446,
-29850,
-28417,
-27200,
-26299,
-25791,
-25763,
-26229,
-27190,
-28539,
-30161,
-31909,
-33645,
-35286,
-36785,
-38130,
-39343,
-40404,
-41309,
-41984,
-42381,
-42447,
-42183,
-41659,
-40999,
-40384,
-39992,
-39963,
-40377,
-41192,
-42323,
-43590,
-44852,
-45966,
-46888,
-47591,
-48122,
-48448,
-48558,
-48300,
-47529,
-46077,
-43845,
-40852,
-37255,
-33301,
-29322,
-25598,
-22357,
-19707,
-17647,
-16135,
-15082,
-14454,
-14235,
-14444,
-15094,
-16143,
-17510,
-19029,
-20524,
-21815,
-22773,
-23342,
-23540,
-23450,
-23180,
-22863,
-22586,
-22440,
-22459,
-22672,
-23085,
-23707,
-24543,
-25608,
-26907,
-28433,
-30169,
-32044,
-33985,
-35863,
-37558,
-38947,
-39940,
-40481,
-40567,
-40223,
-39512,
-38488,
-37229,
-35767,
-34174,
-32498,
-30810,
-29229,
-27847,
-26807,
-26208,
-26109,
-26543,
-27442,
-28734,
-30275,
-31940,
-33619,
-35222,
-36734,
-38123,
-39410,
-40569,
-41567,
-42338,
-42808,
-42918,
-42674,
-42127,
-41427,
-40747,
-40278,
-40178,
-40509,
-41272,
-42353,
-43614,
-44900,
-46074,
-47067,
-47837,
-48383,
-48699,
-48744,
-48443,
-47699,
-46390,
-44452,
-41868,
-38723,
-35172,
-31451,
-27792,
-24433,
-21539,
-19201,
-17464,
-16285,
-15638,
-15455,
-15711,
-16362,
-17365,
-18636,
-20060,
-21478,
-22741,
-23698,
-24290,
-24497,
-24411,
-24149,
-23852,
-23643,
-23580,
-23687,
-23941,
-24304,
-24773,
-25362,
-26134,
-27153,
-28475,
-30109,
-32002,
-34041,
-36066,
-37904,
-39398,
-40448,
-40988,
-41049,
-40661,
-39926,
-38906,
-37689,
-36314,
-34834,
-33286,
-31720,
-30228,
-28901,
-27859,
-27218,
-27033,
-27362,
-28136,
-29299,
-30708,
-32246,
-33806,
-35307,
-36727,
-38052,
-39282,
-40409,
-41374,
-42137,
-42604,
-42752,
-42557,
-42110,
-41510,
-40939,
-40547,
-40474,
-40779,
-41459,
-42425,
-43567,
-44750,
-45862,
-46837,
-47631,
-48237,
-48619,
-48748,
-48522,
-47853,
-46627,
-44771,
-42287,
-39244,
-35802,
-32166,
-28570,
-25219,
-22274,
-19836,
-17937,
-16568,
-15716,
-15333,
-15419,
-15927,
-16828,
-18038,
-19444,
-20895,
-22230,
-23301,
-24019,
-24351,
-24349,
-24123,
-23789,
-23498,
-23309,
-23296,
-23426,
-23714,
-24106,
-24648,
-25352,
-26304,
-27544,
-29111,
-30956,
-32993,
-35057,
-36975,
-38573,
-39731,
-40381,
-40534,
-40240,
-39583,
-38641,
-37469,
-36121,
-34606,
-32985,
-31297,
-29652,
-28169,
-26990,
-26240,
-26010,
-26315,
-27127,
-28337,
-29820,
-31445,
-33078,
-34666,
-36146,
-37527,
-38797,
-39951,
-40955,
-41745,
-42270,
-42459,
-42324,
-41893,
-41291,
-40661,
-40185,
-39999,
-40199,
-40802,
-41740,
-42905,
-44157,
-45362,
-46441,
-47323,
-47999,
-48436,
-48605,
-48428,
-47805,
-46641,
-44841,
-42413,
-39399,
-35965,
-32303,
-28660,
-25234,
-22217,
-19690,
-17722,
-16291,
-15390,
-14980,
-15041,
-15540,
-16431,
-17644,
-19060,
-20548,
-21938,
-23095,
-23917,
-24353,
-24453,
-24286,
-23993,
-23691,
-23494,
-23453,
-23601,
-23908,
-24371,
-24965,
-25720,
-26669,
-27867,
-29339,
-31080,
-33013,
-35011,
-36920,
-38549,
-39787,
-40511,
-40734,
-40474,
-39832,
-38904,
-37777,
-36520,
-35163,
-33720,
-32218,
-30683,
-29214,
-27920,
-26948,
-26438,
-26481,
-27109,
-28258,
-29799,
-31551,
-33342,
-35026,
-36546,
-37878,
-39078,
-40179,
-41195,
-42085,
-42755,
-43108,
-43081,
-42670,
-42001,
-41223,
-40587,
-40262,
-40380,
-40951,
-41889,
-43053,
-44266,
-45421,
-46418,
-47263,
-47941,
-48459,
-48760,
-48740,
-48260,
-47178,
-45404,
-42923,
-39838,
-36314,
-32602,
-28939,
-25530,
-22540,
-20022,
-18015,
-16497,
-15457,
-14878,
-14787,
-15155,
-15991,
-17195,
-18659,
-20199,
-21636,
-22790,
-23569,
-23916,
-23907,
-23626,
-23233,
-22843,
-22575,
-22462,
-22537,
-22773,
-23179,
-23737,
-24493,
-25464,
-26687,
-28173,
-29884,
-31752,
-33669,
-35496,
-37108,
-38380,
-39232,
-39614,
-39534,
-39012,
-38119,
-36916,
-35479,
-33890,
-32205,
-30517,
-28896,
-27450,
-26270,
-25463,
-25103,
-25237,
-25865,
-26933,
-28353,
-30005,
-31769,
-33527,
-35205,
-36743,
-38124,
-39335,
-40383,
-41243,
-41907,
-42334,
-42500,
-42420,
-42125,
-41723,
-41337,
-41122,
-41200,
-41645,
-42448,
-43527,
-44754,
-45969,
-47073,
-47976,
-48679,
-49185,
-49485,
-49531,
-49206,
-48357,
-46836,
-44567,
-41564,
-37997,
-34093,
-30175,
-26501,
-23290,
-20636,
-18556,
-17001,
-15919,
-15264,
-15039,
-15251,
-15903,
-16947,
-18290,
-19763,
-21197,
-22406,
-23287,
-23773,
-23912,
-23776,
-23505,
-23209,
-22992,
-22906,
-22979,
-23206,
-23583,
-24116,
-24830,
-25768,
-26969,
-28446,
-30190,
-32115,
-34123,
-36063,
-37791,
-39192,
-40168,
-40691,
-40757,
-40394,
-39654,
-38580,
-37238,
-35677,
-33979,
-32217,
-30494,
-28916,
-27588,
-26599,
-26043,
-25942,
-26332,
-27169,
-28395,
-29912,
-31616,
-33378,
-35127,
-36756,
-38258,
-39572,
-40711,
-41628,
-42304,
-42689,
-42762,
-42521,
-42031,
-41396,
-40778,
-40343,
-40220,
-40516,
-41195,
-42219,
-43428,
-44689,
-45876,
-46887,
-47699,
-48284,
-48640,
-48738,
-48488,
-47803,
-46542,
-44635,
-42050,
-38855,
-35227,
-31384,
-27609,
-24126,
-21140,
-18722,
-16926,
-15680,
-14954,
-14673,
-14816,
-15345,
-16245,
-17441,
-18834,
-20275,
-21587,
-22636,
-23313,
-23623,
-23606,
-23406,
-23133,
-22926,
-22841,
-22902,
-23112,
-23432,
-23888,
-24485,
-25301,
-26369,
-27753,
-29420,
-31328,
-33353,
-35356,
-37194,
-38715,
-39838,
-40484,
-40656,
-40369,
-39685,
-38670,
-37401,
-35961,
-34394,
-32785,
-31178,
-29653,
-28312,
-27244,
-26576,
-26376,
-26696,
-27508,
-28732,
-30242,
-31889,
-33549,
-35123,
-36573,
-37892,
-39099,
-40197,
-41170,
-41961,
-42510,
-42743,
-42652,
-42252,
-41648,
-40999,
-40455,
-40205,
-40322,
-40870,
-41775,
-42947,
-44227,
-45483,
-46598,
-47509,
-48174,
-48584,
-48699,
-48462,
-47787,
-46566,
-44729,
-42253,
-39209,
-35752,
-32097,
-28484,
-25140,
-22214,
-19817,
-17958,
-16630,
-15801,
-15438,
-15529,
-16045,
-16951,
-18156,
-19543,
-20954,
-22226,
-23227,
-23879,
-24174,
-24165,
-23968,
-23693,
-23460,
-23331,
-23349,
-23498,
-23779,
-24171,
-24692,
-25386,
-26311,
-27512,
-29030,
-30817,
-32802,
-34831,
-36736,
-38339,
-39505,
-40148,
-40262,
-39895,
-39135,
-38076,
-36812,
-35382,
-33841,
-32208,
-30555,
-28968,
-27603,
-26599,
-26116,
-26215,
-26913,
-28108,
-29653,
-31358,
-33078,
-34691,
-36177,
-37525,
-38772,
-39902,
-40894,
-41653,
-42115,
-42213,
-41975,
-41491,
-40919,
-40446,
-40235,
-40382,
-40907,
-41748,
-42784,
-43911,
-45008,
-46039,
-46937,
-47712,
-48269,
-48564,
-48428,
-47744,
-46368,
-44251,
-41418,
-38004,
-34219,
-30327,
-26585,
-23209,
-20347,
-18070,
-16392,
-15289,
-14734,
-14684,
-15116,
-15971,
-17176,
-18597,
-20084,
-21438,
-22525,
-23216,
-23507,
-23451,
-23161,
-22817,
-22528,
-22430,
-22534,
-22847,
-23329,
-23949,
-24713,
-25650,
-26822,
-28280,
-30025,
-32011,
-34096,
-36125,
-37885,
-39235,
-40053,
-40326,
-40075,
-39391,
-38352,
-37050,
-35536,
-33869,
-32105,
-30329,
-28659,
-27236,
-26206,
-25689,
-25739,
-26356,
-27449,
-28896,
-30548,
-32269,
-33970,
-35583,
-37102,
-38497,
-39773,
-40859,
-41706,
-42227,
-42378,
-42161,
-41652,
-40997,
-40386,
-40005,
-39995,
-40414,
-41229,
-42333,
-43582,
-44834,
-45992,
-46992,
-47805,
-48407,
-48720,
-48658,
-48068,
-46833,
-44874,
-42205,
-38954,
-35320,
-31576,
-27957,
-24681,
-21869,
-19582,
-17832,
-16607,
-15901,
-15713,
-16040,
-16847,
-18049,
-19522,
-21067,
-22515,
-23680,
-24474,
-24862,
-24903,
-24703,
-24398,
-24121,
-23959,
-23977,
-24186,
-24579,
-25162,
-25914,
-26871,
-28044,
-29452,
-31098,
-32930,
-34858,
-36761,
-38467,
-39839,
-40737,
-41110,
-40929,
-40284,
-39235,
-37932,
-36445,
-34874,
-33261,
-31661,
-30138,
-28788,
-27725,
-27089,
-26969,
-27414,
-28377,
-29747,
-31367,
-33065,
-34730,
-36284,
-37721,
-39057,
-40288,
-41388,
-42277,
-42857,
-43048,
-42840,
-42295,
-41573,
-40875,
-40398,
-40301,
-40636,
-41378,
-42420,
-43627,
-44862,
-46022,
-47038,
-47861,
-48440,
-48714,
-48572,
-47923,
-46652,
-44716,
-42124,
-38979,
-35454,
-31768,
-28152,
-24808,
-21876,
-19453,
-17560,
-16199,
-15360,
-15021,
-15179,
-15796,
-16821,
-18135,
-19592,
-20996,
-22186,
-23011,
-23440,
-23482,
-23266,
-22919,
-22604,
-22418,
-22412,
-22600,
-22943,
-23429,
-24067,
-24880,
-25953,
-27315,
-28992,
-30935,
-33014,
-35079,
-36929,
-38419,
-39418,
-39906,
-39872,
-39406,
-38568,
-37453,
-36118,
-34625,
-33019,
-31379,
-29787,
-28375,
-27270,
-26611,
-26487,
-26948,
-27953,
-29408,
-31156,
-33023,
-34860,
-36551,
-38055,
-39373,
-40530,
-41559,
-42427,
-43103,
-43482,
-43522,
-43195,
-42598,
-41869,
-41247,
-40919,
-41034,
-41628,
-42612,
-43829,
-45100,
-46255,
-47236,
-47987,
-48550,
-48895,
-48963,
-48633,
-47721,
-46103,
-43698,
-40571,
-36905,
-32971,
-29076,
-25481,
-22373,
-19845,
-17911,
-16543,
-15717,
-15407,
-15606,
-16283,
-17361,
-18731,
-20203,
-21604,
-22752,
-23542,
-23941,
-23994,
-23807,
-23499,
-23205,
-22995,
-22938,
-23050,
-23336,
-23822,
-24511,
-25443,
-26646,
-28118,
-29851,
-31772,
-33784,
-35751,
-37522,
-38953,
-39946,
-40417,
-40387,
-39872,
-38974,
-37774,
-36356,
-34794,
-33137,
-31433,
-29767,
-28225,
-26978,
-26142,
-25880,
-26217,
-27157,
-28558,
-30253,
-32034,
-33744,
-35290,
-36657,
-37885,
-39014,
-40066,
-40993,
-41714,
-42129,
-42162,
-41847,
-41262,
-40611,
-40086,
-39877,
-40093,
-40738,
-41743,
-42967,
-44257,
-45494,
-46588,
-47488,
-48177,
-48581,
-48662,
-48267,
-47306,
-45654,
-43274,
-40230,
-36646,
-32785,
-28891,
-25245,
-22050,
-19422,
-17435,
-16033,
-15206,
-14880,
-15025,
-15620,
-16593,
-17887,
-19336,
-20793,
-22048,
-22974,
-23491,
-23613,
-23452,
-23147,
-22850,
-22685,
-22692,
-22896,
-23256,
-23773,
-24446,
-25318,
-26446,
-27860,
-29554,
-31459,
-33447,
-35372,
-37073,
-38434,
-39371,
-39866,
-39917,
-39573,
-38854,
-37834,
-36528,
-35035,
-33389,
-31720,
-30099,
-28663,
-27500,
-26715,
-26374,
-26521,
-27149,
-28217,
-29624,
-31255,
-32978,
-34668,
-36260,
-37695,
-38985,
-40124,
-41095,
-41874,
-42356,
-42522,
-42306,
-41797,
-41126,
-40497,
-40145,
-40216,
-40790,
-41784,
-43055,
-44389,
-45619,
-46637,
-47431,
-48017,
-48426,
-48619,
-48464,
-47799,
-46424,
-44241,
-41268,
-37671,
-33743,
-29805,
-26166,
-23030,
-20483,
-18539,
-17109,
-16170,
-15671,
-15635,
-16079,
-16977,
-18261,
-19766,
-21307,
-22653,
-23671,
-24252,
-24444,
-24330,
-24063,
-23792,
-23615,
-23598,
-23732,
-24007,
-24395,
-24910,
-25579,
-26482,
-27660,
-29164,
-30953,
-32945,
-34994,
-36913,
-38530,
-39695,
-40335,
-40424,
-40027,
-39225,
-38127,
-36827,
-35394,
-33873,
-32317,
-30764,
-29310,
-28055,
-27139,
-26666,
-26729,
-27317,
-28388,
-29805,
-31431,
-33117,
-34774,
-36335,
-37796,
-39150,
-40377,
-41438,
-42239,
-42720,
-42806,
-42534,
-41977,
-41306,
-40719,
-40380,
-40442,
-40909,
-41759,
-42854,
-44066,
-45253,
-46333,
-47247,
-47978,
-48489,
-48725,
-48574,
-47903,
-46567,
-44486,
-41649,
-38195,
-34332,
-30364,
-26587,
-23240,
-20473,
-18337,
-16782,
-15756,
-15190,
-15072,
-15405,
-16204,
-17417,
-18941,
-20566,
-22071,
-23218,
-23894,
-24064,
-23856,
-23446,
-23053,
-22827,
-22836,
-23071,
-23443,
-23896,
-24398,
-24997,
-25802,
-26907,
-28400,
-30242,
-32342,
-34503,
-36514,
-38191,
-39393,
-40073,
-40248,
-39958,
-39294,
-38288,
-37015,
-35501,
-33816,
-32043,
-30288,
-28702,
-27400,
-26526,
-26141,
-26292,
-26947,
-28033,
-29457,
-31076,
-32791,
-34484,
-36095,
-37586,
-38930,
-40133,
-41150,
-41956,
-42482,
-42683,
-42546,
-42118,
-41521,
-40936,
-40545,
-40516,
-40918,
-41725,
-42836,
-44072,
-45296,
-46386,
-47291,
-48018,
-48544,
-48839,
-48783,
-48217,
-46975,
-44952,
-42143,
-38705,
-34868,
-30962,
-27267,
-24009,
-21304,
-19170,
-17579,
-16477,
-15863,
-15724,
-16104,
-16970,
-18259,
-19825,
-21445,
-22925,
-24052,
-24751,
-24995,
-24894,
-24575,
-24211,
-23926,
-23800,
-23862,
-24098,
-24489,
-25036,
-25749,
-26682,
-27873,
-29352,
-31095,
-33025,
-35012,
-36899,
-38517,
-39737,
-40468,
-40696,
-40450,
-39805,
-38848,
-37651,
-36289,
-34798,
-33231,
-31636,
-30101,
-28740,
-27685,
-27062,
-26962,
-27408,
-28360,
-29700,
-31277,
-32944,
-34561,
-36080,
-37450,
-38709,
-39838,
-40848,
-41661,
-42238,
-42475,
-42384,
-41982,
-41392,
-40798,
-40358,
-40263,
-40557,
-41267,
-42278,
-43464,
-44671,
-45756,
-46663,
-47323,
-47755,
-47914,
-47769,
-47219,
-46161,
-44478,
-42130,
-39128,
-35630,
-31830,
-28030,
-24461,
-21368,
-18841,
-16949,
-15639,
-14873,
-14593,
-14777,
-15400,
-16431,
-17779,
-19301,
-20807,
-22086,
-22982,
-23408,
-23398,
-23065,
-22585,
-22131,
-21828,
-21755,
-21905,
-22274,
-22825,
-23577,
-24557,
-25811,
-27364,
-29192,
-31209,
-33273,
-35213,
-36852,
-38071,
-38788,
-39000,
-38746,
-38093,
-37115,
-35864,
-34397,
-32758,
-31030,
-29326,
-27802,
-26636,
-25989,
-25965,
-26582,
-27762,
-29346,
-31152,
-32999,
-34772,
-36421,
-37935,
-39339,
-40606,
-41698,
-42514,
-42975,
-43034,
-42725,
-42179,
-41571,
-41109,
-40942,
-41146,
-41711,
-42545,
-43545,
-44602,
-45640,
-46612,
-47468,
-48133,
-48492,
-48392,
-47674,
-46218,
-43978,
-41014,
-37492,
-33647,
-29749,
-26057,
-22770,
-20038,
-17904,
-16410,
-15512,
-15196,
-15408,
-16092,
-17168,
-18507,
-19957,
-21331,
-22471,
-23238,
-23601,
-23595,
-23332,
-22987,
-22685,
-22560,
-22644,
-22941,
-23432,
-24092,
-24959,
-26067,
-27482,
-29217,
-31216,
-33364,
-35449,
-37277,
-38667,
-39512,
-39802,
-39589,
-38966,
-38024,
-36833,
-35426,
-33837,
-32114,
-30347,
-28684,
-27292,
-26335,
-25943,
-26154,
-26941,
-28188,
-29739,
-31453,
-33190,
-34876,
-36462,
-37929,
-39252,
-40394,
-41275,
-41838,
-42023,
-41842,
-41386,
-40795,
-40294,
-40047,
-40214,
-40812,
-41796,
-43017,
-44309,
-45524,
-46563,
-47389,
-47980,
-48322,
-48343,
-47919,
-46919,
-45200,
-42723,
-39549,
-35844,
-31886,
-27954,
-24331,
-21203,
-18700,
-16849,
-15656,
-15084,
-15089,
-15625,
-16595,
-17895,
-19347,
-20791,
-22034,
-22966,
-23514,
-23707,
-23625,
-23403,
-23162,
-23022,
-23036,
-23236,
-23615,
-24171,
-24911,
-25872,
-27097,
-28626,
-30451,
-32513,
-34661,
-36724,
-38476,
-39751,
-40434,
-40497,
-40007,
-39059,
-37793,
-36309,
-34694,
-33015,
-31330,
-29742,
-28362,
-27339,
-26796,
-26805,
-27377,
-28421,
-29819,
-31405,
-33058,
-34683,
-36250,
-37729,
-39116,
-40357,
-41382,
-42115,
-42474,
-42458,
-42122,
-41583,
-41033,
-40636,
-40547,
-40854,
-41552,
-42582,
-43835,
-45157,
-46441,
-47549,
-48402,
-48925,
-49032,
-48667,
-47745,
-46206,
-44037,
-41250,
-37972,
-34352,
-30619,
-27015,
-23738,
-20981,
-18818,
-17318,
-16451,
-16200,
-16495,
-17272,
-18423,
-19818,
-21284,
-22650,
-23748,
-24472,
-24793,
-24765,
-24505,
-24176,
-23907,
-23805,
-23918,
-24240,
-24763,
-25480,
-26390,
-27542,
-28938,
-30593,
-32444,
-34378,
-36259,
-37902,
-39193,
-40009,
-40341,
-40187,
-39611,
-38681,
-37454,
-35991,
-34349,
-32593,
-30838,
-29217,
-27893,
-27034,
-26749,
-27092,
-28013,
-29382,
-31022,
-32756,
-34441,
-36006,
-37438,
-38761,
-39983,
-41095,
-41991,
-42604,
-42820,
-42648,
-42157,
-41528,
-40977,
-40718,
-40878,
-41469,
-42428,
-43570,
-44782,
-45902,
-46901,
-47742,
-48408,
-48836,
-48906,
-48437,
-47289,
-45321,
-42579,
-39163,
-35341,
-31399,
-27628,
-24263,
-21433,
-19207,
-17561,
-16490,
-15939,
-15908,
-16344,
-17208,
-18383,
-19740,
-21087,
-22268,
-23134,
-23634,
-23775,
-23659,
-23407,
-23163,
-23032,
-23071,
-23294,
-23689,
-24246,
-24981,
-25944,
-27195,
-28779,
-30680,
-32801,
-34969,
-36974,
-38594,
-39687,
-40171,
-40086,
-39523,
-38589,
-37412,
-36021,
-34481,
-32802,
-31049,
-29332,
-27809,
-26663,
-26050,
-26057,
-26682,
-27820,
-29333,
-31027,
-32773,
-34461,
-36052,
-37534,
-38889,
-40095,
-41081,
-41783,
-42121,
-42101,
-41759,
-41246,
-40729,
-40407,
-40430,
-40861,
-41683,
-42784,
-44015,
-45229,
-46317,
-47216,
-47913,
-48378,
-48563,
-48349,
-47596,
-46141,
-43912,
-40901,
-37285,
-33294,
-29270,
-25498,
-22235,
-19601,
-17651,
-16354,
-15654,
-15517,
-15884,
-16718,
-17928,
-19378,
-20888,
-22259,
-23311,
-23955,
-24174,
-24059,
-23755,
-23418,
-23196,
-23151,
-23340,
-23720,
-24303,
-25064,
-26025,
-27230,
-28692,
-30423,
-32358,
-34386,
-36348,
-38068,
-39391,
-40205,
-40476,
-40217,
-39518,
-38452,
-37133,
-35614,
-33980,
-32279,
-30625,
-29114,
-27926,
-27166,
-26963,
-27325,
-28198,
-29467,
-30961,
-32556,
-34139,
-35685,
-37183,
-38638,
-40018,
-41236,
-42184,
-42743,
-42853,
-42539,
-41933,
-41229,
-40653,
-40394,
-40553,
-41144,
-42087,
-43243,
-44485,
-45672,
-46731,
-47596,
-48193,
-48478,
-48325,
-47652,
-46352,
-44378,
-41738,
-38543,
-34946,
-31185,
-27490,
-24094,
-21158,
-18817,
-17102,
-16030,
-15567,
-15655,
-16231,
-17209,
-18463,
-19868,
-21244,
-22442,
-23323,
-23825,
-23948,
-23779,
-23444,
-23089,
-22833,
-22757,
-22889,
-23231,
-23788,
-24568,
-25606,
-26937,
-28564,
-30447,
-32480,
-34495,
-36321,
-37766,
-38746,
-39176,
-39112,
-38581,
-37684,
-36480,
-35029,
-33381,
-31607,
-29789,
-28086,
-26633,
-25612,
-25138,
-25272,
-25996,
-27204,
-28761,
-30485,
-32271,
-33997,
-35649,
-37194,
-38627,
-39910,
-40965,
-41716,
-42076,
-42043,
-41675,
-41119,
-40592,
-40268,
-40335,
-40810,
-41683,
-42821,
-44084,
-45354,
-46531,
-47586,
-48466,
-49111,
-49407,
-49187,
-48291,
-46603,
-44095,
-40892,
-37195,
-33305,
-29494,
-26013,
-23002,
-20542,
-18640,
-17289,
-16479,
-16214,
-16483,
-17236,
-18392,
-19778,
-21217,
-22508,
-23497,
-24108,
-24332,
-24261,
-23996,
-23686,
-23427,
-23299,
-23341,
-23565,
-23998,
-24655,
-25592,
-26840,
-28425,
-30310,
-32401,
-34537,
-36532,
-38191,
-39376,
-40014,
-40115,
-39745,
-39003,
-37965,
-36707,
-35237,
-33604,
-31849,
-30084,
-28469,
-27186,
-26415,
-26261,
-26741,
-27775,
-29205,
-30848,
-32551,
-34194,
-35748,
-37195,
-38545,
-39783,
-40843,
-41651,
-42111,
-42186,
-41904,
-41386,
-40802,
-40377,
-40269,
-40596,
-41351,
-42435,
-43705,
-44974,
-46129,
-47072,
-47794,
-48281,
-48509,
-48406,
-47827,
-46627,
-44662,
-41906,
-38442,
-34505,
-30399,
-26481,
-23018,
-20199,
-18078,
-16615,
-15737,
-15360,
-15445,
-15961,
-16894,
-18152,
-19611,
-21054,
-22294,
-23141,
-23548,
-23540,
-23268,
-22910,
-22642,
-22572,
-22735,
-23105,
-23633,
-24295,
-25107,
-26133,
-27439,
-29068,
-30996,
-33102,
-35234,
-37158,
-38711,
-39735,
-40194,
-40088,
-39514,
-38540,
-37290,
-35814,
-34192,
-32477,
-30759,
-29147,
-27786,
-26826,
-26379,
-26522,
-27231,
-28418,
-29943,
-31639,
-33377,
-35059,
-36639,
-38106,
-39432,
-40596,
-41504,
-42104,
-42316,
-42157,
-41697,
-41098,
-40550,
-40249,
-40328,
-40829,
-41714,
-42871,
-44153,
-45434,
-46595,
-47565,
-48275,
-48660,
-48631,
-48090,
-46939,
-45127,
-42643,
-39586,
-36093,
-32389,
-28702,
-25243,
-22214,
-19719,
-17851,
-16617,
-16010,
-15979,
-16465,
-17370,
-18583,
-19966,
-21346,
-22586,
-23528,
-24119,
-24324,
-24224,
-23923,
-23569,
-23293,
-23186,
-23297,
-23634,
-24188,
-24957,
-25962,
-27226,
-28771,
-30567,
-32538,
-34538,
-36404,
-37966,
-39093,
-39742,
-39895,
-39616,
-38954,
-37960,
-36672,
-35121,
-33370,
-31521,
-29735,
-28190,
-27073,
-26500,
-26534,
-27133,
-28194,
-29589,
-31163,
-32844,
-34524,
-36191,
-37777,
-39231,
-40478,
-41415,
-41985,
-42148,
-41947,
-41493,
-40952,
-40505,
-40331,
-40518,
-41123,
-42076,
-43274,
-44583,
-45847,
-46970,
-47835,
-48380,
-48498,
-48096,
-47055,
-45269,
-42724,
-39466,
-35681,
-31645,
-27670,
-24065,
-21061,
-18764,
-17194,
-16282,
-15941,
-16088,
-16664,
-17609,
-18843,
-20231,
-21600,
-22746,
-23531,
-23871,
-23833,
-23546,
-23216,
-23011,
-23036,
-23320,
-23811,
-24460,
-25237,
-26177,
-27358,
-28849,
-30670,
-32737,
-34867,
-36833,
-38393,
-39387,
-39749,
-39513,
-38775,
-37664,
-36267,
-34677,
-32941,
-31157,
-29426,
-27924,
-26790,
-26183,
-26139,
-26671,
-27658,
-28993,
-30540,
-32195,
-33917,
-35630,
-37313,
-38862,
-40180,
-41161,
-41709,
-41831,
-41586,
-41131,
-40657,
-40354,
-40355,
-40736,
-41471,
-42489,
-43684,
-44931,
-46142,
-47210,
-48073,
-48612,
-48753,
-48333,
-47278,
-45462,
-42902,
-39648,
-35878,
-31841,
-27827,
-24121,
-20967,
-18495,
-16787,
-15783,
-15432,
-15614,
-16230,
-17191,
-18377,
-19686,
-20964,
-22075,
-22889,
-23342,
-23444,
-23289,
-23027,
-22817,
-22800,
-23022,
-23527,
-24245,
-25178,
-26297,
-27623,
-29197,
-31001,
-32983,
-35015,
-36898,
-38457,
-39521,
-40026,
-39967,
-39417,
-38468,
-37196,
-35689,
-33976,
-32173,
-30381,
-28796,
-27603,
-26983,
-27015,
-27698,
-28891,
-30443,
-32136,
-33863,
-35531,
-37134,
-38673,
-40101,
-41362,
-42311,
-42860,
-42940,
-42607,
-42014,
-41388,
-40964,
-40921,
-41335,
-42163,
-43304,
-44582,
-45881,
-47078,
-48121,
-48956,
-49499,
-49663,
-49291,
-48265,
-46483,
-43940,
-40725,
-37030,
-33097,
-29211,
-25613,
-22508,
-20033,
-18237,
-17149,
-16710,
-16870,
-17519,
-18544,
-19797,
-21121,
-22367,
-23385,
-24099,
-24451,
-24490,
-24290,
-23984,
-23706,
-23566,
-23648,
-23981,
-24578,
-25430,
-26542,
-27922,
-29576,
-31479,
-33550,
-35647,
-37584,
-39150,
-40189,
-40605,
-40399,
-39657,
-38500,
-37055,
-35426,
-33685,
-31895,
-30153,
-28574,
-27340,
-26607,
-26500,
-27043,
-28151,
-29655,
-31350,
-33056,
-34673,
-36164,
-37551,
-38844,
-40012,
-40968,
-41593,
-41799,
-41586,
-41056,
-40435,
-39939,
-39810,
-40115,
-40862,
-41910,
-43092,
-44264,
-45332,
-46265,
-47058,
-47672,
-48005,
-47887,
-47123,
-45548,
-43118,
-39905,
-36131,
-32092,
-28107,
-24446,
-21320,
-18826,
-17029,
-15926,
-15500,
-15712,
-16474,
-17658,
-19087,
-20550,
-21864,
-22876,
-23527,
-23831,
-23872,
-23772,
-23645,
-23588,
-23644,
-23866,
-24252,
-24854,
-25691,
-26816,
-28249,
-29987,
-31963,
-34068,
-36136,
-37989,
-39456,
-40415,
-40798,
-40618,
-39923,
-38828,
-37423,
-35816,
-34093,
-32324,
-30623,
-29091,
-27887,
-27137,
-26963,
-27400,
-28399,
-29842,
-31541,
-33327,
-35069,
-36671,
-38147,
-39462,
-40631,
-41591,
-42258,
-42571,
-42489,
-42086,
-41519,
-40998,
-40747,
-40903,
-41507,
-42486,
-43678,
-44922,
-46062,
-47016,
-47743,
-48197,
-48319,
-47988,
-47052,
-45400,
-42964,
-39822,
-36155,
-32232,
-28350,
-24765,
-21656,
-19127,
-17205,
-15913,
-15239,
-15192,
-15737,
-16785,
-18184,
-19717,
-21149,
-22284,
-23012,
-23328,
-23320,
-23144,
-22927,
-22809,
-22809,
-22972,
-23274,
-23751,
-24437,
-25414,
-26730,
-28412,
-30384,
-32536,
-34658,
-36573,
-38095,
-39118,
-39594,
-39547,
-39018,
-38104,
-36846,
-35347,
-33650,
-31865,
-30101,
-28497,
-27218,
-26396,
-26138,
-26480,
-27386,
-28751,
-30431,
-32270,
-34125,
-35897,
-37516,
-38939,
-40131,
-41049,
-41636,
-41874,
-41751,
-41355,
-40802,
-40301,
-40008,
-40111,
-40631,
-41573,
-42799,
-44161,
-45504,
-46679,
-47605,
-48184,
-48329,
-47934,
-46868,
-45046,
-42441,
-39138,
-35345,
-31344,
-27461,
-23954,
-21030,
-18734,
-17093,
-16027,
-15512,
-15508,
-16002,
-16955,
-18254,
-19741,
-21186,
-22380,
-23174,
-23520,
-23504,
-23269,
-23003,
-22845,
-22863,
-23075,
-23441,
-23957,
-24654,
-25600,
-26887,
-28553,
-30557,
-32764,
-34957,
-36906,
-38406,
-39346,
-39696,
-39518,
-38894,
-37923,
-36661,
-35175,
-33499,
-31740,
-30004,
-28469,
-27297,
-26627,
-26546,
-27037,
-28042,
-29426,
-31056,
-32812,
-34583,
-36308,
-37920,
-39358,
-40570,
-41467,
-42019,
-42179,
-42005,
-41555,
-41015,
-40514,
-40264,
-40353,
-40861,
-41751,
-42935,
-44280,
-45625,
-46855,
-47832,
-48475,
-48684,
-48347,
-47381,
-45682,
-43236,
-40103,
-36435,
-32505,
-28581,
-24979,
-21892,
-19459,
-17709,
-16607,
-16095,
-16119,
-16623,
-17554,
-18818,
-20270,
-21708,
-22946,
-23801,
-24226,
-24244,
-24010,
-23695,
-23479,
-23467,
-23678,
-24099,
-24663,
-25377,
-26260,
-27394,
-28848,
-30632,
-32674,
-34805,
-36804,
-38451,
-39582,
-40117,
-40070,
-39516,
-38545,
-37251,
-35702,
-33974,
-32152,
-30375,
-28793,
-27591,
-26899,
-26794,
-27274,
-28244,
-29596,
-31173,
-32883,
-34618,
-36339,
-37971,
-39452,
-40694,
-41601,
-42131,
-42253,
-42059,
-41643,
-41196,
-40869,
-40793,
-41048,
-41625,
-42486,
-43542,
-44697,
-45865,
-46954,
-47876,
-48525,
-48784,
-48504,
-47569,
-45874,
-43407,
-40241,
-36546,
-32578,
-28622,
-24957,
-21794,
-19277,
-17438,
-16271,
-15706,
-15686,
-16142,
-17012,
-18198,
-19579,
-20976,
-22218,
-23120,
-23620,
-23691,
-23467,
-23103,
-22793,
-22688,
-22861,
-23329,
-24040,
-24969,
-26086,
-27425,
-29010,
-30848,
-32883,
-34970,
-36923,
-38535,
-39634,
-40157,
-40089,
-39524,
-38549,
-37267,
-35742,
-34029,
-32201,
-30371,
-28710,
-27403,
-26629,
-26488,
-26982,
-28012,
-29417,
-31017,
-32685,
-34341,
-35955,
-37524,
-39004,
-40327,
-41373,
-42040,
-42276,
-42108,
-41685,
-41181,
-40820,
-40756,
-41063,
-41738,
-42679,
-43798,
-44961,
-46118,
-47186,
-48122,
-48828,
-49183,
-49029,
-48216,
-46628,
-44243,
-41130,
-37464,
-33503,
-29521,
-25802,
-22566,
-19973,
-18095,
-16947,
-16483,
-16617,
-17259,
-18275,
-19543,
-20909,
-22219,
-23333,
-24133,
-24573,
-24651,
-24471,
-24142,
-23840,
-23679,
-23759,
-24107,
-24731,
-25597,
-26716,
-28070,
-29687,
-31539,
-33562,
-35629,
-37547,
-39140,
-40229,
-40749,
-40676,
-40106,
-39115,
-37827,
-36296,
-34588,
-32769,
-30940,
-29278,
-27968,
-27220,
-27135,
-27737,
-28894,
-30419,
-32077,
-33712,
-35228,
-36637,
-37985,
-39289,
-40521,
-41563,
-42263,
-42525,
-42306,
-41751,
-41051,
-40494,
-40285,
-40553,
-41273,
-42321,
-43517,
-44713,
-45799,
-46761,
-47560,
-48188,
-48520,
-48410,
-47656,
-46108,
-43716,
-40552,
-36828,
-32827,
-28861,
-25185,
-22004,
-19409,
-17475,
-16190,
-15578,
-15576,
-16150,
-17166,
-18466,
-19853,
-21122,
-22129,
-22776,
-23074,
-23072,
-22883,
-22623,
-22385,
-22263,
-22316,
-22602,
-23182,
-24095,
-25360,
-26968,
-28830,
-30849,
-32861,
-34720,
-36282,
-37442,
-38129,
-38312,
-37987,
-37179,
-35943,
-34365,
-32569,
-30707,
-28952,
-27470,
-26396,
-25816,
-25774,
-26237,
-27166,
-28464,
-30053,
-31830,
-33696,
-35539,
-37250,
-38720,
-39866,
-40636,
-41038,
-41123,
-40993,
-40787,
-40614,
-40628,
-40873,
-41432,
-42281,
-43396,
-44694,
-46074,
-47388,
-48493,
-49203,
-49390,
-48904,
-47692,
-45721,
-43048,
-39779,
-36078,
-32149,
-28223,
-24535,
-21315,
-18755,
-16985,
-16064,
-15960,
-16539,
-17628,
-18978,
-20367,
-21602,
-22542,
-23150,
-23422,
-23436,
-23283,
-23059,
-22866,
-22776,
-22866,
-23190,
-23799,
-24732,
-25987,
-27564,
-29382,
-31365,
-33380,
-35288,
-36961,
-38268,
-39118,
-39441,
-39213,
-38433,
-37168,
-35506,
-33585,
-31592,
-29696,
-28116,
-26978,
-26417,
-26449,
-27060,
-28167,
-29636,
-31346,
-33157,
-34960,
-36678,
-38212,
-39536,
-40564,
-41285,
-41660,
-41718,
-41515,
-41155,
-40785,
-40546,
-40578,
-40964,
-41723,
-42820,
-44124,
-45507,
-46774,
-47762,
-48312,
-48291,
-47597,
-46182,
-44029,
-41194,
-37791,
-34001,
-30050,
-26194,
-22679,
-19717,
-17454,
-15968,
-15251,
-15240,
-15812,
-16826,
-18097,
-19479,
-20782,
-21899,
-22708,
-23183,
-23325,
-23208,
-22937,
-22650,
-22473,
-22530,
-22896,
-23632,
-24745,
-26222,
-28011,
-30026,
-32151,
-34251,
-36152,
-37727,
-38832,
-39406,
-39418,
-38905,
-37935,
-36609,
-35030,
-33308,
-31561,
-29900,
-28460,
-27361,
-26716,
-26605,
-27051,
-28020,
-29432,
-31148,
-33037,
-34956,
-36781,
-38421,
-39788,
-40825,
-41490,
-41774,
-41717,
-41402,
-40982,
-40611,
-40472,
-40678,
-41292,
-42284,
-43549,
-44946,
-46303,
-47480,
-48334,
-48788,
-48728,
-48103,
-46821,
-44846,
-42184,
-38903,
-35177,
-31230,
-27350,
-23809,
-20837,
-18593,
-17140,
-16458,
-16470,
-17043,
-18035,
-19276,
-20614,
-21875,
-22936,
-23687,
-24095,
-24185,
-24040,
-23795,
-23576,
-23523,
-23699,
-24171,
-24929,
-25990,
-27320,
-28918,
-30733,
-32702,
-34713,
-36624,
-38262,
-39489,
-40174,
-40287,
-39827,
-38873,
-37530,
-35908,
-34149,
-32368,
-30709,
-29304,
-28287,
-27763,
-27796,
-28382,
-29456,
-30904,
-32582,
-34364,
-36128,
-37796,
-39297,
-40568,
-41554,
-42189,
-42453,
-42352,
-41989,
-41483,
-41058,
-40844,
-41019,
-41597,
-42567,
-43815,
-45197,
-46557,
-47757,
-48652,
-49129,
-49045,
-48286,
-46759,
-44423,
-41351,
-37696,
-33716,
-29723,
-25995,
-22796,
-20250,
-18433,
-17306,
-16824,
-16893,
-17441,
-18367,
-19555,
-20867,
-22124,
-23182,
-23910,
-24258,
-24275,
-24047,
-23739,
-23485,
-23409,
-23575,
-24025,
-24762,
-25801,
-27148,
-28791,
-30690,
-32749,
-34813,
-36710,
-38245,
-39294,
-39775,
-39691,
-39106,
-38091,
-36746,
-35150,
-33385,
-31563,
-29818,
-28318,
-27241,
-26718,
-26823,
-27534,
-28741,
-30299,
-32039,
-33832,
-35589,
-37250,
-38768,
-40085,
-41117,
-41786,
-42044,
-41918,
-41520,
-41036,
-40669,
-40620,
-40968,
-41747,
-42843,
-44128,
-45445,
-46662,
-47676,
-48407,
-48759,
-48615,
-47858,
-46353,
-44068,
-41022,
-37392,
-33402,
-29367,
-25560,
-22215,
-19491,
-17455,
-16125,
-15489,
-15488,
-16062,
-17092,
-18414,
-19845,
-21164,
-22208,
-22870,
-23149,
-23123,
-22941,
-22744,
-22663,
-22774,
-23101,
-23658,
-24450,
-25504,
-26850,
-28503,
-30427,
-32527,
-34643,
-36585,
-38176,
-39272,
-39810,
-39783,
-39233,
-38230,
-36850,
-35164,
-33299,
-31370,
-29570,
-28092,
-27114,
-26759,
-27075,
-27979,
-29367,
-31039,
-32855,
-34663,
-36400,
-37991,
-39398,
-40552,
-41391,
-41865,
-41955,
-41729,
-41306,
-40861,
-40578,
-40590,
-40970,
-41714,
-42742,
-43971,
-45271,
-46563,
-47729,
-48647,
-49185,
-49143,
-48389,
-46774,
-44304,
-41052,
-37247,
-33161,
-29124,
-25404,
-22236,
-19740,
-17983,
-16966,
-16638,
-16934,
-17734,
-18884,
-20215,
-21517,
-22634,
-23438,
-23889,
-24033,
-23953,
-23782,
-23616,
-23543,
-23606,
-23831,
-24262,
-24926,
-25909,
-27225,
-28901,
-30853,
-32958,
-35025,
-36861,
-38299,
-39211,
-39575,
-39372,
-38682,
-37554,
-36084,
-34359,
-32512,
-30678,
-29045,
-27773,
-27003,
-26814,
-27200,
-28095,
-29372,
-30915,
-32583,
-34310,
-35998,
-37600,
-39024,
-40196,
-41027,
-41475,
-41548,
-41327,
-40956,
-40602,
-40435,
-40561,
-41039,
-41826,
-42876,
-44059,
-45298,
-46451,
-47434,
-48091,
-48305,
-47922,
-46830,
-44976,
-42377,
-39150,
-35486,
-31613,
-27788,
-24216,
-21103,
-18554,
-16686,
-15514,
-15051,
-15244,
-15964,
-17078,
-18357,
-19630,
-20706,
-21491,
-21942,
-22101,
-22043,
-21881,
-21712,
-21630,
-21714,
-22035,
-22654,
-23639,
-25002,
-26748,
-28783,
-30998,
-33217,
-35270,
-37006,
-38315,
-39138,
-39460,
-39285,
-38645,
-37571,
-36133,
-34419,
-32575,
-30778,
-29214,
-28074,
-27463,
-27456,
-28016,
-29071,
-30500,
-32188,
-34015,
-35887,
-37715,
-39387,
-40826,
-41917,
-42597,
-42852,
-42711,
-42297,
-41760,
-41271,
-40995,
-41035,
-41444,
-42209,
-43264,
-44515,
-45842,
-47124,
-48220,
-48999,
-49312,
-49031,
-48054,
-46303,
-43799,
-40595,
-36862,
-32813,
-28717,
-24858,
-21500,
-18857,
-17056,
-16135,
-16028,
-16592,
-17616,
-18890,
-20199,
-21379,
-22333,
-23000,
-23402,
-23561,
-23550,
-23425,
-23271,
-23157,
-23168,
-23385,
-23880,
-24707,
-25886,
-27407,
-29192,
-31164,
-33177,
-35101,
-36794,
-38127,
-39002,
-39352,
-39142,
-38399,
-37176,
-35586,
-33763,
-31884,
-30093,
-28582,
-27449,
-26804,
-26692,
-27107,
-28018,
-29351,
-30998,
-32853,
-34777,
-36652,
-38349,
-39776,
-40853,
-41541,
-41851,
-41816,
-41547,
-41152,
-40789,
-40595,
-40686,
-41150,
-41977,
-43139,
-44507,
-45939,
-47263,
-48299,
-48910,
-48958,
-48362,
-47060,
-45039,
-42331,
-39029,
-35271,
-31293,
-27315,
-23640,
-20475,
-18035,
-16394,
-15583,
-15504,
-16041,
-17002,
-18232,
-19541,
-20807,
-21897,
-22736,
-23281,
-23523,
-23524,
-23355,
-23145,
-23016,
-23075,
-23412,
-24056,
-25034,
-26316,
-27881,
-29680,
-31647,
-33683,
-35667,
-37427,
-38814,
-39681,
-39928,
-39570,
-38626,
-37263,
-35589,
-33791,
-31983,
-30300,
-28826,
-27679,
-26941,
-26709,
-27039,
-27930,
-29335,
-31120,
-33123,
-35162,
-37077,
-38739,
-40081,
-41052,
-41658,
-41906,
-41852,
-41558,
-41159,
-40786,
-40599,
-40731,
-41250,
-42151,
-43358,
-44715,
-46075,
-47269,
-48185,
-48705,
-48772,
-48271,
-47150,
-45314,
-42759,
-39526,
-35792,
-31781,
-27826,
-24204,
-21187,
-18924,
-17464,
-16779,
-16750,
-17268,
-18165,
-19329,
-20576,
-21788,
-22795,
-23503,
-23847,
-23855,
-23625,
-23304,
-23053,
-22995,
-23195,
-23651,
-24319,
-25152,
-26128,
-27262,
-28598,
-30157,
-31934,
-33823,
-35689,
-37315,
-38549,
-39254,
-39413,
-39092,
-38384,
-37435,
-36319,
-35090,
-33756,
-32305,
-30783,
-29249,
-27876,
-26797,
-26209,
-26177,
-26738,
-27792,
-29205,
-30789,
-32409,
-33948,
-35374,
-36691,
-37906,
-39030,
-40017,
-40796,
-41298,
-41452,
-41285,
-40841,
-40284,
-39761,
-39450,
-39459,
-39836,
-40547,
-41504,
-42590,
-43692,
-44726,
-45627,
-46370,
-46887,
-47153,
-47033,
-46462,
-45303,
-43520,
-41105,
-38154,
-34818,
-31324,
-27880,
-24706,
-21940,
-19688,
-17970,
-16805,
-16145,
-15981,
-16261,
-16945,
-17958,
-19189,
-20510,
-21751,
-22783,
-23489,
-23833,
-23839,
-23605,
-23246,
-22907,
-22674,
-22616,
-22744,
-23042,
-23515,
-24148,
-24998,
-26102,
-27497,
-29196,
-31113,
-33150,
-35106,
-36819,
-38113,
-38907,
-39170,
-38953,
-38337,
-37422,
-36276,
-34964,
-33506,
-31952,
-30356,
-28821,
-27478,
-26470,
-25919,
-25889,
-26386,
-27334,
-28619,
-30103,
-31664,
-33208,
-34698,
-36107,
-37432,
-38658,
-39725,
-40590,
-41159,
-41398,
-41285,
-40890,
-40322,
-39752,
-39344,
-39240,
-39521,
-40184,
-41154,
-42308,
-43506,
-44624,
-45579,
-46311,
-46798,
-46997,
-46846,
-46264,
-45142,
-43419,
-41075,
-38181,
-34903,
-31446,
-28061,
-24937,
-22234,
-20000,
-18265,
-16993,
-16181,
-15823,
-15935,
-16513,
-17518,
-18834,
-20306,
-21731,
-22930,
-23781,
-24245,
-24378,
-24289,
-24111,
-23964,
-23910,
-23986,
-24185,
-24500,
-24958,
-25583,
-26449,
-27582,
-29017,
-30695,
-32551,
-34453,
-36261,
-37860,
-39123,
-40002,
-40446,
-40459,
-40053,
-39288,
-38199,
-36886,
-35404,
-33849,
-32303,
-30841,
-29570,
-28565,
-27929,
-27724,
-27995,
-28732,
-29865,
-31292,
-32868,
-34481,
-36021,
-37444,
-38735,
-39890,
-40905,
-41735,
-42313,
-42573,
-42472,
-42044,
-41402,
-40719,
-40204,
-40026,
-40277,
-40956,
-41948,
-43111,
-44277,
-45335,
-46224,
-46935,
-47471,
-47810,
-47876,
-47547,
-46674,
-45145,
-42925,
-40066,
-36749,
-33194,
-29672,
-26403,
-23551,
-21210,
-19398,
-18104,
-17300,
-16954,
-17050,
-17551,
-18404,
-19518,
-20764,
-21994,
-23068,
-23870,
-24353,
-24516,
-24430,
-24193,
-23917,
-23705,
-23608,
-23679,
-23907,
-24307,
-24877,
-25646,
-26645,
-27902,
-29426,
-31165,
-33034,
-34883,
-36550,
-37883,
-38763,
-39140,
-39024,
-38478,
-37588,
-36441,
-35112,
-33635,
-32069,
-30445,
-28847,
-27394,
-26211,
-25445,
-25206,
-25522,
-26386,
-27678,
-29258,
-30971,
-32670,
-34277,
-35748,
-37084,
-38304,
-39395,
-40337,
-41051,
-41486,
-41574,
-41344,
-40865,
-40297,
-39833,
-39645,
-39878,
-40547,
-41605,
-42900,
-44266,
-45536,
-46606,
-47427,
-47996,
-48326,
-48388,
-48114,
-47384,
-46067,
-44077,
-41413,
-38187,
-34609,
-30954,
-27482,
-24418,
-21881,
-19913,
-18490,
-17569,
-17118,
-17115,
-17561,
-18411,
-19591,
-20952,
-22312,
-23485,
-24323,
-24772,
-24846,
-24668,
-24351,
-24046,
-23836,
-23759,
-23840,
-24058,
-24433,
-24993,
-25776,
-26836,
-28169,
-29757,
-31509,
-33326,
-35072,
-36643,
-37926,
-38862,
-39401,
-39521,
-39229,
-38541,
-37517,
-36219,
-34737,
-33161,
-31572,
-30070,
-28715,
-27612,
-26829,
-26457,
-26546,
-27124,
-28133,
-29500,
-31061,
-32695,
-34265,
-35711,
-37010,
-38169,
-39210,
-40106,
-40811,
-41249,
-41350,
-41122,
-40629,
-40046,
-39560,
-39377,
-39601,
-40255,
-41238,
-42393,
-43551,
-44576,
-45432,
-46098,
-46634,
-47026,
-47218,
-47090,
-46448,
-45148,
-43099,
-40330,
-37000,
-33352,
-29671,
-26217,
-23172,
-20638,
-18631,
-17131,
-16113,
-15551,
-15454,
-15826,
-16622,
-17787,
-19156,
-20580,
-21848,
-22835,
-23439,
-23677,
-23622,
-23400,
-23161,
-23000,
-22999,
-23155,
-23459,
-23884,
-24418,
-25099,
-25968,
-27105,
-28530,
-30245,
-32150,
-34119,
-35957,
-37500,
-38608,
-39204,
-39302,
-38940,
-38221,
-37223,
-36030,
-34688,
-33258,
-31774,
-30328,
-29002,
-27912,
-27167,
-26841,
-26967,
-27528,
-28447,
-29636,
-30989,
-32417,
-33871,
-35293,
-36686,
-38006,
-39223,
-40281,
-41090,
-41600,
-41753,
-41571,
-41126,
-40555,
-40034,
-39730,
-39780,
-40230,
-41050,
-42130,
-43323,
-44481,
-45502,
-46326,
-46947,
-47360,
-47542,
-47410,
-46837,
-45682,
-43837,
-41283,
-38128,
-34579,
-30933,
-27464,
-24425,
-21920,
-20008,
-18610,
-17686,
-17156,
-17034,
-17315,
-18018,
-19102,
-20443,
-21883,
-23191,
-24213,
-24828,
-25051,
-24958,
-24717,
-24452,
-24301,
-24281,
-24410,
-24643,
-24969,
-25409,
-26013,
-26859,
-28010,
-29468,
-31198,
-33082,
-34977,
-36727,
-38192,
-39269,
-39906,
-40091,
-39836,
-39201,
-38239,
-37020,
-35631,
-34133,
-32603,
-31127,
-29757,
-28610,
-27749,
-27283,
-27266,
-27739,
-28655,
-29948,
-31465,
-33079,
-34644,
-36095,
-37386,
-38545,
-39590,
-40526,
-41323,
-41905,
-42204,
-42163,
-41824,
-41276,
-40703,
-40301,
-40218,
-40553,
-41268,
-42272,
-43405,
-44527,
-45531,
-46363,
-47019,
-47477,
-47706,
-47599,
-47042,
-45878,
-44048,
-41531,
-38451,
-35009,
-31442,
-28029,
-24934,
-22328,
-20222,
-18652,
-17573,
-16973,
-16847,
-17158,
-17905,
-18975,
-20278,
-21621,
-22852,
-23799,
-24392,
-24602,
-24502,
-24217,
-23868,
-23598,
-23468,
-23521,
-23736,
-24103,
-24606,
-25262,
-26135,
-27252,
-28675,
-30364,
-32246,
-34181,
-35991,
-37511,
-38625,
-39262,
-39453,
-39239,
-38716,
-37935,
-36944,
-35749,
-34364,
-32815,
-31185,
-29584,
-28183,
-27129,
-26562,
-26538,
-27059,
-28048,
-29378,
-30924,
-32538,
-34142,
-35651,
-37051,
-38304,
-39415,
-40346,
-41075,
-41558,
-41770,
-41710,
-41416,
-40985,
-40530,
-40225,
-40164,
-40468,
-41121,
-42075,
-43209,
-44374,
-45444,
-46327,
-46984,
-47398,
-47565,
-47441,
-46947,
-45969,
-44403,
-42188,
-39361,
-36056,
-32496,
-28945,
-25654,
-22804,
-20506,
-18775,
-17592,
-16914,
-16706,
-16953,
-17633,
-18687,
-20022,
-21468,
-22856,
-24001,
-24788,
-25170,
-25207,
-24992,
-24694,
-24408,
-24249,
-24240,
-24383,
-24682,
-25125,
-25757,
-26619,
-27764,
-29209,
-30939,
-32845,
-34815,
-36663,
-38247,
-39441,
-40178,
-40450,
-40300,
-39788,
-38988,
-37959,
-36737,
-35374,
-33886,
-32372,
-30887,
-29588,
-28581,
-27997,
-27907,
-28318,
-29186,
-30396,
-31821,
-33331,
-34822,
-36241,
-37563,
-38791,
-39914,
-40903,
-41704,
-42230,
-42450,
-42316,
-41914,
-41331,
-40757,
-40350,
-40260,
-40557,
-41227,
-42191,
-43321,
-44481,
-45565,
-46506,
-47255,
-47802,
-48086,
-48054,
-47589,
-46598,
-44982,
-42737,
-39906,
-36640,
-33141,
-29631,
-26342,
-23421,
-21008,
-19119,
-17789,
-16970,
-16646,
-16764,
-17298,
-18171,
-19315,
-20590,
-21881,
-23015,
-23892,
-24406,
-24557,
-24384,
-24005,
-23544,
-23145,
-22907,
-22880,
-23084,
-23478,
-24050,
-24771,
-25656,
-26734,
-28034,
-29560,
-31280,
-33090,
-34871,
-36461,
-37734,
-38589,
-38982,
-38922,
-38449,
-37625,
-36517,
-35189,
-33689,
-32093,
-30452,
-28859,
-27406,
-26177,
-25284,
-24793,
-24769,
-25239,
-26176,
-27521,
-29164,
-30965,
-32777,
-34487,
-36004,
-37307,
-38412,
-39342,
-40129,
-40758,
-41191,
-41379,
-41288,
-40953,
-40468,
-39994,
-39719,
-39779,
-40264,
-41128,
-42269,
-43514,
-44710,
-45755,
-46599,
-47279,
-47799,
-48186,
-48344,
-48167,
-47469,
-46116,
-44027,
-41244,
-37915,
-34274,
-30608,
-27147,
-24106,
-21570,
-19582,
-18114,
-17126,
-16569,
-16425,
-16660,
-17259,
-18155,
-19270,
-20482,
-21656,
-22669,
-23428,
-23891,
-24072,
-24034,
-23856,
-23644,
-23458,
-23374,
-23390,
-23548,
-23839,
-24296,
-24955,
-25845,
-27009,
-28441,
-30106,
-31934,
-33786,
-35566,
-37108,
-38345,
-39185,
-39628,
-39668,
-39359,
-38725,
-37830,
-36693,
-35367,
-33881,
-32299,
-30705,
-29193,
-27890,
-26904,
-26333,
-26236,
-26616,
-27434,
-28596,
-30001,
-31529,
-33081,
-34590,
-36016,
-37330,
-38535,
-39595,
-40493,
-41171,
-41587,
-41701,
-41519,
-41081,
-40496,
-39897,
-39444,
-39272,
-39467,
-40047,
-40962,
-42085,
-43296,
-44445,
-45451,
-46252,
-46847,
-47211,
-47344,
-47157,
-46561,
-45432,
-43668,
-41249,
-38233,
-34792,
-31154,
-27593,
-24334,
-21557,
-19329,
-17669,
-16520,
-15836,
-15565,
-15686,
-16188,
-17045,
-18202,
-19545,
-20940,
-22220,
-23250,
-23940,
-24272,
-24294,
-24114,
-23848,
-23624,
-23511,
-23564,
-23777,
-24133,
-24618,
-25218,
-25963,
-26891,
-28043,
-29458,
-31105,
-32937,
-34824,
-36620,
-38164,
-39324,
-40005,
-40202,
-39931,
-39291,
-38365,
-37246,
-35987,
-34638,
-33215,
-31758,
-30336,
-29032,
-27979,
-27296,
-27072,
-27361,
-28119,
-29272,
-30672,
-32188,
-33689,
-35111,
-36405,
-37602,
-38699,
-39715,
-40621,
-41361,
-41864,
-42083,
-41986,
-41643,
-41128,
-40613,
-40233,
-40113,
-40337,
-40875,
-41704,
-42687,
-43752,
-44786,
-45738,
-46571,
-47247,
-47744,
-47978,
-47882,
-47332,
-46254,
-44578,
-42325,
-39557,
-36429,
-33113,
-29811,
-26705,
-23931,
-21598,
-19745,
-18403,
-17560,
-17202,
-17315,
-17847,
-18753,
-19931,
-21261,
-22603,
-23811,
-24759,
-25389,
-25671,
-25676,
-25484,
-25218,
-24983,
-24847,
-24855,
-24993,
-25255,
-25621,
-26104,
-26740,
-27579,
-28680,
-30047,
-31684,
-33472,
-35327,
-37058,
-38545,
-39653,
-40317,
-40528,
-40306,
-39725,
-38851,
-37756,
-36497,
-35117,
-33653,
-32174,
-30725,
-29428,
-28362,
-27651,
-27365,
-27552,
-28195,
-29232,
-30554,
-32034,
-33555,
-35020,
-36379,
-37620,
-38746,
-39770,
-40679,
-41437,
-41989,
-42271,
-42249,
-41943,
-41422,
-40830,
-40322,
-40050,
-40138,
-40593,
-41408,
-42444,
-43590,
-44705,
-45686,
-46494,
-47095,
-47493,
-47658,
-47543,
-47040,
-46061,
-44493,
-42308,
-39550,
-36334,
-32875,
-29394,
-26121,
-23230,
-20829,
-18949,
-17585,
-16692,
-16241,
-16204,
-16567,
-17303,
-18352,
-19617,
-20960,
-22223,
-23266,
-23995,
-24373,
-24453,
-24310,
-24067,
-23825,
-23660,
-23621,
-23713,
-23948,
-24323,
-24863,
-25584,
-26533,
-27701,
-29110,
-30695,
-32405,
-34144,
-35792,
-37259,
-38414,
-39206,
-39558,
-39482,
-38992,
-38171,
-37086,
-35830,
-34468,
-33044,
-31600,
-30166,
-28803,
-27604,
-26688,
-26178,
-26182,
-26725,
-27779,
-29209,
-30861,
-32552,
-34146,
-35579,
-36832,
-37964,
-39006,
-39991,
-40869,
-41587,
-42015,
-42129,
-41878,
-41378,
-40747,
-40190,
-39878,
-39929,
-40379,
-41178,
-42198,
-43318,
-44400,
-45372,
-46203,
-46888,
-47422,
-47777,
-47849,
-47534,
-46669,
-45173,
-42993,
-40202,
-36968,
-33493,
-30050,
-26832,
-24008,
-21661,
-19797,
-18422,
-17489,
-17005,
-16955,
-17338,
-18128,
-19245,
-20578,
-21964,
-23254,
-24295,
-25019,
-25390,
-25454,
-25294,
-25015,
-24719,
-24494,
-24392,
-24448,
-24675,
-25071,
-25647,
-26396,
-27341,
-28484,
-29824,
-31355,
-33016,
-34749,
-36439,
-37970,
-39223,
-40101,
-40532,
-40519,
-40060,
-39248,
-38137,
-36826,
-35384,
-33879,
-32369,
-30914,
-29576,
-28447,
-27593,
-27112,
-27044,
-27420,
-28210,
-29340,
-30720,
-32215,
-33737,
-35197,
-36549,
-37789,
-38910,
-39900,
-40759,
-41400,
-41803,
-41894,
-41688,
-41235,
-40656,
-40111,
-39761,
-39738,
-40086,
-40785,
-41727,
-42789,
-43836,
-44784,
-45599,
-46272,
-46827,
-47224,
-47413,
-47240,
-46576,
-45260,
-43230,
-40509,
-37230,
-33628,
-29968,
-26514,
-23465,
-20934,
-18944,
-17459,
-16416,
-15777,
-15514,
-15649,
-16183,
-17093,
-18303,
-19665,
-20993,
-22110,
-22878,
-23243,
-23254,
-23011,
-22674,
-22365,
-22173,
-22130,
-22206,
-22393,
-22667,
-23071,
-23669,
-24544,
-25746,
-27295,
-29118,
-31115,
-33134,
-35033,
-36687,
-38021,
-38974,
-39544,
-39717,
-39509,
-38940,
-38042,
-36878,
-35513,
-34044,
-32560,
-31145,
-29894,
-28862,
-28128,
-27736,
-27730,
-28130,
-28910,
-30029,
-31391,
-32897,
-34445,
-35949,
-37347,
-38629,
-39759,
-40748,
-41554,
-42149,
-42477,
-42521,
-42266,
-41789,
-41180,
-40596,
-40189,
-40081,
-40350,
-40986,
-41926,
-43040,
-44195,
-45267,
-46173,
-46875,
-47371,
-47655,
-47719,
-47493,
-46896,
-45797,
-44132,
-41840,
-38986,
-35707,
-32196,
-28698,
-25427,
-22542,
-20161,
-18302,
-16973,
-16137,
-15782,
-15871,
-16392,
-17280,
-18462,
-19803,
-21153,
-22369,
-23308,
-23932,
-24214,
-24235,
-24080,
-23869,
-23682,
-23591,
-23605,
-23732,
-23963,
-24296,
-24786,
-25450,
-26400,
-27628,
-29186,
-30992,
-32954,
-34923,
-36728,
-38238,
-39331,
-39980,
-40163,
-39947,
-39367,
-38492,
-37366,
-36020,
-34506,
-32877,
-31214,
-29634,
-28243,
-27173,
-26500,
-26298,
-26560,
-27263,
-28327,
-29657,
-31146,
-32696,
-34223,
-35673,
-37015,
-38224,
-39307,
-40220,
-40958,
-41448,
-41670,
-41592,
-41250,
-40728,
-40157,
-39701,
-39512,
-39680,
-40246,
-41135,
-42246,
-43424,
-44548,
-45526,
-46315,
-46922,
-47324,
-47522,
-47420,
-46932,
-45928,
-44317,
-42084,
-39275,
-36054,
-32618,
-29194,
-25998,
-23159,
-20788,
-18892,
-17487,
-16539,
-16063,
-16038,
-16479,
-17333,
-18543,
-19958,
-21432,
-22761,
-23821,
-24492,
-24781,
-24735,
-24480,
-24151,
-23875,
-23738,
-23772,
-23982,
-24328,
-24793,
-25376,
-26092,
-26987,
-28107,
-29450,
-31036,
-32751,
-34539,
-36227,
-37712,
-38865,
-39618,
-39941,
-39848,
-39390,
-38631,
-37640,
-36476,
-35176,
-33798,
-32360,
-30944,
-29615,
-28487,
-27661,
-27244,
-27280,
-27798,
-28731,
-29990,
-31449,
-32970,
-34466,
-35860,
-37134,
-38294,
-39338,
-40278,
-41067,
-41667,
-42010,
-42057,
-41809,
-41331,
-40722,
-40163,
-39769,
-39714,
-40006,
-40682,
-41620,
-42727,
-43851,
-44903,
-45802,
-46547,
-47123,
-47563,
-47817,
-47853,
-47548,
-46802,
-45516,
-43629,
-41179,
-38248,
-35005,
-31643,
-28355,
-25321,
-22656,
-20451,
-18716,
-17474,
-16692,
-16358,
-16448,
-16921,
-17743,
-18831,
-20105,
-21428,
-22695,
-23755,
-24548,
-24998,
-25133,
-25003,
-24708,
-24366,
-24072,
-23913,
-23911,
-24085,
-24397,
-24835,
-25386,
-26064,
-26902,
-27949,
-29215,
-30718,
-32381,
-34141,
-35848,
-37392,
-38640,
-39515,
-39980,
-40022,
-39702,
-39042,
-38131,
-36999,
-35708,
-34285,
-32794,
-31271,
-29809,
-28483,
-27392,
-26627,
-26253,
-26315,
-26810,
-27696,
-28903,
-30322,
-31857,
-33397,
-34871,
-36233,
-37454,
-38553,
-39507,
-40343,
-41000,
-41477,
-41691,
-41644,
-41327,
-40816,
-40218,
-39694,
-39380,
-39410,
-39821,
-40597,
-41634,
-42804,
-43955,
-44994,
-45845,
-46517,
-47019,
-47368,
-47543,
-47479,
-47047,
-46135,
-44611,
-42450,
-39687,
-36454,
-32975,
-29460,
-26163,
-23223,
-20758,
-18782,
-17285,
-16214,
-15559,
-15279,
-15416,
-15934,
-16842,
-18038,
-19429,
-20828,
-22103,
-23086,
-23731,
-24011,
-24006,
-23818,
-23571,
-23368,
-23274,
-23308,
-23456,
-23697,
-24001,
-24393,
-24889,
-25568,
-26475,
-27658,
-29128,
-30829,
-32693,
-34573,
-36346,
-37873,
-39048,
-39812,
-40130,
-40032,
-39551,
-38750,
-37685,
-36427,
-35014,
-33532,
-32010,
-30558,
-29218,
-28103,
-27265,
-26783,
-26691,
-27005,
-27705,
-28740,
-30041,
-31499,
-33038,
-34543,
-35974,
-37277,
-38456,
-39509,
-40451,
-41266,
-41925,
-42381,
-42580,
-42504,
-42176,
-41674,
-41135,
-40705,
-40526,
-40700,
-41235,
-42095,
-43156,
-44303,
-45399,
-46366,
-47155,
-47760,
-48193,
-48437,
-48468,
-48206,
-47551,
-46417,
-44713,
-42447,
-39662,
-36495,
-33134,
-29781,
-26642,
-23867,
-21558,
-19755,
-18443,
-17594,
-17165,
-17126,
-17461,
-18150,
-19141,
-20367,
-21698,
-23001,
-24120,
-24953,
-25423,
-25559,
-25420,
-25122,
-24784,
-24493,
-24316,
-24264,
-24336,
-24516,
-24814,
-25238,
-25853,
-26675,
-27760,
-29086,
-30624,
-32298,
-34002,
-35644,
-37106,
-38315,
-39205,
-39730,
-39887,
-39663,
-39102,
-38236,
-37124,
-35840,
-34433,
-32972,
-31509,
-30076,
-28759,
-27586,
-26681,
-26090,
-25921,
-26200,
-26928,
-28040,
-29425,
-30951,
-32488,
-33945,
-35280,
-36489,
-37609,
-38642,
-39594,
-40397,
-40982,
-41267,
-41207,
-40828,
-40218,
-39532,
-38944,
-38604,
-38623,
-39010,
-39733,
-40678,
-41739,
-42800,
-43798,
-44678,
-45452,
-46085,
-46593,
-46908,
-46966,
-46671,
-45906,
-44605,
-42720,
-40274,
-37370,
-34155,
-30823,
-27592,
-24622,
-22083,
-20020,
-18495,
-17461,
-16916,
-16799,
-17087,
-17735,
-18692,
-19889,
-21213,
-22552,
-23773,
-24769,
-25479,
-25878,
-25997,
-25904,
-25679,
-25400,
-25137,
-24930,
-24808,
-24795,
-24902,
-25158,
-25596,
-26245,
-27138,
-28290,
-29687,
-31288,
-33023,
-34772,
-36444,
-37883,
-39025,
-39777,
-40121,
-40073,
-39667,
-38967,
-38029,
-36910,
-35634,
-34259,
-32789,
-31305,
-29843,
-28520,
-27412,
-26630,
-26254,
-26316,
-26835,
-27747,
-28971,
-30407,
-31918,
-33440,
-34875,
-36216,
-37448,
-38585,
-39626,
-40552,
-41309,
-41844,
-42085,
-42016,
-41656,
-41090,
-40466,
-39933,
-39652,
-39720,
-40172,
-40958,
-41981,
-43106,
-44204,
-45197,
-46022,
-46688,
-47192,
-47538,
-47683,
-47550,
-47021,
-45986,
-44344,
-42092,
-39261,
-36018,
-32539,
-29056,
-25782,
-22864,
-20422,
-18479,
-17032,
-16060,
-15506,
-15369,
-15611,
-16217,
-17153,
-18333,
-19668,
-21022,
-22253,
-23251,
-23929,
-24266,
-24299,
-24104,
-23799,
-23481,
-23258,
-23165,
-23240,
-23467,
-23833,
-24329,
-24960,
-25750,
-26737,
-27940,
-29368,
-30982,
-32713,
-34465,
-36103,
-37537,
-38635,
-39366,
-39668,
-39573,
-39100,
-38312,
-37281,
-36066,
-34739,
-33339,
-31916,
-30505,
-29156,
-27934,
-26916,
-26211,
-25895,
-26055,
-26685,
-27768,
-29177,
-30801,
-32462,
-34068,
-35516,
-36808,
-37940,
-38959,
-39869,
-40661,
-41278,
-41655,
-41739,
-41519,
-41057,
-40461,
-39896,
-39516,
-39445,
-39750,
-40391,
-41320,
-42380,
-43483,
-44505,
-45401,
-46154,
-46762,
-47232,
-47543,
-47628,
-47403,
-46740,
-45552,
-43767,
-41396,
-38532,
-35303,
-31937,
-28614,
-25547,
-22855,
-20632,
-18897,
-17635,
-16824,
-16422,
-16418,
-16792,
-17520,
-18561,
-19827,
-21210,
-22557,
-23741,
-24636,
-25194,
-25404,
-25333,
-25075,
-24737,
-24433,
-24212,
-24135,
-24193,
-24398,
-24749,
-25257,
-25952,
-26864,
-28006,
-29380,
-30945,
-32639,
-34360,
-36026,
-37503,
-38733,
-39615,
-40129,
-40240,
-39977,
-39367,
-38469,
-37356,
-36087,
-34725,
-33320,
-31916,
-30558,
-29306,
-28241,
-27432,
-26992,
-26953,
-27363,
-28182,
-29334,
-30716,
-32194,
-33681,
-35085,
-36398,
-37590,
-38693,
-39697,
-40585,
-41331,
-41862,
-42156,
-42176,
-41953,
-41546,
-41058,
-40613,
-40323,
-40288,
-40546,
-41113,
-41926,
-42917,
-43977,
-45026,
-45976,
-46797,
-47434,
-47888,
-48105,
-48040,
-47605,
-46710,
-45266,
-43238,
-40639,
-37576,
-34209,
-30755,
-27431,
-24432,
-21892,
-19871,
-18382,
-17379,
-16812,
-16630,
-16797,
-17283,
-18071,
-19088,
-20279,
-21505,
-22660,
-23606,
-24264,
-24597,
-24629,
-24442,
-24133,
-23825,
-23593,
-23512,
-23578,
-23797,
-24140,
-24593,
-25171,
-25891,
-26794,
-27921,
-29274,
-30845,
-32561,
-34334,
-36038,
-37549,
-38764,
-39594,
-40015,
-40019,
-39646,
-38961,
-38013,
-36879,
-35591,
-34201,
-32739,
-31259,
-29820,
-28511,
-27428,
-26670,
-26314,
-26406,
-26942,
-27871,
-29114,
-30550,
-32092,
-33632,
-35128,
-36521,
-37820,
-38984,
-40029,
-40894,
-41570,
-41987,
-42143,
-42012,
-41659,
-41144,
-40606,
-40157,
-39939,
-40022,
-40448,
-41182,
-42144,
-43228,
-44319,
-45333,
-46208,
-46925,
-47476,
-47840,
-47984,
-47821,
-47252,
-46179,
-44509,
-42254,
-39453,
-36264,
-32872,
-29502,
-26356,
-23591,
-21306,
-19523,
-18231,
-17382,
-16924,
-16824,
-17055,
-17600,
-18432,
-19509,
-20742,
-22035,
-23253,
-24283,
-25044,
-25482,
-25631,
-25537,
-25311,
-25041,
-24828,
-24715,
-24747,
-24919,
-25234,
-25698,
-26318,
-27122,
-28144,
-29382,
-30846,
-32471,
-34194,
-35908,
-37496,
-38855,
-39887,
-40533,
-40774,
-40609,
-40097,
-39282,
-38261,
-37073,
-35799,
-34458,
-33088,
-31726,
-30404,
-29209,
-28227,
-27553,
-27300,
-27485,
-28142,
-29176,
-30492,
-31955,
-33435,
-34856,
-36159,
-37362,
-38457,
-39482,
-40399,
-41184,
-41753,
-42064,
-42058,
-41775,
-41259,
-40648,
-40061,
-39651,
-39506,
-39686,
-40186,
-40952,
-41892,
-42910,
-43902,
-44787,
-45536,
-46105,
-46525,
-46781,
-46878,
-46770,
-46387,
-45623,
-44376,
-42576,
-40187,
-37297,
-34021,
-30580,
-27201,
-24076,
-21390,
-19183,
-17499,
-16258,
-15419,
-14918,
-14725,
-14861,
-15325,
-16131,
-17233,
-18540,
-19917,
-21200,
-22241,
-22947,
-23270,
-23273,
-23034,
-22696,
-22366,
-22131,
-22028,
-22046,
-22170,
-22362,
-22637,
-23025,
-23576,
-24371,
-25435,
-26795,
-28395,
-30178,
-32020,
-33841,
-35523,
-37000,
-38212,
-39105,
-39653,
-39837,
-39640,
-39107,
-38271,
-37210,
-36020,
-34760,
-33508,
-32287,
-31119,
-30014,
-29005,
-28141,
-27505,
-27191,
-27266,
-27779,
-28697,
-29947,
-31398,
-32920,
-34375,
-35707,
-36864,
-37879,
-38793,
-39628,
-40424,
-41130,
-41709,
-42090,
-42206,
-42055,
-41653,
-41096,
-40497,
-40007,
-39723,
-39756,
-40093,
-40739,
-41582,
-42565,
-43554,
-44510,
-45356,
-46092,
-46690,
-47152,
-47424,
-47475,
-47197,
-46523,
-45356,
-43655,
-41412,
-38688,
-35599,
-32306,
-28990,
-25835,
-22981,
-20545,
-18561,
-17049,
-15976,
-15310,
-15027,
-15097,
-15517,
-16260,
-17278,
-18505,
-19823,
-21120,
-22260,
-23161,
-23759,
-24063,
-24110,
-23984,
-23764,
-23545,
-23373,
-23301,
-23334,
-23483,
-23742,
-24124,
-24630,
-25297,
-26130,
-27173,
-28411,
-29852,
-31435,
-33106,
-34777,
-36331,
-37697,
-38751,
-39478,
-39805,
-39775,
-39387,
-38704,
-37779,
-36661,
-35412,
-34063,
-32673,
-31262,
-29903,
-28635,
-27542,
-26700,
-26178,
-26046,
-26324,
-27011,
-28045,
-29350,
-30811,
-32326,
-33807,
-35194,
-36475,
-37636,
-38702,
-39662,
-40504,
-41190,
-41660,
-41879,
-41815,
-41493,
-40974,
-40367,
-39798,
-39403,
-39276,
-39484,
-40017,
-40828,
-41833,
-42910,
-43991,
-44968,
-45831,
-46534,
-47088,
-47466,
-47625,
-47521,
-47044,
-46150,
-44744,
-42837,
-40441,
-37661,
-34607,
-31442,
-28325,
-25390,
-22772,
-20542,
-18751,
-17422,
-16531,
-16063,
-15976,
-16237,
-16812,
-17656,
-18733,
-19958,
-21254,
-22501,
-23585,
-24416,
-24922,
-25117,
-25032,
-24789,
-24477,
-24223,
-24084,
-24100,
-24262,
-24548,
-24930,
-25417,
-26010,
-26771,
-27717,
-28887,
-30260,
-31803,
-33437,
-35066,
-36611,
-37959,
-39074,
-39882,
-40375,
-40536,
-40381,
-39917,
-39202,
-38238,
-37105,
-35816,
-34436,
-33007,
-31585,
-30238,
-29037,
-28062,
-27390,
-27078,
-27162,
-27639,
-28475,
-29597,
-30921,
-32348,
-33793,
-35204,
-36520,
-37760,
-38892,
-39945,
-40890,
-41707,
-42344,
-42750,
-42872,
-42703,
-42268,
-41646,
-40974,
-40374,
-40014,
-39963,
-40288,
-40948,
-41871,
-42939,
-44031,
-45058,
-45940,
-46678,
-47255,
-47691,
-47977,
-48065,
-47877,
-47316,
-46262,
-44657,
-42466,
-39758,
-36646,
-33336,
-30010,
-26898,
-24130,
-21815,
-19975,
-18576,
-17580,
-16921,
-16576,
-16548,
-16839,
-17478,
-18436,
-19666,
-21048,
-22455,
-23707,
-24704,
-25330,
-25606,
-25553,
-25289,
-24930,
-24581,
-24340,
-24228,
-24268,
-24424,
-24687,
-25022,
-25467,
-26027,
-26775,
-27736,
-28945,
-30390,
-32022,
-33759,
-35491,
-37099,
-38474,
-39529,
-40206,
-40491,
-40389,
-39939,
-39203,
-38223,
-37080,
-35805,
-34447,
-33050,
-31626,
-30239,
-28922,
-27764,
-26834,
-26249,
-26053,
-26321,
-27021,
-28114,
-29483,
-31013,
-32563,
-34061,
-35431,
-36687,
-37838,
-38914,
-39926,
-40850,
-41625,
-42189,
-42470,
-42432,
-42104,
-41543,
-40872,
-40228,
-39737,
-39524,
-39628,
-40085,
-40828,
-41797,
-42883,
-43978,
-45000,
-45882,
-46588,
-47119,
-47458,
-47608,
-47512,
-47116,
-46308,
-45018,
-43153,
-40742,
-37820,
-34561,
-31141,
-27782,
-24677,
-21974,
-19739,
-18005,
-16725,
-15867,
-15385,
-15255,
-15474,
-16040,
-16933,
-18101,
-19459,
-20869,
-22207,
-23327,
-24146,
-24617,
-24768,
-24668,
-24431,
-24159,
-23960,
-23876,
-23944,
-24144,
-24447,
-24841,
-25296,
-25853,
-26527,
-27371,
-28422,
-29683,
-31158,
-32777,
-34481,
-36161,
-37709,
-39042,
-40047,
-40703,
-40947,
-40818,
-40321,
-39531,
-38495,
-37286,
-35957,
-34558,
-33132,
-31735,
-30410,
-29243,
-28284,
-27621,
-27303,
-27355,
-27794,
-28565,
-29625,
-30896,
-32279,
-33721,
-35125,
-36469,
-37700,
-38815,
-39795,
-40643,
-41356,
-41903,
-42275,
-42429,
-42348,
-42043,
-41544,
-40950,
-40369,
-39949,
-39806,
-40025,
-40619,
-41525,
-42643,
-43809,
-44915,
-45838,
-46552,
-47048,
-47374,
-47539,
-47555,
-47354,
-46839,
-45900,
-44420,
-42354,
-39744,
-36673,
-33358,
-29979,
-26767,
-23885,
-21435,
-19470,
-17965,
-16889,
-16194,
-15840,
-15816,
-16115,
-16724,
-17635,
-18768,
-20053,
-21359,
-22559,
-23539,
-24208,
-24537,
-24543,
-24304,
-23915,
-23500,
-23154,
-22945,
-22917,
-23047,
-23344,
-23747,
-24289,
-24934,
-25748,
-26733,
-27929,
-29322,
-30876,
-32524,
-34165,
-35703,
-37033,
-38080,
-38789,
-39121,
-39090,
-38691,
-37980,
-36992,
-35793,
-34448,
-33029,
-31586,
-30196,
-28891,
-27735,
-26770,
-26057,
-25641,
-25585,
-25901,
-26604,
-27651,
-28962,
-30446,
-31982,
-33487,
-34883,
-36159,
-37315,
-38396,
-39423,
-40402,
-41310,
-42073,
-42617,
-42875,
-42812,
-42473,
-41951,
-41389,
-40949,
-40764,
-40910,
-41404,
-42168,
-43111,
-44101,
-45043,
-45871,
-46559,
-47112,
-47547,
-47839,
-47973,
-47852,
-47406,
-46534,
-45170,
-43292,
-40923,
-38151,
-35087,
-31900,
-28721,
-25725,
-23012,
-20693,
-18797,
-17366,
-16378,
-15824,
-15677,
-15907,
-16482,
-17361,
-18470,
-19728,
-21022,
-22235,
-23271,
-24039,
-24522,
-24718,
-24688,
-24501,
-24247,
-23995,
-23803,
-23701,
-23716,
-23841,
-24102,
-24498,
-25057,
-25796,
-26741,
-27893,
-29250,
-30785,
-32432,
-34136,
-35786,
-37302,
-38582,
-39552,
-40154,
-40368,
-40194,
-39664,
-38828,
-37749,
-36490,
-35126,
-33700,
-32278,
-30894,
-29601,
-28442,
-27478,
-26766,
-26373,
-26345,
-26721,
-27473,
-28583,
-29931,
-31444,
-32987,
-34482,
-35866,
-37110,
-38223,
-39210,
-40092,
-40850,
-41461,
-41871,
-42049,
-41968,
-41658,
-41169,
-40617,
-40103,
-39766,
-39675,
-39906,
-40440,
-41245,
-42237,
-43318,
-44395,
-45392,
-46240,
-46919,
-47399,
-47656,
-47670,
-47376,
-46715,
-45626,
-44039,
-41953,
-39393,
-36442,
-33257,
-29986,
-26835,
-23935,
-21434,
-19381,
-17809,
-16693,
-15995,
-15667,
-15674,
-15987,
-16586,
-17452,
-18538,
-19783,
-21077,
-22314,
-23360,
-24138,
-24577,
-24702,
-24568,
-24280,
-23960,
-23706,
-23594,
-23638,
-23841,
-24151,
-24561,
-25053,
-25659,
-26428,
-27409,
-28644,
-30120,
-31797,
-33566,
-35325,
-36924,
-38283,
-39302,
-39969,
-40263,
-40226,
-39871,
-39258,
-38399,
-37348,
-36125,
-34782,
-33368,
-31939,
-30568,
-29310,
-28237,
-27394,
-26839,
-26596,
-26697,
-27133,
-27896,
-28931,
-30182,
-31571,
-33011,
-34437,
-35789,
-37033,
-38171,
-39179,
-40080,
-40848,
-41474,
-41913,
-42137,
-42117,
-41861,
-41407,
-40832,
-40243,
-39754,
-39478,
-39485,
-39807,
-40431,
-41281,
-42279,
-43319,
-44309,
-45207,
-45962,
-46602,
-47110,
-47508,
-47755,
-47805,
-47563,
-46929,
-45820,
-44163,
-41978,
-39317,
-36305,
-33110,
-29901,
-26853,
-24097,
-21718,
-19758,
-18216,
-17071,
-16294,
-15852,
-15739,
-15939,
-16460,
-17268,
-18343,
-19595,
-20949,
-22266,
-23452,
-24393,
-25042,
-25381,
-25448,
-25305,
-25053,
-24759,
-24506,
-24321,
-24233,
-24238,
-24350,
-24561,
-24914,
-25411,
-26095,
-26981,
-28059,
-29329,
-30747,
-32262,
-33835,
-35375,
-36840,
-38139,
-39212,
-39994,
-40437,
-40523,
-40254,
-39679,
-38829,
-37800,
-36617,
-35361,
-34047,
-32712,
-31374,
-30070,
-28842,
-27754,
-26880,
-26281,
-26032,
-26156,
-26664,
-27531,
-28678,
-30042,
-31501,
-32977,
-34380,
-35668,
-36819,
-37844,
-38768,
-39611,
-40379,
-41039,
-41553,
-41844,
-41878,
-41634,
-41145,
-40514,
-39851,
-39315,
-39010,
-39026,
-39373,
-40023,
-40898,
-41907,
-42967,
-43995,
-44956,
-45807,
-46524,
-47094,
-47466,
-47617,
-47487,
-47033,
-46200,
-44953,
-43259,
-41127,
-38571,
-35682,
-32554,
-29344,
-26217,
-23324,
-20804,
-18740,
-17152,
-16034,
-15325,
-14968,
-14914,
-15133,
-15615,
-16360,
-17356,
-18546,
-19876,
-21204,
-22437,
-23433,
-24141,
-24514,
-24604,
-24467,
-24214,
-23937,
-23710,
-23580,
-23558,
-23636,
-23814,
-24081,
-24466,
-24995,
-25698,
-26612,
-27739,
-29060,
-30557,
-32144,
-33793,
-35405,
-36927,
-38281,
-39396,
-40220,
-40697,
-40816,
-40577,
-40024,
-39215,
-38220,
-37101,
-35914,
-34682,
-33430,
-32171,
-30938,
-29777,
-28757,
-27962,
-27452,
-27296,
-27504,
-28070,
-28949,
-30072,
-31366,
-32749,
-34162,
-35541,
-36851,
-38074,
-39184,
-40200,
-41094,
-41876,
-42512,
-42964,
-43203,
-43182,
-42914,
-42425,
-41803,
-41156,
-40632,
-40324,
-40333,
-40657,
-41287,
-42122,
-43095,
-44089,
-45057,
-45947,
-46729,
-47405,
-47933,
-48307,
-48462,
-48356,
-47930,
-47130,
-45925,
-44270,
-42186,
-39669,
-36815,
-33700,
-30498,
-27352,
-24445,
-21911,
-19828,
-18250,
-17116,
-16410,
-16037,
-15979,
-16199,
-16713,
-17502,
-18558,
-19797,
-21125,
-22403,
-23501,
-24322,
-24820,
-25010,
-24955,
-24749,
-24483,
-24233,
-24051,
-23944,
-23920,
-23965,
-24076,
-24266,
-24548,
-24961,
-25530,
-26297,
-27268,
-28460,
-29842,
-31381,
-33011,
-34646,
-36194,
-37559,
-38648,
-39409,
-39787,
-39789,
-39427,
-38751,
-37819,
-36691,
-35432,
-34082,
-32688,
-31276,
-29871,
-28516,
-27260,
-26171,
-25335,
-24834,
-24729,
-25066,
-25831,
-26969,
-28395,
-29981,
-31615,
-33190,
-34638,
-35920,
-37057,
-38052,
-38969,
-39819,
-40610,
-41331,
-41919,
-42321,
-42491,
-42391,
-42062,
-41559,
-41017,
-40565,
-40345,
-40450,
-40908,
-41697,
-42708,
-43838,
-44941,
-45937,
-46764,
-47411,
-47900,
-48253,
-48461,
-48514,
-48326,
-47822,
-46918,
-45540,
-43676,
-41351,
-38649,
-35678,
-32595,
-29527,
-26616,
-23963,
-21645,
-19693,
-18137,
-16950,
-16132,
-15665,
-15531,
-15727,
-16246,
-17052,
-18119,
-19360,
-20686,
-21979,
-23129,
-24036,
-24645,
-24936,
-24946,
-24740,
-24416,
-24060,
-23765,
-23572,
-23529,
-23615,
-23844,
-24179,
-24629,
-25194,
-25897,
-26760,
-27818,
-29061,
-30503,
-32071,
-33725,
-35356,
-36881,
-38205,
-39248,
-39971,
-40340,
-40360,
-40062,
-39463,
-38631,
-37587,
-36391,
-35080,
-33694,
-32281,
-30886,
-29555,
-28352,
-27319,
-26530,
-26030,
-25871,
-26086,
-26667,
-27605,
-28817,
-30238,
-31748,
-33266,
-34702,
-36015,
-37191,
-38236,
-39185,
-40039,
-40807,
-41450,
-41924,
-42178,
-42177,
-41923,
-41461,
-40881,
-40294,
-39821,
-39568,
-39593,
-39925,
-40532,
-41355,
-42316,
-43332,
-44322,
-45239,
-46032,
-46688,
-47180,
-47488,
-47580,
-47419,
-46943,
-46104,
-44844,
-43130,
-40961,
-38370,
-35439,
-32293,
-29084,
-25969,
-23114,
-20623,
-18592,
-17022,
-15914,
-15204,
-14856,
-14820,
-15086,
-15651,
-16514,
-17656,
-19015,
-20482,
-21924,
-23185,
-24143,
-24726,
-24931,
-24829,
-24537,
-24180,
-23878,
-23693,
-23658,
-23751,
-23940,
-24200,
-24516,
-24916,
-25426,
-26096,
-26951,
-28009,
-29253,
-30658,
-32166,
-33731,
-35276,
-36741,
-38047,
-39124,
-39912,
-40357,
-40448,
-40182,
-39604,
-38753,
-37704,
-36500,
-35203,
-33845,
-32464,
-31097,
-29787,
-28591,
-27587,
-26823,
-26398,
-26330,
-26661,
-27379,
-28427,
-29736,
-31207,
-32722,
-34208,
-35574,
-36804,
-37889,
-38852,
-39729,
-40519,
-41233,
-41818,
-42232,
-42420,
-42345,
-42036,
-41529,
-40940,
-40375,
-39952,
-39767,
-39861,
-40246,
-40884,
-41717,
-42669,
-43666,
-44653,
-45567,
-46384,
-47062,
-47584,
-47921,
-48044,
-47909,
-47465,
-46643,
-45389,
-43650,
-41426,
-38749,
-35731,
-32517,
-29294,
-26249,
-23534,
-21256,
-19452,
-18101,
-17148,
-16533,
-16210,
-16165,
-16404,
-16957,
-17807,
-18951,
-20271,
-21677,
-23003,
-24128,
-24951,
-25433,
-25589,
-25506,
-25254,
-24967,
-24685,
-24494,
-24385,
-24378,
-24459,
-24627,
-24904,
-25307,
-25866,
-26607,
-27544,
-28665,
-29972,
-31402,
-32944,
-34507,
-36054,
-37487,
-38743,
-39734,
-40415,
-40739,
-40715,
-40367,
-39742,
-38908,
-37907,
-36783,
-35552,
-34226,
-32825,
-31371,
-29944,
-28605,
-27478,
-26635,
-26165,
-26103,
-26446,
-27165,
-28186,
-29434,
-30824,
-32270,
-33712,
-35092,
-36377,
-37558,
-38623,
-39593,
-40449,
-41199,
-41791,
-42194,
-42351,
-42239,
-41872,
-41305,
-40656,
-40049,
-39632,
-39504,
-39712,
-40244,
-41035,
-41974,
-42976,
-43940,
-44833,
-45622,
-46318,
-46909,
-47383,
-47700,
-47801,
-47619,
-47081,
-46137,
-44739,
-42892,
-40600,
-37935,
-34977,
-31854,
-28714,
-25694,
-22946,
-20566,
-18614,
-17118,
-16047,
-15372,
-15053,
-15056,
-15368,
-15971,
-16844,
-17944,
-19195,
-20510,
-21772,
-22882,
-23759,
-24358,
-24670,
-24736,
-24605,
-24368,
-24090,
-23860,
-23719,
-23724,
-23878,
-24190,
-24638,
-25219,
-25908,
-26715,
-27652,
-28733,
-29985,
-31401,
-32950,
-34582,
-36189,
-37691,
-38958,
-39943,
-40566,
-40849,
-40792,
-40454,
-39885,
-39116,
-38204,
-37148,
-35983,
-34721,
-33387,
-32035,
-30712,
-29495,
-28461,
-27677,
-27221,
-27123,
-27421,
-28090,
-29098,
-30365,
-31804,
-33312,
-34801,
-36190,
-37455,
-38562,
-39551,
-40418,
-41198,
-41878,
-42438,
-42830,
-43013,
-42942,
-42631,
-42112,
-41477,
-40846,
-40343,
-40082,
-40135,
-40522,
-41201,
-42108,
-43120,
-44161,
-45130,
-45987,
-46705,
-47276,
-47710,
-47986,
-48095,
-47961,
-47556,
-46771,
-45599,
-43963,
-41909,
-39447,
-36678,
-33707,
-30659,
-27677,
-24886,
-22379,
-20245,
-18495,
-17147,
-16160,
-15512,
-15165,
-15107,
-15331,
-15846,
-16645,
-17699,
-18947,
-20289,
-21595,
-22756,
-23644,
-24222,
-24472,
-24443,
-24224,
-23899,
-23567,
-23277,
-23073,
-22955,
-22920,
-22972,
-23104,
-23346,
-23711,
-24216,
-24873,
-25683,
-26629,
-27711,
-28915,
-30229,
-31651,
-33138,
-34645,
-36097,
-37379,
-38410,
-39080,
-39362,
-39240,
-38773,
-38034,
-37127,
-36136,
-35113,
-34094,
-33060,
-32001,
-30902,
-29761,
-28632,
-27564,
-26653,
-25978,
-25608,
-25592,
-25930,
-26613,
-27587,
-28792,
-30168,
-31633,
-33142,
-34629,
-36054,
-37396,
-38609,
-39711,
-40665,
-41484,
-42153,
-42654,
-42975,
-43087,
-42986,
-42669,
-42171,
-41547,
-40890,
-40302,
-39887,
-39735,
-39884,
-40350,
-41073,
-41984,
-42979,
-43970,
-44882,
-45685,
-46354,
-46903,
-47325,
-47600,
-47695,
-47531,
-47041,
-46149,
-44796,
-42992,
-40733,
-38123,
-35232,
-32203,
-29153,
-26212,
-23498,
-21087,
-19066,
-17432,
-16213,
-15357,
-14830,
-14588,
-14597,
-14847,
-15348,
-16099,
-17105,
-18320,
-19678,
-21048,
-22324,
-23353,
-24085,
-24458,
-24532,
-24366,
-24086,
-23784,
-23549,
-23418,
-23393,
-23465,
-23599,
-23788,
-24039,
-24370,
-24829,
-25439,
-26234,
-27218,
-28386,
-29717,
-31174,
-32723,
-34301,
-35855,
-37298,
-38563,
-39559,
-40241,
-40559,
-40532,
-40174,
-39555,
-38722,
-37740,
-36634,
-35432,
-34140,
-32773,
-31364,
-29959,
-28640,
-27492,
-26594,
-26010,
-25769,
-25863,
-26278,
-26956,
-27860,
-28949,
-30171,
-31501,
-32888,
-34277,
-35631,
-36886,
-38018,
-39014,
-39871,
-40605,
-41219,
-41706,
-42031,
-42170,
-42072,
-41757,
-41241,
-40622,
-40010,
-39530,
-39298,
-39370,
-39765,
-40439,
-41318,
-42308,
-43328,
-44305,
-45205,
-45997,
-46672,
-47213,
-47612,
-47844,
-47882,
-47700,
-47234,
-46462,
-45297,
-43717,
-41678,
-39206,
-36363,
-33282,
-30112,
-27048,
-24241,
-21815,
-19828,
-18277,
-17116,
-16300,
-15767,
-15515,
-15542,
-15885,
-16539,
-17523,
-18732,
-20121,
-21512,
-22813,
-23895,
-24698,
-25206,
-25434,
-25455,
-25321,
-25127,
-24905,
-24724,
-24591,
-24527,
-24547,
-24633,
-24820,
-25081,
-25462,
-25952,
-26593,
-27393,
-28376,
-29549,
-30898,
-32393,
-33980,
-35581,
-37115,
-38492,
-39636,
-40491,
-41026,
-41236,
-41145,
-40776,
-40194,
-39409,
-38495,
-37442,
-36293,
-35054,
-33744,
-32399,
-31059,
-29789,
-28653,
-27735,
-27089,
-26770,
-26805,
-27184,
-27889,
-28869,
-30051,
-31387,
-32777,
-34189,
-35538,
-36808,
-37962,
-38998,
-39921,
-40731,
-41449,
-42051,
-42538,
-42855,
-42992,
-42892,
-42593,
-42084,
-41485,
-40861,
-40357,
-40063,
-40052,
-40355,
-40926,
-41717,
-42614,
-43551,
-44442,
-45264,
-46004,
-46663,
-47255,
-47742,
-48097,
-48230,
-48072,
-47534,
-46563,
-45133,
-43261,
-40989,
-38399,
-35579,
-32635,
-29682,
-26827,
-24188,
-21846,
-19885,
-18330,
-17186,
-16427,
-15997,
-15855,
-15955,
-16287,
-16839,
-17622,
-18613,
-19773,
-21030,
-22273,
-23401,
-24312,
-24943,
-25283,
-25365,
-25247,
-25025,
-24756,
-24521,
-24334,
-24232,
-24189,
-24238,
-24342,
-24553,
-24860,
-25301,
-25901,
-26664,
-27615,
-28748,
-30054,
-31510,
-33075,
-34686,
-36268,
-37732,
-38981,
-39939,
-40548,
-40781,
-40661,
-40229,
-39546,
-38684,
-37673,
-36568,
-35347,
-34046,
-32654,
-31216,
-29799,
-28466,
-27320,
-26429,
-25842,
-25592,
-25669,
-26065,
-26755,
-27721,
-28910,
-30296,
-31787,
-33311,
-34782,
-36110,
-37288,
-38287,
-39171,
-39976,
-40733,
-41451,
-42058,
-42488,
-42653,
-42499,
-42058,
-41396,
-40664,
-40011,
-39580,
-39452,
-39653,
-40146,
-40858,
-41704,
-42618,
-43539,
-44435,
-45289,
-46059,
-46748,
-47301,
-47709,
-47934,
-47949,
-47722,
-47198,
-46323,
-45032,
-43287,
-41077,
-38450,
-35511,
-32396,
-29283,
-26323,
-23656,
-21356,
-19472,
-17988,
-16899,
-16155,
-15746,
-15628,
-15804,
-16232,
-16914,
-17804,
-18874,
-20073,
-21338,
-22586,
-23742,
-24696,
-25404,
-25803,
-25913,
-25781,
-25494,
-25158,
-24864,
-24668,
-24600,
-24639,
-24768,
-24954,
-25219,
-25567,
-26076,
-26766,
-27673,
-28793,
-30075,
-31476,
-32925,
-34385,
-35809,
-37189,
-38463,
-39614,
-40534,
-41190,
-41477,
-41400,
-40949,
-40200,
-39223,
-38108,
-36919,
-35683,
-34422,
-33119,
-31799,
-30485,
-29248,
-28166,
-27311,
-26758,
-26530,
-26642,
-27074,
-27795,
-28765,
-29951,
-31277,
-32707,
-34137,
-35522,
-36781,
-37893,
-38851,
-39667,
-40387,
-41013,
-41560,
-41984,
-42242,
-42276,
-42072,
-41626,
-41015,
-40329,
-39690,
-39219,
-39001,
-39077,
-39457,
-40091,
-40917,
-41859,
-42839,
-43798,
-44689,
-45482,
-46145,
-46669,
-47012,
-47153,
-47044,
-46644,
-45914,
-44822,
-43350,
-41514,
-39325,
-36846,
-34130,
-31267,
-28344,
-25457,
-22715,
-20199,
-18012,
-16193,
-14808,
-13834,
-13292,
-13116,
-13286,
-13747,
-14460,
-15395,
-16513,
-17769,
-19112,
-20454,
-21714,
-22796,
-23625,
-24162,
-24397,
-24389,
-24198,
-23935,
-23675,
-23491,
-23423,
-23468,
-23637,
-23906,
-24281,
-24778,
-25416,
-26226,
-27229,
-28420,
-29792,
-31311,
-32929,
-34597,
-36251,
-37822,
-39244,
-40437,
-41331,
-41883,
-42062,
-41881,
-41372,
-40594,
-39600,
-38454,
-37184,
-35829,
-34411,
-32965,
-31530,
-30177,
-28948,
-27928,
-27146,
-26650,
-26447,
-26554,
-26952,
-27648,
-28606,
-29788,
-31146,
-32587,
-34040,
-35429,
-36688,
-37810,
-38779,
-39642,
-40402,
-41099,
-41697,
-42178,
-42486,
-42576,
-42426,
-42055,
-41517,
-40908,
-40346,
-39931,
-39751,
-39860,
-40242,
-40883,
-41696,
-42621,
-43577,
-44504,
-45365,
-46124,
-46773,
-47291,
-47659,
-47847,
-47818,
-47520,
-46903,
-45920,
-44523,
-42699,
-40448,
-37814,
-34880,
-31772,
-28622,
-25608,
-22851,
-20477,
-18535,
-17039,
-15955,
-15227,
-14794,
-14620,
-14684,
-15003,
-15593,
-16460,
-17588,
-18901,
-20315,
-21681,
-22891,
-23821,
-24437,
-24722,
-24731,
-24557,
-24272,
-23991,
-23745,
-23588,
-23511,
-23525,
-23621,
-23811,
-24124,
-24576,
-25205,
-26012,
-27013,
-28178,
-29493,
-30919,
-32421,
-33957,
-35477,
-36923,
-38230,
-39320,
-40146,
-40637,
-40796,
-40608,
-40117,
-39368,
-38419,
-37334,
-36145,
-34910,
-33623,
-32333,
-31032,
-29766,
-28566,
-27493,
-26615,
-26011,
-25740,
-25851,
-26358,
-27223,
-28403,
-29785,
-31285,
-32792,
-34228,
-35547,
-36715,
-37752,
-38669,
-39500,
-40265,
-40961,
-41573,
-42057,
-42355,
-42429,
-42239,
-41819,
-41221,
-40547,
-39943,
-39518,
-39380,
-39571,
-40069,
-40824,
-41733,
-42713,
-43675,
-44583,
-45405,
-46140,
-46764,
-47271,
-47600,
-47722,
-47560,
-47072,
-46202,
-44925,
-43211,
-41081,
-38549,
-35714,
-32669,
-29571,
-26592,
-23855,
-21518,
-19599,
-18142,
-17092,
-16405,
-16032,
-15950,
-16155,
-16658,
-17456,
-18515,
-19756,
-21077,
-22338,
-23427,
-24249,
-24768,
-24998,
-24994,
-24839,
-24619,
-24410,
-24261,
-24205,
-24246,
-24385,
-24611,
-24929,
-25338,
-25869,
-26534,
-27372,
-28396,
-29614,
-31013,
-32542,
-34151,
-35733,
-37221,
-38503,
-39526,
-40217,
-40576,
-40579,
-40276,
-39684,
-38863,
-37848,
-36690,
-35416,
-34075,
-32689,
-31317,
-29994,
-28793,
-27774,
-26997,
-26534,
-26404,
-26652,
-27247,
-28172,
-29352,
-30714,
-32171,
-33635,
-35051,
-36358,
-37549,
-38619,
-39571,
-40422,
-41150,
-41738,
-42146,
-42323,
-42259,
-41937,
-41426,
-40800,
-40184,
-39703,
-39468,
-39539,
-39944,
-40632,
-41534,
-42537,
-43559,
-44505,
-45356,
-46069,
-46668,
-47146,
-47481,
-47653,
-47574,
-47169,
-46351,
-45031,
-43201,
-40848,
-38064,
-34959,
-31696,
-28455,
-25397,
-22658,
-20330,
-18441,
-16990,
-15940,
-15245,
-14890,
-14844,
-15143,
-15758,
-16711,
-17917,
-19300,
-20723,
-22037,
-23130,
-23905,
-24342,
-24478,
-24377,
-24148,
-23873,
-23620,
-23446,
-23351,
-23367,
-23471,
-23680,
-24002,
-24427,
-24995,
-25690,
-26550,
-27581,
-28804,
-30220,
-31806,
-33520,
-35254,
-36921,
-38372,
-39507,
-40255,
-40559,
-40473,
-40011,
-39282,
-38330,
-37242,
-36037,
-34760,
-33422,
-32045,
-30683,
-29364,
-28180,
-27182,
-26448,
-26039,
-25987,
-26312,
-27001,
-28008,
-29266,
-30697,
-32193,
-33689,
-35094,
-36383,
-37534,
-38554,
-39467,
-40283,
-41000,
-41602,
-42034,
-42259,
-42234,
-41955,
-41459,
-40835,
-40209,
-39716,
-39486,
-39595,
-40070,
-40862,
-41885,
-43006,
-44122,
-45139,
-46008,
-46729,
-47306,
-47756,
-48069,
-48202,
-48081,
-47627,
-46747,
-45394,
-43550,
-41248,
-38569,
-35629,
-32560,
-29517,
-26614,
-23998,
-21718,
-19865,
-18432,
-17416,
-16796,
-16518,
-16564,
-16898,
-17505,
-18366,
-19445,
-20681,
-21984,
-23247,
-24346,
-25203,
-25738,
-25969,
-25922,
-25699,
-25382,
-25089,
-24862,
-24761,
-24779,
-24906,
-25130,
-25440,
-25840,
-26368,
-27037,
-27898,
-28957,
-30222,
-31660,
-33220,
-34826,
-36381,
-37802,
-38984,
-39881,
-40430,
-40645,
-40522,
-40117,
-39467,
-38627,
-37637,
-36526,
-35324,
-34048,
-32723,
-31398,
-30103,
-28925,
-27909,
-27148,
-26684,
-26579,
-26830,
-27450,
-28370,
-29551,
-30885,
-32300,
-33712,
-35060,
-36321,
-37471,
-38522,
-39475,
-40317,
-41037,
-41577,
-41917,
-41992,
-41820,
-41402,
-40821,
-40163,
-39552,
-39094,
-38888,
-38978,
-39379,
-40044,
-40914,
-41886,
-42892,
-43839,
-44694,
-45422,
-46009,
-46459,
-46735,
-46816,
-46631,
-46109,
-45176,
-43776,
-41876,
-39529,
-36772,
-33766,
-30630,
-27544,
-24647,
-22062,
-19875,
-18123,
-16807,
-15901,
-15364,
-15161,
-15254,
-15637,
-16280,
-17197,
-18327,
-19642,
-21028,
-22401,
-23623,
-24612,
-25298,
-25671,
-25779,
-25691,
-25517,
-25341,
-25226,
-25215,
-25292,
-25461,
-25689,
-25990,
-26358,
-26853,
-27487,
-28312,
-29335,
-30552,
-31927,
-33424,
-34955,
-36474,
-37879,
-39106,
-40085,
-40746,
-41076,
-41035,
-40669,
-39988,
-39065,
-37938,
-36670,
-35298,
-33861,
-32394,
-30944,
-29557,
-28314,
-27268,
-26514,
-26089,
-26055,
-26409,
-27146,
-28208,
-29534,
-31015,
-32568,
-34078,
-35492,
-36747,
-37860,
-38826,
-39709,
-40503,
-41234,
-41842,
-42274,
-42457,
-42335,
-41921,
-41276,
-40522,
-39831,
-39339,
-39179,
-39389,
-39949,
-40786,
-41774,
-42824,
-43825,
-44756,
-45575,
-46300,
-46922,
-47423,
-47764,
-47881,
-47687,
-47115,
-46082,
-44554,
-42522,
-40016,
-37131,
-33974,
-30712,
-27500,
-24500,
-21833,
-19584,
-17780,
-16422,
-15467,
-14881,
-14619,
-14674,
-15022,
-15678,
-16601,
-17772,
-19095,
-20486,
-21808,
-22954,
-23827,
-24371,
-24593,
-24532,
-24279,
-23934,
-23593,
-23326,
-23183,
-23159,
-23267,
-23472,
-23794,
-24237,
-24833,
-25618,
-26620,
-27829,
-29243,
-30786,
-32415,
-34036,
-35590,
-36991,
-38193,
-39127,
-39757,
-40051,
-39996,
-39615,
-38927,
-38005,
-36889,
-35654,
-34333,
-32971,
-31594,
-30244,
-28958,
-27810,
-26864,
-26195,
-25870,
-25915,
-26339,
-27114,
-28173,
-29456,
-30863,
-32330,
-33772,
-35143,
-36412,
-37557,
-38588,
-39510,
-40330,
-41038,
-41615,
-42008,
-42187,
-42115,
-41802,
-41297,
-40696,
-40115,
-39690,
-39512,
-39650,
-40095,
-40811,
-41708,
-42703,
-43706,
-44657,
-45519,
-46264,
-46877,
-47335,
-47613,
-47661,
-47437,
-46880,
-45930,
-44555,
-42714,
-40420,
-37721,
-34710,
-31530,
-28355,
-25359,
-22700,
-20485,
-18758,
-17500,
-16664,
-16169,
-15967,
-16027,
-16350,
-16951,
-17836,
-18971,
-20288,
-21659,
-22959,
-24047,
-24838,
-25293,
-25430,
-25333,
-25087,
-24803,
-24552,
-24401,
-24354,
-24428,
-24596,
-24852,
-25197,
-25626,
-26174,
-26859,
-27706,
-28752,
-29975,
-31389,
-32928,
-34540,
-36137,
-37611,
-38881,
-39858,
-40491,
-40760,
-40670,
-40263,
-39588,
-38703,
-37661,
-36494,
-35243,
-33911,
-32548,
-31169,
-29852,
-28659,
-27682,
-27009,
-26702,
-26800,
-27302,
-28157,
-29292,
-30618,
-32025,
-33451,
-34811,
-36096,
-37264,
-38343,
-39312,
-40194,
-40973,
-41625,
-42138,
-42459,
-42572,
-42465,
-42125,
-41634,
-41025,
-40443,
-39979,
-39751,
-39841,
-40258,
-41000,
-41956,
-43059,
-44151,
-45179,
-46044,
-46751,
-47287,
-47675,
-47914,
-47983,
-47814,
-47334,
-46426,
-45021,
-43063,
-40561,
-37611,
-34331,
-30931,
-27597,
-24524,
-21854,
-19669,
-17984,
-16771,
-15961,
-15490,
-15321,
-15418,
-15805,
-16475,
-17422,
-18613,
-19930,
-21290,
-22521,
-23537,
-24248,
-24637,
-24745,
-24635,
-24407,
-24132,
-23887,
-23697,
-23593,
-23575,
-23655,
-23853,
-24178,
-24667,
-25330,
-26182,
-27235,
-28462,
-29869,
-31407,
-33045,
-34722,
-36355,
-37864,
-39144,
-40120,
-40723,
-40923,
-40731,
-40185,
-39350,
-38307,
-37114,
-35839,
-34514,
-33171,
-31824,
-30511,
-29254,
-28133,
-27199,
-26542,
-26233,
-26309,
-26797,
-27655,
-28823,
-30197,
-31677,
-33153,
-34571,
-35863,
-37057,
-38134,
-39137,
-40064,
-40899,
-41618,
-42161,
-42484,
-42561,
-42382,
-42003,
-41488,
-40943,
-40482,
-40189,
-40152,
-40391,
-40902,
-41639,
-42534,
-43504,
-44480,
-45406,
-46234,
-46967,
-47564,
-48032,
-48313,
-48369,
-48116,
-47483,
-46404,
-44842,
-42797,
-40326,
-37509,
-34483,
-31382,
-28353,
-25540,
-23034,
-20931,
-19249,
-17999,
-17161,
-16675,
-16531,
-16663,
-17077,
-17749,
-18652,
-19767,
-20996,
-22266,
-23447,
-24437,
-25152,
-25565,
-25688,
-25606,
-25386,
-25146,
-24932,
-24814,
-24780,
-24854,
-25015,
-25280,
-25670,
-26211,
-26930,
-27856,
-28973,
-30279,
-31730,
-33276,
-34856,
-36398,
-37814,
-39019,
-39928,
-40470,
-40606,
-40331,
-39689,
-38738,
-37576,
-36273,
-34902,
-33506,
-32107,
-30728,
-29398,
-28175,
-27137,
-26366,
-25972,
-25983,
-26455,
-27315,
-28506,
-29909,
-31396,
-32878,
-34267,
-35538,
-36684,
-37717,
-38648,
-39482,
-40182,
-40719,
-41033,
-41094,
-40895,
-40465,
-39897,
-39290,
-38787,
-38499,
-38503,
-38840,
-39475,
-40341,
-41338,
-42364,
-43332,
-44197,
-44922,
-45510,
-45948,
-46208,
-46247,
-45968,
-45290,
-44116,
-42400,
-40146,
-37425,
-34368,
-31151,
-27963,
-24975,
-22326,
-20096,
-18310,
-16964,
-16015,
-15435,
-15194,
-15281,
-15698,
-16434,
-17467,
-18731,
-20134,
-21555,
-22862,
-23945,
-24728,
-25186,
-25354,
-25308,
-25143,
-24970,
-24853,
-24852,
-24973,
-25200,
-25509,
-25885,
-26317,
-26845,
-27498,
-28328,
-29372,
-30633,
-32096,
-33678,
-35303,
-36834,
-38178,
-39221,
-39915,
-40219,
-40156,
-39751,
-39063,
-38139,
-37029,
-35767,
-34389,
-32916,
-31420,
-29929,
-28568,
-27397,
-26536,
-26047,
-25985,
-26345,
-27100,
-28165,
-29454,
-30864,
-32303,
-33704,
-35036,
-36273,
-37435,
-38509,
-39511,
-40387,
-41122,
-41627,
-41868,
-41816,
-41477,
-40945,
-40313,
-39740,
-39349,
-39246,
-39474,
-40013,
-40797,
-41728,
-42717,
-43679,
-44585,
-45396,
-46131,
-46747,
-47235,
-47500,
-47483,
-47066,
-46181,
-44762,
-42807,
-40345,
-37480,
-34325,
-31050,
-27816,
-24778,
-22066,
-19756,
-17901,
-16488,
-15522,
-14948,
-14782,
-14975,
-15556,
-16461,
-17657,
-19034,
-20453,
-21780,
-22857,
-23621,
-24020,
-24113,
-23975,
-23729,
-23478,
-23292,
-23211,
-23230,
-23336,
-23519,
-23776,
-24159,
-24689,
-25445,
-26437,
-27688,
-29162,
-30806,
-32531,
-34253,
-35872,
-37302,
-38481,
-39341,
-39862,
-40029,
-39854,
-39364,
-38608,
-37620,
-36465,
-35169,
-33784,
-32350,
-30908,
-29546,
-28300,
-27297,
-26576,
-26230,
-26283,
-26738,
-27565,
-28695,
-30045,
-31511,
-33026,
-34496,
-35901,
-37196,
-38382,
-39452,
-40389,
-41175,
-41759,
-42116,
-42202,
-42028,
-41624,
-41077,
-40497,
-40017,
-39756,
-39797,
-40174,
-40860,
-41785,
-42836,
-43919,
-44921,
-45799,
-46517,
-47076,
-47490,
-47746,
-47809,
-47610,
-47035,
-45987,
-44381,
-42197,
-39490,
-36399,
-33105,
-29843,
-26786,
-24102,
-21844,
-20021,
-18606,
-17527,
-16781,
-16343,
-16265,
-16563,
-17269,
-18327,
-19669,
-21128,
-22562,
-23797,
-24729,
-25301,
-25527,
-25477,
-25242,
-24944,
-24653,
-24455,
-24361,
-24401,
-24553,
-24822,
-25206,
-25717,
-26386,
-27226,
-28268,
-29502,
-30926,
-32487,
-34129,
-35767,
-37309,
-38666,
-39747,
-40495,
-40856,
-40841,
-40453,
-39761,
-38813,
-37692,
-36444,
-35125,
-33753,
-32363,
-30987,
-29678,
-28524,
-27609,
-27044,
-26889,
-27190,
-27913,
-28992,
-30309,
-31756,
-33201,
-34597,
-35876,
-37060,
-38151,
-39176,
-40130,
-40998,
-41730,
-42271,
-42562,
-42575,
-42309,
-41820,
-41201,
-40579,
-40090,
-39854,
-39941,
-40375,
-41113,
-42058,
-43111,
-44142,
-45095,
-45902,
-46577,
-47113,
-47525,
-47776,
-47806,
-47502,
-46753,
-45459,
-43575,
-41129,
-38225,
-35030,
-31747,
-28568,
-25668,
-23131,
-21026,
-19327,
-18021,
-17058,
-16423,
-16107,
-16116,
-16472,
-17152,
-18133,
-19330,
-20635,
-21924,
-23052,
-23931,
-24484,
-24708,
-24650,
-24392,
-24047,
-23726,
-23504,
-23435,
-23528,
-23761,
-24111,
-24552,
-25092,
-25754,
-26590,
-27640,
-28936,
-30470,
-32176,
-33984,
-35742,
-37353,
-38681,
-39654,
-40230,
-40401,
-40197,
-39670,
-38872,
-37871,
-36700,
-35418,
-34040,
-32605,
-31163,
-29741,
-28449,
-27342,
-26534,
-26102,
-26103,
-26551,
-27410,
-28598,
-30000,
-31502,
-32992,
-34405,
-35701,
-36901,
-38002,
-39051,
-40016,
-40895,
-41598,
-42088,
-42275,
-42167,
-41770,
-41178,
-40511,
-39914,
-39532,
-39469,
-39768,
-40431,
-41366,
-42487,
-43647,
-44752,
-45705,
-46476,
-47058,
-47461,
-47705,
-47761,
-47592,
-47092,
-46176,
-44725,
-42712,
-40133,
-37103,
-33772,
-30365,
-27087,
-24130,
-21626,
-19625,
-18146,
-17126,
-16530,
-16288,
-16383,
-16783,
-17483,
-18441,
-19612,
-20891,
-22175,
-23325,
-24257,
-24888,
-25215,
-25273,
-25139,
-24909,
-24685,
-24517,
-24469,
-24525,
-24696,
-24958,
-25318,
-25788,
-26398,
-27190,
-28192,
-29417,
-30846,
-32430,
-34091,
-35746,
-37284,
-38634,
-39703,
-40452,
-40837,
-40862,
-40524,
-39872,
-38941,
-37788,
-36484,
-35076,
-33633,
-32197,
-30824,
-29553,
-28453,
-27567,
-26981,
-26732,
-26881,
-27425,
-28338,
-29558,
-30968,
-32472,
-33952,
-35342,
-36592,
-37710,
-38698,
-39597,
-40391,
-41069,
-41581,
-41856,
-41872,
-41601,
-41107,
-40480,
-39865,
-39393,
-39197,
-39328,
-39805,
-40550,
-41491,
-42486,
-43472,
-44357,
-45129,
-45772,
-46294,
-46670,
-46866,
-46797,
-46370,
-45495,
-44102,
-42175,
-39756,
-36938,
-33861,
-30683,
-27552,
-24599,
-21911,
-19553,
-17555,
-15937,
-14727,
-13927,
-13580,
-13676,
-14207,
-15123,
-16330,
-17708,
-19123,
-20433,
-21538,
-22376,
-22925,
-23226,
-23333,
-23330,
-23280,
-23249,
-23266,
-23356,
-23521,
-23778,
-24118,
-24573,
-25149,
-25882,
-26790,
-27900,
-29213,
-30725,
-32401,
-34174,
-35952,
-37629,
-39081,
-40213,
-40949,
-41262,
-41164,
-40711,
-39967,
-39007,
-37893,
-36657,
-35330,
-33932,
-32481,
-31054,
-29693,
-28537,
-27644,
-27139,
-27047,
-27399,
-28146,
-29229,
-30531,
-31974,
-33441,
-34882,
-36237,
-37497,
-38641,
-39673,
-40563,
-41302,
-41837,
-42149,
-42203,
-42014,
-41615,
-41078,
-40514,
-40023,
-39726,
-39693,
-39971,
-40546,
-41378,
-42370,
-43447,
-44506,
-45485,
-46332,
-47022,
-47532,
-47841,
-47907,
-47672,
-47065,
-46008,
-44453,
-42368,
-39802,
-36822,
-33591,
-30255,
-27021,
-24032,
-21437,
-19296,
-17652,
-16472,
-15736,
-15381,
-15382,
-15717,
-16361,
-17304,
-18480,
-19816,
-21185,
-22453,
-23486,
-24194,
-24536,
-24551,
-24323,
-23974,
-23627,
-23373,
-23266,
-23308,
-23481,
-23751,
-24105,
-24561,
-25146,
-25934,
-26944,
-28237,
-29753,
-31472,
-33268,
-35042,
-36673,
-38057,
-39127,
-39834,
-40177,
-40164,
-39832,
-39220,
-38368,
-37313,
-36091,
-34730,
-33279,
-31772,
-30285,
-28885,
-27672,
-26720,
-26121,
-25912,
-26126,
-26737,
-27698,
-28923,
-30327,
-31811,
-33301,
-34745,
-36095,
-37350,
-38489,
-39512,
-40403,
-41129,
-41656,
-41946,
-41976,
-41755,
-41322,
-40778,
-40218,
-39793,
-39602,
-39733,
-40194,
-40969,
-41940,
-43019,
-44081,
-45025,
-45830,
-46449,
-46921,
-47245,
-47414,
-47386,
-47065,
-46343,
-45115,
-43305,
-40918,
-38025,
-34781,
-31397,
-28090,
-25053,
-22437,
-20302,
-18671,
-17504,
-16767,
-16411,
-16443,
-16832,
-17594,
-18661,
-19951,
-21329,
-22627,
-23707,
-24451,
-24830,
-24881,
-24697,
-24406,
-24123,
-23925,
-23858,
-23913,
-24066,
-24311,
-24636,
-25088,
-25715,
-26568,
-27695,
-29080,
-30696,
-32440,
-34218,
-35884,
-37355,
-38512,
-39331,
-39766,
-39838,
-39566,
-38990,
-38142,
-37063,
-35792,
-34378,
-32877,
-31372,
-29936,
-28689,
-27703,
-27070,
-26837,
-27014,
-27585,
-28485,
-29628,
-30939,
-32304,
-33688,
-35013,
-36283,
-37471,
-38582,
-39591,
-40473,
-41177,
-41652,
-41860,
-41789,
-41477,
-40999,
-40479,
-40043,
-39822,
-39904,
-40320,
-41043,
-41998,
-43059,
-44128,
-45094,
-45906,
-46550,
-47024,
-47347,
-47498,
-47424,
-47023,
-46188,
-44792,
-42802,
-40223,
-37179,
-33853,
-30474,
-27254,
-24374,
-21921,
-19947,
-18415,
-17313,
-16600,
-16283,
-16360,
-16845,
-17696,
-18855,
-20187,
-21546,
-22778,
-23760,
-24413,
-24738,
-24769,
-24602,
-24328,
-24049,
-23830,
-23720,
-23736,
-23891,
-24178,
-24614,
-25204,
-25972,
-26949,
-28135,
-29545,
-31123,
-32828,
-34535,
-36165,
-37566,
-38667,
-39374,
-39668,
-39550,
-39065,
-38268,
-37237,
-36022,
-34687,
-33272,
-31811,
-30371,
-28984,
-27756,
-26749,
-26072,
-25786,
-25935,
-26521,
-27489,
-28765,
-30230,
-31789,
-33335,
-34819,
-36198,
-37463,
-38625,
-39656,
-40554,
-41256,
-41715,
-41894,
-41765,
-41382,
-40822,
-40223,
-39741,
-39511,
-39628,
-40125,
-40944,
-41991,
-43135,
-44241,
-45234,
-46055,
-46706,
-47199,
-47523,
-47647,
-47477,
-46901,
-45798,
-44080,
-41730,
-38819,
-35506,
-31998,
-28537,
-25330,
-22537,
-20247,
-18469,
-17187,
-16339,
-15894,
-15822,
-16110,
-16758,
-17719,
-18933,
-20273,
-21597,
-22758,
-23635,
-24179,
-24396,
-24367,
-24201,
-24012,
-23885,
-23860,
-23957,
-24138,
-24417,
-24767,
-25241,
-25867,
-26702,
-27769,
-29075,
-30586,
-32242,
-33967,
-35672,
-37257,
-38648,
-39725,
-40460,
-40757,
-40641,
-40101,
-39215,
-38058,
-36725,
-35291,
-33840,
-32401,
-31036,
-29778,
-28693,
-27865,
-27370,
-27288,
-27650,
-28435,
-29585,
-30967,
-32469,
-33957,
-35354,
-36620,
-37763,
-38815,
-39800,
-40726,
-41552,
-42211,
-42626,
-42727,
-42518,
-42037,
-41425,
-40829,
-40425,
-40341,
-40630,
-41286,
-42202,
-43267,
-44338,
-45320,
-46160,
-46843,
-47382,
-47780,
-48008,
-47999,
-47647,
-46834,
-45473,
-43514,
-41004,
-38035,
-34792,
-31455,
-28236,
-25275,
-22701,
-20553,
-18863,
-17610,
-16794,
-16396,
-16421,
-16844,
-17637,
-18714,
-19972,
-21273,
-22472,
-23455,
-24137,
-24505,
-24585,
-24454,
-24199,
-23910,
-23653,
-23471,
-23388,
-23415,
-23560,
-23854,
-24304,
-24986,
-25888,
-27065,
-28483,
-30101,
-31850,
-33610,
-35279,
-36731,
-37877,
-38645,
-39007,
-38960,
-38549,
-37801,
-36805,
-35589,
-34226,
-32758,
-31234,
-29706,
-28247,
-26933,
-25865,
-25141,
-24837,
-25017,
-25672,
-26766,
-28194,
-29832,
-31544,
-33212,
-34768,
-36170,
-37437,
-38577,
-39615,
-40531,
-41292,
-41832,
-42105,
-42083,
-41813,
-41372,
-40916,
-40567,
-40480,
-40705,
-41268,
-42101,
-43115,
-44190,
-45241,
-46187,
-47016,
-47702,
-48253,
-48631,
-48791,
-48641,
-48075,
-47001,
-45345,
-43106,
-40333,
-37156,
-33750,
-30325,
-27069,
-24158,
-21701,
-19741,
-18292,
-17299,
-16725,
-16528,
-16672,
-17154,
-17940,
-18992,
-20226,
-21515,
-22727,
-23717,
-24397,
-24720,
-24739,
-24522,
-24217,
-23911,
-23719,
-23651,
-23734,
-23929,
-24234,
-24642,
-25194,
-25932,
-26910,
-28150,
-29642,
-31333,
-33124,
-34907,
-36551,
-37957,
-39027,
-39712,
-39978,
-39835,
-39320,
-38481,
-37388,
-36118,
-34725,
-33281,
-31820,
-30393,
-29046,
-27851,
-26881,
-26231,
-25974,
-26166,
-26807,
-27850,
-29202,
-30731,
-32318,
-33852,
-35271,
-36563,
-37726,
-38806,
-39788,
-40668,
-41386,
-41866,
-42055,
-41921,
-41505,
-40906,
-40286,
-39797,
-39608,
-39785,
-40346,
-41224,
-42287,
-43410,
-44470,
-45387,
-46149,
-46744,
-47205,
-47500,
-47594,
-47368,
-46717,
-45513,
-43693,
-41258,
-38291,
-34964,
-31474,
-28048,
-24875,
-22083,
-19769,
-17924,
-16568,
-15648,
-15165,
-15102,
-15446,
-16186,
-17255,
-18561,
-19977,
-21332,
-22511,
-23385,
-23931,
-24146,
-24110,
-23908,
-23654,
-23419,
-23270,
-23229,
-23317,
-23534,
-23899,
-24422,
-25141,
-26070,
-27232,
-28609,
-30185,
-31885,
-33641,
-35341,
-36888,
-38171,
-39121,
-39671,
-39822,
-39582,
-39014,
-38162,
-37115,
-35908,
-34605,
-33232,
-31831,
-30453,
-29158,
-28038,
-27178,
-26666,
-26564,
-26888,
-27626,
-28702,
-30036,
-31513,
-33051,
-34562,
-36007,
-37357,
-38589,
-39705,
-40656,
-41420,
-41938,
-42183,
-42132,
-41820,
-41320,
-40740,
-40234,
-39920,
-39921,
-40268,
-40961,
-41909,
-43010,
-44128,
-45158,
-46036,
-46726,
-47249,
-47604,
-47787,
-47746,
-47384,
-46576,
-45220,
-43243,
-40677,
-37628,
-34282,
-30874,
-27626,
-24713,
-22245,
-20257,
-18728,
-17629,
-16920,
-16595,
-16659,
-17110,
-17938,
-19063,
-20388,
-21759,
-23019,
-24043,
-24746,
-25110,
-25187,
-25053,
-24814,
-24573,
-24386,
-24301,
-24326,
-24447,
-24688,
-25037,
-25540,
-26230,
-27141,
-28298,
-29687,
-31269,
-32973,
-34703,
-36354,
-37833,
-39032,
-39900,
-40366,
-40423,
-40081,
-39367,
-38366,
-37142,
-35783,
-34375,
-32960,
-31597,
-30322,
-29165,
-28199,
-27484,
-27100,
-27119,
-27570,
-28433,
-29656,
-31098,
-32661,
-34194,
-35630,
-36921,
-38057,
-39076,
-39979,
-40776,
-41423,
-41881,
-42083,
-42024,
-41708,
-41225,
-40696,
-40249,
-40033,
-40108,
-40521,
-41213,
-42118,
-43112,
-44113,
-45034,
-45842,
-46523,
-47064,
-47446,
-47621,
-47488,
-46962,
-45913,
-44284,
-42052,
-39270,
-36082,
-32661,
-29227,
-25973,
-23069,
-20607,
-18649,
-17177,
-16183,
-15625,
-15489,
-15754,
-16412,
-17407,
-18679,
-20090,
-21502,
-22762,
-23722,
-24342,
-24578,
-24527,
-24270,
-23951,
-23664,
-23497,
-23467,
-23587,
-23824,
-24174,
-24637,
-25238,
-26022,
-27027,
-28280,
-29772,
-31470,
-33278,
-35094,
-36786,
-38223,
-39310,
-39969,
-40191,
-39988,
-39437,
-38611,
-37595,
-36455,
-35226,
-33928,
-32569,
-31172,
-29791,
-28513,
-27456,
-26734,
-26460,
-26661,
-27349,
-28424,
-29780,
-31289,
-32819,
-34308,
-35709,
-37021,
-38264,
-39424,
-40491,
-41403,
-42090,
-42488,
-42554,
-42309,
-41815,
-41203,
-40614,
-40193,
-40070,
-40277,
-40840,
-41673,
-42694,
-43786,
-44863,
-45843,
-46709,
-47419,
-47976,
-48331,
-48416,
-48150,
-47400,
-46113,
-44210,
-41754,
-38818,
-35588,
-32253,
-29019,
-26056,
-23465,
-21320,
-19614,
-18350,
-17495,
-17058,
-17020,
-17396,
-18144,
-19211,
-20480,
-21821,
-23068,
-24103,
-24821,
-25207,
-25285,
-25155,
-24912,
-24674,
-24518,
-24488,
-24605,
-24859,
-25253,
-25798,
-26514,
-27455,
-28634,
-30070,
-31715,
-33488,
-35270,
-36924,
-38329,
-39383,
-40039,
-40293,
-40154,
-39683,
-38898,
-37859,
-36581,
-35120,
-33512,
-31851,
-30228,
-28774,
-27594,
-26806,
-26459,
-26578,
-27134,
-28047,
-29238,
-30598,
-32048,
-33516,
-34961,
-36353,
-37656,
-38848,
-39859,
-40645,
-41133,
-41289,
-41115,
-40651,
-40019,
-39346,
-38800,
-38509,
-38570,
-38991,
-39748,
-40728,
-41828,
-42935,
-43960,
-44855,
-45591,
-46138,
-46453,
-46462,
-46054,
-45127,
-43589,
-41411,
-38637,
-35396,
-31876,
-28292,
-24876,
-21788,
-19175,
-17090,
-15565,
-14589,
-14149,
-14212,
-14745,
-15684,
-16952,
-18418,
-19946,
-21371,
-22565,
-23425,
-23928,
-24083,
-23997,
-23765,
-23522,
-23361,
-23347,
-23516,
-23848,
-24353,
-25000,
-25812,
-26810,
-28019,
-29463,
-31128,
-32949,
-34841,
-36659,
-38273,
-39555,
-40410,
-40797,
-40722,
-40222,
-39379,
-38257,
-36937,
-35478,
-33940,
-32372,
-30848,
-29437,
-28246,
-27364,
-26893,
-26876,
-27330,
-28203,
-29397,
-30788,
-32251,
-33689,
-35047,
-36316,
-37507,
-38629,
-39678,
-40586,
-41292,
-41695,
-41750,
-41460,
-40909,
-40240,
-39643,
-39271,
-39272,
-39647,
-40400,
-41385,
-42501,
-43612,
-44624,
-45509,
-46231,
-46798,
-47171,
-47290,
-47040,
-46308,
-44970,
-42983,
-40358,
-37219,
-33746,
-30185,
-26765,
-23689,
-21084,
-19011,
-17461,
-16404,
-15801,
-15609,
-15827,
-16425,
-17367,
-18588,
-19955,
-21323,
-22533,
-23445,
-24000,
-24184,
-24085,
-23808,
-23505,
-23279,
-23211,
-23311,
-23574,
-23948,
-24425,
-25008,
-25736,
-26683,
-27901,
-29411,
-31183,
-33101,
-35027,
-36759,
-38167,
-39103,
-39554,
-39528,
-39104,
-38374,
-37430,
-36315,
-35072,
-33701,
-32222,
-30688,
-29179,
-27824,
-26771,
-26140,
-26026,
-26441,
-27333,
-28596,
-30081,
-31655,
-33206,
-34668,
-36026,
-37282,
-38454,
-39525,
-40472,
-41218,
-41705,
-41872,
-41716,
-41294,
-40722,
-40154,
-39760,
-39669,
-39955,
-40615,
-41568,
-42696,
-43860,
-44947,
-45877,
-46623,
-47156,
-47483,
-47539,
-47268,
-46551,
-45295,
-43436,
-40979,
-38021,
-34728,
-31319,
-28016,
-25006,
-22420,
-20323,
-18722,
-17613,
-16955,
-16749,
-16956,
-17567,
-18504,
-19697,
-20998,
-22282,
-23399,
-24248,
-24780,
-24995,
-24956,
-24757,
-24498,
-24289,
-24177,
-24230,
-24424,
-24781,
-25271,
-25908,
-26709,
-27698,
-28915,
-30352,
-31991,
-33749,
-35506,
-37129,
-38478,
-39442,
-39978,
-40061,
-39750,
-39099,
-38185,
-37079,
-35821,
-34457,
-33024,
-31571,
-30173,
-28917,
-27915,
-27269,
-27057,
-27329,
-28058,
-29193,
-30613,
-32194,
-33801,
-35347,
-36760,
-38036,
-39179,
-40196,
-41088,
-41813,
-42310,
-42526,
-42434,
-42061,
-41514,
-40930,
-40480,
-40307,
-40488,
-41030,
-41861,
-42873,
-43942,
-44971,
-45900,
-46691,
-47349,
-47809,
-48044,
-47918,
-47336,
-46180,
-44380,
-41963,
-39013,
-35700,
-32257,
-28882,
-25801,
-23127,
-20961,
-19303,
-18153,
-17463,
-17209,
-17361,
-17888,
-18745,
-19857,
-21107,
-22360,
-23475,
-24336,
-24884,
-25118,
-25094,
-24917,
-24685,
-24502,
-24415,
-24450,
-24609,
-24880,
-25274,
-25809,
-26517,
-27448,
-28608,
-30007,
-31593,
-33301,
-35025,
-36662,
-38084,
-39210,
-39939,
-40247,
-40103,
-39550,
-38634,
-37441,
-36050,
-34550,
-32993,
-31460,
-29983,
-28649,
-27523,
-26710,
-26293,
-26349,
-26898,
-27906,
-29282,
-30887,
-32582,
-34237,
-35770,
-37144,
-38364,
-39436,
-40373,
-41141,
-41690,
-41966,
-41924,
-41590,
-41041,
-40422,
-39917,
-39684,
-39847,
-40427,
-41360,
-42517,
-43720,
-44836,
-45757,
-46469,
-46985,
-47352,
-47561,
-47561,
-47213,
-46359,
-44840,
-42592,
-39651,
-36198,
-32494,
-28843,
-25498,
-22641,
-20326,
-18543,
-17213,
-16291,
-15743,
-15608,
-15907,
-16663,
-17808,
-19223,
-20709,
-22077,
-23147,
-23847,
-24162,
-24178,
-24017,
-23788,
-23598,
-23488,
-23485,
-23586,
-23802,
-24150,
-24666,
-25401,
-26374,
-27627,
-29113,
-30822,
-32645,
-34507,
-36270,
-37827,
-39062,
-39895,
-40284,
-40221,
-39745,
-38919,
-37812,
-36501,
-35048,
-33512,
-31958,
-30453,
-29090,
-27970,
-27198,
-26855,
-26995,
-27602,
-28638,
-29984,
-31525,
-33136,
-34699,
-36170,
-37493,
-38688,
-39752,
-40688,
-41469,
-42048,
-42365,
-42392,
-42122,
-41638,
-41047,
-40530,
-40233,
-40282,
-40716,
-41503,
-42532,
-43671,
-44788,
-45775,
-46612,
-47254,
-47741,
-48017,
-48059,
-47735,
-46950,
-45570,
-43561,
-40928,
-37804,
-34371,
-30869,
-27532,
-24554,
-22051,
-20086,
-18637,
-17670,
-17136,
-16990,
-17229,
-17812,
-18720,
-19858,
-21119,
-22340,
-23377,
-24113,
-24496,
-24563,
-24405,
-24149,
-23930,
-23809,
-23836,
-23975,
-24203,
-24489,
-24857,
-25351,
-26067,
-27060,
-28374,
-29979,
-31775,
-33643,
-35416,
-36972,
-38193,
-39031,
-39455,
-39472,
-39097,
-38371,
-37320,
-36014,
-34509,
-32893,
-31256,
-29696,
-28298,
-27159,
-26346,
-25928,
-25934,
-26377,
-27215,
-28379,
-29759,
-31236,
-32709,
-34089,
-35357,
-36490,
-37523,
-38448,
-39253,
-39895,
-40299,
-40423,
-40248,
-39824,
-39270,
-38730,
-38387,
-38359,
-38735,
-39494,
-40557,
-41805,
-43082,
-44284,
-45313,
-46137,
-46730,
-47075,
-47135,
-46840,
-46106,
-44837,
-43000,
-40582,
-37707,
-34520,
-31245,
-28106,
-25272,
-22884,
-20971,
-19540,
-18551,
-17964,
-17774,
-17961,
-18550,
-19479,
-20692,
-22039,
-23350,
-24457,
-25228,
-25593,
-25596,
-25312,
-24890,
-24469,
-24153,
-24013,
-24061,
-24277,
-24646,
-25141,
-25776,
-26579,
-27574,
-28807,
-30262,
-31912,
-33681,
-35441,
-37068,
-38414,
-39376,
-39879,
-39925,
-39530,
-38804,
-37802,
-36641,
-35357,
-33997,
-32584,
-31150,
-29753,
-28494,
-27476,
-26842,
-26664,
-27004,
-27810,
-29007,
-30441,
-31988,
-33514,
-34958,
-36292,
-37515,
-38657,
-39690,
-40601,
-41301,
-41739,
-41847,
-41642,
-41182,
-40600,
-40056,
-39709,
-39681,
-40017,
-40696,
-41630,
-42693,
-43782,
-44794,
-45684,
-46436,
-47024,
-47436,
-47595,
-47405,
-46746,
-45503,
-43622,
-41111,
-38069,
-34675,
-31144,
-27712,
-24568,
-21866,
-19661,
-17997,
-16827,
-16151,
-15907,
-16095,
-16665,
-17584,
-18758,
-20079,
-21402,
-22577,
-23497,
-24076,
-24325,
-24287,
-24077,
-23793,
-23552,
-23413,
-23415,
-23562,
-23841,
-24265,
-24837,
-25606,
-26607,
-27862,
-29377,
-31081,
-32897,
-34677,
-36309,
-37650,
-38626,
-39188,
-39330,
-39084,
-38499,
-37621,
-36524,
-35241,
-33842,
-32370,
-30898,
-29503,
-28264,
-27287,
-26646,
-26435,
-26681,
-27403,
-28537,
-30009,
-31670,
-33410,
-35078,
-36613,
-37948,
-39086,
-40029,
-40771,
-41315,
-41612,
-41657,
-41441,
-41024,
-40519,
-40076,
-39857,
-39983,
-40496,
-41377,
-42495,
-43739,
-44933,
-45991,
-46839,
-47434,
-47760,
-47750,
-47341,
-46418,
-44926,
-42805,
-40125,
-36994,
-33615,
-30201,
-26967,
-24074,
-21635,
-19698,
-18294,
-17403,
-17029,
-17133,
-17683,
-18590,
-19754,
-21020,
-22241,
-23289,
-24048,
-24512,
-24671,
-24619,
-24432,
-24214,
-24040,
-23960,
-24004,
-24200,
-24545,
-25098,
-25858,
-26884,
-28188,
-29738,
-31507,
-33359,
-35192,
-36843,
-38188,
-39134,
-39625,
-39676,
-39321,
-38629,
-37667,
-36492,
-35146,
-33680,
-32138,
-30604,
-29190,
-28014,
-27223,
-26908,
-27116,
-27833,
-28951,
-30357,
-31885,
-33429,
-34893,
-36266,
-37519,
-38692,
-39736,
-40634,
-41307,
-41680,
-41730,
-41459,
-40971,
-40402,
-39930,
-39705,
-39845,
-40358,
-41212,
-42279,
-43438,
-44559,
-45549,
-46365,
-46961,
-47332,
-47403,
-47113,
-46336,
-44988,
-42998,
-40390,
-37282,
-33855,
-30369,
-27056,
-24114,
-21673,
-19757,
-18374,
-17451,
-16984,
-16925,
-17295,
-18053,
-19149,
-20458,
-21810,
-23026,
-23937,
-24467,
-24608,
-24461,
-24165,
-23872,
-23694,
-23686,
-23838,
-24119,
-24491,
-24957,
-25558,
-26370,
-27465,
-28881,
-30594,
-32506,
-34464,
-36293,
-37821,
-38930,
-39563,
-39707,
-39420,
-38753,
-37780,
-36552,
-35122,
-33541,
-31869,
-30222,
-28691,
-27435,
-26568,
-26174,
-26315,
-26948,
-28007,
-29381,
-30934,
-32562,
-34169,
-35708,
-37136,
-38439,
-39573,
-40501,
-41156,
-41503,
-41515,
-41233,
-40755,
-40213,
-39775,
-39585,
-39722,
-40230,
-41031,
-42054,
-43149,
-44246,
-45243,
-46129,
-46853,
-47393,
-47658,
-47551,
-46916,
-45659,
-43683,
-41043,
-37831,
-34275,
-30607,
-27086,
-23923,
-21248,
-19150,
-17627,
-16661,
-16221,
-16251,
-16712,
-17540,
-18641,
-19903,
-21178,
-22340,
-23260,
-23887,
-24194,
-24257,
-24140,
-23982,
-23858,
-23847,
-23987,
-24270,
-24711,
-25291,
-26046,
-26994,
-28178,
-29628,
-31302,
-33165,
-35064,
-36893,
-38457,
-39669,
-40412,
-40683,
-40492,
-39909,
-38995,
-37840,
-36480,
-34993,
-33420,
-31849,
-30389,
-29150,
-28278,
-27860,
-27957,
-28553,
-29571,
-30881,
-32356,
-33861,
-35321,
-36701,
-37983,
-39187,
-40281,
-41234,
-41966,
-42414,
-42525,
-42313,
-41866,
-41305,
-40822,
-40554,
-40628,
-41057,
-41819,
-42790,
-43865,
-44920,
-45868,
-46675,
-47300,
-47731,
-47911,
-47751,
-47152,
-45985,
-44184,
-41744,
-38743,
-35361,
-31827,
-28387,
-25269,
-22615,
-20516,
-18967,
-17942,
-17385,
-17255,
-17520,
-18153,
-19100,
-20279,
-21551,
-22763,
-23751,
-24407,
-24675,
-24606,
-24297,
-23911,
-23584,
-23436,
-23512,
-23813,
-24290,
-24919,
-25650,
-26526,
-27559,
-28802,
-30274,
-31916,
-33659,
-35335,
-36802,
-37915,
-38584,
-38790,
-38565,
-37984,
-37129,
-36063,
-34827,
-33433,
-31911,
-30297,
-28702,
-27240,
-26095,
-25395,
-25257,
-25693,
-26656,
-28009,
-29601,
-31268,
-32893,
-34413,
-35796,
-37066,
-38209,
-39224,
-40051,
-40625,
-40901,
-40857,
-40555,
-40115,
-39693,
-39478,
-39573,
-40054,
-40863,
-41915,
-43055,
-44174,
-45170,
-46030,
-46733,
-47291,
-47643,
-47704,
-47320,
-46349,
-44693,
-42338,
-39394,
-36057,
-32586,
-29220,
-26177,
-23557,
-21424,
-19770,
-18573,
-17830,
-17540,
-17708,
-18307,
-19272,
-20471,
-21747,
-22926,
-23862,
-24481,
-24760,
-24771,
-24591,
-24352,
-24129,
-24001,
-23996,
-24124,
-24395,
-24814,
-25419,
-26223,
-27292,
-28605,
-30186,
-31948,
-33808,
-35625,
-37253,
-38552,
-39423,
-39796,
-39691,
-39137,
-38228,
-37049,
-35672,
-34175,
-32596,
-30995,
-29452,
-28059,
-26965,
-26289,
-26149,
-26585,
-27555,
-28955,
-30597,
-32329,
-33978,
-35482,
-36813,
-37987,
-39055,
-39994,
-40791,
-41354,
-41622,
-41553,
-41187,
-40641,
-40074,
-39688,
-39607,
-39925,
-40612,
-41586,
-42712,
-43872,
-44946,
-45898,
-46656,
-47216,
-47486,
-47404,
-46846,
-45716,
-43954,
-41562,
-38633,
-35325,
-31848,
-28416,
-25229,
-22426,
-20098,
-18275,
-16969,
-16157,
-15837,
-15990,
-16577,
-17554,
-18801,
-20180,
-21525,
-22654,
-23461,
-23883,
-23949,
-23772,
-23470,
-23201,
-23052,
-23076,
-23274,
-23616,
-24088,
-24694,
-25475,
-26494,
-27796,
-29397,
-31228,
-33180,
-35071,
-36742,
-38033,
-38860,
-39202,
-39094,
-38609,
-37827,
-36811,
-35608,
-34249,
-32761,
-31205,
-29662,
-28262,
-27131,
-26422,
-26200,
-26536,
-27359,
-28605,
-30122,
-31777,
-33435,
-35023,
-36477,
-37804,
-38978,
-39996,
-40817,
-41388,
-41662,
-41617,
-41291,
-40777,
-40231,
-39822,
-39694,
-39951,
-40574,
-41513,
-42619,
-43757,
-44818,
-45720,
-46442,
-46974,
-47279,
-47295,
-46899,
-45966,
-44391,
-42152,
-39318,
-36074,
-32650,
-29306,
-26241,
-23586,
-21388,
-19644,
-18325,
-17436,
-16975,
-17002,
-17485,
-18423,
-19661,
-21048,
-22376,
-23472,
-24231,
-24635,
-24732,
-24639,
-24462,
-24308,
-24223,
-24246,
-24373,
-24627,
-25024,
-25612,
-26422,
-27483,
-28797,
-30319,
-31999,
-33737,
-35447,
-37012,
-38340,
-39328,
-39908,
-40039,
-39713,
-38983,
-37919,
-36623,
-35189,
-33699,
-32217,
-30797,
-29504,
-28410,
-27634,
-27254,
-27379,
-28006,
-29100,
-30531,
-32144,
-33779,
-35321,
-36722,
-37977,
-39123,
-40163,
-41074,
-41775,
-42170,
-42205,
-41871,
-41285,
-40617,
-40090,
-39883,
-40104,
-40737,
-41688,
-42790,
-43897,
-44901,
-45760,
-46486,
-47077,
-47533,
-47743,
-47600,
-46908,
-45563,
-43493,
-40757,
-37507,
-33983,
-30430,
-27110,
-24171,
-21746,
-19850,
-18486,
-17618,
-17214,
-17244,
-17687,
-18479,
-19567,
-20812,
-22082,
-23227,
-24104,
-24654,
-24857,
-24774,
-24525,
-24222,
-23990,
-23890,
-23952,
-24169,
-24525,
-25019,
-25690,
-26581,
-27763,
-29248,
-31019,
-32962,
-34933,
-36732,
-38200,
-39205,
-39703,
-39703,
-39284,
-38524,
-37520,
-36319,
-34963,
-33485,
-31921,
-30360,
-28899,
-27698,
-26868,
-26547,
-26750,
-27479,
-28628,
-30065,
-31638,
-33227,
-34730,
-36128,
-37403,
-38572,
-39639,
-40554,
-41272,
-41708,
-41813,
-41592,
-41112,
-40525,
-40013,
-39758,
-39886,
-40435,
-41344,
-42477,
-43672,
-44784,
-45727,
-46468,
-47022,
-47395,
-47548,
-47383,
-46751,
-45500,
-43533,
-40856,
-37593,
-33992,
-30325,
-26877,
-23856,
-21362,
-19438,
-18036,
-17119,
-16656,
-16639,
-17059,
-17892,
-19047,
-20394,
-21740,
-22928,
-23799,
-24321,
-24508,
-24462,
-24311,
-24178,
-24142,
-24239,
-24468,
-24801,
-25238,
-25787,
-26497,
-27426,
-28616,
-30073,
-31757,
-33555,
-35349,
-36983,
-38336,
-39330,
-39914,
-40109,
-39924,
-39409,
-38582,
-37473,
-36108,
-34550,
-32873,
-31231,
-29754,
-28624,
-27950,
-27826,
-28230,
-29116,
-30349,
-31801,
-33342,
-34866,
-36335,
-37697,
-38966,
-40104,
-41074,
-41820,
-42270,
-42390,
-42198,
-41761,
-41243,
-40794,
-40603,
-40758,
-41300,
-42165,
-43231,
-44366,
-45436,
-46372,
-47116,
-47645,
-47900,
-47802,
-47215,
-46022,
-44133,
-41557,
-38415,
-34906,
-31315,
-27879,
-24829,
-22265,
-20244,
-18749,
-17753,
-17233,
-17180,
-17573,
-18356,
-19445,
-20669,
-21873,
-22887,
-23598,
-23977,
-24059,
-23933,
-23731,
-23537,
-23444,
-23471,
-23648,
-23969,
-24475,
-25180,
-26150,
-27395,
-28920,
-30659,
-32497,
-34290,
-35862,
-37094,
-37886,
-38220,
-38126,
-37668,
-36922,
-35940,
-34760,
-33397,
-31878,
-30275,
-28676,
-27252,
-26141,
-25506,
-25413,
-25876,
-26813,
-28102,
-29596,
-31171,
-32732,
-34237,
-35646,
-36940,
-38073,
-38980,
-39611,
-39913,
-39901,
-39648,
-39271,
-38937,
-38796,
-38957,
-39478,
-40319,
-41402,
-42597,
-43776,
-44846,
-45714,
-46359,
-46729,
-46788,
-46463,
-45668,
-44299,
-42328,
-39740,
-36662,
-33264,
-29798,
-26512,
-23631,
-21299,
-19582,
-18489,
-17954,
-17933,
-18330,
-19090,
-20102,
-21257,
-22410,
-23404,
-24126,
-24496,
-24539,
-24339,
-24034,
-23768,
-23637,
-23692,
-23924,
-24284,
-24762,
-25345,
-26102,
-27096,
-28390,
-29998,
-31841,
-33790,
-35643,
-37225,
-38376,
-39031,
-39179,
-38877,
-38211,
-37251,
-36071,
-34696,
-33182,
-31572,
-29971,
-28493,
-27301,
-26532,
-26288,
-26610,
-27452,
-28704,
-30224,
-31852,
-33467,
-35005,
-36417,
-37719,
-38891,
-39901,
-40693,
-41182,
-41321,
-41116,
-40645,
-40070,
-39589,
-39386,
-39588,
-40220,
-41219,
-42437,
-43723,
-44920,
-45940,
-46720,
-47236,
-47433,
-47258,
-46595,
-45358,
-43462,
-40926,
-37815,
-34329,
-30672,
-27108,
-23844,
-21060,
-18847,
-17266,
-16309,
-15945,
-16129,
-16770,
-17784,
-19028,
-20374,
-21644,
-22732,
-23497,
-23933,
-24034,
-23895,
-23632,
-23370,
-23220,
-23257,
-23495,
-23944,
-24573,
-25389,
-26406,
-27652,
-29150,
-30879,
-32759,
-34654,
-36389,
-37795,
-38743,
-39189,
-39135,
-38665,
-37853,
-36774,
-35475,
-33987,
-32355,
-30666,
-29062,
-27710,
-26788,
-26427,
-26661,
-27453,
-28669,
-30145,
-31732,
-33305,
-34813,
-36230,
-37561,
-38782,
-39861,
-40722,
-41304,
-41557,
-41496,
-41196,
-40773,
-40397,
-40190,
-40282,
-40684,
-41391,
-42302,
-43334,
-44369,
-45352,
-46208,
-46909,
-47378,
-47532,
-47237,
-46361,
-44799,
-42521,
-39597,
-36215,
-32609,
-29076,
-25826,
-23059,
-20818,
-19147,
-17993,
-17345,
-17179,
-17489,
-18238,
-19356,
-20705,
-22099,
-23359,
-24310,
-24888,
-25085,
-25002,
-24766,
-24514,
-24363,
-24356,
-24525,
-24856,
-25353,
-26029,
-26928,
-28082,
-29513,
-31200,
-33052,
-34941,
-36700,
-38163,
-39207,
-39758,
-39823,
-39440,
-38720,
-37715,
-36534,
-35194,
-33749,
-32245,
-30747,
-29393,
-28315,
-27658,
-27533,
-27949,
-28878,
-30174,
-31697,
-33294,
-34851,
-36329,
-37693,
-38951,
-40076,
-41011,
-41690,
-42038,
-42034,
-41721,
-41210,
-40674,
-40293,
-40206,
-40505,
-41158,
-42107,
-43216,
-44356,
-45433,
-46350,
-47085,
-47585,
-47796,
-47649,
-47015,
-45814,
-43944,
-41428,
-38334,
-34857,
-31237,
-27745,
-24616,
-22035,
-20057,
-18714,
-17927,
-17639,
-17771,
-18270,
-19076,
-20121,
-21297,
-22468,
-23497,
-24244,
-24676,
-24780,
-24668,
-24467,
-24297,
-24266,
-24399,
-24682,
-25097,
-25610,
-26266,
-27107,
-28233,
-29671,
-31422,
-33382,
-35377,
-37213,
-38681,
-39645,
-40049,
-39900,
-39286,
-38299,
-37036,
-35584,
-33998,
-32348,
-30719,
-29205,
-27957,
-27083,
-26707,
-26866,
-27549,
-28668,
-30098,
-31692,
-33331,
-34916,
-36405,
-37771,
-39000,
-40051,
-40881,
-41406,
-41596,
-41430,
-40991,
-40404,
-39868,
-39550,
-39604,
-40076,
-40928,
-42052,
-43294,
-44507,
-45586,
-46453,
-47076,
-47398,
-47367,
-46878,
-45828,
-44147,
-41798,
-38863,
-35491,
-31893,
-28326,
-24997,
-22102,
-19734,
-17965,
-16789,
-16201,
-16160,
-16605,
-17476,
-18640,
-19982,
-21331,
-22531,
-23467,
-24047,
-24273,
-24200,
-23929,
-23607,
-23339,
-23253,
-23374,
-23758,
-24361,
-25205,
-26249,
-27520,
-29002,
-30677,
-32497,
-34335,
-36079,
-37550,
-38646,
-39272,
-39424,
-39140,
-38486,
-37550,
-36375,
-35020,
-33515,
-31933,
-30376,
-28993,
-27933,
-27347,
-27309,
-27820,
-28805,
-30128,
-31644,
-33231,
-34806,
-36324,
-37769,
-39105,
-40303,
-41266,
-41951,
-42271,
-42253,
-41945,
-41466,
-40987,
-40642,
-40574,
-40823,
-41399,
-42242,
-43255,
-44348,
-45429,
-46415,
-47253,
-47844,
-48109,
-47914,
-47157,
-45716,
-43592,
-40801,
-37529,
-33976,
-30420,
-27104,
-24216,
-21863,
-20074,
-18815,
-18051,
-17727,
-17837,
-18338,
-19197,
-20325,
-21570,
-22786,
-23788,
-24484,
-24821,
-24855,
-24686,
-24448,
-24259,
-24194,
-24279,
-24531,
-24918,
-25483,
-26231,
-27228,
-28500,
-30046,
-31806,
-33666,
-35463,
-37039,
-38244,
-38988,
-39243,
-39029,
-38419,
-37486,
-36310,
-34955,
-33470,
-31917,
-30370,
-28941,
-27752,
-26945,
-26613,
-26813,
-27507,
-28611,
-29978,
-31470,
-32970,
-34404,
-35754,
-37012,
-38163,
-39181,
-39975,
-40484,
-40649,
-40476,
-40066,
-39551,
-39130,
-38944,
-39110,
-39611,
-40415,
-41374,
-42413,
-43401,
-44317,
-45101,
-45729,
-46122,
-46170,
-45733,
-44680,
-42928,
-40483,
-37445,
-34023,
-30445,
-26993,
-23863,
-21233,
-19170,
-17699,
-16798,
-16420,
-16517,
-17029,
-17886,
-18996,
-20245,
-21490,
-22619,
-23500,
-24116,
-24434,
-24553,
-24537,
-24513,
-24546,
-24695,
-24974,
-25383,
-25932,
-26648,
-27582,
-28782,
-30285,
-32051,
-34004,
-35964,
-37761,
-39182,
-40110,
-40466,
-40279,
-39631,
-38637,
-37407,
-36037,
-34572,
-33063,
-31557,
-30116,
-28856,
-27886,
-27326,
-27254,
-27683,
-28575,
-29818,
-31298,
-32869,
-34453,
-35961,
-37377,
-38656,
-39782,
-40695,
-41344,
-41669,
-41665,
-41361,
-40876,
-40357,
-39985,
-39907,
-40210,
-40894,
-41891,
-43062,
-44286,
-45423,
-46400,
-47150,
-47621,
-47750,
-47437,
-46585,
-45092,
-42936,
-40154,
-36892,
-33355,
-29787,
-26410,
-23398,
-20869,
-18865,
-17426,
-16549,
-16236,
-16483,
-17222,
-18365,
-19734,
-21145,
-22394,
-23341,
-23914,
-24127,
-24076,
-23875,
-23662,
-23509,
-23487,
-23596,
-23856,
-24274,
-24893,
-25747,
-26896,
-28333,
-30037,
-31911,
-33824,
-35615,
-37148,
-38293,
-38999,
-39244,
-39057,
-38492,
-37600,
-36436,
-35044,
-33479,
-31817,
-30163,
-28662,
-27464,
-26717,
-26510,
-26872,
-27741,
-29007,
-30508,
-32108,
-33684,
-35183,
-36578,
-37858,
-39026,
-40011,
-40780,
-41234,
-41339,
-41098,
-40577,
-39913,
-39271,
-38814,
-38661,
-38878,
-39429,
-40265,
-41242,
-42273,
-43242,
-44090,
-44800,
-45342,
-45740,
-45954,
-45955,
-45665,
-44997,
-43864,
-42214,
-40035,
-37393,
-34406,
-31250,
-28110,
-25179,
-22587,
-20426,
-18727,
-17481,
-16664,
-16247,
-16211,
-16553,
-17247,
-18253,
-19491,
-20816,
-22107,
-23188,
-23968,
-24398,
-24492,
-24350,
-24077,
-23800,
-23609,
-23553,
-23631,
-23833,
-24116,
-24487,
-24942,
-25526,
-26279,
-27241,
-28421,
-29803,
-31332,
-32928,
-34493,
-35935,
-37153,
-38095,
-38697,
-38942,
-38827,
-38362,
-37585,
-36537,
-35278,
-33870,
-32395,
-30932,
-29563,
-28375,
-27424,
-26783,
-26473,
-26519,
-26910,
-27619,
-28605,
-29800,
-31135,
-32530,
-33917,
-35236,
-36453,
-37544,
-38510,
-39329,
-40003,
-40482,
-40748,
-40764,
-40538,
-40120,
-39600,
-39118,
-38804,
-38773,
-39089,
-39727,
-40630,
-41670,
-42729,
-43707,
-44543,
-45213,
-45730,
-46092,
-46275,
-46234,
-45849,
-45042,
-43703,
-41804,
-39384,
-36532,
-33444,
-30285,
-27264,
-24517,
-22141,
-20187,
-18649,
-17537,
-16827,
-16528,
-16642,
-17140,
-17999,
-19107,
-20362,
-21605,
-22715,
-23570,
-24135,
-24400,
-24420,
-24287,
-24076,
-23888,
-23760,
-23737,
-23808,
-23972,
-24219,
-24548,
-24992,
-25586,
-26377,
-27416,
-28698,
-30219,
-31892,
-33616,
-35271,
-36713,
-37871,
-38646,
-39046,
-39056,
-38721,
-38082,
-37174,
-36052,
-34750,
-33325,
-31841,
-30371,
-29004,
-27821,
-26910,
-26330,
-26129,
-26316,
-26873,
-27753,
-28885,
-30182,
-31559,
-32946,
-34287,
-35558,
-36739,
-37829,
-38810,
-39658,
-40323,
-40764,
-40931,
-40828,
-40470,
-39958,
-39399,
-38944,
-38722,
-38824,
-39278,
-40056,
-41053,
-42155,
-43242,
-44211,
-45039,
-45692,
-46205,
-46551,
-46720,
-46610,
-46129,
-45153,
-43600,
-41471,
-38808,
-35776,
-32535,
-29310,
-26267,
-23546,
-21233,
-19359,
-17939,
-16946,
-16390,
-16224,
-16468,
-17045,
-17944,
-19052,
-20290,
-21523,
-22642,
-23538,
-24151,
-24456,
-24488,
-24314,
-24042,
-23760,
-23567,
-23503,
-23604,
-23857,
-24255,
-24795,
-25466,
-26311,
-27331,
-28563,
-29988,
-31585,
-33272,
-34972,
-36555,
-37923,
-38972,
-39641,
-39902,
-39763,
-39284,
-38513,
-37550,
-36437,
-35235,
-33976,
-32681,
-31389,
-30145,
-29034,
-28149,
-27587,
-27426,
-27696,
-28381,
-29411,
-30674,
-32063,
-33470,
-34832,
-36112,
-37313,
-38433,
-39488,
-40435,
-41243,
-41832,
-42152,
-42165,
-41894,
-41413,
-40841,
-40326,
-40010,
-39987,
-40307,
-40929,
-41791,
-42767,
-43766,
-44685,
-45493,
-46159,
-46698,
-47098,
-47334,
-47350,
-47053,
-46342,
-45136,
-43384,
-41102,
-38375,
-35333,
-32169,
-29052,
-26163,
-23610,
-21477,
-19787,
-18537,
-17712,
-17294,
-17266,
-17617,
-18310,
-19284,
-20451,
-21683,
-22857,
-23845,
-24568,
-24987,
-25116,
-25024,
-24781,
-24503,
-24251,
-24102,
-24078,
-24195,
-24443,
-24827,
-25323,
-25971,
-26759,
-27739,
-28911,
-30274,
-31796,
-33399,
-34989,
-36450,
-37668,
-38557,
-39070,
-39182,
-38931,
-38343,
-37480,
-36388,
-35119,
-33704,
-32209,
-30673,
-29187,
-27838,
-26713,
-25919,
-25502,
-25521,
-25953,
-26771,
-27880,
-29200,
-30627,
-32079,
-33506,
-34855,
-36137,
-37315,
-38403,
-39350,
-40131,
-40685,
-40984,
-41003,
-40776,
-40366,
-39881,
-39459,
-39209,
-39259,
-39629,
-40337,
-41304,
-42425,
-43592,
-44681,
-45631,
-46402,
-46987,
-47398,
-47615,
-47601,
-47262,
-46504,
-45216,
-43358,
-40931,
-38054,
-34876,
-31617,
-28475,
-25616,
-23154,
-21133,
-19558,
-18411,
-17680,
-17344,
-17421,
-17883,
-18709,
-19820,
-21097,
-22401,
-23576,
-24499,
-25097,
-25355,
-25325,
-25100,
-24785,
-24495,
-24283,
-24199,
-24236,
-24382,
-24635,
-24991,
-25492,
-26175,
-27081,
-28245,
-29639,
-31235,
-32927,
-34627,
-36208,
-37577,
-38650,
-39375,
-39734,
-39727,
-39375,
-38715,
-37781,
-36624,
-35294,
-33836,
-32337,
-30835,
-29451,
-28223,
-27277,
-26641,
-26396,
-26543,
-27092,
-27993,
-29188,
-30591,
-32105,
-33644,
-35121,
-36492,
-37708,
-38779,
-39685,
-40432,
-41011,
-41378,
-41527,
-41429,
-41106,
-40635,
-40109,
-39686,
-39483,
-39606,
-40082,
-40874,
-41881,
-42981,
-44046,
-44996,
-45783,
-46409,
-46869,
-47172,
-47254,
-47050,
-46448,
-45341,
-43678,
-41444,
-38727,
-35657,
-32423,
-29215,
-26210,
-23533,
-21271,
-19441,
-18061,
-17094,
-16545,
-16383,
-16618,
-17206,
-18123,
-19268,
-20541,
-21803,
-22919,
-23792,
-24355,
-24618,
-24616,
-24454,
-24214,
-23995,
-23855,
-23822,
-23905,
-24093,
-24379,
-24782,
-25320,
-26046,
-26990,
-28187,
-29620,
-31247,
-32976,
-34697,
-36282,
-37624,
-38634,
-39269,
-39521,
-39395,
-38951,
-38197,
-37215,
-36010,
-34661,
-33199,
-31710,
-30266,
-28953,
-27867,
-27071,
-26637,
-26588,
-26931,
-27649,
-28667,
-29935,
-31336,
-32801,
-34237,
-35598,
-36845,
-37974,
-38972,
-39848,
-40563,
-41103,
-41413,
-41469,
-41284,
-40890,
-40399,
-39924,
-39615,
-39575,
-39874,
-40501,
-41397,
-42440,
-43513,
-44500,
-45324,
-45977,
-46445,
-46775,
-46946,
-46933,
-46655,
-45983,
-44831,
-43104,
-40823,
-38055,
-34972,
-31774,
-28664,
-25824,
-23355,
-21322,
-19725,
-18549,
-17779,
-17406,
-17437,
-17855,
-18639,
-19709,
-20956,
-22247,
-23433,
-24409,
-25090,
-25460,
-25551,
-25427,
-25184,
-24911,
-24677,
-24554,
-24541,
-24677,
-24932,
-25321,
-25841,
-26509,
-27357,
-28407,
-29673,
-31137,
-32749,
-34428,
-36054,
-37524,
-38713,
-39545,
-39981,
-40001,
-39654,
-38986,
-38074,
-36987,
-35782,
-34508,
-33188,
-31864,
-30561,
-29348,
-28297,
-27507,
-27074,
-27061,
-27504,
-28362,
-29552,
-30956,
-32436,
-33892,
-35250,
-36494,
-37622,
-38680,
-39642,
-40521,
-41233,
-41723,
-41928,
-41822,
-41440,
-40886,
-40287,
-39815,
-39597,
-39723,
-40208,
-40999,
-41984,
-43048,
-44066,
-44965,
-45717,
-46319,
-46800,
-47155,
-47354,
-47312,
-46910,
-46023,
-44552,
-42472,
-39828,
-36773,
-33483,
-30199,
-27099,
-24357,
-22039,
-20187,
-18776,
-17782,
-17173,
-16946,
-17083,
-17598,
-18430,
-19541,
-20792,
-22069,
-23221,
-24130,
-24741,
-25024,
-25054,
-24888,
-24656,
-24421,
-24268,
-24212,
-24264,
-24411,
-24655,
-25004,
-25500,
-26176,
-27088,
-28244,
-29659,
-31266,
-33006,
-34751,
-36397,
-37811,
-38907,
-39612,
-39904,
-39797,
-39340,
-38590,
-37629,
-36511,
-35291,
-33999,
-32672,
-31333,
-30045,
-28862,
-27882,
-27184,
-26857,
-26944,
-27460,
-28366,
-29592,
-31021,
-32565,
-34091,
-35557,
-36878,
-38064,
-39093,
-39968,
-40691,
-41224,
-41552,
-41654,
-41507,
-41181,
-40711,
-40243,
-39877,
-39741,
-39900,
-40380,
-41132,
-42082,
-43109,
-44123,
-45048,
-45836,
-46499,
-47022,
-47406,
-47621,
-47583,
-47210,
-46384,
-45038,
-43122,
-40696,
-37839,
-34742,
-31566,
-28532,
-25768,
-23405,
-21474,
-19971,
-18874,
-18127,
-17713,
-17611,
-17833,
-18375,
-19230,
-20341,
-21620,
-22939,
-24159,
-25150,
-25834,
-26175,
-26212,
-26021,
-25714,
-25392,
-25146,
-25010,
-25007,
-25120,
-25330,
-25638,
-26037,
-26578,
-27271,
-28170,
-29279,
-30584,
-32054,
-33609,
-35176,
-36657,
-37967,
-39027,
-39771,
-40170,
-40205,
-39894,
-39280,
-38413,
-37362,
-36195,
-34945,
-33677,
-32393,
-31133,
-29929,
-28827,
-27907,
-27236,
-26908,
-26964,
-27433,
-28278,
-29422,
-30758,
-32168,
-33540,
-34811,
-35945,
-36959,
-37875,
-38731,
-39527,
-40239,
-40812,
-41169,
-41257,
-41051,
-40582,
-39955,
-39288,
-38754,
-38464,
-38516,
-38919,
-39627,
-40542,
-41553,
-42542,
-43439,
-44210,
-44835,
-45348,
-45730,
-45975,
-46013,
-45763,
-45107,
-43972,
-42285,
-40068,
-37385,
-34377,
-31209,
-28069,
-25112,
-22475,
-20224,
-18393,
-16988,
-15979,
-15371,
-15135,
-15278,
-15792,
-16634,
-17770,
-19081,
-20479,
-21817,
-22984,
-23889,
-24480,
-24762,
-24790,
-24631,
-24402,
-24174,
-24043,
-24029,
-24168,
-24431,
-24813,
-25292,
-25859,
-26543,
-27362,
-28354,
-29554,
-30943,
-32516,
-34178,
-35850,
-37395,
-38708,
-39689,
-40272,
-40451,
-40238,
-39701,
-38904,
-37927,
-36825,
-35646,
-34413,
-33145,
-31865,
-30598,
-29413,
-28362,
-27544,
-27021,
-26871,
-27105,
-27731,
-28684,
-29889,
-31249,
-32660,
-34044,
-35350,
-36546,
-37638,
-38631,
-39527,
-40317,
-40966,
-41422,
-41648,
-41611,
-41320,
-40834,
-40239,
-39671,
-39243,
-39078,
-39233,
-39721,
-40513,
-41499,
-42603,
-43683,
-44682,
-45514,
-46171,
-46639,
-46922,
-47008,
-46863,
-46418,
-45598,
-44321,
-42524,
-40216,
-37438,
-34336,
-31071,
-27860,
-24885,
-22306,
-20207,
-18610,
-17480,
-16746,
-16348,
-16228,
-16385,
-16815,
-17545,
-18546,
-19776,
-21108,
-22409,
-23515,
-24309,
-24732,
-24811,
-24625,
-24321,
-24009,
-23810,
-23743,
-23825,
-23994,
-24236,
-24512,
-24871,
-25346,
-26019,
-26937,
-28124,
-29558,
-31167,
-32875,
-34558,
-36145,
-37536,
-38675,
-39518,
-40018,
-40176,
-39974,
-39441,
-38613,
-37545,
-36305,
-34963,
-33571,
-32191,
-30855,
-29616,
-28512,
-27611,
-26978,
-26683,
-26777,
-27287,
-28171,
-29377,
-30771,
-32248,
-33676,
-34994,
-36158,
-37198,
-38150,
-39053,
-39928,
-40734,
-41414,
-41879,
-42060,
-41935,
-41541,
-40978,
-40387,
-39912,
-39673,
-39739,
-40116,
-40766,
-41600,
-42542,
-43502,
-44423,
-45268,
-46012,
-46624,
-47094,
-47357,
-47374,
-47072,
-46371,
-45231,
-43601,
-41500,
-38981,
-36130,
-33105,
-30038,
-27104,
-24436,
-22127,
-20264,
-18839,
-17876,
-17318,
-17148,
-17313,
-17780,
-18506,
-19440,
-20527,
-21691,
-22845,
-23901,
-24773,
-25398,
-25760,
-25865,
-25776,
-25573,
-25336,
-25151,
-25059,
-25082,
-25224,
-25462,
-25810,
-26258,
-26849,
-27605,
-28561,
-29718,
-31064,
-32547,
-34096,
-35640,
-37069,
-38330,
-39324,
-40015,
-40356,
-40335,
-39975,
-39308,
-38402,
-37320,
-36128,
-34874,
-33595,
-32313,
-31064,
-29884,
-28847,
-28028,
-27525,
-27392,
-27678,
-28348,
-29348,
-30575,
-31912,
-33267,
-34568,
-35784,
-36915,
-37981,
-38981,
-39930,
-40768,
-41466,
-41943,
-42166,
-42110,
-41810,
-41333,
-40785,
-40295,
-39960,
-39882,
-40082,
-40567,
-41281,
-42156,
-43107,
-44064,
-44962,
-45763,
-46436,
-46959,
-47300,
-47426,
-47274,
-46794,
-45916,
-44597,
-42810,
-40587,
-37964,
-35078,
-32031,
-29014,
-26148,
-23587,
-21407,
-19664,
-18371,
-17497,
-17028,
-16901,
-17125,
-17636,
-18433,
-19454,
-20624,
-21856,
-23021,
-24009,
-24734,
-25142,
-25250,
-25116,
-24831,
-24516,
-24250,
-24105,
-24100,
-24229,
-24465,
-24789,
-25197,
-25708,
-26372,
-27227,
-28320,
-29645,
-31178,
-32833,
-34519,
-36103,
-37494,
-38585,
-39349,
-39754,
-39832,
-39608,
-39131,
-38431,
-37541,
-36472,
-35253,
-33898,
-32468,
-31018,
-29647,
-28435,
-27481,
-26848,
-26582,
-26688,
-27151,
-27919,
-28946,
-30153,
-31489,
-32880,
-34283,
-35645,
-36931,
-38112,
-39170,
-40078,
-40830,
-41383,
-41730,
-41835,
-41709,
-41364,
-40876,
-40331,
-39848,
-39555,
-39526,
-39826,
-40436,
-41287,
-42297,
-43344,
-44342,
-45231,
-45974,
-46573,
-47018,
-47298,
-47355,
-47126,
-46501,
-45404,
-43770,
-41611,
-38979,
-36022,
-32892,
-29787,
-26875,
-24277,
-22084,
-20296,
-18925,
-17912,
-17246,
-16900,
-16875,
-17183,
-17817,
-18753,
-19922,
-21229,
-22543,
-23742,
-24705,
-25375,
-25728,
-25789,
-25654,
-25387,
-25112,
-24893,
-24789,
-24813,
-24986,
-25261,
-25665,
-26150,
-26769,
-27508,
-28434,
-29536,
-30850,
-32317,
-33907,
-35504,
-37016,
-38323,
-39335,
-39986,
-40258,
-40157,
-39747,
-39080,
-38234,
-37257,
-36183,
-35030,
-33802,
-32510,
-31190,
-29900,
-28738,
-27812,
-27231,
-27067,
-27362,
-28066,
-29120,
-30388,
-31749,
-33112,
-34381,
-35562,
-36636,
-37651,
-38606,
-39515,
-40335,
-41019,
-41508,
-41739,
-41710,
-41418,
-40937,
-40359,
-39795,
-39368,
-39172,
-39271,
-39684,
-40376,
-41276,
-42289,
-43314,
-44260,
-45076,
-45727,
-46213,
-46529,
-46657,
-46559,
-46154,
-45359,
-44076,
-42267,
-39932,
-37150,
-34069,
-30872,
-27762,
-24915,
-22447,
-20438,
-18864,
-17711,
-16908,
-16411,
-16205,
-16277,
-16641,
-17306,
-18225,
-19353,
-20560,
-21744,
-22755,
-23516,
-23967,
-24118,
-24028,
-23773,
-23449,
-23150,
-22921,
-22829,
-22865,
-23071,
-23423,
-23946,
-24636,
-25491,
-26524,
-27715,
-29063,
-30543,
-32120,
-33752,
-35351,
-36849,
-38130,
-39124,
-39757,
-40013,
-39904,
-39485,
-38824,
-37983,
-37028,
-35968,
-34831,
-33619,
-32360,
-31106,
-29945,
-28966,
-28277,
-27946,
-28007,
-28459,
-29232,
-30261,
-31440,
-32690,
-33944,
-35150,
-36296,
-37368,
-38373,
-39300,
-40137,
-40856,
-41416,
-41771,
-41897,
-41768,
-41422,
-40918,
-40347,
-39843,
-39509,
-39452,
-39721,
-40316,
-41173,
-42208,
-43295,
-44332,
-45240,
-45967,
-46518,
-46892,
-47109,
-47141,
-46945,
-46426,
-45490,
-44041,
-42041,
-39510,
-36558,
-33352,
-30095,
-26991,
-24205,
-21835,
-19935,
-18469,
-17414,
-16720,
-16354,
-16323,
-16617,
-17239,
-18159,
-19306,
-20575,
-21839,
-22972,
-23864,
-24470,
-24778,
-24833,
-24720,
-24516,
-24312,
-24151,
-24074,
-24083,
-24177,
-24374,
-24678,
-25137,
-25784,
-26644,
-27736,
-29033,
-30490,
-32046,
-33620,
-35147,
-36559,
-37799,
-38817,
-39555,
-39981,
-40047,
-39755,
-39122,
-38194,
-37045,
-35754,
-34387,
-33003,
-31636,
-30314,
-29082,
-27993,
-27115,
-26547,
-26344,
-26559,
-27182,
-28149,
-29375,
-30740,
-32140,
-33499,
-34770,
-35940,
-37015,
-38012,
-38930,
-39767,
-40496,
-41084,
-41487,
-41678,
-41634,
-41368,
-40918,
-40359,
-39795,
-39335,
-39096,
-39143,
-39517,
-40186,
-41081,
-42098,
-43131,
-44086,
-44913,
-45592,
-46136,
-46566,
-46890,
-47078,
-47086,
-46803,
-46148,
-45006,
-43342,
-41137,
-38478,
-35476,
-32313,
-29183,
-26255,
-23688,
-21551,
-19882,
-18648,
-17795,
-17255,
-16980,
-16949,
-17164,
-17649,
-18406,
-19420,
-20616,
-21898,
-23122,
-24166,
-24929,
-25368,
-25500,
-25404,
-25164,
-24896,
-24665,
-24516,
-24462,
-24481,
-24575,
-24728,
-24975,
-25335,
-25855,
-26561,
-27460,
-28552,
-29808,
-31193,
-32665,
-34172,
-35654,
-37043,
-38266,
-39231,
-39899,
-40212,
-40176,
-39824,
-39195,
-38365,
-37377,
-36284,
-35094,
-33851,
-32547,
-31248,
-29979,
-28831,
-27868,
-27157,
-26771,
-26716,
-27032,
-27674,
-28616,
-29791,
-31110,
-32508,
-33872,
-35167,
-36330,
-37364,
-38288,
-39119,
-39882,
-40571,
-41153,
-41567,
-41771,
-41712,
-41407,
-40922,
-40340,
-39813,
-39445,
-39333,
-39519,
-39984,
-40684,
-41528,
-42448,
-43365,
-44235,
-45020,
-45714,
-46276,
-46716,
-46978,
-47043,
-46853,
-46352,
-45487,
-44207,
-42484,
-40330,
-37788,
-34966,
-31999,
-29039,
-26247,
-23738,
-21607,
-19870,
-18538,
-17561,
-16917,
-16574,
-16524,
-16765,
-17299,
-18101,
-19123,
-20296,
-21498,
-22642,
-23605,
-24340,
-24792,
-24998,
-24980,
-24834,
-24621,
-24417,
-24272,
-24213,
-24251,
-24373,
-24578,
-24855,
-25219,
-25690,
-26289,
-27061,
-28024,
-29183,
-30539,
-32039,
-33625,
-35212,
-36689,
-37962,
-38943,
-39569,
-39825,
-39730,
-39326,
-38691,
-37874,
-36937,
-35892,
-34756,
-33516,
-32196,
-30819,
-29458,
-28196,
-27141,
-26372,
-25977,
-25957,
-26334,
-27044,
-28039,
-29236,
-30566,
-31951,
-33342,
-34674,
-35932,
-37080,
-38125,
-39061,
-39881,
-40583,
-41131,
-41493,
-41636,
-41531,
-41205,
-40695,
-40110,
-39550,
-39147,
-38990,
-39142,
-39596,
-40323,
-41230,
-42237,
-43250,
-44202,
-45050,
-45773,
-46354,
-46799,
-47075,
-47169,
-47016,
-46556,
-45714,
-44429,
-42649,
-40403,
-37716,
-34732,
-31590,
-28482,
-25584,
-23033,
-20926,
-19275,
-18073,
-17251,
-16760,
-16559,
-16621,
-16963,
-17573,
-18460,
-19561,
-20814,
-22097,
-23302,
-24324,
-25087,
-25577,
-25796,
-25805,
-25674,
-25474,
-25277,
-25132,
-25076,
-25121,
-25278,
-25527,
-25873,
-26300,
-26820,
-27447,
-28204,
-29131,
-30242,
-31539,
-33003,
-34558,
-36138,
-37618,
-38916,
-39920,
-40597,
-40898,
-40842,
-40459,
-39789,
-38900,
-37840,
-36657,
-35398,
-34096,
-32788,
-31516,
-30324,
-29257,
-28390,
-27757,
-27434,
-27438,
-27789,
-28479,
-29449,
-30648,
-31974,
-33351,
-34683,
-35925,
-37026,
-37997,
-38853,
-39619,
-40327,
-40967,
-41522,
-41926,
-42134,
-42076,
-41769,
-41231,
-40586,
-39947,
-39483,
-39292,
-39456,
-39953,
-40727,
-41660,
-42646,
-43576,
-44407,
-45106,
-45703,
-46194,
-46612,
-46902,
-47032,
-46905,
-46437,
-45551,
-44184,
-42336,
-40018,
-37334,
-34376,
-31320,
-28299,
-25492,
-22986,
-20886,
-19193,
-17900,
-16966,
-16341,
-16001,
-15943,
-16172,
-16703,
-17526,
-18582,
-19790,
-21014,
-22135,
-23037,
-23660,
-23991,
-24064,
-23955,
-23734,
-23483,
-23246,
-23074,
-22970,
-22980,
-23098,
-23366,
-23781,
-24365,
-25108,
-26006,
-27050,
-28223,
-29528,
-30937,
-32438,
-33968,
-35477,
-36862,
-38054,
-38965,
-39563,
-39831,
-39795,
-39503,
-39007,
-38352,
-37572,
-36674,
-35667,
-34551,
-33353,
-32106,
-30887,
-29762,
-28837,
-28169,
-27836,
-27842,
-28193,
-28843,
-29734,
-30790,
-31954,
-33147,
-34352,
-35522,
-36654,
-37737,
-38763,
-39715,
-40572,
-41291,
-41852,
-42190,
-42306,
-42168,
-41814,
-41292,
-40689,
-40119,
-39687,
-39498,
-39606,
-40026,
-40714,
-41597,
-42573,
-43551,
-44460,
-45256,
-45924,
-46467,
-46869,
-47124,
-47171,
-46968,
-46430,
-45502,
-44137,
-42316,
-40065,
-37433,
-34533,
-31474,
-28431,
-25543,
-22961,
-20782,
-19062,
-17786,
-16917,
-16378,
-16108,
-16083,
-16287,
-16757,
-17503,
-18523,
-19750,
-21084,
-22372,
-23473,
-24287,
-24753,
-24912,
-24815,
-24598,
-24338,
-24135,
-24015,
-23991,
-24046,
-24172,
-24360,
-24632,
-25012,
-25541,
-26240,
-27150,
-28245,
-29554,
-31002,
-32578,
-34188,
-35758,
-37196,
-38406,
-39319,
-39886,
-40096,
-39960,
-39533,
-38851,
-37986,
-36954,
-35815,
-34566,
-33252,
-31897,
-30549,
-29273,
-28136,
-27207,
-26555,
-26225,
-26254,
-26635,
-27359,
-28366,
-29588,
-30953,
-32352,
-33740,
-35032,
-36223,
-37290,
-38249,
-39113,
-39881,
-40540,
-41057,
-41390,
-41504,
-41380,
-41039,
-40535,
-39969,
-39448,
-39096,
-38995,
-39213,
-39727,
-40510,
-41459,
-42483,
-43486,
-44402,
-45189,
-45849,
-46377,
-46772,
-47018,
-47059,
-46819,
-46226,
-45200,
-43702,
-41742,
-39360,
-36663,
-33761,
-30807,
-27920,
-25243,
-22859,
-20842,
-19224,
-18004,
-17165,
-16660,
-16468,
-16542,
-16892,
-17492,
-18350,
-19422,
-20648,
-21935,
-23150,
-24181,
-24934,
-25356,
-25487,
-25373,
-25134,
-24863,
-24645,
-24528,
-24514,
-24597,
-24755,
-24977,
-25281,
-25683,
-26227,
-26938,
-27835,
-28925,
-30184,
-31595,
-33096,
-34640,
-36139,
-37511,
-38669,
-39529,
-40045,
-40199,
-40006,
-39532,
-38830,
-37977,
-37017,
-35976,
-34865,
-33691,
-32461,
-31216,
-30011,
-28918,
-28033,
-27414,
-27133,
-27198,
-27614,
-28339,
-29320,
-30482,
-31751,
-33052,
-34332,
-35542,
-36680,
-37728,
-38714,
-39632,
-40469,
-41209,
-41776,
-42138,
-42234,
-42066,
-41664,
-41114,
-40534,
-40040,
-39756,
-39731,
-40006,
-40535,
-41273,
-42129,
-43039,
-43939,
-44786,
-45557,
-46224,
-46777,
-47176,
-47398,
-47380,
-47086,
-46452,
-45426,
-43991,
-42108,
-39838,
-37208,
-34345,
-31368,
-28428,
-25670,
-23208,
-21128,
-19465,
-18218,
-17357,
-16843,
-16639,
-16717,
-17067,
-17676,
-18528,
-19582,
-20781,
-22022,
-23211,
-24232,
-25004,
-25470,
-25640,
-25542,
-25269,
-24909,
-24559,
-24284,
-24145,
-24128,
-24264,
-24504,
-24860,
-25324,
-25906,
-26636,
-27524,
-28592,
-29838,
-31240,
-32767,
-34344,
-35908,
-37352,
-38601,
-39550,
-40154,
-40375,
-40227,
-39755,
-39014,
-38083,
-37010,
-35842,
-34589,
-33280,
-31918,
-30561,
-29262,
-28111,
-27198,
-26602,
-26367,
-26519,
-27022,
-27845,
-28914,
-30160,
-31519,
-32919,
-34304,
-35623,
-36834,
-37920,
-38873,
-39695,
-40406,
-40993,
-41458,
-41761,
-41867,
-41761,
-41424,
-40930,
-40331,
-39776,
-39363,
-39211,
-39373,
-39848,
-40600,
-41531,
-42546,
-43565,
-44500,
-45343,
-46056,
-46645,
-47098,
-47379,
-47447,
-47230,
-46657,
-45669,
-44226,
-42337,
-40037,
-37414,
-34579,
-31660,
-28796,
-26103,
-23684,
-21605,
-19913,
-18595,
-17659,
-17039,
-16721,
-16653,
-16817,
-17207,
-17815,
-18654,
-19683,
-20885,
-22143,
-23394,
-24491,
-25364,
-25942,
-26224,
-26251,
-26105,
-25866,
-25630,
-25426,
-25305,
-25241,
-25253,
-25326,
-25487,
-25760,
-26180,
-26765,
-27531,
-28467,
-29553,
-30770,
-32090,
-33484,
-34929,
-36362,
-37734,
-38955,
-39957,
-40674,
-41072,
-41145,
-40926,
-40450,
-39777,
-38935,
-37964,
-36869,
-35676,
-34399,
-33078,
-31755,
-30494,
-29344,
-28372,
-27619,
-27140,
-26955,
-27099,
-27567,
-28345,
-29383,
-30617,
-31947,
-33296,
-34575,
-35737,
-36761,
-37667,
-38468,
-39221,
-39918,
-40575,
-41137,
-41564,
-41788,
-41777,
-41519,
-41049,
-40445,
-39811,
-39258,
-38894,
-38782,
-38953,
-39400,
-40059,
-40876,
-41765,
-42662,
-43509,
-44272,
-44919,
-45444,
-45825,
-46056,
-46116,
-45981,
-45624,
-44994,
-44057,
-42761,
-41086,
-39014,
-36583,
-33857,
-30944,
-27985,
-25115,
-22483,
-20176,
-18278,
-16781,
-15692,
-14949,
-14523,
-14377,
-14499,
-14892,
-15560,
-16493,
-17658,
-18971,
-20349,
-21645,
-22777,
-23639,
-24206,
-24488,
-24535,
-24428,
-24250,
-24065,
-23921,
-23834,
-23812,
-23854,
-23964,
-24168,
-24482,
-24947,
-25578,
-26390,
-27386,
-28536,
-29834,
-31236,
-32720,
-34251,
-35774,
-37242,
-38574,
-39695,
-40523,
-41002,
-41096,
-40816,
-40216,
-39348,
-38325,
-37184,
-36008,
-34792,
-33563,
-32301,
-31030,
-29781,
-28612,
-27622,
-26873,
-26449,
-26371,
-26638,
-27216,
-28042,
-29061,
-30212,
-31448,
-32732,
-34020,
-35280,
-36468,
-37549,
-38510,
-39327,
-40031,
-40604,
-41072,
-41406,
-41590,
-41583,
-41368,
-40951,
-40375,
-39738,
-39145,
-38732,
-38584,
-38769,
-39274,
-40046,
-41001,
-42016,
-43021,
-43928,
-44723,
-45394,
-45954,
-46416,
-46759,
-46956,
-46934,
-46625,
-45952,
-44859,
-43324,
-41361,
-39011,
-36367,
-33522,
-30598,
-27719,
-24995,
-22541,
-20429,
-18708,
-17392,
-16448,
-15851,
-15527,
-15464,
-15618,
-16021,
-16662,
-17569,
-18694,
-19987,
-21328,
-22591,
-23652,
-24419,
-24858,
-24997,
-24905,
-24688,
-24430,
-24218,
-24074,
-24017,
-24026,
-24098,
-24225,
-24428,
-24733,
-25169,
-25771,
-26537,
-27476,
-28568,
-29782,
-31103,
-32480,
-33903,
-35310,
-36667,
-37896,
-38941,
-39731,
-40217,
-40365,
-40188,
-39704,
-38979,
-38068,
-37032,
-35920,
-34755,
-33551,
-32325,
-31083,
-29878,
-28747,
-27779,
-27036,
-26599,
-26499,
-26762,
-27355,
-28244,
-29350,
-30600,
-31920,
-33240,
-34509,
-35698,
-36783,
-37771,
-38674,
-39494,
-40249,
-40919,
-41483,
-41900,
-42127,
-42131,
-41910,
-41485,
-40929,
-40338,
-39816,
-39484,
-39406,
-39629,
-40143,
-40890,
-41795,
-42761,
-43710,
-44579,
-45338,
-45982,
-46509,
-46936,
-47248,
-47412,
-47388,
-47093,
-46473,
-45462,
-44027,
-42169,
-39923,
-37356,
-34580,
-31698,
-28853,
-26161,
-23732,
-21642,
-19939,
-18627,
-17697,
-17106,
-16819,
-16803,
-17036,
-17514,
-18221,
-19146,
-20247,
-21456,
-22689,
-23835,
-24804,
-25519,
-25943,
-26095,
-26014,
-25791,
-25504,
-25239,
-25044,
-24945,
-24943,
-25020,
-25171,
-25383,
-25679,
-26075,
-26614,
-27305,
-28177,
-29206,
-30398,
-31702,
-33107,
-34551,
-36006,
-37382,
-38633,
-39644,
-40371,
-40736,
-40747,
-40418,
-39825,
-39036,
-38134,
-37162,
-36143,
-35066,
-33924,
-32711,
-31458,
-30227,
-29089,
-28143,
-27453,
-27071,
-27015,
-27274,
-27832,
-28650,
-29697,
-30921,
-32260,
-33643,
-34998,
-36250,
-37368,
-38333,
-39163,
-39901,
-40564,
-41177,
-41705,
-42105,
-42313,
-42288,
-42017,
-41540,
-40940,
-40319,
-39803,
-39478,
-39409,
-39615,
-40076,
-40749,
-41571,
-42475,
-43408,
-44309,
-45144,
-45882,
-46493,
-46972,
-47284,
-47409,
-47304,
-46910,
-46172,
-45023,
-43430,
-41382,
-38926,
-36138,
-33158,
-30126,
-27202,
-24520,
-22176,
-20232,
-18690,
-17537,
-16717,
-16197,
-15925,
-15904,
-16108,
-16567,
-17264,
-18199,
-19318,
-20561,
-21809,
-22985,
-23955,
-24676,
-25098,
-25235,
-25156,
-24917,
-24628,
-24357,
-24164,
-24071,
-24087,
-24190,
-24372,
-24630,
-24959,
-25403,
-25965,
-26694,
-27589,
-28662,
-29893,
-31254,
-32700,
-34194,
-35657,
-37044,
-38257,
-39244,
-39934,
-40295,
-40325,
-40037,
-39493,
-38738,
-37832,
-36812,
-35695,
-34492,
-33221,
-31901,
-30591,
-29355,
-28270,
-27417,
-26838,
-26574,
-26611,
-26943,
-27537,
-28358,
-29373,
-30539,
-31803,
-33116,
-34416,
-35647,
-36796,
-37825,
-38774,
-39636,
-40434,
-41154,
-41754,
-42184,
-42382,
-42314,
-41975,
-41425,
-40746,
-40083,
-39545,
-39253,
-39270,
-39600,
-40221,
-41048,
-41995,
-42973,
-43909,
-44762,
-45505,
-46150,
-46686,
-47127,
-47443,
-47598,
-47534,
-47174,
-46463,
-45344,
-43804,
-41854,
-39543,
-36948,
-34170,
-31322,
-28514,
-25868,
-23472,
-21412,
-19731,
-18449,
-17558,
-17015,
-16792,
-16824,
-17104,
-17593,
-18301,
-19201,
-20277,
-21466,
-22682,
-23828,
-24792,
-25499,
-25914,
-26033,
-25939,
-25687,
-25400,
-25129,
-24938,
-24836,
-24823,
-24875,
-25002,
-25192,
-25485,
-25893,
-26460,
-27184,
-28086,
-29144,
-30345,
-31666,
-33066,
-34519,
-35944,
-37293,
-38454,
-39368,
-39958,
-40199,
-40105,
-39715,
-39101,
-38327,
-37446,
-36486,
-35450,
-34335,
-33142,
-31887,
-30623,
-29401,
-28307,
-27398,
-26736,
-26353,
-26266,
-26483,
-26988,
-27766,
-28779,
-29972,
-31292,
-32644,
-33978,
-35223,
-36349,
-37353,
-38229,
-39007,
-39683,
-40257,
-40701,
-40984,
-41074,
-40956,
-40636,
-40156,
-39577,
-38996,
-38495,
-38181,
-38106,
-38333,
-38839,
-39614,
-40563,
-41613,
-42659,
-43629,
-44466,
-45157,
-45701,
-46116,
-46408,
-46548,
-46488,
-46135,
-45416,
-44245,
-42605,
-40513,
-38055,
-35356,
-32560,
-29814,
-27234,
-24905,
-22877,
-21153,
-19748,
-18634,
-17812,
-17274,
-17022,
-17056,
-17372,
-17958,
-18777,
-19796,
-20933,
-22118,
-23258,
-24263,
-25060,
-25603,
-25863,
-25889,
-25709,
-25424,
-25108,
-24833,
-24658,
-24595,
-24642,
-24779,
-24979,
-25225,
-25526,
-25893,
-26373,
-27003,
-27818,
-28841,
-30068,
-31458,
-32975,
-34521,
-36035,
-37412,
-38585,
-39492,
-40093,
-40373,
-40342,
-40019,
-39445,
-38655,
-37687,
-36582,
-35371,
-34095,
-32787,
-31495,
-30255,
-29126,
-28135,
-27344,
-26779,
-26475,
-26465,
-26746,
-27331,
-28182,
-29271,
-30522,
-31876,
-33250,
-34585,
-35829,
-36972,
-37991,
-38922,
-39756,
-40506,
-41156,
-41668,
-41998,
-42114,
-41979,
-41630,
-41101,
-40497,
-39925,
-39496,
-39295,
-39376,
-39733,
-40328,
-41106,
-41968,
-42879,
-43747,
-44567,
-45288,
-45913,
-46414,
-46784,
-47003,
-47058,
-46919,
-46558,
-45922,
-44950,
-43592,
-41803,
-39582,
-37003,
-34144,
-31192,
-28287,
-25586,
-23198,
-21155,
-19472,
-18104,
-17025,
-16205,
-15652,
-15371,
-15384,
-15684,
-16246,
-17032,
-17984,
-19047,
-20177,
-21327,
-22450,
-23490,
-24378,
-25038,
-25434,
-25541,
-25406,
-25104,
-24740,
-24410,
-24187,
-24090,
-24117,
-24223,
-24386,
-24591,
-24862,
-25233,
-25750,
-26428,
-27277,
-28269,
-29365,
-30552,
-31787,
-33100,
-34446,
-35843,
-37204,
-38481,
-39550,
-40346,
-40780,
-40861,
-40595,
-40069,
-39349,
-38515,
-37610,
-36642,
-35611,
-34488,
-33279,
-31999,
-30697,
-29457,
-28353,
-27471,
-26859,
-26552,
-26539,
-26812,
-27334,
-28072,
-29002,
-30085,
-31296,
-32572,
-33880,
-35130,
-36299,
-37327,
-38222,
-38986,
-39662,
-40269,
-40829,
-41328,
-41721,
-41967,
-42010,
-41835,
-41463,
-40946,
-40379,
-39856,
-39466,
-39275,
-39310,
-39576,
-40048,
-40692,
-41459,
-42306,
-43185,
-44035,
-44827,
-45505,
-46053,
-46453,
-46706,
-46810,
-46771,
-46550,
-46123,
-45411,
-44360,
-42909,
-41030,
-38756,
-36148,
-33333,
-30460,
-27673,
-25119,
-22870,
-20985,
-19453,
-18241,
-17314,
-16629,
-16186,
-15984,
-16052,
-16397,
-17022,
-17886,
-18935,
-20085,
-21260,
-22380,
-23385,
-24234,
-24897,
-25352,
-25609,
-25666,
-25564,
-25357,
-25092,
-24856,
-24677,
-24598,
-24612,
-24702,
-24856,
-25044,
-25304,
-25638,
-26117,
-26753,
-27585,
-28592,
-29748,
-31014,
-32339,
-33689,
-35033,
-36341,
-37564,
-38669,
-39557,
-40197,
-40512,
-40503,
-40179,
-39605,
-38840,
-37964,
-37014,
-36016,
-34962,
-33841,
-32645,
-31383,
-30112,
-28883,
-27788,
-26897,
-26273,
-25953,
-25943,
-26241,
-26815,
-27642,
-28682,
-29883,
-31211,
-32581,
-33959,
-35255,
-36445,
-37485,
-38381,
-39150,
-39817,
-40408,
-40935,
-41372,
-41690,
-41835,
-41781,
-41508,
-41068,
-40506,
-39950,
-39471,
-39175,
-39096,
-39262,
-39647,
-40217,
-40936,
-41752,
-42640,
-43545,
-44431,
-45241,
-45929,
-46456,
-46807,
-46977,
-46993,
-46840,
-46531,
-45988,
-45164,
-43963,
-42332,
-40252,
-37775,
-34997,
-32074,
-29153,
-26379,
-23861,
-21654,
-19793,
-18269,
-17078,
-16205,
-15633,
-15350,
-15342,
-15581,
-16069,
-16756,
-17650,
-18699,
-19870,
-21095,
-22290,
-23361,
-24228,
-24829,
-25146,
-25215,
-25093,
-24876,
-24655,
-24483,
-24419,
-24449,
-24562,
-24736,
-24939,
-25176,
-25452,
-25794,
-26236,
-26809,
-27527,
-28408,
-29438,
-30609,
-31896,
-33264,
-34681,
-36105,
-37477,
-38743,
-39834,
-40678,
-41237,
-41467,
-41365,
-40967,
-40313,
-39468,
-38506,
-37454,
-36368,
-35240,
-34093,
-32913,
-31738,
-30586,
-29520,
-28599,
-27883,
-27424,
-27255,
-27376,
-27796,
-28462,
-29358,
-30415,
-31593,
-32828,
-34077,
-35284,
-36427,
-37476,
-38428,
-39289,
-40064,
-40762,
-41381,
-41899,
-42294,
-42526,
-42569,
-42408,
-42055,
-41563,
-40988,
-40439,
-39989,
-39721,
-39674,
-39865,
-40271,
-40857,
-41572,
-42373,
-43215,
-44067,
-44886,
-45639,
-46285,
-46779,
-47108,
-47240,
-47184,
-46924,
-46454,
-45737,
-44730,
-43360,
-41607,
-39446,
-36940,
-34192,
-31337,
-28545,
-25939,
-23613,
-21610,
-19918,
-18518,
-17379,
-16492,
-15869,
-15520,
-15476,
-15715,
-16239,
-16988,
-17924,
-18989,
-20129,
-21289,
-22402,
-23387,
-24174,
-24687,
-24905,
-24834,
-24541,
-24124,
-23698,
-23348,
-23143,
-23072,
-23127,
-23254,
-23421,
-23631,
-23900,
-24279,
-24815,
-25537,
-26452,
-27535,
-28753,
-30050,
-31411,
-32794,
-34194,
-35584,
-36929,
-38168,
-39224,
-40028,
-40497,
-40628,
-40401,
-39892,
-39156,
-38294,
-37369,
-36427,
-35482,
-34514,
-33512,
-32453,
-31364,
-30283,
-29282,
-28455,
-27855,
-27553,
-27546,
-27836,
-28371,
-29128,
-30041,
-31090,
-32227,
-33414,
-34610,
-35760,
-36827,
-37782,
-38618,
-39359,
-40024,
-40653,
-41240,
-41769,
-42188,
-42433,
-42448,
-42211,
-41737,
-41104,
-40415,
-39791,
-39352,
-39160,
-39275,
-39659,
-40287,
-41075,
-41953,
-42859,
-43733,
-44557,
-45293,
-45947,
-46495,
-46931,
-47238,
-47387,
-47348,
-47088,
-46551,
-45711,
-44502,
-42915,
-40930,
-38576,
-35922,
-33058,
-30127,
-27268,
-24604,
-22259,
-20265,
-18670,
-17429,
-16516,
-15885,
-15498,
-15357,
-15441,
-15777,
-16347,
-17156,
-18149,
-19290,
-20492,
-21688,
-22788,
-23720,
-24433,
-24875,
-25074,
-25026,
-24827,
-24527,
-24235,
-23993,
-23870,
-23847,
-23930,
-24079,
-24279,
-24530,
-24850,
-25277,
-25853,
-26598,
-27523,
-28604,
-29806,
-31097,
-32433,
-33797,
-35156,
-36487,
-37741,
-38853,
-39756,
-40368,
-40660,
-40590,
-40221,
-39570,
-38748,
-37799,
-36796,
-35740,
-34661,
-33517,
-32325,
-31090,
-29840,
-28659,
-27604,
-26765,
-26196,
-25940,
-26001,
-26368,
-27005,
-27873,
-28929,
-30136,
-31435,
-32791,
-34120,
-35392,
-36532,
-37530,
-38376,
-39095,
-39733,
-40320,
-40875,
-41367,
-41761,
-41964,
-41956,
-41675,
-41192,
-40555,
-39906,
-39351,
-38998,
-38915,
-39100,
-39551,
-40205,
-41005,
-41907,
-42837,
-43769,
-44635,
-45410,
-46043,
-46524,
-46848,
-47014,
-47046,
-46920,
-46612,
-46068,
-45194,
-43943,
-42256,
-40151,
-37687,
-34974,
-32146,
-29350,
-26701,
-24293,
-22175,
-20372,
-18888,
-17713,
-16845,
-16270,
-15986,
-15981,
-16241,
-16743,
-17454,
-18348,
-19368,
-20470,
-21600,
-22680,
-23671,
-24489,
-25111,
-25495,
-25655,
-25608,
-25414,
-25137,
-24853,
-24620,
-24485,
-24463,
-24553,
-24739,
-24996,
-25325,
-25724,
-26221,
-26832,
-27591,
-28503,
-29568,
-30764,
-32058,
-33407,
-34780,
-36113,
-37373,
-38491,
-39415,
-40092,
-40475,
-40563,
-40361,
-39917,
-39287,
-38528,
-37683,
-36779,
-35809,
-34771,
-33647,
-32457,
-31222,
-30007,
-28882,
-27918,
-27187,
-26731,
-26576,
-26723,
-27156,
-27852,
-28767,
-29870,
-31103,
-32415,
-33747,
-35032,
-36235,
-37309,
-38259,
-39078,
-39812,
-40469,
-41084,
-41636,
-42098,
-42419,
-42534,
-42414,
-42040,
-41481,
-40801,
-40149,
-39627,
-39351,
-39370,
-39684,
-40258,
-41002,
-41846,
-42716,
-43552,
-44350,
-45073,
-45737,
-46323,
-46811,
-47185,
-47391,
-47414,
-47191,
-46695,
-45872,
-44689,
-43121,
-41168,
-38865,
-36283,
-33521,
-30711,
-27967,
-25411,
-23112,
-21127,
-19468,
-18134,
-17101,
-16362,
-15886,
-15670,
-15697,
-15960,
-16448,
-17146,
-18033,
-19072,
-20217,
-21403,
-22549,
-23576,
-24405,
-24986,
-25301,
-25368,
-25243,
-24998,
-24717,
-24470,
-24298,
-24224,
-24241,
-24330,
-24485,
-24689,
-24969,
-25342,
-25848,
-26518,
-27369,
-28407,
-29604,
-30928,
-32328,
-33760,
-35170,
-36522,
-37760,
-38848,
-39721,
-40339,
-40655,
-40656,
-40359,
-39806,
-39066,
-38219,
-37302,
-36367,
-35379,
-34338,
-33206,
-31989,
-30733,
-29502,
-28394,
-27501,
-26859,
-26512,
-26408,
-26539,
-26848,
-27346,
-28017,
-28906,
-29991,
-31270,
-32651,
-34070,
-35400,
-36594,
-37601,
-38447,
-39175,
-39851,
-40502,
-41149,
-41747,
-42250,
-42593,
-42733,
-42655,
-42386,
-41963,
-41459,
-40930,
-40449,
-40072,
-39840,
-39797,
-39964,
-40342,
-40921,
-41660,
-42500,
-43383,
-44249,
-45037,
-45738,
-46315,
-46791,
-47155,
-47422,
-47569,
-47582,
-47415,
-47023,
-46352,
-45363,
-44028,
-42336,
-40321,
-38011,
-35496,
-32850,
-30182,
-27589,
-25162,
-22992,
-21109,
-19576,
-18351,
-17456,
-16818,
-16426,
-16239,
-16244,
-16444,
-16846,
-17459,
-18276,
-19270,
-20383,
-21547,
-22681,
-23709,
-24568,
-25223,
-25652,
-25860,
-25868,
-25703,
-25422,
-25072,
-24734,
-24456,
-24299,
-24273,
-24377,
-24572,
-24815,
-25075,
-25332,
-25627,
-26000,
-26517,
-27230,
-28131,
-29222,
-30416,
-31670,
-32917,
-34135,
-35314,
-36460,
-37554,
-38564,
-39413,
-40018,
-40309,
-40240,
-39845,
-39175,
-38336,
-37421,
-36480,
-35556,
-34601,
-33604,
-32520,
-31353,
-30137,
-28933,
-27811,
-26845,
-26067,
-25515,
-25182,
-25090,
-25228,
-25623,
-26261,
-27147,
-28232,
-29472,
-30786,
-32099,
-33355,
-34506,
-35550,
-36492,
-37356,
-38167,
-38932,
-39655,
-40309,
-40868,
-41287,
-41536,
-41586,
-41434,
-41094,
-40610,
-40048,
-39486,
-39014,
-38713,
-38645,
-38843,
-39314,
-40015,
-40894,
-41870,
-42865,
-43810,
-44661,
-45386,
-45995,
-46493,
-46897,
-47208,
-47418,
-47481,
-47363,
-46995,
-46338,
-45354,
-44027,
-42365,
-40380,
-38113,
-35608,
-32944,
-30197,
-27487,
-24919,
-22611,
-20630,
-19035,
-17794,
-16885,
-16226,
-15772,
-15483,
-15369,
-15456,
-15778,
-16374,
-17206,
-18258,
-19421,
-20628,
-21787,
-22831,
-23734,
-24454,
-24995,
-25327,
-25456,
-25373,
-25120,
-24748,
-24333,
-23973,
-23722,
-23633,
-23697,
-23885,
-24148,
-24452,
-24783,
-25159,
-25621,
-26218,
-26974,
-27911,
-28989,
-30191,
-31454,
-32756,
-34062,
-35355,
-36619,
-37815,
-38904,
-39811,
-40480,
-40844,
-40884,
-40602,
-40048,
-39289,
-38403,
-37458,
-36476,
-35484,
-34437,
-33336,
-32146,
-30909,
-29651,
-28479,
-27455,
-26670,
-26164,
-25936,
-25979,
-26251,
-26721,
-27377,
-28210,
-29213,
-30387,
-31669,
-33015,
-34339,
-35554,
-36638,
-37542,
-38325,
-39007,
-39649,
-40272,
-40878,
-41425,
-41859,
-42121,
-42166,
-41983,
-41595,
-41047,
-40424,
-39800,
-39269,
-38904,
-38763,
-38888,
-39276,
-39910,
-40726,
-41664,
-42623,
-43555,
-44378,
-45095,
-45675,
-46163,
-46549,
-46866,
-47082,
-47189,
-47117,
-46834,
-46258,
-45371,
-44114,
-42513,
-40555,
-38304,
-35818,
-33188,
-30519,
-27909,
-25466,
-23248,
-21326,
-19697,
-18377,
-17334,
-16553,
-16014,
-15704,
-15629,
-15785,
-16180,
-16805,
-17628,
-18630,
-19744,
-20923,
-22094,
-23198,
-24164,
-24958,
-25526,
-25867,
-25978,
-25894,
-25658,
-25348,
-25024,
-24766,
-24608,
-24596,
-24698,
-24917,
-25180,
-25475,
-25771,
-26090,
-26469,
-26967,
-27633,
-28496,
-29545,
-30745,
-32025,
-33333,
-34611,
-35846,
-37026,
-38150,
-39188,
-40102,
-40807,
-41244,
-41345,
-41112,
-40574,
-39823,
-38942,
-38018,
-37090,
-36154,
-35180,
-34134,
-32989,
-31784,
-30562,
-29418,
-28445,
-27686,
-27201,
-26971,
-26983,
-27223,
-27657,
-28296,
-29123,
-30129,
-31293,
-32545,
-33837,
-35075,
-36215,
-37215,
-38080,
-38834,
-39517,
-40176,
-40822,
-41444,
-42011,
-42445,
-42704,
-42734,
-42522,
-42110,
-41546,
-40933,
-40343,
-39869,
-39552,
-39440,
-39529,
-39832,
-40324,
-40989,
-41800,
-42695,
-43632,
-44535,
-45345,
-46027,
-46553,
-46924,
-47176,
-47301,
-47328,
-47218,
-46937,
-46422,
-45613,
-44472,
-42972,
-41139,
-38994,
-36607,
-34040,
-31389,
-28735,
-26188,
-23832,
-21754,
-20010,
-18613,
-17556,
-16793,
-16272,
-15966,
-15840,
-15918,
-16213,
-16745,
-17517,
-18493,
-19611,
-20793,
-21943,
-23008,
-23916,
-24653,
-25189,
-25522,
-25649,
-25584,
-25350,
-25007,
-24630,
-24286,
-24068,
-23986,
-24063,
-24250,
-24500,
-24770,
-25042,
-25338,
-25707,
-26210,
-26895,
-27781,
-28855,
-30067,
-31370,
-32703,
-34031,
-35336,
-36588,
-37771,
-38837,
-39726,
-40394,
-40769,
-40853,
-40625,
-40157,
-39480,
-38677,
-37784,
-36832,
-35833,
-34773,
-33646,
-32462,
-31230,
-30019,
-28866,
-27853,
-27027,
-26436,
-26098,
-26019,
-26191,
-26603,
-27240,
-28093,
-29127,
-30323,
-31614,
-32939,
-34235,
-35422,
-36487,
-37405,
-38213,
-38943,
-39646,
-40325,
-40990,
-41578,
-42043,
-42319,
-42364,
-42171,
-41775,
-41225,
-40617,
-40023,
-39527,
-39196,
-39063,
-39166,
-39494,
-40040,
-40751,
-41577,
-42444,
-43297,
-44085,
-44788,
-45397,
-45932,
-46394,
-46788,
-47088,
-47250,
-47227,
-46968,
-46439,
-45616,
-44498,
-43076,
-41363,
-39350,
-37075,
-34558,
-31900,
-29192,
-26572,
-24165,
-22066,
-20326,
-18954,
-17896,
-17117,
-16547,
-16186,
-16016,
-16074,
-16375,
-16927,
-17705,
-18672,
-19747,
-20888,
-22015,
-23085,
-24058,
-24884,
-25535,
-25971,
-26174,
-26162,
-25965,
-25660,
-25328,
-25041,
-24872,
-24819,
-24889,
-25027,
-25201,
-25382,
-25564,
-25791,
-26097,
-26556,
-27196,
-28036,
-29060,
-30218,
-31459,
-32726,
-33990,
-35215,
-36419,
-37556,
-38644,
-39586,
-40357,
-40851,
-41041,
-40883,
-40424,
-39713,
-38835,
-37879,
-36876,
-35865,
-34812,
-33712,
-32541,
-31334,
-30127,
-29003,
-28025,
-27247,
-26691,
-26346,
-26202,
-26238,
-26468,
-26907,
-27580,
-28495,
-29616,
-30892,
-32220,
-33515,
-34699,
-35740,
-36648,
-37457,
-38219,
-38948,
-39659,
-40301,
-40834,
-41197,
-41352,
-41291,
-41039,
-40628,
-40127,
-39581,
-39061,
-38600,
-38267,
-38084,
-38105,
-38342,
-38810,
-39472,
-40305,
-41230,
-42193,
-43124,
-43980,
-44731,
-45374,
-45908,
-46337,
-46654,
-46845,
-46863,
-46674,
-46223,
-45477,
-44418,
-43049,
-41379,
-39458,
-37291,
-34964,
-32491,
-29966,
-27454,
-25053,
-22869,
-20979,
-19451,
-18297,
-17501,
-17009,
-16747,
-16669,
-16727,
-16936,
-17301,
-17855,
-18612,
-19547,
-20627,
-21761,
-22879,
-23887,
-24738,
-25372,
-25794,
-25989,
-25994,
-25835,
-25567,
-25246,
-24933,
-24681,
-24525,
-24477,
-24528,
-24648,
-24821,
-25027,
-25286,
-25626,
-26093,
-26731,
-27555,
-28560,
-29722,
-30977,
-32303,
-33622,
-34937,
-36200,
-37403,
-38505,
-39463,
-40218,
-40723,
-40934,
-40847,
-40482,
-39878,
-39107,
-38214,
-37255,
-36242,
-35189,
-34084,
-32933,
-31739,
-30545,
-29385,
-28334,
-27438,
-26754,
-26315,
-26134,
-26218,
-26548,
-27114,
-27891,
-28855,
-29978,
-31210,
-32519,
-33831,
-35110,
-36296,
-37362,
-38300,
-39107,
-39819,
-40440,
-41000,
-41476,
-41857,
-42089,
-42137,
-41968,
-41593,
-41046,
-40416,
-39798,
-39315,
-39042,
-39054,
-39347,
-39894,
-40636,
-41484,
-42378,
-43247,
-44064,
-44805,
-45468,
-46052,
-46533,
-46908,
-47119,
-47147,
-46926,
-46424,
-45607,
-44436,
-42926,
-41055,
-38868,
-36405,
-33720,
-30929,
-28111,
-25416,
-22939,
-20789,
-19033,
-17685,
-16740,
-16135,
-15810,
-15709,
-15782,
-16045,
-16483,
-17153,
-18030,
-19115,
-20328,
-21579,
-22753,
-23750,
-24502,
-24977,
-25202,
-25223,
-25114,
-24933,
-24745,
-24565,
-24439,
-24356,
-24343,
-24403,
-24550,
-24789,
-25134,
-25579,
-26124,
-26785,
-27546,
-28449,
-29484,
-30666,
-31977,
-33393,
-34842,
-36277,
-37583,
-38713,
-39577,
-40152,
-40412,
-40381,
-40083,
-39569,
-38886,
-38066,
-37151,
-36150,
-35075,
-33949,
-32768,
-31584,
-30416,
-29318,
-28345,
-27540,
-26954,
-26624,
-26572,
-26820,
-27350,
-28156,
-29179,
-30382,
-31669,
-32999,
-34264,
-35456,
-36511,
-37449,
-38278,
-39021,
-39709,
-40342,
-40916,
-41393,
-41738,
-41895,
-41854,
-41594,
-41162,
-40619,
-40040,
-39539,
-39180,
-39043,
-39147,
-39499,
-40067,
-40797,
-41637,
-42517,
-43394,
-44214,
-44963,
-45598,
-46134,
-46539,
-46816,
-46940,
-46888,
-46611,
-46077,
-45220,
-44019,
-42439,
-40499,
-38230,
-35701,
-33006,
-30249,
-27541,
-24994,
-22687,
-20701,
-19066,
-17806,
-16894,
-16309,
-15997,
-15930,
-16072,
-16426,
-16982,
-17758,
-18735,
-19884,
-21132,
-22382,
-23528,
-24465,
-25131,
-25505,
-25604,
-25510,
-25286,
-25030,
-24801,
-24634,
-24552,
-24542,
-24601,
-24718,
-24886,
-25120,
-25417,
-25805,
-26298,
-26907,
-27665,
-28576,
-29656,
-30901,
-32267,
-33729,
-35191,
-36585,
-37825,
-38827,
-39564,
-39991,
-40133,
-40002,
-39636,
-39078,
-38355,
-37490,
-36513,
-35425,
-34262,
-33040,
-31804,
-30580,
-29424,
-28370,
-27466,
-26741,
-26243,
-25986,
-26022,
-26342,
-26971,
-27869,
-29004,
-30306,
-31689,
-33077,
-34389,
-35582,
-36633,
-37552,
-38374,
-39115,
-39826,
-40478,
-41076,
-41551,
-41867,
-41965,
-41832,
-41470,
-40943,
-40322,
-39725,
-39245,
-38974,
-38966,
-39237,
-39755,
-40471,
-41301,
-42177,
-43031,
-43823,
-44543,
-45176,
-45755,
-46243,
-46669,
-46958,
-47090,
-46987,
-46603,
-45896,
-44834,
-43422,
-41666,
-39588,
-37242,
-34662,
-31938,
-29161,
-26431,
-23883,
-21602,
-19686,
-18162,
-17036,
-16266,
-15809,
-15606,
-15640,
-15886,
-16369,
-17089,
-18049,
-19209,
-20502,
-21834,
-23088,
-24175,
-25010,
-25560,
-25832,
-25866,
-25725,
-25495,
-25243,
-25034,
-24907,
-24883,
-24952,
-25108,
-25327,
-25598,
-25921,
-26313,
-26798,
-27412,
-28182,
-29116,
-30219,
-31451,
-32786,
-34158,
-35527,
-36837,
-38039,
-39098,
-39969,
-40620,
-41020,
-41151,
-41010,
-40613,
-39992,
-39178,
-38230,
-37163,
-36031,
-34836,
-33613,
-32380,
-31178,
-30042,
-29039,
-28201,
-27590,
-27222,
-27132,
-27309,
-27768,
-28474,
-29414,
-30540,
-31796,
-33112,
-34418,
-35646,
-36755,
-37730,
-38580,
-39339,
-40036,
-40688,
-41286,
-41788,
-42149,
-42311,
-42248,
-41964,
-41503,
-40941,
-40367,
-39875,
-39524,
-39371,
-39429,
-39684,
-40140,
-40736,
-41473,
-42281,
-43144,
-44004,
-44825,
-45565,
-46197,
-46681,
-47021,
-47164,
-47122,
-46833,
-46286,
-45427,
-44230,
-42672,
-40752,
-38500,
-35973,
-33252,
-30446,
-27665,
-25032,
-22642,
-20578,
-18883,
-17564,
-16602,
-15948,
-15550,
-15361,
-15352,
-15520,
-15880,
-16455,
-17264,
-18287,
-19483,
-20757,
-21990,
-23076,
-23894,
-24412,
-24619,
-24575,
-24380,
-24134,
-23929,
-23820,
-23814,
-23901,
-24037,
-24202,
-24387,
-24610,
-24919,
-25352,
-25943,
-26717,
-27646,
-28728,
-29925,
-31210,
-32588,
-34012,
-35485,
-36942,
-38324,
-39545,
-40528,
-41196,
-41536,
-41533,
-41249,
-40729,
-40034,
-39216,
-38283,
-37257,
-36123,
-34893,
-33587,
-32244,
-30935,
-29715,
-28665,
-27826,
-27239,
-26931,
-26892,
-27143,
-27651,
-28420,
-29401,
-30565,
-31843,
-33170,
-34480,
-35701,
-36816,
-37794,
-38660,
-39435,
-40141,
-40793,
-41375,
-41847,
-42162,
-42276,
-42149,
-41812,
-41291,
-40685,
-40089,
-39595,
-39298,
-39222,
-39404,
-39810,
-40407,
-41154,
-41982,
-42860,
-43730,
-44558,
-45311,
-45960,
-46483,
-46868,
-47092,
-47146,
-47003,
-46632,
-45993,
-45054,
-43769,
-42135,
-40148,
-37842,
-35284,
-32549,
-29753,
-27004,
-24409,
-22077,
-20063,
-18427,
-17165,
-16265,
-15686,
-15386,
-15325,
-15478,
-15843,
-16411,
-17198,
-18183,
-19327,
-20580,
-21833,
-23003,
-23980,
-24694,
-25107,
-25226,
-25109,
-24820,
-24478,
-24145,
-23910,
-23781,
-23776,
-23853,
-24005,
-24195,
-24443,
-24765,
-25208,
-25808,
-26597,
-27569,
-28709,
-29971,
-31310,
-32681,
-34043,
-35377,
-36641,
-37807,
-38817,
-39609,
-40136,
-40337,
-40217,
-39783,
-39095,
-38217,
-37221,
-36160,
-35075,
-33969,
-32851,
-31708,
-30558,
-29423,
-28347,
-27394,
-26629,
-26107,
-25892,
-25985,
-26412,
-27131,
-28099,
-29265,
-30536,
-31855,
-33150,
-34363,
-35481,
-36484,
-37384,
-38216,
-38978,
-39714,
-40383,
-40988,
-41461,
-41762,
-41851,
-41698,
-41344,
-40823,
-40238,
-39684,
-39256,
-39033,
-39055,
-39321,
-39817,
-40492,
-41295,
-42178,
-43081,
-43965,
-44784,
-45503,
-46092,
-46538,
-46830,
-46973,
-46959,
-46775,
-46378,
-45715,
-44714,
-43326,
-41517,
-39313,
-36781,
-34037,
-31217,
-28465,
-25898,
-23604,
-21633,
-19988,
-18673,
-17645,
-16899,
-16394,
-16128,
-16094,
-16289,
-16718,
-17375,
-18245,
-19302,
-20486,
-21722,
-22934,
-24008,
-24895,
-25512,
-25867,
-25969,
-25876,
-25663,
-25399,
-25159,
-24977,
-24887,
-24875,
-24947,
-25082,
-25289,
-25571,
-25959,
-26455,
-27104,
-27890,
-28822,
-29881,
-31042,
-32288,
-33591,
-34933,
-36273,
-37566,
-38752,
-39739,
-40478,
-40883,
-40954,
-40687,
-40147,
-39396,
-38514,
-37556,
-36551,
-35508,
-34410,
-33257,
-32056,
-30850,
-29692,
-28655,
-27802,
-27187,
-26832,
-26758,
-26955,
-27423,
-28143,
-29094,
-30240,
-31516,
-32858,
-34182,
-35424,
-36538,
-37517,
-38370,
-39144,
-39861,
-40540,
-41172,
-41706,
-42102,
-42294,
-42263,
-42006,
-41567,
-41018,
-40442,
-39943,
-39584,
-39438,
-39519,
-39839,
-40364,
-41065,
-41872,
-42741,
-43606,
-44420,
-45148,
-45759,
-46249,
-46613,
-46856,
-46971,
-46950,
-46747,
-46314,
-45574,
-44450,
-42897,
-40887,
-38463,
-35718,
-32783,
-29824,
-26993,
-24418,
-22170,
-20279,
-18729,
-17492,
-16528,
-15828,
-15374,
-15184,
-15264,
-15605,
-16202,
-17030,
-18035,
-19197,
-20432,
-21692,
-22886,
-23932,
-24752,
-25287,
-25519,
-25486,
-25251,
-24921,
-24594,
-24338,
-24204,
-24179,
-24251,
-24386,
-24574,
-24823,
-25166,
-25641,
-26279,
-27101,
-28099,
-29259,
-30553,
-31948,
-33415,
-34899,
-36353,
-37689,
-38837,
-39716,
-40275,
-40497,
-40397,
-40021,
-39413,
-38635,
-37701,
-36643,
-35467,
-34191,
-32855,
-31515,
-30229,
-29081,
-28115,
-27378,
-26909,
-26711,
-26818,
-27219,
-27927,
-28906,
-30118,
-31474,
-32893,
-34275,
-35561,
-36711,
-37729,
-38648,
-39494,
-40301,
-41051,
-41720,
-42237,
-42563,
-42644,
-42487,
-42122,
-41620,
-41074,
-40573,
-40207,
-40035,
-40096,
-40402,
-40931,
-41649,
-42500,
-43423,
-44346,
-45224,
-45988,
-46631,
-47118,
-47450,
-47617,
-47587,
-47335,
-46796,
-45920,
-44650,
-42958,
-40853,
-38379,
-35638,
-32742,
-29837,
-27060,
-24529,
-22342,
-20541,
-19146,
-18131,
-17462,
-17077,
-16937,
-17003,
-17272,
-17743,
-18428,
-19316,
-20384,
-21556,
-22740,
-23817,
-24686,
-25272,
-25558,
-25573,
-25397,
-25123,
-24840,
-24621,
-24485,
-24451,
-24487,
-24600,
-24769,
-25027,
-25386,
-25883,
-26532,
-27353,
-28323,
-29454,
-30694,
-32036,
-33426,
-34824,
-36158,
-37370,
-38375,
-39129,
-39584,
-39737,
-39592,
-39190,
-38551,
-37728,
-36737,
-35616,
-34385,
-33091,
-31757,
-30455,
-29221,
-28112,
-27173,
-26438,
-25936,
-25703,
-25747,
-26087,
-26717,
-27618,
-28743,
-30022,
-31381,
-32731,
-34010,
-35168,
-36189,
-37085,
-37885,
-38611,
-39298,
-39917,
-40459,
-40854,
-41058,
-41033,
-40775,
-40328,
-39779,
-39241,
-38838,
-38663,
-38787,
-39203,
-39894,
-40764,
-41753,
-42753,
-43723,
-44596,
-45370,
-46017,
-46540,
-46919,
-47134,
-47149,
-46926,
-46419,
-45579,
-44378,
-42779,
-40794,
-38454,
-35819,
-33000,
-30109,
-27288,
-24663,
-22329,
-20366,
-18793,
-17613,
-16801,
-16318,
-16149,
-16260,
-16658,
-17316,
-18220,
-19315,
-20525,
-21752,
-22886,
-23821,
-24500,
-24884,
-25004,
-24912,
-24696,
-24434,
-24202,
-24039,
-23963,
-23977,
-24061,
-24212,
-24428,
-24715,
-25105,
-25616,
-26273,
-27098,
-28096,
-29264,
-30585,
-32019,
-33519,
-35013,
-36429,
-37683,
-38710,
-39451,
-39883,
-39990,
-39804,
-39351,
-38678,
-37833,
-36843,
-35759,
-34587,
-33370,
-32119,
-30873,
-29677,
-28571,
-27631,
-26888,
-26420,
-26239,
-26385,
-26837,
-27584,
-28573,
-29756,
-31057,
-32413,
-33761,
-35042,
-36230,
-37302,
-38256,
-39115,
-39874,
-40555,
-41122,
-41569,
-41824,
-41879,
-41686,
-41283,
-40714,
-40082,
-39492,
-39072,
-38891,
-39016,
-39431,
-40097,
-40936,
-41868,
-42814,
-43719,
-44552,
-45293,
-45940,
-46476,
-46888,
-47124,
-47141,
-46862,
-46230,
-45190,
-43716,
-41811,
-39514,
-36904,
-34079,
-31171,
-28301,
-25593,
-23145,
-21035,
-19293,
-17945,
-16958,
-16319,
-15984,
-15919,
-16114,
-16540,
-17192,
-18058,
-19085,
-20244,
-21433,
-22576,
-23578,
-24369,
-24902,
-25186,
-25241,
-25145,
-24967,
-24773,
-24625,
-24533,
-24525,
-24581,
-24706,
-24904,
-25185,
-25593,
-26136,
-26865,
-27766,
-28850,
-30080,
-31428,
-32841,
-34281,
-35691,
-37021,
-38225,
-39229,
-40000,
-40474,
-40635,
-40481,
-40029,
-39335,
-38449,
-37432,
-36332,
-35179,
-33996,
-32797,
-31596,
-30431,
-29350,
-28405,
-27672,
-27198,
-27025,
-27183,
-27656,
-28431,
-29454,
-30675,
-32009,
-33394,
-34741,
-35993,
-37121,
-38098,
-38958,
-39722,
-40423,
-41072,
-41660,
-42124,
-42431,
-42503,
-42326,
-41919,
-41339,
-40710,
-40130,
-39737,
-39588,
-39744,
-40179,
-40855,
-41701,
-42635,
-43589,
-44493,
-45311,
-46001,
-46558,
-46971,
-47232,
-47343,
-47270,
-46987,
-46434,
-45549,
-44278,
-42571,
-40442,
-37922,
-35123,
-32166,
-29221,
-26433,
-23931,
-21807,
-20083,
-18767,
-17813,
-17175,
-16822,
-16716,
-16866,
-17270,
-17931,
-18842,
-19948,
-21189,
-22454,
-23647,
-24661,
-25419,
-25897,
-26081,
-26031,
-25804,
-25479,
-25147,
-24852,
-24655,
-24569,
-24603,
-24758,
-25018,
-25381,
-25855,
-26434,
-27155,
-28008,
-29026,
-30199,
-31502,
-32923,
-34379,
-35819,
-37164,
-38323,
-39257,
-39887,
-40228,
-40249,
-40013,
-39530,
-38872,
-38053,
-37128,
-36089,
-34968,
-33759,
-32495,
-31209,
-29944,
-28778,
-27763,
-26978,
-26468,
-26273,
-26412,
-26887,
-27673,
-28732,
-29989,
-31380,
-32799,
-34189,
-35471,
-36629,
-37651,
-38567,
-39399,
-40167,
-40871,
-41463,
-41911,
-42138,
-42124,
-41851,
-41374,
-40760,
-40133,
-39587,
-39240,
-39144,
-39327,
-39783,
-40453,
-41282,
-42196,
-43121,
-44015,
-44826,
-45546,
-46147,
-46632,
-46975,
-47147,
-47101,
-46778,
-46096,
-45022,
-43483,
-41520,
-39140,
-36447,
-33556,
-30590,
-27705,
-25000,
-22581,
-20507,
-18795,
-17470,
-16491,
-15865,
-15544,
-15530,
-15784,
-16312,
-17074,
-18055,
-19189,
-20431,
-21682,
-22857,
-23867,
-24622,
-25111,
-25299,
-25260,
-25052,
-24774,
-24517,
-24344,
-24285,
-24352,
-24514,
-24755,
-25061,
-25426,
-25880,
-26435,
-27124,
-27951,
-28930,
-30034,
-31275,
-32609,
-34026,
-35487,
-36911,
-38247,
-39373,
-40224,
-40733,
-40876,
-40686,
-40204,
-39512,
-38658,
-37680,
-36592,
-35393,
-34096,
-32734,
-31364,
-30077,
-28963,
-28087,
-27508,
-27218,
-27218,
-27473,
-27963,
-28676,
-29592,
-30696,
-31939,
-33268,
-34607,
-35884,
-37048,
-38080,
-38978,
-39784,
-40502,
-41157,
-41710,
-42132,
-42343,
-42331,
-42052,
-41577,
-40962,
-40333,
-39815,
-39499,
-39479,
-39746,
-40299,
-41049,
-41924,
-42833,
-43701,
-44489,
-45179,
-45767,
-46270,
-46674,
-46976,
-47122,
-47065,
-46731,
-46051,
-44984,
-43489,
-41578,
-39284,
-36673,
-33848,
-30928,
-28042,
-25325,
-22886,
-20809,
-19136,
-17873,
-16982,
-16422,
-16137,
-16089,
-16267,
-16665,
-17296,
-18152,
-19204,
-20389,
-21610,
-22752,
-23713,
-24401,
-24799,
-24907,
-24794,
-24549,
-24243,
-23977,
-23755,
-23628,
-23554,
-23549,
-23596,
-23717,
-23944,
-24314,
-24853,
-25599,
-26525,
-27641,
-28901,
-30283,
-31746,
-33248,
-34730,
-36138,
-37383,
-38406,
-39135,
-39547,
-39636,
-39432,
-38990,
-38346,
-37557,
-36636,
-35597,
-34455,
-33216,
-31934,
-30655,
-29468,
-28437,
-27639,
-27115,
-26891,
-26978,
-27350,
-28010,
-28904,
-30014,
-31282,
-32639,
-34028,
-35368,
-36611,
-37725,
-38694,
-39539,
-40283,
-40947,
-41538,
-42040,
-42405,
-42591,
-42546,
-42259,
-41752,
-41095,
-40398,
-39797,
-39402,
-39321,
-39561,
-40132,
-40923,
-41872,
-42829,
-43755,
-44558,
-45262,
-45845,
-46352,
-46758,
-47072,
-47221,
-47159,
-46795,
-46064,
-44913,
-43315,
-41282,
-38868,
-36148,
-33253,
-30307,
-27461,
-24826,
-22511,
-20549,
-18971,
-17741,
-16832,
-16225,
-15888,
-15840,
-16066,
-16568,
-17326,
-18287,
-19389,
-20563,
-21727,
-22824,
-23792,
-24558,
-25079,
-25274,
-25106,
-24575,
-23690,
-22579,
-21338,
-20148,
-19116,
-18345,
-17833,
-17555,
-17419,
-17345,
-17271,
-17173,
-17077,
-17021,
-17061,
-17210,
-17479,
-17824,
-18213,
-18589,
-18942,
-19243,
-19511,
-19756,
-19979,
-20190,
-20379,
-20530,
-20659,
-20754,
-20856,
-20972,
-21138,
-21351,
-21626,
-21925,
-22251,
-22565,
-22873,
-23179,
-23495,
-23848,
-24250,
-24695,
-25171,
-25638,
-26067,
-26425,
-26711,
-26939,
-27138,
-27359,
-27617,
-27935,
-28296,
-28665,
-29005,
-29296,
-29517,
-29706,
-29884,
-30100,
-30389,
-30755,
-31204,
-31695,
-32212,
-32725,
-33225,
-33716,
-34210,
-34711,
-35232,
-35758,
-36283,
-36784,
-37256,
-37685,
-38078,
-38430,
-38751,
-39033,
-39280,
-39486,
-39654,
-39796,
-39923,
-40060,
-40220,
-40422,
-40663,
-40942,
-41240,
-41546,
-41842,
-42114,
-42362,
-42574,
-42758,
-42913,
-43044,
-43155,
-43261,
-43363,
-43474,
-43608,
-43753,
-43926,
-44095,
-44258,
-44391,
-44479,
-44510,
-44483,
-44400,
-44285,
-44149,
-44021,
-43917,
-43854,
-43846,
-43883,
-43970,
-44083,
-44206,
-44325,
-44420,
-44484,
-44521,
-44522,
-44507,
-44468,
-44416,
-44341,
-44249,
-44129,
-43998,
-43859,
-43735,
-43637,
-43569,
-43527,
-43488,
-43420,
-43299,
-43098,
-42823,
-42494,
-42139,
-41813,
-41542,
-41351,
-41245,
-41192,
-41175,
-41146,
-41092,
-40990,
-40852,
-40683,
-40502,
-40319,
-40130,
-39935,
-39715,
-39469,
-39190,
-38891,
-38585,
-38293,
-38028,
-37791,
-37579,
-37370,
-37157,
-36920,
-36662,
-36382,
-36096,
-35811,
-35535,
-35268,
-35010,
-34757,
-34509,
-34280,
-34062,
-33872,
-33699,
-33518,
-33323,
-33066,
-32744,
-32349,
-31882,
-31393,
-30876,
-30394,
-29922,
-29474,
-29032,
-28560,
-28073,
-27547,
-27024,
-26519,
-26071,
-25699,
-25411,
-25199,
-25037,
-24897,
-24753,
-24599,
-24425,
-24255,
-24089,
-23952,
-23839,
-23744,
-23647,
-23533,
-23376,
-23183,
-22942,
-22682,
-22405,
-22139,
-21883,
-21652,
-21433,
-21228,
-21037,
-20848,
-20688,
-20543,
-20437,
-20362,
-20325,
-20320,
-20347,
-20399,
-20470,
-20554,
-20631,
-20694,
-20712,
-20680,
-20586,
-20438,
-20255,
-20061,
-19891,
-19766,
-19700,
-19690,
-19730,
-19792,
-19868,
-19942,
-20006,
-20081,
-20158,
-20257,
-20366,
-20487,
-20603,
-20708,
-20800,
-20890,
-21007,
-21169,
-21410,
-21732,
-22120,
-22548,
-22965,
-23315,
-23591,
-23740,
-23831,
-23851,
-23883,
-23939,
-24055,
-24219,
-24424,
-24636,
-24847,
-25054,
-25260,
-25496,
-25763,
-26078,
-26427,
-26785,
-27141,
-27460,
-27752,
-28007,
-28258,
-28502,
-28771,
-29048,
-29349,
-29644,
-29952,
-30245,
-30538,
-30822,
-31096,
-31342,
-31563,
-31733,
-31878,
-31992,
-32126,
-32297,
-32551,
-32899,
-33329,
-33839,
-34369,
-34897,
-35385,
-35821,
-36215,
-36580,
-36951,
-37339,
-37759,
-38193,
-38623,
-39007,
-39337,
-39574,
-39748,
-39857,
-39950,
-40037,
-40161,
-40302,
-40483,
-40659,
-40843,
-40997,
-41149,
-41285,
-41430,
-41591,
-41758,
-41939,
-42094,
-42235,
-42324,
-42386,
-42417,
-42450,
-42497,
-42582,
-42703,
-42857,
-43031,
-43202,
-43349,
-43459,
-43514,
-43515,
-43459,
-43353,
-43217,
-43062,
-42921,
-42803,
-42738,
-42719,
-42750,
-42807,
-42877,
-42940,
-42981,
-43000,
-42996,
-42973,
-42946,
-42894,
-42844,
-42753,
-42659,
-42535,
-42415,
-42303,
-42212,
-42154,
-42110,
-42086,
-42032,
-41959,
-41827,
-41653,
-41422,
-41168,
-40882,
-40598,
-40321,
-40061,
-39832,
-39641,
-39490,
-39385,
-39311,
-39260,
-39215,
-39150,
-39062,
-38931,
-38769,
-38574,
-38360,
-38139,
-37916,
-37694,
-37472,
-37248,
-37020,
-36796,
-36565,
-36347,
-36129,
-35914,
-35703,
-35473,
-35235,
-34967,
-34685,
-34389,
-34100,
-33835,
-33611,
-33446,
-33328,
-33265,
-33207,
-33158,
-33059,
-32916,
-32710,
-32453,
-32166,
-31867,
-31576,
-31305,
-31042,
-30784,
-30494,
-30179,
-29800,
-29396,
-28953,
-28522,
-28121,
-27779,
-27506,
-27304,
-27156,
-27043,
-26943,
-26838,
-26717,
-26588,
-26450,
-26324,
-26203,
-26099,
-25990,
-25880,
-25738,
-25581,
-25390,
-25189,
-24990,
-24795,
-24633,
-24483,
-24358,
-24242,
-24125,
-24005,
-23871,
-23725,
-23567,
-23409,
-23247,
-23114,
-23006,
-22960,
-22974,
-23063,
-23221,
-23416,
-23637,
-23817,
-23947,
-23981,
-23912,
-23759,
-23523,
-23272,
-23004,
-22803,
-22639,
-22576,
-22567,
-22630,
-22724,
-22845,
-22954,
-23066,
-23149,
-23224,
-23284,
-23341,
-23396,
-23468,
-23545,
-23658,
-23797,
-23983,
-24213,
-24488,
-24802,
-25134,
-25474,
-25783,
-26059,
-26269,
-26423,
-26515,
-26562,
-26591,
-26610,
-26666,
-26748,
-26888,
-27072,
-27288,
-27530,
-27770,
-27999,
-28220,
-28422,
-28639,
-28868,
-29144,
-29457,
-29813,
-30189,
-30556,
-30894,
-31173,
-31386,
-31540,
-31651,
-31745,
-31854,
-31980,
-32143,
-32318,
-32494,
-32662,
-32790,
-32922,
-33032,
-33192,
-33393,
-33672,
-34023,
-34423,
-34853,
-35268,
-35653,
-35991,
-36285,
-36567,
-36845,
-37160,
-37506,
-37887,
-38279,
-38653,
-38977,
-39226,
-39398,
-39490,
-39536,
-39550,
-39574,
-39620,
-39709,
-39827,
-39974,
-40124,
-40270,
-40403,
-40513,
-40616,
-40703,
-40794,
-40882,
-40964,
-41049,
-41117,
-41180,
-41240,
-41287,
-41352,
-41403,
-41471,
-41535,
-41599,
-41662,
-41716,
-41755,
-41778,
-41765,
-41721,
-41631,
-41516,
-41371,
-41237,
-41123,
-41055,
-41038,
-41065,
-41124,
-41194,
-41252,
-41288,
-41300,
-41285,
-41261,
-41222,
-41168,
-41110,
-41019,
-40919,
-40793,
-40666,
-40543,
-40445,
-40372,
-40322,
-40284,
-40234,
-40155,
-40032,
-39855,
-39624,
-39362,
-39071,
-38790,
-38526,
-38305,
-38130,
-38009,
-37932,
-37893,
-37864,
-37842,
-37790,
-37710,
-37592,
-37433,
-37248,
-37047,
-36843,
-36652,
-36482,
-36330,
-36199,
-36068,
-35942,
-35787,
-35621,
-35414,
-35191,
-34947,
-34694,
-34445,
-34205,
-33979,
-33769,
-33571,
-33380,
-33202,
-33025,
-32868,
-32720,
-32593,
-32480,
-32368,
-32246,
-32098,
-31904,
-31674,
-31391,
-31090,
-30775,
-30467,
-30178,
-29894,
-29612,
-29308,
-28967,
-28589,
-28174,
-27760,
-27367,
-27034,
-26780,
-26605,
-26506,
-26442,
-26396,
-26330,
-26236,
-26116,
-25983,
-25865,
-25780,
-25745,
-25753,
-25791,
-25825,
-25837,
-25792,
-25698,
-25541,
-25366,
-25171,
-25005,
-24853,
-24738,
-24640,
-24551,
-24472,
-24388,
-24323,
-24272,
-24254,
-24263,
-24305,
-24366,
-24451,
-24557,
-24678,
-24830,
-24979,
-25129,
-25220,
-25246,
-25164,
-24993,
-24758,
-24514,
-24317,
-24219,
-24232,
-24340,
-24511,
-24677,
-24814,
-24896,
-24930,
-24956,
-24988,
-25061,
-25171,
-25292,
-25420,
-25518,
-25612,
-25706,
-25843,
-26043,
-26324,
-26665,
-27044,
-27414,
-27740,
-28011,
-28214,
-28383,
-28530,
-28697,
-28898,
-29156,
-29481,
-29885,
-30362,
-30916,
-31514,
-32137,
-32742,
-33298,
-33788,
-34214,
-34614,
-35028,
-35515,
-36099,
-36805,
-37598,
-38450,
-39308,
-40127,
-40896,
-41596,
-42252,
-42872,
-43466,
-44037,
-44565,
-45049,
-45470,
-45851,
-46188,
-46528,
-46861,
-47223,
-47579,
-47933,
-48242,
-48496,
-48676,
-48781,
-48834,
-48836,
-48834,
-48815,
-48818,
-48826,
-48854,
-48876,
-48890,
-48865,
-48788,
-48640,
-48402,
-48084,
-47690,
-47239,
-46770,
-46277,
-45811,
-45345,
-44898,
-44448,
-43993,
-43517,
-43017,
-42489,
-41922,
-41320,
-40673,
-39976,
-39244,
-38474,
-37696,
-36925,
-36176,
-35457,
-34765,
-34073,
-33364,
-32602,
-31771,
-30858,
-29873,
-28826,
-27752,
-26679,
-25634,
-24656,
-23745,
-22932,
-22192,
-21538,
-20929,
-20350,
-19777,
-19170,
-18543,
-17881,
-17208,
-16556,
-15953,
-15429,
-15002,
-14666,
-14395,
-14166,
-13935,
-13674,
-13375,
-13037,
-12686,
-12358,
-12082,
-11886,
-11787,
-11781,
-11861,
-12024,
-12236,
-12517,
-12826,
-13187,
-13558,
-13946,
-14314,
-14667,
-14991,
-15308,
-15649,
-16042,
-16522,
-17105,
-17774,
-18509,
-19249,
-19964,
-20604,
-21185,
-21708,
-22235,
-22805,
-23468,
-24243,
-25127,
-26097,
-27117,
-28145,
-29159,
-30127,
-31062,
-31946,
-32803,
-33620,
-34408,
-35168,
-35903,
-36618,
-37313,
-37996,
-38653,
-39289,
-39885,
-40449,
-40971,
-41476,
-41950,
-42424,
-42872,
-43304,
-43692,
-44035,
-44332,
-44594,
-44849,
-45109,
-45405,
-45717,
-46041,
-46332,
-46564,
-46704,
-46755,
-46709,
-46606,
-46460,
-46301,
-46144,
-45985,
-45833,
-45675,
-45522,
-45361,
-45206,
-45037,
-44855,
-44635,
-44366,
-44028,
-43630,
-43170,
-42686,
-42184,
-41707,
-41245,
-40813,
-40383,
-39930,
-39420,
-38828,
-38135,
-37347,
-36476,
-35564,
-34642,
-33765,
-32954,
-32239,
-31609,
-31072,
-30581,
-30138,
-29696,
-29249,
-28779,
-28292,
-27773,
-27263,
-26738,
-26255,
-25801,
-25416,
-25092,
-24844,
-24647,
-24497,
-24360,
-24230,
-24078,
-23913,
-23732,
-23555,
-23391,
-23276,
-23209,
-23231,
-23330,
-23524,
-23802,
-24137,
-24518,
-24897,
-25261,
-25588,
-25878,
-26152,
-26434,
-26768,
-27168,
-27665,
-28244,
-28887,
-29565,
-30232,
-30867,
-31441,
-31964,
-32436,
-32906,
-33384,
-33924,
-34538,
-35239,
-36027,
-36872,
-37760,
-38643,
-39508,
-40318,
-41073,
-41764,
-42399,
-42989,
-43541,
-44073,
-44594,
-45108,
-45624,
-46130,
-46627,
-47094,
-47521,
-47895,
-48205,
-48458,
-48654,
-48811,
-48935,
-49036,
-49117,
-49181,
-49224,
-49254,
-49271,
-49285,
-49297,
-49299,
-49277,
-49207,
-49072,
-48851,
-48548,
-48176,
-47760,
-47335,
-46924,
-46526,
-46157,
-45765,
-45362,
-44896,
-44390,
-43828,
-43245,
-42646,
-42052,
-41451,
-40849,
-40208,
-39548,
-38836,
-38106,
-37355,
-36600,
-35853,
-35090,
-34306,
-33472,
-32560,
-31586,
-30532,
-29459,
-28373,
-27344,
-26376,
-25502,
-24719,
-24001,
-23346,
-22700,
-22063,
-21404,
-20720,
-20030,
-19326,
-18659,
-18026,
-17469,
-16984,
-16591,
-16256,
-15991,
-15741,
-15510,
-15261,
-14997,
-14710,
-14409,
-14107,
-13819,
-13572,
-13380,
-13269,
-13251,
-13339,
-13529,
-13812,
-14161,
-14557,
-14953,
-15351,
-15700,
-16039,
-16341,
-16657,
-16996,
-17391,
-17865,
-18413,
-19039,
-19709,
-20396,
-21071,
-21698,
-22280,
-22817,
-23346,
-23893,
-24513,
-25208,
-26015,
-26901,
-27857,
-28843,
-29832,
-30800,
-31727,
-32616,
-33451,
-34248,
-34994,
-35704,
-36381,
-37039,
-37688,
-38335,
-38990,
-39639,
-40279,
-40887,
-41448,
-41957,
-42408,
-42809,
-43169,
-43493,
-43795,
-44064,
-44324,
-44555,
-44793,
-45023,
-45264,
-45513,
-45745,
-45954,
-46099,
-46172,
-46157,
-46064,
-45912,
-45726,
-45541,
-45360,
-45198,
-45047,
-44890,
-44720,
-44516,
-44277,
-43998,
-43675,
-43313,
-42899,
-42453,
-41963,
-41459,
-40942,
-40438,
-39944,
-39463,
-38987,
-38489,
-37962,
-37385,
-36749,
-36062,
-35314,
-34528,
-33706,
-32861,
-32025,
-31205,
-30453,
-29782,
-29208,
-28730,
-28311,
-27916,
-27492,
-27006,
-26444,
-25833,
-25211,
-24646,
-24166,
-23818,
-23572,
-23413,
-23281,
-23144,
-22962,
-22748,
-22498,
-22255,
-22029,
-21844,
-21693,
-21583,
-21501,
-21462,
-21477,
-21564,
-21744,
-22019,
-22371,
-22788,
-23206,
-23610,
-23965,
-24268,
-24541,
-24811,
-25123,
-25510,
-25993,
-26572,
-27228,
-27926,
-28633,
-29309,
-29938,
-30516,
-31046,
-31562,
-32076,
-32631,
-33240,
-33921,
-34686,
-35519,
-36423,
-37361,
-38313,
-39243,
-40119,
-40922,
-41637,
-42272,
-42844,
-43384,
-43918,
-44463,
-45033,
-45605,
-46183,
-46717,
-47209,
-47636,
-47988,
-48289,
-48521,
-48719,
-48876,
-49011,
-49127,
-49240,
-49357,
-49479,
-49608,
-49726,
-49822,
-49865,
-49845,
-49740,
-49561,
-49313,
-49022,
-48704,
-48380,
-48056,
-47733,
-47400,
-47052,
-46678,
-46274,
-45843,
-45382,
-44898,
-44394,
-43850,
-43280,
-42657,
-42000,
-41307,
-40601,
-39891,
-39210,
-38544,
-37914,
-37273,
-36623,
-35908,
-35130,
-34260,
-33320,
-32321,
-31295,
-30276,
-29278,
-28334,
-27435,
-26601,
-25826,
-25100,
-24442,
-23805,
-23218,
-22620,
-22025,
-21399,
-20753,
-20102,
-19464,
-18888,
-18388,
-17986,
-17672,
-17416,
-17187,
-16933,
-16642,
-16292,
-15916,
-15532,
-15198,
-14932,
-14775,
-14721,
-14759,
-14877,
-15041,
-15243,
-15469,
-15712,
-15983,
-16269,
-16574,
-16890,
-17207,
-17527,
-17865,
-18223,
-18647,
-19127,
-19695,
-20326,
-20995,
-21670,
-22304,
-22874,
-23380,
-23838,
-24290,
-24793,
-25374,
-26078,
-26885,
-27792,
-28745,
-29710,
-30655,
-31542,
-32391,
-33174,
-33928,
-34638,
-35322,
-35978,
-36612,
-37226,
-37830,
-38428,
-39020,
-39608,
-40168,
-40700,
-41173,
-41586,
-41938,
-42226,
-42486,
-42713,
-42940,
-43166,
-43407,
-43650,
-43900,
-44139,
-44355,
-44539,
-44668,
-44734,
-44732,
-44664,
-44536,
-44373,
-44182,
-43989,
-43791,
-43591,
-43384,
-43162,
-42924,
-42671,
-42399,
-42122,
-41823,
-41505,
-41147,
-40739,
-40284,
-39785,
-39263,
-38752,
-38261,
-37816,
-37394,
-36989,
-36548,
-36059,
-35469,
-34789,
-34009,
-33161,
-32269,
-31377,
-30504,
-29703,
-28968,
-28340,
-27796,
-27350,
-26962,
-26614,
-26259,
-25878,
-25440,
-24956,
-24427,
-23901,
-23397,
-22962,
-22591,
-22307,
-22069,
-21874,
-21671,
-21467,
-21235,
-20992,
-20754,
-20527,
-20341,
-20191,
-20094,
-20049,
-20063,
-20146,
-20298,
-20534,
-20840,
-21213,
-21619,
-22045,
-22453,
-22837,
-23198,
-23537,
-23900,
-24298,
-24762,
-25317,
-25934,
-26624,
-27327,
-28028,
-28679,
-29280,
-29807,
-30310,
-30784,
-31308,
-31886,
-32574,
-33374,
-34286,
-35298,
-36377,
-37493,
-38623,
-39731,
-40816,
-41853,
-42855,
-43807,
-44711,
-45558,
-46332,
-47021,
-47618,
-48113,
-48535,
-48889,
-49221,
-49540,
-49866,
-50182,
-50457,
-50647,
-50704,
-50616,
-50376,
-50028,
-49608,
-49181,
-48751,
-48341,
-47903,
-47402,
-46808,
-46094,
-45285,
-44410,
-43499,
-42586,
-41650,
-40670,
-39613,
-38432,
-37159,
-35792,
-34421,
-33077,
-31820,
-30645,
-29548,
-28476,
-27420,
-26348,
-25306,
-24310,
-23426,
-22656,
-22013,
-21457,
-20937,
-20435,
-19904,
-19391,
-18918,
-18533,
-18296,
-18192,
-18243,
-18390,
-18617,
-18877,
-19176,
-19513,
-19908,
-20390,
-20949,
-21595,
-22286,
-23005,
-23723,
-24444,
-25187,
-25992,
-26898,
-27939,
-29103,
-30374,
-31679,
-32957,
-34151,
-35222,
-36188,
-37068,
-37916,
-38765,
-39628,
-40484,
-41291,
-42004,
-42586,
-43052,
-43405,
-43715,
-44008,
-44312,
-44623,
-44895,
-45087,
-45159,
-45086,
-44885,
-44593,
-44239,
-43879,
-43504,
-43122,
-42698,
-42207,
-41631,
-40968,
-40230,
-39450,
-38631,
-37800,
-36927,
-36007,
-35012,
-33921,
-32748,
-31514,
-30253,
-29024,
-27850,
-26751,
-25730,
-24757,
-23817,
-22886,
-21978,
-21096,
-20282,
-19551,
-18912,
-18353,
-17852,
-17365,
-16895,
-16434,
-16031,
-15717,
-15543,
-15524,
-15639,
-15868,
-16140,
-16447,
-16763,
-17128,
-17571,
-18139,
-18840,
-19651,
-20530,
-21413,
-22256,
-23052,
-23825,
-24639,
-25559,
-26624,
-27852,
-29195,
-30605,
-31986,
-33294,
-34481,
-35561,
-36553,
-37502,
-38436,
-39373,
-40300,
-41189,
-42016,
-42739,
-43374,
-43909,
-44392,
-44837,
-45271,
-45686,
-46063,
-46363,
-46561,
-46626,
-46580,
-46431,
-46242,
-46023,
-45809,
-45570,
-45280,
-44906,
-44418,
-43824,
-43155,
-42449,
-41749,
-41066,
-40378,
-39642,
-38805,
-37834,
-36728,
-35528,
-34291,
-33087,
-31958,
-30918,
-29947,
-29015,
-28085,
-27158,
-26233,
-25359,
-24553,
-23843,
-23224,
-22669,
-22145,
-21645,
-21139,
-20683,
-20284,
-19996,
-19841,
-19818,
-19912,
-20093,
-20329,
-20596,
-20900,
-21242,
-21649,
-22136,
-22711,
-23363,
-24083,
-24837,
-25617,
-26415,
-27240,
-28115,
-29069,
-30113,
-31264,
-32497,
-33787,
-35092,
-36368,
-37586,
-38728,
-39798,
-40806,
-41764,
-42693,
-43572,
-44421,
-45192,
-45898,
-46515,
-47048,
-47520,
-47931,
-48313,
-48663,
-48979,
-49247,
-49438,
-49534,
-49519,
-49391,
-49170,
-48871,
-48523,
-48144,
-47728,
-47273,
-46756,
-46162,
-45490,
-44752,
-43969,
-43166,
-42353,
-41520,
-40633,
-39658,
-38556,
-37332,
-35995,
-34618,
-33248,
-31961,
-30765,
-29683,
-28658,
-27686,
-26713,
-25762,
-24831,
-23970,
-23189,
-22499,
-21876,
-21298,
-20726,
-20167,
-19624,
-19162,
-18808,
-18627,
-18598,
-18725,
-18942,
-19212,
-19493,
-19780,
-20096,
-20475,
-20959,
-21562,
-22272,
-23062,
-23874,
-24678,
-25451,
-26201,
-26981,
-27830,
-28808,
-29927,
-31176,
-32500,
-33830,
-35092,
-36230,
-37239,
-38125,
-38947,
-39743,
-40548,
-41361,
-42156,
-42887,
-43526,
-44046,
-44476,
-44840,
-45185,
-45531,
-45866,
-46163,
-46366,
-46444,
-46375,
-46183,
-45908,
-45598,
-45283,
-44971,
-44619,
-44206,
-43669,
-43025,
-42263,
-41460,
-40638,
-39854,
-39103,
-38353,
-37560,
-36657,
-35624,
-34436,
-33151,
-31798,
-30458,
-29182,
-27988,
-26897,
-25872,
-24906,
-23962,
-23055,
-22180,
-21366,
-20636,
-19981,
-19412,
-18880,
-18370,
-17849,
-17323,
-16821,
-16388,
-16083,
-15942,
-15983,
-16175,
-16482,
-16834,
-17206,
-17568,
-17961,
-18395,
-18938,
-19582,
-20337,
-21154,
-21991,
-22817,
-23614,
-24418,
-25265,
-26209,
-27279,
-28473,
-29756,
-31063,
-32341,
-33533,
-34633,
-35651,
-36617,
-37575,
-38538,
-39511,
-40456,
-41342,
-42119,
-42768,
-43284,
-43694,
-44038,
-44358,
-44675,
-45001,
-45295,
-45536,
-45667,
-45675,
-45566,
-45356,
-45102,
-44831,
-44567,
-44302,
-44006,
-43637,
-43171,
-42596,
-41927,
-41209,
-40456,
-39702,
-38926,
-38098,
-37195,
-36170,
-35053,
-33854,
-32644,
-31476,
-30383,
-29399,
-28489,
-27649,
-26822,
-26017,
-25215,
-24449,
-23738,
-23097,
-22538,
-22041,
-21587,
-21160,
-20742,
-20349,
-19996,
-19711,
-19529,
-19459,
-19510,
-19668,
-19917,
-20240,
-20623,
-21063,
-21562,
-22131,
-22761,
-23464,
-24199,
-24971,
-25745,
-26531,
-27340,
-28196,
-29144,
-30201,
-31381,
-32655,
-33986,
-35304,
-36567,
-37734,
-38802,
-39792,
-40734,
-41656,
-42564,
-43456,
-44294,
-45055,
-45717,
-46268,
-46747,
-47159,
-47552,
-47925,
-48282,
-48588,
-48824,
-48942,
-48946,
-48826,
-48614,
-48337,
-48025,
-47696,
-47347,
-46966,
-46522,
-45999,
-45377,
-44670,
-43890,
-43063,
-42215,
-41339,
-40438,
-39470,
-38415,
-37252,
-35992,
-34667,
-33336,
-32047,
-30854,
-29748,
-28740,
-27765,
-26816,
-25849,
-24897,
-23969,
-23123,
-22373,
-21732,
-21179,
-20677,
-20189,
-19702,
-19235,
-18809,
-18506,
-18318,
-18312,
-18426,
-18660,
-18959,
-19284,
-19651,
-20041,
-20506,
-21044,
-21675,
-22373,
-23124,
-23884,
-24649,
-25417,
-26222,
-27099,
-28094,
-29215,
-30464,
-31789,
-33131,
-34419,
-35603,
-36656,
-37593,
-38442,
-39256,
-40070,
-40897,
-41732,
-42515,
-43231,
-43822,
-44297,
-44669,
-44978,
-45255,
-45530,
-45787,
-46002,
-46135,
-46154,
-46052,
-45850,
-45578,
-45276,
-44965,
-44636,
-44273,
-43827,
-43289,
-42640,
-41915,
-41140,
-40358,
-39580,
-38794,
-37968,
-37054,
-36016,
-34858,
-33583,
-32275,
-30963,
-29725,
-28577,
-27518,
-26531,
-25576,
-24626,
-23680,
-22736,
-21839,
-21001,
-20265,
-19619,
-19059,
-18563,
-18087,
-17649,
-17220,
-16858,
-16569,
-16415,
-16387,
-16510,
-16726,
-17031,
-17365,
-17731,
-18121,
-18558,
-19078,
-19682,
-20390,
-21158,
-21973,
-22784,
-23601,
-24411,
-25279,
-26219,
-27286,
-28472,
-29753,
-31087,
-32398,
-33645,
-34791,
-35838,
-36810,
-37742,
-38649,
-39555,
-40432,
-41269,
-42028,
-42703,
-43280,
-43795,
-44252,
-44693,
-45108,
-45488,
-45807,
-46020,
-46110,
-46067,
-45911,
-45686,
-45429,
-45186,
-44947,
-44710,
-44401,
-43998,
-43447,
-42767,
-41988,
-41171,
-40376,
-39624,
-38913,
-38176,
-37365,
-36393,
-35271,
-33993,
-32661,
-31343,
-30122,
-29038,
-28070,
-27188,
-26328,
-25462,
-24583,
-23718,
-22925,
-22222,
-21650,
-21154,
-20728,
-20298,
-19862,
-19418,
-19005,
-18685,
-18488,
-18452,
-18554,
-18769,
-19064,
-19395,
-19772,
-20186,
-20668,
-21232,
-21870,
-22575,
-23316,
-24068,
-24829,
-25596,
-26410,
-27295,
-28285,
-29387,
-30593,
-31858,
-33153,
-34421,
-35638,
-36789,
-37874,
-38911,
-39917,
-40899,
-41852,
-42758,
-43589,
-44322,
-44950,
-45476,
-45930,
-46341,
-46737,
-47145,
-47547,
-47924,
-48235,
-48434,
-48500,
-48422,
-48213,
-47892,
-47496,
-47033,
-46515,
-45938,
-45269,
-44514,
-43635,
-42649,
-41541,
-40329,
-39014,
-37616,
-36149,
-34630,
-33102,
-31583,
-30118,
-28729,
-27434,
-26233,
-25134,
-24105,
-23159,
-22277,
-21471,
-20759,
-20151,
-19683,
-19363,
-19218,
-19245,
-19449,
-19806,
-20304,
-20899,
-21582,
-22318,
-23115,
-23979,
-24935,
-26012,
-27234,
-28595,
-30091,
-31668,
-33282,
-34874,
-36393,
-37808,
-39110,
-40294,
-41382,
-42382,
-43307,
-44155,
-44926,
-45600,
-46173,
-46622,
-46946,
-47133,
-47188,
-47104,
-46900,
-46565,
-46137,
-45596,
-44988,
-44282,
-43515,
-42648,
-41694,
-40628,
-39444,
-38145,
-36737,
-35246,
-33714,
-32178,
-30679,
-29261,
-27921,
-26694,
-25541,
-24474,
-23455,
-22500,
-21598,
-20776,
-20056,
-19458,
-19011,
-18716,
-18582,
-18599,
-18750,
-19035,
-19425,
-19934,
-20535,
-21241,
-22039,
-22939,
-23937,
-25043,
-26253,
-27576,
-28987,
-30472,
-31992,
-33501,
-34961,
-36334,
-37592,
-38741,
-39769,
-40720,
-41581,
-42401,
-43147,
-43847,
-44449,
-44965,
-45342,
-45587,
-45672,
-45605,
-45392,
-45048,
-44591,
-44039,
-43404,
-42700,
-41924,
-41071,
-40131,
-39087,
-37938,
-36674,
-35308,
-33850,
-32334,
-30787,
-29260,
-27773,
-26370,
-25068,
-23870,
-22784,
-21786,
-20863,
-20011,
-19219,
-18512,
-17901,
-17433,
-17117,
-16991,
-17037,
-17249,
-17589,
-18032,
-18538,
-19109,
-19738,
-20450,
-21276,
-22238,
-23358,
-24640,
-26051,
-27576,
-29151,
-30737,
-32286,
-33757,
-35137,
-36410,
-37590,
-38675,
-39702,
-40651,
-41556,
-42387,
-43138,
-43787,
-44310,
-44691,
-44934,
-45024,
-44996,
-44849,
-44615,
-44301,
-43913,
-43451,
-42900,
-42256,
-41494,
-40621,
-39612,
-38495,
-37255,
-35931,
-34531,
-33085,
-31623,
-30169,
-28759,
-27411,
-26154,
-24999,
-23955,
-23029,
-22202,
-21476,
-20830,
-20261,
-19775,
-19377,
-19103,
-18972,
-19007,
-19228,
-19613,
-20147,
-20779,
-21475,
-22195,
-22934,
-23710,
-24549,
-25516,
-26628,
-27924,
-29367,
-30937,
-32544,
-34147,
-35667,
-37086,
-38392,
-39587,
-40709,
-41749,
-42744,
-43656,
-44503,
-45236,
-45864,
-46363,
-46730,
-46975,
-47075,
-47060,
-46903,
-46639,
-46255,
-45790,
-45235,
-44620,
-43925,
-43147,
-42263,
-41249,
-40098,
-38815,
-37417,
-35943,
-34428,
-32911,
-31423,
-29975,
-28592,
-27261,
-26011,
-24828,
-23742,
-22749,
-21866,
-21090,
-20423,
-19870,
-19422,
-19106,
-18907,
-18867,
-18963,
-19218,
-19609,
-20121,
-20740,
-21445,
-22236,
-23120,
-24109,
-25221,
-26472,
-27844,
-29336,
-30880,
-32460,
-33999,
-35478,
-36870,
-38161,
-39382,
-40510,
-41591,
-42588,
-43518,
-44349,
-45070,
-45676,
-46157,
-46526,
-46783,
-46924,
-46961,
-46860,
-46637,
-46272,
-45778,
-45177,
-44472,
-43694,
-42828,
-41878,
-40813,
-39621,
-38303,
-36859,
-35348,
-33786,
-32256,
-30762,
-29355,
-28017,
-26749,
-25544,
-24380,
-23294,
-22262,
-21345,
-20523,
-19831,
-19257,
-18806,
-18478,
-18276,
-18214,
-18293,
-18531,
-18910,
-19424,
-20051,
-20767,
-21567,
-22441,
-23408,
-24470,
-25652,
-26945,
-28344,
-29819,
-31344,
-32869,
-34375,
-35814,
-37178,
-38437,
-39593,
-40633,
-41573,
-42414,
-43175,
-43860,
-44473,
-45005,
-45440,
-45749,
-45924,
-45940,
-45820,
-45561,
-45202,
-44754,
-44229,
-43633,
-42935,
-42130,
-41194,
-40122,
-38925,
-37626,
-36248,
-34829,
-33385,
-31943,
-30505,
-29096,
-27716,
-26392,
-25139,
-23977,
-22916,
-21964,
-21110,
-20348,
-19667,
-19062,
-18548,
-18140,
-17875,
-17770,
-17861,
-18134,
-18590,
-19183,
-19883,
-20650,
-21466,
-22338,
-23275,
-24318,
-25484,
-26788,
-28218,
-29733,
-31289,
-32827,
-34312,
-35720,
-37039,
-38290,
-39460,
-40570,
-41599,
-42536,
-43372,
-44089,
-44702,
-45208,
-45625,
-45946,
-46178,
-46283,
-46270,
-46098,
-45792,
-45351,
-44804,
-44177,
-43474,
-42703,
-41833,
-40854,
-39738,
-38486,
-37108,
-35638,
-34114,
-32590,
-31093,
-29669,
-28314,
-27060,
-25880,
-24796,
-23782,
-22849,
-21988,
-21204,
-20509,
-19911,
-19438,
-19090,
-18905,
-18861,
-18986,
-19238,
-19632,
-20120,
-20721,
-21402,
-22177,
-23048,
-24016,
-25094,
-26285,
-27582,
-28976,
-30454,
-31976,
-33529,
-35056,
-36541,
-37946,
-39249,
-40443,
-41523,
-42490,
-43372,
-44162,
-44882,
-45538,
-46116,
-46610,
-46998,
-47246,
-47339,
-47260,
-47008,
-46607,
-46079,
-45468,
-44794,
-44080,
-43315,
-42475,
-41534,
-40459,
-39236,
-37876,
-36406,
-34873,
-33333,
-31820,
-30372,
-28999,
-27699,
-26468,
-25294,
-24181,
-23130,
-22163,
-21280,
-20518,
-19863,
-19358,
-18983,
-18770,
-18710,
-18814,
-19069,
-19474,
-19997,
-20630,
-21343,
-22131,
-22992,
-23935,
-24974,
-26127,
-27399,
-28785,
-30266,
-31806,
-33369,
-34905,
-36389,
-37787,
-39088,
-40297,
-41399,
-42422,
-43351,
-44204,
-44962,
-45631,
-46188,
-46626,
-46936,
-47097,
-47125,
-47009,
-46770,
-46427,
-45987,
-45474,
-44879,
-44207,
-43426,
-42541,
-41504,
-40341,
-39037,
-37624,
-36135,
-34603,
-33064,
-31551,
-30078,
-28666,
-27327,
-26069,
-24898,
-23838,
-22867,
-22011,
-21237,
-20552,
-19943,
-19410,
-18978,
-18654,
-18489,
-18488,
-18686,
-19058,
-19601,
-20267,
-21027,
-21855,
-22736,
-23679,
-24708,
-25840,
-27097,
-28474,
-29952,
-31487,
-33040,
-34554,
-36000,
-37346,
-38596,
-39732,
-40794,
-41752,
-42648,
-43453,
-44183,
-44814,
-45356,
-45773,
-46084,
-46253,
-46297,
-46200,
-45982,
-45645,
-45213,
-44698,
-44107,
-43441,
-42691,
-41828,
-40856,
-39731,
-38483,
-37102,
-35629,
-34099,
-32550,
-31028,
-29554,
-28156,
-26829,
-25590,
-24413,
-23325,
-22298,
-21360,
-20508,
-19761,
-19126,
-18616,
-18232,
-17990,
-17887,
-17933,
-18124,
-18459,
-18928,
-19512,
-20192,
-20959,
-21797,
-22721,
-23734,
-24857,
-26105,
-27467,
-28939,
-30468,
-32028,
-33553,
-35012,
-36376,
-37630,
-38779,
-39828,
-40788,
-41663,
-42468,
-43185,
-43825,
-44377,
-44824,
-45172,
-45385,
-45475,
-45420,
-45234,
-44925,
-44516,
-44019,
-43456,
-42819,
-42098,
-41274,
-40314,
-39211,
-37952,
-36564,
-35069,
-33524,
-31955,
-30427,
-28944,
-27547,
-26232,
-24998,
-23845,
-22771,
-21771,
-20859,
-20043,
-19337,
-18757,
-18317,
-18020,
-17877,
-17867,
-18005,
-18257,
-18641,
-19127,
-19728,
-20423,
-21222,
-22112,
-23100,
-24190,
-25393,
-26710,
-28149,
-29690,
-31306,
-32955,
-34586,
-36151,
-37615,
-38963,
-40191,
-41318,
-42351,
-43312,
-44187,
-44981,
-45662,
-46225,
-46659,
-46944,
-47111,
-47127,
-47033,
-46810,
-46477,
-46038,
-45513,
-44910,
-44248,
-43520,
-42720,
-41811,
-40786,
-39596,
-38267,
-36799,
-35253,
-33673,
-32127,
-30651,
-29270,
-27986,
-26773,
-25628,
-24520,
-23469,
-22471,
-21569,
-20775,
-20128,
-19640,
-19324,
-19199,
-19258,
-19518,
-19964,
-20604,
-21417,
-22402,
-23536,
-24823,
-26246,
-27801,
-29475,
-31232,
-33040,
-34835,
-36569,
-38201,
-39694,
-41054,
-42274,
-43374,
-44351,
-45187,
-45865,
-46339,
-46599,
-46623,
-46436,
-46067,
-45558,
-44932,
-44204,
-43345,
-42331,
-41122,
-39705,
-38090,
-36335,
-34493,
-32667,
-30901,
-29245,
-27710,
-26267,
-24908,
-23613,
-22388,
-21273,
-20318,
-19579,
-19105,
-18903,
-18970,
-19253,
-19725,
-20326,
-21058,
-21918,
-22934,
-24141,
-25541,
-27138,
-28874,
-30689,
-32511,
-34261,
-35918,
-37449,
-38879,
-40209,
-41467,
-42624,
-43667,
-44548,
-45219,
-45671,
-45881,
-45888,
-45719,
-45422,
-45015,
-44505,
-43874,
-43070,
-42081,
-40858,
-39428,
-37811,
-36073,
-34277,
-32496,
-30775,
-29138,
-27606,
-26155,
-24791,
-23512,
-22325,
-21275,
-20373,
-19676,
-19188,
-18928,
-18886,
-19046,
-19387,
-19904,
-20570,
-21408,
-22396,
-23562,
-24887,
-26371,
-27990,
-29710,
-31491,
-33281,
-35027,
-36680,
-38208,
-39582,
-40810,
-41888,
-42842,
-43669,
-44375,
-44937,
-45325,
-45523,
-45496,
-45279,
-44856,
-44301,
-43605,
-42811,
-41895,
-40828,
-39591,
-38145,
-36519,
-34738,
-32884,
-31036,
-29275,
-27649,
-26170,
-24835,
-23600,
-22445,
-21363,
-20366,
-19511,
-18846,
-18427,
-18284,
-18415,
-18787,
-19362,
-20079,
-20920,
-21870,
-22942,
-24173,
-25575,
-27154,
-28880,
-30700,
-32526,
-34305,
-35956,
-37475,
-38846,
-40102,
-41255,
-42317,
-43278,
-44088,
-44734,
-45151,
-45349,
-45340,
-45140,
-44816,
-44369,
-43823,
-43146,
-42313,
-41269,
-40016,
-38532,
-36889,
-35116,
-33322,
-31547,
-29866,
-28282,
-26818,
-25441,
-24157,
-22946,
-21830,
-20831,
-19996,
-19361,
-18966,
-18818,
-18920,
-19235,
-19733,
-20382,
-21150,
-22050,
-23084,
-24277,
-25655,
-27203,
-28912,
-30711,
-32546,
-34338,
-36026,
-37586,
-38990,
-40266,
-41420,
-42473,
-43421,
-44252,
-44937,
-45450,
-45770,
-45884,
-45803,
-45537,
-45109,
-44522,
-43783,
-42877,
-41798,
-40537,
-39098,
-37514,
-35813,
-34063,
-32304,
-30592,
-28953,
-27418,
-25972,
-24636,
-23380,
-22237,
-21202,
-20315,
-19604,
-19097,
-18833,
-18799,
-19016,
-19439,
-20056,
-20830,
-21742,
-22786,
-23958,
-25285,
-26757,
-28393,
-30150,
-31989,
-33851,
-35653,
-37353,
-38893,
-40274,
-41494,
-42578,
-43545,
-44390,
-45107,
-45662,
-46023,
-46175,
-46105,
-45844,
-45407,
-44839,
-44144,
-43332,
-42374,
-41248,
-39925,
-38408,
-36717,
-34910,
-33050,
-31212,
-29455,
-27806,
-26294,
-24895,
-23624,
-22451,
-21410,
-20511,
-19792,
-19288,
-19006,
-18961,
-19119,
-19472,
-19975,
-20637,
-21443,
-22431,
-23606,
-24987,
-26562,
-28288,
-30103,
-31940,
-33724,
-35415,
-36999,
-38463,
-39838,
-41119,
-42312,
-43386,
-44324,
-45070,
-45630,
-45968,
-46125,
-46096,
-45920,
-45596,
-45127,
-44498,
-43694,
-42701,
-41524,
-40175,
-38679,
-37086,
-35412,
-33723,
-32031,
-30384,
-28796,
-27301,
-25899,
-24618,
-23448,
-22412,
-21511,
-20758,
-20182,
-19788,
-19606,
-19631,
-19875,
-20316,
-20955,
-21758,
-22732,
-23850,
-25129,
-26545,
-28098,
-29759,
-31498,
-33267,
-35021,
-36710,
-38299,
-39755,
-41075,
-42234,
-43259,
-44125,
-44846,
-45409,
-45802,
-46024,
-46061,
-45923,
-45619,
-45158,
-44557,
-43812,
-42923,
-41875,
-40656,
-39258,
-37687,
-35978,
-34171,
-32336,
-30531,
-28809,
-27213,
-25752,
-24429,
-23234,
-22150,
-21187,
-20361,
-19693,
-19230,
-18988,
-18990,
-19225,
-19673,
-20296,
-21071,
-21973,
-23006,
-24179,
-25512,
-27002,
-28646,
-30383,
-32172,
-33923,
-35601,
-37149,
-38571,
-39865,
-41053,
-42143,
-43122,
-43969,
-44642,
-45110,
-45359,
-45392,
-45233,
-44927,
-44483,
-43937,
-43253,
-42425,
-41408,
-40191,
-38770,
-37176,
-35456,
-33669,
-31877,
-30119,
-28435,
-26826,
-25311,
-23881,
-22561,
-21355,
-20308,
-19428,
-18764,
-18318,
-18108,
-18120,
-18347,
-18763,
-19365,
-20136,
-21077,
-22200,
-23487,
-24959,
-26566,
-28297,
-30093,
-31898,
-33678,
-35375,
-36979,
-38474,
-39855,
-41135,
-42302,
-43352,
-44274,
-45036,
-45634,
-46036,
-46251,
-46279,
-46124,
-45814,
-45331,
-44706,
-43895,
-42914,
-41728,
-40360,
-38810,
-37133,
-35370,
-33581,
-31824,
-30118,
-28508,
-26970,
-25536,
-24180,
-22941,
-21831,
-20889,
-20156,
-19649,
-19386,
-19352,
-19534,
-19893,
-20413,
-21065,
-21848,
-22765,
-23833,
-25063,
-26473,
-28043,
-29765,
-31580,
-33439,
-35269,
-37006,
-38614,
-40057,
-41350,
-42488,
-43515,
-44405,
-45180,
-45787,
-46209,
-46410,
-46386,
-46148,
-45728,
-45163,
-44480,
-43680,
-42754,
-41664,
-40387,
-38913,
-37261,
-35491,
-33668,
-31870,
-30153,
-28545,
-27045,
-25646,
-24311,
-23050,
-21872,
-20816,
-19943,
-19297,
-18922,
-18818,
-18965,
-19325,
-19840,
-20492,
-21247,
-22133,
-23169,
-24393,
-25822,
-27438,
-29209,
-31050,
-32901,
-34672,
-36334,
-37857,
-39259,
-40554,
-41766,
-42883,
-43896,
-44758,
-45426,
-45883,
-46099,
-46107,
-45920,
-45576,
-45093,
-44482,
-43716,
-42797,
-41669,
-40371,
-38866,
-37242,
-35506,
-33749,
-31998,
-30294,
-28667,
-27101,
-25624,
-24220,
-22911,
-21729,
-20695,
-19860,
-19232,
-18839,
-18662,
-18696,
-18908,
-19289,
-19825,
-20528,
-21414,
-22491,
-23770,
-25234,
-26848,
-28571,
-30339,
-32109,
-33833,
-35495,
-37060,
-38546,
-39917,
-41187,
-42325,
-43317,
-44141,
-44786,
-45232,
-45495,
-45568,
-45477,
-45226,
-44834,
-44299,
-43627,
-42790,
-41794,
-40603,
-39245,
-37709,
-36054,
-34304,
-32532,
-30774,
-29078,
-27469,
-25958,
-24555,
-23268,
-22097,
-21077,
-20220,
-19560,
-19118,
-18901,
-18905,
-19121,
-19510,
-20063,
-20748,
-21569,
-22534,
-23644,
-24946,
-26405,
-28049,
-29799,
-31620,
-33430,
-35155,
-36770,
-38232,
-39572,
-40799,
-41931,
-42985,
-43919,
-44707,
-45292,
-45638,
-45743,
-45626,
-45325,
-44909,
-44379,
-43774,
-43029,
-42131,
-41022,
-39689,
-38160,
-36476,
-34723,
-32973,
-31276,
-29675,
-28151,
-26716,
-25330,
-24013,
-22775,
-21652,
-20698,
-19940,
-19417,
-19126,
-19057,
-19197,
-19505,
-19985,
-20610,
-21399,
-22357,
-23503,
-24833,
-26343,
-27997,
-29755,
-31549,
-33336,
-35051,
-36673,
-38181,
-39574,
-40853,
-42018,
-43059,
-43965,
-44704,
-45275,
-45650,
-45855,
-45877,
-45756,
-45476,
-45060,
-44481,
-43736,
-42801,
-41684,
-40383,
-38926,
-37341,
-35676,
-33951,
-32231,
-30512,
-28858,
-27258,
-25764,
-24374,
-23119,
-22018,
-21080,
-20334,
-19784,
-19448,
-19318,
-19398,
-19664,
-20105,
-20705,
-21450,
-22343,
-23387,
-24594,
-25970,
-27506,
-29187,
-30965,
-32807,
-34633,
-36420,
-38091,
-39641,
-41026,
-42247,
-43286,
-44153,
-44829,
-45328,
-45633,
-45736,
-45633,
-45288,
-44709,
-43858,
-42756,
-41403,
-39828,
-38079,
-36197,
-34239,
-32251,
-30273,
-28350,
-26521,
-24832,
-23327,
-22050,
-21041,
-20310,
-19885,
-19720,
-19833,
-20177,
-20760,
-21580,
-22645,
-23967,
-25536,
-27333,
-29292,
-31348,
-33423,
-35414,
-37297,
-38994,
-40519,
-41847,
-42997,
-43958,
-44735,
-45314,
-45667,
-45793,
-45662,
-45268,
-44609,
-43674,
-42479,
-41037,
-39381,
-37546,
-35604,
-33596,
-31604,
-29679,
-27859,
-26193,
-24686,
-23363,
-22230,
-21307,
-20598,
-20139,
-19932,
-20005,
-20358,
-20994,
-21906,
-23079,
-24483,
-26103,
-27880,
-29803,
-31792,
-33824,
-35814,
-37722,
-39478,
-41045,
-42383,
-43480,
-44329,
-44950,
-45348,
-45544,
-45539,
-45314,
-44866,
-44158,
-43185,
-41945,
-40463,
-38777,
-36948,
-35031,
-33089,
-31167,
-29314,
-27554,
-25924,
-24452,
-23164,
-22100,
-21271,
-20707,
-20400,
-20359,
-20571,
-21027,
-21729,
-22663,
-23841,
-25241,
-26861,
-28653,
-30582,
-32576,
-34569,
-36485,
-38268,
-39864,
-41260,
-42433,
-43410,
-44189,
-44793,
-45213,
-45439,
-45442,
-45199,
-44672,
-43863,
-42769,
-41420,
-39855,
-38119,
-36260,
-34312,
-32331,
-30333,
-28388,
-26526,
-24816,
-23306,
-22040,
-21037,
-20318,
-19855,
-19648,
-19672,
-19925,
-20416,
-21157,
-22168,
-23440,
-24972,
-26700,
-28591,
-30551,
-32523,
-34442,
-36250,
-37936,
-39453,
-40812,
-41983,
-42965,
-43737,
-44291,
-44607,
-44684,
-44508,
-44087,
-43416,
-42504,
-41357,
-39989,
-38421,
-36689,
-34828,
-32889,
-30930,
-29001,
-27153,
-25422,
-23836,
-22414,
-21175,
-20132,
-19305,
-18722,
-18412,
-18391,
-18695,
-19298,
-20220,
-21412,
-22845,
-24488,
-26279,
-28203,
-30198,
-32235,
-34255,
-36214,
-38047,
-39711,
-41159,
-42368,
-43324,
-44040,
-44516,
-44775,
-44813,
-44630,
-44210,
-43543,
-42614,
-41436,
-40027,
-38426,
-36691,
-34870,
-33021,
-31192,
-29407,
-27706,
-26103,
-24632,
-23312,
-22197,
-21289,
-20651,
-20270,
-20164,
-20327,
-20736,
-21387,
-22265,
-23366,
-24689,
-26220,
-27945,
-29816,
-31786,
-33780,
-35731,
-37568,
-39249,
-40733,
-42023,
-43101,
-43987,
-44666,
-45142,
-45396,
-45402,
-45153,
-44630,
-43828,
-42778,
-41471,
-39965,
-38277,
-36449,
-34524,
-32537,
-30539,
-28573,
-26697,
-24957,
-23404,
-22081,
-21007,
-20209,
-19678,
-19418,
-19411,
-19663,
-20159,
-20921,
-21942,
-23224,
-24760,
-26501,
-28416,
-30418,
-32461,
-34457,
-36374,
-38155,
-39783,
-41233,
-42493,
-43539,
-44373,
-44967,
-45332,
-45460,
-45354,
-45017,
-44445,
-43624,
-42553,
-41219,
-39645,
-37863,
-35927,
-33914,
-31885,
-29915,
-28046,
-26304,
-24714,
-23277,
-22021,
-20963,
-20140,
-19583,
-19312,
-19343,
-19659,
-20262,
-21112,
-22212,
-23529,
-25065,
-26795,
-28690,
-30700,
-32768,
-34813,
-36775,
-38583,
-40198,
-41595,
-42758,
-43700,
-44409,
-44912,
-45193,
-45265,
-45122,
-44742,
-44134,
-43267,
-42144,
-40775,
-39165,
-37371,
-35437,
-33436,
-31426,
-29477,
-27624,
-25907,
-24348,
-22965,
-21792,
-20842,
-20152,
-19741,
-19613,
-19780,
-20201,
-20879,
-21776,
-22898,
-24222,
-25763,
-27497,
-29405,
-31429,
-33505,
-35546,
-37481,
-39238,
-40783,
-42092,
-43177,
-44032,
-44686,
-45129,
-45357,
-45381,
-45151,
-44704,
-43987,
-43036,
-41831,
-40396,
-38749,
-36927,
-34973,
-32958,
-30938,
-28978,
-27148,
-25467,
-23985,
-22697,
-21631,
-20783,
-20183,
-19835,
-19763,
-19975,
-20464,
-21233,
-22242,
-23493,
-24938,
-26572,
-28354,
-30253,
-32225,
-34214,
-36154,
-37996,
-39677,
-41175,
-42458,
-43525,
-44372,
-44999,
-45405,
-45582,
-45518,
-45210,
-44649,
-43838,
-42786,
-41504,
-40013,
-38344,
-36530,
-34620,
-32671,
-30735,
-28873,
-27127,
-25532,
-24111,
-22879,
-21845,
-21028,
-20440,
-20111,
-20049,
-20282,
-20799,
-21602,
-22662,
-23964,
-25460,
-27146,
-28958,
-30888,
-32872,
-34861,
-36799,
-38610,
-40249,
-41667,
-42840,
-43773,
-44480,
-44977,
-45305,
-45439,
-45394,
-45120,
-44582,
-43761,
-42624,
-41210,
-39552,
-37729,
-35821,
-33889,
-31999,
-30169,
-28420,
-26761,
-25198,
-23774,
-22515,
-21488,
-20721,
-20255,
-20079,
-20196,
-20571,
-21187,
-22038,
-23105,
-24416,
-25934,
-27668,
-29546,
-31521,
-33510,
-35446,
-37273,
-38952,
-40468,
-41804,
-42962,
-43922,
-44683,
-45207,
-45508,
-45545,
-45341,
-44884,
-44174,
-43230,
-42030,
-40618,
-38985,
-37198,
-35278,
-33309,
-31321,
-29393,
-27544,
-25827,
-24262,
-22884,
-21722,
-20805,
-20155,
-19791,
-19704,
-19899,
-20347,
-21048,
-21988,
-23163,
-24576,
-26199,
-28015,
-29957,
-31972,
-33977,
-35908,
-37714,
-39357,
-40825,
-42110,
-43206,
-44107,
-44798,
-45258,
-45482,
-45444,
-45159,
-44615,
-43839,
-42820,
-41588,
-40135,
-38488,
-36678,
-34737,
-32735,
-30724,
-28776,
-26939,
-25262,
-23767,
-22470,
-21380,
-20506,
-19857,
-19459,
-19325,
-19484,
-19942,
-20708,
-21758,
-23074,
-24617,
-26329,
-28192,
-30128,
-32124,
-34116,
-36063,
-37923,
-39632,
-41165,
-42467,
-43538,
-44351,
-44931,
-45268,
-45392,
-45282,
-44951,
-44376,
-43549,
-42481,
-41167,
-39654,
-37968,
-36153,
-34263,
-32325,
-30395,
-28509,
-26709,
-25054,
-23577,
-22330,
-21330,
-20591,
-20116,
-19891,
-19921,
-20195,
-20731,
-21533,
-22599,
-23934,
-25487,
-27240,
-29114,
-31067,
-33029,
-34965,
-36819,
-38567,
-40166,
-41579,
-42799,
-43780,
-44542,
-45063,
-45370,
-45453,
-45324,
-44963,
-44356,
-43492,
-42363,
-40978,
-39380,
-37607,
-35723,
-33781,
-31833,
-29912,
-28069,
-26313,
-24708,
-23272,
-22064,
-21108,
-20429,
-20034,
-19913,
-20048,
-20425,
-21030,
-21867,
-22939,
-24254,
-25797,
-27552,
-29459,
-31458,
-33463,
-35410,
-37225,
-38878,
-40337,
-41604,
-42678,
-43572,
-44273,
-44789,
-45078,
-45142,
-44938,
-44464,
-43718,
-42701,
-41449,
-39991,
-38359,
-36613,
-34767,
-32882,
-30973,
-29091,
-27258,
-25540,
-23951,
-22569,
-21403,
-20498,
-19864,
-19496,
-19394,
-19537,
-19926,
-20548,
-21416,
-22528,
-23886,
-25481,
-27273,
-29222,
-31264,
-33315,
-35321,
-37197,
-38904,
-40401,
-41666,
-42697,
-43496,
-44071,
-44434,
-44587,
-44532,
-44252,
-43737,
-42963,
-41928,
-40634,
-39109,
-37400,
-35558,
-33659,
-31746,
-29881,
-28082,
-26383,
-24799,
-23350,
-22071,
-20993,
-20158,
-19595,
-19326,
-19347,
-19660,
-20247,
-21090,
-22190,
-23523,
-25093,
-26862,
-28804,
-30850,
-32945,
-35003,
-36971,
-38790,
-40436,
-41887,
-43139,
-44184,
-45015,
-45622,
-45982,
-46094,
-45929,
-45514,
-44825,
-43891,
-42717,
-41314,
-39712,
-37940,
-36031,
-34053,
-32050,
-30084,
-28219,
-26470,
-24903,
-23503,
-22325,
-21362,
-20659,
-20233,
-20126,
-20350,
-20940,
-21874,
-23168,
-24767,
-26643,
-28723,
-30926,
-33176,
-35369,
-37436,
-39298,
-40915,
-42267,
-43342,
-44148,
-44687,
-44937,
-44895,
-44514,
-43774,
-42669,
-41203,
-39433,
-37422,
-35253,
-33026,
-30815,
-28699,
-26734,
-24959,
-23419,
-22140,
-21150,
-20484,
-20148,
-20174,
-20556,
-21300,
-22388,
-23804,
-25504,
-27446,
-29564,
-31780,
-34022,
-36192,
-38227,
-40051,
-41625,
-42914,
-43905,
-44590,
-44968,
-45039,
-44801,
-44246,
-43370,
-42179,
-40685,
-38922,
-36934,
-34790,
-32564,
-30329,
-28184,
-26173,
-24387,
-22859,
-21637,
-20748,
-20210,
-20032,
-20216,
-20757,
-21639,
-22855,
-24368,
-26163,
-28172,
-30348,
-32595,
-34828,
-36953,
-38882,
-40569,
-41968,
-43098,
-43944,
-44542,
-44864,
-44907,
-44622,
-43979,
-42951,
-41556,
-39840,
-37878,
-35769,
-33604,
-31451,
-29379,
-27410,
-25583,
-23936,
-22510,
-21369,
-20558,
-20117,
-20067,
-20395,
-21080,
-22090,
-23393,
-24970,
-26795,
-28831,
-31027,
-33297,
-35548,
-37661,
-39556,
-41153,
-42434,
-43393,
-44062,
-44452,
-44603,
-44475,
-44078,
-43349,
-42289,
-40885,
-39181,
-37219,
-35109,
-32912,
-30750,
-28675,
-26765,
-25054,
-23578,
-22355,
-21409,
-20757,
-20421,
-20424,
-20785,
-21511,
-22604,
-24034,
-25767,
-27736,
-29863,
-32062,
-34245,
-36330,
-38254,
-39968,
-41438,
-42654,
-43594,
-44256,
-44624,
-44679,
-44411,
-43802,
-42853,
-41582,
-40009,
-38202,
-36205,
-34095,
-31939,
-29797,
-27744,
-25833,
-24118,
-22665,
-21496,
-20675,
-20199,
-20092,
-20345,
-20938,
-21860,
-23084,
-24597,
-26356,
-28342,
-30477,
-32699,
-34916,
-37020,
-38944,
-40600,
-41968,
-43025,
-43788,
-44272,
-44487,
-44429,
-44087,
-43429,
-42440,
-41115,
-39478,
-37579,
-35491,
-33308,
-31110,
-28990,
-27005,
-25215,
-23655,
-22347,
-21327,
-20596,
-20195,
-20129,
-20425,
-21086,
-22123,
-23501,
-25203,
-27143,
-29268,
-31465,
-33665,
-35769,
-37723,
-39472,
-40994,
-42267,
-43285,
-44031,
-44499,
-44656,
-44501,
-43998,
-43165,
-41998,
-40519,
-38787,
-36822,
-34722,
-32528,
-30335,
-28206,
-26226,
-24445,
-22935,
-21712,
-20825,
-20262,
-20056,
-20178,
-20654,
-21455,
-22598,
-24046,
-25784,
-27753,
-29891,
-32111,
-34320,
-36429,
-38355,
-40054,
-41482,
-42644,
-43538,
-44171,
-44540,
-44621,
-44385,
-43794,
-42834,
-41498,
-39830,
-37888,
-35766,
-33549,
-31339,
-29194,
-27181,
-25337,
-23692,
-22286,
-21146,
-20306,
-19808,
-19658,
-19889,
-20487,
-21451,
-22759,
-24382,
-26265,
-28365,
-30583,
-32851,
-35068,
-37147,
-39034,
-40665,
-42028,
-43118,
-43923,
-44456,
-44702,
-44644,
-44265,
-43550,
-42486,
-41090,
-39395,
-37444,
-35315,
-33085,
-30838,
-28659,
-26630,
-24805,
-23240,
-21962,
-20987,
-20329,
-19994,
-19993,
-20335,
-21040,
-22102,
-23523,
-25265,
-27275,
-29480,
-31782,
-34081,
-36288,
-38308,
-40100,
-41609,
-42840,
-43776,
-44437,
-44813,
-44911,
-44697,
-44176,
-43306,
-42118,
-40603,
-38830,
-36844,
-34734,
-32577,
-30439,
-28405,
-26508,
-24821,
-23369,
-22210,
-21360,
-20869,
-20728,
-20960,
-21547,
-22472,
-23716,
-25241,
-27020,
-28996,
-31118,
-33306,
-35484,
-37561,
-39468,
-41134,
-42539,
-43644,
-44473,
-45007,
-45269,
-45239,
-44909,
-44257,
-43274,
-41952,
-40334,
-38446,
-36389,
-34218,
-32047,
-29938,
-27959,
-26167,
-24577,
-23233,
-22147,
-21354,
-20887,
-20779,
-21055,
-21723,
-22772,
-24164,
-25847,
-27743,
-29785,
-31896,
-34005,
-36057,
-37987,
-39755,
-41311,
-42630,
-43670,
-44429,
-44880,
-45031,
-44860,
-44373,
-43553,
-42412,
-40948,
-39217,
-37238,
-35116,
-32907,
-30715,
-28615,
-26673,
-24938,
-23456,
-22231,
-21309,
-20681,
-20389,
-20444,
-20855,
-21645,
-22784,
-24264,
-26016,
-27993,
-30095,
-32265,
-34396,
-36444,
-38325,
-40014,
-41462,
-42653,
-43565,
-44189,
-44504,
-44520,
-44205,
-43576,
-42619,
-41346,
-39772,
-37929,
-35866,
-33656,
-31375,
-29123,
-26972,
-25021,
-23305,
-21880,
-20759,
-19957,
-19484,
-19356,
-19577,
-20180,
-21152,
-22499,
-24171,
-26124,
-28260,
-30513,
-32762,
-34956,
-37007,
-38882,
-40548,
-41970,
-43142,
-44031,
-44616,
-44881,
-44800,
-44374,
-43611,
-42530,
-41162,
-39554,
-37737,
-35775,
-33715,
-31617,
-29557,
-27599,
-25819,
-24272,
-23012,
-22050,
-21411,
-21082,
-21063,
-21364,
-21978,
-22929,
-24217,
-25817,
-27706,
-29798,
-32006,
-34233,
-36365,
-38336,
-40074,
-41561,
-42777,
-43724,
-44409,
-44810,
-44933,
-44737,
-44216,
-43347,
-42150,
-40629,
-38850,
-36857,
-34731,
-32550,
-30380,
-28304,
-26368,
-24636,
-23136,
-21914,
-20991,
-20387,
-20127,
-20208,
-20657,
-21460,
-22621,
-24116,
-25909,
-27944,
-30144,
-32413,
-34654,
-36773,
-38700,
-40379,
-41795,
-42937,
-43813,
-44426,
-44765,
-44815,
-44542,
-43939,
-42976,
-41688,
-40089,
-38230,
-36184,
-33994,
-31756,
-29521,
-27379,
-25392,
-23642,
-22173,
-21051,
-20277,
-19879,
-19834,
-20143,
-20788,
-21767,
-23062,
-24667,
-26532,
-28616,
-30824,
-33087,
-35288,
-37371,
-39243,
-40886,
-42253,
-43341,
-44138,
-44626,
-44806,
-44654,
-44168,
-43349,
-42202,
-40761,
-39051,
-37132,
-35046,
-32873,
-30669,
-28517,
-26482,
-24640,
-23037,
-21743,
-20765,
-20148,
-19886,
-19980,
-20431,
-21213,
-22319,
-23730,
-25402,
-27312,
-29382,
-31558,
-33755,
-35888,
-37888,
-39683,
-41235,
-42512,
-43498,
-44193,
-44581,
-44667,
-44423,
-43856,
-42942,
-41701,
-40155,
-38336,
-36327,
-34174,
-31981,
-29815,
-27753,
-25869,
-24198,
-22799,
-21677,
-20864,
-20355,
-20173,
-20316,
-20806,
-21645,
-22835,
-24361,
-26181,
-28237,
-30441,
-32698,
-34919,
-37005,
-38906,
-40568,
-41964,
-43098,
-43941,
-44510,
-44776,
-44732,
-44357,
-43645,
-42596,
-41228,
-39584,
-37707,
-35677,
-33549,
-31419,
-29325,
-27370,
-25562,
-23986,
-22650,
-21599,
-20860,
-20440,
-20377,
-20655,
-21304,
-22296,
-23634,
-25270,
-27172,
-29259,
-31464,
-33691,
-35845,
-37856,
-39639,
-41176,
-42428,
-43411,
-44118,
-44560,
-44724,
-44592,
-44138,
-43336,
-42186,
-40706,
-38936,
-36965,
-34850,
-32706,
-30576,
-28550,
-26651,
-24941,
-23441,
-22193,
-21239,
-20607,
-20327,
-20414,
-20868,
-21684,
-22844,
-24316,
-26074,
-28055,
-30204,
-32436,
-34655,
-36780,
-38723,
-40423,
-41859,
-43002,
-43874,
-44471,
-44795,
-44836,
-44571,
-43978,
-43045,
-41779,
-40205,
-38376,
-36357,
-34222,
-32052,
-29919,
-27892,
-26041,
-24403,
-23034,
-21955,
-21176,
-20720,
-20573,
-20755,
-21275,
-22134,
-23352,
-24908,
-26770,
-28873,
-31123,
-33410,
-35633,
-37690,
-39525,
-41101,
-42401,
-43446,
-44216,
-44732,
-44951,
-44852,
-44400,
-43560,
-42328,
-40720,
-38775,
-36585,
-34224,
-31826,
-29471,
-27288,
-25335,
-23697,
-22407,
-21503,
-21011,
-20942,
-21320,
-22143,
-23404,
-25068,
-27067,
-29307,
-31674,
-34047,
-36307,
-38370,
-40167,
-41664,
-42837,
-43676,
-44153,
-44260,
-43941,
-43207,
-42025,
-40454,
-38531,
-36359,
-34040,
-31677,
-29377,
-27220,
-25268,
-23598,
-22236,
-21266,
-20703,
-20617,
-21016,
-21904,
-23252,
-24997,
-27045,
-29306,
-31651,
-33996,
-36236,
-38307,
-40149,
-41707,
-42961,
-43861,
-44383,
-44503,
-44179,
-43433,
-42244,
-40668,
-38752,
-36581,
-34257,
-31882,
-29566,
-27399,
-25465,
-23824,
-22523,
-21607,
-21092,
-21014,
-21376,
-22186,
-23428,
-25050,
-27011,
-29195,
-31530,
-33887,
-36168,
-38283,
-40148,
-41719,
-42950,
-43825,
-44319,
-44431,
-44137,
-43439,
-42331,
-40825,
-38975,
-36829,
-34502,
-32093,
-29729,
-27528,
-25578,
-23960,
-22703,
-21848,
-21388,
-21344,
-21722,
-22521,
-23750,
-25375,
-27341,
-29567,
-31925,
-34300,
-36560,
-38619,
-40391,
-41864,
-43015,
-43846,
-44361,
-44528,
-44320,
-43703,
-42644,
-41152,
-39278,
-37091,
-34730,
-32302,
-29956,
-27778,
-25853,
-24230,
-22927,
-21984,
-21410,
-21247,
-21526,
-22265,
-23466,
-25094,
-27070,
-29293,
-31641,
-33978,
-36216,
-38247,
-40041,
-41543,
-42753,
-43633,
-44169,
-44321,
-44055,
-43343,
-42193,
-40617,
-38701,
-36513,
-34189,
-31824,
-29538,
-27410,
-25510,
-23882,
-22565,
-21586,
-20979,
-20778,
-21012,
-21701,
-22846,
-24409,
-26337,
-28524,
-30868,
-33231,
-35514,
-37593,
-39431,
-40937,
-42135,
-42967,
-43459,
-43583,
-43312,
-42657,
-41565,
-40085,
-38224,
-36071,
-33719,
-31288,
-28910,
-26689,
-24737,
-23093,
-21815,
-20901,
-20369,
-20221,
-20475,
-21136,
-22225,
-23719,
-25587,
-27741,
-30086,
-32483,
-34815,
-36962,
-38852,
-40421,
-41664,
-42556,
-43106,
-43301,
-43112,
-42528,
-41517,
-40107,
-38314,
-36234,
-33945,
-31590,
-29262,
-27090,
-25132,
-23470,
-22131,
-21155,
-20576,
-20411,
-20706,
-21452,
-22668,
-24300,
-26294,
-28548,
-30944,
-33372,
-35702,
-37868,
-39770,
-41402,
-42704,
-43677,
-44289,
-44515,
-44325,
-43699,
-42621,
-41127,
-39253,
-37099,
-34761,
-32354,
-29996,
-27770,
-25764,
-24028,
-22614,
-21558,
-20905,
-20684,
-20930,
-21645,
-22827,
-24416,
-26352,
-28528,
-30830,
-33162,
-35397,
-37482,
-39327,
-40912,
-42189,
-43144,
-43749,
-43976,
-43803,
-43211,
-42184,
-40757,
-38953,
-36858,
-34561,
-32171,
-29809,
-27570,
-25553,
-23816,
-22412,
-21381,
-20735,
-20524,
-20740,
-21418,
-22540,
-24087,
-25996,
-28186,
-30536,
-32943,
-35272,
-37442,
-39365,
-40995,
-42302,
-43268,
-43869,
-44099,
-43921,
-43331,
-42314,
-40891,
-39102,
-37017,
-34734,
-32354,
-29990,
-27741,
-25696,
-23919,
-22471,
-21393,
-20714,
-20477,
-20688,
-21370,
-22498,
-24054,
-25954,
-28128,
-30461,
-32834,
-35153,
-37310,
-39244,
-40901,
-42251,
-43262,
-43923,
-44187,
-44042,
-43456,
-42417,
-40967,
-39130,
-37023,
-34725,
-32373,
-30057,
-27876,
-25894,
-24158,
-22717,
-21602,
-20860,
-20546,
-20694,
-21338,
-22480,
-24068,
-26044,
-28287,
-30673,
-33092,
-35409,
-37565,
-39476,
-41107,
-42443,
-43436,
-44087,
-44356,
-44206,
-43642,
-42629,
-41211,
-39418,
-37341,
-35064,
-32712,
-30382,
-28186,
-26199,
-24486,
-23091,
-22044,
-21376,
-21107,
-21258,
-21853,
-22883,
-24336,
-26149,
-28262,
-30547,
-32926,
-35246,
-37448,
-39416,
-41118,
-42494,
-43519,
-44171,
-44419,
-44254,
-43664,
-42656,
-41264,
-39526,
-37525,
-35333,
-33043,
-30750,
-28535,
-26485,
-24676,
-23174,
-22040,
-21326,
-21058,
-21266,
-21940,
-23054,
-24571,
-26415,
-28516,
-30767,
-33081,
-35340,
-37479,
-39401,
-41068,
-42431,
-43463,
-44146,
-44449,
-44351,
-43822,
-42863,
-41472,
-39714,
-37651,
-35400,
-33065,
-30763,
-28585,
-26602,
-24869,
-23425,
-22302,
-21569,
-21233,
-21379,
-21986,
-23074,
-24587,
-26450,
-28567,
-30833,
-33137,
-35397,
-37529,
-39464,
-41154,
-42543,
-43589,
-44261,
-44527,
-44376,
-43815,
-42845,
-41504,
-39827,
-37874,
-35715,
-33436,
-31135,
-28905,
-26849,
-25031,
-23532,
-22387,
-21641,
-21316,
-21431,
-21999,
-23013,
-24449,
-26249,
-28348,
-30623,
-32993,
-35308,
-37498,
-39457,
-41137,
-42501,
-43511,
-44182,
-44458,
-44374,
-43873,
-42980,
-41678,
-40011,
-38016,
-35795,
-33429,
-31055,
-28758,
-26672,
-24834,
-23346,
-22205,
-21470,
-21143,
-21253,
-21806,
-22799,
-24214,
-25990,
-28068,
-30326,
-32680,
-35000,
-37208,
-39208,
-40946,
-42372,
-43452,
-44156,
-44471,
-44365,
-43850,
-42909,
-41577,
-39881,
-37883,
-35663,
-33310,
-30932,
-28629,
-26500,
-24624,
-23060,
-21858,
-21047,
-20658,
-20713,
-21229,
-22215,
-23645,
-25480,
-27627,
-29987,
-32422,
-34822,
-37063,
-39080,
-40808,
-42222,
-43299,
-44022,
-44368,
-44299,
-43811,
-42874,
-41521,
-39788,
-37750,
-35498,
-33142,
-30773,
-28494,
-26381,
-24501,
-22919,
-21685,
-20847,
-20453,
-20527,
-21091,
-22130,
-23605,
-25458,
-27589,
-29907,
-32288,
-34640,
-36867,
-38889,
-40661,
-42122,
-43251,
-44005,
-44362,
-44296,
-43802,
-42872,
-41544,
-39846,
-37865,
-35662,
-33355,
-31016,
-28759,
-26649,
-24777,
-23197,
-21972,
-21138,
-20746,
-20804,
-21337,
-22323,
-23733,
-25516,
-27589,
-29861,
-32227,
-34577,
-36822,
-38860,
-40641,
-42094,
-43201,
-43935,
-44275,
-44224,
-43763,
-42900,
-41656,
-40044,
-38138,
-36003,
-33736,
-31447,
-29230,
-27181,
-25375,
-23858,
-22677,
-21854,
-21420,
-21401,
-21824,
-22693,
-24017,
-25731,
-27787,
-30058,
-32429,
-34778,
-36977,
-38956,
-40650,
-42027,
-43083,
-43799,
-44166,
-44163,
-43763,
-42952,
-41726,
-40116,
-38178,
-35997,
-33683,
-31340,
-29076,
-26993,
-25150,
-23618,
-22428,
-21608,
-21189,
-21177,
-21598,
-22443,
-23717,
-25376,
-27374,
-29612,
-31989,
-34374,
-36640,
-38688,
-40426,
-41828,
-42872,
-43571,
-43929,
-43949,
-43599,
-42863,
-41703,
-40134,
-38189,
-35960,
-33564,
-31141,
-28810,
-26683,
-24816,
-23255,
-22025,
-21149,
-20662,
-20608,
-21017,
-21903,
-23250,
-24990,
-27034,
-29272,
-31577,
-33868,
-36036,
-38040,
-39815,
-41314,
-42504,
-43328,
-43759,
-43773,
-43351,
-42509,
-41270,
-39662,
-37754,
-35595,
-33280,
-30893,
-28541,
-26317,
-24326,
-22639,
-21315,
-20404,
-19916,
-19885,
-20298,
-21175,
-22482,
-24201,
-26260,
-28575,
-31034,
-33510,
-35888,
-38053,
-39933,
-41473,
-42649,
-43455,
-43888,
-43943,
-43606,
-42875,
-41727,
-40201,
-38319,
-36179,
-33877,
-31537,
-29283,
-27214,
-25410,
-23919,
-22766,
-21973,
-21551,
-21531,
-21938,
-22786,
-24091,
-25805,
-27876,
-30191,
-32625,
-35048,
-37322,
-39358,
-41064,
-42406,
-43339,
-43853,
-43928,
-43551,
-42722,
-41436,
-39737,
-37678,
-35353,
-32882,
-30391,
-28019,
-25879,
-24087,
-22715,
-21840,
-21497,
-21723,
-22520,
-23855,
-25673,
-27864,
-30301,
-32830,
-35305,
-37598,
-39603,
-41260,
-42520,
-43357,
-43755,
-43681,
-43126,
-42082,
-40569,
-38644,
-36393,
-33931,
-31402,
-28928,
-26651,
-24672,
-23087,
-21969,
-21374,
-21327,
-21858,
-22932,
-24515,
-26520,
-28837,
-31328,
-33857,
-36280,
-38482,
-40370,
-41878,
-42959,
-43598,
-43764,
-43460,
-42667,
-41399,
-39690,
-37593,
-35215,
-32675,
-30118,
-27688,
-25517,
-23714,
-22361,
-21525,
-21230,
-21509,
-22346,
-23712,
-25539,
-27714,
-30120,
-32601,
-35029,
-37282,
-39272,
-40938,
-42240,
-43130,
-43590,
-43557,
-43021,
-41951,
-40392,
-38394,
-36080,
-33578,
-31042,
-28612,
-26413,
-24532,
-23050,
-22010,
-21457,
-21426,
-21929,
-22983,
-24544,
-26551,
-28892,
-31419,
-33971,
-36390,
-38548,
-40348,
-41754,
-42732,
-43295,
-43426,
-43115,
-42338,
-41076,
-39346,
-37203,
-34761,
-32170,
-29603,
-27215,
-25144,
-23476,
-22263,
-21536,
-21307,
-21598,
-22411,
-23745,
-25545,
-27740,
-30186,
-32746,
-35248,
-37562,
-39581,
-41228,
-42470,
-43272,
-43615,
-43480,
-42854,
-41732,
-40169,
-38197,
-35955,
-33522,
-31059,
-28671,
-26491,
-24608,
-23119,
-22083,
-21566,
-21590,
-22174,
-23284,
-24877,
-26860,
-29128,
-31556,
-34016,
-36382,
-38554,
-40429,
-41941,
-43023,
-43636,
-43734,
-43311,
-42356,
-40915,
-39041,
-36850,
-34445,
-31984,
-29576,
-27356,
-25396,
-23784,
-22568,
-21794,
-21519,
-21762,
-22549,
-23860,
-25630,
-27768,
-30140,
-32603,
-35022,
-37279,
-39279,
-40955,
-42246,
-43111,
-43501,
-43387,
-42749,
-41596,
-39987,
-37990,
-35735,
-33324,
-30910,
-28586,
-26473,
-24645,
-23179,
-22142,
-21590,
-21564,
-22104,
-23187,
-24790,
-26818,
-29149,
-31644,
-34148,
-36517,
-38650,
-40450,
-41872,
-42882,
-43441,
-43545,
-43141,
-42251,
-40857,
-39036,
-36865,
-34472,
-32005,
-29596,
-27379,
-25444,
-23857,
-22675,
-21927,
-21665,
-21917,
-22703,
-24019,
-25813,
-27991,
-30425,
-32956,
-35425,
-37703,
-39672,
-41270,
-42449,
-43189,
-43477,
-43306,
-42656,
-41545,
-39969,
-38008,
-35715,
-33229,
-30673,
-28204,
-25959,
-24069,
-22610,
-21675,
-21267,
-21425,
-22126,
-23330,
-24992,
-27015,
-29296,
-31714,
-34130,
-36438,
-38515,
-40303,
-41721,
-42739,
-43312,
-43408,
-42996,
-42075,
-40649,
-38782,
-36554,
-34097,
-31537,
-29033,
-26699,
-24659,
-22998,
-21784,
-21070,
-20892,
-21267,
-22190,
-23618,
-25494,
-27696,
-30131,
-32633,
-35099,
-37384,
-39409,
-41081,
-42351,
-43175,
-43514,
-43355,
-42679,
-41508,
-39870,
-37844,
-35527,
-33049,
-30544,
-28152,
-25980,
-24136,
-22667,
-21658,
-21120,
-21134,
-21690,
-22827,
-24482,
-26597,
-29021,
-31611,
-34177,
-36579,
-38698,
-40457,
-41833,
-42795,
-43339,
-43436,
-43052,
-42174,
-40792,
-38969,
-36776,
-34361,
-31850,
-29407,
-27137,
-25158,
-23530,
-22331,
-21594,
-21389,
-21721,
-22623,
-24050,
-25936,
-28177,
-30624,
-33142,
-35577,
-37829,
-39782,
-41402,
-42614,
-43409,
-43737,
-43590,
-42939,
-41795,
-40191,
-38192,
-35913,
-33479,
-31036,
-28723,
-26652,
-24918,
-23578,
-22687,
-22255,
-22337,
-22919,
-24023,
-25602,
-27598,
-29893,
-32362,
-34849,
-37215,
-39346,
-41144,
-42556,
-43524,
-44035,
-44043,
-43549,
-42553,
-41078,
-39208,
-37026,
-34659,
-32239,
-29877,
-27698,
-25770,
-24185,
-22991,
-22260,
-22026,
-22345,
-23205,
-24609,
-26471,
-28696,
-31153,
-33666,
-36127,
-38357,
-40311,
-41870,
-43033,
-43739,
-43989,
-43746,
-43005,
-41766,
-40061,
-37972,
-35599,
-33099,
-30609,
-28277,
-26217,
-24497,
-23188,
-22305,
-21896,
-21985,
-22589,
-23727,
-25344,
-27381,
-29704,
-32176,
-34633,
-36962,
-39033,
-40801,
-42196,
-43182,
-43723,
-43765,
-43277,
-42252,
-40707,
-38738,
-36439,
-33972,
-31465,
-29057,
-26850,
-24924,
-23343,
-22171,
-21462,
-21269,
-21648,
-22585,
-24080,
-26023,
-28304,
-30768,
-33243,
-35602,
-37727,
-39548,
-41033,
-42150,
-42882,
-43194,
-43035,
-42364,
-41162,
-39445,
-37296,
-34843,
-32245,
-29691,
-27322,
-25273,
-23608,
-22378,
-21603,
-21306,
-21506,
-22228,
-23457,
-25180,
-27286,
-29682,
-32190,
-34680,
-36997,
-39059,
-40784,
-42150,
-43109,
-43648,
-43727,
-43311,
-42399,
-40993,
-39161,
-36990,
-34617,
-32156,
-29775,
-27557,
-25632,
-24063,
-22925,
-22263,
-22127,
-22531,
-23476,
-24931,
-26815,
-29038,
-31454,
-33943,
-36340,
-38561,
-40468,
-42025,
-43149,
-43829,
-44016,
-43709,
-42889,
-41585,
-39843,
-37732,
-35373,
-32878,
-30386,
-28019,
-25878,
-24069,
-22656,
-21719,
-21312,
-21471,
-22226,
-23537,
-25354,
-27547,
-29995,
-32519,
-34992,
-37271,
-39272,
-40935,
-42212,
-43087,
-43525,
-43510,
-43021,
-42057,
-40625,
-38786,
-36596,
-34181,
-31646,
-29141,
-26783,
-24714,
-23023,
-21818,
-21144,
-21052,
-21547,
-22601,
-24170,
-26154,
-28450,
-30923,
-33434,
-35858,
-38077,
-39995,
-41555,
-42687,
-43373,
-43560,
-43253,
-42427,
-41122,
-39377,
-37281,
-34939,
-32473,
-30005,
-27657,
-25525,
-23709,
-22280,
-21329,
-20901,
-21065,
-21816,
-23150,
-24972,
-27191,
-29640,
-32180,
-34654,
-36939,
-38947,
-40612,
-41894,
-42768,
-43202,
-43183,
-42685,
-41706,
-40260,
-38394,
-36190,
-33764,
-31243,
-28778,
-26495,
-24521,
-22944,
-21832,
-21232,
-21169,
-21648,
-22659,
-24157,
-26077,
-28318,
-30750,
-33244,
-35661,
-37884,
-39827,
-41404,
-42572,
-43278,
-43489,
-43167,
-42323,
-40960,
-39163,
-37021,
-34668,
-32238,
-29858,
-27633,
-25649,
-23965,
-22646,
-21749,
-21332,
-21461,
-22152,
-23403,
-25155,
-27300,
-29702,
-32208,
-34668,
-36963,
-39007,
-40723,
-42085,
-43033,
-43541,
-43559,
-43055,
-42016,
-40467,
-38478,
-36162,
-33667,
-31146,
-28753,
-26589,
-24763,
-23304,
-22262,
-21678,
-21566,
-21999,
-22962,
-24466,
-26433,
-28745,
-31250,
-33773,
-36153,
-38297,
-40102,
-41568,
-42651,
-43345,
-43600,
-43377,
-42616,
-41337,
-39554,
-37396,
-34980,
-32488,
-30045,
-27799,
-25806,
-24146,
-22857,
-21993,
-21615,
-21773,
-22510,
-23806,
-25617,
-27813,
-30255,
-32782,
-35233,
-37497,
-39478,
-41128,
-42404,
-43277,
-43708,
-43663,
-43113,
-42049,
-40503,
-38534,
-36257,
-33800,
-31306,
-28917,
-26744,
-24883,
-23401,
-22349,
-21774,
-21712,
-22187,
-23199,
-24730,
-26686,
-28984,
-31452,
-33972,
-36372,
-38568,
-40437,
-41955,
-43039,
-43686,
-43838,
-43489,
-42624,
-41277,
-39506,
-37409,
-35099,
-32698,
-30323,
-28069,
-26028,
-24276,
-22902,
-21975,
-21591,
-21786,
-22605,
-24007,
-25932,
-28253,
-30825,
-33484,
-36064,
-38420,
-40426,
-41968,
-42984,
-43399,
-43220,
-42427,
-41096,
-39277,
-37095,
-34662,
-32113,
-29601,
-27249,
-25217,
-23615,
-22563,
-22140,
-22383,
-23292,
-24796,
-26798,
-29148,
-31684,
-34248,
-36679,
-38858,
-40665,
-42028,
-42874,
-43159,
-42860,
-41973,
-40531,
-38603,
-36293,
-33725,
-31075,
-28490,
-26147,
-24204,
-22771,
-21966,
-21827,
-22369,
-23562,
-25302,
-27487,
-29958,
-32553,
-35130,
-37516,
-39620,
-41307,
-42517,
-43174,
-43236,
-42688,
-41545,
-39848,
-37704,
-35212,
-32564,
-29890,
-27404,
-25234,
-23533,
-22397,
-21891,
-22041,
-22839,
-24222,
-26116,
-28392,
-30926,
-33549,
-36118,
-38469,
-40471,
-42011,
-42998,
-43388,
-43155,
-42322,
-40926,
-39056,
-36800,
-34296,
-31680,
-29114,
-26754,
-24756,
-23249,
-22328,
-22056,
-22435,
-23440,
-24999,
-27011,
-29356,
-31900,
-34487,
-36989,
-39225,
-41094,
-42454,
-43246,
-43411,
-42963,
-41917,
-40365,
-38369,
-36052,
-33538,
-30949,
-28461,
-26210,
-24359,
-23039,
-22345,
-22323,
-22981,
-24251,
-26060,
-28264,
-30744,
-33335,
-35896,
-38274,
-40332,
-41954,
-43043,
-43549,
-43442,
-42752,
-41508,
-39805,
-37708,
-35351,
-32826,
-30293,
-27884,
-25764,
-24079,
-22958,
-22478,
-22694,
-23560,
-25030,
-26966,
-29246,
-31705,
-34207,
-36611,
-38794,
-40657,
-42090,
-43037,
-43413,
-43207,
-42389,
-41009,
-39128,
-36855,
-34336,
-31722,
-29189,
-26885,
-24965,
-23524,
-22662,
-22408,
-22780,
-23753,
-25259,
-27214,
-29487,
-31953,
-34441,
-36830,
-38952,
-40712,
-41995,
-42738,
-42890,
-42436,
-41387,
-39795,
-37742,
-35350,
-32768,
-30153,
-27686,
-25505,
-23756,
-22532,
-21901,
-21900,
-22523,
-23730,
-25460,
-27594,
-30010,
-32543,
-35044,
-37342,
-39318,
-40854,
-41877,
-42349,
-42235,
-41557,
-40323,
-38601,
-36461,
-34024,
-31421,
-28827,
-26390,
-24286,
-22636,
-21543,
-21075,
-21248,
-22058,
-23454,
-25353,
-27649,
-30187,
-32817,
-35358,
-37648,
-39559,
-40972,
-41841,
-42124,
-41840,
-41003,
-39666,
-37882,
-35741,
-33339,
-30822,
-28333,
-26048,
-24117,
-22685,
-21843,
-21658,
-22131,
-23236,
-24901,
-27030,
-29490,
-32136,
-34807,
-37329,
-39559,
-41344,
-42605,
-43264,
-43311,
-42755,
-41638,
-40027,
-37998,
-35660,
-33128,
-30544,
-28067,
-25848,
-24047,
-22783,
-22151,
-22184,
-22886,
-24189,
-26012,
-28222,
-30685,
-33236,
-35731,
-38016,
-39969,
-41472,
-42461,
-42869,
-42690,
-41933,
-40629,
-38856,
-36690,
-34251,
-31672,
-29097,
-26694,
-24603,
-22991,
-21942,
-21564,
-21851,
-22816,
-24353,
-26387,
-28749,
-31309,
-33901,
-36366,
-38586,
-40424,
-41799,
-42628,
-42870,
-42501,
-41537,
-40030,
-38042,
-35712,
-33149,
-30533,
-28011,
-25748,
-23889,
-22553,
-21822,
-21748,
-22323,
-23512,
-25231,
-27357,
-29770,
-32306,
-34837,
-37210,
-39302,
-41008,
-42219,
-42877,
-42919,
-42331,
-41148,
-39416,
-37261,
-34801,
-32205,
-29629,
-27229,
-25144,
-23486,
-22352,
-21802,
-21889,
-22601,
-23939,
-25795,
-28097,
-30661,
-33346,
-35951,
-38323,
-40307,
-41804,
-42728,
-43061,
-42774,
-41912,
-40507,
-38635,
-36403,
-33916,
-31335,
-28798,
-26473,
-24498,
-23004,
-22084,
-21799,
-22169,
-23173,
-24755,
-26806,
-29220,
-31814,
-34464,
-36967,
-39208,
-41027,
-42348,
-43088,
-43226,
-42762,
-41713,
-40155,
-38140,
-35804,
-33235,
-30622,
-28081,
-25818,
-23956,
-22649,
-21974,
-21992,
-22679,
-23997,
-25826,
-28054,
-30517,
-33082,
-35588,
-37905,
-39912,
-41503,
-42595,
-43135,
-43076,
-42437,
-41230,
-39531,
-37426,
-35036,
-32498,
-29958,
-27577,
-25495,
-23860,
-22767,
-22302,
-22495,
-23327,
-24750,
-26653,
-28922,
-31406,
-33956,
-36422,
-38673,
-40577,
-42050,
-42997,
-43378,
-43158,
-42346,
-40973,
-39110,
-36854,
-34332,
-31703,
-29129,
-26782,
-24822,
-23383,
-22557,
-22402,
-22905,
-24027,
-25681,
-27743,
-30095,
-32574,
-35063,
-37411,
-39502,
-41227,
-42488,
-43216,
-43362,
-42902,
-41858,
-40266,
-38232,
-35853,
-33299,
-30706,
-28262,
-26108,
-24383,
-23192,
-22598,
-22636,
-23301,
-24545,
-26307,
-28466,
-30915,
-33477,
-36021,
-38361,
-40380,
-41937,
-42969,
-43413,
-43260,
-42535,
-41264,
-39528,
-37400,
-35003,
-32457,
-29928,
-27564,
-25526,
-23950,
-22936,
-22544,
-22802,
-23667,
-25105,
-26999,
-29263,
-31746,
-34311,
-36805,
-39070,
-40969,
-42387,
-43230,
-43469,
-43081,
-42115,
-40616,
-38675,
-36398,
-33897,
-31321,
-28806,
-26513,
-24587,
-23168,
-22341,
-22189,
-22696,
-23852,
-25552,
-27695,
-30127,
-32698,
-35249,
-37624,
-39699,
-41352,
-42509,
-43107,
-43127,
-42573,
-41471,
-39877,
-37867,
-35533,
-33001,
-30409,
-27906,
-25669,
-23828,
-22546,
-21895,
-21942,
-22678,
-24040,
-25940,
-28227,
-30760,
-33364,
-35898,
-38211,
-40182,
-41713,
-42716,
-43145,
-42961,
-42185,
-40826,
-38989,
-36743,
-34240,
-31624,
-29041,
-26672,
-24635,
-23085,
-22098,
-21746,
-22056,
-22994,
-24524,
-26525,
-28892,
-31461,
-34086,
-36602,
-38865,
-40744,
-42137,
-42963,
-43178,
-42774,
-41764,
-40211,
-38204,
-35844,
-33291,
-30672,
-28157,
-25896,
-24015,
-22645,
-21860,
-21714,
-22229,
-23365,
-25065,
-27225,
-29698,
-32347,
-34978,
-37444,
-39588,
-41278,
-42438,
-43002,
-42961,
-42331,
-41152,
-39483,
-37420,
-35044,
-32504,
-29915,
-27447,
-25266,
-23503,
-22325,
-21781,
-21948,
-22783,
-24243,
-26199,
-28535,
-31075,
-33688,
-36199,
-38501,
-40440,
-41945,
-42905,
-43294,
-43058,
-42227,
-40833,
-38947,
-36698,
-34188,
-31598,
-29060,
-26741,
-24784,
-23298,
-22407,
-22134,
-22544,
-23581,
-25205,
-27303,
-29724,
-32325,
-34905,
-37330,
-39435,
-41132,
-42334,
-43014,
-43138,
-42725,
-41760,
-40294,
-38360,
-36058,
-33502,
-30861,
-28313,
-26053,
-24237,
-23006,
-22409,
-22493,
-23197,
-24479,
-26229,
-28353,
-30716,
-33204,
-35666,
-37970,
-39984,
-41583,
-42676,
-43202,
-43119,
-42446,
-41198,
-39457,
-37294,
-34852,
-32252,
-29674,
-27276,
-25217,
-23635,
-22627,
-22243,
-22504,
-23366,
-24775,
-26637,
-28840,
-31262,
-33759,
-36189,
-38413,
-40296,
-41733,
-42639,
-42956,
-42676,
-41796,
-40372,
-38467,
-36192,
-33665,
-31057,
-28510,
-26212,
-24291,
-22890,
-22071,
-21897,
-22344,
-23396,
-24962,
-26968,
-29271,
-31762,
-34270,
-36665,
-38793,
-40529,
-41779,
-42468,
-42568,
-42068,
-41000,
-39403,
-37366,
-34974,
-32369,
-29693,
-27118,
-24819,
-22943,
-21635,
-20973,
-20994,
-21706,
-23022,
-24895,
-27166,
-29723,
-32402,
-35034,
-37481,
-39578,
-41210,
-42299,
-42772,
-42651,
-41926,
-40669,
-38938,
-36823,
-34433,
-31895,
-29345,
-26967,
-24903,
-23332,
-22373,
-22108,
-22571,
-23726,
-25491,
-27743,
-30326,
-33059,
-35775,
-38278,
-40412,
-42026,
-43000,
-43269,
-42802,
-41637,
-39853,
-37577,
-34979,
-32231,
-29542,
-27096,
-25082,
-23646,
-22907,
-22920,
-23685,
-25145,
-27169,
-29605,
-32261,
-34942,
-37467,
-39665,
-41392,
-42539,
-43020,
-42789,
-41850,
-40256,
-38107,
-35574,
-32829,
-30094,
-27576,
-25446,
-23880,
-22952,
-22760,
-23286,
-24513,
-26346,
-28644,
-31248,
-33944,
-36539,
-38841,
-40690,
-41985,
-42637,
-42633,
-41959,
-40642,
-38754,
-36379,
-33680,
-30843,
-28092,
-25678,
-23800,
-22633,
-22257,
-22677,
-23834,
-25601,
-27828,
-30351,
-33000,
-35612,
-38018,
-40065,
-41601,
-42516,
-42733,
-42224,
-41033,
-39237,
-36977,
-34398,
-31688,
-29020,
-26591,
-24573,
-23137,
-22400,
-22453,
-23284,
-24850,
-26990,
-29540,
-32267,
-34966,
-37439,
-39538,
-41135,
-42169,
-42558,
-42310,
-41392,
-39867,
-37783,
-35286,
-32524,
-29728,
-27109,
-24895,
-23284,
-22391,
-22305,
-22995,
-24397,
-26378,
-28770,
-31392,
-34067,
-36601,
-38852,
-40659,
-41911,
-42522,
-42430,
-41653,
-40221,
-38246,
-35857,
-33234,
-30568,
-28049,
-25864,
-24175,
-23100,
-22741,
-23108,
-24200,
-25917,
-28146,
-30695,
-33389,
-36006,
-38373,
-40313,
-41713,
-42474,
-42569,
-41975,
-40748,
-38948,
-36691,
-34131,
-31426,
-28786,
-26403,
-24456,
-23125,
-22495,
-22646,
-23547,
-25139,
-27281,
-29808,
-32516,
-35208,
-37679,
-39771,
-41341,
-42292,
-42572,
-42158,
-41089,
-39426,
-37280,
-34802,
-32147,
-29528,
-27108,
-25097,
-23617,
-22812,
-22720,
-23368,
-24702,
-26615,
-28974,
-31585,
-34258,
-36795,
-39007,
-40750,
-41896,
-42386,
-42183,
-41304,
-39815,
-37800,
-35405,
-32778,
-30118,
-27606,
-25445,
-23787,
-22775,
-22474,
-22917,
-24056,
-25807,
-28041,
-30578,
-33259,
-35866,
-38234,
-40187,
-41585,
-42328,
-42369,
-41691,
-40358,
-38457,
-36122,
-33536,
-30864,
-28321,
-26080,
-24307,
-23149,
-22673,
-22929,
-23892,
-25477,
-27582,
-30032,
-32667,
-35292,
-37735,
-39822,
-41416,
-42393,
-42684,
-42249,
-41118,
-39360,
-37106,
-34523,
-31807,
-29166,
-26791,
-24868,
-23512,
-22841,
-22873,
-23620,
-25013,
-26952,
-29298,
-31873,
-34501,
-36988,
-39173,
-40895,
-42049,
-42547,
-42356,
-41472,
-39941,
-37863,
-35362,
-32641,
-29879,
-27323,
-25158,
-23572,
-22671,
-22522,
-23107,
-24365,
-26179,
-28413,
-30899,
-33482,
-35988,
-38264,
-40164,
-41542,
-42302,
-42364,
-41705,
-40359,
-38410,
-36008,
-33330,
-30592,
-28000,
-25746,
-24000,
-22869,
-22442,
-22730,
-23717,
-25329,
-27447,
-29926,
-32568,
-35202,
-37608,
-39645,
-41154,
-42051,
-42281,
-41826,
-40710,
-38990,
-36765,
-34171,
-31386,
-28629,
-26116,
-24077,
-22678,
-22042,
-22200,
-23119,
-24693,
-26777,
-29214,
-31818,
-34441,
-36906,
-39071,
-40789,
-41930,
-42405,
-42153,
-41187,
-39556,
-37396,
-34856,
-32140,
-29446,
-26972,
-24891,
-23359,
-22479,
-22327,
-22917,
-24216,
-26127,
-28506,
-31174,
-33903,
-36515,
-38776,
-40575,
-41767,
-42317,
-42190,
-41423,
-40045,
-38156,
-35837,
-33246,
-30540,
-27924,
-25609,
-23800,
-22660,
-22306,
-22745,
-23944,
-25765,
-28048,
-30599,
-33233,
-35774,
-38071,
-39996,
-41423,
-42270,
-42457,
-41962,
-40800,
-39048,
-36829,
-34314,
-31692,
-29155,
-26895,
-25064,
-23798,
-23202,
-23313,
-24161,
-25679,
-27772,
-30286,
-33016,
-35751,
-38277,
-40399,
-41987,
-42927,
-43195,
-42772,
-41712,
-40073,
-37963,
-35504,
-32857,
-30199,
-27726,
-25631,
-24086,
-23227,
-23125,
-23795,
-25175,
-27146,
-29551,
-32182,
-34860,
-37377,
-39575,
-41307,
-42470,
-42992,
-42845,
-42027,
-40597,
-38626,
-36261,
-33645,
-30971,
-28436,
-26226,
-24518,
-23446,
-23091,
-23496,
-24615,
-26378,
-28633,
-31217,
-33920,
-36547,
-38894,
-40809,
-42144,
-42834,
-42823,
-42134,
-40824,
-38965,
-36715,
-34180,
-31569,
-29020,
-26738,
-24872,
-23583,
-22972,
-23104,
-23978,
-25526,
-27630,
-30103,
-32759,
-35375,
-37770,
-39780,
-41278,
-42188,
-42450,
-42054,
-41006,
-39362,
-37202,
-34679,
-31948,
-29243,
-26759,
-24715,
-23269,
-22532,
-22548,
-23293,
-24700,
-26647,
-28991,
-31572,
-34203,
-36723,
-38947,
-40720,
-41913,
-42423,
-42213,
-41278,
-39691,
-37545,
-35014,
-32256,
-29494,
-26914,
-24715,
-23067,
-22080,
-21845,
-22373,
-23609,
-25479,
-27809,
-30437,
-33168,
-35792,
-38153,
-40071,
-41443,
-42171,
-42215,
-41563,
-40257,
-38374,
-36053,
-33449,
-30776,
-28238,
-26044,
-24369,
-23343,
-23029,
-23446,
-24536,
-26218,
-28354,
-30819,
-33432,
-36046,
-38471,
-40561,
-42142,
-43116,
-43366,
-42892,
-41693,
-39874,
-37550,
-34907,
-32123,
-29422,
-26977,
-24995,
-23602,
-22919,
-23002,
-23831,
-25359,
-27434,
-29897,
-32543,
-35168,
-37577,
-39619,
-41166,
-42146,
-42508,
-42242,
-41344,
-39866,
-37862,
-35453,
-32788,
-30058,
-27482,
-25274,
-23631,
-22681,
-22514,
-23105,
-24409,
-26285,
-28588,
-31149,
-33782,
-36328,
-38618,
-40502,
-41853,
-42564,
-42568,
-41859,
-40456,
-38476,
-36030,
-33338,
-30563,
-27949,
-25671,
-23909,
-22797,
-22407,
-22778,
-23865,
-25592,
-27817,
-30372,
-33066,
-35694,
-38076,
-40040,
-41460,
-42246,
-42356,
-41785,
-40574,
-38789,
-36546,
-33973,
-31249,
-28557,
-26112,
-24108,
-22731,
-22092,
-22265,
-23210,
-24851,
-27012,
-29536,
-32193,
-34829,
-37261,
-39346,
-40983,
-42040,
-42469,
-42194,
-41229,
-39605,
-37438,
-34880,
-32132,
-29401,
-26906,
-24824,
-23316,
-22478,
-22374,
-23008,
-24330,
-26255,
-28621,
-31274,
-33983,
-36571,
-38827,
-40612,
-41799,
-42326,
-42170,
-41340,
-39902,
-37929,
-35559,
-32930,
-30236,
-27658,
-25399,
-23638,
-22511,
-22120,
-22490,
-23593,
-25345,
-27600,
-30195,
-32920,
-35593,
-38005,
-40006,
-41447,
-42238,
-42334,
-41720,
-40456,
-38616,
-36334,
-33767,
-31096,
-28511,
-26202,
-24335,
-23062,
-22471,
-22628,
-23506,
-25060,
-27164,
-29666,
-32377,
-35096,
-37623,
-39774,
-41392,
-42365,
-42623,
-42158,
-41004,
-39254,
-37040,
-34526,
-31895,
-29328,
-27015,
-25100,
-23729,
-22990,
-22943,
-23599,
-24918,
-26809,
-29143,
-31734,
-34405,
-36935,
-39150,
-40892,
-42028,
-42503,
-42275,
-41370,
-39850,
-37820,
-35422,
-32827,
-30226,
-27806,
-25752,
-24207,
-23281,
-23038,
-23487,
-24597,
-26292,
-28456,
-30943,
-33582,
-36181,
-38549,
-40513,
-41915,
-42663,
-42694,
-42019,
-40686,
-38797,
-36481,
-33905,
-31236,
-28675,
-26396,
-24585,
-23378,
-22879,
-23131,
-24111,
-25741,
-27875,
-30353,
-32970,
-35545,
-37905,
-39890,
-41388,
-42296,
-42548,
-42109,
-40989,
-39233,
-36976,
-34368,
-31652,
-29036,
-26760,
-24955,
-23715,
-22997,
-22706,
-22684,
-22764,
-22828,
-22796,
-22664,
-22478,
-22298,
-22172,
-22150,
-22188,
-22295,
-22398,
-22482,
-22532,
-22548,
-22563,
-22587,
-22641,
-22712,
-22807,
-22885,
-22961,
-23009,
-23045,
-23083,
-23123,
-23188,
-23261,
-23356,
-23451,
-23551,
-23643,
-23729,
-23805,
-23872,
-23935,
-23985,
-24042,
-24089,
-24147,
-24204,
-24265,
-24327,
-24388,
-24441,
-24495,
-24540,
-24590,
-24643,
-24704,
-24773,
-24848,
-24930,
-25007,
-25080,
-25139,
-25188,
-25223,
-25252,
-25278,
-25315,
-25361,
-25433,
-25512,
-25600,
-25684,
-25748,
-25787,
-25803,
-25798,
-25789,
-25789,
-25800,
-25837,
-25887,
-25948,
-26010,
-26065,
-26115,
-26151,
-26188,
-26200,
-26217,
-26200,
-26184,
-26153,
-26124,
-26120,
-26136,
-26191,
-26270,
-26356,
-26434,
-26484,
-26503,
-26495,
-26477,
-26468,
-26482,
-26526,
-26591,
-26661,
-26723,
-26761,
-26768,
-26764,
-26737,
-26720,
-26708,
-26693,
-26695,
-26676,
-26677,
-26665,
-26683,
-26715,
-26771,
-26851,
-26920,
-26985,
-27013,
-27016,
-26991,
-26957,
-26926,
-26912,
-26911,
-26921,
-26929,
-26933,
-26924,
-26915,
-26896,
-26897,
-26893,
-26905,
-26911,
-26912,
-26912,
-26912,
-26919,
-26954,
-26993,
-27062,
-27123,
-27174,
-27210,
-27208,
-27199,
-27171,
-27152,
-27135,
-27138,
-27144,
-27156,
-27176,
-27179,
-27203,
-27211,
-27229,
-27246,
-27243,
-27248,
-27213,
-27192,
-27158,
-27139,
-27149,
-27175,
-27228,
-27292,
-27347,
-27397,
-27422,
-27433,
-27429,
-27424,
-27422,
-27426,
-27439,
-27444,
-27458,
-27456,
-27465,
-27473,
-27498,
-27539,
-27594,
-27657,
-27716,
-27750,
-27767,
-27737,
-27703,
-27646,
-27615,
-27602,
-27629,
-27687,
-27755,
-27828,
-27874,
-27895,
-27892,
-27876,
-27868,
-27878,
-27919,
-27973,
-28040,
-28093,
-28127,
-28143,
-28140,
-28148,
-28158,
-28204,
-28252,
-28315,
-28357,
-28387,
-28388,
-28380,
-28371,
-28377,
-28408,
-28462,
-28531,
-28608,
-28678,
-28745,
-28802,
-28865,
-28935,
-29004,
-29085,
-29135,
-29178,
-29186,
-29174,
-29154,
-29140,
-29150,
-29188,
-29254,
-29335,
-29420,
-29496,
-29551,
-29595,
-29625,
-29663,
-29709,
-29767,
-29838,
-29912,
-29971,
-30021,
-30042,
-30046,
-30040,
-30028,
-30033,
-30047,
-30097,
-30150,
-30234,
-30310,
-30389,
-30462,
-30519,
-30576,
-30619,
-30668,
-30716,
-30770,
-30831,
-30885,
-30942,
-30985,
-31016,
-31034,
-31036,
-31028,
-31029,
-31032,
-31063,
-31117,
-31195,
-31290,
-31382,
-31461,
-31505,
-31527,
-31519,
-31505,
-31505,
-31522,
-31573,
-31639,
-31706,
-31759,
-31784,
-31777,
-31757,
-31732,
-31729,
-31753,
-31799,
-31866,
-31915,
-31960,
-31968,
-31968,
-31970,
-31986,
-32045,
-32123,
-32227,
-32324,
-32388,
-32420,
-32393,
-32350,
-32287,
-32245,
-32230,
-32254,
-32307,
-32380,
-32449,
-32505,
-32540,
-32552,
-32554,
-32546,
-32540,
-32537,
-32532,
-32531,
-32515,
-32502,
-32477,
-32469,
-32464,
-32487,
-32520,
-32578,
-32631,
-32689,
-32726,
-32748,
-32757,
-32755,
-32752,
-32757,
-32765,
-32784,
-32800,
-32811,
-32813,
-32803,
-32789,
-32772,
-32755,
-32752,
-32741,
-32748,
-32739,
-32741,
-32733,
-32731,
-32729,
-32731,
-32740,
-32745,
-32753,
-32755,
-32753,
-32752,
-32746,
-32748,
-32749,
-32756,
-32758,
-32763,
-32760,
-32757,
-32747,
-32739,
-32731,
-32722,
-32719,
-32713,
-32715,
-32716,
-32721,
-32735,
-32746,
-32771,
-32783,
-32803,
-32811,
-32816,
-32812,
-32803,
-32788,
-32779,
-32765,
-32770,
-32769,
-32783,
-32795,
-32791,
-32787,
-32749,
-32704,
-32640,
-32574,
-32515,
-32477,
-32456,
-32462,
-32482,
-32504,
-32532,
-32541,
-32551,
-32548,
-32547,
-32547,
-32548,
-32554,
-32556,
-32557,
-32549,
-32546,
-32527,
-32525,
-32511,
-32507,
-32509,
-32505,
-32510,
-32514,
-32515,
-32524,
-32517,
-32520,
-32503,
-32500,
-32481,
-32485,
-32481,
-32502,
-32516,
-32537,
-32545,
-32546,
-32533,
-32524,
-32512,
-32515,
-32525,
-32543,
-32559,
-32558,
-32552,
-32520,
-32509,
-32488,
-32517,
-32552,
-32623,
-32696,
-32756,
-32801,
-32810,
-32801,
-32780,
-32755,
-32745,
-32736,
-32744,
-32742,
-32742,
-32733,
-32725,
-32728,
-32747,
-32785,
-32842,
-32902,
-32954,
-32994,
-33005,
-33004,
-32981,
-32964,
-32943,
-32947,
-32954,
-32988,
-33029,
-33088,
-33146,
-33212,
-33261,
-33304,
-33315,
-33312,
-33285,
-33255,
-33229,
-33227,
-33245,
-33297,
-33355,
-33418,
-33464,
-33486,
-33485,
-33473,
-33456,
-33463,
-33489,
-33548,
-33622,
-33698,
-33759,
-33794,
-33795,
-33771,
-33728,
-33690,
-33664,
-33662,
-33689,
-33732,
-33793,
-33851,
-33902,
-33936,
-33953,
-33956,
-33944,
-33935,
-33926,
-33933,
-33951,
-33994,
-34039,
-34102,
-34154,
-34203,
-34233,
-34243,
-34234,
-34214,
-34185,
-34170,
-34153,
-34168,
-34194,
-34239,
-34301,
-34356,
-34413,
-34453,
-34476,
-34486,
-34474,
-34462,
-34436,
-34429,
-34420,
-34427,
-34439,
-34449,
-34464,
-34465,
-34460,
-34453,
-34437,
-34433,
-34427,
-34436,
-34442,
-34456,
-34460,
-34466,
-34464,
-34465,
-34464,
-34476,
-34481,
-34501,
-34505,
-34508,
-34505,
-34483,
-34472,
-34452,
-34441,
-34444,
-34444,
-34458,
-34462,
-34466,
-34460,
-34456,
-34444,
-34442,
-34436,
-34442,
-34441,
-34450,
-34445,
-34448,
-34439,
-34438,
-34431,
-34431,
-34428,
-34433,
-34432,
-34442,
-34443,
-34460,
-34464,
-34475,
-34466,
-34450,
-34415,
-34366,
-34313,
-34258,
-34219,
-34198,
-34196,
-34213,
-34238,
-34254,
-34270,
-34260,
-34249,
-34226,
-34205,
-34197,
-34198,
-34210,
-34229,
-34238,
-34239,
-34221,
-34185,
-34141,
-34090,
-34043,
-34010,
-33984,
-33972,
-33965,
-33961,
-33952,
-33946,
-33939,
-33940,
-33947,
-33961,
-33973,
-33980,
-33967,
-33939,
-33886,
-33832,
-33773,
-33734,
-33708,
-33713,
-33718,
-33742,
-33746,
-33744,
-33732,
-33710,
-33701,
-33698,
-33714,
-33737,
-33763,
-33778,
-33772,
-33749,
-33696,
-33648,
-33584,
-33543,
-33508,
-33493,
-33491,
-33493,
-33502,
-33505,
-33512,
-33506,
-33510,
-33500,
-33503,
-33496,
-33497,
-33497,
-33499,
-33505,
-33513,
-33523,
-33533,
-33544,
-33549,
-33560,
-33562,
-33565,
-33569,
-33561,
-33562,
-33554,
-33544,
-33545,
-33530,
-33537,
-33531,
-33538,
-33538,
-33544,
-33552,
-33559,
-33576,
-33587,
-33601,
-33611,
-33605,
-33596,
-33569,
-33548,
-33522,
-33518,
-33516,
-33537,
-33554,
-33571,
-33574,
-33564,
-33544,
-33531,
-33527,
-33552,
-33596,
-33658,
-33725,
-33779,
-33814,
-33816,
-33801,
-33773,
-33746,
-33735,
-33734,
-33750,
-33770,
-33787,
-33795,
-33794,
-33784,
-33770,
-33763,
-33752,
-33754,
-33746,
-33747,
-33742,
-33745,
-33760,
-33797,
-33847,
-33919,
-33976,
-34024,
-34028,
-34004,
-33959,
-33927,
-33961,
-34089,
-34361,
-34756,
-35273,
-35845,
-36431,
-36973,
-37440,
-37832,
-38155,
-38447,
-38725,
-39010,
-39302,
-39593,
-39883,
-40164,
-40457,
-40782,
-41155,
-41598,
-42089,
-42618,
-43145,
-43655,
-44117,
-44561,
-44979,
-45414,
-45866,
-46336,
-46800,
-47232,
-47600,
-47889,
-48109,
-48267,
-48406,
-48538,
-48695,
-48868,
-49067,
-49273,
-49489,
-49703,
-49930,
-50151,
-50385,
-50597,
-50805,
-50978,
-51131,
-51258,
-51376,
-51498,
-51630,
-51781,
-51941,
-52116,
-52284,
-52460,
-52633,
-52811,
-52989,
-53160,
-53305,
-53410,
-53455,
-53433,
-53344,
-53213,
-53046,
-52896,
-52758,
-52675,
-52641,
-52666,
-52740,
-52856,
-52999,
-53150,
-53287,
-53392,
-53445,
-53441,
-53384,
-53280,
-53160,
-53037,
-52938,
-52862,
-52814,
-52777,
-52738,
-52681,
-52599,
-52482,
-52342,
-52178,
-51990,
-51787,
-51549,
-51291,
-51004,
-50702,
-50398,
-50112,
-49858,
-49658,
-49499,
-49390,
-49305,
-49228,
-49140,
-49018,
-48856,
-48644,
-48391,
-48102,
-47793,
-47479,
-47174,
-46879,
-46602,
-46331,
-46064,
-45787,
-45512,
-45218,
-44937,
-44650,
-44375,
-44100,
-43811,
-43504,
-43162,
-42794,
-42406,
-42022,
-41663,
-41345,
-41078,
-40851,
-40647,
-40434,
-40195,
-39901,
-39559,
-39164,
-38746,
-38317,
-37907,
-37513,
-37142,
-36768,
-36371,
-35920,
-35403,
-34818,
-34185,
-33552,
-32949,
-32435,
-32022,
-31712,
-31483,
-31297,
-31115,
-30922,
-30698,
-30470,
-30244,
-30046,
-29875,
-29725,
-29575,
-29409,
-29212,
-28990,
-28747,
-28508,
-28271,
-28050,
-27825,
-27594,
-27348,
-27092,
-26844,
-26613,
-26417,
-26247,
-26101,
-25947,
-25791,
-25614,
-25454,
-25328,
-25276,
-25301,
-25411,
-25549,
-25690,
-25761,
-25744,
-25619,
-25415,
-25154,
-24898,
-24656,
-24474,
-24324,
-24223,
-24141,
-24079,
-24041,
-24022,
-24044,
-24091,
-24162,
-24236,
-24291,
-24316,
-24308,
-24273,
-24245,
-24243,
-24306,
-24446,
-24671,
-24967,
-25308,
-25669,
-26008,
-26312,
-26555,
-26737,
-26870,
-26945,
-27009,
-27036,
-27083,
-27118,
-27184,
-27263,
-27373,
-27517,
-27687,
-27901,
-28132,
-28393,
-28659,
-28933,
-29200,
-29468,
-29732,
-29999,
-30282,
-30566,
-30868,
-31159,
-31434,
-31684,
-31892,
-32072,
-32224,
-32371,
-32522,
-32690,
-32864,
-33054,
-33220,
-33393,
-33538,
-33704,
-33897,
-34144,
-34469,
-34851,
-35295,
-35749,
-36200,
-36609,
-36982,
-37323,
-37656,
-38007,
-38376,
-38782,
-39180,
-39573,
-39905,
-40176,
-40376,
-40512,
-40619,
-40698,
-40801,
-40909,
-41049,
-41207,
-41377,
-41560,
-41738,
-41926,
-42102,
-42278,
-42441,
-42582,
-42712,
-42813,
-42909,
-42995,
-43089,
-43192,
-43315,
-43448,
-43587,
-43723,
-43844,
-43948,
-44036,
-44104,
-44166,
-44211,
-44240,
-44244,
-44211,
-44146,
-44037,
-43923,
-43804,
-43721,
-43693,
-43717,
-43811,
-43932,
-44070,
-44191,
-44275,
-44310,
-44307,
-44258,
-44199,
-44126,
-44048,
-43983,
-43905,
-43845,
-43775,
-43721,
-43679,
-43647,
-43632,
-43604,
-43559,
-43463,
-43304,
-43068,
-42771,
-42420,
-42074,
-41744,
-41490,
-41316,
-41228,
-41217,
-41237,
-41272,
-41268,
-41227,
-41126,
-40980,
-40796,
-40590,
-40365,
-40138,
-39898,
-39656,
-39410,
-39173,
-38945,
-38751,
-38570,
-38416,
-38271,
-38112,
-37942,
-37733,
-37496,
-37224,
-36937,
-36631,
-36343,
-36061,
-35821,
-35604,
-35436,
-35292,
-35173,
-35057,
-34922,
-34757,
-34548,
-34300,
-34019,
-33728,
-33434,
-33160,
-32899,
-32643,
-32377,
-32072,
-31713,
-31297,
-30817,
-30316,
-29798,
-29326,
-28909,
-28582,
-28344,
-28182,
-28077,
-27990,
-27900,
-27776,
-27618,
-27429,
-27220,
-27035,
-26869,
-26757,
-26680,
-26633,
-26583,
-26511,
-26386,
-26211,
-25986,
-25741,
-25497,
-25292,
-25129,
-25013,
-24925,
-24830,
-24718,
-24557,
-24373,
-24171,
-24007,
-23897,
-23889,
-23959,
-24122,
-24307,
-24504,
-24642,
-24720,
-24706,
-24623,
-24475,
-24297,
-24099,
-23924,
-23757,
-23640,
-23552,
-23504,
-23494,
-23498,
-23524,
-23549,
-23584,
-23626,
-23672,
-23741,
-23805,
-23881,
-23940,
-23988,
-24020,
-24059,
-24124,
-24248,
-24447,
-24727,
-25067,
-25434,
-25787,
-26074,
-26286,
-26397,
-26437,
-26428,
-26396,
-26383,
-26391,
-26443,
-26521,
-26631,
-26754,
-26890,
-27037,
-27186,
-27355,
-27531,
-27738,
-27964,
-28223,
-28499,
-28794,
-29077,
-29345,
-29570,
-29750,
-29891,
-29997,
-30100,
-30210,
-30342,
-30510,
-30692,
-30886,
-31066,
-31213,
-31337,
-31424,
-31518,
-31624,
-31790,
-32028,
-32348,
-32749,
-33200,
-33671,
-34136,
-34553,
-34930,
-35261,
-35569,
-35890,
-36228,
-36606,
-37011,
-37419,
-37811,
-38146,
-38425,
-38624,
-38779,
-38888,
-38991,
-39098,
-39220,
-39362,
-39516,
-39682,
-39844,
-40002,
-40149,
-40280,
-40401,
-40502,
-40589,
-40657,
-40706,
-40738,
-40749,
-40755,
-40747,
-40756,
-40777,
-40835,
-40926,
-41046,
-41183,
-41306,
-41393,
-41420,
-41368,
-41262,
-41091,
-40917,
-40744,
-40607,
-40521,
-40474,
-40478,
-40496,
-40547,
-40595,
-40658,
-40721,
-40777,
-40824,
-40843,
-40829,
-40772,
-40688,
-40574,
-40463,
-40354,
-40270,
-40206,
-40157,
-40115,
-40055,
-39980,
-39880,
-39751,
-39606,
-39438,
-39254,
-39058,
-38839,
-38607,
-38361,
-38119,
-37890,
-37701,
-37554,
-37465,
-37425,
-37420,
-37433,
-37433,
-37399,
-37319,
-37179,
-36994,
-36769,
-36529,
-36291,
-36071,
-35882,
-35717,
-35575,
-35440,
-35294,
-35134,
-34949,
-34741,
-34525,
-34292,
-34064,
-33835,
-33603,
-33374,
-33137,
-32902,
-32676,
-32473,
-32303,
-32176,
-32077,
-32005,
-31923,
-31821,
-31663,
-31458,
-31193,
-30892,
-30569,
-30239,
-29920,
-29603,
-29287,
-28958,
-28600,
-28219,
-27804,
-27380,
-26961,
-26569,
-26221,
-25938,
-25710,
-25550,
-25430,
-25346,
-25279,
-25215,
-25156,
-25093,
-25029,
-24976,
-24914,
-24866,
-24804,
-24729,
-24642,
-24522,
-24397,
-24257,
-24121,
-24002,
-23900,
-23822,
-23764,
-23706,
-23656,
-23588,
-23512,
-23428,
-23346,
-23288,
-23259,
-23288,
-23358,
-23492,
-23645,
-23827,
-23984,
-24118,
-24199,
-24229,
-24211,
-24156,
-24079,
-23995,
-23919,
-23849,
-23804,
-23768,
-23766,
-23780,
-23831,
-23907,
-24008,
-24130,
-24251,
-24364,
-24456,
-24524,
-24570,
-24617,
-24665,
-24759,
-24894,
-25102,
-25365,
-25694,
-26048,
-26427,
-26778,
-27089,
-27339,
-27508,
-27616,
-27664,
-27681,
-27698,
-27732,
-27808,
-27923,
-28071,
-28239,
-28405,
-28561,
-28707,
-28840,
-28990,
-29159,
-29370,
-29613,
-29890,
-30176,
-30458,
-30726,
-30968,
-31193,
-31408,
-31609,
-31815,
-32000,
-32180,
-32321,
-32452,
-32549,
-32647,
-32741,
-32844,
-32960,
-33077,
-33200,
-33312,
-33441,
-33583,
-33781,
-34045,
-34389,
-34819,
-35306,
-35837,
-36371,
-36896,
-37386,
-37844,
-38274,
-38677,
-39075,
-39458,
-39849,
-40229,
-40624,
-41007,
-41403,
-41785,
-42159,
-42506,
-42818,
-43090,
-43311,
-43490,
-43619,
-43712,
-43762,
-43785,
-43776,
-43752,
-43723,
-43698,
-43694,
-43694,
-43701,
-43681,
-43615,
-43480,
-43255,
-42953,
-42576,
-42166,
-41733,
-41309,
-40905,
-40516,
-40142,
-39763,
-39368,
-38943,
-38484,
-37978,
-37427,
-36839,
-36200,
-35543,
-34858,
-34169,
-33494,
-32824,
-32178,
-31532,
-30887,
-30208,
-29493,
-28712,
-27873,
-26970,
-26013,
-25027,
-24026,
-23048,
-22111,
-21240,
-20449,
-19745,
-19111,
-18540,
-17988,
-17445,
-16882,
-16302,
-15714,
-15136,
-14608,
-14145,
-13770,
-13473,
-13244,
-13043,
-12862,
-12653,
-12441,
-12197,
-11968,
-11742,
-11563,
-11421,
-11337,
-11310,
-11344,
-11456,
-11644,
-11922,
-12280,
-12704,
-13177,
-13665,
-14143,
-14604,
-15039,
-15469,
-15922,
-16412,
-16972,
-17600,
-18301,
-19055,
-19850,
-20654,
-21458,
-22234,
-22987,
-23704,
-24401,
-25099,
-25812,
-26584,
-27426,
-28363,
-29392,
-30488,
-31631,
-32774,
-33889,
-34950,
-35941,
-36875,
-37749,
-38590,
-39393,
-40176,
-40927,
-41653,
-42345,
-43006,
-43644,
-44256,
-44853,
-45422,
-45971,
-46477,
-46957,
-47386,
-47792,
-48161,
-48515,
-48850,
-49174,
-49487,
-49779,
-50057,
-50300,
-50522,
-50704,
-50840,
-50923,
-50935,
-50878,
-50741,
-50549,
-50304,
-50050,
-49801,
-49581,
-49403,
-49244,
-49100,
-48920,
-48685,
-48364,
-47948,
-47451,
-46893,
-46309,
-45730,
-45183,
-44664,
-44182,
-43698,
-43203,
-42661,
-42064,
-41396,
-40668,
-39868,
-39024,
-38125,
-37205,
-36274,
-35367,
-34514,
-33731,
-33051,
-32440,
-31908,
-31380,
-30848,
-30261,
-29619,
-28937,
-28243,
-27578,
-26983,
-26463,
-26031,
-25667,
-25344,
-25051,
-24765,
-24482,
-24209,
-23928,
-23663,
-23380,
-23113,
-22840,
-22600,
-22410,
-22293,
-22276,
-22358,
-22522,
-22753,
-23013,
-23278,
-23527,
-23756,
-23964,
-24163,
-24365,
-24583,
-24829,
-25128,
-25473,
-25897,
-26377,
-26911,
-27464,
-28011,
-28518,
-28974,
-29388,
-29771,
-30181,
-30643,
-31191,
-31834,
-32561,
-33339,
-34145,
-34934,
-35699,
-36414,
-37092,
-37725,
-38321,
-38886,
-39410,
-39905,
-40371,
-40818,
-41250,
-41679,
-42099,
-42519,
-42915,
-43290,
-43621,
-43907,
-44135,
-44309,
-44437,
-44518,
-44586,
-44626,
-44679,
-44728,
-44789,
-44853,
-44897,
-44927,
-44900,
-44832,
-44691,
-44487,
-44215,
-43891,
-43512,
-43114,
-42686,
-42278,
-41866,
-41490,
-41113,
-40739,
-40329,
-39863,
-39318,
-38690,
-37978,
-37221,
-36435,
-35671,
-34941,
-34266,
-33640,
-33040,
-32442,
-31811,
-31120,
-30364,
-29520,
-28610,
-27638,
-26623,
-25601,
-24576,
-23598,
-22661,
-21813,
-21042,
-20362,
-19758,
-19202,
-18673,
-18135,
-17571,
-16974,
-16353,
-15738,
-15151,
-14636,
-14196,
-13841,
-13557,
-13308,
-13089,
-12859,
-12634,
-12401,
-12185,
-11992,
-11825,
-11701,
-11603,
-11553,
-11541,
-11598,
-11732,
-11968,
-12299,
-12718,
-13188,
-13684,
-14150,
-14588,
-14972,
-15337,
-15711,
-16133,
-16635,
-17236,
-17912,
-18662,
-19421,
-20175,
-20875,
-21528,
-22130,
-22717,
-23316,
-23968,
-24703,
-25525,
-26456,
-27456,
-28528,
-29621,
-30722,
-31803,
-32839,
-33822,
-34738,
-35587,
-36369,
-37092,
-37770,
-38417,
-39061,
-39699,
-40360,
-41027,
-41698,
-42353,
-42963,
-43520,
-44006,
-44421,
-44788,
-45111,
-45425,
-45743,
-46071,
-46414,
-46755,
-47082,
-47376,
-47632,
-47832,
-47990,
-48092,
-48150,
-48148,
-48094,
-47976,
-47807,
-47586,
-47344,
-47084,
-46838,
-46602,
-46378,
-46154,
-45907,
-45627,
-45295,
-44913,
-44478,
-44010,
-43507,
-42999,
-42476,
-41968,
-41461,
-40969,
-40481,
-39985,
-39459,
-38879,
-38223,
-37476,
-36649,
-35752,
-34826,
-33906,
-33028,
-32223,
-31494,
-30850,
-30268,
-29735,
-29235,
-28737,
-28245,
-27728,
-27188,
-26633,
-26054,
-25493,
-24959,
-24496,
-24109,
-23827,
-23608,
-23458,
-23323,
-23177,
-23005,
-22790,
-22557,
-22313,
-22098,
-21919,
-21796,
-21738,
-21742,
-21816,
-21961,
-22173,
-22457,
-22789,
-23162,
-23528,
-23882,
-24186,
-24457,
-24699,
-24954,
-25255,
-25634,
-26109,
-26678,
-27309,
-27973,
-28622,
-29224,
-29767,
-30253,
-30693,
-31142,
-31614,
-32159,
-32800,
-33531,
-34369,
-35258,
-36191,
-37090,
-37952,
-38711,
-39388,
-39966,
-40488,
-40971,
-41458,
-41958,
-42472,
-42993,
-43487,
-43947,
-44352,
-44713,
-45030,
-45330,
-45610,
-45876,
-46112,
-46307,
-46443,
-46531,
-46573,
-46596,
-46629,
-46667,
-46740,
-46795,
-46846,
-46836,
-46763,
-46614,
-46383,
-46092,
-45744,
-45360,
-44947,
-44525,
-44096,
-43685,
-43285,
-42908,
-42538,
-42156,
-41742,
-41266,
-40722,
-40108,
-39432,
-38730,
-38012,
-37313,
-36632,
-35968,
-35323,
-34661,
-33990,
-33282,
-32531,
-31729,
-30872,
-29949,
-28980,
-27960,
-26926,
-25901,
-24918,
-24021,
-23210,
-22517,
-21897,
-21348,
-20814,
-20270,
-19684,
-19055,
-18389,
-17719,
-17082,
-16503,
-16020,
-15618,
-15302,
-15032,
-14786,
-14537,
-14266,
-13984,
-13685,
-13399,
-13135,
-12911,
-12737,
-12626,
-12583,
-12627,
-12754,
-12971,
-13277,
-13637,
-14047,
-14450,
-14846,
-15201,
-15538,
-15847,
-16188,
-16559,
-17011,
-17535,
-18144,
-18806,
-19507,
-20207,
-20884,
-21523,
-22125,
-22702,
-23287,
-23905,
-24593,
-25366,
-26232,
-27179,
-28184,
-29216,
-30248,
-31251,
-32212,
-33119,
-33974,
-34770,
-35530,
-36238,
-36928,
-37590,
-38252,
-38902,
-39562,
-40200,
-40832,
-41418,
-41969,
-42463,
-42910,
-43310,
-43671,
-44004,
-44308,
-44597,
-44870,
-45135,
-45407,
-45682,
-45964,
-46248,
-46496,
-46711,
-46836,
-46880,
-46826,
-46689,
-46506,
-46286,
-46081,
-45887,
-45716,
-45558,
-45382,
-45184,
-44939,
-44643,
-44309,
-43935,
-43547,
-43144,
-42726,
-42296,
-41832,
-41336,
-40801,
-40228,
-39649,
-39055,
-38490,
-37922,
-37372,
-36782,
-36152,
-35427,
-34621,
-33734,
-32795,
-31865,
-30966,
-30158,
-29444,
-28820,
-28274,
-27768,
-27277,
-26787,
-26278,
-25762,
-25244,
-24732,
-24243,
-23784,
-23361,
-22985,
-22651,
-22360,
-22103,
-21870,
-21649,
-21435,
-21223,
-21018,
-20827,
-20666,
-20534,
-20449,
-20409,
-20424,
-20499,
-20644,
-20860,
-21152,
-21507,
-21895,
-22299,
-22667,
-23002,
-23280,
-23541,
-23801,
-24116,
-24514,
-25006,
-25590,
-26224,
-26875,
-27496,
-28065,
-28573,
-29044,
-29502,
-29990,
-30532,
-31150,
-31846,
-32612,
-33432,
-34289,
-35162,
-36036,
-36892,
-37710,
-38471,
-39164,
-39775,
-40319,
-40805,
-41264,
-41715,
-42190,
-42684,
-43202,
-43715,
-44209,
-44643,
-45022,
-45314,
-45551,
-45732,
-45886,
-46029,
-46182,
-46341,
-46516,
-46678,
-46819,
-46906,
-46921,
-46848,
-46685,
-46437,
-46132,
-45777,
-45403,
-45003,
-44581,
-44113,
-43592,
-42991,
-42320,
-41576,
-40777,
-39933,
-39051,
-38118,
-37131,
-36063,
-34921,
-33709,
-32454,
-31194,
-29961,
-28791,
-27689,
-26656,
-25668,
-24717,
-23786,
-22877,
-22008,
-21180,
-20429,
-19736,
-19110,
-18527,
-17966,
-17430,
-16914,
-16444,
-16056,
-15769,
-15628,
-15608,
-15729,
-15928,
-16210,
-16519,
-16882,
-17282,
-17756,
-18316,
-18957,
-19679,
-20437,
-21216,
-21991,
-22778,
-23609,
-24525,
-25575,
-26760,
-28067,
-29424,
-30764,
-32005,
-33114,
-34089,
-34972,
-35812,
-36672,
-37547,
-38450,
-39304,
-40082,
-40731,
-41256,
-41681,
-42058,
-42420,
-42807,
-43181,
-43531,
-43785,
-43919,
-43922,
-43801,
-43613,
-43374,
-43130,
-42863,
-42563,
-42184,
-41712,
-41124,
-40447,
-39708,
-38938,
-38167,
-37391,
-36588,
-35733,
-34782,
-33734,
-32578,
-31369,
-30123,
-28915,
-27748,
-26661,
-25634,
-24656,
-23718,
-22798,
-21927,
-21096,
-20360,
-19694,
-19140,
-18636,
-18188,
-17751,
-17317,
-16897,
-16519,
-16225,
-16059,
-16045,
-16180,
-16446,
-16804,
-17214,
-17659,
-18122,
-18634,
-19197,
-19854,
-20586,
-21400,
-22259,
-23145,
-24039,
-24948,
-25894,
-26910,
-28031,
-29258,
-30595,
-31983,
-33382,
-34721,
-35966,
-37095,
-38127,
-39092,
-40028,
-40966,
-41903,
-42830,
-43689,
-44466,
-45110,
-45644,
-46079,
-46465,
-46833,
-47210,
-47574,
-47900,
-48146,
-48263,
-48263,
-48137,
-47938,
-47708,
-47458,
-47205,
-46905,
-46530,
-46042,
-45433,
-44717,
-43947,
-43153,
-42388,
-41635,
-40883,
-40065,
-39158,
-38102,
-36933,
-35663,
-34375,
-33111,
-31930,
-30845,
-29843,
-28912,
-28006,
-27123,
-26260,
-25427,
-24661,
-23965,
-23363,
-22823,
-22345,
-21881,
-21444,
-21016,
-20635,
-20336,
-20148,
-20105,
-20193,
-20409,
-20695,
-21039,
-21399,
-21791,
-22222,
-22734,
-23329,
-24029,
-24797,
-25600,
-26415,
-27206,
-28006,
-28840,
-29768,
-30817,
-32010,
-33295,
-34625,
-35912,
-37091,
-38142,
-39060,
-39909,
-40721,
-41555,
-42407,
-43256,
-44068,
-44773,
-45372,
-45838,
-46216,
-46539,
-46842,
-47133,
-47405,
-47612,
-47732,
-47721,
-47595,
-47357,
-47062,
-46734,
-46404,
-46067,
-45695,
-45270,
-44735,
-44106,
-43363,
-42558,
-41708,
-40859,
-40004,
-39143,
-38230,
-37237,
-36137,
-34927,
-33642,
-32325,
-31027,
-29797,
-28643,
-27562,
-26524,
-25510,
-24494,
-23498,
-22533,
-21641,
-20845,
-20150,
-19539,
-18983,
-18447,
-17918,
-17401,
-16935,
-16559,
-16329,
-16251,
-16336,
-16539,
-16818,
-17138,
-17455,
-17786,
-18139,
-18550,
-19049,
-19637,
-20310,
-21039,
-21791,
-22557,
-23329,
-24146,
-25037,
-26048,
-27184,
-28436,
-29748,
-31058,
-32298,
-33429,
-34437,
-35361,
-36228,
-37105,
-37980,
-38875,
-39720,
-40492,
-41134,
-41649,
-42060,
-42408,
-42754,
-43103,
-43476,
-43801,
-44061,
-44179,
-44163,
-44013,
-43792,
-43533,
-43290,
-43054,
-42806,
-42496,
-42079,
-41532,
-40869,
-40115,
-39340,
-38558,
-37802,
-37049,
-36243,
-35367,
-34352,
-33231,
-31998,
-30732,
-29465,
-28257,
-27122,
-26059,
-25051,
-24076,
-23116,
-22186,
-21288,
-20475,
-19741,
-19119,
-18584,
-18110,
-17675,
-17244,
-16826,
-16428,
-16099,
-15861,
-15764,
-15801,
-15974,
-16257,
-16612,
-17035,
-17492,
-18018,
-18593,
-19252,
-19968,
-20737,
-21537,
-22342,
-23165,
-24009,
-24915,
-25919,
-27038,
-28285,
-29627,
-31023,
-32416,
-33755,
-35006,
-36161,
-37228,
-38237,
-39209,
-40165,
-41106,
-42014,
-42880,
-43665,
-44373,
-44990,
-45541,
-46033,
-46490,
-46909,
-47278,
-47584,
-47784,
-47873,
-47842,
-47712,
-47507,
-47272,
-47010,
-46740,
-46428,
-46060,
-45600,
-45049,
-44422,
-43739,
-43047,
-42343,
-41638,
-40882,
-40050,
-39087,
-38002,
-36801,
-35541,
-34271,
-33052,
-31900,
-30829,
-29798,
-28807,
-27818,
-26865,
-25946,
-25114,
-24379,
-23749,
-23209,
-22722,
-22246,
-21774,
-21284,
-20823,
-20415,
-20115,
-19946,
-19921,
-20025,
-20219,
-20474,
-20756,
-21049,
-21383,
-21766,
-22249,
-22843,
-23546,
-24346,
-25184,
-26038,
-26868,
-27687,
-28521,
-29422,
-30420,
-31552,
-32770,
-34058,
-35315,
-36510,
-37593,
-38581,
-39504,
-40401,
-41315,
-42223,
-43126,
-43935,
-44640,
-45191,
-45621,
-45963,
-46281,
-46609,
-46970,
-47331,
-47652,
-47862,
-47941,
-47853,
-47650,
-47357,
-47032,
-46703,
-46376,
-46031,
-45629,
-45145,
-44542,
-43854,
-43075,
-42265,
-41433,
-40593,
-39729,
-38804,
-37787,
-36644,
-35398,
-34056,
-32700,
-31377,
-30139,
-29017,
-27992,
-27029,
-26102,
-25160,
-24232,
-23310,
-22465,
-21709,
-21080,
-20546,
-20080,
-19630,
-19165,
-18681,
-18209,
-17805,
-17528,
-17421,
-17483,
-17698,
-18002,
-18354,
-18715,
-19071,
-19461,
-19893,
-20423,
-21042,
-21754,
-22512,
-23306,
-24080,
-24871,
-25657,
-26509,
-27427,
-28461,
-29577,
-30768,
-31973,
-33143,
-34253,
-35273,
-36225,
-37131,
-38017,
-38903,
-39786,
-40631,
-41418,
-42093,
-42666,
-43130,
-43529,
-43896,
-44261,
-44630,
-44969,
-45242,
-45393,
-45405,
-45279,
-45045,
-44756,
-44452,
-44145,
-43827,
-43458,
-42997,
-42430,
-41748,
-41008,
-40234,
-39489,
-38763,
-38042,
-37273,
-36396,
-35378,
-34216,
-32948,
-31630,
-30344,
-29119,
-27995,
-26942,
-25942,
-24962,
-23984,
-23013,
-22079,
-21199,
-20408,
-19705,
-19073,
-18501,
-17952,
-17428,
-16932,
-16499,
-16155,
-15947,
-15874,
-15947,
-16120,
-16374,
-16662,
-16974,
-17317,
-17700,
-18172,
-18736,
-19419,
-20183,
-21010,
-21850,
-22691,
-23517,
-24368,
-25270,
-26269,
-27394,
-28624,
-29943,
-31278,
-32590,
-33827,
-34985,
-36063,
-37093,
-38103,
-39100,
-40082,
-41025,
-41893,
-42665,
-43328,
-43888,
-44375,
-44810,
-45222,
-45614,
-45983,
-46298,
-46533,
-46671,
-46696,
-46625,
-46476,
-46271,
-46034,
-45764,
-45450,
-45075,
-44613,
-44063,
-43430,
-42738,
-42022,
-41295,
-40568,
-39816,
-39003,
-38091,
-37053,
-35899,
-34651,
-33378,
-32128,
-30946,
-29859,
-28840,
-27873,
-26925,
-25971,
-25032,
-24125,
-23282,
-22544,
-21898,
-21354,
-20863,
-20408,
-19967,
-19546,
-19172,
-18880,
-18711,
-18678,
-18794,
-19021,
-19341,
-19708,
-20103,
-20520,
-20961,
-21460,
-22025,
-22676,
-23409,
-24198,
-25037,
-25885,
-26761,
-27655,
-28611,
-29644,
-30780,
-32005,
-33291,
-34582,
-35827,
-36984,
-38033,
-39003,
-39908,
-40802,
-41682,
-42555,
-43384,
-44126,
-44772,
-45293,
-45751,
-46155,
-46566,
-46988,
-47400,
-47761,
-48008,
-48110,
-48049,
-47866,
-47605,
-47333,
-47074,
-46840,
-46571,
-46250,
-45793,
-45214,
-44518,
-43739,
-42961,
-42180,
-41434,
-40671,
-39839,
-38886,
-37767,
-36475,
-35048,
-33530,
-32003,
-30512,
-29114,
-27804,
-26601,
-25464,
-24394,
-23367,
-22389,
-21473,
-20639,
-19909,
-19313,
-18858,
-18564,
-18428,
-18441,
-18599,
-18884,
-19289,
-19799,
-20414,
-21120,
-21930,
-22834,
-23839,
-24942,
-26149,
-27443,
-28824,
-30251,
-31722,
-33179,
-34622,
-36002,
-37318,
-38548,
-39695,
-40747,
-41707,
-42573,
-43335,
-44003,
-44558,
-45016,
-45356,
-45585,
-45688,
-45657,
-45490,
-45189,
-44761,
-44229,
-43613,
-42926,
-42175,
-41355,
-40438,
-39418,
-38264,
-36981,
-35585,
-34095,
-32564,
-31014,
-29498,
-28019,
-26605,
-25258,
-23978,
-22785,
-21677,
-20674,
-19780,
-18998,
-18334,
-17782,
-17351,
-17040,
-16866,
-16835,
-16967,
-17246,
-17674,
-18224,
-18870,
-19600,
-20399,
-21271,
-22244,
-23322,
-24538,
-25884,
-27351,
-28905,
-30498,
-32091,
-33629,
-35091,
-36452,
-37716,
-38879,
-39964,
-40961,
-41884,
-42728,
-43470,
-44116,
-44635,
-45027,
-45279,
-45389,
-45361,
-45204,
-44933,
-44552,
-44095,
-43554,
-42945,
-42269,
-41493,
-40630,
-39629,
-38498,
-37227,
-35827,
-34345,
-32804,
-31273,
-29773,
-28354,
-27017,
-25769,
-24600,
-23504,
-22478,
-21525,
-20661,
-19889,
-19236,
-18694,
-18284,
-17996,
-17851,
-17845,
-18006,
-18317,
-18798,
-19413,
-20146,
-20970,
-21858,
-22804,
-23815,
-24902,
-26093,
-27386,
-28800,
-30286,
-31840,
-33396,
-34931,
-36402,
-37793,
-39091,
-40297,
-41400,
-42424,
-43340,
-44187,
-44932,
-45592,
-46144,
-46580,
-46880,
-47035,
-47033,
-46891,
-46617,
-46255,
-45814,
-45320,
-44767,
-44147,
-43422,
-42582,
-41585,
-40451,
-39177,
-37802,
-36356,
-34883,
-33397,
-31952,
-30524,
-29168,
-27861,
-26629,
-25482,
-24419,
-23445,
-22569,
-21771,
-21078,
-20474,
-19990,
-19628,
-19426,
-19368,
-19498,
-19767,
-20196,
-20733,
-21367,
-22080,
-22857,
-23710,
-24644,
-25674,
-26819,
-28070,
-29433,
-30867,
-32351,
-33844,
-35307,
-36714,
-38047,
-39280,
-40434,
-41480,
-42452,
-43316,
-44100,
-44776,
-45349,
-45812,
-46149,
-46379,
-46481,
-46483,
-46370,
-46166,
-45851,
-45448,
-44923,
-44302,
-43553,
-42697,
-41718,
-40632,
-39441,
-38154,
-36791,
-35347,
-33873,
-32359,
-30869,
-29397,
-27988,
-26643,
-25375,
-24183,
-23056,
-22005,
-21015,
-20122,
-19319,
-18646,
-18108,
-17722,
-17499,
-17425,
-17507,
-17726,
-18073,
-18545,
-19129,
-19826,
-20635,
-21553,
-22586,
-23731,
-24983,
-26337,
-27772,
-29275,
-30808,
-32347,
-33860,
-35315,
-36695,
-37983,
-39168,
-40264,
-41264,
-42189,
-43034,
-43808,
-44494,
-45082,
-45547,
-45869,
-46038,
-46050,
-45918,
-45663,
-45307,
-44867,
-44353,
-43762,
-43080,
-42296,
-41381,
-40348,
-39169,
-37880,
-36477,
-34997,
-33457,
-31898,
-30344,
-28839,
-27405,
-26070,
-24842,
-23716,
-22686,
-21724,
-20826,
-19981,
-19201,
-18506,
-17924,
-17485,
-17209,
-17110,
-17181,
-17421,
-17801,
-18315,
-18927,
-19637,
-20422,
-21286,
-22228,
-23258,
-24392,
-25637,
-27007,
-28478,
-30037,
-31633,
-33218,
-34743,
-36162,
-37462,
-38628,
-39689,
-40651,
-41551,
-42385,
-43160,
-43854,
-44446,
-44916,
-45243,
-45423,
-45462,
-45361,
-45149,
-44821,
-44412,
-43900,
-43320,
-42635,
-41862,
-40976,
-39968,
-38828,
-37567,
-36172,
-34710,
-33178,
-31654,
-30162,
-28732,
-27384,
-26112,
-24907,
-23766,
-22673,
-21643,
-20686,
-19829,
-19080,
-18463,
-17978,
-17629,
-17424,
-17354,
-17442,
-17675,
-18064,
-18589,
-19234,
-19978,
-20795,
-21691,
-22657,
-23730,
-24915,
-26239,
-27688,
-29245,
-30860,
-32482,
-34068,
-35567,
-36974,
-38268,
-39469,
-40582,
-41616,
-42582,
-43461,
-44261,
-44961,
-45549,
-46021,
-46355,
-46552,
-46603,
-46512,
-46292,
-45954,
-45521,
-45013,
-44428,
-43779,
-43037,
-42200,
-41228,
-40133,
-38892,
-37552,
-36123,
-34660,
-33197,
-31769,
-30391,
-29071,
-27804,
-26586,
-25414,
-24298,
-23249,
-22290,
-21441,
-20708,
-20108,
-19629,
-19280,
-19057,
-18978,
-19054,
-19302,
-19719,
-20295,
-20995,
-21781,
-22614,
-23474,
-24369,
-25332,
-26397,
-27616,
-28985,
-30501,
-32098,
-33711,
-35277,
-36730,
-38075,
-39301,
-40447,
-41535,
-42568,
-43540,
-44427,
-45188,
-45819,
-46308,
-46680,
-46951,
-47143,
-47248,
-47258,
-47142,
-46876,
-46457,
-45898,
-45225,
-44483,
-43686,
-42845,
-41942,
-40932,
-39795,
-38499,
-37068,
-35528,
-33948,
-32383,
-30890,
-29502,
-28220,
-27037,
-25924,
-24871,
-23853,
-22896,
-21996,
-21198,
-20516,
-19982,
-19599,
-19387,
-19316,
-19401,
-19604,
-19924,
-20344,
-20858,
-21465,
-22173,
-22983,
-23908,
-24950,
-26110,
-27382,
-28756,
-30198,
-31696,
-33199,
-34686,
-36119,
-37470,
-38734,
-39892,
-40957,
-41932,
-42822,
-43642,
-44373,
-45022,
-45573,
-46009,
-46329,
-46515,
-46570,
-46498,
-46297,
-45990,
-45572,
-45076,
-44489,
-43832,
-43087,
-42237,
-41267,
-40153,
-38893,
-37500,
-36002,
-34458,
-32910,
-31413,
-29993,
-28650,
-27382,
-26163,
-24972,
-23818,
-22700,
-21654,
-20708,
-19886,
-19207,
-18671,
-18282,
-18029,
-17918,
-17953,
-18135,
-18474,
-18942,
-19539,
-20215,
-20964,
-21762,
-22615,
-23551,
-24589,
-25768,
-27086,
-28547,
-30105,
-31713,
-33313,
-34847,
-36277,
-37589,
-38773,
-39852,
-40836,
-41755,
-42601,
-43397,
-44102,
-44723,
-45209,
-45572,
-45764,
-45827,
-45729,
-45525,
-45215,
-44818,
-44355,
-43807,
-43176,
-42442,
-41588,
-40605,
-39493,
-38253,
-36907,
-35471,
-33980,
-32456,
-30933,
-29446,
-28006,
-26649,
-25373,
-24192,
-23089,
-22076,
-21117,
-20243,
-19438,
-18734,
-18159,
-17727,
-17476,
-17398,
-17492,
-17743,
-18107,
-18581,
-19132,
-19771,
-20502,
-21347,
-22312,
-23421,
-24648,
-25995,
-27420,
-28904,
-30416,
-31934,
-33439,
-34914,
-36333,
-37685,
-38945,
-40106,
-41161,
-42118,
-42990,
-43780,
-44503,
-45136,
-45677,
-46091,
-46371,
-46491,
-46464,
-46300,
-46009,
-45626,
-45147,
-44592,
-43949,
-43227,
-42402,
-41485,
-40453,
-39313,
-38062,
-36693,
-35251,
-33725,
-32201,
-30691,
-29258,
-27932,
-26713,
-25607,
-24578,
-23618,
-22693,
-21830,
-21025,
-20333,
-19771,
-19373,
-19145,
-19077,
-19156,
-19358,
-19672,
-20086,
-20601,
-21216,
-21937,
-22764,
-23690,
-24726,
-25865,
-27113,
-28466,
-29915,
-31426,
-32978,
-34509,
-35987,
-37375,
-38658,
-39834,
-40926,
-41933,
-42887,
-43765,
-44575,
-45278,
-45870,
-46325,
-46648,
-46840,
-46912,
-46872,
-46728,
-46476,
-46122,
-45660,
-45093,
-44433,
-43669,
-42822,
-41868,
-40812,
-39632,
-38332,
-36912,
-35405,
-33835,
-32262,
-30718,
-29253,
-27885,
-26625,
-25470,
-24401,
-23404,
-22474,
-21591,
-20784,
-20050,
-19421,
-18925,
-18576,
-18401,
-18396,
-18565,
-18884,
-19355,
-19949,
-20684,
-21554,
-22589,
-23793,
-25181,
-26725,
-28405,
-30154,
-31919,
-33640,
-35272,
-36801,
-38217,
-39534,
-40754,
-41888,
-42905,
-43802,
-44523,
-45065,
-45396,
-45535,
-45486,
-45281,
-44939,
-44462,
-43852,
-43081,
-42128,
-40970,
-39607,
-38058,
-36367,
-34594,
-32810,
-31068,
-29421,
-27888,
-26459,
-25151,
-23925,
-22809,
-21801,
-20937,
-20253,
-19771,
-19522,
-19490,
-19671,
-20036,
-20560,
-21235,
-22053,
-23024,
-24158,
-25454,
-26910,
-28487,
-30163,
-31876,
-33593,
-35263,
-36861,
-38361,
-39754,
-41021,
-42163,
-43164,
-44018,
-44712,
-45233,
-45571,
-45718,
-45681,
-45455,
-45073,
-44539,
-43871,
-43079,
-42146,
-41066,
-39814,
-38376,
-36772,
-35012,
-33189,
-31335,
-29553,
-27882,
-26347,
-24962,
-23688,
-22514,
-21423,
-20428,
-19565,
-18883,
-18437,
-18252,
-18344,
-18673,
-19212,
-19897,
-20721,
-21649,
-22725,
-23954,
-25369,
-26975,
-28723,
-30574,
-32432,
-34231,
-35915,
-37454,
-38857,
-40135,
-41326,
-42423,
-43424,
-44285,
-44973,
-45436,
-45673,
-45675,
-45480,
-45129,
-44642,
-44056,
-43336,
-42471,
-41423,
-40154,
-38688,
-37032,
-35254,
-33430,
-31620,
-29889,
-28264,
-26742,
-25326,
-23982,
-22718,
-21546,
-20489,
-19608,
-18935,
-18509,
-18344,
-18416,
-18709,
-19178,
-19800,
-20566,
-21478,
-22560,
-23825,
-25283,
-26916,
-28679,
-30520,
-32360,
-34154,
-35842,
-37418,
-38857,
-40187,
-41393,
-42497,
-43469,
-44314,
-44985,
-45491,
-45790,
-45906,
-45830,
-45581,
-45173,
-44615,
-43907,
-43054,
-42031,
-40846,
-39474,
-37937,
-36259,
-34476,
-32661,
-30859,
-29144,
-27546,
-26097,
-24788,
-23623,
-22572,
-21654,
-20849,
-20208,
-19741,
-19485,
-19454,
-19648,
-20040,
-20624,
-21347,
-22221,
-23220,
-24375,
-25680,
-27158,
-28780,
-30520,
-32328,
-34123,
-35856,
-37475,
-38945,
-40280,
-41470,
-42555,
-43517,
-44383,
-45101,
-45673,
-46044,
-46223,
-46182,
-45962,
-45564,
-45024,
-44348,
-43537,
-42570,
-41438,
-40111,
-38618,
-36962,
-35209,
-33415,
-31635,
-29933,
-28330,
-26836,
-25463,
-24183,
-23014,
-21958,
-21040,
-20304,
-19770,
-19478,
-19410,
-19570,
-19915,
-20407,
-21047,
-21796,
-22711,
-23785,
-25073,
-26560,
-28238,
-30039,
-31888,
-33704,
-35412,
-36989,
-38418,
-39738,
-40966,
-42134,
-43219,
-44201,
-45014,
-45623,
-45988,
-46123,
-46041,
-45808,
-45440,
-44974,
-44397,
-43672,
-42774,
-41657,
-40324,
-38798,
-37121,
-35362,
-33581,
-31826,
-30142,
-28533,
-27022,
-25596,
-24277,
-23057,
-21974,
-21030,
-20260,
-19678,
-19301,
-19134,
-19181,
-19422,
-19854,
-20448,
-21201,
-22103,
-23153,
-24368,
-25737,
-27269,
-28930,
-30693,
-32488,
-34280,
-35988,
-37595,
-39059,
-40382,
-41560,
-42605,
-43508,
-44284,
-44890,
-45341,
-45592,
-45652,
-45516,
-45187,
-44695,
-44039,
-43246,
-42314,
-41239,
-40022,
-38646,
-37124,
-35464,
-33710,
-31895,
-30090,
-28330,
-26677,
-25142,
-23758,
-22507,
-21399,
-20433,
-19615,
-18972,
-18524,
-18297,
-18302,
-18537,
-18975,
-19597,
-20359,
-21256,
-22274,
-23438,
-24757,
-26263,
-27931,
-29744,
-31627,
-33500,
-35292,
-36929,
-38398,
-39689,
-40844,
-41881,
-42838,
-43684,
-44417,
-44967,
-45320,
-45438,
-45349,
-45072,
-44659,
-44133,
-43500,
-42731,
-41793,
-40630,
-39245,
-37639,
-35889,
-34060,
-32246,
-30504,
-28865,
-27328,
-25872,
-24468,
-23120,
-21842,
-20691,
-19720,
-18990,
-18530,
-18346,
-18409,
-18679,
-19109,
-19673,
-20361,
-21182,
-22175,
-23348,
-24738,
-26312,
-28046,
-29880,
-31744,
-33572,
-35317,
-36935,
-38432,
-39796,
-41048,
-42191,
-43221,
-44133,
-44896,
-45497,
-45905,
-46124,
-46145,
-45984,
-45651,
-45158,
-44509,
-43705,
-42720,
-41572,
-40230,
-38739,
-37108,
-35395,
-33650,
-31933,
-30271,
-28718,
-27249,
-25900,
-24631,
-23470,
-22404,
-21482,
-20715,
-20162,
-19833,
-19751,
-19900,
-20262,
-20807,
-21505,
-22338,
-23302,
-24399,
-25644,
-27044,
-28587,
-30264,
-32015,
-33805,
-35558,
-37227,
-38776,
-40172,
-41436,
-42556,
-43572,
-44468,
-45255,
-45887,
-46345,
-46585,
-46599,
-46389,
-45990,
-45435,
-44770,
-43997,
-43118,
-42089,
-40879,
-39456,
-37838,
-36061,
-34221,
-32388,
-30665,
-29069,
-27625,
-26291,
-25031,
-23818,
-22654,
-21572,
-20646,
-19934,
-19498,
-19349,
-19473,
-19823,
-20339,
-20984,
-21728,
-22595,
-23595,
-24778,
-26154,
-27710,
-29423,
-31207,
-33010,
-34751,
-36382,
-37890,
-39260,
-40523,
-41681,
-42745,
-43702,
-44523,
-45182,
-45640,
-45893,
-45933,
-45791,
-45480,
-45033,
-44453,
-43731,
-42853,
-41783,
-40514,
-39043,
-37393,
-35618,
-33773,
-31931,
-30136,
-28446,
-26860,
-25414,
-24072,
-22863,
-21763,
-20801,
-19993,
-19362,
-18942,
-18738,
-18768,
-19016,
-19465,
-20101,
-20885,
-21827,
-22907,
-24133,
-25512,
-27032,
-28680,
-30426,
-32215,
-34014,
-35752,
-37421,
-38961,
-40394,
-41685,
-42854,
-43878,
-44752,
-45460,
-45977,
-46301,
-46412,
-46336,
-46067,
-45646,
-45068,
-44359,
-43502,
-42491,
-41304,
-39927,
-38374,
-36657,
-34843,
-32979,
-31150,
-29409,
-27788,
-26311,
-24954,
-23711,
-22566,
-21518,
-20605,
-19847,
-19311,
-19002,
-18948,
-19124,
-19499,
-20036,
-20710,
-21502,
-22439,
-23531,
-24803,
-26264,
-27887,
-29632,
-31438,
-33234,
-34967,
-36596,
-38106,
-39501,
-40779,
-41948,
-42990,
-43892,
-44620,
-45148,
-45475,
-45595,
-45546,
-45349,
-45027,
-44592,
-44019,
-43284,
-42341,
-41171,
-39767,
-38170,
-36432,
-34644,
-32857,
-31143,
-29503,
-27947,
-26445,
-24990,
-23574,
-22238,
-21017,
-19988,
-19183,
-18656,
-18382,
-18368,
-18543,
-18896,
-19378,
-19992,
-20747,
-21671,
-22781,
-24102,
-25616,
-27296,
-29097,
-30942,
-32782,
-34546,
-36212,
-37739,
-39147,
-40412,
-41570,
-42600,
-43510,
-44283,
-44902,
-45349,
-45615,
-45694,
-45586,
-45304,
-44844,
-44219,
-43425,
-42469,
-41341,
-40059,
-38614,
-37044,
-35356,
-33602,
-31813,
-30034,
-28315,
-26686,
-25173,
-23808,
-22579,
-21509,
-20593,
-19842,
-19271,
-18897,
-18732,
-18780,
-19034,
-19477,
-20084,
-20844,
-21736,
-22781,
-23983,
-25363,
-26924,
-28649,
-30491,
-32400,
-34271,
-36071,
-37701,
-39178,
-40463,
-41596,
-42595,
-43472,
-44252,
-44896,
-45414,
-45744,
-45892,
-45840,
-45582,
-45163,
-44566,
-43838,
-42952,
-41923,
-40722,
-39353,
-37824,
-36161,
-34417,
-32653,
-30919,
-29269,
-27717,
-26278,
-24934,
-23688,
-22540,
-21514,
-20646,
-19982,
-19545,
-19360,
-19409,
-19665,
-20092,
-20654,
-21336,
-22149,
-23109,
-24253,
-25598,
-27136,
-28838,
-30643,
-32471,
-34264,
-35948,
-37512,
-38938,
-40240,
-41440,
-42531,
-43521,
-44377,
-45076,
-45603,
-45929,
-46081,
-46042,
-45833,
-45441,
-44839,
-44006,
-42908,
-41532,
-39916,
-38087,
-36142,
-34154,
-32192,
-30319,
-28539,
-26881,
-25325,
-23909,
-22639,
-21575,
-20754,
-20217,
-19975,
-20031,
-20356,
-20936,
-21749,
-22794,
-24074,
-25590,
-27326,
-29241,
-31267,
-33318,
-35313,
-37170,
-38859,
-40337,
-41634,
-42742,
-43684,
-44461,
-45049,
-45436,
-45581,
-45464,
-45075,
-44399,
-43469,
-42281,
-40888,
-39296,
-37557,
-35694,
-33748,
-31772,
-29805,
-27914,
-26148,
-24559,
-23188,
-22062,
-21182,
-20560,
-20171,
-20031,
-20116,
-20452,
-21041,
-21898,
-23029,
-24419,
-26036,
-27841,
-29763,
-31741,
-33719,
-35627,
-37431,
-39093,
-40578,
-41880,
-42973,
-43849,
-44510,
-44935,
-45142,
-45109,
-44845,
-44341,
-43589,
-42602,
-41375,
-39942,
-38317,
-36557,
-34689,
-32781,
-30854,
-28970,
-27148,
-25437,
-23860,
-22463,
-21275,
-20337,
-19670,
-19300,
-19222,
-19439,
-19927,
-20675,
-21662,
-22876,
-24314,
-25944,
-27767,
-29716,
-31763,
-33820,
-35824,
-37700,
-39399,
-40877,
-42131,
-43153,
-43955,
-44554,
-44937,
-45119,
-45071,
-44789,
-44254,
-43460,
-42416,
-41124,
-39626,
-37934,
-36107,
-34171,
-32193,
-30205,
-28273,
-26435,
-24745,
-23238,
-21958,
-20910,
-20136,
-19620,
-19385,
-19415,
-19716,
-20278,
-21107,
-22184,
-23508,
-25051,
-26781,
-28661,
-30622,
-32626,
-34591,
-36498,
-38267,
-39907,
-41356,
-42630,
-43680,
-44519,
-45105,
-45456,
-45542,
-45382,
-44972,
-44325,
-43443,
-42342,
-41014,
-39494,
-37782,
-35925,
-33974,
-31981,
-30031,
-28168,
-26465,
-24938,
-23628,
-22525,
-21647,
-20986,
-20554,
-20365,
-20430,
-20760,
-21365,
-22224,
-23342,
-24678,
-26223,
-27939,
-29796,
-31753,
-33748,
-35733,
-37622,
-39370,
-40915,
-42233,
-43322,
-44185,
-44851,
-45317,
-45605,
-45676,
-45529,
-45108,
-44421,
-43440,
-42213,
-40745,
-39118,
-37346,
-35506,
-33613,
-31718,
-29843,
-28031,
-26314,
-24739,
-23338,
-22149,
-21200,
-20503,
-20080,
-19926,
-20048,
-20449,
-21113,
-22039,
-23206,
-24587,
-26163,
-27892,
-29745,
-31675,
-33630,
-35568,
-37412,
-39127,
-40645,
-41951,
-43008,
-43836,
-44420,
-44803,
-44969,
-44944,
-44694,
-44219,
-43484,
-42494,
-41230,
-39735,
-38030,
-36170,
-34229,
-32234,
-30273,
-28356,
-26551,
-24874,
-23368,
-22060,
-20975,
-20140,
-19560,
-19253,
-19199,
-19409,
-19865,
-20565,
-21515,
-22695,
-24108,
-25724,
-27504,
-29406,
-31364,
-33323,
-35222,
-37017,
-38671,
-40148,
-41438,
-42509,
-43357,
-43971,
-44341,
-44477,
-44379,
-44056,
-43509,
-42743,
-41743,
-40516,
-39063,
-37393,
-35563,
-33602,
-31596,
-29615,
-27709,
-25964,
-24390,
-23043,
-21924,
-21051,
-20429,
-20052,
-19931,
-20049,
-20404,
-21002,
-21824,
-22892,
-24189,
-25716,
-27450,
-29340,
-31336,
-33351,
-35316,
-37158,
-38822,
-40299,
-41556,
-42635,
-43510,
-44220,
-44733,
-45054,
-45146,
-45001,
-44599,
-43933,
-43023,
-41861,
-40493,
-38915,
-37184,
-35312,
-33360,
-31367,
-29392,
-27486,
-25702,
-24079,
-22653,
-21449,
-20478,
-19760,
-19301,
-19110,
-19196,
-19560,
-20199,
-21110,
-22278,
-23678,
-25286,
-27068,
-28974,
-30971,
-32992,
-34982,
-36889,
-38650,
-40224,
-41581,
-42698,
-43583,
-44241,
-44690,
-44938,
-44984,
-44811,
-44399,
-43713,
-42742,
-41487,
-39966,
-38244,
-36367,
-34410,
-32438,
-30478,
-28591,
-26775,
-25077,
-23513,
-22135,
-20976,
-20080,
-19470,
-19154,
-19125,
-19367,
-19856,
-20584,
-21543,
-22733,
-24154,
-25788,
-27618,
-29579,
-31627,
-33672,
-35662,
-37523,
-39224,
-40714,
-41999,
-43052,
-43897,
-44523,
-44946,
-45155,
-45149,
-44906,
-44410,
-43643,
-42595,
-41293,
-39748,
-38032,
-36178,
-34259,
-32314,
-30388,
-28510,
-26713,
-25029,
-23498,
-22167,
-21072,
-20250,
-19716,
-19467,
-19503,
-19801,
-20356,
-21169,
-22226,
-23540,
-25082,
-26825,
-28718,
-30697,
-32693,
-34652,
-36512,
-38255,
-39840,
-41264,
-42502,
-43539,
-44361,
-44951,
-45299,
-45413,
-45279,
-44919,
-44321,
-43490,
-42429,
-41128,
-39616,
-37903,
-36053,
-34102,
-32124,
-30183,
-28320,
-26597,
-25026,
-23645,
-22459,
-21492,
-20752,
-20264,
-20033,
-20081,
-20409,
-21010,
-21892,
-23007,
-24368,
-25916,
-27637,
-29488,
-31420,
-33400,
-35361,
-37257,
-39030,
-40636,
-42032,
-43208,
-44143,
-44842,
-45321,
-45568,
-45605,
-45408,
-44980,
-44298,
-43370,
-42189,
-40785,
-39171,
-37410,
-35523,
-33588,
-31636,
-29729,
-27916,
-26230,
-24721,
-23405,
-22303,
-21440,
-20799,
-20414,
-20277,
-20402,
-20808,
-21480,
-22434,
-23629,
-25060,
-26669,
-28426,
-30288,
-32205,
-34143,
-36046,
-37875,
-39571,
-41099,
-42418,
-43504,
-44364,
-44984,
-45393,
-45583,
-45557,
-45303,
-44801,
-44047,
-43030,
-41779,
-40309,
-38678,
-36912,
-35068,
-33168,
-31257,
-29361,
-27533,
-25815,
-24265,
-22932,
-21851,
-21043,
-20506,
-20238,
-20213,
-20437,
-20902,
-21618,
-22596,
-23828,
-25311,
-26994,
-28838,
-30774,
-32736,
-34671,
-36523,
-38254,
-39832,
-41237,
-42444,
-43454,
-44255,
-44839,
-45226,
-45381,
-45333,
-45038,
-44504,
-43705,
-42652,
-41340,
-39816,
-38102,
-36264,
-34343,
-32398,
-30469,
-28601,
-26828,
-25186,
-23706,
-22423,
-21358,
-20533,
-19967,
-19654,
-19617,
-19836,
-20337,
-21103,
-22147,
-23457,
-24999,
-26763,
-28670,
-30682,
-32721,
-34717,
-36625,
-38384,
-39971,
-41363,
-42555,
-43536,
-44314,
-44879,
-45214,
-45322,
-45158,
-44742,
-44049,
-43092,
-41898,
-40482,
-38887,
-37152,
-35298,
-33383,
-31425,
-29478,
-27584,
-25794,
-24156,
-22717,
-21509,
-20558,
-19871,
-19450,
-19287,
-19383,
-19732,
-20335,
-21200,
-22316,
-23690,
-25285,
-27087,
-29024,
-31060,
-33113,
-35127,
-37040,
-38803,
-40383,
-41753,
-42913,
-43835,
-44543,
-45007,
-45242,
-45240,
-44990,
-44516,
-43794,
-42861,
-41694,
-40325,
-38740,
-36985,
-35059,
-33050,
-30988,
-28976,
-27070,
-25343,
-23830,
-22560,
-21529,
-20732,
-20168,
-19827,
-19737,
-19900,
-20342,
-21061,
-22052,
-23290,
-24745,
-26374,
-28149,
-30025,
-31981,
-33964,
-35930,
-37824,
-39571,
-41133,
-42447,
-43509,
-44311,
-44868,
-45215,
-45351,
-45302,
-45048,
-44577,
-43866,
-42897,
-41677,
-40209,
-38545,
-36712,
-34786,
-32809,
-30859,
-28965,
-27199,
-25572,
-24130,
-22876,
-21831,
-21000,
-20395,
-20030,
-19933,
-20107,
-20592,
-21367,
-22439,
-23778,
-25331,
-27063,
-28910,
-30828,
-32772,
-34697,
-36566,
-38345,
-39981,
-41453,
-42708,
-43735,
-44518,
-45051,
-45349,
-45417,
-45262,
-44890,
-44289,
-43460,
-42383,
-41078,
-39543,
-37818,
-35944,
-33968,
-31968,
-29982,
-28087,
-26319,
-24713,
-23311,
-22109,
-21142,
-20402,
-19909,
-19665,
-19686,
-19989,
-20583,
-21488,
-22697,
-24206,
-25988,
-27988,
-30144,
-32361,
-34550,
-36617,
-38488,
-40110,
-41455,
-42534,
-43338,
-43899,
-44205,
-44235,
-43982,
-43375,
-42425,
-41094,
-39431,
-37473,
-35310,
-33029,
-30731,
-28508,
-26437,
-24574,
-22974,
-21652,
-20636,
-19929,
-19536,
-19468,
-19738,
-20354,
-21343,
-22685,
-24375,
-26346,
-28530,
-30819,
-33114,
-35323,
-37374,
-39225,
-40855,
-42239,
-43380,
-44230,
-44782,
-44985,
-44835,
-44322,
-43474,
-42325,
-40921,
-39299,
-37498,
-35551,
-33491,
-31383,
-29282,
-27288,
-25481,
-23942,
-22723,
-21845,
-21314,
-21103,
-21205,
-21612,
-22319,
-23357,
-24708,
-26373,
-28292,
-30401,
-32592,
-34778,
-36850,
-38752,
-40430,
-41866,
-43055,
-43983,
-44649,
-45026,
-45086,
-44804,
-44158,
-43151,
-41813,
-40175,
-38319,
-36293,
-34185,
-32041,
-29935,
-27903,
-26008,
-24297,
-22825,
-21645,
-20792,
-20304,
-20171,
-20420,
-21003,
-21934,
-23165,
-24692,
-26475,
-28475,
-30639,
-32876,
-35112,
-37238,
-39185,
-40873,
-42277,
-43361,
-44146,
-44626,
-44812,
-44714,
-44305,
-43599,
-42564,
-41217,
-39575,
-37675,
-35583,
-33374,
-31128,
-28940,
-26880,
-25025,
-23416,
-22096,
-21087,
-20398,
-20055,
-20047,
-20404,
-21113,
-22182,
-23587,
-25291,
-27238,
-29353,
-31552,
-33747,
-35862,
-37828,
-39601,
-41151,
-42458,
-43507,
-44289,
-44777,
-44955,
-44796,
-44278,
-43403,
-42170,
-40627,
-38802,
-36781,
-34622,
-32403,
-30207,
-28085,
-26121,
-24349,
-22829,
-21595,
-20672,
-20101,
-19873,
-20024,
-20536,
-21415,
-22646,
-24193,
-26017,
-28064,
-30243,
-32495,
-34709,
-36827,
-38759,
-40470,
-41910,
-43068,
-43935,
-44501,
-44778,
-44757,
-44429,
-43791,
-42831,
-41556,
-39981,
-38152,
-36119,
-33970,
-31777,
-29640,
-27607,
-25769,
-24135,
-22759,
-21654,
-20856,
-20378,
-20269,
-20521,
-21167,
-22178,
-23534,
-25179,
-27065,
-29120,
-31278,
-33472,
-35620,
-37662,
-39518,
-41133,
-42468,
-43488,
-44212,
-44626,
-44767,
-44625,
-44197,
-43473,
-42414,
-41038,
-39339,
-37391,
-35250,
-33041,
-30829,
-28738,
-26803,
-25082,
-23599,
-22364,
-21404,
-20735,
-20391,
-20389,
-20756,
-21482,
-22571,
-23973,
-25675,
-27591,
-29682,
-31860,
-34043,
-36158,
-38119,
-39867,
-41369,
-42586,
-43531,
-44188,
-44560,
-44646,
-44411,
-43859,
-42960,
-41740,
-40213,
-38442,
-36480,
-34406,
-32283,
-30179,
-28153,
-26262,
-24561,
-23098,
-21925,
-21054,
-20536,
-20339,
-20498,
-20988,
-21822,
-22995,
-24499,
-26302,
-28353,
-30560,
-32827,
-35032,
-37097,
-38937,
-40532,
-41866,
-42940,
-43771,
-44326,
-44609,
-44565,
-44193,
-43476,
-42434,
-41095,
-39509,
-37715,
-35757,
-33685,
-31540,
-29404,
-27343,
-25452,
-23807,
-22462,
-21457,
-20778,
-20423,
-20379,
-20631,
-21221,
-22140,
-23430,
-25054,
-26978,
-29101,
-31325,
-33533,
-35638,
-37578,
-39318,
-40847,
-42160,
-43227,
-44045,
-44547,
-44731,
-44558,
-44026,
-43165,
-41977,
-40519,
-38807,
-36894,
-34817,
-32645,
-30436,
-28285,
-26261,
-24443,
-22886,
-21625,
-20684,
-20073,
-19803,
-19882,
-20324,
-21127,
-22294,
-23793,
-25582,
-27599,
-29756,
-31982,
-34175,
-36276,
-38205,
-39927,
-41401,
-42608,
-43539,
-44179,
-44531,
-44573,
-44308,
-43709,
-42782,
-41519,
-39951,
-38104,
-36046,
-33838,
-31587,
-29358,
-27267,
-25362,
-23716,
-22355,
-21296,
-20544,
-20096,
-19954,
-20144,
-20663,
-21561,
-22823,
-24440,
-26374,
-28523,
-30801,
-33080,
-35267,
-37271,
-39058,
-40596,
-41898,
-42959,
-43786,
-44362,
-44655,
-44635,
-44267,
-43534,
-42446,
-41026,
-39322,
-37404,
-35331,
-33184,
-31028,
-28923,
-26938,
-25114,
-23515,
-22177,
-21142,
-20447,
-20107,
-20150,
-20566,
-21361,
-22505,
-23974,
-25725,
-27687,
-29815,
-32010,
-34218,
-36348,
-38346,
-40146,
-41716,
-43015,
-44035,
-44748,
-45159,
-45245,
-45015,
-44451,
-43562,
-42357,
-40855,
-39101,
-37135,
-35036,
-32867,
-30718,
-28656,
-26753,
-25071,
-23635,
-22491,
-21647,
-21115,
-20922,
-21060,
-21554,
-22401,
-23586,
-25095,
-26868,
-28855,
-30969,
-33142,
-35283,
-37328,
-39215,
-40892,
-42334,
-43502,
-44393,
-44981,
-45266,
-45232,
-44873,
-44186,
-43170,
-41843,
-40227,
-38372,
-36326,
-34178,
-31984,
-29835,
-27798,
-25931,
-24291,
-22922,
-21842,
-21103,
-20692,
-20652,
-20952,
-21617,
-22608,
-23917,
-25505,
-27332,
-29340,
-31467,
-33623,
-35740,
-37722,
-39517,
-41061,
-42346,
-43346,
-44082,
-44539,
-44726,
-44609,
-44181,
-43402,
-42279,
-40820,
-39070,
-37099,
-34987,
-32816,
-30670,
-28600,
-26682,
-24924,
-23409,
-22120,
-21143,
-20462,
-20136,
-20162,
-20550,
-21302,
-22403,
-23820,
-25538,
-27475,
-29589,
-31779,
-33963,
-36058,
-37988,
-39705,
-41177,
-42388,
-43332,
-43998,
-44376,
-44449,
-44189,
-43599,
-42664,
-41415,
-39883,
-38108,
-36156,
-34083,
-31945,
-29826,
-27770,
-25864,
-24164,
-22721,
-21588,
-20774,
-20301,
-20169,
-20377,
-20937,
-21840,
-23097,
-24684,
-26572,
-28687,
-30956,
-33254,
-35509,
-37599,
-39498,
-41135,
-42520,
-43646,
-44504,
-45111,
-45411,
-45416,
-45057,
-44348,
-43261,
-41836,
-40105,
-38147,
-36024,
-33828,
-31629,
-29491,
-27486,
-25645,
-24034,
-22680,
-21630,
-20913,
-20551,
-20553,
-20922,
-21633,
-22677,
-24004,
-25605,
-27408,
-29406,
-31502,
-33667,
-35797,
-37832,
-39687,
-41299,
-42627,
-43641,
-44338,
-44724,
-44802,
-44582,
-44059,
-43220,
-42071,
-40604,
-38853,
-36858,
-34697,
-32447,
-30219,
-28087,
-26145,
-24439,
-23004,
-21860,
-21003,
-20439,
-20177,
-20229,
-20626,
-21389,
-22527,
-24035,
-25856,
-27934,
-30149,
-32412,
-34609,
-36665,
-38527,
-40167,
-41571,
-42740,
-43652,
-44303,
-44648,
-44674,
-44349,
-43680,
-42668,
-41354,
-39768,
-37957,
-35972,
-33860,
-31674,
-29494,
-27373,
-25405,
-23651,
-22179,
-21020,
-20220,
-19764,
-19681,
-19950,
-20590,
-21576,
-22913,
-24552,
-26454,
-28544,
-30738,
-32953,
-35100,
-37117,
-38947,
-40555,
-41921,
-43015,
-43842,
-44368,
-44594,
-44495,
-44059,
-43282,
-42164,
-40723,
-38997,
-37037,
-34913,
-32711,
-30510,
-28392,
-26416,
-24644,
-23098,
-21820,
-20826,
-20136,
-19787,
-19787,
-20171,
-20931,
-22070,
-23541,
-25300,
-27283,
-29399,
-31589,
-33757,
-35850,
-37807,
-39576,
-41127,
-42419,
-43436,
-44145,
-44542,
-44600,
-44331,
-43723,
-42795,
-41563,
-40053,
-38310,
-36372,
-34305,
-32167,
-30032,
-27975,
-26055,
-24354,
-22899,
-21751,
-20917,
-20421,
-20265,
-20451,
-20979,
-21838,
-23029,
-24520,
-26287,
-28276,
-30424,
-32649,
-34863,
-36975,
-38909,
-40599,
-42010,
-43117,
-43922,
-44432,
-44652,
-44591,
-44236,
-43586,
-42618,
-41348,
-39775,
-37949,
-35920,
-33753,
-31547,
-29362,
-27297,
-25420,
-23791,
-22483,
-21529,
-20982,
-20868,
-21199,
-21986,
-23199,
-24817,
-26763,
-28973,
-31329,
-33738,
-36065,
-38218,
-40104,
-41659,
-42854,
-43674,
-44121,
-44204,
-43920,
-43257,
-42227,
-40805,
-39052,
-36989,
-34730,
-32369,
-30028,
-27831,
-25856,
-24193,
-22865,
-21917,
-21352,
-21200,
-21470,
-22182,
-23332,
-24903,
-26834,
-29041,
-31404,
-33808,
-36115,
-38242,
-40099,
-41648,
-42867,
-43738,
-44257,
-44404,
-44160,
-43505,
-42437,
-40965,
-39150,
-37053,
-34786,
-32448,
-30150,
-27986,
-26028,
-24341,
-22964,
-21952,
-21324,
-21141,
-21407,
-22147,
-23347,
-24948,
-26896,
-29068,
-31370,
-33672,
-35890,
-37926,
-39741,
-41277,
-42531,
-43453,
-44047,
-44258,
-44067,
-43455,
-42399,
-40940,
-39113,
-37000,
-34704,
-32335,
-29996,
-27797,
-25801,
-24083,
-22681,
-21640,
-20991,
-20772,
-21009,
-21708,
-22877,
-24454,
-26391,
-28578,
-30899,
-33252,
-35516,
-37620,
-39496,
-41104,
-42413,
-43400,
-44027,
-44275,
-44102,
-43497,
-42459,
-41004,
-39199,
-37099,
-34815,
-32437,
-30069,
-27815,
-25751,
-23965,
-22514,
-21447,
-20805,
-20614,
-20870,
-21594,
-22733,
-24277,
-26146,
-28281,
-30575,
-32948,
-35272,
-37474,
-39449,
-41140,
-42496,
-43476,
-44075,
-44259,
-44049,
-43414,
-42387,
-40964,
-39209,
-37152,
-34911,
-32542,
-30189,
-27932,
-25874,
-24102,
-22653,
-21603,
-20948,
-20743,
-20985,
-21686,
-22836,
-24396,
-26313,
-28493,
-30826,
-33202,
-35495,
-37632,
-39524,
-41141,
-42445,
-43416,
-44036,
-44276,
-44117,
-43542,
-42546,
-41163,
-39429,
-37422,
-35223,
-32923,
-30624,
-28406,
-26370,
-24585,
-23128,
-22055,
-21407,
-21211,
-21469,
-22173,
-23292,
-24791,
-26613,
-28694,
-30949,
-33285,
-35600,
-37782,
-39755,
-41424,
-42762,
-43725,
-44307,
-44509,
-44315,
-43734,
-42754,
-41390,
-39670,
-37652,
-35423,
-33078,
-30746,
-28510,
-26483,
-24725,
-23287,
-22216,
-21534,
-21273,
-21451,
-22083,
-23157,
-24651,
-26491,
-28599,
-30865,
-33171,
-35417,
-37499,
-39366,
-40954,
-42251,
-43221,
-43855,
-44123,
-43997,
-43457,
-42489,
-41109,
-39354,
-37305,
-35039,
-32684,
-30328,
-28087,
-26033,
-24241,
-22763,
-21648,
-20928,
-20650,
-20814,
-21451,
-22527,
-24018,
-25854,
-27953,
-30219,
-32544,
-34831,
-36980,
-38916,
-40574,
-41901,
-42873,
-43456,
-43649,
-43431,
-42812,
-41791,
-40395,
-38659,
-36647,
-34442,
-32141,
-29848,
-27663,
-25667,
-23927,
-22490,
-21381,
-20639,
-20277,
-20329,
-20825,
-21759,
-23141,
-24907,
-27000,
-29303,
-31705,
-34080,
-36319,
-38335,
-40054,
-41446,
-42476,
-43145,
-43430,
-43336,
-42848,
-41968,
-40705,
-39078,
-37143,
-34964,
-32647,
-30290,
-28024,
-25936,
-24137,
-22670,
-21603,
-20936,
-20711,
-20908,
-21559,
-22634,
-24120,
-25970,
-28098,
-30419,
-32803,
-35145,
-37333,
-39298,
-40969,
-42336,
-43354,
-44028,
-44325,
-44226,
-43710,
-42764,
-41398,
-39653,
-37597,
-35334,
-32969,
-30629,
-28404,
-26384,
-24631,
-23171,
-22047,
-21274,
-20880,
-20906,
-21368,
-22290,
-23658,
-25425,
-27514,
-29809,
-32202,
-34555,
-36780,
-38782,
-40512,
-41935,
-43018,
-43747,
-44089,
-44026,
-43539,
-42612,
-41279,
-39561,
-37539,
-35296,
-32928,
-30551,
-28248,
-26120,
-24233,
-22655,
-21427,
-20605,
-20212,
-20290,
-20849,
-21884,
-23372,
-25242,
-27416,
-29771,
-32188,
-34552,
-36755,
-38733,
-40427,
-41814,
-42884,
-43610,
-43991,
-43972,
-43554,
-42691,
-41407,
-39726,
-37706,
-35463,
-33079,
-30697,
-28400,
-26282,
-24414,
-22833,
-21608,
-20750,
-20333,
-20361,
-20891,
-21893,
-23361,
-25206,
-27353,
-29670,
-32051,
-34382,
-36575,
-38564,
-40301,
-41749,
-42882,
-43662,
-44071,
-44055,
-43622,
-42731,
-41423,
-39729,
-37718,
-35491,
-33153,
-30810,
-28580,
-26536,
-24746,
-23262,
-22104,
-21308,
-20893,
-20899,
-21340,
-22246,
-23597,
-25352,
-27441,
-29747,
-32154,
-34535,
-36791,
-38829,
-40610,
-42078,
-43220,
-43997,
-44386,
-44357,
-43889,
-42974,
-41648,
-39943,
-37958,
-35764,
-33482,
-31193,
-28989,
-26951,
-25122,
-23582,
-22358,
-21507,
-21071,
-21077,
-21542,
-22471,
-23824,
-25557,
-27590,
-29819,
-32154,
-34474,
-36696,
-38730,
-40522,
-42016,
-43190,
-43996,
-44437,
-44452,
-44055,
-43207,
-41941,
-40284,
-38309,
-36107,
-33788,
-31459,
-29229,
-27167,
-25347,
-23805,
-22588,
-21730,
-21273,
-21256,
-21704,
-22631,
-24007,
-25775,
-27856,
-30128,
-32492,
-34826,
-37037,
-39043,
-40783,
-42209,
-43304,
-44031,
-44405,
-44386,
-43993,
-43208,
-42032,
-40484,
-38601,
-36446,
-34131,
-31757,
-29467,
-27359,
-25525,
-24014,
-22849,
-22043,
-21600,
-21551,
-21915,
-22736,
-24007,
-25713,
-27773,
-30070,
-32474,
-34835,
-37050,
-39030,
-40737,
-42140,
-43240,
-44004,
-44421,
-44446,
-44056,
-43241,
-42007,
-40403,
-38488,
-36345,
-34068,
-31753,
-29490,
-27382,
-25491,
-23911,
-22673,
-21840,
-21412,
-21425,
-21852,
-22719,
-23978,
-25630,
-27592,
-29807,
-32152,
-34515,
-36773,
-38816,
-40572,
-41990,
-43065,
-43784,
-44170,
-44198,
-43872,
-43152,
-42047,
-40541,
-38696,
-36570,
-34270,
-31914,
-29608,
-27457,
-25541,
-23911,
-22616,
-21690,
-21161,
-21063,
-21419,
-22238,
-23510,
-25189,
-27205,
-29460,
-31841,
-34226,
-36509,
-38589,
-40404,
-41892,
-43045,
-43816,
-44231,
-44239,
-43862,
-43073,
-41873,
-40296,
-38371,
-36192,
-33842,
-31449,
-29114,
-26947,
-25018,
-23386,
-22091,
-21163,
-20632,
-20535,
-20897,
-21743,
-23049,
-24779,
-26840,
-29124,
-31506,
-33869,
-36111,
-38166,
-39974,
-41511,
-42727,
-43609,
-44097,
-44182,
-43817,
-43024,
-41802,
-40211,
-38301,
-36152,
-33856,
-31497,
-29182,
-27001,
-25048,
-23394,
-22103,
-21204,
-20726,
-20674,
-21051,
-21858,
-23085,
-24710,
-26675,
-28910,
-31285,
-33691,
-35982,
-38072,
-39872,
-41358,
-42519,
-43355,
-43863,
-44025,
-43789,
-43141,
-42034,
-40500,
-38577,
-36372,
-33993,
-31582,
-29245,
-27092,
-25186,
-23583,
-22321,
-21431,
-20941,
-20888,
-21267,
-22104,
-23356,
-24993,
-26942,
-29121,
-31425,
-33765,
-36022,
-38119,
-39966,
-41520,
-42727,
-43587,
-44070,
-44188,
-43928,
-43279,
-42243,
-40821,
-39046,
-36974,
-34694,
-32309,
-29953,
-27724,
-25737,
-24052,
-22734,
-21798,
-21285,
-21197,
-21554,
-22355,
-23586,
-25198,
-27143,
-29303,
-31600,
-33902,
-36132,
-38192,
-40029,
-41591,
-42840,
-43753,
-44285,
-44428,
-44147,
-43446,
-42327,
-40826,
-38983,
-36882,
-34602,
-32252,
-29936,
-27759,
-25807,
-24160,
-22851,
-21920,
-21371,
-21221,
-21485,
-22163,
-23283,
-24809,
-26720,
-28915,
-31288,
-33697,
-36012,
-38114,
-39937,
-41421,
-42574,
-43347,
-43764,
-43746,
-43287,
-42329,
-40880,
-38983,
-36726,
-34248,
-31699,
-29230,
-26971,
-25015,
-23436,
-22280,
-21591,
-21400,
-21746,
-22620,
-24021,
-25866,
-28070,
-30484,
-32966,
-35372,
-37568,
-39478,
-41011,
-42150,
-42846,
-43100,
-42870,
-42172,
-40986,
-39358,
-37336,
-35013,
-32504,
-29950,
-27483,
-25250,
-23356,
-21903,
-20959,
-20560,
-20735,
-21466,
-22717,
-24431,
-26499,
-28831,
-31280,
-33739,
-36079,
-38216,
-40054,
-41544,
-42616,
-43234,
-43360,
-42957,
-42045,
-40632,
-38792,
-36619,
-34217,
-31733,
-29290,
-27009,
-25017,
-23396,
-22232,
-21600,
-21519,
-22027,
-23090,
-24659,
-26651,
-28949,
-31425,
-33951,
-36387,
-38635,
-40589,
-42181,
-43355,
-44058,
-44281,
-43986,
-43210,
-41939,
-40257,
-38203,
-35896,
-33431,
-30935,
-28534,
-26340,
-24469,
-23012,
-22036,
-21609,
-21742,
-22447,
-23683,
-25384,
-27459,
-29780,
-32227,
-34662,
-36974,
-39058,
-40839,
-42240,
-43231,
-43741,
-43767,
-43271,
-42260,
-40779,
-38863,
-36637,
-34193,
-31679,
-29227,
-26956,
-24974,
-23365,
-22191,
-21496,
-21331,
-21702,
-22631,
-24094,
-26017,
-28321,
-30835,
-33423,
-35900,
-38144,
-40050,
-41569,
-42679,
-43377,
-43645,
-43464,
-42787,
-41607,
-39913,
-37800,
-35356,
-32780,
-30215,
-27846,
-25762,
-24054,
-22738,
-21849,
-21408,
-21463,
-22057,
-23219,
-24911,
-27075,
-29541,
-32152,
-34723,
-37091,
-39170,
-40876,
-42202,
-43111,
-43592,
-43603,
-43111,
-42101,
-40588,
-38639,
-36360,
-33886,
-31359,
-28918,
-26675,
-24726,
-23143,
-21994,
-21332,
-21204,
-21633,
-22620,
-24118,
-26055,
-28315,
-30768,
-33274,
-35702,
-37937,
-39892,
-41501,
-42700,
-43455,
-43712,
-43451,
-42659,
-41351,
-39591,
-37461,
-35098,
-32622,
-30188,
-27889,
-25836,
-24091,
-22717,
-21782,
-21334,
-21434,
-22115,
-23360,
-25124,
-27288,
-29710,
-32236,
-34707,
-37017,
-39069,
-40809,
-42193,
-43170,
-43698,
-43717,
-43200,
-42134,
-40567,
-38578,
-36288,
-33840,
-31368,
-28999,
-26828,
-24947,
-23404,
-22294,
-21644,
-21536,
-21984,
-22996,
-24530,
-26497,
-28775,
-31212,
-33669,
-35999,
-38115,
-39927,
-41400,
-42498,
-43185,
-43440,
-43220,
-42504,
-41288,
-39609,
-37526,
-35178,
-32676,
-30190,
-27851,
-25771,
-24055,
-22743,
-21903,
-21543,
-21703,
-22390,
-23591,
-25280,
-27368,
-29754,
-32289,
-34816,
-37185,
-39264,
-40965,
-42228,
-43040,
-43390,
-43295,
-42750,
-41767,
-40347,
-38528,
-36361,
-33951,
-31430,
-28946,
-26661,
-24703,
-23171,
-22139,
-21621,
-21639,
-22171,
-23206,
-24692,
-26585,
-28776,
-31170,
-33618,
-35989,
-38170,
-40043,
-41571,
-42670,
-43350,
-43543,
-43266,
-42463,
-41181,
-39425,
-37304,
-34911,
-32406,
-29921,
-27597,
-25548,
-23844,
-22569,
-21747,
-21435,
-21649,
-22408,
-23697,
-25465,
-27620,
-30040,
-32567,
-35055,
-37360,
-39369,
-41011,
-42241,
-43037,
-43396,
-43300,
-42740,
-41718,
-40232,
-38340,
-36108,
-33669,
-31150,
-28719,
-26486,
-24578,
-23059,
-21979,
-21390,
-21294,
-21751,
-22738,
-24255,
-26225,
-28533,
-31037,
-33559,
-35960,
-38110,
-39936,
-41408,
-42481,
-43165,
-43393,
-43149,
-42379,
-41089,
-39309,
-37140,
-34703,
-32170,
-29672,
-27359,
-25310,
-23605,
-22300,
-21441,
-21087,
-21278,
-22040,
-23359,
-25180,
-27382,
-29835,
-32362,
-34826,
-37088,
-39059,
-40693,
-41931,
-42785,
-43193,
-43167,
-42641,
-41639,
-40135,
-38211,
-35932,
-33445,
-30883,
-28407,
-26144,
-24205,
-22676,
-21601,
-21030,
-20987,
-21485,
-22531,
-24086,
-26078,
-28412,
-30929,
-33496,
-35954,
-38189,
-40106,
-41643,
-42757,
-43405,
-43571,
-43210,
-42341,
-40957,
-39144,
-36973,
-34585,
-32108,
-29680,
-27410,
-25406,
-23730,
-22467,
-21657,
-21364,
-21612,
-22417,
-23750,
-25553,
-27717,
-30125,
-32626,
-35095,
-37408,
-39468,
-41202,
-42552,
-43465,
-43909,
-43842,
-43253,
-42139,
-40545,
-38538,
-36233,
-33765,
-31274,
-28902,
-26770,
-24965,
-23563,
-22604,
-22130,
-22155,
-22710,
-23770,
-25319,
-27286,
-29563,
-32026,
-34527,
-36917,
-39089,
-40928,
-42386,
-43412,
-43987,
-44086,
-43710,
-42840,
-41509,
-39748,
-37627,
-35272,
-32781,
-30325,
-28013,
-25974,
-24304,
-23057,
-22302,
-22045,
-22333,
-23145,
-24480,
-26270,
-28440,
-30850,
-33364,
-35820,
-38085,
-40049,
-41656,
-42859,
-43651,
-44016,
-43930,
-43364,
-42310,
-40754,
-38770,
-36442,
-33919,
-31370,
-28937,
-26776,
-24946,
-23545,
-22566,
-22078,
-22073,
-22593,
-23641,
-25175,
-27139,
-29406,
-31830,
-34268,
-36569,
-38642,
-40407,
-41822,
-42857,
-43472,
-43645,
-43319,
-42494,
-41163,
-39379,
-37230,
-34826,
-32314,
-29816,
-27473,
-25378,
-23642,
-22334,
-21524,
-21268,
-21581,
-22468,
-23881,
-25740,
-27930,
-30317,
-32768,
-35144,
-37347,
-39289,
-40900,
-42142,
-42963,
-43319,
-43188,
-42535,
-41372,
-39737,
-37699,
-35375,
-32885,
-30376,
-27960,
-25764,
-23867,
-22352,
-21294,
-20739,
-20750,
-21342,
-22510,
-24205,
-26324,
-28745,
-31310,
-33877,
-36309,
-38500,
-40378,
-41869,
-42940,
-43544,
-43652,
-43256,
-42353,
-40990,
-39232,
-37164,
-34912,
-32567,
-30255,
-28066,
-26092,
-24425,
-23143,
-22327,
-22049,
-22343,
-23228,
-24652,
-26539,
-28759,
-31169,
-33617,
-35972,
-38128,
-40010,
-41573,
-42761,
-43560,
-43898,
-43759,
-43102,
-41922,
-40274,
-38220,
-35887,
-33412,
-30927,
-28570,
-26430,
-24601,
-23144,
-22123,
-21594,
-21600,
-22174,
-23303,
-24945,
-26999,
-29340,
-31818,
-34285,
-36616,
-38711,
-40499,
-41933,
-42965,
-43565,
-43681,
-43288,
-42364,
-40925,
-39030,
-36782,
-34309,
-31776,
-29308,
-27054,
-25090,
-23495,
-22309,
-21565,
-21311,
-21561,
-22365,
-23681,
-25510,
-27714,
-30195,
-32771,
-35289,
-37612,
-39627,
-41271,
-42501,
-43285,
-43598,
-43415,
-42710,
-41500,
-39806,
-37729,
-35370,
-32890,
-30407,
-28067,
-25946,
-24138,
-22683,
-21653,
-21091,
-21060,
-21602,
-22708,
-24361,
-26450,
-28852,
-31413,
-33959,
-36370,
-38520,
-40345,
-41795,
-42824,
-43408,
-43513,
-43100,
-42173,
-40726,
-38831,
-36573,
-34088,
-31519,
-29025,
-26717,
-24731,
-23105,
-21932,
-21221,
-21028,
-21364,
-22249,
-23654,
-25532,
-27769,
-30245,
-32786,
-35264,
-37532,
-39511,
-41129,
-42349,
-43143,
-43472,
-43317,
-42636,
-41451,
-39778,
-37705,
-35350,
-32834,
-30332,
-27936,
-25798,
-23972,
-22557,
-21605,
-21168,
-21288,
-21981,
-23211,
-24944,
-27038,
-29400,
-31854,
-34286,
-36565,
-38607,
-40350,
-41748,
-42751,
-43341,
-43444,
-43064,
-42144,
-40736,
-38859,
-36647,
-34193,
-31679,
-29233,
-26993,
-25069,
-23517,
-22412,
-21767,
-21626,
-21992,
-22884,
-24265,
-26097,
-28273,
-30677,
-33169,
-35597,
-37839,
-39784,
-41345,
-42462,
-43072,
-43136,
-42618,
-41519,
-39868,
-37752,
-35294,
-32662,
-30044,
-27603,
-25521,
-23891,
-22823,
-22350,
-22492,
-23242,
-24549,
-26344,
-28530,
-30969,
-33517,
-36027,
-38330,
-40320,
-41857,
-42885,
-43328,
-43171,
-42416,
-41088,
-39271,
-37050,
-34566,
-31968,
-29415,
-27080,
-25096,
-23602,
-22680,
-22386,
-22735,
-23699,
-25215,
-27179,
-29475,
-31951,
-34472,
-36885,
-39065,
-40879,
-42252,
-43075,
-43326,
-42955,
-41989,
-40458,
-38462,
-36106,
-33550,
-30955,
-28486,
-26306,
-24540,
-23299,
-22646,
-22618,
-23211,
-24391,
-26091,
-28211,
-30618,
-33177,
-35707,
-38078,
-40121,
-41741,
-42841,
-43372,
-43312,
-42672,
-41480,
-39801,
-37710,
-35328,
-32779,
-30219,
-27806,
-25691,
-24011,
-22871,
-22344,
-22462,
-23221,
-24575,
-26436,
-28690,
-31191,
-33776,
-36290,
-38574,
-40502,
-41971,
-42915,
-43275,
-43058,
-42233,
-40871,
-38995,
-36737,
-34195,
-31555,
-28962,
-26609,
-24623,
-23145,
-22244,
-21974,
-22352,
-23349,
-24924,
-26976,
-29387,
-32001,
-34641,
-37140,
-39333,
-41104,
-42361,
-43065,
-43183,
-42740,
-41728,
-40204,
-38206,
-35835,
-33214,
-30512,
-27913,
-25606,
-23758,
-22494,
-21884,
-21945,
-22651,
-23934,
-25705,
-27865,
-30288,
-32840,
-35393,
-37772,
-39871,
-41529,
-42678,
-43226,
-43168,
-42497,
-41257,
-39516,
-37355,
-34906,
-32279,
-29662,
-27185,
-25047,
-23370,
-22285,
-21867,
-22126,
-23056,
-24566,
-26560,
-28905,
-31449,
-34052,
-36558,
-38829,
-40741,
-42184,
-43076,
-43367,
-43033,
-42094,
-40600,
-38637,
-36327,
-33797,
-31210,
-28720,
-26475,
-24619,
-23259,
-22471,
-22316,
-22783,
-23863,
-25477,
-27543,
-29927,
-32490,
-35073,
-37510,
-39665,
-41395,
-42623,
-43274,
-43335,
-42808,
-41727,
-40159,
-38173,
-35873,
-33381,
-30835,
-28393,
-26213,
-24446,
-23208,
-22600,
-22637,
-23338,
-24619,
-26427,
-28613,
-31072,
-33642,
-36178,
-38533,
-40559,
-42131,
-43164,
-43582,
-43382,
-42566,
-41204,
-39369,
-37177,
-34741,
-32208,
-29707,
-27401,
-25415,
-23884,
-22902,
-22535,
-22806,
-23695,
-25146,
-27060,
-29324,
-31796,
-34330,
-36774,
-38992,
-40841,
-42235,
-43071,
-43326,
-42966,
-42015,
-40520,
-38543,
-36201,
-33611,
-30935,
-28349,
-26016,
-24121,
-22764,
-22060,
-21999,
-22593,
-23745,
-25385,
-27399,
-29669,
-32102,
-34552,
-36911,
-39034,
-40785,
-42048,
-42729,
-42782,
-42203,
-41036,
-39353,
-37253,
-34863,
-32283,
-29691,
-27188,
-24981,
-23171,
-21944,
-21346,
-21459,
-22240,
-23634,
-25530,
-27782,
-30265,
-32817,
-35319,
-37623,
-39609,
-41154,
-42150,
-42536,
-42268,
-41383,
-39918,
-37999,
-35716,
-33230,
-30652,
-28126,
-25781,
-23754,
-22175,
-21157,
-20791,
-21113,
-22121,
-23743,
-25870,
-28352,
-31031,
-33731,
-36299,
-38586,
-40465,
-41833,
-42625,
-42781,
-42325,
-41267,
-39696,
-37710,
-35421,
-32980,
-30509,
-28155,
-26058,
-24326,
-23099,
-22427,
-22392,
-22986,
-24182,
-25912,
-28054,
-30488,
-33052,
-35601,
-37976,
-40044,
-41680,
-42783,
-43296,
-43179,
-42444,
-41140,
-39331,
-37146,
-34685,
-32114,
-29555,
-27173,
-25092,
-23450,
-22343,
-21855,
-22010,
-22819,
-24219,
-26128,
-28411,
-30924,
-33496,
-35984,
-38224,
-40120,
-41554,
-42484,
-42844,
-42629,
-41830,
-40474,
-38619,
-36348,
-33793,
-31109,
-28475,
-26074,
-24073,
-22605,
-21760,
-21576,
-22059,
-23148,
-24788,
-26860,
-29251,
-31824,
-34422,
-36893,
-39093,
-40892,
-42186,
-42917,
-43046,
-42567,
-41527,
-39942,
-37918,
-35529,
-32914,
-30229,
-27641,
-25334,
-23476,
-22194,
-21587,
-21666,
-22419,
-23769,
-25601,
-27811,
-30236,
-32774,
-35261,
-37594,
-39626,
-41256,
-42378,
-42914,
-42832,
-42117,
-40821,
-39016,
-36816,
-34358,
-31785,
-29260,
-26916,
-24904,
-23328,
-22297,
-21873,
-22092,
-22948,
-24393,
-26337,
-28657,
-31207,
-33817,
-36338,
-38610,
-40516,
-41949,
-42843,
-43146,
-42850,
-41953,
-40516,
-38589,
-36298,
-33755,
-31121,
-28565,
-26231,
-24298,
-22858,
-22041,
-21863,
-22363,
-23488,
-25175,
-27314,
-29768,
-32380,
-35000,
-37453,
-39606,
-41327,
-42525,
-43144,
-43155,
-42575,
-41438,
-39822,
-37800,
-35494,
-33005,
-30485,
-28062,
-25889,
-24114,
-22849,
-22214,
-22234,
-22941,
-24263,
-26124,
-28372,
-30876,
-33450,
-35968,
-38264,
-40242,
-41780,
-42818,
-43290,
-43165,
-42450,
-41159,
-39371,
-37173,
-34699,
-32094,
-29527,
-27153,
-25131,
-23583,
-22609,
-22266,
-22578,
-23514,
-25020,
-26997,
-29321,
-31851,
-34436,
-36918,
-39160,
-41027,
-42417,
-43258,
-43492,
-43124,
-42154,
-40648,
-38686,
-36371,
-33859,
-31274,
-28804,
-26570,
-24746,
-23413,
-22680,
-22574,
-23109,
-24247,
-25917,
-28019,
-30419,
-32978,
-35531,
-37936,
-40039,
-41728,
-42897,
-43483,
-43454,
-42813,
-41596,
-39875,
-37754,
-35353,
-32823,
-30307,
-27955,
-25910,
-24283,
-23178,
-22657,
-22753,
-23475,
-24780,
-26594,
-28818,
-31302,
-33896,
-36435,
-38753,
-40717,
-42214,
-43164,
-43527,
-43291,
-42475,
-41123,
-39305,
-37110,
-34664,
-32086,
-29556,
-27211,
-25215,
-23714,
-22778,
-22513,
-22876,
-23890,
-25433,
-27438,
-29760,
-32262,
-34809,
-37244,
-39431,
-41241,
-42564,
-43310,
-43452,
-42958,
-41889,
-40294,
-38283,
-35968,
-33476,
-30939,
-28491,
-26272,
-24406,
-23033,
-22242,
-22123,
-22692,
-23928,
-25740,
-28001,
-30534,
-33162,
-35709,
-38029,
-39995,
-41533,
-42572,
-43082,
-43035,
-42415,
-41247,
-39541,
-37407,
-34919,
-32261,
-29594,
-27101,
-24971,
-23325,
-22288,
-21886,
-22150,
-23020,
-24454,
-26343,
-28589,
-31062,
-33621,
-36125,
-38421,
-40368,
-41857,
-42784,
-43109,
-42807,
-41902,
-40451,
-38529,
-36249,
-33727,
-31118,
-28561,
-26229,
-24256,
-22782,
-21900,
-21675,
-22114,
-23193,
-24828,
-26921,
-29330,
-31913,
-34508,
-36973,
-39160,
-40955,
-42247,
-42974,
-43087,
-42579,
-41479,
-39841,
-37776,
-35385,
-32833,
-30250,
-27809,
-25638,
-23879,
-22626,
-21972,
-21954,
-22589,
-23846,
-25645,
-27887,
-30397,
-33036,
-35606,
-37958,
-39954,
-41486,
-42485,
-42922,
-42775,
-42064,
-40822,
-39110,
-37005,
-34633,
-32108,
-29606,
-27262,
-25238,
-23663,
-22625,
-22213,
-22427,
-23281,
-24706,
-26630,
-28926,
-31454,
-34058,
-36569,
-38844,
-40744,
-42168,
-43044,
-43331,
-43017,
-42126,
-40692,
-38800,
-36530,
-34029,
-31418,
-28883,
-26566,
-24641,
-23225,
-22429,
-22294,
-22839,
-24011,
-25733,
-27885,
-30313,
-32877,
-35398,
-37749,
-39790,
-41420,
-42557,
-43148,
-43157,
-42593,
-41463,
-39836,
-37786,
-35431,
-32907,
-30364,
-27955,
-25832,
-24122,
-22934,
-22345,
-22398,
-23104,
-24422,
-26285,
-28562,
-31106,
-33734,
-36258,
-38512,
-40336,
-41629,
-42313,
-42350,
-41745,
-40524,
-38751,
-36526,
-33985,
-31302,
-28686,
-26335,
-24458,
-23196,
-22659,
-22878,
-23815,
-25395,
-27471,
-29902,
-32495,
-35087,
-37482,
-39527,
-41070,
-42009,
-42277,
-41861,
-40794,
-39143,
-37034,
-34576,
-31959,
-29322,
-26880,
-24792,
-23251,
-22380,
-22282,
-22970,
-24391,
-26435,
-28907,
-31616,
-34341,
-36869,
-39045,
-40710,
-41781,
-42187,
-41912,
-40968,
-39410,
-37339,
-34871,
-32189,
-29458,
-26891,
-24666,
-22961,
-21908,
-21595,
-22055,
-23250,
-25103,
-27456,
-30148,
-32954,
-35687,
-38129,
-40130,
-41538,
-42276,
-42304,
-41619,
-40299,
-38422,
-36135,
-33594,
-30983,
-28477,
-26274,
-24525,
-23366,
-22914,
-23183,
-24198,
-25868,
-28084,
-30668,
-33432,
-36159,
-38646,
-40724,
-42238,
-43106,
-43278,
-42739,
-41558,
-39778,
-37545,
-34978,
-32257,
-29573,
-27114,
-25073,
-23616,
-22854,
-22859,
-23624,
-25073,
-27101,
-29517,
-32161,
-34817,
-37310,
-39470,
-41154,
-42251,
-42688,
-42418,
-41467,
-39872,
-37759,
-35259,
-32570,
-29878,
-27389,
-25291,
-23728,
-22824,
-22634,
-23167,
-24393,
-26206,
-28494,
-31080,
-33787,
-36420,
-38785,
-40725,
-42080,
-42768,
-42724,
-41956,
-40515,
-38506,
-36073,
-33393,
-30656,
-28068,
-25804,
-24046,
-22910,
-22491,
-22822,
-23871,
-25569,
-27769,
-30317,
-32999,
-35642,
-38035,
-40042,
-41518,
-42379,
-42579,
-42086,
-40938,
-39183,
-36928,
-34325,
-31540,
-28804,
-26307,
-24278,
-22865,
-22196,
-22315,
-23209,
-24786,
-26925,
-29430,
-32139,
-34826,
-37337,
-39489,
-41161,
-42243,
-42667,
-42392,
-41425,
-39819,
-37662,
-35116,
-32350,
-29592,
-27052,
-24938,
-23412,
-22591,
-22521,
-23188,
-24531,
-26432,
-28748,
-31313,
-33948,
-36473,
-38728,
-40548,
-41822,
-42451,
-42393,
-41642,
-40241,
-38283,
-35886,
-33231,
-30487,
-27876,
-25581,
-23800,
-22659,
-22267,
-22643,
-23755,
-25512,
-27761,
-30329,
-33022,
-35638,
-38013,
-39980,
-41430,
-42271,
-42450,
-41958,
-40810,
-39078,
-36853,
-34298,
-31568,
-28892,
-26462,
-24495,
-23148,
-22546,
-22737,
-23704,
-25357,
-27555,
-30106,
-32805,
-35454,
-37847,
-39851,
-41328,
-42213,
-42460,
-42058,
-41036,
-39430,
-37343,
-34877,
-32204,
-29509,
-27002,
-24895,
-23366,
-22559,
-22521,
-23269,
-24699,
-26705,
-29096,
-31713,
-34344,
-36839,
-39013,
-40739,
-41898,
-42399,
-42220,
-41343,
-39854,
-37834,
-35443,
-32850,
-30229,
-27778,
-25655,
-24024,
-23003,
-22678,
-23090,
-24212,
-25981,
-28247,
-30853,
-33579,
-36224,
-38581,
-40493,
-41824,
-42501,
-42487,
-41789,
-40462,
-38591,
-36298,
-33730,
-31074,
-28497,
-26214,
-24367,
-23126,
-22571,
-22761,
-23678,
-25253,
-27371,
-29861,
-32543,
-35208,
-37656,
-39719,
-41238,
-42129,
-42325,
-41828,
-40681,
-38959,
-36798,
-34327,
-31732,
-29180,
-26861,
-24941,
-23567,
-22847,
-22845,
-23568,
-24967,
-26948,
-29344,
-32002,
-34681,
-37212,
-39372,
-41032,
-42056,
-42403,
-42047,
-41049,
-39467,
-37439,
-35067,
-32522,
-29955,
-27527,
-25433,
-23803,
-22809,
-22518,
-22990,
-24183,
-25999,
-28297,
-30871,
-33532,
-36072,
-38322,
-40132,
-41402,
-42040,
-42022,
-41329,
-40002,
-38118,
-35794,
-33189,
-30496,
-27907,
-25631,
-23840,
-22672,
-22226,
-22523,
-23552,
-25226,
-27417,
-29970,
-32681,
-35366,
-37824,
-39886,
-41403,
-42282,
-42443,
-41906,
-40671,
-38863,
-36566,
-33975,
-31242,
-28581,
-26175,
-24196,
-22814,
-22109,
-22169,
-22971,
-24468,
-26542,
-29028,
-31742,
-34470,
-37020,
-39205,
-40886,
-41948,
-42335,
-42014,
-41015,
-39400,
-37266,
-34765,
-32064,
-29352,
-26852,
-24729,
-23180,
-22300,
-22181,
-22808,
-24137,
-26057,
-28413,
-31039,
-33741,
-36343,
-38670,
-40575,
-41922,
-42629,
-42623,
-41907,
-40507,
-38517,
-36088,
-33379,
-30621,
-27997,
-25727,
-23970,
-22862,
-22489,
-22869,
-23985,
-25740,
-28001,
-30593,
-33309,
-35951,
-38328,
-40287,
-41714,
-42528,
-42701,
-42211,
-41094,
-39388,
-37193,
-34631,
-31891,
-29173,
-26716,
-24727,
-23389,
-22809,
-23033,
-24015,
-25665,
-27826,
-30334,
-32996,
-35635,
-38083,
-40167,
-41777,
-42781,
-43127,
-42782,
-41761,
-40143,
-38028,
-35568,
-32939,
-30316,
-27906,
-25864,
-24357,
-23499,
-23358,
-23960,
-25261,
-27164,
-29527,
-32152,
-34849,
-37390,
-39608,
-41336,
-42470,
-42958,
-42762,
-41923,
-40469,
-38500,
-36112,
-33466,
-30732,
-28122,
-25852,
-24113,
-23066,
-22796,
-23320,
-24575,
-26442,
-28753,
-31328,
-33987,
-36539,
-38844,
-40733,
-42102,
-42838,
-42894,
-42247,
-40940,
-39060,
-36738,
-34143,
-31456,
-28863,
-26550,
-24679,
-23384,
-22784,
-22913,
-23801,
-25367,
-27512,
-30057,
-32805,
-35525,
-38029,
-40106,
-41650,
-42527,
-42735,
-42230,
-41089,
-39356,
-37158,
-34620,
-31913,
-29219,
-26737,
-24650,
-23131,
-22295,
-22222,
-22907,
-24305,
-26295,
-28727,
-31407,
-34144,
-36726,
-38982,
-40737,
-41883,
-42326,
-42052,
-41070,
-39465,
-37337,
-34850,
-32164,
-29470,
-26956,
-24791,
-23157,
-22151,
-21900,
-22401,
-23655,
-25559,
-27967,
-30700,
-33535,
-36261,
-38683,
-40623,
-41967,
-42620,
-42561,
-41791,
-40386,
-38430,
-36082,
-33505,
-30890,
-28437,
-26315,
-24685,
-23654,
-23289,
-23612,
-24595,
-26174,
-28248,
-30680,
-33306,
-35946,
-38408,
-40498,
-42060,
-42959,
-43126,
-42552,
-41286,
-39427,
-37140,
-34566,
-31918,
-29350,
-27041,
-25148,
-23790,
-23078,
-23071,
-23787,
-25178,
-27165,
-29572,
-32239,
-34943,
-37476,
-39667,
-41350,
-42423,
-42823,
-42519,
-41537,
-39938,
-37815,
-35322,
-32609,
-29901,
-27373,
-25247,
-23674,
-22778,
-22634,
-23217,
-24506,
-26352,
-28649,
-31194,
-33833,
-36370,
-38643,
-40503,
-41810,
-42480,
-42445,
-41697,
-40277,
-38277,
-35840,
-33150,
-30411,
-27830,
-25611,
-23893,
-22823,
-22442,
-22790,
-23827,
-25490,
-27664,
-30199,
-32928,
-35635,
-38139,
-40233,
-41764,
-42622,
-42745,
-42140,
-40860,
-39002,
-36696,
-34097,
-31374,
-28714,
-26307,
-24331,
-22959,
-22294,
-22413,
-23297,
-24873,
-27003,
-29505,
-32186,
-34850,
-37314,
-39435,
-41065,
-42120,
-42513,
-42210,
-41213,
-39567,
-37384,
-34798,
-32016,
-29231,
-26670,
-24529,
-22978,
-22144,
-22083,
-22801,
-24226,
-26231,
-28653,
-31287,
-33945,
-36447,
-38636,
-40394,
-41617,
-42236,
-42189,
-41457,
-40059,
-38059,
-35605,
-32865,
-30084,
-27474,
-25254,
-23591,
-22584,
-22309,
-22749,
-23891,
-25643,
-27899,
-30495,
-33234,
-35900,
-38279,
-40183,
-41500,
-42156,
-42162,
-41550,
-40375,
-38687,
-36549,
-34034,
-31280,
-28481,
-25895,
-23820,
-22501,
-22118,
-22665,
-23994,
-25792,
-27662,
-29223,
-30177,
-30383,
-29883,
-28860,
-27578,
-26317,
-25273,
-24547,
-24125,
-23905,
-23772,
-23609,
-23389,
-23107,
-22840,
-22638,
-22563,
-22585,
-22685,
-22774,
-22803,
-22756,
-22637,
-22520,
-22445,
-22470,
-22577,
-22748,
-22912,
-23024,
-23060,
-23034,
-22986,
-22976,
-23026,
-23147,
-23302,
-23445,
-23527,
-23546,
-23499,
-23456,
-23434,
-23496,
-23612,
-23781,
-23936,
-24051,
-24102,
-24103,
-24085,
-24089,
-24134,
-24227,
-24343,
-24440,
-24509,
-24510,
-24486,
-24442,
-24418,
-24448,
-24512,
-24623,
-24730,
-24828,
-24888,
-24923,
-24935,
-24955,
-24985,
-25043,
-25115,
-25205,
-25283,
-25367,
-25426,
-25485,
-25530,
-25564,
-25592,
-25597,
-25593,
-25576,
-25563,
-25565,
-25592,
-25653,
-25734,
-25840,
-25937,
-26026,
-26096,
-26144,
-26187,
-26228,
-26278,
-26340,
-26408,
-26469,
-26516,
-26532,
-26527,
-26502,
-26469,
-26449,
-26444,
-26470,
-26508,
-26565,
-26611,
-26649,
-26665,
-26668,
-26660,
-26661,
-26672,
-26708,
-26767,
-26834,
-26900,
-26947,
-26963,
-26944,
-26900,
-26841,
-26799,
-26778,
-26806,
-26863,
-26957,
-27050,
-27133,
-27193,
-27219,
-27237,
-27240,
-27263,
-27296,
-27350,
-27406,
-27451,
-27475,
-27473,
-27447,
-27419,
-27386,
-27370,
-27370,
-27370,
-27380,
-27378,
-27371,
-27373,
-27378,
-27414,
-27466,
-27536,
-27610,
-27662,
-27702,
-27704,
-27702,
-27697,
-27706,
-27745,
-27803,
-27867,
-27931,
-27951,
-27952,
-27904,
-27843,
-27779,
-27731,
-27715,
-27742,
-27794,
-27884,
-27974,
-28072,
-28150,
-28210,
-28236,
-28239,
-28214,
-28186,
-28156,
-28152,
-28182,
-28231,
-28313,
-28373,
-28420,
-28417,
-28377,
-28307,
-28240,
-28196,
-28201,
-28252,
-28338,
-28441,
-28522,
-28590,
-28621,
-28642,
-28664,
-28695,
-28743,
-28794,
-28834,
-28854,
-28851,
-28830,
-28821,
-28828,
-28869,
-28932,
-29001,
-29054,
-29076,
-29070,
-29038,
-29023,
-29027,
-29072,
-29155,
-29243,
-29331,
-29380,
-29402,
-29388,
-29378,
-29372,
-29404,
-29457,
-29526,
-29583,
-29615,
-29618,
-29589,
-29568,
-29557,
-29594,
-29678,
-29795,
-29927,
-30045,
-30121,
-30153,
-30135,
-30098,
-30059,
-30048,
-30079,
-30144,
-30243,
-30334,
-30407,
-30438,
-30425,
-30393,
-30340,
-30325,
-30330,
-30396,
-30481,
-30584,
-30666,
-30716,
-30713,
-30679,
-30617,
-30562,
-30533,
-30536,
-30582,
-30645,
-30722,
-30780,
-30823,
-30839,
-30841,
-30840,
-30844,
-30862,
-30892,
-30925,
-30953,
-30975,
-30972,
-30982,
-30977,
-31003,
-31043,
-31100,
-31171,
-31229,
-31268,
-31281,
-31266,
-31243,
-31222,
-31223,
-31254,
-31311,
-31386,
-31453,
-31507,
-31529,
-31531,
-31510,
-31499,
-31492,
-31518,
-31554,
-31614,
-31661,
-31707,
-31723,
-31725,
-31716,
-31700,
-31706,
-31715,
-31757,
-31803,
-31864,
-31920,
-31968,
-32009,
-32033,
-32058,
-32065,
-32076,
-32068,
-32055,
-32032,
-32005,
-31986,
-31982,
-32004,
-32054,
-32123,
-32201,
-32270,
-32320,
-32337,
-32338,
-32313,
-32302,
-32280,
-32280,
-32273,
-32267,
-32248,
-32223,
-32198,
-32188,
-32212,
-32258,
-32341,
-32422,
-32496,
-32539,
-32544,
-32520,
-32478,
-32442,
-32424,
-32427,
-32459,
-32494,
-32532,
-32558,
-32568,
-32570,
-32565,
-32561,
-32562,
-32565,
-32566,
-32568,
-32556,
-32547,
-32529,
-32518,
-32510,
-32505,
-32511,
-32513,
-32527,
-32534,
-32547,
-32557,
-32568,
-32576,
-32581,
-32583,
-32577,
-32574,
-32564,
-32561,
-32560,
-32557,
-32566,
-32565,
-32574,
-32567,
-32565,
-32548,
-32538,
-32518,
-32512,
-32502,
-32512,
-32520,
-32539,
-32555,
-32569,
-32580,
-32580,
-32584,
-32572,
-32569,
-32555,
-32542,
-32522,
-32503,
-32476,
-32458,
-32440,
-32427,
-32432,
-32436,
-32464,
-32491,
-32527,
-32564,
-32591,
-32608,
-32614,
-32597,
-32585,
-32563,
-32561,
-32577,
-32613,
-32667,
-32725,
-32768,
-32797,
-32791,
-32775,
-32733,
-32701,
-32672,
-32657,
-32659,
-32667,
-32684,
-32703,
-32725,
-32744,
-32765,
-32776,
-32782,
-32773,
-32764,
-32744,
-32753,
-32768,
-32823,
-32886,
-32958,
-33017,
-33047,
-33054,
-33036,
-33019,
-33015,
-33043,
-33093,
-33164,
-33229,
-33274,
-33292,
-33277,
-33252,
-33225,
-33215,
-33224,
-33252,
-33284,
-33315,
-33323,
-33325,
-33304,
-33287,
-33267,
-33250,
-33242,
-33238,
-33235,
-33242,
-33254,
-33278,
-33319,
-33359,
-33413,
-33449,
-33480,
-33494,
-33501,
-33500,
-33509,
-33514,
-33525,
-33537,
-33533,
-33534,
-33520,
-33517,
-33522,
-33554,
-33598,
-33664,
-33718,
-33771,
-33791,
-33796,
-33777,
-33751,
-33730,
-33714,
-33711,
-33711,
-33712,
-33707,
-33701,
-33691,
-33703,
-33721,
-33774,
-33828,
-33904,
-33957,
-34009,
-34026,
-34035,
-34029,
-34027,
-34032,
-34048,
-34070,
-34083,
-34093,
-34073,
-34041,
-33996,
-33945,
-33914,
-33898,
-33914,
-33956,
-34014,
-34084,
-34141,
-34192,
-34216,
-34227,
-34220,
-34215,
-34211,
-34217,
-34233,
-34251,
-34273,
-34282,
-34284,
-34275,
-34262,
-34255,
-34250,
-34261,
-34267,
-34283,
-34279,
-34267,
-34242,
-34208,
-34188,
-34171,
-34186,
-34217,
-34268,
-34332,
-34386,
-34437,
-34474,
-34493,
-34504,
-34504,
-34501,
-34494,
-34488,
-34477,
-34468,
-34461,
-34449,
-34456,
-34452,
-34471,
-34478,
-34494,
-34498,
-34500,
-34484,
-34472,
-34442,
-34432,
-34412,
-34414,
-34419,
-34432,
-34449,
-34465,
-34474,
-34484,
-34485,
-34485,
-34478,
-34473,
-34464,
-34460,
-34454,
-34459,
-34460,
-34477,
-34476,
-34482,
-34460,
-34429,
-34372,
-34315,
-34243,
-34197,
-34151,
-34145,
-34138,
-34161,
-34172,
-34187,
-34197,
-34199,
-34207,
-34216,
-34235,
-34253,
-34279,
-34293,
-34295,
-34295,
-34269,
-34260,
-34236,
-34239,
-34237,
-34255,
-34262,
-34265,
-34245,
-34208,
-34144,
-34074,
-33999,
-33940,
-33901,
-33886,
-33901,
-33921,
-33960,
-33986,
-34012,
-34026,
-34034,
-34034,
-34035,
-34028,
-34023,
-34007,
-33993,
-33977,
-33965,
-33963,
-33965,
-33975,
-33974,
-33970,
-33937,
-33901,
-33842,
-33795,
-33746,
-33723,
-33712,
-33717,
-33726,
-33738,
-33735,
-33737,
-33723,
-33720,
-33712,
-33715,
-33714,
-33720,
-33716,
-33710,
-33705,
-33689,
-33691,
-33679,
-33692,
-33694,
-33707,
-33719,
-33726,
-33738,
-33738,
-33738,
-33735,
-33724,
-33713,
-33700,
-33682,
-33677,
-33661,
-33664,
-33658,
-33664,
-33670,
-33679,
-33695,
-33705,
-33722,
-33730,
-33740,
-33739,
-33732,
-33725,
-33708,
-33708,
-33696,
-33709,
-33713,
-33733,
-33744,
-33752,
-33759,
-33753,
-33757,
-33752,
-33756,
-33762,
-33764,
-33768,
-33754,
-33736,
-33707,
-33686,
-33671,
-33689,
-33721,
-33789,
-33855,
-33926,
-33973,
-33996,
-33992,
-33970,
-33940,
-33919,
-33906,
-33917,
-33931,
-33952,
-33970,
-33976,
-33979,
-33975,
-33971,
-33973,
-33974,
-33983,
-33984,
-33991,
-33987,
-33991,
-33979,
-33979,
-33964,
-33954,
-33938,
-33923,
-33924,
-33930,
-33969,
-34020,
-34087,
-34162,
-34219,
-34269,
-34283,
-34289,
-34265,
-34250,
-34226,
-34218,
-34219,
-34228,
-34242,
-34253,
-34264,
-34266,
-34268,
-34264,
-34265,
-34263,
-34266,
-34263,
-34259,
-34246,
-34227,
-34208,
-34188,
-34186,
-34201,
-34238,
-34296,
-34361,
-34423,
-34470,
-34492,
-34491,
-34472,
-34449,
-34436,
-34429,
-34448,
-34461,
-34487,
-34495,
-34493,
-34478,
-34456,
-34435,
-34424,
-34415,
-34424,
-34430,
-34442,
-34450,
-34452,
-34453,
-34449,
-34441,
-34433,
-34425,
-34414,
-34421,
-34419,
-34441,
-34453,
-34473,
-34479,
-34471,
-34459,
-34432,
-34420,
-34417,
-34440,
-34481,
-34537,
-34595,
-34639,
-34672,
-34681,
-34686,
-34684,
-34692,
-34704,
-34718,
-34725,
-34715,
-34679,
-34631,
-34561,
-34503,
-34454,
-34432,
-34435,
-34453,
-34476,
-34497,
-34500,
-34488,
-34465,
-34434,
-34413,
-34399,
-34397,
-34414,
-34427,
-34452,
-34465,
-34481,
-34488,
-34500,
-34507,
-34516,
-34524,
-34521,
-34514,
-34497,
-34475,
-34454,
-34443,
-34440,
-34454,
-34471,
-34485,
-34482,
-34462,
-34410,
-34352,
-34284,
-34225,
-34192,
-34180,
-34194,
-34220,
-34249,
-34268,
-34277,
-34269,
-34256,
-34240,
-34234,
-34230,
-34238,
-34241,
-34244,
-34242,
-34234,
-34223,
-34210,
-34203,
-34196,
-34197,
-34198,
-34202,
-34208,
-34212,
-34221,
-34221,
-34231,
-34228,
-34227,
-34230,
-34220,
-34236,
-34238,
-34257,
-34266,
-34266,
-34248,
-34209,
-34149,
-34077,
-34010,
-33948,
-33916,
-33903,
-33911,
-33936,
-33956,
-33977,
-33986,
-33984,
-33982,
-33971,
-33971,
-33968,
-33967,
-33972,
-33968,
-33967,
-33966,
-33957,
-33963,
-33956,
-33965,
-33961,
-33968,
-33968,
-33971,
-33970,
-33975,
-33973,
-33975,
-33974,
-33970,
-33969,
-33964,
-33961,
-33963,
-33962,
-33968,
-33966,
-33967,
-33965,
-33955,
-33952,
-33941,
-33936,
-33937,
-33936,
-33944,
-33953,
-33958,
-33971,
-33972,
-33979,
-33977,
-33978,
-33982,
-33981,
-33984,
-33988,
-33978,
-33984,
-33967,
-33971,
-33966,
-33978,
-33991,
-34010,
-34014,
-34020,
-33993,
-33974,
-33933,
-33918,
-33917,
-33954,
-34014,
-34091,
-34164,
-34210,
-34224,
-34191,
-34133,
-34057,
-33989,
-33943,
-33925,
-33933,
-33958,
-33981,
-34003,
-34004,
-34002,
-33984,
-33979,
-33966,
-33974,
-33976,
-33984,
-33993,
-33992,
-33996,
-33990,
-33993,
-33988,
-33992,
-33985,
-33992,
-33982,
-33988,
-33980,
-33985,
-33986,
-33986,
-33987,
-33983,
-33979,
-33980,
-33972,
-33979,
-33976,
-33986,
-33986,
-33992,
-33990,
-33990,
-33989,
-33987,
-33990,
-33990,
-33992,
-33992,
-33993,
-33988,
-33992,
-33984,
-33988,
-33984,
-33984,
-33982,
-33977,
-33973,
-33971,
-33971,
-33973,
-33977,
-33985,
-33988,
-33994,
-33995,
-33991,
-33993,
-33982,
-33985,
-33976,
-33979,
-33972,
-33977,
-33972,
-33972,
-33974,
-33969,
-33974,
-33971,
-33975,
-33979,
-33986,
-33991,
-33998,
-33999,
-33997,
-33993,
-33983,
-33977,
-33971,
-33969,
-33971,
-33976,
-33983,
-33987,
-33990,
-33987,
-33985,
-33980,
-33980,
-33976,
-33978,
-33974,
-33976,
-33970,
-33970,
-33971,
-33970,
-33981,
-33982,
-33990,
-33993,
-33986,
-33990,
-33977,
-33982,
-33978,
-33983,
-33988,
-33986,
-33988,
-33972,
-33972,
-33961,
-33973,
-33981,
-34006,
-34021,
-34029,
-34014,
-33979,
-33922,
-33856,
-33790,
-33741,
-33712,
-33705,
-33717,
-33733,
-33755,
-33760,
-33762,
-33751,
-33744,
-33733,
-33738,
-33739,
-33753,
-33758,
-33763,
-33761,
-33755,
-33743,
-33737,
-33725,
-33728,
-33723,
-33730,
-33731,
-33733,
-33739,
-33736,
-33743,
-33740,
-33743,
-33739,
-33735,
-33733,
-33727,
-33731,
-33726,
-33734,
-33735,
-33742,
-33745,
-33748,
-33748,
-33748,
-33749,
-33742,
-33746,
-33739,
-33739,
-33737,
-33732,
-33735,
-33731,
-33731,
-33732,
-33729,
-33729,
-33730,
-33726,
-33729,
-33729,
-33728,
-33731,
-33731,
-33734,
-33733,
-33740,
-33731,
-33739,
-33730,
-33732,
-33727,
-33728,
-33726,
-33735,
-33733,
-33743,
-33737,
-33738,
-33727,
-33722,
-33718,
-33729,
-33753,
-33797,
-33851,
-33916,
-33974,
-34023,
-34038,
-34039,
-33998,
-33947,
-33881,
-33810,
-33763,
-33721,
-33706,
-33707,
-33718,
-33733,
-33748,
-33753,
-33755,
-33754,
-33748,
-33748,
-33746,
-33751,
-33749,
-33757,
-33752,
-33752,
-33748,
-33742,
-33743,
-33735,
-33742,
-33732,
-33742,
-33736,
-33744,
-33745,
-33752,
-33751,
-33752,
-33744,
-33742,
-33733,
-33741,
-33738,
-33756,
-33759,
-33767,
-33756,
-33747,
-33717,
-33712,
-33697,
-33724,
-33758,
-33817,
-33881,
-33939,
-33982,
-34005,
-34007,
-33995,
-33987,
-33970,
-33977,
-33976,
-33994,
-34001,
-34007,
-34005,
-33994,
-33987,
-33971,
-33972,
-33966,
-33976,
-33981,
-33989,
-33999,
-33998,
-34006,
-33994,
-34001,
-33986,
-33988,
-33978,
-33978,
-33973,
-33974,
-33974,
-33976,
-33983,
-33982,
-33989,
-33986,
-33992,
-33985,
-33989,
-33982,
-33985,
-33981,
-33985,
-33983,
-33987,
-33988,
-33991,
-33989,
-33994,
-33988,
-33992,
-33987,
-33990,
-33985,
-33992,
-33987,
-33996,
-33989,
-33993,
-33985,
-33983,
-33975,
-33975,
-33970,
-33978,
-33978,
-33988,
-33991,
-33995,
-33994,
-33992,
-33991,
-33990,
-33991,
-33994,
-33993,
-33994,
-33988,
-33986,
-33979,
-33982,
-33979,
-33990,
-33989,
-33995,
-33992,
-33983,
-33978,
-33971,
-33974,
-33989,
-33997,
-34017,
-34012,
-33997,
-33959,
-33897,
-33836,
-33768,
-33726,
-33691,
-33696,
-33700,
-33727,
-33743,
-33751,
-33753,
-33742,
-33727,
-33721,
-33712,
-33718,
-33727,
-33731,
-33739,
-33734,
-33729,
-33721,
-33717,
-33716,
-33728,
-33732,
-33749,
-33745,
-33748,
-33731,
-33727,
-33712,
-33719,
-33727,
-33744,
-33759,
-33759,
-33745,
-33702,
-33651,
-33583,
-33525,
-33480,
-33457,
-33454,
-33469,
-33490,
-33507,
-33517,
-33512,
-33501,
-33488,
-33476,
-33477,
-33476,
-33491,
-33496,
-33504,
-33503,
-33495,
-33491,
-33476,
-33484,
-33478,
-33494,
-33498,
-33503,
-33501,
-33489,
-33481,
-33473,
-33476,
-33492,
-33509,
-33534,
-33541,
-33532,
-33501,
-33443,
-33380,
-33311,
-33262,
-33227,
-33219,
-33227,
-33242,
-33259,
-33265,
-33262,
-33257,
-33244,
-33240,
-33241,
-33244,
-33256,
-33256,
-33264,
-33254,
-33256,
-33244,
-33245,
-33249,
-33251,
-33258,
-33264,
-33258,
-33261,
-33249,
-33242,
-33238,
-33231,
-33233,
-33232,
-33237,
-33235,
-33245,
-33241,
-33251,
-33249,
-33255,
-33254,
-33256,
-33256,
-33258,
-33257,
-33262,
-33258,
-33264,
-33260,
-33260,
-33257,
-33255,
-33255,
-33257,
-33259,
-33268,
-33267,
-33273,
-33270,
-33266,
-33258,
-33251,
-33238,
-33239,
-33233,
-33238,
-33242,
-33249,
-33255,
-33254,
-33256,
-33248,
-33245,
-33242,
-33241,
-33248,
-33256,
-33264,
-33270,
-33268,
-33267,
-33259,
-33255,
-33254,
-33259,
-33264,
-33271,
-33264,
-33261,
-33239,
-33234,
-33221,
-33241,
-33267,
-33326,
-33380,
-33445,
-33492,
-33522,
-33532,
-33525,
-33507,
-33495,
-33481,
-33480,
-33483,
-33490,
-33497,
-33501,
-33498,
-33500,
-33495,
-33496,
-33500,
-33498,
-33506,
-33502,
-33508,
-33502,
-33508,
-33502,
-33505,
-33501,
-33498,
-33492,
-33488,
-33487,
-33485,
-33493,
-33497,
-33506,
-33509,
-33513,
-33510,
-33507,
-33506,
-33498,
-33504,
-33502,
-33502,
-33504,
-33494,
-33499,
-33486,
-33495,
-33484,
-33496,
-33489,
-33494,
-33488,
-33486,
-33483,
-33486,
-33492,
-33505,
-33516,
-33524,
-33525,
-33516,
-33505,
-33489,
-33487,
-33497,
-33528,
-33579,
-33642,
-33706,
-33764,
-33796,
-33804,
-33786,
-33737,
-33684,
-33616,
-33561,
-33517,
-33488,
-33480,
-33477,
-33488,
-33493,
-33505,
-33503,
-33508,
-33498,
-33500,
-33494,
-33495,
-33496,
-33499,
-33502,
-33500,
-33505,
-33495,
-33504,
-33493,
-33502,
-33496,
-33504,
-33501,
-33505,
-33501,
-33500,
-33498,
-33497,
-33498,
-33500,
-33503,
-33505,
-33502,
-33498,
-33491,
-33485,
-33483,
-33483,
-33488,
-33494,
-33499,
-33499,
-33495,
-33488,
-33481,
-33478,
-33480,
-33487,
-33494,
-33499,
-33500,
-33495,
-33488,
-33484,
-33487,
-33494,
-33514,
-33517,
-33525,
-33496,
-33465,
-33401,
-33342,
-33283,
-33239,
-33222,
-33216,
-33236,
-33246,
-33268,
-33269,
-33269,
-33258,
-33250,
-33242,
-33244,
-33245,
-33252,
-33256,
-33257,
-33253,
-33250,
-33244,
-33247,
-33243,
-33252,
-33253,
-33258,
-33256,
-33256,
-33250,
-33249,
-33246,
-33246,
-33251,
-33254,
-33258,
-33263,
-33260,
-33264,
-33257,
-33256,
-33252,
-33249,
-33248,
-33247,
-33250,
-33250,
-33254,
-33254,
-33256,
-33254,
-33253,
-33253,
-33250,
-33252,
-33252,
-33253,
-33256,
-33255,
-33255,
-33253,
-33256,
-33252,
-33258,
-33255,
-33256,
-33258,
-33252,
-33253,
-33248,
-33245,
-33248,
-33247,
-33252,
-33256,
-33257,
-33257,
-33260,
-33251,
-33257,
-33249,
-33254,
-33254,
-33255,
-33256,
-33254,
-33254,
-33252,
-33254,
-33256,
-33260,
-33265,
-33263,
-33263,
-33255,
-33249,
-33245,
-33239,
-33250,
-33250,
-33265,
-33260,
-33261,
-33248,
-33238,
-33232,
-33232,
-33248,
-33265,
-33284,
-33288,
-33275,
-33236,
-33181,
-33112,
-33052,
-33001,
-32978,
-32972,
-32986,
-33004,
-33022,
-33027,
-33031,
-33014,
-33015,
-32998,
-33008,
-33006,
-33019,
-33022,
-33026,
-33024,
-33019,
-33013,
-33009,
-33011,
-33010,
-33019,
-33015,
-33024,
-33015,
-33017,
-33011,
-33008,
-33008,
-33007,
-33010,
-33011,
-33010,
-33014,
-33006,
-33013,
-33006,
-33008,
-33008,
-33009,
-33009,
-33011,
-33009,
-33009,
-33010,
-33010,
-33010,
-33012,
-33008,
-33014,
-33006,
-33015,
-33004,
-33016,
-33006,
-33018,
-33011,
-33017,
-33016,
-33012,
-33016,
-33008,
-33014,
-33009,
-33013,
-33013,
-33011,
-33015,
-33009,
-33010,
-33006,
-33004,
-33003,
-33004,
-33004,
-33008,
-33008,
-33014,
-33013,
-33017,
-33013,
-33016,
-33011,
-33012,
-33008,
-33007,
-33009,
-33008,
-33010,
-33012,
-33011,
-33012,
-33014,
-33009,
-33012,
-33008,
-33008,
-33008,
-33008,
-33009,
-33010,
-33011,
-33015,
-33013,
-33018,
-33014,
-33014,
-33013,
-33010,
-33010,
-33007,
-33009,
-33010,
-33009,
-33012,
-33010,
-33009,
-33011,
-33007,
-33011,
-33006,
-33009,
-33009,
-33007,
-33012,
-33005,
-33012,
-33007,
-33011,
-33011,
-33010,
-33012,
-33012,
-33010,
-33013,
-33008,
-33011,
-33010,
-33010,
-33010,
-33013,
-33009,
-33016,
-33011,
-33015,
-33012,
-33011,
-33009,
-33009,
-33006,
-33007,
-33005,
-33009,
-33008,
-33011,
-33009,
-33010,
-33010,
-33011,
-33009,
-33013,
-33010,
-33016,
-33009,
-33015,
-33008,
-33009,
-33010,
-33005,
-33013,
-33013,
-33014,
-33019,
-33012,
-33017,
-33009,
-33009,
-33008,
-33008,
-33012,
-33013,
-33012,
-33015,
-33007,
-33013,
-33005,
-33011,
-33008,
-33012,
-33013,
-33008,
-33010,
-33003,
-33007,
-33009,
-33016,
-33022,
-33026,
-33022,
-33011,
-32999,
-32983,
-32985,
-32993,
-33031,
-33078,
-33147,
-33204,
-33261,
-33290,
-33298,
-33290,
-33259,
-33244,
-33219,
-33229,
-33241,
-33265,
-33292,
-33295,
-33285,
-33248,
-33191,
-33127,
-33068,
-33018,
-32994,
-32985,
-32991,
-33002,
-33014,
-33018,
-33019,
-33013,
-33011,
-33006,
-33010,
-33007,
-33010,
-33007,
-33004,
-33004,
-33005,
-33011,
-33021,
-33024,
-33021,
-33014,
-32993,
-32986,
-32978,
-32998,
-33036,
-33092,
-33159,
-33218,
-33263,
-33288,
-33286,
-33277,
-33255,
-33242,
-33236,
-33237,
-33253,
-33253,
-33270,
-33259,
-33263,
-33252,
-33248,
-33248,
-33247,
-33254,
-33255,
-33258,
-33255,
-33256,
-33249,
-33252,
-33247,
-33253,
-33250,
-33253,
-33252,
-33250,
-33251,
-33249,
-33250,
-33251,
-33250,
-33254,
-33250,
-33254,
-33250,
-33252,
-33251,
-33252,
-33254,
-33255,
-33254,
-33257,
-33254,
-33255,
-33254,
-33253,
-33253,
-33253,
-33253,
-33254,
-33252,
-33256,
-33250,
-33259,
-33247,
-33261,
-33246,
-33260,
-33249,
-33257,
-33253,
-33255,
-33255,
-33253,
-33256,
-33253,
-33258,
-33255,
-33258,
-33256,
-33259,
-33254,
-33256,
-33251,
-33252,
-33253,
-33251,
-33254,
-33250,
-33255,
-33249,
-33255,
-33250,
-33256,
-33255,
-33256,
-33256,
-33253,
-33249,
-33248,
-33247,
-33251,
-33256,
-33261,
-33262,
-33262,
-33255,
-33249,
-33245,
-33244,
-33253,
-33259,
-33271,
-33267,
-33264,
-33245,
-33237,
-33226,
-33236,
-33254,
-33277,
-33298,
-33291,
-33271,
-33211,
-33149,
-33079,
-33027,
-33001,
-32999,
-33012,
-33020,
-33011,
-32977,
-32920,
-32850,
-32787,
-32737,
-32722,
-32723,
-32748,
-32768,
-32788,
-32789,
-32783,
-32769,
-32757,
-32752,
-32757,
-32761,
-32774,
-32774,
-32778,
-32771,
-32766,
-32761,
-32762,
-32764,
-32770,
-32772,
-32774,
-32772,
-32769,
-32764,
-32765,
-32759,
-32769,
-32764,
-32773,
-32769,
-32771,
-32768,
-32768,
-32764,
-32769,
-32763,
-32772,
-32766,
-32769,
-32768,
-32766,
-32763,
-32765,
-32761,
-32765,
-32762,
-32765,
-32762,
-32767,
-32762,
-32765,
-32764,
-32767,
-32765,
-32770,
-32766,
-32769,
-32766,
-32767,
-32766,
-32768,
-32765,
-32768,
-32769,
-32765,
-32772,
-32762,
-32770,
-32763,
-32768,
-32764,
-32768,
-32766,
-32770,
-32767,
-32770,
-32766,
-32771,
-32766,
-32772,
-32767,
-32771,
-32770,
-32769,
-32771,
-32767,
-32768,
-32766,
-32767,
-32765,
-32767,
-32768,
-32765,
-32771,
-32763,
-32768,
-32763,
-32767,
-32762,
-32769,
-32763,
-32771,
-32764,
-32770,
-32764,
-32767,
-32765,
-32765,
-32767,
-32765,
-32770,
-32766,
-32770,
-32765,
-32767,
-32766,
-32763,
-32770,
-32761,
-32770,
-32763,
-32767,
-32766,
-32765,
-32767,
-32766,
-32766,
-32768,
-32764,
-32766,
-32765,
-32765,
-32767,
-32769,
-32767,
-32773,
-32767,
-32771,
-32770,
-32764,
-32771,
-32763,
-32770,
-32765,
-32769,
-32767,
-32768,
-32768,
-32768,
-32767,
-32768,
-32767,
-32766,
-32770,
-32767,
-32769,
-32769,
-32769,
-32768,
-32769,
-32764,
-32769,
-32764,
-32768,
-32765,
-32767,
-32768,
-32765,
-32769,
-32765,
-32767,
-32766,
-32767,
-32766,
-32769,
-32767,
-32768,
-32768,
-32769,
-32765,
-32769,
-32763,
-32766,
-32763,
-32765,
-32763,
-32765,
-32766,
-32764,
-32768,
-32764,
-32766,
-32768,
-32763,
-32769,
-32765,
-32768,
-32766,
-32768,
-32765,
-32767,
-32764,
-32767,
-32765,
-32768,
-32767,
-32770,
-32766,
-32770,
-32767,
-32766,
-32768,
-32765,
-32766,
-32767,
-32766,
-32767,
-32767,
-32767,
-32766,
-32767,
-32765,
-32767,
-32762,
-32768,
-32763,
-32767,
-32765,
-32768,
-32765,
-32768,
-32765,
-32767,
-32764,
-32768,
-32766,
-32769,
-32768,
-32766,
-32770,
-32766,
-32767,
-32767,
-32763,
-32771,
-32763,
-32771,
-32765,
-32769,
-32768,
-32767,
-32770,
-32765,
-32771,
-32765,
-32770,
-32767,
-32768,
-32767,
-32767,
-32767,
-32768,
-32766,
-32767,
-32768,
-32766,
-32769,
-32766,
-32765,
-32767,
-32763,
-32768,
-32762,
-32771,
-32763,
-32772,
-32768,
-32769,
-32770,
-32767,
-32767,
-32767,
-32765,
-32769,
-32765,
-32768,
-32768,
-32767,
-32768,
-32770,
-32765,
-32772,
-32764,
-32770,
-32763,
-32768,
-32764,
-32766,
-32766,
-32767,
-32766,
-32769,
-32766,
-32768,
-32764,
-32767,
-32763,
-32765,
-32765,
-32763,
-32768,
-32765,
-32769,
-32765,
-32769,
-32762,
-32770,
-32761,
-32769,
-32762,
-32766,
-32764,
-32767,
-32764,
-32767,
-32766,
-32764,
-32771,
-32761,
-32772,
-32761,
-32771,
-32762,
-32769,
-32765,
-32767,
-32769,
-32767,
-32768,
-32768,
-32764,
-32769,
-32763,
-32767,
-32766,
-32765,
-32769,
-32763,
-32769,
-32763,
-32770,
-32762,
-32769,
-32764,
-32769,
-32767,
-32769,
-32768,
-32768,
-32768,
-32766,
-32770,
-32762,
-32772,
-32763,
-32769,
-32771,
-32764,
-32775,
-32765,
-32771,
-32767,
-32767,
-32769,
-32765,
-32771,
-32765,
-32769,
-32766,
-32767,
-32768,
-32764,
-32771,
-32763,
-32771,
-32765,
-32769,
-32767,
-32768,
-32767,
-32766,
-32770,
-32766,
-32768,
-32770,
-32762,
-32773,
-32759,
-32771,
-32762,
-32770,
-32765,
-32768,
-32769,
-32765,
-32771,
-32764,
-32766,
-32768,
-32762,
-32770,
-32763,
-32767,
-32767,
-32767,
-32767,
-32766,
-32766,
-32765,
-32767,
-32766,
-32765,
-32769,
-32765,
-32768,
-32767,
-32765,
-32768,
-32763,
-32767,
-32764,
-32768,
-32764,
-32768,
-32765,
-32767,
-32767,
-32765,
-32767,
-32767,
-32765,
-32768,
-32764,
-32769,
-32766,
-32767,
-32768,
-32767,
-32768,
-32768,
-32766,
-32769,
-32764,
-32768,
-32764,
-32767,
-32767,
-32767,
-32767,
-32769,
-32767,
-32768,
-32768,
-32767,
-32768,
-32767,
-32768,
-32768,
-32769,
-32767,
-32771,
-32766,
-32772,
-32766,
-32769,
-32769,
-32766,
-32767,
-32768,
-32766,
-32768,
-32769,
-32764,
-32772,
-32764,
-32770,
-32766,
-32767,
-32767,
-32768,
-32766,
-32768,
-32765,
-32770,
-32766,
-32770,
-32766,
-32770,
-32765,
-32771,
-32765,
-32770,
-32766,
-32770,
-32766,
-32768,
-32768,
-32767,
-32768,
-32767,
-32767,
-32767,
-32769,
-32766,
-32768,
-32768,
-32764,
-32771,
-32763,
-32770,
-32766,
-32768,
-32767,
-32767,
-32769,
-32767,
-32768,
-32767,
-32767,
-32768,
-32767,
-32768,
-32766,
-32769,
-32768,
-32767,
-32768,
-32769,
-32766,
-32770,
-32766,
-32768,
-32766,
-32768,
-32766,
-32768,
-32766,
-32768,
-32766,
-32769,
-32765,
-32768,
-32765,
-32768,
-32765,
-32768,
-32767,
-32766,
-32770,
-32764,
-32770,
-32765,
-32769,
-32766,
-32769,
-32767,
-32767,
-32768,
-32767,
-32768,
-32767,
-32767,
-32766,
-32769,
-32767,
-32768,
-32766,
-32769,
-32765,
-32771,
-32764,
-32770,
-32767,
-32767,
-32770,
-32764,
-32772,
-32762,
-32772,
-32764,
-32770,
-32764,
-32771,
-32762,
-32771,
-32765,
-32767,
-32768,
-32765,
-32768,
-32766,
-32769,
-32765,
-32769,
-32767,
-32766,
-32769,
-32766,
-32769,
-32766,
-32768,
-32767,
-32768,
-32768,
-32766,
-32768,
-32768,
-32765,
-32770,
-32765,
-32768,
-32768,
-32764,
-32772,
-32762,
-32771,
-32764,
-32769,
-32766,
-32768,
-32767,
-32766,
-32768,
-32766,
-32767,
-32767,
-32767,
-32766,
-32768,
-32765,
-32769,
-32766,
-32767,
-32766,
-32767,
-32768,
-32765,
-32770,
-32763,
-32770,
-32765,
-32769,
-32766,
-32768,
-32765,
-32769,
-32767,
-32765,
-32770,
-32764,
-32769,
-32767,
-32766,
-32768,
-32767,
-32767,
-32767,
-32768,
-32766,
-32767,
-32768,
-32766,
-32770,
-32764,
-32770,
-32764,
-32770,
-32767,
-32766,
-32770,
-32764,
-32771,
-32764,
-32770,
-32765,
-32769,
-32767,
-32767,
-32768,
-32766,
-32768,
-32767,
-32766,
-32769,
-32764,
-32770,
-32765,
-32767,
-32769,
-32764,
-32769,
-32765,
-32769,
-32765,
-32769,
-32765,
-32768,
-32766,
-32768,
-32765,
-32769,
-32766,
-32767,
-32768,
-32765,
-32770,
-32764,
-32770,
-32766,
-32767,
-32769,
-32764,
-32771,
-32765,
-32768,
-32768,
-32766,
-32767,
-32770,
-32763,
-32771,
-32764,
-32769,
-32767,
-32765,
-32770,
-32763,
-32771,
-32764,
-32768,
-32767,
-32766,
-32768,
-32766,
-32767,
-32768,
-32764,
-32770,
-32765,
-32768,
-32767,
-32765,
-32769,
-32766,
-32767,
-32768,
-32765,
-32769,
-32765,
-32769,
-32765,
-32768,
-32767,
-32766,
-32769,
-32765,
-32768,
-32767,
-32766,
-32769,
-32765,
-32769,
-32766,
-32767,
-32769,
-32763,
-32773,
-32762,
-32771,
-32765,
-32768,
-32767,
-32769,
-32766,
-32767,
-32769,
-32765,
-32771,
-32764,
-32770,
-32765,
-32770,
-32766,
-32768,
-32768,
-32765,
-32771,
-32764,
-32770,
-32766,
-32767,
-32769,
-32765,
-32769,
-32767,
-32766,
-32769,
-32765,
-32768,
-32767,
-32766,
-32768,
-32767,
-32766,
-32768,
-32765,
-32769,
-32765,
-32768,
-32767,
-32765,
-32769,
-32765,
-32768,
-32766,
-32767,
-32767,
-32766,
-32768,
-32766,
-32767,
-32767,
-32766,
-32769,
-32764,
-32770,
-32764,
-32769,
-32765,
-32770,
-32763,
-32771,
-32763,
-32770,
-32765,
-32768,
-32767,
-32766,
-32769,
-32765,
-32768,
-32767,
-32767,
-32767,
-32767,
-32768,
-32766,
-32768,
-32766,
-32768,
-32767,
-32767,
-32768,
-32766,
-32769,
-32765,
-32768,
-32767,
-32767,
-32768,
-32766,
-32768,
-32766,
-32767,
-32768,
-32766,
-32768,
-32767,
-32766,
-32768,
-32767,
-32766,
-32768,
-32767,
-32765,
-32771,
-32762,
-32772,
-32762,
-32770,
-32766,
-32767,
-32767,
-32767,
-32767,
-32767,
-32767,
-32767,
-32767,
-32768,
-32765,
-32769,
-32767,
-32766,
-32768,
-32767,
-32766,
-32770,
-32764,
-32769,
-32767,
-32766,
-32769,
-32765,
-32769,
-32766,
-32767,
-32768,
-32766,
-32768,
-32767,
-32765,
-32771,
-32763,
-32770,
-32765,
-32768,
-32767,
-32767,
-32767,
-32766,
-32769,
-32764,
-32770,
-32765,
-32767,
-32768,
-32765,
-32769,
-32765,
-32769,
-32766,
-32766,
-32769,
-32764,
-32770,
-32766,
-32766,
-32768,
-32766,
-32767,
-32769,
-32763,
-32770,
-32765,
-32769,
-32765,
-32769,
-32764,
-32770,
-32765,
-32768,
-32766,
-32768,
-32767,
-32767,
-32766,
-32767,
-32768,
-32767,
-32766,
-32769,
-32764,
-32770,
-32765,
-32768,
-32767,
-32766,
-32769,
-32765,
-32768,
-32767,
-32766,
-32769,
-32765,
-32769,
-32765,
-32769,
-32765,
-32769,
-32766,
-32768,
-32766,
-32767,
-32768,
-32765,
-32769,
-32766,
-32767,
-32767,
-32767,
-32766,
-32769,
-32765,
-32769,
-32764,
-32770,
-32764,
-32770,
-32765,
-32768,
-32767,
-32766,
-32768,
-32766,
-32768,
-32767,
-32767,
-32766,
-32768,
-32767,
-32766,
-32769,
-32764,
-32770,
-32766,
-32766,
-32769,
-32764,
-32771,
-32763,
-32770,
-32766,
-32766,
-32769,
-32764,
-32771,
-32763,
-32771,
-32763,
-32770,
-32766,
-32765,
-32771,
-32762,
-32772,
-32763,
-32769,
-32766,
-32767,
-32768,
-32765,
-32769,
-32765,
-32769,
-32766,
-32767,
-32767,
-32767,
-32767,
-32767,
-32767,
-32768,
-32764,
-32771,
-32763,
-32770,
-32766,
-32767,
-32767,
-32767,
-32766,
-32769,
-32766,
-32767,
-32767,
-32767,
-32767,
-32767,
-32767,
-32767,
-32767,
-32768,
-32765,
-32769,
-32766,
-32768,
-32765,
-32770,
-32764,
-32769,
-32767,
-32765,
-32770,
-32764,
-32769,
-32766,
-32768,
-32766,
-32768,
-32766,
-32767,
-32767,
-32768,
-32765,
-32770,
-32763,
-32770,
-32765,
-32768,
-32767,
-32767,
-32766,
-32769,
-32765,
-32769,
-32764,
-32771,
-32763,
-32771,
-32763,
-32770,
-32765,
-32768,
-32768,
-32764,
-32771,
-32762,
-32772,
-32764,
-32768,
-32768,
-32764,
-32771,
-32763,
-32770,
-32765,
-32768,
-32767,
-32766,
-32769,
-32765,
-32768,
-32767,
-32766,
-32769,
-32766,
-32766,
-32769,
-32765,
-32769,
-32765,
-32769,
-32764,
-32770,
-32765,
-32768,
-32767,
-32766,
-32767,
-32768,
-32766,
-32767,
-32768,
-32765,
-32769,
-32765,
-32769,
-32765,
-32770,
-32763,
-32770,
-32766,
-32766,
-32770,
-32763,
-32771,
-32763,
-32770,
-32766,
-32766,
-32769,
-32765,
-32767,
-32770,
-32762,
-32772,
-32764,
-32767,
-32769,
-32764,
-32770,
-32765,
-32768,
-32766,
-32769,
-32765,
-32768,
-32767,
-32766,
-32769,
-32766,
-32766,
-32769,
-32765,
-32769,
-32765,
-32768,
-32767,
-32767,
-32766,
-32768,
-32766,
-32769,
-32765,
-32768,
-32766,
-32768,
-32767,
-32766,
-32768,
-32766,
-32769,
-32765,
-32769,
-32764,
-32770,
-32766,
-32766,
-32770,
-32763,
-32771,
-32763,
-32771,
-32763,
-32772,
-32761,
-32773,
-32762,
-32771,
-32764,
-32768,
-32768,
-32765,
-32770,
-32764,
-32769,
-32766,
-32768,
-32766,
-32769,
-32764,
-32771,
-32763,
-32770,
-32766,
-32766,
-32769,
-32765,
-32769,
-32765,
-32768,
-32767,
-32766,
-32770,
-32764,
-32768,
-32767,
-32767,
-32768,
-32766,
-32768,
-32765,
-32770,
-32765,
-32767,
-32768,
-32766,
-32768,
-32767,
-32766,
-32768,
-32766,
-32768,
-32766,
-32768,
-32766,
-32768,
-32766,
-32768,
-32766,
-32768,
-32766,
-32768,
-32766,
-32768,
-32766,
-32768,
-32767,
-32765,
-32770,
-32764,
-32770,
-32765,
-32767,
-32767,
-32768,
-32766,
-32768,
-32765,
-32769,
-32766,
-32767,
-32767,
-32767,
-32768,
-32766,
-32766,
-32770,
-32763,
-32771,
-32764,
-32768,
-32768,
-32765,
-32769,
-32765,
-32770,
-32763,
-32770,
-32766,
-32767,
-32767,
-32767,
-32767,
-32767,
-32767,
-32766,
-32769,
-32766,
-32767,
-32767,
-32767,
-32768,
-32766,
-32768,
-32765,
-32770,
-32765,
-32768,
-32767,
-32765,
-32770,
-32765,
-32768,
-32766,
-32768,
-32765,
-32770,
-32764,
-32769,
-32765,
-32769,
-32765,
-32769,
-32765,
-32769,
-32766,
-32767,
-32767,
-32767,
-32768,
-32765,
-32770,
-32764,
-32769,
-32766,
-32767,
-32768,
-32766,
-32768,
-32766,
-32768,
-32767,
-32766,
-32768,
-32766,
-32768,
-32767,
-32766,
-32768,
-32767,
-32766,
-32769,
-32764,
-32771,
-32763,
-32771,
-32764,
-32768,
-32768,
-32765,
-32769,
-32766,
-32767,
-32767,
-32767,
-32767,
-32767,
-32767,
-32766,
-32769,
-32764,
-32771,
-32763,
-32770,
-32765,
-32768,
-32767,
-32767,
-32767,
-32767,
-32767,
-32767,
-32767,
-32768,
-32765,
-32769,
-32765,
-32769,
-32766,
-32768,
-32766,
-32767,
-32768,
-32765,
-32770,
-32765,
-32767,
-32769,
-32763,
-32772,
-32762,
-32771,
-32764,
-32769,
-32766,
-32767,
-32768,
-32765,
-32769,
-32765,
-32770,
-32764,
-32770,
-32763,
-32771,
-32764,
-32769,
-32766,
-32768,
-32765,
-32769,
-32765,
-32768,
-32768,
-32766,
-32767,
-32768,
-32765,
-32769,
-32766,
-32768,
-32766,
-32768,
-32766,
-32767,
-32768,
-32766,
-32768,
-32766,
-32767,
-32768,
-32766,
-32767,
-32768,
-32765,
-32770,
-32764,
-32769,
-32766,
-32768,
-32766,
-32769,
-32764,
-32770,
-32765,
-32768,
-32768,
-32765,
-32769,
-32765,
-32769,
-32765,
-32769,
-32766,
-32767,
-32768,
-32765,
-32769,
-32765,
-32770,
-32764,
-32769,
-32766,
-32767,
-32767,
-32768,
-32765,
-32770,
-32764,
-32769,
-32765,
-32769,
-32766,
-32768,
-32765,
-32769,
-32765,
-32769,
-32766,
-32767,
-32768,
-32765,
-32770,
-32763,
-32771,
-32764,
-32769,
-32767,
-32766,
-32768,
-32766,
-32768,
-32766,
-32769,
-32764,
-32770,
-32765,
-32768,
-32766,
-32768,
-32766,
-32768,
-32766,
-32768,
-32766,
-32768,
-32766,
-32768,
-32766,
-32769,
-32764,
-32769,
-32767,
-32766,
-32768,
-32767,
-32765,
-32770,
-32765,
-32767,
-32768,
-32765,
-32769,
-32767,
-32765,
-32770,
-32764,
-32768,
-32769,
-32763,
-32772,
-32762,
-32771,
-32764,
-32769,
-32766,
-32767,
-32768,
-32766,
-32767,
-32768,
-32766,
-32768,
-32766,
-32768,
-32766,
-32768,
-32766,
-32768,
-32765,
-32771,
-32762,
-32771,
-32765,
-32768,
-32766,
-32768,
-32766,
-32768,
-32768,
-32764,
-32769,
-32767,
-32766,
-32769,
-32765,
-32767,
-32768,
-32766,
-32768,
-32766,
-32768,
-32765,
-32770,
-32764,
-32769,
-32765,
-32769,
-32766,
-32768,
-32766,
-32767,
-32767,
-32768,
-32766,
-32768,
-32766,
-32767,
-32768,
-32766,
-32768,
-32766,
-32767,
-32768,
-32765,
-32770,
-32764,
-32770,
-32764,
-32769,
-32767,
-32766,
-32769,
-32764,
-32770,
-32765,
-32768,
-32767,
-32765,
-32770,
-32764,
-32770,
-32765,
-32768,
-32765,
-32770,
-32765,
-32768,
-32767,
-32767,
-32767,
-32767,
-32767,
-32766,
-32770,
-32764,
-32768,
-32768,
-32765,
-32769,
-32765,
-32769,
-32765,
-32769,
-32765,
-32769,
-32765,
-32769,
-32765,
-32769,
-32766,
-32766,
-32770,
-32763,
-32771,
-32764,
-32768,
-32767,
-32767,
-32767,
-32767,
-32767,
-32767,
-32766,
-32769,
-32765,
-32768,
-32768,
-32765,
-32768,
-32767,
-32766,
-32769,
-32765,
-32768,
-32767,
-32767,
-32767,
-32766,
-32768,
-32767,
-32767,
-32767,
-32766,
-32769,
-32765,
-32769,
-32765,
-32769,
-32765,
-32769,
-32765,
-32769,
-32765,
-32769,
-32765,
-32769,
-32765,
-32769,
-32765,
-32769,
-32766,
-32767,
-32768,
-32765,
-32770,
-32764,
-32768,
-32768,
-32766,
-32767,
-32768,
-32765,
-32770,
-32764,
-32768,
-32768,
-32765,
-32770,
-32764,
-32769,
-32765,
-32769,
-32766,
-32767,
-32768,
-32765,
-32769,
-32766,
-32767,
-32767,
-32767,
-32767,
-32767,
-32767,
-32766,
-32769,
-32764,
-32771,
-32763,
-32770,
-32765,
-32768,
-32767,
-32766,
-32768,
-32766,
-32769,
-32765,
-32768,
-32766,
-32768,
-32767,
-32767,
-32766,
-32768,
-32767,
-32767,
-32767,
-32766,
-32768,
-32767,
-32767,
-32767,
-32766,
-32768,
-32768,
-32765,
-32769,
-32765,
-32768,
-32768,
-32765,
-32768,
-32768,
-32765,
-32769,
-32765,
-32769,
-32764,
-32771,
-32763,
-32770,
-32765,
-32769,
-32764,
-32771,
-32763,
-32770,
-32765,
-32769,
-32765,
-32769,
-32766,
-32766,
-32769,
-32766,
-32766,
-32770,
-32763,
-32771,
-32764,
-32768,
-32768,
-32765,
-32769,
-32765,
-32769,
-32766,
-32768,
-32765,
-32769,
-32765,
-32770,
-32764,
-32769,
-32766,
-32768,
-32765,
-32770,
-32764,
-32769,
-32767,
-32765,
-32769,
-32767,
-32766,
-32767,
-32769,
-32763,
-32772,
-32763,
-32769,
-32767,
-32766,
-32768,
-32766,
-32768,
-32766,
-32769,
-32764,
-32770,
-32765,
-32768,
-32767,
-32766,
-32768,
-32767,
-32767,
-32766,
-32768,
-32766,
-32768,
-32766,
-32768,
-32766,
-32767,
-32768,
-32765,
-32769,
-32766,
-32767,
-32767,
-32767,
-32767,
-32767,
-32768,
-32765,
-32769,
-32765,
-32770,
-32764,
-32770,
-32763,
-32770,
-32767,
-32765,
-32771,
-32762,
-32770,
-32766,
-32767,
-32768,
-32767,
-32766,
-32768,
-32766,
-32767,
-32769,
-32765,
-32769,
-32765,
-32768,
-32767,
-32767,
-32767,
-32767,
-32766,
-32769,
-32765,
-32769,
-32765,
-32768,
-32766,
-32769,
-32765,
-32768,
-32766,
-32769,
-32764,
-32770,
-32764,
-32769,
-32767,
-32766,
-32768,
-32766,
-32768,
-32765,
-32770,
-32764,
-32770,
-32764,
-32770,
-32764,
-32769,
-32766,
-32768,
-32766,
-32768,
-32766,
-32767,
-32768,
-32766,
-32767,
-32769,
-32763,
-32772,
-32763,
-32770,
-32765,
-32768,
-32766,
-32769,
-32766,
-32766,
-32769,
-32765,
-32768,
-32767,
-32766,
-32768,
-32767,
-32766,
-32769,
-32764,
-32770,
-32764,
-32770,
-32765,
-32768,
-32766,
-32768,
-32767,
-32767,
-32766,
-32768,
-32766,
-32769,
-32765,
-32769,
-32765,
-32769,
-32765,
-32769,
-32766,
-32767,
-32768,
-32765,
-32769,
-32765,
-32769,
-32766,
-32767,
-32767,
-32766,
-32769,
-32765,
-32768,
-32767,
-32767,
-32767,
-32767,
-32766,
-32769,
-32765,
-32768,
-32767,
-32766,
-32769,
-32765,
-32768,
-32766,
-32769,
-32764,
-32770,
-32765,
-32768,
-32767,
-32766,
-32768,
-32767,
-32766,
-32768,
-32767,
-32767,
-32767,
-32766,
-32768,
-32767,
-32768,
-32764,
-32771,
-32763,
-32771,
-32764,
-32768,
-32767,
-32767,
-32767,
-32767,
-32768,
-32764,
-32770,
-32765,
-32769,
-32766,
-32766,
-32769,
-32764,
-32771,
-32763,
-32770,
-32765,
-32768,
-32766,
-32768,
-32766,
-32768,
-32766,
-32768,
-32766,
-32768,
-32766,
-32767,
-32767,
-32768,
-32766,
-32768,
-32765,
-32768,
-32768,
-32765,
-32770,
-32764,
-32769,
-32766,
-32767,
-32768,
-32767,
-32766,
-32768,
-32766,
-32768,
-32768,
-32765,
-32768,
-32767,
-32766,
-32769,
-32765,
-32768,
-32767,
-32766,
-32768,
-32766,
-32768,
-32767,
-32766,
-32768,
-32766,
-32768,
-32767,
-32766,
-32769,
-32764,
-32771,
-32762,
-32772,
-32762,
-32772,
-32763,
-32770,
-32765,
-32767,
-32768,
-32766,
-32768,
-32767,
-32766,
-32768,
-32767,
-32766,
-32768,
-32766,
-32768,
-32767,
-32766,
-32768,
-32766,
-32767,
-32768,
-32765,
-32770,
-32764,
-32768,
-32768,
-32764,
-32771,
-32764,
-32769,
-32766,
-32767,
-32766,
-32770,
-32763,
-32772,
-32762,
-32771,
-32764,
-32768,
-32767,
-32768,
-32766,
-32768,
-32765,
-32769,
-32766,
-32768,
-32767,
-32765,
-32769,
-32766,
-32768,
-32766,
-32768,
-32765,
-32769,
-32767,
-32766,
-32768,
-32765,
-32769,
-32766,
-32769,
-32765,
-32768,
-32765,
-32770,
-32764,
-32770,
-32765,
-32767,
-32768,
-32767,
-32766,
-32769,
-32764,
-32770,
-32766,
-32767,
-32767,
-32767,
-32767,
-32767,
-32767,
-32766,
-32769,
-32765,
-32769,
-32764,
-32770,
-32766,
-32767,
-32767,
-32767,
-32767,
-32768,
-32766,
-32767,
-32767,
-32768,
-32765,
-32770,
-32763,
-32771,
-32764,
-32769,
-32766,
-32768,
-32765,
-32770,
-32764,
-32769,
-32767,
-32765,
-32770,
-32765,
-32767,
-32769,
-32764,
-32770,
-32765,
-32768,
-32767,
-32767,
-32766,
-32768,
-32767,
-32767,
-32767,
-32767,
-32767,
-32768,
-32765,
-32769,
-32765,
-32770,
-32764,
-32769,
-32765,
-32768,
-32768,
-32765,
-32769,
-32765,
-32769,
-32765,
-32769,
-32765,
-32769,
-32766,
-32767,
-32768,
-32765,
-32770,
-32764,
-32769,
-32766,
-32768,
-32767,
-32765,
-32770,
-32764,
-32770,
-32765,
-32767,
-32768,
-32766,
-32767,
-32768,
-32765,
-32770,
-32763,
-32771,
-32764,
-32769,
-32766,
-32766,
-32770,
-32763,
-32771,
-32763,
-32771,
-32763,
-32770,
-32764,
-32771,
-32763,
-32770,
-32764,
-32769,
-32767,
-32766,
-32768,
-32766,
-32767,
-32769,
-32763,
-32772,
-32762,
-32771,
-32764,
-32769,
-32766,
-32768,
-32766,
-32767,
-32768,
-32766,
-32768,
-32766,
-32767,
-32768,
-32765,
-32770,
-32764,
-32769,
-32766,
-32766,
-32770,
-32764,
-32770,
-32764,
-32768,
-32769,
-32764,
-32771,
-32762,
-32771,
-32765,
-32768,
-32767,
-32766,
-32768,
-32767,
-32766,
-32769,
-32764,
-32771,
-32762,
-32772,
-32763,
-32770,
-32765,
-32768,
-32766,
-32768,
-32766,
-32769,
-32764,
-32770,
-32765,
-32768,
-32767,
-32767,
-32767,
-32767,
-32767,
-32767,
-32767,
-32768,
-32765,
-32769,
-32765,
-32768,
-32768,
-32765,
-32769,
-32764,
-32769,
-32768,
-32764,
-32771,
-32762,
-32771,
-32765,
-32768,
-32767,
-32766,
-32768,
-32767,
-32766,
-32769,
-32765,
-32768,
-32767,
-32767,
-32766,
-32768,
-32766,
-32768,
-32767,
-32766,
-32768,
-32766,
-32769,
-32765,
-32768,
-32767,
-32766,
-32770,
-32762,
-32773,
-32760,
-32773,
-32763,
-32769,
-32766,
-32768,
-32765,
-32770,
-32763,
-32771,
-32764,
-32770,
-32764,
-32769,
-32765,
-32769,
-32767,
-32766,
-32767,
-32767,
-32767,
-32767,
-32768,
-32766,
-32766,
-32769,
-32765,
-32768,
-32768,
-32765,
-32769,
-32765,
-32769,
-32764,
-32771,
-32763,
-32771,
-32764,
-32767,
-32769,
-32764,
-32771,
-32763,
-32770,
-32765,
-32768,
-32767,
-32767,
-32767,
-32767,
-32767,
-32767,
-32767,
-32767,
-32767,
-32767,
-32767,
-32767,
-32767,
-32767,
-32767,
-32766,
-32769,
-32766,
-32767,
-32767,
-32767,
-32766,
-32770,
-32763,
-32771,
-32764,
-32768,
-32768,
-32764,
-32770,
-32765,
-32768,
-32767,
-32766,
-32767,
-32768,
-32766,
-32768,
-32766,
-32768,
-32766,
-32768,
-32766,
-32769,
-32765,
-32768,
-32767,
-32766,
-32768,
-32768,
-32764,
-32771,
-32763,
-32769,
-32767,
-32766,
-32768,
-32767,
-32767,
-32767,
-32767,
-32766,
-32769,
-32766,
-32768,
-32765,
-32770,
-32763,
-32771,
-32765,
-32767,
-32768,
-32765,
-32769,
-32766,
-32768,
-32766,
-32767,
-32767,
-32768,
-32766,
-32768,
-32766,
-32767,
-32767,
-32768,
-32766,
-32769,
-32764,
-32769,
-32765,
-32770,
-32764,
-32770,
-32764,
-32768,
-32768,
-32766,
-32767,
-32768,
-32765,
-32769,
-32766,
-32768,
-32766,
-32768,
-32765,
-32770,
-32764,
-32770,
-32765,
-32767,
-32768,
-32766,
-32768,
-32767,
-32765,
-32769,
-32766,
-32768,
-32766,
-32768,
-32765,
-32769,
-32766,
-32768,
-32766,
-32768,
-32765,
-32770,
-32764,
-32770,
-32765,
-32767,
-32768,
-32766,
-32768,
-32767,
-32765,
-32770,
-32764,
-32769,
-32766,
-32767,
-32768,
-32766,
-32767,
-32767,
-32768,
-32765,
-32770,
-32764,
-32769,
-32767,
-32766,
-32768,
-32766,
-32768,
-32766,
-32769,
-32764,
-32770,
-32764,
-32769,
-32766,
-32767,
-32768,
-32766,
-32767,
-32767,
-32768,
-32765,
-32769,
-32765,
-32769,
-32766,
-32767,
-32767,
-32767,
-32767,
-32768,
-32766,
-32768,
-32765,
-32769,
-32765,
-32769,
-32767,
-32765,
-32770,
-32762,
-32772,
-32764,
-32769,
-32766,
-32766,
-32768,
-32767,
-32767,
-32767,
-32767,
-32767,
-32767,
-32767,
-32768,
-32765,
-32770,
-32764,
-32769,
-32766,
-32767,
-32767,
-32768,
-32766,
-32767,
-32768,
-32765,
-32770,
-32765,
-32767,
-32768,
-32766,
-32768,
-32767,
-32767,
-32766,
-32768,
-32766,
-32768,
-32767,
-32767,
-32766,
-32768,
-32766,
-32768,
-32767,
-32766,
-32768,
-32766,
-32768,
-32767,
-32767,
-32766,
-32769,
-32765,
-32769,
-32765,
-32768,
-32767,
-32767,
-32767,
-32766,
-32768,
-32766,
-32769,
-32764,
-32770,
-32764,
-32769,
-32767,
-32766,
-32768,
-32766,
-32767,
-32767,
-32769,
-32764,
-32769,
-32767,
-32765,
-32770,
-32765,
-32767,
-32769,
-32764,
-32769,
-32767,
-32766,
-32768,
-32767,
-32766,
-32769,
-32765,
-32768,
-32767,
-32767,
-32766,
-32770,
-32762,
-32772,
-32763,
-32769,
-32767,
-32766,
-32768,
-32766,
-32768,
-32765,
-32770,
-32765,
-32768,
-32766,
-32767,
-32768,
-32767,
-32766,
-32768,
-32766,
-32768,
-32767,
-32767,
-32767,
-32767,
-32766,
-32769,
-32765,
-32769,
-32766,
-32766,
-32769,
-32765,
-32768,
-32767,
-32767,
-32767,
-32766,
-32768,
-32766,
-32768,
-32766,
-32767,
-32769,
-32764,
-32769,
-32765,
-32769,
-32766,
-32768,
-32765,
-32769,
-32766,
-32767,
-32768,
-32765,
-32768,
-32768,
-32765,
-32769,
-32765,
-32769,
-32765,
-32769,
-32765,
-32768,
-32768,
-32764,
-32771,
-32763,
-32770,
-32766,
-32765,
-32771,
-32763,
-32770,
-32766,
-32766,
-32769,
-32765,
-32768,
-32767,
-32767,
-32767,
-32766,
-32768,
-32766,
-32768,
-32767,
-32766,
-32769,
-32764,
-32769,
-32767,
-32766,
-32769,
-32764,
-32770,
-32764,
-32770,
-32765,
-32768,
-32767,
-32766,
-32769,
-32764,
-32771,
-32763,
-32770,
-32765,
-32769,
-32765,
-32768,
-32766,
-32768,
-32766,
-32768,
-32767,
-32766,
-32768,
-32766,
-32767,
-32768,
-32767,
-32766,
-32768,
-32766,
-32767,
-32768,
-32766,
-32768,
-32766,
-32768,
-32766,
-32769,
-32764,
-32770,
-32765,
-32768,
-32767,
-32767,
-32766,
-32769,
-32765,
-32768,
-32766,
-32768,
-32766,
-32768,
-32767,
-32765,
-32769,
-32765,
-32769,
-32766,
-32767,
-32767,
-32767,
-32767,
-32767,
-32767,
-32767,
-32767,
-32767,
-32767,
-32766,
-32769,
-32765,
-32769,
-32766,
-32767,
-32766,
-32770,
-32763,
-32772,
-32762,
-32771,
-32764,
-32769,
-32766,
-32767,
-32768,
-32766,
-32767,
-32767,
-32768,
-32765,
-32770,
-32763,
-32770,
-32766,
-32767,
-32766,
-32769,
-32765,
-32769,
-32766,
-32766,
-32769,
-32765,
-32768,
-32768,
-32765,
-32770,
-32763,
-32770,
-32765,
-32769,
-32766,
-32767,
-32767,
-32767,
-32767,
-32767,
-32767,
-32767,
-32767,
-32768,
-32765,
-32769,
-32765,
-32768,
-32768,
-32765,
-32769,
-32765,
-32769,
-32765,
-32770,
-32763,
-32770,
-32766,
-32766,
-32770,
-32764,
-32768,
-32768,
-32765,
-32769,
-32766,
-32767,
-32767,
-32767,
-32767,
-32767,
-32767,
-32767,
-32767,
-32767,
-32767,
-32766,
-32769,
-32766,
-32767,
-32767,
-32766,
-32768,
-32767,
-32767,
-32767,
-32766,
-32768,
-32767,
-32767,
-32767,
-32767,
-32766,
-32770,
-32763,
-32771,
-32764,
-32768,
-32768,
-32765,
-32769,
-32765,
-32769,
-32765,
-32769,
-32766,
-32766,
-32769,
-32765,
-32768,
-32768,
-32764,
-32770,
-32766,
-32766,
-32769,
-32764,
-32771,
-32763,
-32770,
-32766,
-32766,
-32769,
-32766,
-32766,
-32769,
-32766,
-32766,
-32770,
-32764,
-32769,
-32766,
-32768,
-32766,
-32768,
-32766,
-32767,
-32769,
-32764,
-32771,
-32763,
-32769,
-32767,
-32767,
-32766,
-32769,
-32764,
-32770,
-32765,
-32768,
-32766,
-32769,
-32764,
-32770,
-32765,
-32768,
-32767,
-32767,
-32766,
-32769,
-32765,
-32768,
-32767,
-32766,
-32769,
-32765,
-32769,
-32764,
-32771,
-32763,
-32771,
-32764,
-32768,
-32767,
-32767,
-32767,
-32768,
-32765,
-32769,
-32765,
-32768,
-32767,
-32767,
-32767,
-32767,
-32766,
-32768,
-32766,
-32769,
-32764,
-32770,
-32764,
-32769,
-32766,
-32769,
-32764,
-32770,
-32763,
-32771,
-32764,
-32770,
-32765,
-32766,
-32770,
-32763,
-32772,
-32762,
-32771,
-32764,
-32769,
-32766,
-32767,
-32768,
-32766,
-32767,
-32767,
-32768,
-32766,
-32768,
-32765,
-32769,
-32765,
-32770,
-32764,
-32768,
-32768,
-32765,
-32769,
-32766,
-32766,
-32770,
-32763,
-32771,
-32764,
-32769,
-32765,
-32769,
-32765,
-32769,
-32765,
-32769,
-32765,
-32769,
-32765,
-32769,
-32765,
-32769,
-32765,
-32769,
-32765,
-32769,
-32766,
-32766,
-32770,
-32762,
-32773,
-32761,
-32772,
-32764,
-32768,
-32767,
-32766,
-32768,
-32767,
-32767,
-32767,
-32766,
-32768,
-32767,
-32767,
-32767,
-32767,
-32766,
-32769,
-32765,
-32769,
-32765,
-32769,
-32764,
-32771,
-32763,
-32770,
-32765,
-32768,
-32767,
-32767,
-32766,
-32768,
-32766,
-32769,
-32764,
-32770,
-32765,
-32768,
-32766,
-32768,
-32766,
-32768,
-32767,
-32765,
-32770,
-32764,
-32770,
-32764,
-32770,
-32765,
-32767,
-32768,
-32766,
-32769,
-32765,
-32768,
-32766,
-32768,
-32767,
-32766,
-32768,
-32766,
-32768,
-32767,
-32766,
-32767,
-32768,
-32765,
-32770,
-32765,
-32767,
-32768,
-32766,
-32768,
-32766,
-32768,
-32766,
-32768,
-32767,
-32766,
-32768,
-32766,
-32768,
-32767,
-32766,
-32768,
-32766,
-32768,
-32767,
-32766,
-32768,
-32765,
-32770,
-32764,
-32769,
-32765,
-32769,
-32766,
-32767,
-32767,
-32766,
-32769,
-32766,
-32767,
-32767,
-32766,
-32769,
-32766,
-32766,
-32769,
-32765,
-32769,
-32765,
-32769,
-32764,
-32771,
-32763,
-32771,
-32763,
-32771,
-32764,
-32768,
-32767,
-32767,
-32766,
-32770,
-32764,
-32768,
-32768,
-32764,
-32771,
-32763,
-32771,
-32764,
-32769,
-32766,
-32766,
-32769,
-32765,
-32769,
-32766,
-32766,
-32769,
-32764,
-32771,
-32764,
-32768,
-32767,
-32766,
-32770,
-32764,
-32769,
-32765,
-32769,
-32766,
-32768,
-32765,
-32770,
-32764,
-32770,
-32764,
-32769,
-32766,
-32768,
-32767,
-32766,
-32768,
-32766,
-32768,
-32767,
-32766,
-32769,
-32764,
-32770,
-32764,
-32770,
-32765,
-32768,
-32766,
-32767,
-32768,
-32766,
-32768,
-32767,
-32766,
-32768,
-32767,
-32766,
-32769,
-32765,
-32768,
-32767,
-32766,
-32769,
-32765,
-32768,
-32767,
-32766,
-32769,
-32765,
-32768,
-32768,
-32765,
-32769,
-32764,
-32771,
-32763,
-32771,
-32763,
-32770,
-32766,
-32767,
-32767,
-32767,
-32767,
-32768,
-32765,
-32770,
-32763,
-32772,
-32762,
-32772,
-32762,
-32771,
-32765,
-32767,
-32768,
-32766,
-32768,
-32766,
-32768,
-32765,
-32770,
-32764,
-32769,
-32767,
-32766,
-32768,
-32766,
-32767,
-32769,
-32764,
-32770,
-32764,
-32769,
-32767,
-32766,
-32768,
-32766,
-32767,
-32768,
-32766,
-32768,
-32766,
-32767,
-32768,
-32766,
-32767,
-32768,
-32765,
-32771,
-32762,
-32771,
-32764,
-32769,
-32766,
-32768,
-32765,
-32770,
-32764,
-32770,
-32764,
-32770,
-32764,
-32770,
-32765,
-32767,
-32768,
-32766,
-32767,
-32769,
-32763,
-32771,
-32764,
-32769,
-32766,
-32768,
-32765,
-32770,
-32764,
-32769,
-32765,
-32770,
-32763,
-32772,
-32762,
-32771,
-32764,
-32770,
-32764,
-32770,
-32765,
-32767,
-32769,
-32765,
-32769,
-32765,
-32767,
-32769,
-32764,
-32771,
-32764,
-32768,
-32767,
-32767,
-32767,
-32767,
-32767,
-32767,
-32768,
-32766,
-32766,
-32769,
-32765,
-32769,
-32766,
-32766,
-32770,
-32764,
-32768,
-32767,
-32766,
-32770,
-32764,
-32768,
-32767,
-32766,
-32769,
-32765,
-32769,
-32765,
-32769,
-32764,
-32771,
-32764,
-32769,
-32766,
-32767,
-32767,
-32768,
-32765,
-32769,
-32766,
-32767,
-32768,
-32765,
-32769,
-32765,
-32769,
-32766,
-32767,
-32767,
-32767,
-32768,
-32766,
-32768,
-32765,
-32769,
-32767,
-32766,
-32768,
-32765,
-32769,
-32766,
-32769,
-32763,
-32771,
-32763,
-32771,
-32764,
-32769,
-32765,
-32769,
-32765,
-32769,
-32765,
-32768,
-32767,
-32767,
-32766,
-32769,
-32765,
-32769,
-32765,
-32768,
-32767,
-32767,
-32767,
-32767,
-32766,
-32769,
-32765,
-32769,
-32764,
-32770,
-32765,
-32768,
-32767,
-32766,
-32767,
-32769,
-32764,
-32770,
-32765,
-32767,
-32768,
-32766,
-32768,
-32767,
-32766,
-32768,
-32766,
-32768,
-32767,
-32766,
-32768,
-32766,
-32768,
-32767,
-32766,
-32768,
-32766,
-32769,
-32764,
-32771,
-32763,
-32770,
-32765,
-32768,
-32767,
-32767,
-32766,
-32769,
-32765,
-32769,
-32764,
-32770,
-32766,
-32766,
-32770,
-32762,
-32772,
-32764,
-32768,
-32767,
-32766,
-32769,
-32765,
-32769,
-32765,
-32768,
-32767,
-32767,
-32767,
-32767,
-32767,
-32767,
-32767,
-32767,
-32767,
-32766,
-32769,
-32765,
-32769,
-32765,
-32769,
-32764,
-32771,
-32763,
-32771,
-32764,
-32768,
-32767,
-32767,
-32766,
-32769,
-32765,
-32768,
-32767,
-32766,
-32767,
-32769,
-32764,
-32770,
-32764,
-32769,
-32765,
-32770,
-32764,
-32769,
-32765,
-32769,
-32765,
-32770,
-32763,
-32771,
-32764,
-32769,
-32765,
-32768,
-32767,
-32767,
-32767,
-32766,
-32768,
-32766,
-32769,
-32765,
-32768,
-32766,
-32768,
-32767,
-32767,
-32766,
-32768,
-32767,
-32766,
-32769,
-32764,
-32770,
-32765,
-32768,
-32766,
-32769,
-32765,
-32769,
-32765,
-32769,
-32765,
-32769,
-32766,
-32767,
-32768,
-32765,
-32769,
-32766,
-32766,
-32769,
-32766,
-32768,
-32766,
-32767,
-32766,
-32771,
-32762,
-32772,
-32762,
-32771,
-32765,
-32768,
-32766,
-32768,
-32766,
-32768,
-32767,
-32766,
-32769,
-32765,
-32768,
-32767,
-32766,
-32769,
-32765,
-32769,
-32765,
-32768,
-32767,
-32767,
-32767,
-32767,
-32767,
-32768,
-32766,
-32767,
-32768,
-32765,
-32770,
-32765,
-32767,
-32768,
-32765,
-32769,
-32766,
-32768,
-32766,
-32767,
-32768,
-32765,
-32769,
-32766,
-32767,
-32768,
-32765,
-32768,
-32768,
-32765,
-32769,
-32765,
-32768,
-32768,
-32765,
-32769,
-32765,
-32768,
-32767,
-32767,
-32767,
-32767,
-32766,
-32768,
-32767,
-32767,
-32767,
-32766,
-32769,
-32765,
-32769,
-32764,
-32770,
-32766,
-32767,
-32767,
-32766,
-32769,
-32765,
-32769,
-32766,
-32766,
-32769,
-32766,
-32766,
-32770,
-32763,
-32771,
-32764,
-32769,
-32765,
-32769,
-32765,
-32770,
-32763,
-32772,
-32762,
-32770,
-32766,
-32767,
-32768,
-32766,
-32767,
-32767,
-32768,
-32766,
-32767,
-32768,
-32765,
-32770,
-32764,
-32769,
-32766,
-32768,
-32766,
-32768,
-32766,
-32767,
-32768,
-32766,
-32767,
-32767,
-32768,
-32766,
-32768,
-32766,
-32767,
-32767,
-32768,
-32766,
-32768,
-32766,
-32767,
-32768,
-32766,
-32768,
-32765,
-32769,
-32767,
-32766,
-32768,
-32766,
-32767,
-32768,
-32766,
-32768,
-32766,
-32768,
-32766,
-32768,
-32767,
-32765,
-32770,
-32765,
-32768,
-32766,
-32768,
-32766,
-32769,
-32765,
-32767,
-32768,
-32766,
-32768,
-32767,
-32766,
-32768,
-32766,
-32768,
-32766,
-32768,
-32766,
-32768,
-32766,
-32768,
-32766,
-32767,
-32768,
-32766,
-32767,
-32768,
-32765,
-32770,
-32765,
-32767,
-32768,
-32765,
-32770,
-32765,
-32768,
-32766,
-32767,
-32769,
-32764,
-32771,
-32762,
-32771,
-32765,
-32768,
-32767,
-32767,
-32767,
-32767,
-32766,
-32768,
-32767,
-32766,
-32770,
-32762,
-32772,
-32762,
-32771,
-32765,
-32767,
-32768,
-32766,
-32768,
-32766,
-32767,
-32767,
-32768,
-32766,
-32768,
-32765,
-32769,
-32765,
-32769,
-32766,
-32767,
-32767,
-32767,
-32767,
-32767,
-32768,
-32766,
-32767,
-32767,
-32767,
-32767,
-32768,
-32766,
-32767,
-32767,
-32767,
-32767,
-32768,
-32766,
-32767,
-32767,
-32768,
-32766,
-32768,
-32766,
-32768,
-32766,
-32768,
-32766,
-32768,
-32767,
-32766,
-32768,
-32766,
-32767,
-32768,
-32766,
-32768,
-32766,
-32767,
-32767,
-32768,
-32765,
-32770,
-32764,
-32769,
-32766,
-32767,
-32767,
-32768,
-32766,
-32767,
-32767,
-32767,
-32766,
-32770,
-32762,
-32772,
-32764,
-32767,
-32769,
-32763,
-32772,
-32764,
-32768,
-32767,
-32765,
-32770,
-32766,
-32766,
-32769,
-32764,
-32770,
-32766,
-32765,
-32770,
-32765,
-32768,
-32767,
-32766,
-32768,
-32767,
-32767,
-32767,
-32767,
-32767,
-32767,
-32767,
-32767,
-32768,
-32765,
-32769,
-32765,
-32769,
-32765,
-32768,
-32766,
-32769,
-32765,
-32768,
-32766,
-32767,
-32768,
-32767,
-32766,
-32768,
-32766,
-32768,
-32766,
-32768,
-32767,
-32766,
-32769,
-32764,
-32770,
-32766,
-32766,
-32770,
-32762,
-32773,
-32762,
-32770,
-32765,
-32769,
-32765,
-32769,
-32765,
-32769,
-32765,
-32769,
-32765,
-32769,
-32766,
-32767,
-32767,
-32767,
-32768,
-32765,
-32769,
-32765,
-32769,
-32765,
-32769,
-32765,
-32769,
-32765,
-32768,
-32767,
-32766,
-32770,
-32763,
-32770,
-32766,
-32766,
-32769,
-32765,
-32768,
-32768,
-32765,
-32768,
-32767,
-32766,
-32768,
-32766,
-32768,
-32766,
-32768,
-32766,
-32767,
-32769,
-32763,
-32772,
-32762,
-32772,
-32762,
-32771,
-32764,
-32770,
-32764,
-32769,
-32765,
-32770,
-32764,
-32770,
-32764,
-32769,
-32767,
-32767,
-32767,
-32767,
-32766,
-32768,
-32768,
-32765,
-32770,
-32763,
-32770,
-32766,
-32767,
-32767,
-32767,
-32767,
-32768,
-32765,
-32769,
-32766,
-32766,
-32770,
-32763,
-32770,
-32766,
-32767,
-32767,
-32767,
-32766,
-32769,
-32765,
-32769,
-32765,
-32768,
-32768,
-32765,
-32769,
-32765,
-32769,
-32766,
-32767,
-32767,
-32768,
-32765,
-32770,
-32763,
-32771,
-32764,
-32769,
-32765,
-32770,
-32763,
-32772,
-32761,
-32773,
-32763,
-32769,
-32766,
-32768,
-32765,
-32770,
-32764,
-32769,
-32767,
-32765,
-32769,
-32766,
-32767,
-32768,
-32766,
-32767,
-32768,
-32765,
-32769,
-32767,
-32764,
-32771,
-32763,
-32771,
-32764,
-32769,
-32765,
-32769,
-32765,
-32768,
-32768,
-32766,
-32768,
-32766,
-32766,
-32769,
-32766,
-32767,
-32768,
-32765,
-32769,
-32766,
-32767,
-32766,
-32769,
-32766,
-32768,
-32766,
-32766,
-32769,
-32766,
-32768,
-32766,
-32767,
-32768,
-32765,
-32770,
-32764,
-32770,
-32764,
-32769,
-32766,
-32768,
-32766,
-32768,
-32766,
-32768,
-32766,
-32768,
-32766,
-32768,
-32767,
-32766,
-32768,
-32766,
-32768,
-32766,
-32768,
-32766,
-32768,
-32766,
-32768,
-32766,
-32767,
-32768,
-32766,
-32768,
-32767,
-32765,
-32769,
-32765,
-32770,
-32765,
-32768,
-32766,
-32767,
-32768,
-32766,
-32768,
-32766,
-32768,
-32766,
-32768,
-32766,
-32767,
-32768,
-32766,
-32767,
-32768,
-32765,
-32769,
-32766,
-32767,
-32768,
-32765,
-32769,
-32765,
-32769,
-32766,
-32767,
-32767,
-32767,
-32767,
-32767,
-32767,
-32766,
-32769,
-32766,
-32766,
-32769,
-32764,
-32770,
-32765,
-32769,
-32764,
-32770,
-32765,
-32768,
-32767,
-32767,
-32767,
-32767,
-32766,
-32768,
-32767,
-32767,
-32766,
-32768,
-32766,
-32768,
-32767,
-32766,
-32768,
-32767,
-32766,
-32769,
-32765,
-32769,
-32765,
-32768,
-32767,
-32766,
-32769,
-32765,
-32769,
-32765,
-32768,
-32766,
-32768,
-32767,
-32766,
-32768,
-32766,
-32767,
-32768,
-32766,
-32768,
-32766,
-32767,
-32768,
-32766,
-32768,
-32767,
-32766,
-32769,
-32765,
-32768,
-32767,
-32767,
-32768,
-32766,
-32767,
-32767,
-32767,
-32768,
-32766,
-32767,
-32767,
-32768,
-32766,
-32768,
-32765,
-32769,
-32767,
-32766,
-32768,
-32765,
-32770,
-32764,
-32769,
-32766,
-32768,
-32766,
-32768,
-32765,
-32770,
-32765,
-32768,
-32766,
-32768,
-32766,
-32768,
-32767,
-32766,
-32768,
-32766,
-32768,
-32767,
-32766,
-32769,
-32763,
-32772,
-32763,
-32770,
-32765,
-32768,
-32765,
-32769,
-32766,
-32768,
-32766,
-32768,
-32765,
-32768,
-32767,
-32768,
-32766,
-32768,
-32764,
-32771,
-32764,
-32770,
-32763,
-32771,
-32764,
-32769,
-32766,
-32766,
-32770,
-32764,
-32769,
-32766,
-32766,
-32770,
-32764,
-32769,
-32766,
-32767,
-32767,
-32768,
-32765,
-32770,
-32764,
-32768,
-32768,
-32765,
-32769,
-32766,
-32766,
-32769,
-32765,
-32769,
-32765,
-32768,
-32768,
-32765,
-32769,
-32766,
-32766,
-32769,
-32767,
-32765,
-32770,
-32763,
-32770,
-32766,
-32767,
-32767,
-32767,
-32766,
-32769,
-32764,
-32770,
-32765,
-32768,
-32766,
-32768,
-32766,
-32768,
-32766,
-32768,
-32766,
-32768,
-32766,
-32767,
-32769,
-32764,
-32770,
-32765,
-32767,
-32769,
-32764,
-32770,
-32765,
-32768,
-32766,
-32768,
-32766,
-32768,
-32766,
-32769,
-32763,
-32773,
-32760,
-32774,
-32761,
-32771,
-32765,
-32768,
-32767,
-32766,
-32768,
-32766,
-32768,
-32767,
-32766,
-32768,
-32766,
-32768,
-32766,
-32768,
-32766,
-32768,
-32765,
-32769,
-32766,
-32768,
-32766,
-32767,
-32767,
-32768,
-32766,
-32767,
-32767,
-32767,
-32768,
-32766,
-32767,
-32767,
-32768,
-32766,
-32767,
-32768,
-32766,
-32768,
-32767,
-32765,
-32769,
-32766,
-32767,
-32768,
-32766,
-32767,
-32768,
-32765,
-32769,
-32766,
-32767,
-32768,
-32766,
-32766,
-32770,
-32764,
-32769,
-32766,
-32767,
-32768,
-32766,
-32767,
-32767,
-32768,
-32766,
-32768,
-32765,
-32769,
-32766,
-32768,
-32765,
-32769,
-32766,
-32767,
-32768,
-32765,
-32769,
-32766,
-32767,
-32767,
-32768,
-32765,
-32769,
-32766,
-32767,
-32767,
-32768,
-32764,
-32772,
-32762,
-32771,
-32764,
-32769,
-32766,
-32767,
-32768,
-32766,
-32767,
-32769,
-32763,
-32771,
-32764,
-32769,
-32766,
-32768,
-32765,
-32769,
-32766,
-32767,
-32767,
-32767,
-32767,
-32768,
-32765,
-32769,
-32765,
-32768,
-32767,
-32766,
-32770,
-32763,
-32770,
-32765,
-32767,
-32769,
-32765,
-32768,
-32767,
-32765,
-32771,
-32763,
-32770,
-32765,
-32768,
-32766,
-32769,
-32765,
-32768,
-32767,
-32766,
-32769,
-32765,
-32768,
-32767,
-32767,
-32767,
-32767,
-32767,
-32768,
-32764,
-32771,
-32763,
-32771,
-32764,
-32768,
-32767,
-32766,
-32768,
-32767,
-32767,
-32767,
-32767,
-32766,
-32768,
-32768,
-32764,
-32771,
-32764,
-32768,
-32768,
-32765,
-32769,
-32765,
-32770,
-32764,
-32769,
-32766,
-32766,
-32770,
-32764,
-32769,
-32765,
-32768,
-32767,
-32768,
-32765,
-32769,
-32765,
-32768,
-32768,
-32766,
-32768,
-32766,
-32768,
-32765,
-32770,
-32764,
-32770,
-32765,
-32767,
-32768,
-32766,
-32767,
-32768,
-32766,
-32767,
-32768,
-32765,
-32770,
-32764,
-32768,
-32767,
-32767,
-32768,
-32766,
-32766,
-32769,
-32765,
-32769,
-32766,
-32767,
-32768,
-32765,
-32769,
-32766,
-32767,
-32769,
-32764,
-32769,
-32766,
-32768,
-32766,
-32769,
-32764,
-32770,
-32764,
-32769,
-32767,
-32765,
-32770,
-32764,
-32769,
-32766,
-32768,
-32765,
-32770,
-32764,
-32770,
-32764,
-32769,
-32766,
-32768,
-32766,
-32767,
-32767,
-32768,
-32765,
-32769,
-32765,
-32769,
-32766,
-32767,
-32767,
-32766,
-32770,
-32764,
-32769,
-32766,
-32766,
-32770,
-32764,
-32769,
-32765,
-32768,
-32768,
-32766,
-32767,
-32766,
-32768,
-32767,
-32768,
-32765,
-32769,
-32765,
-32769,
-32766,
-32767,
-32768,
-32766,
-32768,
-32766,
-32768,
-32766,
-32768,
-32767,
-32765,
-32770,
-32764,
-32769,
-32766,
-32768,
-32766,
-32768,
-32765,
-32769,
-32766,
-32767,
-32768,
-32765,
-32769,
-32766,
-32768,
-32765,
-32769,
-32765,
-32769,
-32767,
-32766,
-32767,
-32768,
-32765,
-32770,
-32764,
-32769,
-32766,
-32767,
-32767,
-32768,
-32765,
-32768,
-32768,
-32764,
-32771,
-32763,
-32770,
-32765,
-32768,
-32767,
-32766,
-32768,
-32767,
-32765,
-32770,
-32765,
-32768,
-32767,
-32766,
-32768,
-32766,
-32769,
-32765,
-32769,
-32765,
-32769,
-32764,
-32771,
-32764,
-32769,
-32766,
-32767,
-32767,
-32768,
-32766,
-32767,
-32768,
-32765,
-32770,
-32764,
-32769,
-32765,
-32769,
-32766,
-32767,
-32767,
-32766,
-32769,
-32765,
-32769,
-32765,
-32768,
-32768,
-32764,
-32771,
-32764,
-32768,
-32767,
-32767,
-32766,
-32770,
-32763,
-32770,
-32765,
-32768,
-32767,
-32766,
-32768,
-32767,
-32766,
-32768,
-32766,
-32768,
-32767,
-32766,
-32768,
-32767,
-32766,
-32769,
-32765,
-32768,
-32767,
-32766,
-32768,
-32767,
-32766,
-32769,
-32764,
-32770,
-32765,
-32768,
-32766,
-32769,
-32764,
-32770,
-32765,
-32767,
-32769,
-32764,
-32770,
-32764,
-32770,
-32765,
-32768,
-32767,
-32766,
-32769,
-32765,
-32768,
-32767,
-32766,
-32769,
-32765,
-32769,
-32765,
-32769,
-32765,
-32769,
-32765,
-32770,
-32764,
-32769,
-32766,
-32766,
-32771,
-32761,
-32773,
-32762,
-32770,
-32766,
-32767,
-32767,
-32768,
-32765,
-32770,
-32763,
-32771,
-32764,
-32770,
-32764,
-32769,
-32765,
-32769,
-32767,
-32765,
-32769,
-32766,
-32767,
-32769,
-32763,
-32771,
-32764,
-32770,
-32764,
-32770,
-32764,
-32769,
-32767,
-32766,
-32767,
-32769,
-32764,
-32770,
-32765,
-32768,
-32766,
-32768,
-32766,
-32768,
-32767,
-32766,
-32768,
-32765,
-32770,
-32765,
-32768,
-32767,
-32766,
-32768,
-32766,
-32769,
-32765,
-32769,
-32765,
-32768,
-32767,
-32767,
-32767,
-32768,
-32765,
-32769,
-32765,
-32769,
-32766,
-32767,
-32768,
-32765,
-32769,
-32765,
-32769,
-32766,
-32767,
-32768,
-32765,
-32769,
-32765,
-32770,
-32763,
-32772,
-32761,
-32772,
-32764,
-32769,
-32766,
-32766,
-32769,
-32765,
-32768,
-32768,
-32765,
-32769,
-32766,
-32767,
-32767,
-32767,
-32767,
-32768,
-32766,
-32767,
-32767,
-32768,
-32765,
-32770,
-32763,
-32771,
-32764,
-32769,
-32766,
-32768,
-32765,
-32769,
-32765,
-32769,
-32765,
-32769,
-32765,
-32769,
-32766,
-32765,
-32771,
-32763,
-32771,
-32763,
-32770,
-32764,
-32770,
-32765,
-32768,
-32766,
-32768,
-32766,
-32767,
-32768,
-32766,
-32768,
-32766,
-32768,
-32766,
-32768,
-32766,
-32768,
-32766,
-32768,
-32766,
-32768,
-32767,
-32766,
-32768,
-32766,
-32768,
-32767,
-32767,
-32766,
-32769,
-32764,
-32770,
-32764,
-32771,
-32763,
-32770,
-32764,
-32770,
-32764,
-32771,
-32762,
-32772,
-32763,
-32770,
-32765,
-32768,
-32767,
-32766,
-32769,
-32765,
-32769,
-32764,
-32771,
-32763,
-32771,
-32764,
-32767,
-32770,
-32764,
-32769,
-32766,
-32766,
-32770,
-32764,
-32770,
-32763,
-32770,
-32766,
-32766,
-32770,
-32763,
-32770,
-32765,
-32768,
-32767,
-32767,
-32767,
-32766,
-32769,
-32765,
-32770,
-32764,
-32769,
-32765,
-32770,
-32764,
-32770,
-32764,
-32769,
-32766,
-32768,
-32766,
-32767,
-32768,
-32765,
-32770,
-32764,
-32770,
-32764,
-32770,
-32764,
-32769,
-32767,
-32765,
-32771,
-32762,
-32772,
-32762,
-32772,
-32763,
-32770,
-32765,
-32768,
-32767,
-32767,
-32766,
-32769,
-32765,
-32769,
-32766,
-32767,
-32767,
-32767,
-32767,
-32768,
-32766,
-32767,
-32767,
-32767,
-32768,
-32766,
-32768,
-32765,
-32769,
-32766,
-32768,
-32766,
-32767,
-32767,
-32767,
-32768,
-32766,
-32767,
-32768,
-32765,
-32770,
-32764,
-32770,
-32764,
-32770,
-32763,
-32772,
-32762,
-32771,
-32765,
-32766,
-32770,
-32763,
-32771,
-32765,
-32767,
-32767,
-32767,
-32767,
-32768,
-32766,
-32767,
-32767,
-32767,
-32767,
-32767,
-32768,
-32765,
-32769,
-32766,
-32766,
-32769,
-32766,
-32767,
-32768,
-32764,
-32771,
-32763,
-32772,
-32761,
-32772,
-32763,
-32770,
-32765,
-32769,
-32765,
-32768,
-32767,
-32766,
-32769,
-32765,
-32768,
-32767,
-32767,
-32767,
-32767,
-32767,
-32767,
-32767,
-32767,
-32767,
-32767,
-32767,
-32766,
-32769,
-32764,
-32771,
-32763,
-32769,
-32767,
-32766,
-32769,
-32764,
-32770,
-32764,
-32770,
-32765,
-32768,
-32766,
-32769,
-32765,
-32769,
-32765,
-32768,
-32768,
-32765,
-32769,
-32765,
-32768,
-32767,
-32767,
-32767,
-32766,
-32769,
-32765,
-32768,
-32767,
-32766,
-32769,
-32765,
-32768,
-32767,
-32766,
-32768,
-32767,
-32766,
-32769,
-32765,
-32768,
-32767,
-32766,
-32769,
-32764,
-32770,
-32765,
-32768,
-32767,
-32765,
-32769,
-32766,
-32767,
-32768,
-32765,
-32768,
-32767,
-32766,
-32769,
-32764,
-32770,
-32764,
-32770,
-32764,
-32769,
-32767,
-32766,
-32768,
-32766,
-32768,
-32766,
-32769,
-32765,
-32768,
-32767,
-32766,
-32769,
-32765,
-32768,
-32767,
-32766,
-32768,
-32767,
-32767,
-32766,
-32768,
-32766,
-32768,
-32767,
-32766,
-32768,
-32766,
-32768,
-32765,
-32770,
-32764,
-32770,
-32764,
-32769,
-32766,
-32768,
-32766,
-32768,
-32766,
-32767,
-32768,
-32766,
-32767,
-32768,
-32765,
-32770,
-32764,
-32769,
-32766,
-32767,
-32768,
-32766,
-32767,
-32768,
-32766,
-32768,
-32766,
-32767,
-32768,
-32766,
-32768,
-32766,
-32768,
-32765,
-32770,
-32764,
-32769,
-32766,
-32767,
-32768,
-32767,
-32766,
-32767,
-32767,
-32769,
-32765,
-32768,
-32766,
-32767,
-32769,
-32764,
-32770,
-32764,
-32769,
-32766,
-32768,
-32766,
-32767,
-32767,
-32767,
-32768,
-32766,
-32767,
-32767,
-32767,
-32768,
-32766,
-32767,
-32767,
-32767,
-32768,
-32766,
-32767,
-32767,
-32767,
-32767,
-32768,
-32766,
-32767,
-32767,
-32767,
-32767,
-32768,
-32765,
-32768,
-32767,
-32767,
-32767,
-32767,
-32767,
-32767,
-32768,
-32765,
-32769,
-32766,
-32768,
-32766,
-32768,
-32766,
-32767,
-32768,
-32766,
-32767,
-32768,
-32765,
-32770,
-32764,
-32770,
-32764,
-32770,
-32765,
-32768,
-32767,
-32766,
-32769,
-32765,
-32769,
-32765,
-32768,
-32767,
-32767,
-32767,
-32767,
-32767,
-32767,
-32767,
-32767,
-32767,
-32767,
-32767,
-32766,
-32769,
-32765,
-32768,
-32767,
-32767,
-32766,
-32768,
-32767,
-32766,
-32769,
-32765,
-32768,
-32767,
-32767,
-32766,
-32770,
-32763,
-32770,
-32765,
-32768,
-32767,
-32767,
-32766,
-32769,
-32765,
-32768,
-32767,
-32766,
-32769,
-32765,
-32769,
-32766,
-32766,
-32769,
-32764,
-32770,
-32766,
-32767,
-32767,
-32766,
-32768,
-32767,
-32767,
-32767,
-32766,
-32768,
-32767,
-32767,
-32766,
-32768,
-32767,
-32767,
-32766,
-32769,
-32764,
-32772,
-32762,
-32771,
-32763,
-32770,
-32766,
-32767,
-32768,
-32765,
-32769,
-32765,
-32769,
-32766,
-32767,
-32768,
-32765,
-32770,
-32764,
-32770,
-32765,
-32767,
-32768,
-32766,
-32769,
-32765,
-32768,
-32767,
-32765,
-32770,
-32765,
-32768,
-32767,
-32766,
-32767,
-32768,
-32765,
-32770,
-32765,
-32768,
-32765,
-32768,
-32767,
-32768,
-32766,
-32767,
-32767,
-32767,
-32767,
-32768,
-32765,
-32769,
-32766,
-32767,
-32768,
-32765,
-32769,
-32766,
-32767,
-32767,
-32767,
-32767,
-32767,
-32767,
-32766,
-32770,
-32764,
-32768,
-32768,
-32764,
-32772,
-32763,
-32768,
-32768,
-32766,
-32767,
-32768,
-32764,
-32772,
-32762,
-32771,
-32763,
-32771,
-32764,
-32769,
-32766,
-32766,
-32770,
-32763,
-32771,
-32764,
-32769,
-32766,
-32767,
-32768,
-32765,
-32770,
-32764,
-32770,
-32764,
-32769,
-32766,
-32768,
-32766,
-32767,
-32767,
-32767,
-32768,
-32766,
-32767,
-32767,
-32767,
-32767,
-32767,
-32768,
-32766,
-32767,
-32768,
-32765,
-32769,
-32766,
-32767,
-32767,
-32768,
-32765,
-32768,
-32768,
-32765,
-32770,
-32764,
-32768,
-32767,
-32768,
-32766,
-32768,
-32765,
-32769,
-32766,
-32767,
-32768,
-32766,
-32767,
-32768,
-32765,
-32770,
-32765,
-32768,
-32766,
-32767,
-32768,
-32767,
-32766,
-32769,
-32763,
-32771,
-32765,
-32767,
-32769,
-32764,
-32769,
-32766,
-32768,
-32766,
-32769,
-32764,
-32770,
-32765,
-32768,
-32767,
-32766,
-32768,
-32767,
-32766,
-32769,
-32764,
-32770,
-32765,
-32768,
-32767,
-32766,
-32768,
-32767,
-32766,
-32769,
-32764,
-32771,
-32762,
-32772,
-32763,
-32770,
-32766,
-32766,
-32768,
-32767,
-32767,
-32767,
-32766,
-32768,
-32767,
-32767,
-32767,
-32766,
-32769,
-32765,
-32769,
-32765,
-32768,
-32768,
-32764,
-32771,
-32763,
-32771,
-32763,
-32770,
-32764,
-32770,
-32765,
-32768,
-32767,
-32766,
-32768,
-32767,
-32766,
-32769,
-32765,
-32768,
-32767,
-32766,
-32769,
-32765,
-32769,
-32764,
-32770,
-32765,
-32768,
-32767,
-32767,
-32766,
-32770,
-32762,
-32772,
-32764,
-32768,
-32767,
-32766,
-32768,
-32766,
-32768,
-32766,
-32767,
-32767,
-32767,
-32767,
-32767,
-32768,
-32765,
-32769,
-32765,
-32768,
-32767,
-32768,
-32765,
-32770,
-32764,
-32768,
-32769,
-32763,
-32772,
-32763,
-32770,
-32764,
-32769,
-32766,
-32767,
-32768,
-32766,
-32767,
-32767,
-32767,
-32768,
-32766,
-32767,
-32768,
-32765,
-32771,
-32762,
-32771,
-32764,
-32770,
-32764,
-32769,
-32765,
-32769,
-32766,
-32768,
-32766,
-32768,
-32765,
-32769,
-32766,
-32769,
-32765,
-32768,
-32766,
-32768,
-32766,
-32768,
-32766,
-32768,
-32766,
-32768,
-32765,
-32769,
-32766,
-32767,
-32768,
-32765,
-32769,
-32766,
-32767,
-32767,
-32767,
-32767,
-32767,
-32768,
-32766,
-32768,
-32765,
-32769,
-32766,
-32768,
-32767,
-32766,
-32767,
-32767,
-32768,
-32766,
-32768,
-32766,
-32767,
-32768,
-32766,
-32768,
-32767,
-32766,
-32768,
-32766,
-32768,
-32767,
-32766,
-32768,
-32766,
-32768,
-32766,
-32768,
-32766,
-32768,
-32765,
-32770,
-32764,
-32770,
-32765,
-32767,
-32767,
-32767,
-32769,
-32763,
-32772,
-32762,
-32771,
-32765,
-32767,
-32767,
-32768,
-32767,
-32766,
-32768,
-32766,
-32768,
-32767,
-32767,
-32766,
-32769,
-32765,
-32769,
-32766,
-32767,
-32767,
-32767,
-32767,
-32768,
-32766,
-32768,
-32766,
-32767,
-32769,
-32763,
-32773,
-32761,
-32771,
-32766,
-32765,
-32770,
-32765,
-32767,
-32769,
-32764,
-32769,
-32767,
-32765,
-32771,
-32762,
-32771,
-32765,
-32767,
-32769,
-32764,
-32770,
-32765,
-32768,
-32767,
-32766,
-32769,
-32764,
-32770,
-32765,
-32767,
-32769,
-32763,
-32772,
-32762,
-32771,
-32764,
-32769,
-32766,
-32767,
-32768,
-32765,
-32769,
-32766,
-32767,
-32767,
-32767,
-32767,
-32768,
-32766,
-32767,
-32767,
-32768,
-32766,
-32767,
-32768,
-32765,
-32769,
-32766,
-32767,
-32767,
-32767,
-32766,
-32769,
-32765,
-32769,
-32765,
-32769,
-32764,
-32771,
-32763,
-32770,
-32765,
-32768,
-32766,
-32769,
-32764,
-32770,
-32764,
-32770,
-32764,
-32770,
-32765,
-32768,
-32767,
-32766,
-32768,
-32767,
-32766,
-32769,
-32765,
-32768,
-32766,
-32769,
-32765,
-32769,
-32765,
-32768,
-32768,
-32765,
-32768,
-32767,
-32767,
-32767,
-32767,
-32766,
-32768,
-32767,
-32766,
-32769,
-32764,
-32769,
-32767,
-32766,
-32768,
-32766,
-32767,
-32768,
-32766,
-32768,
-32766,
-32768,
-32766,
-32769,
-32764,
-32770,
-32765,
-32768,
-32767,
-32767,
-32766,
-32768,
-32767,
-32766,
-32769,
-32764,
-32770,
-32764,
-32771,
-32763,
-32770,
-32764,
-32770,
-32765,
-32769,
-32765,
-32768,
-32767,
-32767,
-32766,
-32769,
-32765,
-32768,
-32767,
-32766,
-32768,
-32767,
-32767,
-32765,
-32770,
-32764,
-32770,
-32765,
-32768,
-32766,
-32768,
-32767,
-32766,
-32769,
-32764,
-32770,
-32765,
-32769,
-32764,
-32770,
-32764,
-32770,
-32765,
-32768,
-32766,
-32768,
-32766,
-32768,
-32767,
-32766,
-32769,
-32764,
-32771,
-32763,
-32770,
-32765,
-32768,
-32768,
-32766,
-32767,
-32767,
-32766,
-32770,
-32764,
-32770,
-32764,
-32768,
-32768,
-32765,
-32769,
-32766,
-32767,
-32767,
-32767,
-32767,
-32768,
-32765,
-32769,
-32765,
-32770,
-32764,
-32769,
-32765,
-32769,
-32767,
-32766,
-32767,
-32768,
-32766,
-32768,
-32766,
-32768,
-32766,
-32768,
-32766,
-32767,
-32768,
-32765,
-32770,
-32763,
-32771,
-32764,
-32768,
-32767,
-32767,
-32767,
-32768,
-32765,
-32769,
-32765,
-32770,
-32764,
-32770,
-32763,
-32771,
-32764,
-32769,
-32766,
-32766,
-32769,
-32765,
-32769,
-32766,
-32766,
-32769,
-32765,
-32768,
-32768,
-32765,
-32768,
-32768,
-32764,
-32770,
-32765,
-32768,
-32767,
-32767,
-32766,
-32769,
-32765,
-32768,
-32768,
-32765,
-32768,
-32767,
-32766,
-32769,
-32765,
-32769,
-32764,
-32770,
-32765,
-32768,
-32767,
-32767,
-32766,
-32768,
-32767,
-32766,
-32768,
-32766,
-32768,
-32766,
-32768,
-32766,
-32768,
-32766,
-32768,
-32765,
-32771,
-32762,
-32772,
-32763,
-32770,
-32764,
-32770,
-32765,
-32768,
-32767,
-32766,
-32769,
-32765,
-32768,
-32767,
-32766,
-32769,
-32765,
-32768,
-32766,
-32768,
-32767,
-32765,
-32770,
-32764,
-32769,
-32767,
-32765,
-32770,
-32764,
-32770,
-32764,
-32769,
-32766,
-32767,
-32768,
-32766,
-32767,
-32767,
-32768,
-32766,
-32768,
-32766,
-32767,
-32768,
-32766,
-32768,
-32767,
-32766,
-32768,
-32766,
-32768,
-32766,
-32768,
-32766,
-32768,
-32766,
-32768,
-32766,
-32768,
-32766,
-32768,
-32766,
-32768,
-32766,
-32768,
-32766,
-32768,
-32767,
-32766,
-32768,
-32766,
-32768,
-32766,
-32769,
-32764,
-32770,
-32765,
-32768,
-32767,
-32766,
-32769,
-32764,
-32771,
-32763,
-32771,
-32763,
-32771,
-32763,
-32770,
-32765,
-32768,
-32767,
-32767,
-32767,
-32766,
-32768,
-32766,
-32768,
-32767,
-32767,
-32766,
-32768,
-32767,
-32766,
-32769,
-32764,
-32770,
-32765,
-32768,
-32767,
-32765,
-32770,
-32765,
-32768,
-32767,
-32766,
-32768,
-32767,
-32766,
-32769,
-32765,
-32768,
-32767,
-32766,
-32768,
-32767,
-32767,
-32766,
-32769,
-32764,
-32771,
-32763,
-32770,
-32765,
-32769,
-32765,
-32769,
-32764,
-32771,
-32763,
-32771,
-32763,
-32770,
-32766,
-32767,
-32768,
-32765,
-32769,
-32766,
-32767,
-32768,
-32765,
-32770,
-32764,
-32769,
-32765,
-32769,
-32766,
-32768,
-32766,
-32767,
-32768,
-32766,
-32768,
-32766,
-32767,
-32768,
-32766,
-32768,
-32766,
-32767,
-32768,
-32766,
-32768,
-32766,
-32767,
-32768,
-32766,
-32768,
-32765,
-32769,
-32765,
-32769,
-32766,
-32767,
-32767,
-32767,
-32766,
-32769,
-32766,
-32767,
-32768,
-32764,
-32771,
-32763,
-32771,
-32764,
-32769,
-32765,
-32769,
-32766,
-32767,
-32767,
-32767,
-32767,
-32768,
-32766,
-32767,
-32767,
-32767,
-32768,
-32765,
-32770,
-32763,
-32771,
-32763,
-32771,
-32764,
-32769,
-32766,
-32767,
-32768,
-32766,
-32767,
-32768,
-32765,
-32770,
-32764,
-32770,
-32764,
-32768,
-32767,
-32767,
-32768,
-32766,
-32766,
-32768,
-32767,
-32767,
-32767,
-32766,
-32768,
-32766,
-32769,
-32765,
-32768,
-32766,
-32767,
-32768,
-32767,
-32766,
-32768,
-32765,
-32770,
-32764,
-32770,
-32764,
-32769,
-32767,
-32766,
-32769,
-32764,
-32769,
-32766,
-32768,
-32766,
-32768,
-32765,
-32769,
-32766,
-32768,
-32766,
-32768,
-32766,
-32768,
-32767,
-32766,
-32769,
-32764,
-32770,
-32765,
-32768,
-32767,
-32766,
-32768,
-32767,
-32766,
-32769,
-32765,
-32769,
-32764,
-32771,
-32763,
-32771,
-32763,
-32770,
-32765,
-32769,
-32766,
-32765,
-32771,
-32762,
-32772,
-32763,
-32769,
-32766,
-32768,
-32766,
-32767,
-32768,
-32766,
-32767,
-32768,
-32766,
-32768,
-32766,
-32768,
-32766,
-32768,
-32766,
-32768,
-32766,
-32769,
-32764,
-32770,
-32765,
-32768,
-32767,
-32766,
-32769,
-32765,
-32769,
-32765,
-32768,
-32767,
-32766,
-32769,
-32765,
-32768,
-32767,
-32766,
-32769,
-32764,
-32771,
-32763,
-32771,
-32763,
-32770,
-32766,
-32766,
-32770,
-32764,
-32768,
-32769,
-32763,
-32771,
-32764,
-32770,
-32764,
-32770,
-32764,
-32769,
-32766,
-32768,
-32766,
-32768,
-32766,
-32768,
-32765,
-32770,
-32763,
-32772,
-32762,
-32772,
-32762,
-32772,
-32761,
-32773,
-32762,
-32772,
-32763,
-32769,
-32765,
-32769,
-32766,
-32768,
-32765,
-32769,
-32766,
-32767,
-32769,
-32764,
-32769,
-32766,
-32767,
-32768,
-32767,
-32767,
-32766,
-32768,
-32766,
-32767,
-32769,
-32764,
-32770,
-32765,
-32767,
-32768,
-32765,
-32770,
-32764,
-32770,
-32764,
-32769,
-32766,
-32767,
-32767,
-32767,
-32768,
-32765,
-32770,
-32763,
-32770,
-32766,
-32767,
-32768,
-32765,
-32769,
-32765,
-32769,
-32766,
-32767,
-32768,
-32765,
-32768,
-32767,
-32768,
-32765,
-32769,
-32765,
-32768,
-32768,
-32765,
-32768,
-32768,
-32765,
-32769,
-32766,
-32767,
-32767,
-32768,
-32765,
-32769,
-32766,
-32766,
-32770,
-32763,
-32772,
-32762,
-32770,
-32766,
-32766,
-32770,
-32764,
-32768,
-32767,
-32766,
-32768,
-32767,
-32767,
-32766,
-32769,
-32764,
-32770,
-32765,
-32768,
-32767,
-32767,
-32767,
-32767,
-32767,
-32766,
-32769,
-32766,
-32767,
-32768,
-32765,
-32769,
-32765,
-32770,
-32764,
-32769,
-32766,
-32767,
-32767,
-32768,
-32765,
-32770,
-32764,
-32768,
-32767,
-32767,
-32768,
-32766,
-32767,
-32767,
-32767,
-32768,
-32766,
-32768,
-32766,
-32768,
-32766,
-32767,
-32768,
-32766,
-32768,
-32766,
-32767,
-32768,
-32766,
-32767,
-32768,
-32765,
-32770,
-32764,
-32769,
-32766,
-32767,
-32768,
-32765,
-32769,
-32765,
-32769,
-32766,
-32767,
-32767,
-32767,
-32767,
-32767,
-32768,
-32765,
-32768,
-32768,
-32765,
-32770,
-32764,
-32768,
-32767,
-32768,
-32766,
-32768,
-32766,
-32767,
-32767,
-32768,
-32766,
-32768,
-32765,
-32769,
-32765,
-32769,
-32766,
-32767,
-32767,
-32768,
-32765,
-32769,
-32766,
-32766,
-32769,
-32766,
-32767,
-32767,
-32766,
-32768,
-32766,
-32769,
-32765,
-32768,
-32766,
-32768,
-32766,
-32769,
-32765,
-32768,
-32767,
-32766,
-32769,
-32765,
-32769,
-32765,
-32768,
-32767,
-32767,
-32766,
-32769,
-32764,
-32770,
-32765,
-32768,
-32767,
-32766,
-32768,
-32767,
-32766,
-32770,
-32763,
-32770,
-32765,
-32769,
-32765,
-32769,
-32766,
-32767,
-32767,
-32766,
-32769,
-32765,
-32769,
-32764,
-32770,
-32765,
-32768,
-32767,
-32765,
-32770,
-32765,
-32767,
-32769,
-32764,
-32770,
-32765,
-32767,
-32769,
-32763,
-32772,
-32763,
-32769,
-32767,
-32765,
-32769,
-32767,
-32766,
-32768,
-32767,
-32765,
-32771,
-32763,
-32770,
-32766,
-32766,
-32769,
-32765,
-32769,
-32766,
-32766,
-32769,
-32765,
-32769,
-32765,
-32769,
-32765,
-32769,
-32766,
-32765,
-32772,
-32762,
-32771,
-32765,
-32767,
-32767,
-32768,
-32766,
-32769,
-32764,
-32769,
-32767,
-32765,
-32771,
-32763,
-32769,
-32768,
-32764,
-32770,
-32765,
-32769,
-32765,
-32769,
-32765,
-32768,
-32767,
-32767,
-32767,
-32767,
-32767,
-32767,
-32767,
-32767,
-32767,
-32768,
-32765,
-32769,
-32765,
-32769,
-32766,
-32767,
-32767,
-32766,
-32770,
-32763,
-32771,
-32763,
-32770,
-32765,
-32769,
-32765,
-32768,
-32767,
-32765,
-32770,
-32765,
-32767,
-32769,
-32764,
-32769,
-32766,
-32767,
-32767,
-32769,
-32764,
-32769,
-32766,
-32766,
-32770,
-32765,
-32768,
-32766,
-32767,
-32768,
-32766,
-32768,
-32766,
-32767,
-32768,
-32765,
-32769,
-32765,
-32769,
-32766,
-32767,
-32768,
-32765,
-32770,
-32764,
-32770,
-32764,
-32770,
-32765,
-32767,
-32769,
-32763,
-32772,
-32763,
-32769,
-32766,
-32767,
-32767,
-32768,
-32766,
-32767,
-32768,
-32766,
-32766,
-32771,
-32761,
-32774,
-32761,
-32770,
-32766,
-32768,
-32766,
-32769,
-32763,
-32771,
-32764,
-32769,
-32767,
-32766,
-32768,
-32765,
-32770,
-32763,
-32771,
-32765,
-32767,
-32769,
-32764,
-32769,
-32766,
-32768,
-32767,
-32767,
-32766,
-32768,
-32767,
-32766,
-32768,
-32767,
-32767,
-32767,
-32767,
-32765,
-32770,
-32765,
-32769,
-32765,
-32768,
-32766,
-32768,
-32767,
-32766,
-32768,
-32767,
-32766,
-32769,
-32764,
-32770,
-32764,
-32770,
-32764,
-32770,
-32764,
-32770,
-32764,
-32769,
-32766,
-32768,
-32766,
-32768,
-32766,
-32767,
-32768,
-32766,
-32768,
-32767,
-32765,
-32770,
-32764,
-32770,
-32765,
-32768,
-32767,
-32766,
-32769,
-32765,
-32768,
-32767,
-32766,
-32769,
-32764,
-32771,
-32763,
-32770,
-32765,
-32767,
-32769,
-32765,
-32769,
-32765,
-32768,
-32767,
-32766,
-32769,
-32765,
-32769,
-32766,
-32766,
-32769,
-32765,
-32770,
-32763,
-32771,
-32763,
-32771,
-32763,
-32771,
-32764,
-32769,
-32766,
-32767,
-32767,
-32768,
-32766,
-32768,
-32766,
-32768,
-32766,
-32768,
-32766,
-32767,
-32768,
-32767,
-32766,
-32768,
-32765,
-32769,
-32767,
-32766,
-32768,
-32765,
-32769,
-32766,
-32767,
-32768,
-32765,
-32769,
-32765,
-32769,
-32765,
-32769,
-32766,
-32767,
-32767,
-32767,
-32767,
-32768,
-32766,
-32767,
-32767,
-32768,
-32766,
-32768,
-32766,
-32767,
-32768,
-32765,
-32770,
-32764,
-32770,
-32764,
-32770,
-32764,
-32770,
-32765,
-32768,
-32767,
-32766,
-32768,
-32767,
-32766,
-32769,
-32764,
-32769,
-32766,
-32769,
-32764,
-32770,
-32764,
-32769,
-32766,
-32769,
-32764,
-32770,
-32764,
-32769,
-32767,
-32767,
-32766,
-32768,
-32766,
-32768,
-32767,
-32766,
-32768,
-32766,
-32768,
-32767,
-32766,
-32768,
-32766,
-32768,
-32766,
-32768,
-32766,
-32769,
-32765,
-32767,
-32769,
-32764,
-32771,
-32763,
-32771,
-32763,
-32771,
-32764,
-32769,
-32766,
-32767,
-32767,
-32768,
-32766,
-32768,
-32765,
-32769,
-32766,
-32767,
-32769,
-32764,
-32769,
-32767,
-32765,
-32771,
-32763,
-32770,
-32764,
-32771,
-32762,
-32773,
-32761,
-32771,
-32766,
-32766,
-32768,
-32767,
-32766,
-32768,
-32767,
-32766,
-32768,
-32767,
-32765,
-32771,
-32762,
-32772,
-32763,
-32769,
-32767,
-32766,
-32769,
-32764,
-32770,
-32765,
-32769,
-32765,
-32768,
-32767,
-32767,
-32767,
-32767,
-32767,
-32768,
-32765,
-32769,
-32765,
-32769,
-32766,
-32767,
-32767,
-32767,
-32767,
-32767,
-32767,
-32767,
-32767,
-32767,
-32767,
-32767,
-32768,
-32765,
-32769,
-32766,
-32768,
-32766,
-32768,
-32766,
-32768,
-32766,
-32768,
-32767,
-32766,
-32768,
-32765,
-32770,
-32764,
-32771,
-32762,
-32771,
-32764,
-32770,
-32765,
-32768,
-32767,
-32766,
-32769,
-32765,
-32768,
-32767,
-32767,
-32767,
-32767,
-32767,
-32767,
-32767,
-32767,
-32766,
-32770,
-32763,
-32771,
-32764,
-32768,
-32768,
-32765,
-32769,
-32766,
-32767,
-32768,
-32765,
-32769,
-32766,
-32768,
-32766,
-32767,
-32767,
-32769,
-32764,
-32770,
-32764,
-32770,
-32766,
-32766,
-32768,
-32767,
-32767,
-32767,
-32766,
-32768,
-32766,
-32769,
-32765,
-32768,
-32766,
-32768,
-32767,
-32767,
-32767,
-32766,
-32768,
-32767,
-32767,
-32767,
-32767,
-32766,
-32769,
-32765,
-32768,
-32767,
-32767,
-32766,
-32769,
-32764,
-32770,
-32765,
-32767,
-32769,
-32765,
-32768,
-32767,
-32765,
-32771,
-32763,
-32770,
-32765,
-32768,
-32767,
-32766,
-32768,
-32766,
-32768,
-32767,
-32765,
-32770,
-32764,
-32769,
-32766,
-32767,
-32767,
-32768,
-32766,
-32766,
-32770,
-32763,
-32771,
-32764,
-32769,
-32766,
-32767,
-32767,
-32767,
-32767,
-32768,
-32765,
-32768,
-32767,
-32767,
-32767,
-32767,
-32766,
-32769,
-32765,
-32769,
-32765,
-32768,
-32767,
-32767,
-32767,
-32767,
-32766,
-32769,
-32765,
-32769,
-32765,
-32768,
-32767,
-32767,
-32767,
-32766,
-32768,
-32767,
-32767,
-32767,
-32766,
-32768,
-32767,
-32767,
-32767,
-32767,
-32766,
-32768,
-32767,
-32766,
-32769,
-32765,
-32767,
-32769,
-32764,
-32771,
-32763,
-32769,
-32767,
-32767,
-32767,
-32767,
-32765,
-32771,
-32763,
-32771,
-32763,
-32770,
-32765,
-32769,
-32766,
-32767,
-32766,
-32769,
-32765,
-32769,
-32766,
-32765,
-32771,
-32763,
-32770,
-32765,
-32769,
-32765,
-32768,
-32767,
-32767,
-32767,
-32767,
-32767,
-32767,
-32767,
-32767,
-32767,
-32767,
-32767,
-32766,
-32769,
-32765,
-32769,
-32765,
-32768,
-32768,
-32765,
-32769,
-32765,
-32768,
-32767,
-32767,
-32767,
-32767,
-32767,
-32767,
-32767,
-32767,
-32766,
-32769,
-32766,
-32767,
-32768,
-32765,
-32768,
-32768,
-32765,
-32770,
-32764,
-32769,
-32766,
-32767,
-32768,
-32766,
-32768,
-32766,
-32767,
-32768,
-32766,
-32768,
-32766,
-32767,
-32768,
-32766,
-32768,
-32766,
-32768,
-32766,
-32768,
-32766,
-32767,
-32769,
-32764,
-32771,
-32763,
-32769,
-32768,
-32764,
-32771,
-32763,
-32770,
-32766,
-32766,
-32769,
-32764,
-32770,
-32765,
-32768,
-32767,
-32766,
-32769,
-32764,
-32770,
-32765,
-32769,
-32765,
-32769,
-32764,
-32770,
-32765,
-32768,
-32767,
-32766,
-32767,
-32768,
-32766,
-32768,
-32766,
-32768,
-32766,
-32768,
-32765,
-32770,
-32764,
-32770,
-32764,
-32769,
-32767,
-32765,
-32770,
-32764,
-32769,
-32767,
-32766,
-32767,
-32768,
-32765,
-32771,
-32762,
-32771,
-32764,
-32769,
-32766,
-32768,
-32766,
-32767,
-32769,
-32764,
-32770,
-32764,
-32769,
-32767,
-32767,
-32767,
-32766,
-32768,
-32766,
-32769,
-32765,
-32768,
-32766,
-32767,
-32768,
-32766,
-32768,
-32766,
-32768,
-32765,
-32769,
-32766,
-32768,
-32767,
-32765,
-32769,
-32766,
-32767,
-32768,
-32765,
-32769,
-32765,
-32769,
-32765,
-32769,
-32765,
-32769,
-32765,
-32768,
-32768,
-32765,
-32769,
-32765,
-32769,
-32766,
-32767,
-32767,
-32767,
-32768,
-32767,
-32765,
-32769,
-32766,
-32767,
-32769,
-32764,
-32770,
-32764,
-32769,
-32766,
-32767,
-32768,
-32765,
-32769,
-32765,
-32769,
-32765,
-32768,
-32767,
-32766,
-32768,
-32766,
-32769,
-32764,
-32770,
-32764,
-32769,
-32767,
-32767,
-32766,
-32769,
-32764,
-32770,
-32766,
-32767,
-32766,
-32769,
-32764,
-32771,
-32764,
-32768,
-32767,
-32766,
-32768,
-32768,
-32764,
-32771,
-32763,
-32770,
-32766,
-32766,
-32769,
-32765,
-32769,
-32765,
-32769,
-32765,
-32769,
-32765,
-32769,
-32765,
-32769,
-32765,
-32769,
-32765,
-32769,
-32765,
-32770,
-32763,
-32770,
-32765,
-32768,
-32768,
-32764,
-32771,
-32762,
-32773,
-32760,
-32774,
-32761,
-32772,
-32763,
-32769,
-32766,
-32768,
-32766,
-32769,
-32763,
-32771,
-32764,
-32769,
-32767,
-32765,
-32770,
-32764,
-32770,
-32764,
-32770,
-32765,
-32768,
-32767,
-32766,
-32769,
-32765,
-32769,
-32765,
-32768,
-32768,
-32765,
-32769,
-32765,
-32769,
-32765,
-32770,
-32763,
-32771,
-32763,
-32771,
-32764,
-32769,
-32766,
-32767,
-32768,
-32765,
-32769,
-32766,
-32768,
-32766,
-32767,
-32768,
-32766,
-32768,
-32766,
-32767,
-32769,
-32763,
-32772,
-32762,
-32772,
-32762,
-32771,
-32765,
-32767,
-32769,
-32765,
-32768,
-32768,
-32765,
-32768,
-32767,
-32766,
-32770,
-32764,
-32768,
-32767,
-32766,
-32769,
-32765,
-32769,
-32765,
-32769,
-32764,
-32771,
-32763,
-32770,
-32765,
-32768,
-32766,
-32769,
-32765,
-32767,
-32769,
-32764,
-32770,
-32766,
-32766,
-32769,
-32765,
-32768,
-32767,
-32766,
-32769,
-32765,
-32768,
-32767,
-32766,
-32769,
-32765,
-32768,
-32767,
-32766,
-32769,
-32765,
-32768,
-32766,
-32768,
-32767,
-32767,
-32767,
-32766,
-32768,
-32767,
-32768,
-32766,
-32768,
-32765,
-32769,
-32766,
-32768,
-32766,
-32768,
-32765,
-32769,
-32766,
-32767,
-32768,
-32765,
-32769,
-32766,
-32768,
-32766,
-32768,
-32766,
-32767,
-32768,
-32766,
-32768,
-32766,
-32767,
-32767,
-32767,
-32768,
-32764,
-32772,
-32761,
-32772,
-32764,
-32767,
-32770,
-32762,
-32772,
-32764,
-32768,
-32767,
-32766,
-32768,
-32767,
-32767,
-32767,
-32766,
-32768,
-32767,
-32766,
-32769,
-32765,
-32768,
-32767,
-32767,
-32767,
-32767,
-32768,
-32765,
-32770,
-32765,
-32767,
-32768,
-32766,
-32768,
-32767,
-32766,
-32768,
-32766,
-32769,
-32764,
-32770,
-32765,
-32767,
-32769,
-32764,
-32769,
-32767,
-32766,
-32768,
-32766,
-32768,
-32765,
-32770,
-32765,
-32768,
-32767,
-32766,
-32768,
-32766,
-32769,
-32765,
-32768,
-32767,
-32767,
-32767,
-32767,
-32767,
-32767,
-32767,
-32768,
-32766,
-32768,
-32766,
-32767,
-32768,
-32766,
-32767,
-32768,
-32765,
-32770,
-32763,
-32771,
-32763,
-32771,
-32764,
-32768,
-32767,
-32766,
-32769,
-32765,
-32768,
-32766,
-32768,
-32766,
-32769,
-32764,
-32770,
-32764,
-32769,
-32767,
-32766,
-32768,
-32766,
-32767,
-32768,
-32766,
-32768,
-32766,
-32767,
-32768,
-32765,
-32770,
-32764,
-32769,
-32766,
-32767,
-32768,
-32765,
-32770,
-32763,
-32771,
-32764,
-32769,
-32766,
-32767,
-32767,
-32768,
-32765,
-32769,
-32766,
-32767,
-32768,
-32765,
-32770,
-32763,
-32772,
-32762,
-32771,
-32764,
-32769,
-32767,
-32766,
-32768,
-32766,
-32768,
-32767,
-32766,
-32768,
-32766,
-32768,
-32767,
-32766,
-32768,
-32766,
-32768,
-32767,
-32767,
-32767,
-32767,
-32766,
-32769,
-32765,
-32768,
-32767,
-32766,
-32769,
-32765,
-32768,
-32766,
-32769,
-32765,
-32769,
-32765,
-32769,
-32765,
-32769,
-32766,
-32767,
-32767,
-32767,
-32766,
-32770,
-32764,
-32769,
-32766,
-32767,
-32767,
-32768,
-32766,
-32767,
-32768,
-32766,
-32768,
-32766,
-32768,
-32765,
-32769,
-32766,
-32767,
-32767,
-32767,
-32767,
-32767,
-32766,
-32768,
-32766,
-32769,
-32765,
-32768,
-32766,
-32768,
-32767,
-32767,
-32766,
-32769,
-32764,
-32770,
-32766,
-32766,
-32770,
-32763,
-32769,
-32767,
-32767,
-32766,
-32769,
-32764,
-32769,
-32767,
-32766,
-32767,
-32768,
-32766,
-32768,
-32766,
-32767,
-32768,
-32766,
-32768,
-32765,
-32770,
-32764,
-32769,
-32766,
-32767,
-32769,
-32764,
-32770,
-32763,
-32771,
-32765,
-32768,
-32766,
-32768,
-32766,
-32768,
-32766,
-32767,
-32769,
-32764,
-32770,
-32763,
-32771,
-32764,
-32770,
-32764,
-32769,
-32765,
-32769,
-32766,
-32768,
-32766,
-32767,
-32768,
-32765,
-32770,
-32764,
-32770,
-32764,
-32769,
-32766,
-32768,
-32767,
-32766,
-32767,
-32768,
-32766,
-32768,
-32767,
-32765,
-32770,
-32764,
-32770,
-32765,
-32768,
-32766,
-32768,
-32767,
-32766,
-32769,
-32764,
-32769,
-32767,
-32765,
-32770,
-32764,
-32769,
-32766,
-32767,
-32767,
-32767,
-32767,
-32767,
-32768,
-32765,
-32769,
-32765,
-32769,
-32765,
-32770,
-32764,
-32769,
-32765,
-32769,
-32766,
-32768,
-32765,
-32769,
-32766,
-32768,
-32766,
-32767,
-32767,
-32768,
-32766,
-32768,
-32766,
-32767,
-32768,
-32766,
-32768,
-32765,
-32770,
-32764,
-32770,
-32765,
-32767,
-32768,
-32766,
-32767,
-32768,
-32766,
-32768,
-32766,
-32768,
-32765,
-32769,
-32766,
-32768,
-32767,
-32766,
-32767,
-32768,
-32766,
-32768,
-32766,
-32767,
-32768,
-32766,
-32768,
-32765,
-32769,
-32766,
-32767,
-32769,
-32763,
-32772,
-32762,
-32771,
-32764,
-32769,
-32766,
-32768,
-32766,
-32767,
-32767,
-32767,
-32768,
-32766
-};
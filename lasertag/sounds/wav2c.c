@@ -1,234 +1,362 @@
-#include <stdio.h>
-#include <stdint.h>
+#include <ctype.h>
+#include <math.h>
 #include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <ctype.h>
 
+#include "adpcm.h"
 
-// Leave the following line uncommented unless you want to generate a simple tone.
-//#define GENERATE_TONE
-
-#define MAX_FILENAME_LENGTH 512 // Max size for buffers.
-#define WAV_SUFFIX "wav"        // The file must end in .wav
-#define H_FILE_SUFFIX ".h"      // .h files have this suffix.
-#define C_FILE_SUFFIX ".c"      // .c files have this suffix.
-#define EXTERN_STATEMENT "extern"  // Just the C extern statement.
-#define C_DATA_TYPE "uint16_t"  // Type for data in the .c file
-#define SUPPORTED_WAVE_DATA_BIT_SIZE 16  // Program can only handle this size of data for now.
-
-// Header-specific defines. All sizes are numbered in bytes.
-#define CHUNKID "RIFF"          // String
-#define CHUNKID_SIZE 5          // Make room for the NULL.
-#define CHUNKSIZE_SIZE 4        // Number
-#define FORMAT "WAVE"           // File must be of this FORMAT.
-#define FORMAT_SIZE 5           // Make room for the NULL.
-#define SUBCHUNK1ID "fmt "      // String.
-#define SUBCHUNK1ID_SIZE 5      // Make room for NULL.
-#define AUDIO_FORMAT_SIZE 2     // Number.
-#define NUM_CHANNELS_SIZE 2     // Number.
-#define SAMPLE_RATE_SIZE 4      // Number.
-#define BYTE_RATE_SIZE 4        // Number.
-#define BLOCK_ALIGN_SIZE 2      // Number.
-#define BITS_PER_SAMPLE_SIZE 2  // Number.
-#define SUBCHUNK2ID "data"      // String
-#define SUBCHUNK2ID_SIZE 5      // Make room for NULL>
-#define SUBCHUNK2SIZE 4         // Number.
-
-// This is the header for the wave vile.
-typedef struct  {
-  char chunkId[CHUNKID_SIZE];     // Should contain "RIFF". Add room for NULL.
-  uint32_t chunkSize;             // Size of the entire file minus 8 bytes (chunkSize + chunkSize).
-  char format[FORMAT_SIZE];       // Should contain "WAVE". Add room for NULL.
-  char subchunk1Id[FORMAT_SIZE];  // Should contain the letters "fmt ". Add room for NULL.
-  uint32_t subchunk1Size;  // Should be 16 for PCM.
-  uint16_t audioFormat;    // Will be 1 for PCM. This program can only handle PCM.
-  uint16_t numChannels;    // Will be 1 for mono, 2 for stereo.
-  uint32_t sampleRate;     // The sample rate.
-  uint32_t byteRate;       // == sampleRate * numChannels * bitsPerSample/8.
-  uint16_t blockAlign;     // == numChannels * bitsPerSample/8.
-  uint16_t bitsPerSample;  // 8 bits, 16 bits, etc.
-  char subchunk2Id[SUBCHUNK2ID_SIZE];     // Should contain "data". Add room for NULL.
-  uint32_t subchunk2Size;  // Number of remaining bytes in the file (the actual data).
-} waveFileHeader_t;
-
-// Reads in the header.
-void readWaveFileHeader(FILE* wavFile, waveFileHeader_t* header) {
-  fread(header->chunkId, sizeof(header->chunkId)-1, 1, wavFile);
-  header->chunkId[4] = '\0';  // Makes easier to print as a string.
-  fread(&(header->chunkSize), 4, 1, wavFile);
-  fread(header->format, sizeof(header->format)-1, 1, wavFile);
-  header->format[4] = '\0';  // Makes easier to print as a string.
-  fread(header->subchunk1Id, sizeof(header->subchunk1Id)-1, 1, wavFile);
-  header->subchunk1Id[4] = '\0';  // Makes easier to print as a string.
-  fread(&header->subchunk1Size, 4, 1, wavFile);
-  fread(&header->audioFormat, 2, 1, wavFile);
-  fread(&header->numChannels, 2, 1, wavFile);
-  fread(&header->sampleRate, 4, 1, wavFile);
-  fread(&header->byteRate, 4, 1, wavFile);
-  fread(&header->blockAlign, 2, 1, wavFile);
-  fread(&header->bitsPerSample, 2, 1, wavFile);
-  fread(header->subchunk2Id, 4, 1, wavFile);
-  header->subchunk2Id[4] = '\0';  // Makes easier to print as a string.
-  fread(&header->subchunk2Size, 4, 1, wavFile);
-}
+// Host tool that turns the .wav sound assets into the sound bank. The build
+// runs it in two steps (see CMakeLists.txt) so only changed assets are redone:
+//
+//   wav2c -o name.adpcm name.wav
+//     Reads a mono 16-bit PCM .wav file, resamples it to the CODEC rate if it
+//     isn't already, IMA-ADPCM encodes it (see adpcm.h) and writes the result
+//     with its metadata to name.adpcm. Prints the decoded SNR.
+//
+//   wav2c --bank soundBank.c soundBank.h a.adpcm b.adpcm ...
+//     Packs the encoded sounds into one aligned array, soundBank_data, with an
+//     index table, soundBank_entries, and an enum with one id per sound,
+//     SOUND_BANK_<NAME>, in the order given.
+//
+// To build by hand:
+//   gcc -o wav2c wav2c.c adpcm.c -lm
 
-// Prints the header to the outputStream.
-void printWaveFileHeader(FILE* outputStream, waveFileHeader_t* header) {
-  fprintf(outputStream, "chunkId:            \"%s\"\n", header->chunkId);
-  fprintf(outputStream, "chunkSize:          %d\n", header->chunkSize);
-  fprintf(outputStream, "format:             \"%s\"\n", header->format);
-  fprintf(outputStream, "subchunkId:         \"%s\"\n", header->subchunk1Id);
-  fprintf(outputStream, "subchunk1Size:      %d\n", header->subchunk1Size);
-  fprintf(outputStream, "audio format:       %d\n", header->audioFormat);
-  fprintf(outputStream, "number of channels: %d\n", header->numChannels);
-  fprintf(outputStream, "sample rate:        %d\n", header->sampleRate);
-  fprintf(outputStream, "byte rate:          %d\n", header->byteRate);
-  fprintf(outputStream, "block align:        %d\n", header->blockAlign);
-  fprintf(outputStream, "bits per sample:    %d\n", header->bitsPerSample);
-  fprintf(outputStream, "subchunk2Id:        \"%s\"\n", header->subchunk2Id);
-  fprintf(outputStream, "subchunk2Size:      %d\n", header->subchunk2Size);
-}
+#define CODEC_SAMPLE_RATE_HZ 48000 // Every sound is resampled to this.
+#define BANK_ALIGNMENT 32          // Bytes, a Cortex-A9 cache line.
+#define BYTES_PER_LINE 16          // Bytes per line of the generated array.
+#define MAX_FILENAME_LENGTH 512    // Max size for buffers.
+#define SUPPORTED_WAVE_DATA_BIT_SIZE 16 // Only 16-bit data for now.
+#define PCM_AUDIO_FORMAT 1              // Uncompressed.
 
-// Returns true if the header looks OK by inspecting various fixed-value fields, false otherwise.
-// Prints out informational messages if the os (output stream) argument is non-NULL.
-bool waveFileHeaderOk(FILE* os, waveFileHeader_t* header) {
-  bool isOk = true;  // Be optimistic.
-  if (strncmp(header->chunkId, CHUNKID, CHUNKID_SIZE)) {
-    isOk = false;
-    if (os)
-      fprintf(os, "ERROR: chunkId (%s) is incorrect. Should be: %s\n", header->chunkId, CHUNKID); 
+// The .wav file is a RIFF file: a "RIFF" header then chunks, each an id and
+// a size. Only the "fmt " and "data" chunks matter, others are skipped.
+#define RIFF_ID "RIFF"
+#define WAVE_FORMAT "WAVE"
+#define FORMAT_CHUNK_ID "fmt "
+#define DATA_CHUNK_ID "data"
+#define CHUNK_ID_SIZE 4
+#define FORMAT_CHUNK_MIN_SIZE 16
+
+// Windowed-sinc resampling: each output sample is a Blackman-windowed sinc of
+// the input samples around it, cut off at the lower of the two Nyquist rates.
+#define RESAMPLE_HALF_WIDTH 32 // Zero crossings on each side of the center.
+
+// The .adpcm file is this header, then byteCount bytes of encoded samples.
+#define ENCODED_MAGIC 0x4D435041 // "APCM", little-endian.
+typedef struct {
+  uint32_t magic;
+  uint32_t sampleRateHz;
+  uint32_t sampleCount;
+  uint32_t byteCount;
+} encodedHeader_t;
+
+// The fields of the "fmt " chunk that matter.
+typedef struct {
+  uint16_t audioFormat;   // Will be 1 for PCM, the only format handled.
+  uint16_t numChannels;   // Will be 1 for mono, 2 for stereo.
+  uint32_t sampleRate;    // The sample rate.
+  uint16_t bitsPerSample; // 8 bits, 16 bits, etc.
+} waveFormat_t;
+
+// Reads a little-endian value of byteCount bytes. Returns false at the end of
+// the file.
+static bool readLittleEndian(FILE *file, uint32_t byteCount, uint32_t *value) {
+  *value = 0;
+  for (uint32_t i = 0; i < byteCount; i++) {
+    int byte = fgetc(file);
+    if (byte == EOF)
+      return false;
+    *value |= (uint32_t)byte << (8 * i);
   }
-  if (strncmp(header->format, FORMAT, FORMAT_SIZE)) {
-    isOk = false;
-    if (os)
-      fprintf(os, "ERROR: format (%s) is incorrect. Should be: %s\n", header->format, FORMAT); 
+  return true;
+}
+
+// Reads the samples of a mono 16-bit PCM .wav file. Returns them, allocated,
+// with their count and rate, or NULL after printing what is wrong.
+static int16_t *readWaveFile(const char *fileName, uint32_t *sampleCount,
+                             uint32_t *sampleRate) {
+  FILE *file = fopen(fileName, "rb");
+  if (file == NULL) {
+    fprintf(stderr, "ERROR: unable to open %s.\n", fileName);
+    return NULL;
   }
-  if (strncmp(header->subchunk1Id, SUBCHUNK1ID, SUBCHUNK1ID_SIZE)) {
-    isOk = false;
-    if (os)
-      fprintf(os, "ERROR: subchunkId (%s) is incorrect. Should be: %s\n", header->subchunk1Id, SUBCHUNK1ID); 
+  char id[CHUNK_ID_SIZE + 1] = {0}; // Add room for NULL.
+  char format[CHUNK_ID_SIZE + 1] = {0};
+  uint32_t size;
+  if (fread(id, CHUNK_ID_SIZE, 1, file) != 1 || strcmp(id, RIFF_ID) ||
+      !readLittleEndian(file, 4, &size) ||
+      fread(format, CHUNK_ID_SIZE, 1, file) != 1 ||
+      strcmp(format, WAVE_FORMAT)) {
+    fprintf(stderr, "ERROR: %s is not a .wav file.\n", fileName);
+    fclose(file);
+    return NULL;
   }
-  if (strncmp(header->subchunk2Id, SUBCHUNK2ID, SUBCHUNK2ID_SIZE)) {
-    isOk = false;
-    if (os)
-      fprintf(os, "ERROR: subchunk2Id (%s) is incorrect. Should be: %s\n", header->subchunk2Id, SUBCHUNK2ID); 
+  waveFormat_t wave;
+  bool haveFormat = false;
+  int16_t *samples = NULL;
+  // Walk the chunks until the data, which must come after the format.
+  while (fread(id, CHUNK_ID_SIZE, 1, file) == 1 &&
+         readLittleEndian(file, 4, &size)) {
+    if (!strcmp(id, FORMAT_CHUNK_ID) && size >= FORMAT_CHUNK_MIN_SIZE) {
+      uint32_t value;
+      readLittleEndian(file, 2, &value);
+      wave.audioFormat = value;
+      readLittleEndian(file, 2, &value);
+      wave.numChannels = value;
+      readLittleEndian(file, 4, &wave.sampleRate);
+      readLittleEndian(file, 4, &value); // Byte rate, implied by the rest.
+      readLittleEndian(file, 2, &value); // Block align, ditto.
+      readLittleEndian(file, 2, &value);
+      wave.bitsPerSample = value;
+      fseek(file, size - FORMAT_CHUNK_MIN_SIZE + (size & 1), SEEK_CUR);
+      haveFormat = true;
+    } else if (!strcmp(id, DATA_CHUNK_ID) && haveFormat) {
+      if (wave.audioFormat != PCM_AUDIO_FORMAT || wave.numChannels != 1 ||
+          wave.bitsPerSample != SUPPORTED_WAVE_DATA_BIT_SIZE) {
+        fprintf(stderr,
+                "ERROR: %s is format %d, %d channels, %d-bit. This program "
+                "can only process mono %d-bit PCM data.\n",
+                fileName, wave.audioFormat, wave.numChannels,
+                wave.bitsPerSample, SUPPORTED_WAVE_DATA_BIT_SIZE);
+        break;
+      }
+      *sampleCount = size / sizeof(int16_t);
+      *sampleRate = wave.sampleRate;
+      samples = malloc(*sampleCount * sizeof(int16_t) + 1);
+      for (uint32_t i = 0; samples && i < *sampleCount; i++) {
+        uint32_t value;
+        if (!readLittleEndian(file, 2, &value)) {
+          fprintf(stderr, "ERROR: %s is shorter than its header says.\n",
+                  fileName);
+          free(samples);
+          samples = NULL;
+        } else {
+          samples[i] = (int16_t)value; // PCM data is signed.
+        }
+      }
+      break;
+    } else {
+      fseek(file, size + (size & 1), SEEK_CUR); // Chunks are word aligned.
+    }
   }
-  return isOk;
+  if (samples == NULL && haveFormat)
+    fprintf(stderr, "ERROR: no usable data in %s.\n", fileName);
+  else if (!haveFormat)
+    fprintf(stderr, "ERROR: %s has no format chunk.\n", fileName);
+  fclose(file);
+  return samples;
 }
 
-// Return the file's extension (.suffix). 
-const char *get_filename_extension(const char* fileName) {
-  const char *dot = strrchr(fileName, '.');  // Find the last occurrence of "."
-  if (!dot || dot == fileName) return "";    // If "." doesn't exist or if file name starts with ".", return empty string.
-  return dot + 1;                            // Advance to the string that follows "."
+// Returns the Blackman-windowed sinc at x, which is zero outside
+// -halfWidth..halfWidth.
+static double windowedSinc(double x, double halfWidth) {
+  if (fabs(x) >= halfWidth)
+    return 0.0;
+  double sinc = x == 0.0 ? 1.0 : sin(M_PI * x) / (M_PI * x);
+  double phase = M_PI * (x / halfWidth + 1.0); // 0 to 2 pi across the window.
+  return sinc * (0.42 - 0.5 * cos(phase) + 0.08 * cos(2 * phase));
 }
 
-int main(int argc, char* argv[]) {
-  // Print a helpful error message and exit if a file-name was not provided on the command line.
-  if (argc != 2) {
-    fprintf(stderr, "Usage: wav2c filename.wav\n");
-    exit(-1);
+// Resamples inputCount samples from inputRate to outputRate. Returns the
+// samples, allocated, and their count.
+static int16_t *resample(const int16_t input[], uint32_t inputCount,
+                         uint32_t inputRate, uint32_t outputRate,
+                         uint32_t *outputCount) {
+  *outputCount = (uint32_t)((uint64_t)inputCount * outputRate / inputRate);
+  int16_t *output = malloc(*outputCount * sizeof(int16_t) + 1);
+  // Scale the sinc to the lower Nyquist rate so downsampling doesn't alias.
+  double scale = outputRate < inputRate ? (double)outputRate / inputRate : 1.0;
+  double halfWidth = RESAMPLE_HALF_WIDTH / scale; // In input samples.
+  for (uint32_t i = 0; output && i < *outputCount; i++) {
+    double center = (double)i * inputRate / outputRate;
+    int32_t first = (int32_t)ceil(center - halfWidth);
+    int32_t last = (int32_t)floor(center + halfWidth);
+    double sum = 0.0;
+    if (first < 0)
+      first = 0;
+    if (last >= (int32_t)inputCount)
+      last = inputCount - 1;
+    for (int32_t j = first; j <= last; j++)
+      sum += input[j] * windowedSinc((j - center) * scale, RESAMPLE_HALF_WIDTH);
+    sum *= scale;
+    output[i] = sum > INT16_MAX   ? INT16_MAX
+                : sum < INT16_MIN ? INT16_MIN
+                                  : (int16_t)lround(sum);
   }
-  char inputFileName[MAX_FILENAME_LENGTH];         // Create a working buffer.
-  strncpy(inputFileName, argv[1], MAX_FILENAME_LENGTH);  // Copy the argv[1] filename into the working buffer.
-  // Make sure that the file-name has a .wav suffix.
-  const char* extension = get_filename_extension(inputFileName);  // Get the suffix.
-  // Compare the suffix and generate an error message if it is incorrect.
-  if (strncmp(extension, WAV_SUFFIX, MAX_FILENAME_LENGTH)) {              
-    fprintf(stderr, "ERROR: input file-name \"%s\" does not have a %s suffix.\n", inputFileName, WAV_SUFFIX);
-    exit(-1);  // Exit because of the error.
-  }
-  
-  // Try to open the file.
-  FILE* inputFileFp = fopen(inputFileName, "rb");
-  if (inputFileFp == NULL) {
-    printf("unable to find file:%s\n", argv[1]);
-    exit(-1);
-  }
-  // File is present and has correct extension if you get this far.
-  waveFileHeader_t header;
-  readWaveFileHeader(inputFileFp, &header);  // Read the header.
-  if (!waveFileHeaderOk(stderr, &header)) {  // Check the header.
-    fprintf(stderr, "ERROR: Input file (%s) contains errors. Maybe not a .wav file? See proceeding messages for details.\n", inputFileName);
-    printWaveFileHeader(stderr, &header);
-    exit(-1);
+  return output;
+}
+
+// Encodes one .wav file into an .adpcm file. Returns the exit status.
+static int encodeWaveFile(const char *inputFileName,
+                          const char *outputFileName) {
+  uint32_t sampleCount;
+  uint32_t sampleRate;
+  int16_t *samples = readWaveFile(inputFileName, &sampleCount, &sampleRate);
+  if (samples == NULL)
+    return EXIT_FAILURE;
+  if (sampleRate != CODEC_SAMPLE_RATE_HZ) {
+    uint32_t resampledCount;
+    int16_t *resampled = resample(samples, sampleCount, sampleRate,
+                                  CODEC_SAMPLE_RATE_HZ, &resampledCount);
+    fprintf(stderr, "%s: resampled %d Hz to %d Hz.\n", inputFileName,
+            sampleRate, CODEC_SAMPLE_RATE_HZ);
+    free(samples);
+    samples = resampled;
+    sampleCount = resampledCount;
   }
-  // File contents look good if you get this far.
-  // Only handle mono files for now, check for this and exit if the file is not mono.
-  if (header.numChannels > 1) {
-    fprintf(stderr, "INFO: wave file contains stereo data. This program only handles monophonic data for now. Exiting...\n");
-    exit(-1);
+  encodedHeader_t header = {ENCODED_MAGIC, CODEC_SAMPLE_RATE_HZ, sampleCount,
+                            adpcm_getEncodedByteCount(sampleCount)};
+  uint8_t *encoded = malloc(header.byteCount + 1);
+  int16_t *decoded = malloc(sampleCount * sizeof(int16_t) + 1);
+  if (samples == NULL || encoded == NULL || decoded == NULL) {
+    fprintf(stderr, "ERROR: unable to allocate memory for %d samples.\n",
+            sampleCount);
+    return EXIT_FAILURE;
   }
-  // Only handle 16-bit data for now.
-  if (header.bitsPerSample != SUPPORTED_WAVE_DATA_BIT_SIZE) {
-    fprintf(stderr, "INFO: wave file contains %d-bit data. This program can only process %d-bit data. Exiting...\n", header.bitsPerSample, SUPPORTED_WAVE_DATA_BIT_SIZE);
-    exit(-1);
+  adpcm_encode(samples, sampleCount, encoded);
+  // Report how close the decoded sound is to the original.
+  adpcm_decode(encoded, sampleCount, decoded);
+  fprintf(stderr, "%s: %d samples, %d bytes encoded, decoded SNR: %.2f dB\n",
+          inputFileName, sampleCount, header.byteCount,
+          adpcm_computeSnr(samples, decoded, sampleCount));
+  FILE *output = fopen(outputFileName, "wb");
+  if (output == NULL ||
+      fwrite(&header, sizeof(header), 1, output) != 1 ||
+      fwrite(encoded, header.byteCount, 1, output) != 1) {
+    fprintf(stderr, "ERROR: unable to write %s.\n", outputFileName);
+    if (output != NULL)
+      fclose(output);
+    return EXIT_FAILURE;
   }
-  printWaveFileHeader(stderr, &header);
-  // Everything looks good. Go ahead and generate the .h and .c files. Exit with an error if either file already exists.
-  // First, open the .h file and output the necessary declarations. Then, close the .h file.
-  char hFileName[MAX_FILENAME_LENGTH];                     // .h file-name.
-  strncpy(hFileName, inputFileName, MAX_FILENAME_LENGTH);  // Basename is just the input-file-name.
-  strncat(hFileName, H_FILE_SUFFIX, MAX_FILENAME_LENGTH);  // Add the suffix.
-  char cFileName[MAX_FILENAME_LENGTH];                     // .c file-name. 
-  strncpy(cFileName, inputFileName, MAX_FILENAME_LENGTH);  // Basename is just the input-file-name.
-  strncat(cFileName, C_FILE_SUFFIX, MAX_FILENAME_LENGTH);  // Add the suffix.
-
-  FILE* hFileFp = fopen(hFileName, "r");
-  FILE* cFileFp = fopen(cFileName, "r");
-  // If you get this far, you can go ahead and open the .c and .h files for write.
-  hFileFp = fopen(hFileName, "w");
-  cFileFp = fopen(cFileName, "w");
-  // Ensure that both files opened OK for write.
-  if ((!hFileFp && cFileFp)) {
-    if (!hFileFp)
-      fprintf(stderr, "Unable to open file: %s for writing.\n", hFileName);
-    if (!cFileFp)
-      fprintf(stderr, "Unable to open file: %s for writing.\n", cFileName);
-    exit(-1);
+  fclose(output);
+  free(samples);
+  free(encoded);
+  free(decoded);
+  return EXIT_SUCCESS;
+}
+
+// Copies the file-name part of path, without its directory or extension, into
+// name.
+static void getBaseName(const char *path, char name[]) {
+  const char *slash = strrchr(path, '/');
+  strncpy(name, slash ? slash + 1 : path, MAX_FILENAME_LENGTH - 1);
+  name[MAX_FILENAME_LENGTH - 1] = '\0';
+  char *dot = strchr(name, '.');
+  if (dot != NULL)
+    *dot = '\0';
+}
+
+// Closes the files writeBank() has open after an error. Returns the exit
+// status.
+static int closeBankFiles(FILE *input, FILE *cFile, FILE *hFile) {
+  if (input != NULL)
+    fclose(input);
+  if (cFile != NULL)
+    fclose(cFile);
+  if (hFile != NULL)
+    fclose(hFile);
+  return EXIT_FAILURE;
+}
+
+// Packs the .adpcm files into one array with an index table. Returns the exit
+// status.
+static int writeBank(const char *cFileName, const char *hFileName,
+                     char *encodedFileNames[], int soundCount) {
+  FILE *cFile = fopen(cFileName, "w");
+  FILE *hFile = fopen(hFileName, "w");
+  if (cFile == NULL || hFile == NULL) {
+    fprintf(stderr, "ERROR: unable to open %s and %s for writing.\n",
+            cFileName, hFileName);
+    return closeBankFiles(NULL, cFile, hFile);
   }
-  char arrayName[MAX_FILENAME_LENGTH];  // Array name will be created here.
-  uint32_t i = 0;
-  // Need to create an array name with no ".". Replace all "." with underscore.
-  for (i=0; inputFileName[i] != '\0'; i++) {
-    if (inputFileName[i] == '.') {
-      arrayName[i] = '_';
-    } else {
-      arrayName[i] = inputFileName[i];
+  fprintf(hFile, "// Generated by wav2c --bank, do not edit.\n");
+  fprintf(hFile, "#ifndef SOUNDBANK_H_\n#define SOUNDBANK_H_\n\n");
+  fprintf(hFile, "#include <stdint.h>\n\n");
+  fprintf(hFile, "// Every sound is IMA-ADPCM encoded (see adpcm.h) at this "
+                 "rate.\n");
+  fprintf(hFile, "#define SOUND_BANK_SAMPLE_RATE_HZ %d\n",
+          CODEC_SAMPLE_RATE_HZ);
+  fprintf(hFile, "#define SOUND_BANK_ALIGNMENT %d\n\n", BANK_ALIGNMENT);
+  fprintf(hFile, "typedef enum {\n");
+  fprintf(cFile, "// Generated by wav2c --bank, do not edit.\n\n");
+  fprintf(cFile, "#include \"soundBank.h\"\n\n");
+  fprintf(cFile, "const uint8_t soundBank_data[] __attribute__((aligned(%d)))"
+                 " = {\n", BANK_ALIGNMENT);
+  encodedHeader_t *headers = malloc(soundCount * sizeof(encodedHeader_t) + 1);
+  uint32_t *offsets = malloc(soundCount * sizeof(uint32_t) + 1);
+  uint32_t offset = 0;
+  for (int sound = 0; sound < soundCount; sound++) {
+    FILE *input = fopen(encodedFileNames[sound], "rb");
+    encodedHeader_t *header = &headers[sound];
+    if (input == NULL || fread(header, sizeof(*header), 1, input) != 1 ||
+        header->magic != ENCODED_MAGIC) {
+      fprintf(stderr, "ERROR: %s is not an .adpcm file from wav2c.\n",
+              encodedFileNames[sound]);
+      return closeBankFiles(input, cFile, hFile);
     }
-    arrayName[i+1] = '\0';  // Make sure to terminate the string.
-  }
-  // Generate an upper-case version of arrayName;
-  char arrayNameUpperCase[MAX_FILENAME_LENGTH];
-  for (i=0; arrayName[i] != '\0'; i++) {
-    arrayNameUpperCase[i] = toupper(arrayName[i]);
+    // Pad to the alignment, so every sound starts on a cache line.
+    for (; offset % BANK_ALIGNMENT; offset++)
+      fprintf(cFile, "0x00,%s", (offset + 1) % BYTES_PER_LINE ? "" : "\n");
+    offsets[sound] = offset;
+    for (uint32_t i = 0; i < header->byteCount; i++, offset++) {
+      int byte = fgetc(input);
+      if (byte == EOF) {
+        fprintf(stderr, "ERROR: %s is shorter than its header says.\n",
+                encodedFileNames[sound]);
+        return closeBankFiles(input, cFile, hFile);
+      }
+      fprintf(cFile, "0x%02x,%s", byte,
+              (offset + 1) % BYTES_PER_LINE ? "" : "\n");
+    }
+    fclose(input);
+    char name[MAX_FILENAME_LENGTH];
+    getBaseName(encodedFileNames[sound], name);
+    for (char *c = name; *c; c++)
+      *c = isalnum((unsigned char)*c) ? toupper((unsigned char)*c) : '_';
+    fprintf(hFile, "  SOUND_BANK_%s,\n", name);
   }
-  arrayNameUpperCase[i+1] = '\0';  // Make sure to terminate the string.
- 
-  // .h file just needs a comment and an extern statement.
-  fprintf(hFileFp, "// This file was generated by executing this statement: wav2c %s\n", inputFileName);
-  fprintf(hFileFp, "%s uint16_t %s[];\n", EXTERN_STATEMENT, arrayName);
-  fprintf(hFileFp, "#define %s_SAMPLE_RATE %d\n", arrayNameUpperCase, header.sampleRate*10);
-  fprintf(hFileFp, "#define %s_BITS_PER_SAMPLE %d\n", arrayNameUpperCase, header.bitsPerSample);
-  fprintf(hFileFp, "#define %s_NUMBER_OF_SAMPLES %d\n", arrayNameUpperCase, header.subchunk2Size/2);
-  fclose(hFileFp);
-  // .c file will contain the data in array form as follows.
-  uint32_t arraySize = header.subchunk2Size/2;  // Wave file is counted by bytes, output file is counted in 16-bit words.
-  // Write some helpful comments to the .c file.
-  fprintf(cFileFp, "// This file was generated by executing this statement: wav2c %s\n", inputFileName);
-  fprintf(cFileFp, "\n#include <stdint.h>\n\n");
-  fprintf(cFileFp, "%s %s[%d] = {\n", C_DATA_TYPE, arrayName, arraySize);
-  // File pointer to the input file should be pointing at the first value after the header is read, so just start from there.
-  for (i=0; i<header.subchunk2Size/2; i++) {
-    int16_t data;  // Program only handles 16-bit PCM data for now. PCM data is signed.
-    fread(&data, header.blockAlign, 1, inputFileFp);  // Read 2 bytes into a signed 16-bit variable.
-    uint16_t unsignedData = data + INT16_MAX;         // Offset to unsigned for the sound CODEC.
-    fprintf(cFileFp, "%d", unsignedData);             // Write the unsiged data.
-    if (i != (header.subchunk2Size/2)-1)              // Don't place the last comma.
-      fprintf(cFileFp, ",\n");                        // Delimited data.
+  fprintf(cFile, "\n};\n\n");
+  fprintf(hFile, "  SOUND_BANK_COUNT\n} soundBank_id_t;\n\n");
+  fprintf(hFile, "typedef struct {\n");
+  fprintf(hFile, "  const char *name;     // The .wav file it came from.\n");
+  fprintf(hFile, "  uint32_t offset;      // Of its data in soundBank_data.\n");
+  fprintf(hFile, "  uint32_t byteCount;   // Of its encoded data.\n");
+  fprintf(hFile, "  uint32_t sampleCount; // Once decoded.\n");
+  fprintf(hFile, "  uint32_t sampleRateHz;\n");
+  fprintf(hFile, "} soundBank_entry_t;\n\n");
+  fprintf(hFile, "extern const uint8_t soundBank_data[];\n");
+  fprintf(hFile, "extern const soundBank_entry_t "
+                 "soundBank_entries[SOUND_BANK_COUNT];\n\n");
+  fprintf(hFile, "#endif /* SOUNDBANK_H_ */\n");
+  fprintf(cFile, "const soundBank_entry_t soundBank_entries[SOUND_BANK_COUNT] "
+                 "= {\n");
+  for (int sound = 0; sound < soundCount; sound++) {
+    char name[MAX_FILENAME_LENGTH];
+    getBaseName(encodedFileNames[sound], name);
+    fprintf(cFile, "    {\"%s\", %d, %d, %d, %d},\n", name, offsets[sound],
+            headers[sound].byteCount, headers[sound].sampleCount,
+            headers[sound].sampleRateHz);
   }
-  fprintf(cFileFp, "\n};\n");  // Close the array.
-  fclose(cFileFp);             // Close the .h file.
-  fclose(inputFileFp);         // Close the input file.
+  fprintf(cFile, "};\n");
+  fprintf(stderr, "sound bank: %d sounds, %d bytes.\n", soundCount, offset);
+  fclose(cFile);
+  fclose(hFile);
+  free(headers);
+  free(offsets);
+  return EXIT_SUCCESS;
+}
+
+int main(int argc, char *argv[]) {
+  if (argc == 4 && !strcmp(argv[1], "-o"))
+    return encodeWaveFile(argv[3], argv[2]);
+  if (argc >= 5 && !strcmp(argv[1], "--bank"))
+    return writeBank(argv[2], argv[3], &argv[4], argc - 4);
+  // Print a helpful error message and exit if the arguments are wrong.
+  fprintf(stderr, "Usage: wav2c -o name.adpcm name.wav\n"
+                  "       wav2c --bank soundBank.c soundBank.h "
+                  "a.adpcm [b.adpcm ...]\n");
+  return EXIT_FAILURE;
 }
@@ -20,6 +20,13 @@ For questions, contact Brad Hutchings or Jeff Goeders, https://ece.byu.edu/
 // frequency as set by transmitter_setFrequencyNumber(). The step counts for the
 // frequencies are provided in filter.h
 
+// Uncomment this, and build transmitterPwm.c instead of transmitter.c, to have
+// AXI interval timer 2 generate the square wave in hardware. transmitter_tick()
+// then only counts down the burst. The hardware design must route the timer's
+// pwm0 output to the transmitter, TRANSMITTER_OUTPUT_PIN is not used. The
+// run-time statistics lose the detector time, which was measured with timer 2.
+//#define TRANSMITTER_USE_TIMER_PWM
+
 // Standard init function.
 void transmitter_init();
 
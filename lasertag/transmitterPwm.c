@@ -0,0 +1,195 @@
+/*
+This software is provided for student assignment use in the Department of
+Electrical and Computer Engineering, Brigham Young University, Utah, USA.
+Users agree to not re-host, or redistribute the software, in source or binary
+form, to other persons or other institutions. Users may modify and use the
+source code for personal or educational use.
+For questions, contact Brad Hutchings or Jeff Goeders, https://ece.byu.edu/
+*/
+
+#include <stdio.h>
+
+#include "buttons.h"
+#include "filter.h"
+#include "intervalTimer.h"
+#include "switches.h"
+#include "transmitter.h"
+#include "utils.h"
+
+// Implements transmitter.h with an AXI interval timer in PWM mode, build this
+// instead of transmitter.c. The timer generates the square wave, so nothing
+// toggles a pin on every tick and every edge lands on the 100 MHz timer clock
+// instead of wherever the ISR happens to run. transmitter_tick() only counts
+// down the 200 ms burst, and at the end of one either stops the timer or, in
+// continuous mode, switches to the newest frequency and starts the next burst.
+// The frequencies are the same as the tick-based version, from
+// filter_frequencyTickTable.
+
+#ifndef TRANSMITTER_USE_TIMER_PWM
+#error "Define TRANSMITTER_USE_TIMER_PWM in transmitter.h to use this file."
+#endif
+
+#define TRANSMITTER_PWM_TIMER INTERVAL_TIMER_2
+#define TRANSMITTER_PWM_CYCLES_PER_TICK 1000 // 100 MHz timer, 100 kHz ticks.
+#define TRANSMITTER_TICKS_PER_SECOND 100000
+
+// The non-continuous test waits this long between bursts.
+#define TRANSMITTER_TEST_DEAD_TIME_IN_MS 300
+
+static volatile uint16_t frequencyNumber; // The current setting.
+static volatile bool continuousModeFlag;
+// Ticks left in the current burst, 0 when the transmitter is not running. Set
+// by transmitter_run() only while it is 0, otherwise only the tick changes it.
+static volatile uint32_t burstTickCount;
+
+// Returns the period of the current frequency in timer clock cycles.
+static uint32_t transmitter_getPeriodCycles() {
+  return (uint32_t)filter_frequencyTickTable[frequencyNumber] *
+         TRANSMITTER_PWM_CYCLES_PER_TICK;
+}
+
+// Standard init function.
+void transmitter_init() {
+  frequencyNumber = 0;
+  continuousModeFlag = false;
+  burstTickCount = 0;
+  uint32_t periodCycles = transmitter_getPeriodCycles();
+  intervalTimer_initPwm(TRANSMITTER_PWM_TIMER, periodCycles, periodCycles / 2);
+}
+
+// Programs the timer for the current frequency setting.
+static void transmitter_setPwmFrequency() {
+  uint32_t periodCycles = transmitter_getPeriodCycles();
+  intervalTimer_setPwm(TRANSMITTER_PWM_TIMER, periodCycles, periodCycles / 2);
+}
+
+// Standard tick function. Only counts down the burst, the timer generates the
+// square wave.
+void transmitter_tick() {
+  if (burstTickCount == 0 || --burstTickCount != 0)
+    return;
+  if (continuousModeFlag) {
+    // Takes effect at the end of the current period, so there is no glitch.
+    transmitter_setPwmFrequency();
+    burstTickCount = TRANSMITTER_PULSE_WIDTH;
+  } else {
+    intervalTimer_stopPwm(TRANSMITTER_PWM_TIMER);
+  }
+}
+
+// Activate the transmitter.
+void transmitter_run() {
+  if (burstTickCount != 0)
+    return;
+  transmitter_setPwmFrequency();
+  intervalTimer_startPwm(TRANSMITTER_PWM_TIMER);
+  // Set last, the tick ignores the transmitter until now.
+  burstTickCount = TRANSMITTER_PULSE_WIDTH;
+}
+
+// Returns true if the transmitter is still running.
+bool transmitter_running() { return burstTickCount != 0; }
+
+// Sets the frequency number. If this function is called while the
+// transmitter is running, the frequency will not be updated until the
+// transmitter stops and transmitter_run() is called again, or the next burst
+// in continuous mode.
+void transmitter_setFrequencyNumber(uint16_t number) {
+  if (number >= FILTER_FREQUENCY_COUNT) {
+    printf("transmitter_setFrequencyNumber(): %d is not a frequency number.\n",
+           number);
+    return;
+  }
+  frequencyNumber = number;
+}
+
+// Returns the current frequency setting.
+uint16_t transmitter_getFrequencyNumber() { return frequencyNumber; }
+
+// Runs the transmitter continuously. When continuous mode is turned off the
+// current burst is finished.
+void transmitter_setContinuousMode(bool flag) { continuousModeFlag = flag; }
+
+// Returns the frequency number selected by the slide switches, the highest one
+// if the switches are past the end.
+static uint16_t transmitter_getSwitchFrequencyNumber() {
+  uint16_t number = switches_read() & 0xF;
+  return number < FILTER_FREQUENCY_COUNT ? number : FILTER_FREQUENCY_COUNT - 1;
+}
+
+// Runs a burst at every frequency, calling transmitter_tick() here, and checks
+// that each burst lasts TRANSMITTER_PULSE_WIDTH ticks. Then checks that
+// continuous mode keeps going and finishes its burst when turned off.
+void transmitter_runTest() {
+  printf("starting transmitter_runTest()\n");
+  transmitter_init();
+  bool passed = true;
+  for (uint16_t number = 0; number < FILTER_FREQUENCY_COUNT; number++) {
+    transmitter_setFrequencyNumber(number);
+    transmitter_run();
+    uint32_t ticks = 0;
+    while (transmitter_running() && ticks <= TRANSMITTER_PULSE_WIDTH) {
+      transmitter_tick();
+      ticks++;
+    }
+    double hz = (double)TRANSMITTER_TICKS_PER_SECOND /
+                filter_frequencyTickTable[number];
+    printf("frequency %d: %7.1f Hz for %ld ticks\n", number, hz, (long)ticks);
+    if (ticks != TRANSMITTER_PULSE_WIDTH) {
+      printf("transmitter_runTest(): burst should be %d ticks.\n",
+             TRANSMITTER_PULSE_WIDTH);
+      passed = false;
+    }
+  }
+  transmitter_setContinuousMode(true);
+  transmitter_run();
+  for (uint32_t i = 0; i < 3 * TRANSMITTER_PULSE_WIDTH; i++)
+    transmitter_tick();
+  if (!transmitter_running()) {
+    printf("transmitter_runTest(): continuous mode stopped.\n");
+    passed = false;
+  }
+  transmitter_setContinuousMode(false);
+  uint32_t ticks = 0;
+  while (transmitter_running() && ticks <= TRANSMITTER_PULSE_WIDTH) {
+    transmitter_tick();
+    ticks++;
+  }
+  if (transmitter_running()) {
+    printf("transmitter_runTest(): continuous mode didn't stop.\n");
+    passed = false;
+  }
+  printf("transmitter_runTest() %s\n", passed ? "passed" : "failed");
+  printf("exiting transmitter_runTest()\n");
+}
+
+// Tests the transmitter in non-continuous mode, until BTN1 is pressed. Needs
+// the ISR running transmitter_tick().
+void transmitter_runNoncontinuousTest() {
+  printf("starting transmitter_runNoncontinuousTest()\n");
+  transmitter_setContinuousMode(false);
+  while (!(buttons_read() & BUTTONS_BTN1_MASK)) {
+    transmitter_setFrequencyNumber(transmitter_getSwitchFrequencyNumber());
+    transmitter_run();
+    while (transmitter_running())
+      ;
+    utils_msDelay(TRANSMITTER_TEST_DEAD_TIME_IN_MS);
+  }
+  while (buttons_read() & BUTTONS_BTN1_MASK)
+    ; // Wait for BTN1 to be released.
+  printf("exiting transmitter_runNoncontinuousTest()\n");
+}
+
+// Tests the transmitter in continuous mode, until BTN1 is pressed. Needs the
+// ISR running transmitter_tick().
+void transmitter_runContinuousTest() {
+  printf("starting transmitter_runContinuousTest()\n");
+  transmitter_setContinuousMode(true);
+  transmitter_run();
+  while (!(buttons_read() & BUTTONS_BTN1_MASK))
+    transmitter_setFrequencyNumber(transmitter_getSwitchFrequencyNumber());
+  transmitter_setContinuousMode(false);
+  while (transmitter_running() || (buttons_read() & BUTTONS_BTN1_MASK))
+    ; // Finish the burst and wait for BTN1 to be released.
+  printf("exiting transmitter_runContinuousTest()\n");
+}
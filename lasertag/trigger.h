@@ -14,7 +14,8 @@ For questions, contact Brad Hutchings or Jeff Goeders, https://ece.byu.edu/
 
 // The trigger state machine debounces both the press and release of gun
 // trigger. Ultimately, it will activate the transmitter when a debounced press
-// is detected.
+// is detected. Each shot should also go in the event journal with
+// eventJournal_recordShot() (see eventJournal.h).
 
 typedef uint16_t trigger_shotsRemaining_t;
 
@@ -1,9 +1,24 @@
+# Build with "cmake -DEMU=1 -DEMU_HEADLESS=1" to run the labs without the GUI,
+# in virtual time (see platforms/emulator/headless/headless.h).
+option(EMU_HEADLESS "Use the headless, virtual-time emulator instead of Qt" OFF)
+
+if (EMU_HEADLESS)
+
+# The headless emulator library is built from platforms/emulator/headless.
+set(EMU_LIBS emu_headless pthread)
+
+else()
+
 find_package(Qt5 COMPONENTS Widgets REQUIRED)
 find_package(Qt5 COMPONENTS Gui REQUIRED)
 find_package(Qt5 COMPONENTS Core REQUIRED)
 
 add_definitions(-DQT_NO_VERSION_TAGGING)
 
+set(EMU_LIBS emu Qt5Widgets Qt5Gui Qt5Core pthread)
+
+endif()
+
 # add_compile_options("-O2")
 # add_compile_options("-Wall")
 # add_compile_options("-W")
@@ -13,4 +28,4 @@ add_definitions(-DQT_NO_VERSION_TAGGING)
 # add_compile_options("-DQT_NO_DEBUG")
 # add_compile_options("-DQT_WIDGETS_LIB")
 # add_compile_options("-DQT_GUI_LIB")
-# add_compile_options("-DQT_CORE_LIB")
\ No newline at end of file
+# add_compile_options("-DQT_CORE_LIB")
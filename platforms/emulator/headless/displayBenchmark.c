@@ -0,0 +1,262 @@
+/*
+This software is provided for student assignment use in the Department of
+Electrical and Computer Engineering, Brigham Young University, Utah, USA.
+
+Users agree to not re-host, or redistribute the software, in source or binary
+form, to other persons or other institutions. Users may modify and use the
+source code for personal or educational use.
+
+For questions, contact Brad Hutchings or Jeff Goeders, https://ece.byu.edu/
+*/
+
+// Measures what drawing costs the program in the headless emulator. Run it
+// with and without --sync-display to compare the render thread with drawing
+// on the program thread:
+//  1. display_test(), the Adafruit graphics test, and the time until it is
+//     all on the screen.
+//  2. A missile command game tick, with the timers, missile counts and speeds
+//     of lab 8 and its main_m3.c loop: the game timer ISR sets a flag and the
+//     main loop draws a tick for each one. A tick that takes too long misses
+//     the next one, the game then runs slower than the timer.
+// With --speed 1 virtual time runs as fast as the host's, like the board.
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "display.h"
+#include "headless.h"
+#include "interrupts.h"
+#include "intervalTimer.h"
+
+// From lab8_missilecommand/config.h.
+#define BENCHMARK_TOUCHSCREEN_TIMER_PERIOD 10.0E-3
+#define BENCHMARK_GAME_TIMER_PERIOD 45.0E-3
+#define BENCHMARK_ENEMY_MISSILE_COUNT 7
+#define BENCHMARK_PLAYER_MISSILE_COUNT 4
+#define BENCHMARK_MISSILE_COUNT                                                \
+  (BENCHMARK_ENEMY_MISSILE_COUNT + BENCHMARK_PLAYER_MISSILE_COUNT + 1)
+#define BENCHMARK_ENEMY_DISTANCE_PER_TICK (35 * BENCHMARK_GAME_TIMER_PERIOD)
+#define BENCHMARK_PLAYER_DISTANCE_PER_TICK (350 * BENCHMARK_GAME_TIMER_PERIOD)
+#define BENCHMARK_RADIUS_CHANGE_PER_TICK (30 * BENCHMARK_GAME_TIMER_PERIOD)
+#define BENCHMARK_PLANE_DISTANCE_PER_TICK (40 * BENCHMARK_GAME_TIMER_PERIOD)
+#define BENCHMARK_EXPLOSION_MAX_RADIUS 25
+#define BENCHMARK_BACKGROUND_COLOR DISPLAY_BLACK
+
+#define BENCHMARK_RUNTIME_S 60
+#define BENCHMARK_RUNTIME_TICKS                                                \
+  ((int)(BENCHMARK_RUNTIME_S / BENCHMARK_GAME_TIMER_PERIOD))
+
+#define BENCHMARK_PLANE_Y 40
+#define BENCHMARK_PLANE_WIDTH 16
+#define BENCHMARK_PLANE_HEIGHT 8
+#define BENCHMARK_LAUNCH_SITE_Y (DISPLAY_HEIGHT - 1)
+#define BENCHMARK_SEED 330
+#define BENCHMARK_US_PER_S 1000000.0
+#define BENCHMARK_NS_PER_US 1000.0
+
+typedef enum {
+  BENCHMARK_MISSILE_MOVING,
+  BENCHMARK_MISSILE_GROWING,
+  BENCHMARK_MISSILE_SHRINKING
+} benchmark_missileState_t;
+
+typedef struct {
+  benchmark_missileState_t state;
+  bool isEnemy;
+  int16_t xOrigin, yOrigin, xDest, yDest;
+  double x, y, length, totalLength, radius;
+} benchmark_missile_t;
+
+static benchmark_missile_t missiles[BENCHMARK_MISSILE_COUNT];
+static double planeX;
+static uint32_t randomState = BENCHMARK_SEED;
+
+static volatile bool interrupt_flag;
+static volatile uint32_t isr_triggered_count;
+static uint32_t isr_handled_count;
+
+// Returns the host time in microseconds.
+static double benchmark_getMicros() {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec * BENCHMARK_US_PER_S + now.tv_nsec / BENCHMARK_NS_PER_US;
+}
+
+// Returns a random number in [0, max), the same sequence every run.
+static int16_t benchmark_random(int16_t max) {
+  randomState = randomState * 1103515245 + 12345;
+  return (randomState >> 16) % max;
+}
+
+// Launches an enemy missile from the top, or a player missile from one of the
+// three launch sites at the bottom.
+static void benchmark_launchMissile(benchmark_missile_t *missile) {
+  if (missile->isEnemy) {
+    missile->xOrigin = benchmark_random(DISPLAY_WIDTH);
+    missile->yOrigin = benchmark_random(DISPLAY_HEIGHT / 4);
+    missile->xDest = benchmark_random(DISPLAY_WIDTH);
+    missile->yDest = BENCHMARK_LAUNCH_SITE_Y;
+  } else {
+    missile->xOrigin = DISPLAY_WIDTH / 4 * (1 + benchmark_random(3));
+    missile->yOrigin = BENCHMARK_LAUNCH_SITE_Y;
+    missile->xDest = benchmark_random(DISPLAY_WIDTH);
+    missile->yDest = benchmark_random(DISPLAY_HEIGHT / 2);
+  }
+  missile->state = BENCHMARK_MISSILE_MOVING;
+  missile->x = missile->xOrigin;
+  missile->y = missile->yOrigin;
+  missile->length = 0;
+  missile->radius = 0;
+  double dx = missile->xDest - missile->xOrigin;
+  double dy = missile->yDest - missile->yOrigin;
+  missile->totalLength = sqrt(dx * dx + dy * dy);
+}
+
+// Moves a missile one tick: the line grows toward its destination, then the
+// explosion grows and shrinks, then it is launched again.
+static void benchmark_tickMissile(benchmark_missile_t *missile) {
+  uint16_t color = missile->isEnemy ? DISPLAY_RED : DISPLAY_GREEN;
+  switch (missile->state) {
+  case BENCHMARK_MISSILE_MOVING:
+    display_drawLine(missile->xOrigin, missile->yOrigin, missile->x,
+                     missile->y, BENCHMARK_BACKGROUND_COLOR);
+    missile->length += missile->isEnemy ? BENCHMARK_ENEMY_DISTANCE_PER_TICK
+                                        : BENCHMARK_PLAYER_DISTANCE_PER_TICK;
+    if (missile->length >= missile->totalLength) {
+      missile->state = BENCHMARK_MISSILE_GROWING;
+      missile->x = missile->xDest;
+      missile->y = missile->yDest;
+      break;
+    }
+    double fraction = missile->length / missile->totalLength;
+    missile->x =
+        missile->xOrigin + fraction * (missile->xDest - missile->xOrigin);
+    missile->y =
+        missile->yOrigin + fraction * (missile->yDest - missile->yOrigin);
+    display_drawLine(missile->xOrigin, missile->yOrigin, missile->x,
+                     missile->y, color);
+    break;
+  case BENCHMARK_MISSILE_GROWING:
+    missile->radius += BENCHMARK_RADIUS_CHANGE_PER_TICK;
+    if (missile->radius >= BENCHMARK_EXPLOSION_MAX_RADIUS)
+      missile->state = BENCHMARK_MISSILE_SHRINKING;
+    display_fillCircle(missile->x, missile->y, missile->radius, color);
+    break;
+  case BENCHMARK_MISSILE_SHRINKING:
+    display_fillCircle(missile->x, missile->y, missile->radius,
+                       BENCHMARK_BACKGROUND_COLOR);
+    missile->radius -= BENCHMARK_RADIUS_CHANGE_PER_TICK;
+    if (missile->radius <= 0)
+      benchmark_launchMissile(missile);
+    else
+      display_fillCircle(missile->x, missile->y, missile->radius, color);
+    break;
+  }
+}
+
+// Moves the plane across the top of the screen, wrapping around.
+static void benchmark_tickPlane() {
+  display_fillTriangle(planeX, BENCHMARK_PLANE_Y,
+                       planeX + BENCHMARK_PLANE_WIDTH,
+                       BENCHMARK_PLANE_Y - BENCHMARK_PLANE_HEIGHT / 2,
+                       planeX + BENCHMARK_PLANE_WIDTH,
+                       BENCHMARK_PLANE_Y + BENCHMARK_PLANE_HEIGHT / 2,
+                       BENCHMARK_BACKGROUND_COLOR);
+  planeX -= BENCHMARK_PLANE_DISTANCE_PER_TICK;
+  if (planeX < -BENCHMARK_PLANE_WIDTH)
+    planeX = DISPLAY_WIDTH;
+  display_fillTriangle(planeX, BENCHMARK_PLANE_Y,
+                       planeX + BENCHMARK_PLANE_WIDTH,
+                       BENCHMARK_PLANE_Y - BENCHMARK_PLANE_HEIGHT / 2,
+                       planeX + BENCHMARK_PLANE_WIDTH,
+                       BENCHMARK_PLANE_Y + BENCHMARK_PLANE_HEIGHT / 2,
+                       DISPLAY_WHITE);
+}
+
+// One game tick: every missile, the plane and the stats line.
+static void benchmark_tickGame() {
+  for (uint16_t i = 0; i < BENCHMARK_MISSILE_COUNT; i++)
+    benchmark_tickMissile(&missiles[i]);
+  benchmark_tickPlane();
+  display_setCursor(0, 0);
+  display_setTextColorBg(DISPLAY_WHITE, BENCHMARK_BACKGROUND_COLOR);
+  display_print("Ticks: ");
+  display_printDecimalInt(isr_handled_count);
+}
+
+// Interrupt handler for game - use flag method, as main_m3.c does.
+static void game_isr() {
+  intervalTimer_ackInterrupt(INTERVAL_TIMER_0);
+  interrupt_flag = true;
+  isr_triggered_count++;
+}
+
+// Interrupt handler for the touchscreen timer, there is no touchscreen here.
+static void touchscreen_isr() { intervalTimer_ackInterrupt(INTERVAL_TIMER_1); }
+
+// Runs display_test() and prints how long it took to queue and to draw.
+static void benchmark_runDisplayTest() {
+  display_init();
+  headlessDisplay_sync();
+  double start = benchmark_getMicros();
+  unsigned long total = display_test();
+  double queued = benchmark_getMicros();
+  headlessDisplay_sync();
+  double drawn = benchmark_getMicros();
+  printf("display_test(): %lu us in the tests, %.0f us on the program, %.0f "
+         "us until drawn\n",
+         total, queued - start, drawn - start);
+}
+
+// Runs the game loop of main_m3.c for BENCHMARK_RUNTIME_S of timer time.
+static void benchmark_runGame() {
+  display_init();
+  for (uint16_t i = 0; i < BENCHMARK_MISSILE_COUNT; i++) {
+    // The last missile is the plane's, it falls like an enemy one.
+    missiles[i].isEnemy = i < BENCHMARK_ENEMY_MISSILE_COUNT ||
+                          i == BENCHMARK_MISSILE_COUNT - 1;
+    benchmark_launchMissile(&missiles[i]);
+  }
+  planeX = DISPLAY_WIDTH;
+
+  interrupts_init();
+  interrupts_register(INTERVAL_TIMER_0_INTERRUPT_IRQ, game_isr);
+  interrupts_register(INTERVAL_TIMER_1_INTERRUPT_IRQ, touchscreen_isr);
+  interrupts_irq_enable(INTERVAL_TIMER_0_INTERRUPT_IRQ);
+  interrupts_irq_enable(INTERVAL_TIMER_1_INTERRUPT_IRQ);
+  intervalTimer_initCountDown(INTERVAL_TIMER_0, BENCHMARK_GAME_TIMER_PERIOD);
+  intervalTimer_initCountDown(INTERVAL_TIMER_1,
+                              BENCHMARK_TOUCHSCREEN_TIMER_PERIOD);
+  intervalTimer_enableInterrupt(INTERVAL_TIMER_0);
+  intervalTimer_enableInterrupt(INTERVAL_TIMER_1);
+
+  double start = benchmark_getMicros();
+  double tickTime = 0;
+  intervalTimer_start(INTERVAL_TIMER_0);
+  intervalTimer_start(INTERVAL_TIMER_1);
+  while (isr_triggered_count < BENCHMARK_RUNTIME_TICKS) {
+    while (!interrupt_flag)
+      ;
+    interrupt_flag = false;
+    isr_handled_count++;
+
+    double tickStart = benchmark_getMicros();
+    benchmark_tickGame();
+    tickTime += benchmark_getMicros() - tickStart;
+  }
+  double gameTime = benchmark_getMicros() - start;
+  printf("Handled %d of %d interrupts\n", isr_handled_count,
+         isr_triggered_count);
+  printf("Game: %.1f us per tick on the program, %d s of timer time in %.2f "
+         "s\n",
+         tickTime / isr_handled_count, BENCHMARK_RUNTIME_S,
+         gameTime / BENCHMARK_US_PER_S);
+}
+
+int main() {
+  benchmark_runDisplayTest();
+  benchmark_runGame();
+  return 0;
+}
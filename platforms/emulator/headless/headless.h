@@ -0,0 +1,136 @@
+/*
+This software is provided for student assignment use in the Department of
+Electrical and Computer Engineering, Brigham Young University, Utah, USA.
+
+Users agree to not re-host, or redistribute the software, in source or binary
+form, to other persons or other institutions. Users may modify and use the
+source code for personal or educational use.
+
+For questions, contact Brad Hutchings or Jeff Goeders, https://ece.byu.edu/
+*/
+
+#ifndef HEADLESS
+#define HEADLESS
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// The headless emulator runs a lab without the GUI and in virtual time. Build
+// with "cmake -DEMU=1 -DEMU_HEADLESS=1", then run the .elf on the host:
+//
+//   lab6.elf --seconds 600 --frames frames --frame-ms 1000 --input taps.txt
+//
+// The program runs on the main thread. A hardware thread models the AXI
+// interval timers, the AXI interrupt controller and the GPIO (buttons,
+// switches, LEDs) from Xil_In32()/Xil_Out32(), and delivers the interrupt to
+// the main thread with a signal, so the ISR preempts the program like it does
+// on the board. Virtual time is counted in cycles of the 100 MHz timer clock:
+//  - While the program waits (utils_msDelay(), utils_sleep(), or after main()
+//    returns) time jumps straight to the next thing that can happen.
+//  - While it is busy, time moves a step after each HEADLESS_QUANTUM_US of
+//    host time, to the next interrupt, or --speed times the host time.
+//  - An interrupt that isn't masked stops time until its ISR has run.
+// Minutes of game time take seconds.
+//
+// The display is drawn into the displayBuffer framebuffer and can be saved as
+// PPM images with --frames. The display_* calls are queued for a render thread
+// that draws them, so a program that draws a lot isn't slowed down by the
+// drawing; --sync-display draws them on the program thread instead.
+// displayBenchmark.elf compares the two.
+//
+// An --input file feeds the buttons, switches and touchscreen, one
+// "<ms> <what> ..." line per change:
+//   1000 buttons 0x1
+//   1200 buttons 0x0
+//   2000 switches 0x3
+//   3000 touch 160 120
+//   3100 release
+
+#define HEADLESS_CLOCK_HZ 100000000ULL
+#define HEADLESS_CYCLES_PER_MS (HEADLESS_CLOCK_HZ / 1000)
+#define HEADLESS_NO_EVENT UINT64_MAX
+
+// Host time the program gets to run between steps of virtual time.
+#define HEADLESS_QUANTUM_US 50
+
+// The longest step while the program is busy and nothing is scheduled.
+#define HEADLESS_MAX_BUSY_STEP (100 * HEADLESS_CYCLES_PER_MS)
+
+// Virtual time and the program thread (headlessMain.c).
+
+// Returns the virtual time in cycles.
+uint64_t headless_getTime();
+
+// Blocks the program until the virtual time reaches time.
+void headless_waitUntil(uint64_t time);
+
+// Blocks the program until an ISR has run.
+void headless_waitForInterrupt();
+
+// Tells the hardware thread the program has changed state. Async-signal-safe.
+void headless_wakeHardware();
+
+// The AXI peripherals (headlessIo.c). All of these lock the registers.
+
+// Puts every peripheral in its reset state.
+void headlessIo_init();
+
+// Counts the timers forward to time and latches their interrupts.
+void headlessIo_advance(uint64_t time);
+
+// Returns when the next enabled timer interrupt will be raised,
+// HEADLESS_NO_EVENT if none will.
+uint64_t headlessIo_getNextEventTime();
+
+// True while the interrupt controller's irq output is asserted.
+bool headlessIo_isIrqAsserted();
+
+// Set what the buttons and switches GPIO read.
+void headlessIo_setButtons(uint32_t value);
+void headlessIo_setSwitches(uint32_t value);
+
+// Returns what was last written to the LEDs GPIO.
+uint32_t headlessIo_getLeds();
+
+// The processor's interrupt (headlessBoard.c).
+
+// Installs the interrupt signal handler on the calling (program) thread.
+void headlessBoard_init();
+
+// Sends the program an interrupt if the irq is asserted and none is in flight.
+// Returns true while one is in flight (sent but its ISR hasn't returned).
+bool headlessBoard_deliverInterrupt();
+
+// True while an interrupt is in flight.
+bool headlessBoard_isInterruptInFlight();
+
+// True while the program has interrupts disabled, or is in the ISR.
+bool headlessBoard_isInterruptMasked();
+
+// Returns the number of times the ISR has run.
+uint32_t headlessBoard_getInterruptCount();
+
+// Hold off the ISR while the program is inside the emulator (the registers,
+// the display queue). An interrupt that arrives meanwhile runs at
+// headlessBoard_endIo().
+void headlessBoard_beginIo();
+void headlessBoard_endIo();
+
+// The display and touchscreen (headlessDisplay.c).
+
+// Starts the render thread, or draws on the program thread if useRenderThread
+// is false. Call it before the program starts.
+void headlessDisplay_init(bool useRenderThread);
+
+// Waits until the render thread has drawn what the program has queued.
+void headlessDisplay_sync();
+
+// Sets the touchscreen state display_isTouched() and
+// display_getTouchedPoint() return.
+void headlessDisplay_setTouch(bool touched, int16_t x, int16_t y);
+
+// Saves the framebuffer as a binary PPM, after a sync. Returns false if it
+// can't be written.
+bool headlessDisplay_writeImage(const char *path);
+
+#endif /* HEADLESS */
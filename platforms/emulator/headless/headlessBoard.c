@@ -0,0 +1,267 @@
+/*
+This software is provided for student assignment use in the Department of
+Electrical and Computer Engineering, Brigham Young University, Utah, USA.
+
+Users agree to not re-host, or redistribute the software, in source or binary
+form, to other persons or other institutions. Users may modify and use the
+source code for personal or educational use.
+
+For questions, contact Brad Hutchings or Jeff Goeders, https://ece.byu.edu/
+*/
+
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "armInterrupts.h"
+#include "headless.h"
+#include "leds.h"
+#include "mio.h"
+#include "utils.h"
+#include "xil_io.h"
+#include "xparameters.h"
+
+// The ISR runs in the handler of this signal, on the program thread.
+#define HEADLESS_BOARD_INTERRUPT_SIGNAL SIGUSR1
+
+#define HEADLESS_BOARD_GPIO_TRI 0x04
+#define HEADLESS_BOARD_MIO_PIN_COUNT 54
+#define HEADLESS_BOARD_MIO_BANK0_PIN_COUNT 16
+#define HEADLESS_BOARD_LED_MASK 0xF
+#define HEADLESS_BOARD_LED_TEST_BLINK_COUNT 10
+#define HEADLESS_BOARD_LED_TEST_BLINK_MS 250
+
+static pthread_t programThread;
+static void (*intcIsr)();
+// Written by the program thread and read in its signal handler.
+static volatile sig_atomic_t interruptsEnabled;
+static volatile sig_atomic_t intcEnabled;
+static volatile sig_atomic_t inIo;
+static volatile sig_atomic_t interruptDeferred;
+// Shared with the hardware thread.
+static bool interruptInFlight;
+static uint32_t interruptCount;
+
+static uint8_t mioPins[HEADLESS_BOARD_MIO_PIN_COUNT];
+static uint8_t ld4;
+
+// Runs the ISR with interrupts masked, as the processor does.
+static void headlessBoard_runIsr() {
+  interruptDeferred = false;
+  interruptsEnabled = false;
+  intcIsr();
+  interruptsEnabled = true;
+  __atomic_add_fetch(&interruptCount, 1, __ATOMIC_RELEASE);
+  __atomic_store_n(&interruptInFlight, false, __ATOMIC_RELEASE);
+  headless_wakeHardware();
+}
+
+// Runs the ISR now, or once interrupts are enabled and the program is out of
+// the emulator.
+static void headlessBoard_handleSignal(int signal) {
+  (void)signal;
+  if (!interruptsEnabled || !intcEnabled || inIo) {
+    interruptDeferred = true;
+    return;
+  }
+  headlessBoard_runIsr();
+}
+
+// Runs an interrupt that arrived while it couldn't.
+static void headlessBoard_runDeferredIsr() {
+  if (interruptDeferred && interruptsEnabled && intcEnabled && !inIo)
+    headlessBoard_runIsr();
+}
+
+// Installs the interrupt signal handler on the calling (program) thread.
+void headlessBoard_init() {
+  programThread = pthread_self();
+  struct sigaction action;
+  memset(&action, 0, sizeof(action));
+  action.sa_handler = headlessBoard_handleSignal;
+  action.sa_flags = SA_RESTART;
+  sigemptyset(&action.sa_mask);
+  sigaction(HEADLESS_BOARD_INTERRUPT_SIGNAL, &action, NULL);
+}
+
+// Sends the program an interrupt if the irq is asserted and none is in flight.
+bool headlessBoard_deliverInterrupt() {
+  if (headlessBoard_isInterruptInFlight())
+    return true;
+  if (!intcIsr || !headlessIo_isIrqAsserted())
+    return false;
+  __atomic_store_n(&interruptInFlight, true, __ATOMIC_RELEASE);
+  pthread_kill(programThread, HEADLESS_BOARD_INTERRUPT_SIGNAL);
+  return true;
+}
+
+// True while an interrupt is in flight.
+bool headlessBoard_isInterruptInFlight() {
+  return __atomic_load_n(&interruptInFlight, __ATOMIC_ACQUIRE);
+}
+
+// True while the program has interrupts disabled, or is in the ISR.
+bool headlessBoard_isInterruptMasked() {
+  return !interruptsEnabled || !intcEnabled;
+}
+
+// Returns the number of times the ISR has run.
+uint32_t headlessBoard_getInterruptCount() {
+  return __atomic_load_n(&interruptCount, __ATOMIC_ACQUIRE);
+}
+
+// Holds off the ISR while the program is inside the emulator.
+void headlessBoard_beginIo() { inIo = true; }
+
+// Runs an ISR that arrived inside the emulator.
+void headlessBoard_endIo() {
+  inIo = false;
+  headlessBoard_runDeferredIsr();
+}
+
+/*******************************************************
+ ********************* armInterrupts *******************
+ ******************************************************/
+
+// Initialize ARM interrupts
+int armInterrupts_init() {
+  interruptsEnabled = false;
+  intcEnabled = true;
+  return 0;
+}
+
+// Global interrupt enable/disable
+void armInterrupts_enable() {
+  interruptsEnabled = true;
+  headlessBoard_runDeferredIsr();
+}
+
+void armInterrupts_disable() { interruptsEnabled = false; }
+
+// The private ARM timer isn't modeled, only the AXI interrupt controller.
+int32_t armInterrupts_setupTimer(void (*isr)(), double period_seconds) {
+  (void)isr;
+  (void)period_seconds;
+  printf("headless: the ARM private timer is not modeled.\n");
+  return -1;
+}
+
+void armInterrupts_enableTimer() {}
+
+void armInterrupts_disableTimer() {}
+
+int32_t armInterrupts_setupIntc(void (*isr)()) {
+  intcIsr = isr;
+  return 0;
+}
+
+void armInterrupts_enableIntc() {
+  intcEnabled = true;
+  headlessBoard_runDeferredIsr();
+}
+
+void armInterrupts_disableIntc() { intcEnabled = false; }
+
+uint32_t armInterrupts_getTimerIsrCount() { return 0; }
+
+// There is no XADC or bluetooth radio.
+int armInterrupts_enableSysMonGlobalInts() { return 0; }
+
+int armInterrupts_disableSysMonGlobalInts() { return 0; }
+
+int armInterrupts_enableSysMonEocInts() { return 0; }
+
+int armInterrupts_disableSysMonEocInts() { return 0; }
+
+bool armInterrupts_getAdcInputMode() {
+  return INTERRUPTS_ADC_DEFAULT_INPUT_MODE;
+}
+
+uint32_t armInterrupts_getAdcData() { return 0; }
+
+u32 armInterrupts_getTotalEocCount() { return 0; }
+
+uint32_t armInterrupts_initBluetoothInterrupts() { return 0; }
+
+void armInterrupts_enableBluetoothInterrupts() {}
+
+void armInterrupts_disableBluetoothInterrupts() {}
+
+void armInterrupts_ackBluetoothInterrupts() {}
+
+/*******************************************************
+ ********************** LEDs and MIO *******************
+ ******************************************************/
+
+// The LEDs are the LEDs GPIO in the register model.
+int32_t leds_init() {
+  Xil_Out32(XPAR_LEDS_BASEADDR + HEADLESS_BOARD_GPIO_TRI, 0); // All outputs.
+  leds_write(0);
+  return 0;
+}
+
+void leds_write(uint8_t ledValue) {
+  Xil_Out32(XPAR_LEDS_BASEADDR, ledValue & HEADLESS_BOARD_LED_MASK);
+}
+
+uint8_t leds_read() { return Xil_In32(XPAR_LEDS_BASEADDR); }
+
+void leds_writeLd4(uint8_t ledValue) { ld4 = ledValue & 1; }
+
+// Blinks the LEDs in virtual time.
+void leds_runTest() {
+  for (uint16_t i = 0; i < HEADLESS_BOARD_LED_TEST_BLINK_COUNT; i++) {
+    leds_write(i % 2 ? 0 : HEADLESS_BOARD_LED_MASK);
+    leds_writeLd4(i % 2 ? 0 : 1);
+    utils_msDelay(HEADLESS_BOARD_LED_TEST_BLINK_MS);
+  }
+  leds_write(0);
+  leds_writeLd4(0);
+}
+
+// MIO pins keep what is written to them, inputs read 0.
+int mio_init(bool printFailedStatusFlag) {
+  (void)printFailedStatusFlag;
+  memset(mioPins, 0, sizeof(mioPins));
+  return 0;
+}
+
+u8 mio_readPin(u8 mioPinNumber) {
+  return mioPinNumber < HEADLESS_BOARD_MIO_PIN_COUNT ? mioPins[mioPinNumber]
+                                                     : 0;
+}
+
+void mio_writePin(u8 mioPinNumber, u8 value) {
+  if (mioPinNumber < HEADLESS_BOARD_MIO_PIN_COUNT)
+    mioPins[mioPinNumber] = value & 1;
+}
+
+void mio_WriteBank0(u32 value) {
+  for (uint16_t pin = 0; pin < HEADLESS_BOARD_MIO_BANK0_PIN_COUNT; pin++)
+    mioPins[pin] = (value >> pin) & 1;
+}
+
+uint16_t mio_readBank0() {
+  uint16_t value = 0;
+  for (uint16_t pin = 0; pin < HEADLESS_BOARD_MIO_BANK0_PIN_COUNT; pin++)
+    value |= mioPins[pin] << pin;
+  return value;
+}
+
+void mio_setPinAsInput(u8 mioPinNo) { (void)mioPinNo; }
+
+void mio_setPinAsOutput(u8 mioPinNo) { (void)mioPinNo; }
+
+/*******************************************************
+ ************************* utils ***********************
+ ******************************************************/
+
+// Waits in virtual time, interrupts keep running.
+void utils_msDelay(long ms) {
+  if (ms > 0)
+    headless_waitUntil(headless_getTime() + ms * HEADLESS_CYCLES_PER_MS);
+}
+
+// Waits until an ISR has run.
+void utils_sleep() { headless_waitForInterrupt(); }
@@ -0,0 +1,733 @@
+/*
+This software is provided for student assignment use in the Department of
+Electrical and Computer Engineering, Brigham Young University, Utah, USA.
+
+Users agree to not re-host, or redistribute the software, in source or binary
+form, to other persons or other institutions. Users may modify and use the
+source code for personal or educational use.
+
+For questions, contact Brad Hutchings or Jeff Goeders, https://ece.byu.edu/
+*/
+
+// The display library is implemented on the displayBuffer framebuffer, which
+// is the screen here. These are the real display_* functions, they must not
+// be redirected to displayBuffer_*.
+#define DISPLAY_BUFFER_NO_REDIRECT
+
+#include <pthread.h>
+#include <sched.h>
+#include <semaphore.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "display.h"
+#include "displayBuffer.h"
+#include "headless.h"
+
+// A power of two. 1 MB, a whole screen window fits many times over.
+#define HEADLESS_DISPLAY_QUEUE_SLOT_COUNT 65536
+#define HEADLESS_DISPLAY_DEFAULT_TEXT_COLOR DISPLAY_WHITE
+#define HEADLESS_DISPLAY_DECIMAL_INT_MAX_CHARS 12 // "-2147483648" and the 0.
+#define HEADLESS_DISPLAY_TOUCH_PRESSURE 100
+#define HEADLESS_DISPLAY_PPM_MAX_VALUE 255
+#define HEADLESS_DISPLAY_US_PER_S 1000000L
+#define HEADLESS_DISPLAY_NS_PER_US 1000L
+
+typedef enum {
+  HEADLESS_DISPLAY_SKIP, // The rest of the queue is unused, go to the start.
+  HEADLESS_DISPLAY_PIXEL,
+  HEADLESS_DISPLAY_LINE,
+  HEADLESS_DISPLAY_VLINE,
+  HEADLESS_DISPLAY_HLINE,
+  HEADLESS_DISPLAY_RECT,
+  HEADLESS_DISPLAY_FILL_RECT,
+  HEADLESS_DISPLAY_FILL_SCREEN,
+  HEADLESS_DISPLAY_CIRCLE,
+  HEADLESS_DISPLAY_FILL_CIRCLE,
+  HEADLESS_DISPLAY_TRIANGLE,
+  HEADLESS_DISPLAY_FILL_TRIANGLE,
+  HEADLESS_DISPLAY_ROUND_RECT,
+  HEADLESS_DISPLAY_FILL_ROUND_RECT,
+  HEADLESS_DISPLAY_BITMAP, // args x, y, w, h, followed by the bitmap.
+  HEADLESS_DISPLAY_CHAR,   // args x, y, c, bg.
+  HEADLESS_DISPLAY_WINDOW  // args x, y, w, h, followed by the pixels.
+} headlessDisplay_op_t;
+
+// One drawing call, args in the order of the display_* arguments. A bitmap
+// or window is copied into the slots that follow it.
+typedef struct {
+  uint8_t op;
+  uint8_t size; // The character size.
+  uint16_t color;
+  int16_t args[6];
+} headlessDisplay_command_t;
+
+// The queue from the program thread to the render thread. Both counts only
+// grow, a slot is queue[count % HEADLESS_DISPLAY_QUEUE_SLOT_COUNT].
+static headlessDisplay_command_t queue[HEADLESS_DISPLAY_QUEUE_SLOT_COUNT];
+static uint32_t queueHead; // Slots written, only the program thread writes it.
+static uint32_t queueTail; // Slots drawn, only the render thread writes it.
+static bool renderThreadRunning;
+static pthread_t renderThread;
+static sem_t renderWake;
+static uint32_t renderWaiting;
+
+// Text state, kept on the program side so printing is one command per
+// character.
+static int16_t cursorX;
+static int16_t cursorY;
+static uint16_t textColor = HEADLESS_DISPLAY_DEFAULT_TEXT_COLOR;
+static uint16_t textBgColor = HEADLESS_DISPLAY_DEFAULT_TEXT_COLOR;
+static uint8_t textSize = 1;
+static bool textWrapFlag = true;
+
+static bool touched;
+static int16_t touchX;
+static int16_t touchY;
+static bool rotationReported;
+
+/*******************************************************
+ ************************ Drawing **********************
+ ******************************************************/
+
+// Returns the number of bytes that follow a command.
+static uint32_t headlessDisplay_getPayloadSize(
+    const headlessDisplay_command_t *command) {
+  int16_t w = command->args[2];
+  int16_t h = command->args[3];
+  if (command->op == HEADLESS_DISPLAY_BITMAP)
+    return (uint32_t)((w + 7) / 8) * h;
+  if (command->op == HEADLESS_DISPLAY_WINDOW)
+    return (uint32_t)w * h * sizeof(uint16_t);
+  return 0;
+}
+
+// Returns the number of slots a command takes, with what follows it.
+static uint32_t headlessDisplay_getSlotCount(uint32_t payloadSize) {
+  return 1 + (payloadSize + sizeof(headlessDisplay_command_t) - 1) /
+                 sizeof(headlessDisplay_command_t);
+}
+
+// Draws a character cell. The background is filled first rather than drawn
+// by displayBuffer_drawChar(), which would take the cell from the glyph
+// cache. The cache belongs to the program, which may be using it right now.
+static void headlessDisplay_drawChar(int16_t x, int16_t y, unsigned char c,
+                                     uint16_t color, uint16_t bg,
+                                     uint8_t size) {
+  if (bg != color)
+    displayBuffer_fillRect(x, y, DISPLAY_CHAR_WIDTH * size,
+                           DISPLAY_CHAR_HEIGHT * size, bg);
+  displayBuffer_drawChar(x, y, c, color, color, size);
+}
+
+// Draws a command into the framebuffer. payload is what follows it.
+static void headlessDisplay_draw(const headlessDisplay_command_t *command,
+                                 const void *payload) {
+  const int16_t *a = command->args;
+  uint16_t color = command->color;
+  switch (command->op) {
+  case HEADLESS_DISPLAY_PIXEL:
+    displayBuffer_drawPixel(a[0], a[1], color);
+    break;
+  case HEADLESS_DISPLAY_LINE:
+    displayBuffer_drawLine(a[0], a[1], a[2], a[3], color);
+    break;
+  case HEADLESS_DISPLAY_VLINE:
+    displayBuffer_drawFastVLine(a[0], a[1], a[2], color);
+    break;
+  case HEADLESS_DISPLAY_HLINE:
+    displayBuffer_drawFastHLine(a[0], a[1], a[2], color);
+    break;
+  case HEADLESS_DISPLAY_RECT:
+    displayBuffer_drawRect(a[0], a[1], a[2], a[3], color);
+    break;
+  case HEADLESS_DISPLAY_FILL_RECT:
+    displayBuffer_fillRect(a[0], a[1], a[2], a[3], color);
+    break;
+  case HEADLESS_DISPLAY_FILL_SCREEN:
+    displayBuffer_fillScreen(color);
+    break;
+  case HEADLESS_DISPLAY_CIRCLE:
+    displayBuffer_drawCircle(a[0], a[1], a[2], color);
+    break;
+  case HEADLESS_DISPLAY_FILL_CIRCLE:
+    displayBuffer_fillCircle(a[0], a[1], a[2], color);
+    break;
+  case HEADLESS_DISPLAY_TRIANGLE:
+    displayBuffer_drawTriangle(a[0], a[1], a[2], a[3], a[4], a[5], color);
+    break;
+  case HEADLESS_DISPLAY_FILL_TRIANGLE:
+    displayBuffer_fillTriangle(a[0], a[1], a[2], a[3], a[4], a[5], color);
+    break;
+  case HEADLESS_DISPLAY_ROUND_RECT:
+    displayBuffer_drawRoundRect(a[0], a[1], a[2], a[3], a[4], color);
+    break;
+  case HEADLESS_DISPLAY_FILL_ROUND_RECT:
+    displayBuffer_fillRoundRect(a[0], a[1], a[2], a[3], a[4], color);
+    break;
+  case HEADLESS_DISPLAY_BITMAP:
+    displayBuffer_drawBitmap(a[0], a[1], payload, a[2], a[3], color);
+    break;
+  case HEADLESS_DISPLAY_CHAR:
+    headlessDisplay_drawChar(a[0], a[1], a[2], color, a[3], command->size);
+    break;
+  case HEADLESS_DISPLAY_WINDOW: {
+    // A window is on the display, see displayBuffer_writeWindow().
+    uint16_t *screen = displayBuffer_getPixels();
+    const uint16_t *pixels = payload;
+    for (int16_t row = 0; row < a[3]; row++)
+      memcpy(&screen[(a[1] + row) * DISPLAY_WIDTH + a[0]], &pixels[row * a[2]],
+             a[2] * sizeof(uint16_t));
+    displayBuffer_markDirty(a[0], a[1], a[2], a[3]);
+    break;
+  }
+  }
+}
+
+/*******************************************************
+ ******************** Command queue ********************
+ ******************************************************/
+
+// Draws the queued commands in batches: everything queued when a batch
+// starts, then the tail moves once. Sleeps while the queue is empty.
+static void *headlessDisplay_render(void *argument) {
+  (void)argument;
+  for (;;) {
+    uint32_t head = __atomic_load_n(&queueHead, __ATOMIC_ACQUIRE);
+    uint32_t tail = queueTail;
+    while (tail != head) {
+      const headlessDisplay_command_t *command =
+          &queue[tail % HEADLESS_DISPLAY_QUEUE_SLOT_COUNT];
+      if (command->op == HEADLESS_DISPLAY_SKIP) {
+        tail += HEADLESS_DISPLAY_QUEUE_SLOT_COUNT -
+                tail % HEADLESS_DISPLAY_QUEUE_SLOT_COUNT;
+        continue;
+      }
+      headlessDisplay_draw(command, command + 1);
+      tail += headlessDisplay_getSlotCount(
+          headlessDisplay_getPayloadSize(command));
+    }
+    __atomic_store_n(&queueTail, tail, __ATOMIC_RELEASE);
+    // The program posts if it sees this flag after queueing, so a command
+    // queued after the check below still wakes the thread.
+    __atomic_store_n(&renderWaiting, 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&queueHead, __ATOMIC_SEQ_CST) == tail)
+      sem_wait(&renderWake);
+    __atomic_store_n(&renderWaiting, 0, __ATOMIC_SEQ_CST);
+  }
+  return NULL;
+}
+
+// True when commands should be drawn right away: without a render thread,
+// or on it (a window written while drawing a command).
+static bool headlessDisplay_isDrawnHere() {
+  return !renderThreadRunning || pthread_equal(pthread_self(), renderThread);
+}
+
+// Waits until everything queued so far has been drawn.
+void headlessDisplay_sync() {
+  if (headlessDisplay_isDrawnHere())
+    return;
+  uint32_t head = __atomic_load_n(&queueHead, __ATOMIC_ACQUIRE);
+  while ((int32_t)(__atomic_load_n(&queueTail, __ATOMIC_ACQUIRE) - head) < 0)
+    sched_yield();
+}
+
+// Queues a command and payloadSize bytes of payload for the render thread,
+// or draws it. The ISR is held off meanwhile, it draws with the same queue.
+// A full queue waits for the render thread, it doesn't drop anything.
+static void headlessDisplay_send(const headlessDisplay_command_t *command,
+                                 const void *payload) {
+  if (headlessDisplay_isDrawnHere()) {
+    headlessDisplay_draw(command, payload);
+    return;
+  }
+  uint32_t payloadSize = headlessDisplay_getPayloadSize(command);
+  uint32_t slotCount = headlessDisplay_getSlotCount(payloadSize);
+  headlessBoard_beginIo();
+  if (slotCount > HEADLESS_DISPLAY_QUEUE_SLOT_COUNT / 2) {
+    // Too big to queue, draw it here once the render thread is done.
+    headlessDisplay_sync();
+    headlessDisplay_draw(command, payload);
+    headlessBoard_endIo();
+    return;
+  }
+  uint32_t head = queueHead;
+  uint32_t index = head % HEADLESS_DISPLAY_QUEUE_SLOT_COUNT;
+  // A command and its payload are never split across the end of the queue.
+  uint32_t skipCount = index + slotCount > HEADLESS_DISPLAY_QUEUE_SLOT_COUNT
+                           ? HEADLESS_DISPLAY_QUEUE_SLOT_COUNT - index
+                           : 0;
+  while (HEADLESS_DISPLAY_QUEUE_SLOT_COUNT -
+             (head - __atomic_load_n(&queueTail, __ATOMIC_ACQUIRE)) <
+         skipCount + slotCount)
+    sched_yield();
+  if (skipCount) {
+    queue[index].op = HEADLESS_DISPLAY_SKIP;
+    head += skipCount;
+    index = 0;
+  }
+  queue[index] = *command;
+  if (payloadSize)
+    memcpy(&queue[index + 1], payload, payloadSize);
+  __atomic_store_n(&queueHead, head + slotCount, __ATOMIC_SEQ_CST);
+  if (__atomic_load_n(&renderWaiting, __ATOMIC_SEQ_CST))
+    sem_post(&renderWake);
+  headlessBoard_endIo();
+}
+
+// Queues a command with no payload.
+static void headlessDisplay_sendArgs(uint8_t op, uint16_t color, int16_t a0,
+                                     int16_t a1, int16_t a2, int16_t a3,
+                                     int16_t a4, int16_t a5) {
+  headlessDisplay_command_t command = {
+      .op = op, .color = color, .args = {a0, a1, a2, a3, a4, a5}};
+  headlessDisplay_send(&command, NULL);
+}
+
+// Queues a window that isn't in the framebuffer already. A flush passes
+// windows that are, there is nothing to write then.
+static void headlessDisplay_writeWindow(int16_t x, int16_t y, int16_t w,
+                                        int16_t h, const uint16_t *pixels,
+                                        uint16_t stride) {
+  uint16_t *screen = displayBuffer_getPixels();
+  if (pixels >= screen && pixels < screen + DISPLAY_WIDTH * DISPLAY_HEIGHT)
+    return;
+  // The rows are queued together when they are packed, one by one if not.
+  int16_t rowCount = stride == w ? h : 1;
+  for (int16_t row = 0; row < h; row += rowCount) {
+    headlessDisplay_command_t command = {
+        .op = HEADLESS_DISPLAY_WINDOW, .args = {x, y + row, w, rowCount}};
+    headlessDisplay_send(&command, &pixels[row * stride]);
+  }
+}
+
+// Starts the render thread, or leaves drawing on the program thread.
+void headlessDisplay_init(bool useRenderThread) {
+  if (!useRenderThread)
+    return;
+  sem_init(&renderWake, 0, 0);
+  renderThreadRunning = true;
+  pthread_create(&renderThread, NULL, headlessDisplay_render, NULL);
+}
+
+// Sets the touchscreen state.
+void headlessDisplay_setTouch(bool isTouched, int16_t x, int16_t y) {
+  touched = isTouched;
+  touchX = x;
+  touchY = y;
+}
+
+// Saves the framebuffer as a binary PPM, once what was queued is drawn.
+bool headlessDisplay_writeImage(const char *path) {
+  headlessDisplay_sync();
+  FILE *file = fopen(path, "wb");
+  if (!file)
+    return false;
+  fprintf(file, "P6\n%d %d\n%d\n", DISPLAY_WIDTH, DISPLAY_HEIGHT,
+          HEADLESS_DISPLAY_PPM_MAX_VALUE);
+  const uint16_t *screen = displayBuffer_getPixels();
+  uint8_t row[DISPLAY_WIDTH * 3];
+  for (int16_t y = 0; y < DISPLAY_HEIGHT; y++) {
+    for (int16_t x = 0; x < DISPLAY_WIDTH; x++) {
+      uint16_t pixel = screen[y * DISPLAY_WIDTH + x];
+      // Widen 5/6/5 bits to 8, repeating the top bits in the new low ones.
+      uint8_t r = pixel >> 11, g = (pixel >> 5) & 0x3F, b = pixel & 0x1F;
+      row[x * 3] = r << 3 | r >> 2;
+      row[x * 3 + 1] = g << 2 | g >> 4;
+      row[x * 3 + 2] = b << 3 | b >> 2;
+    }
+    fwrite(row, 1, sizeof(row), file);
+  }
+  return fclose(file) == 0;
+}
+
+/*******************************************************
+ ******************** Display library ******************
+ ******************************************************/
+
+void display_init() {
+  headlessDisplay_sync();
+  displayBuffer_setWindowWriter(headlessDisplay_writeWindow);
+  cursorX = 0;
+  cursorY = 0;
+  textColor = HEADLESS_DISPLAY_DEFAULT_TEXT_COLOR;
+  textBgColor = HEADLESS_DISPLAY_DEFAULT_TEXT_COLOR;
+  textSize = 1;
+  textWrapFlag = true;
+  display_fillScreen(DISPLAY_BLACK);
+}
+
+void display_drawPixel(int16_t x0, int16_t y0, uint16_t color) {
+  headlessDisplay_sendArgs(HEADLESS_DISPLAY_PIXEL, color, x0, y0, 0, 0, 0, 0);
+}
+
+void display_drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1,
+                      uint16_t color) {
+  headlessDisplay_sendArgs(HEADLESS_DISPLAY_LINE, color, x0, y0, x1, y1, 0, 0);
+}
+
+void display_drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) {
+  headlessDisplay_sendArgs(HEADLESS_DISPLAY_VLINE, color, x, y, h, 0, 0, 0);
+}
+
+void display_drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) {
+  headlessDisplay_sendArgs(HEADLESS_DISPLAY_HLINE, color, x, y, w, 0, 0, 0);
+}
+
+void display_drawRect(int16_t x, int16_t y, int16_t w, int16_t h,
+                      uint16_t color) {
+  headlessDisplay_sendArgs(HEADLESS_DISPLAY_RECT, color, x, y, w, h, 0, 0);
+}
+
+void display_fillRect(int16_t x, int16_t y, int16_t w, int16_t h,
+                      uint16_t color) {
+  headlessDisplay_sendArgs(HEADLESS_DISPLAY_FILL_RECT, color, x, y, w, h, 0,
+                           0);
+}
+
+void display_fillScreen(uint16_t color) {
+  headlessDisplay_sendArgs(HEADLESS_DISPLAY_FILL_SCREEN, color, 0, 0, 0, 0, 0,
+                           0);
+}
+
+// Inverting is done by the LCD, the framebuffer keeps the colors drawn.
+void display_invertDisplay(bool i) { (void)i; }
+
+void display_drawCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color) {
+  headlessDisplay_sendArgs(HEADLESS_DISPLAY_CIRCLE, color, x0, y0, r, 0, 0, 0);
+}
+
+void display_fillCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color) {
+  headlessDisplay_sendArgs(HEADLESS_DISPLAY_FILL_CIRCLE, color, x0, y0, r, 0,
+                           0, 0);
+}
+
+void display_drawTriangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1,
+                          int16_t x2, int16_t y2, uint16_t color) {
+  headlessDisplay_sendArgs(HEADLESS_DISPLAY_TRIANGLE, color, x0, y0, x1, y1,
+                           x2, y2);
+}
+
+void display_fillTriangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1,
+                          int16_t x2, int16_t y2, uint16_t color) {
+  headlessDisplay_sendArgs(HEADLESS_DISPLAY_FILL_TRIANGLE, color, x0, y0, x1,
+                           y1, x2, y2);
+}
+
+void display_drawRoundRect(int16_t x0, int16_t y0, int16_t w, int16_t h,
+                           int16_t radius, uint16_t color) {
+  headlessDisplay_sendArgs(HEADLESS_DISPLAY_ROUND_RECT, color, x0, y0, w, h,
+                           radius, 0);
+}
+
+void display_fillRoundRect(int16_t x0, int16_t y0, int16_t w, int16_t h,
+                           int16_t radius, uint16_t color) {
+  headlessDisplay_sendArgs(HEADLESS_DISPLAY_FILL_ROUND_RECT, color, x0, y0, w,
+                           h, radius, 0);
+}
+
+void display_drawBitmap(int16_t x, int16_t y, const uint8_t *bitmap, int16_t w,
+                        int16_t h, uint16_t color) {
+  headlessDisplay_command_t command = {
+      .op = HEADLESS_DISPLAY_BITMAP, .color = color, .args = {x, y, w, h}};
+  headlessDisplay_send(&command, bitmap);
+}
+
+void display_drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color,
+                      uint16_t bg, uint8_t size) {
+  headlessDisplay_command_t command = {.op = HEADLESS_DISPLAY_CHAR,
+                                       .size = size,
+                                       .color = color,
+                                       .args = {x, y, c, (int16_t)bg}};
+  headlessDisplay_send(&command, NULL);
+}
+
+void display_setCursor(int16_t x, int16_t y) {
+  cursorX = x;
+  cursorY = y;
+}
+
+void display_setTextColor(uint16_t c) {
+  textColor = c;
+  textBgColor = c;
+}
+
+void display_setTextColorBg(uint16_t c, uint16_t bg) {
+  textColor = c;
+  textBgColor = bg;
+}
+
+void display_setTextSize(uint8_t s) { textSize = s > 0 ? s : 1; }
+
+void display_setTextWrap(bool w) { textWrapFlag = w; }
+
+// The framebuffer is always landscape with the origin at the upper left.
+void display_setRotation(uint8_t r) {
+  if (r == DISPLAY_LANDSCAPE_MODE_ORIGIN_UPPER_LEFT || rotationReported)
+    return;
+  rotationReported = true;
+  printf("headless: only the landscape upper left rotation is modeled.\n");
+}
+
+int16_t display_height() { return DISPLAY_HEIGHT; }
+
+int16_t display_width() { return DISPLAY_WIDTH; }
+
+uint16_t display_color565(uint8_t r, uint8_t g, uint8_t b) {
+  return ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3);
+}
+
+// Prints one character at the cursor and moves it, the same as
+// displayBuffer_printChar().
+size_t display_printChar(char c) {
+  if (c == '\n') {
+    cursorY += textSize * DISPLAY_CHAR_HEIGHT;
+    cursorX = 0;
+  } else if (c != '\r') {
+    display_drawChar(cursorX, cursorY, c, textColor, textBgColor, textSize);
+    cursorX += textSize * DISPLAY_CHAR_WIDTH;
+    if (textWrapFlag &&
+        cursorX > DISPLAY_WIDTH - textSize * DISPLAY_CHAR_WIDTH) {
+      cursorY += textSize * DISPLAY_CHAR_HEIGHT;
+      cursorX = 0;
+    }
+  }
+  return 1;
+}
+
+size_t display_print(const char str[]) {
+  size_t count = 0;
+  while (str[count] != '\0')
+    display_printChar(str[count++]);
+  return count;
+}
+
+size_t display_printDecimalInt(int num) {
+  char buffer[HEADLESS_DISPLAY_DECIMAL_INT_MAX_CHARS];
+  sprintf(buffer, "%d", num);
+  return display_print(buffer);
+}
+
+size_t display_println(const char str[]) {
+  return display_print(str) + display_print("\r\n");
+}
+
+size_t display_printlnChar(char c) {
+  return display_printChar(c) + display_print("\r\n");
+}
+
+size_t display_printlnDecimalInt(int num) {
+  return display_printDecimalInt(num) + display_print("\r\n");
+}
+
+/*******************************************************
+ ********************** Display tests ******************
+ ******************************************************/
+
+// The tests are the Adafruit graphicstest ones. Each returns the host
+// microseconds the program spent in it, which with the render thread is the
+// time to queue the drawing, not to draw it.
+
+// Returns the host time in microseconds.
+static unsigned long headlessDisplay_getMicros() {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec * HEADLESS_DISPLAY_US_PER_S +
+         now.tv_nsec / HEADLESS_DISPLAY_NS_PER_US;
+}
+
+unsigned long display_testFillScreen() {
+  unsigned long start = headlessDisplay_getMicros();
+  display_fillScreen(DISPLAY_BLACK);
+  display_fillScreen(DISPLAY_RED);
+  display_fillScreen(DISPLAY_GREEN);
+  display_fillScreen(DISPLAY_BLUE);
+  display_fillScreen(DISPLAY_BLACK);
+  return headlessDisplay_getMicros() - start;
+}
+
+unsigned long display_testText() {
+  display_fillScreen(DISPLAY_BLACK);
+  unsigned long start = headlessDisplay_getMicros();
+  display_setCursor(0, 0);
+  display_setTextColor(DISPLAY_WHITE);
+  display_setTextSize(1);
+  display_println("Hello World!");
+  display_setTextColor(DISPLAY_YELLOW);
+  display_setTextSize(2);
+  display_println("1234.56");
+  display_setTextColor(DISPLAY_RED);
+  display_setTextSize(3);
+  display_println("DEADBEEF");
+  display_println("");
+  display_setTextColor(DISPLAY_GREEN);
+  display_setTextSize(5);
+  display_println("Groop");
+  display_setTextSize(2);
+  display_println("I implore thee,");
+  display_setTextSize(1);
+  display_println("my foonting turlingdromes.");
+  display_println("And hooptiously drangle me");
+  display_println("with crinkly bindlewurdles,");
+  display_println("Or I will rend thee");
+  display_println("in the gobberwarts");
+  display_println("with my blurglecruncheon,");
+  display_println("see if I don't!");
+  return headlessDisplay_getMicros() - start;
+}
+
+// Fans of lines from each corner.
+unsigned long display_testLines(uint16_t color) {
+  int16_t w = DISPLAY_WIDTH, h = DISPLAY_HEIGHT;
+  int16_t x0[] = {0, w - 1, 0, w - 1}, y0[] = {0, 0, h - 1, h - 1};
+  unsigned long total = 0;
+  for (uint16_t corner = 0; corner < 4; corner++) {
+    display_fillScreen(DISPLAY_BLACK);
+    unsigned long start = headlessDisplay_getMicros();
+    int16_t yEdge = h - 1 - y0[corner], xEdge = w - 1 - x0[corner];
+    for (int16_t x = 0; x < w; x += 6)
+      display_drawLine(x0[corner], y0[corner], x, yEdge, color);
+    for (int16_t y = 0; y < h; y += 6)
+      display_drawLine(x0[corner], y0[corner], xEdge, y, color);
+    total += headlessDisplay_getMicros() - start;
+  }
+  return total;
+}
+
+unsigned long display_testFastLines(uint16_t color1, uint16_t color2) {
+  display_fillScreen(DISPLAY_BLACK);
+  unsigned long start = headlessDisplay_getMicros();
+  for (int16_t y = 0; y < DISPLAY_HEIGHT; y += 5)
+    display_drawFastHLine(0, y, DISPLAY_WIDTH, color1);
+  for (int16_t x = 0; x < DISPLAY_WIDTH; x += 5)
+    display_drawFastVLine(x, 0, DISPLAY_HEIGHT, color2);
+  return headlessDisplay_getMicros() - start;
+}
+
+unsigned long display_testRects(uint16_t color) {
+  int16_t cx = DISPLAY_WIDTH / 2, cy = DISPLAY_HEIGHT / 2;
+  display_fillScreen(DISPLAY_BLACK);
+  unsigned long start = headlessDisplay_getMicros();
+  for (int16_t i = 2; i < DISPLAY_HEIGHT; i += 6)
+    display_drawRect(cx - i / 2, cy - i / 2, i, i, color);
+  return headlessDisplay_getMicros() - start;
+}
+
+unsigned long display_testFilledRects(uint16_t color1, uint16_t color2) {
+  int16_t cx = DISPLAY_WIDTH / 2 - 1, cy = DISPLAY_HEIGHT / 2 - 1;
+  display_fillScreen(DISPLAY_BLACK);
+  unsigned long start = headlessDisplay_getMicros();
+  for (int16_t i = DISPLAY_HEIGHT; i > 0; i -= 6) {
+    display_fillRect(cx - i / 2, cy - i / 2, i, i, color1);
+    display_drawRect(cx - i / 2, cy - i / 2, i, i, color2);
+  }
+  return headlessDisplay_getMicros() - start;
+}
+
+unsigned long display_testFilledCircles(uint8_t radius, uint16_t color) {
+  display_fillScreen(DISPLAY_BLACK);
+  unsigned long start = headlessDisplay_getMicros();
+  for (int16_t x = radius; x < DISPLAY_WIDTH; x += radius * 2)
+    for (int16_t y = radius; y < DISPLAY_HEIGHT; y += radius * 2)
+      display_fillCircle(x, y, radius, color);
+  return headlessDisplay_getMicros() - start;
+}
+
+// Draws over what display_testFilledCircles() left.
+unsigned long display_testCircles(uint8_t radius, uint16_t color) {
+  unsigned long start = headlessDisplay_getMicros();
+  for (int16_t x = 0; x < DISPLAY_WIDTH + radius; x += radius * 2)
+    for (int16_t y = 0; y < DISPLAY_HEIGHT + radius; y += radius * 2)
+      display_drawCircle(x, y, radius, color);
+  return headlessDisplay_getMicros() - start;
+}
+
+unsigned long display_testTriangles() {
+  int16_t cx = DISPLAY_WIDTH / 2 - 1, cy = DISPLAY_HEIGHT / 2 - 1;
+  display_fillScreen(DISPLAY_BLACK);
+  unsigned long start = headlessDisplay_getMicros();
+  for (int16_t i = 0; i < cy; i += 5)
+    display_drawTriangle(cx, cy - i, cx - i, cy + i, cx + i, cy + i,
+                         display_color565(i, i, i));
+  return headlessDisplay_getMicros() - start;
+}
+
+unsigned long display_testFilledTriangles() {
+  int16_t cx = DISPLAY_WIDTH / 2 - 1, cy = DISPLAY_HEIGHT / 2 - 1;
+  display_fillScreen(DISPLAY_BLACK);
+  unsigned long start = headlessDisplay_getMicros();
+  for (int16_t i = cy; i > 10; i -= 5) {
+    display_fillTriangle(cx, cy - i, cx - i, cy + i, cx + i, cy + i,
+                         display_color565(0, i * 10, i * 10));
+    display_drawTriangle(cx, cy - i, cx - i, cy + i, cx + i, cy + i,
+                         display_color565(i * 10, i * 10, 0));
+  }
+  return headlessDisplay_getMicros() - start;
+}
+
+unsigned long display_testRoundRects() {
+  int16_t cx = DISPLAY_WIDTH / 2 - 1, cy = DISPLAY_HEIGHT / 2 - 1;
+  display_fillScreen(DISPLAY_BLACK);
+  unsigned long start = headlessDisplay_getMicros();
+  for (int16_t i = 0; i < DISPLAY_HEIGHT; i += 6)
+    display_drawRoundRect(cx - i / 2, cy - i / 2, i, i, i / 8,
+                          display_color565(i, 0, 0));
+  return headlessDisplay_getMicros() - start;
+}
+
+unsigned long display_testFilledRoundRects() {
+  int16_t cx = DISPLAY_WIDTH / 2 - 1, cy = DISPLAY_HEIGHT / 2 - 1;
+  display_fillScreen(DISPLAY_BLACK);
+  unsigned long start = headlessDisplay_getMicros();
+  for (int16_t i = DISPLAY_HEIGHT; i > 20; i -= 6)
+    display_fillRoundRect(cx - i / 2, cy - i / 2, i, i, i / 8,
+                          display_color565(0, i, 0));
+  return headlessDisplay_getMicros() - start;
+}
+
+// Runs every test and prints the times.
+unsigned long display_test() {
+  unsigned long times[] = {display_testFillScreen(),
+                           display_testText(),
+                           display_testLines(DISPLAY_CYAN),
+                           display_testFastLines(DISPLAY_RED, DISPLAY_BLUE),
+                           display_testRects(DISPLAY_GREEN),
+                           display_testFilledRects(DISPLAY_YELLOW,
+                                                   DISPLAY_MAGENTA),
+                           display_testFilledCircles(10, DISPLAY_MAGENTA),
+                           display_testCircles(10, DISPLAY_WHITE),
+                           display_testTriangles(),
+                           display_testFilledTriangles(),
+                           display_testRoundRects(),
+                           display_testFilledRoundRects()};
+  const char *names[] = {"Screen fill",     "Text",
+                         "Lines",           "Horiz/Vert Lines",
+                         "Rectangles",      "Rectangles (filled)",
+                         "Circles (filled)", "Circles (outline)",
+                         "Triangles",       "Triangles (filled)",
+                         "Rounded rects",   "Rounded rects (filled)"};
+  unsigned long total = 0;
+  printf("Benchmark                Time (microseconds)\n");
+  for (uint16_t i = 0; i < sizeof(times) / sizeof(times[0]); i++) {
+    printf("%-24s %lu\n", names[i], times[i]);
+    total += times[i];
+  }
+  return total;
+}
+
+/*******************************************************
+ ********************** Touchscreen ********************
+ ******************************************************/
+
+bool display_isTouched(void) { return touched; }
+
+void display_getTouchedPoint(int16_t *x, int16_t *y, uint8_t *z) {
+  *x = touchX;
+  *y = touchY;
+  *z = touched ? HEADLESS_DISPLAY_TOUCH_PRESSURE : 0;
+}
+
+// Touches are set by the input script, there is no old data to throw away.
+void display_clearOldTouchData() {}
@@ -0,0 +1,445 @@
+/*
+This software is provided for student assignment use in the Department of
+Electrical and Computer Engineering, Brigham Young University, Utah, USA.
+
+Users agree to not re-host, or redistribute the software, in source or binary
+form, to other persons or other institutions. Users may modify and use the
+source code for personal or educational use.
+
+For questions, contact Brad Hutchings or Jeff Goeders, https://ece.byu.edu/
+*/
+
+#include <pthread.h>
+#include <stdio.h>
+
+#include "headless.h"
+#include "xil_io.h"
+#include "xparameters.h"
+
+#define HEADLESS_IO_TIMER_COUNT 3
+#define HEADLESS_IO_TIMER_SPAN 0x10000
+#define HEADLESS_IO_GPIO_SPAN 0x10000
+
+// AXI timer registers, counter 1's are at +0x10.
+#define HEADLESS_IO_TCSR 0x00
+#define HEADLESS_IO_TLR 0x04
+#define HEADLESS_IO_TCR 0x08
+#define HEADLESS_IO_COUNTER_SPAN 0x10
+
+// TCSR bits.
+#define HEADLESS_IO_CASC (1 << 11)
+#define HEADLESS_IO_ENALL (1 << 10)
+#define HEADLESS_IO_TINT (1 << 8)
+#define HEADLESS_IO_ENT (1 << 7)
+#define HEADLESS_IO_ENIT (1 << 6)
+#define HEADLESS_IO_LOAD (1 << 5)
+#define HEADLESS_IO_ARHT (1 << 4)
+#define HEADLESS_IO_UDT (1 << 1)
+
+// AXI interrupt controller registers.
+#define HEADLESS_IO_ISR 0x00
+#define HEADLESS_IO_IPR 0x04
+#define HEADLESS_IO_IER 0x08
+#define HEADLESS_IO_IAR 0x0C
+#define HEADLESS_IO_SIE 0x10
+#define HEADLESS_IO_CIE 0x14
+#define HEADLESS_IO_MER 0x1C
+#define HEADLESS_IO_MER_ME 0x1
+
+// GPIO registers.
+#define HEADLESS_IO_GPIO_DATA 0x00
+#define HEADLESS_IO_GPIO_TRI 0x04
+
+typedef struct {
+  uint32_t tcsr[2];
+  uint32_t tlr[2];
+  uint32_t tcr[2];
+  uint64_t time; // The virtual time the counters have been counted to.
+} headlessIo_timer_t;
+
+typedef struct {
+  uint32_t data;
+  uint32_t tri;
+} headlessIo_gpio_t;
+
+static pthread_mutex_t ioLock = PTHREAD_MUTEX_INITIALIZER;
+static headlessIo_timer_t timers[HEADLESS_IO_TIMER_COUNT];
+static uint32_t intcIsr;
+static uint32_t intcIer;
+static uint32_t intcMer;
+static headlessIo_gpio_t buttons;
+static headlessIo_gpio_t switches;
+static headlessIo_gpio_t leds;
+static bool unknownAddressReported;
+
+static const uint32_t timerBases[HEADLESS_IO_TIMER_COUNT] = {
+    XPAR_AXI_TIMER_0_BASEADDR, XPAR_AXI_TIMER_1_BASEADDR,
+    XPAR_AXI_TIMER_2_BASEADDR};
+
+// Puts every peripheral in its reset state.
+void headlessIo_init() {
+  pthread_mutex_lock(&ioLock);
+  for (uint16_t i = 0; i < HEADLESS_IO_TIMER_COUNT; i++)
+    timers[i] = (headlessIo_timer_t){0};
+  intcIsr = 0;
+  intcIer = 0;
+  intcMer = 0;
+  buttons = (headlessIo_gpio_t){0};
+  switches = (headlessIo_gpio_t){0};
+  leds = (headlessIo_gpio_t){0};
+  pthread_mutex_unlock(&ioLock);
+}
+
+/*******************************************************
+ ********************* AXI timers **********************
+ ******************************************************/
+
+// In cascade mode counter 0's control register runs both counters as one.
+static bool headlessIo_isCascaded(const headlessIo_timer_t *timer) {
+  return timer->tcsr[0] & HEADLESS_IO_CASC;
+}
+
+// True if the counter counts, ENALL in either control register starts both.
+static bool headlessIo_isCounting(const headlessIo_timer_t *timer,
+                                  uint16_t counter) {
+  uint32_t tcsr = timer->tcsr[counter];
+  if (tcsr & HEADLESS_IO_LOAD)
+    return false; // Held at the load value.
+  return (tcsr & HEADLESS_IO_ENT) ||
+         ((timer->tcsr[0] | timer->tcsr[1]) & HEADLESS_IO_ENALL);
+}
+
+// Cycles from value to the terminal count, 0 or max.
+static uint64_t headlessIo_getDistance(uint64_t value, uint64_t max,
+                                       uint32_t tcsr) {
+  return (tcsr & HEADLESS_IO_UDT) ? value : max - value;
+}
+
+// Counts a counter (or the cascaded pair, with max UINT64_MAX) forward by
+// cycles. Returns the number of times it passed the terminal count. Passing it
+// reloads the load value with ARHT, which takes a cycle, so a period is two
+// cycles longer than the distance from the load value to the terminal count.
+// Without ARHT the counter wraps around.
+static uint64_t headlessIo_count(uint64_t *value, uint64_t load, uint64_t max,
+                                 uint32_t tcsr, uint64_t cycles) {
+  uint64_t distance = headlessIo_getDistance(*value, max, tcsr);
+  uint64_t rollovers = 0;
+  if (cycles <= distance) {
+    distance -= cycles;
+  } else {
+    cycles -= distance + 1;
+    rollovers = 1;
+    uint64_t restart = max;
+    if (tcsr & HEADLESS_IO_ARHT) {
+      uint64_t loadDistance = headlessIo_getDistance(load, max, tcsr);
+      restart = loadDistance < max ? loadDistance + 1 : max;
+    }
+    // restart + 1 only overflows for a free running 64-bit counter.
+    if (restart + 1 != 0) {
+      rollovers += cycles / (restart + 1);
+      cycles %= restart + 1;
+    }
+    distance = restart - cycles;
+  }
+  *value = ((tcsr & HEADLESS_IO_UDT) ? distance : max - distance) & max;
+  return rollovers;
+}
+
+// Counts the timer forward to time.
+static void headlessIo_countTimer(headlessIo_timer_t *timer, uint64_t time) {
+  uint64_t cycles = time - timer->time;
+  timer->time = time;
+  if (headlessIo_isCascaded(timer)) {
+    if (!headlessIo_isCounting(timer, 0))
+      return;
+    uint64_t value = (uint64_t)timer->tcr[1] << 32 | timer->tcr[0];
+    uint64_t load = (uint64_t)timer->tlr[1] << 32 | timer->tlr[0];
+    if (headlessIo_count(&value, load, UINT64_MAX, timer->tcsr[0], cycles))
+      timer->tcsr[0] |= HEADLESS_IO_TINT;
+    timer->tcr[0] = (uint32_t)value;
+    timer->tcr[1] = value >> 32;
+    return;
+  }
+  for (uint16_t counter = 0; counter < 2; counter++) {
+    if (!headlessIo_isCounting(timer, counter))
+      continue;
+    uint64_t value = timer->tcr[counter];
+    if (headlessIo_count(&value, timer->tlr[counter], UINT32_MAX,
+                         timer->tcsr[counter], cycles))
+      timer->tcsr[counter] |= HEADLESS_IO_TINT;
+    timer->tcr[counter] = value;
+  }
+}
+
+// Returns the cycles until the counter next passes its terminal count and
+// raises an interrupt, HEADLESS_NO_EVENT if it won't.
+static uint64_t headlessIo_getCyclesToInterrupt(const headlessIo_timer_t *timer,
+                                                uint16_t counter) {
+  if (counter == 1 && headlessIo_isCascaded(timer))
+    return HEADLESS_NO_EVENT; // Counter 0 runs the pair.
+  uint32_t tcsr = timer->tcsr[counter];
+  if (!(tcsr & HEADLESS_IO_ENIT) || (tcsr & HEADLESS_IO_TINT) ||
+      !headlessIo_isCounting(timer, counter))
+    return HEADLESS_NO_EVENT; // Disabled, or already raised.
+  if (headlessIo_isCascaded(timer)) {
+    uint64_t value = (uint64_t)timer->tcr[1] << 32 | timer->tcr[0];
+    uint64_t distance = headlessIo_getDistance(value, UINT64_MAX, tcsr);
+    return distance < UINT64_MAX ? distance + 1 : HEADLESS_NO_EVENT;
+  }
+  return headlessIo_getDistance(timer->tcr[counter], UINT32_MAX, tcsr) + 1;
+}
+
+// The interrupt output of a timer.
+static bool headlessIo_isTimerInterrupting(const headlessIo_timer_t *timer) {
+  for (uint16_t counter = 0; counter < 2; counter++) {
+    uint32_t tcsr = timer->tcsr[counter];
+    if ((tcsr & HEADLESS_IO_TINT) && (tcsr & HEADLESS_IO_ENIT))
+      return true;
+  }
+  return false;
+}
+
+// Loads the load register into the counter while LOAD is set. In cascade mode
+// the load registers are loaded into both counters.
+static void headlessIo_loadTimer(headlessIo_timer_t *timer, uint16_t counter) {
+  if (!(timer->tcsr[counter] & HEADLESS_IO_LOAD))
+    return;
+  if (headlessIo_isCascaded(timer)) {
+    timer->tcr[0] = timer->tlr[0];
+    timer->tcr[1] = timer->tlr[1];
+  } else {
+    timer->tcr[counter] = timer->tlr[counter];
+  }
+}
+
+static uint32_t headlessIo_readTimer(headlessIo_timer_t *timer,
+                                     uint32_t offset) {
+  uint16_t counter = offset / HEADLESS_IO_COUNTER_SPAN;
+  switch (offset % HEADLESS_IO_COUNTER_SPAN) {
+  case HEADLESS_IO_TCSR:
+    return timer->tcsr[counter];
+  case HEADLESS_IO_TLR:
+    return timer->tlr[counter];
+  case HEADLESS_IO_TCR:
+    return timer->tcr[counter];
+  }
+  return 0;
+}
+
+static void headlessIo_writeTimer(headlessIo_timer_t *timer, uint32_t offset,
+                                  uint32_t value) {
+  uint16_t counter = offset / HEADLESS_IO_COUNTER_SPAN;
+  switch (offset % HEADLESS_IO_COUNTER_SPAN) {
+  case HEADLESS_IO_TCSR:
+    // Writing a 1 to the interrupt bit clears it.
+    if (value & HEADLESS_IO_TINT)
+      value &= ~HEADLESS_IO_TINT;
+    else
+      value |= timer->tcsr[counter] & HEADLESS_IO_TINT;
+    timer->tcsr[counter] = value;
+    headlessIo_loadTimer(timer, counter);
+    break;
+  case HEADLESS_IO_TLR:
+    timer->tlr[counter] = value;
+    headlessIo_loadTimer(timer, counter);
+    break;
+  }
+}
+
+/*******************************************************
+ *************** AXI interrupt controller **************
+ ******************************************************/
+
+// The inputs are levels, timer n is input n.
+static uint32_t headlessIo_getIntcInputs() {
+  uint32_t inputs = 0;
+  for (uint16_t i = 0; i < HEADLESS_IO_TIMER_COUNT; i++)
+    if (headlessIo_isTimerInterrupting(&timers[i]))
+      inputs |= 1 << i;
+  return inputs;
+}
+
+// Latches the inputs into the status register. A bit cleared while its input
+// is still asserted is set again, as with a level input on the board.
+static void headlessIo_latchIntc() { intcIsr |= headlessIo_getIntcInputs(); }
+
+static uint32_t headlessIo_readIntc(uint32_t offset) {
+  switch (offset) {
+  case HEADLESS_IO_ISR:
+    return intcIsr;
+  case HEADLESS_IO_IPR:
+    return intcIsr & intcIer;
+  case HEADLESS_IO_IER:
+    return intcIer;
+  case HEADLESS_IO_MER:
+    return intcMer;
+  }
+  return 0;
+}
+
+static void headlessIo_writeIntc(uint32_t offset, uint32_t value) {
+  switch (offset) {
+  case HEADLESS_IO_IER:
+    intcIer = value;
+    break;
+  case HEADLESS_IO_IAR:
+    intcIsr &= ~value;
+    break;
+  case HEADLESS_IO_SIE:
+    intcIer |= value;
+    break;
+  case HEADLESS_IO_CIE:
+    intcIer &= ~value;
+    break;
+  case HEADLESS_IO_MER:
+    intcMer = value;
+    break;
+  }
+}
+
+/*******************************************************
+ *********************** Registers *********************
+ ******************************************************/
+
+// Returns the GPIO at address, NULL if there isn't one.
+static headlessIo_gpio_t *headlessIo_getGpio(uint32_t address) {
+  uint32_t base = address & ~(HEADLESS_IO_GPIO_SPAN - 1);
+  if (base == XPAR_PUSH_BUTTONS_BASEADDR)
+    return &buttons;
+  if (base == XPAR_SLIDE_SWITCHES_BASEADDR)
+    return &switches;
+  if (base == XPAR_LEDS_BASEADDR)
+    return &leds;
+  return NULL;
+}
+
+// Returns the timer at address, NULL if there isn't one.
+static headlessIo_timer_t *headlessIo_getTimer(uint32_t address) {
+  for (uint16_t i = 0; i < HEADLESS_IO_TIMER_COUNT; i++)
+    if (address - timerBases[i] < HEADLESS_IO_TIMER_SPAN)
+      return &timers[i];
+  return NULL;
+}
+
+// Reports the first access outside the modeled peripherals.
+static void headlessIo_reportUnknown(uint32_t address) {
+  if (unknownAddressReported)
+    return;
+  unknownAddressReported = true;
+  printf("headless: nothing is modeled at address 0x%08x (reported once).\n",
+         address);
+}
+
+static uint32_t headlessIo_read(uint32_t address) {
+  headlessIo_timer_t *timer = headlessIo_getTimer(address);
+  if (timer)
+    return headlessIo_readTimer(timer, address % HEADLESS_IO_TIMER_SPAN);
+  if (address - XPAR_AXI_INTC_0_BASEADDR < HEADLESS_IO_GPIO_SPAN)
+    return headlessIo_readIntc(address - XPAR_AXI_INTC_0_BASEADDR);
+  headlessIo_gpio_t *gpio = headlessIo_getGpio(address);
+  if (gpio) {
+    uint32_t offset = address % HEADLESS_IO_GPIO_SPAN;
+    return offset == HEADLESS_IO_GPIO_TRI    ? gpio->tri
+           : offset == HEADLESS_IO_GPIO_DATA ? gpio->data
+                                             : 0;
+  }
+  headlessIo_reportUnknown(address);
+  return 0;
+}
+
+static void headlessIo_write(uint32_t address, uint32_t value) {
+  headlessIo_timer_t *timer = headlessIo_getTimer(address);
+  if (timer) {
+    headlessIo_writeTimer(timer, address % HEADLESS_IO_TIMER_SPAN, value);
+  } else if (address - XPAR_AXI_INTC_0_BASEADDR < HEADLESS_IO_GPIO_SPAN) {
+    headlessIo_writeIntc(address - XPAR_AXI_INTC_0_BASEADDR, value);
+  } else if (headlessIo_getGpio(address)) {
+    headlessIo_gpio_t *gpio = headlessIo_getGpio(address);
+    uint32_t offset = address % HEADLESS_IO_GPIO_SPAN;
+    // Only the LEDs are outputs, the buttons and switches ignore data writes.
+    if (offset == HEADLESS_IO_GPIO_TRI)
+      gpio->tri = value;
+    else if (offset == HEADLESS_IO_GPIO_DATA && gpio == &leds)
+      gpio->data = value;
+  } else {
+    headlessIo_reportUnknown(address);
+    return;
+  }
+  // A write can raise or clear a timer interrupt.
+  headlessIo_latchIntc();
+}
+
+uint32_t Xil_In32(uint32_t Addr) {
+  headlessBoard_beginIo();
+  pthread_mutex_lock(&ioLock);
+  uint32_t value = headlessIo_read(Addr);
+  pthread_mutex_unlock(&ioLock);
+  headlessBoard_endIo();
+  return value;
+}
+
+void Xil_Out32(uint32_t Addr, uint32_t Value) {
+  headlessBoard_beginIo();
+  pthread_mutex_lock(&ioLock);
+  headlessIo_write(Addr, Value);
+  pthread_mutex_unlock(&ioLock);
+  headlessBoard_endIo();
+}
+
+/*******************************************************
+ ******************** Hardware thread ******************
+ ******************************************************/
+
+// Counts the timers forward to time and latches their interrupts.
+void headlessIo_advance(uint64_t time) {
+  pthread_mutex_lock(&ioLock);
+  for (uint16_t i = 0; i < HEADLESS_IO_TIMER_COUNT; i++)
+    headlessIo_countTimer(&timers[i], time);
+  headlessIo_latchIntc();
+  pthread_mutex_unlock(&ioLock);
+}
+
+// Returns when the next enabled timer interrupt will be raised.
+uint64_t headlessIo_getNextEventTime() {
+  uint64_t next = HEADLESS_NO_EVENT;
+  pthread_mutex_lock(&ioLock);
+  for (uint16_t i = 0; i < HEADLESS_IO_TIMER_COUNT; i++) {
+    for (uint16_t counter = 0; counter < 2; counter++) {
+      uint64_t cycles = headlessIo_getCyclesToInterrupt(&timers[i], counter);
+      if (cycles != HEADLESS_NO_EVENT && timers[i].time + cycles < next)
+        next = timers[i].time + cycles;
+    }
+  }
+  pthread_mutex_unlock(&ioLock);
+  return next;
+}
+
+// True while the interrupt controller's irq output is asserted.
+bool headlessIo_isIrqAsserted() {
+  pthread_mutex_lock(&ioLock);
+  bool asserted = (intcMer & HEADLESS_IO_MER_ME) && (intcIsr & intcIer);
+  pthread_mutex_unlock(&ioLock);
+  return asserted;
+}
+
+// Sets what the buttons GPIO reads.
+void headlessIo_setButtons(uint32_t value) {
+  pthread_mutex_lock(&ioLock);
+  buttons.data = value;
+  pthread_mutex_unlock(&ioLock);
+}
+
+// Sets what the switches GPIO reads.
+void headlessIo_setSwitches(uint32_t value) {
+  pthread_mutex_lock(&ioLock);
+  switches.data = value;
+  pthread_mutex_unlock(&ioLock);
+}
+
+// Returns what was last written to the LEDs GPIO.
+uint32_t headlessIo_getLeds() {
+  pthread_mutex_lock(&ioLock);
+  uint32_t value = leds.data;
+  pthread_mutex_unlock(&ioLock);
+  return value;
+}
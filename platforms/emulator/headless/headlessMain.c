@@ -0,0 +1,441 @@
+/*
+This software is provided for student assignment use in the Department of
+Electrical and Computer Engineering, Brigham Young University, Utah, USA.
+
+Users agree to not re-host, or redistribute the software, in source or binary
+form, to other persons or other institutions. Users may modify and use the
+source code for personal or educational use.
+
+For questions, contact Brad Hutchings or Jeff Goeders, https://ece.byu.edu/
+*/
+
+#include <errno.h>
+#include <getopt.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "headless.h"
+
+// emulator.h renames the program's main() to user_main(), this is the real
+// one.
+#undef main
+
+// Sent to the program thread to end the run.
+#define HEADLESS_MAIN_FINISH_SIGNAL SIGUSR2
+
+#define HEADLESS_MAIN_DEFAULT_FRAME_MS 1000
+#define HEADLESS_MAIN_LINE_MAX 128
+#define HEADLESS_MAIN_PATH_MAX 512
+#define HEADLESS_MAIN_NS_PER_S 1000000000L
+#define HEADLESS_MAIN_NS_PER_US 1000L
+
+typedef enum {
+  HEADLESS_MAIN_INPUT_BUTTONS,
+  HEADLESS_MAIN_INPUT_SWITCHES,
+  HEADLESS_MAIN_INPUT_TOUCH,
+  HEADLESS_MAIN_INPUT_RELEASE
+} headlessMain_inputKind_t;
+
+typedef struct {
+  uint64_t time;
+  headlessMain_inputKind_t kind;
+  uint32_t value;
+  int16_t x;
+  int16_t y;
+} headlessMain_input_t;
+
+int user_main();
+
+static uint64_t virtualTime;
+static pthread_mutex_t timeLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t timeChanged = PTHREAD_COND_INITIALIZER;
+static sem_t hardwareWake;
+
+// What the program is waiting for, under timeLock.
+static bool programWaiting;
+static uint64_t programWakeTime;
+static bool programWakesOnInterrupt;
+static uint32_t programWakeCount;
+
+// Options.
+static uint64_t endTime = HEADLESS_NO_EVENT;
+static double speed; // 0 is no limit.
+static const char *frameDirectory;
+static uint64_t framePeriod =
+    HEADLESS_MAIN_DEFAULT_FRAME_MS * HEADLESS_CYCLES_PER_MS;
+static bool syncDisplay;
+
+static uint64_t nextFrameTime = HEADLESS_NO_EVENT;
+static uint32_t frameCount;
+static headlessMain_input_t *inputs;
+static uint32_t inputCount;
+static uint32_t nextInput;
+static struct timespec hostStartTime;
+static pthread_t programThread;
+static pthread_mutex_t finishLock = PTHREAD_MUTEX_INITIALIZER;
+static int finishStatus;
+static const char *finishMessage = "";
+
+// Returns the virtual time in cycles.
+uint64_t headless_getTime() {
+  return __atomic_load_n(&virtualTime, __ATOMIC_ACQUIRE);
+}
+
+// Tells the hardware thread the program has changed state.
+void headless_wakeHardware() { sem_post(&hardwareWake); }
+
+// True while the program waits for something that hasn't happened. Call with
+// timeLock held.
+static bool headlessMain_isProgramAsleep() {
+  if (!programWaiting || headless_getTime() >= programWakeTime)
+    return false;
+  return !programWakesOnInterrupt ||
+         headlessBoard_getInterruptCount() == programWakeCount;
+}
+
+// Blocks the program until wakeTime, or until an ISR has run. The ISR runs in
+// the middle of the wait.
+static void headlessMain_wait(uint64_t wakeTime, bool wakesOnInterrupt) {
+  pthread_mutex_lock(&timeLock);
+  programWaiting = true;
+  programWakeTime = wakeTime;
+  programWakesOnInterrupt = wakesOnInterrupt;
+  programWakeCount = headlessBoard_getInterruptCount();
+  headless_wakeHardware();
+  while (headlessMain_isProgramAsleep())
+    pthread_cond_wait(&timeChanged, &timeLock);
+  programWaiting = false;
+  pthread_mutex_unlock(&timeLock);
+}
+
+// Blocks the program until the virtual time reaches time.
+void headless_waitUntil(uint64_t time) { headlessMain_wait(time, false); }
+
+// Blocks the program until an ISR has run.
+void headless_waitForInterrupt() {
+  headlessMain_wait(HEADLESS_NO_EVENT, true);
+}
+
+// Returns the host seconds since the start.
+static double headlessMain_getHostSeconds() {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (now.tv_sec - hostStartTime.tv_sec) +
+         (now.tv_nsec - hostStartTime.tv_nsec) /
+             (double)HEADLESS_MAIN_NS_PER_S;
+}
+
+// Saves the display as <frame directory>/<name>.ppm.
+static void headlessMain_writeFrame(const char *name) {
+  char path[HEADLESS_MAIN_PATH_MAX];
+  snprintf(path, sizeof(path), "%s/%s.ppm", frameDirectory, name);
+  if (!headlessDisplay_writeImage(path))
+    printf("headless: can't write %s.\n", path);
+}
+
+// Prints why the run ended and the totals, then exits. Runs on the program
+// thread, in a signal handler when the hardware thread ends the run, so it
+// only writes the line with write() after flushing what the program printed.
+static void headlessMain_exit() {
+  fflush(stdout);
+  char line[HEADLESS_MAIN_LINE_MAX * 2];
+  int length = snprintf(
+      line, sizeof(line),
+      "%sheadless: ran %.3f virtual seconds in %.3f host seconds, %u "
+      "interrupts, %u frames.\n",
+      finishMessage, (double)headless_getTime() / HEADLESS_CLOCK_HZ,
+      headlessMain_getHostSeconds(), headlessBoard_getInterruptCount(),
+      frameCount);
+  if (write(STDOUT_FILENO, line, length) < 0)
+    finishStatus = EXIT_FAILURE;
+  _exit(finishStatus);
+}
+
+static void headlessMain_handleFinishSignal(int signal) {
+  (void)signal;
+  headlessMain_exit();
+}
+
+// Ends the run from either thread. The first call wins, a later one blocks
+// until the process exits. The hardware thread can't exit itself, the program
+// may be in the middle of a printf().
+static void headlessMain_finish(int status, const char *message) {
+  pthread_mutex_lock(&finishLock);
+  finishStatus = status;
+  finishMessage = message;
+  if (frameDirectory)
+    headlessMain_writeFrame("last");
+  if (pthread_equal(pthread_self(), programThread))
+    headlessMain_exit();
+  pthread_kill(programThread, HEADLESS_MAIN_FINISH_SIGNAL);
+  for (;;)
+    pause();
+}
+
+/*******************************************************
+ ******************** Hardware thread ******************
+ ******************************************************/
+
+// Gives the program up to a quantum of host time, less if it goes to sleep
+// with no interrupt in flight. A program that an ISR woke up is let go here.
+static void headlessMain_letProgramRun() {
+  struct timespec deadline;
+  clock_gettime(CLOCK_REALTIME, &deadline);
+  deadline.tv_nsec += HEADLESS_QUANTUM_US * HEADLESS_MAIN_NS_PER_US;
+  if (deadline.tv_nsec >= HEADLESS_MAIN_NS_PER_S) {
+    deadline.tv_sec++;
+    deadline.tv_nsec -= HEADLESS_MAIN_NS_PER_S;
+  }
+  for (;;) {
+    pthread_mutex_lock(&timeLock);
+    bool asleep = headlessMain_isProgramAsleep();
+    if (programWaiting && !asleep)
+      pthread_cond_broadcast(&timeChanged);
+    pthread_mutex_unlock(&timeLock);
+    if (asleep && !headlessBoard_isInterruptInFlight())
+      return;
+    if (sem_timedwait(&hardwareWake, &deadline) != 0 && errno == ETIMEDOUT)
+      return;
+  }
+}
+
+// Counts the hardware forward to time and wakes the program if it was
+// waiting for it.
+static void headlessMain_advance(uint64_t time) {
+  headlessIo_advance(time);
+  pthread_mutex_lock(&timeLock);
+  __atomic_store_n(&virtualTime, time, __ATOMIC_RELEASE);
+  pthread_cond_broadcast(&timeChanged);
+  pthread_mutex_unlock(&timeLock);
+}
+
+// Applies the inputs that are due.
+static void headlessMain_applyInputs(uint64_t now) {
+  while (nextInput < inputCount && inputs[nextInput].time <= now) {
+    const headlessMain_input_t *input = &inputs[nextInput++];
+    switch (input->kind) {
+    case HEADLESS_MAIN_INPUT_BUTTONS:
+      headlessIo_setButtons(input->value);
+      break;
+    case HEADLESS_MAIN_INPUT_SWITCHES:
+      headlessIo_setSwitches(input->value);
+      break;
+    case HEADLESS_MAIN_INPUT_TOUCH:
+      headlessDisplay_setTouch(true, input->x, input->y);
+      break;
+    case HEADLESS_MAIN_INPUT_RELEASE:
+      headlessDisplay_setTouch(false, input->x, input->y);
+      break;
+    }
+  }
+}
+
+// Returns the earlier of two times.
+static uint64_t headlessMain_min(uint64_t a, uint64_t b) {
+  return a < b ? a : b;
+}
+
+// Returns how far time may move while the program is running: speed times the
+// host time since the last step, so --speed keeps pace with the host clock
+// however long a step takes.
+static uint64_t headlessMain_getBusyStep(double *lastHostSeconds) {
+  double hostSeconds = headlessMain_getHostSeconds();
+  double step = (hostSeconds - *lastHostSeconds) * speed * HEADLESS_CLOCK_HZ;
+  *lastHostSeconds = hostSeconds;
+  if (speed <= 0 || step > HEADLESS_MAX_BUSY_STEP)
+    return HEADLESS_MAX_BUSY_STEP;
+  return step;
+}
+
+// Delivers interrupts and moves virtual time: to the next event if the program
+// is asleep, at most a busy step further if it is running.
+static void *headlessMain_runHardware(void *argument) {
+  (void)argument;
+  double lastHostSeconds = 0;
+  for (;;) {
+    headlessBoard_deliverInterrupt();
+    headlessMain_letProgramRun();
+    // The board takes the interrupt right away unless it is masked. Time
+    // waits for the ISR here, the host may not have run the program yet.
+    if (headlessBoard_isInterruptInFlight() &&
+        !headlessBoard_isInterruptMasked())
+      continue;
+    uint64_t now = headless_getTime();
+    pthread_mutex_lock(&timeLock);
+    bool asleep = headlessMain_isProgramAsleep() &&
+                  !headlessBoard_isInterruptInFlight();
+    uint64_t next = programWaiting ? programWakeTime : HEADLESS_NO_EVENT;
+    pthread_mutex_unlock(&timeLock);
+    next = headlessMain_min(next, headlessIo_getNextEventTime());
+    next = headlessMain_min(next, nextFrameTime);
+    next = headlessMain_min(next, endTime);
+    if (nextInput < inputCount)
+      next = headlessMain_min(next, inputs[nextInput].time);
+    uint64_t busyStep = headlessMain_getBusyStep(&lastHostSeconds);
+    if (!asleep) {
+      next = headlessMain_min(next, now + busyStep);
+    } else if (next == HEADLESS_NO_EVENT) {
+      headlessMain_finish(EXIT_FAILURE,
+                          "headless: the program is waiting for an interrupt "
+                          "but none is scheduled.\n");
+    }
+    if (next > now)
+      headlessMain_advance(next);
+    headlessMain_applyInputs(next);
+    while (next >= nextFrameTime) {
+      char name[HEADLESS_MAIN_LINE_MAX];
+      snprintf(name, sizeof(name), "frame%06u", frameCount++);
+      headlessMain_writeFrame(name);
+      nextFrameTime += framePeriod;
+    }
+    if (next >= endTime)
+      headlessMain_finish(EXIT_SUCCESS, "");
+  }
+  return NULL;
+}
+
+/*******************************************************
+ *********************** Options ***********************
+ ******************************************************/
+
+// Reads the input script, one "<ms> <what> ..." line per input.
+static void headlessMain_readInputs(const char *path) {
+  FILE *file = fopen(path, "r");
+  if (!file) {
+    printf("headless: can't open %s.\n", path);
+    exit(EXIT_FAILURE);
+  }
+  char line[HEADLESS_MAIN_LINE_MAX];
+  uint32_t lineNumber = 0;
+  while (fgets(line, sizeof(line), file)) {
+    lineNumber++;
+    char what[HEADLESS_MAIN_LINE_MAX];
+    double ms;
+    int count = sscanf(line, "%lf %s", &ms, what);
+    if (count == EOF || line[strspn(line, " \t")] == '#')
+      continue; // A blank line or a comment.
+    headlessMain_input_t input = {0};
+    input.time = ms * HEADLESS_CYCLES_PER_MS;
+    unsigned int value;
+    int x, y;
+    bool ok = count == 2;
+    if (ok && strcmp(what, "buttons") == 0) {
+      input.kind = HEADLESS_MAIN_INPUT_BUTTONS;
+      ok = sscanf(line, "%*f %*s %x", &value) == 1;
+      input.value = value;
+    } else if (ok && strcmp(what, "switches") == 0) {
+      input.kind = HEADLESS_MAIN_INPUT_SWITCHES;
+      ok = sscanf(line, "%*f %*s %x", &value) == 1;
+      input.value = value;
+    } else if (ok && strcmp(what, "touch") == 0) {
+      input.kind = HEADLESS_MAIN_INPUT_TOUCH;
+      ok = sscanf(line, "%*f %*s %d %d", &x, &y) == 2;
+      input.x = x;
+      input.y = y;
+    } else if (ok && strcmp(what, "release") == 0) {
+      input.kind = HEADLESS_MAIN_INPUT_RELEASE;
+    } else {
+      ok = false;
+    }
+    if (ok && inputCount > 0 && input.time < inputs[inputCount - 1].time) {
+      printf("headless: %s:%u: the inputs must be in time order.\n", path,
+             lineNumber);
+      exit(EXIT_FAILURE);
+    }
+    if (!ok) {
+      printf("headless: %s:%u: can't read \"%.*s\".\n", path, lineNumber,
+             (int)strcspn(line, "\n"), line);
+      exit(EXIT_FAILURE);
+    }
+    inputs = realloc(inputs, (inputCount + 1) * sizeof(headlessMain_input_t));
+    inputs[inputCount++] = input;
+  }
+  fclose(file);
+}
+
+static void headlessMain_printUsage(const char *program) {
+  printf("Usage: %s [options]\n"
+         "  --seconds S     stop after S seconds of virtual time\n"
+         "  --speed N       run at most N times faster than the host while\n"
+         "                  the program is busy (default: no limit)\n"
+         "  --frames DIR    save the display as DIR/frameNNNNNN.ppm\n"
+         "  --frame-ms MS   virtual ms between frames (default %d)\n"
+         "  --input FILE    read buttons, switches and touches from FILE\n"
+         "  --sync-display  draw on the program thread, not a render thread\n",
+         program, HEADLESS_MAIN_DEFAULT_FRAME_MS);
+}
+
+static void headlessMain_readOptions(int argc, char **argv) {
+  static const struct option options[] = {
+      {"seconds", required_argument, NULL, 's'},
+      {"speed", required_argument, NULL, 'x'},
+      {"frames", required_argument, NULL, 'f'},
+      {"frame-ms", required_argument, NULL, 'm'},
+      {"input", required_argument, NULL, 'i'},
+      {"sync-display", no_argument, NULL, 'd'},
+      {"help", no_argument, NULL, 'h'},
+      {NULL, 0, NULL, 0}};
+  int option;
+  while ((option = getopt_long(argc, argv, "", options, NULL)) != -1) {
+    switch (option) {
+    case 's':
+      endTime = atof(optarg) * HEADLESS_CLOCK_HZ;
+      break;
+    case 'x':
+      speed = atof(optarg);
+      break;
+    case 'f':
+      frameDirectory = optarg;
+      break;
+    case 'm':
+      framePeriod = atof(optarg) * HEADLESS_CYCLES_PER_MS;
+      break;
+    case 'i':
+      headlessMain_readInputs(optarg);
+      break;
+    case 'd':
+      syncDisplay = true;
+      break;
+    case 'h':
+      headlessMain_printUsage(argv[0]);
+      exit(EXIT_SUCCESS);
+    default:
+      headlessMain_printUsage(argv[0]);
+      exit(EXIT_FAILURE);
+    }
+  }
+  if (framePeriod == 0)
+    framePeriod = HEADLESS_CYCLES_PER_MS;
+  if (frameDirectory)
+    nextFrameTime = 0;
+}
+
+// Starts the hardware thread and runs the program on this one.
+int main(int argc, char **argv) {
+  headlessMain_readOptions(argc, argv);
+  clock_gettime(CLOCK_MONOTONIC, &hostStartTime);
+  sem_init(&hardwareWake, 0, 0);
+  programThread = pthread_self();
+  signal(HEADLESS_MAIN_FINISH_SIGNAL, headlessMain_handleFinishSignal);
+  headlessIo_init();
+  headlessBoard_init();
+  headlessDisplay_init(!syncDisplay);
+  pthread_t hardwareThread;
+  pthread_create(&hardwareThread, NULL, headlessMain_runHardware, NULL);
+  int status = user_main();
+  // On the board the interrupts keep running after main() returns. The
+  // hardware thread ends the run at endTime.
+  if (endTime != HEADLESS_NO_EVENT) {
+    headless_waitUntil(endTime);
+    for (;;)
+      pause();
+  }
+  headlessMain_finish(status, "");
+  return status;
+}